@@ -242,11 +242,14 @@ void                            _clutter_actor_attach_clone
 void                            _clutter_actor_detach_clone                             (ClutterActor *actor,
                                                                                          ClutterActor *clone);
 void                            _clutter_actor_queue_only_relayout                      (ClutterActor *actor);
+void                            clutter_actor_reallocate                                (ClutterActor *self);
 void                            clutter_actor_clear_stage_views_recursive               (ClutterActor *actor,
                                                                                          gboolean      stop_transitions);
 
 float                           clutter_actor_get_real_resource_scale                   (ClutterActor *actor);
 
+guint64                         clutter_actor_get_size_request_stamp                    (ClutterActor *self);
+
 void clutter_actor_finish_layout (ClutterActor *self,
                                   int           phase);
 
@@ -268,4 +271,9 @@ const GList * clutter_actor_peek_actions (ClutterActor *self);
 void clutter_actor_set_implicitly_grabbed (ClutterActor *actor,
                                            gboolean      is_implicitly_grabbed);
 
+gboolean clutter_actor_interpolate_final_state (ClutterActor    *actor,
+                                                GParamSpec      *pspec,
+                                                ClutterInterval *interval,
+                                                double           progress);
+
 G_END_DECLS
@@ -491,6 +491,7 @@
 #include "clutter/clutter-action-private.h"
 #include "clutter/clutter-actor-meta-private.h"
 #include "clutter/clutter-animatable.h"
+#include "clutter/clutter-clone-private.h"
 #include "clutter/clutter-color-state.h"
 #include "clutter/clutter-color-static.h"
 #include "clutter/clutter-color.h"
@@ -540,6 +541,10 @@ typedef enum
  * will ask for 3 different preferred size in each allocation cycle */
 #define N_CACHED_SIZE_REQUESTS 3
 
+/* Source of ClutterActorPrivate.size_request_stamp; global so that stamps
+ * are never reused by a different actor */
+static guint64 size_request_stamp_counter = 0;
+
 struct _ClutterActorPrivate
 {
   /* request mode */
@@ -553,6 +558,9 @@ struct _ClutterActorPrivate
   guint cached_height_age;
   guint cached_width_age;
 
+  /* changes whenever the size requests above get invalidated */
+  guint64 size_request_stamp;
+
   /* the bounding box of the actor, relative to the parent's
    * allocation
    */
@@ -684,6 +692,13 @@ struct _ClutterActorPrivate
 
   GArray *next_redraw_clips;
 
+  /* the paint nodes built for the actor itself on the last paint, kept
+   * around until a redraw is queued; see clutter_actor_set_retain_paint_nodes()
+   */
+  ClutterPaintNode *retained_paint_node;
+  CoglFramebuffer *retained_paint_framebuffer;
+  guint8 retained_paint_opacity;
+
   /* bitfields: KEEP AT THE END */
 
   /* fixed position and sizes */
@@ -698,6 +713,8 @@ struct _ClutterActorPrivate
   guint needs_height_request        : 1;
   /* cached allocation is invalid (request has changed, probably) */
   guint needs_allocation            : 1;
+  /* queued on the stage as a relayout boundary, see is_relayout_boundary() */
+  guint relayout_boundary_queued    : 1;
   guint show_on_set_parent          : 1;
   guint has_clip                    : 1;
   guint clip_to_allocation          : 1;
@@ -729,6 +746,7 @@ struct _ClutterActorPrivate
   guint needs_redraw : 1;
   guint needs_finish_layout : 1;
   guint stage_relative_modelview_valid : 1;
+  guint retain_paint_nodes : 1;
 };
 
 enum
@@ -922,6 +940,8 @@ static void clutter_actor_set_natural_height_set (ClutterActor *self,
 static void clutter_actor_update_map_state       (ClutterActor  *self,
                                                   MapStateChange change);
 static void clutter_actor_unrealize_not_hiding   (ClutterActor *self);
+static void clutter_actor_allocate_internal      (ClutterActor          *self,
+                                                  const ClutterActorBox *allocation);
 
 static ClutterPaintVolume *_clutter_actor_get_paint_volume_mutable (ClutterActor *self);
 
@@ -959,6 +979,11 @@ static void pop_in_paint_unmapped_branch (ClutterActor *self,
                                           guint         count);
 
 static void clutter_actor_update_devices (ClutterActor *self);
+static void clutter_actor_clear_retained_paint_node (ClutterActor *self);
+static void queue_redraw_internal (ClutterActor             *self,
+                                   const ClutterPaintVolume *volume,
+                                   ClutterEffect            *effect);
+static void queue_redraw_for_transform (ClutterActor *self);
 
 static GQuark quark_actor_layout_info = 0;
 static GQuark quark_actor_transform_info = 0;
@@ -1412,6 +1437,9 @@ clutter_actor_real_map (ClutterActor *self)
 
   self->flags |= CLUTTER_ACTOR_MAPPED;
 
+  if (self->flags & CLUTTER_ACTOR_REACTIVE)
+    clutter_actor_update_devices (self);
+
   if (priv->unmapped_paint_branch_counter == 0)
     {
       /* Invariant that needs_finish_layout is set all the way up to the stage
@@ -1941,6 +1969,8 @@ clutter_actor_real_unrealize (ClutterActor *self)
 {
   /* we must be unmapped (implying our children are also unmapped) */
   g_assert (!clutter_actor_is_mapped (self));
+
+  clutter_actor_clear_retained_paint_node (self);
 }
 
 /**
@@ -2039,9 +2069,12 @@ unrealize_actor_after_children_cb (ClutterActor *self,
 
   if (stage != NULL &&
       priv->parent != NULL &&
-      priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
+      (priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT ||
+       priv->relayout_boundary_queued))
     clutter_stage_dequeue_actor_relayout (CLUTTER_STAGE (stage), self);
 
+  priv->relayout_boundary_queued = FALSE;
+
   if (priv->unmapped_paint_branch_counter == 0)
     priv->allocation = (ClutterActorBox) CLUTTER_ACTOR_BOX_UNINITIALIZED;
 
@@ -2319,14 +2352,22 @@ absolute_geometry_changed_cb (ClutterActor *actor,
                               int           depth,
                               gpointer      user_data)
 {
+  gboolean *affects_picking = user_data;
+
   absolute_geometry_changed (actor);
 
+  if (actor->flags & CLUTTER_ACTOR_REACTIVE &&
+      clutter_actor_is_mapped (actor))
+    *affects_picking = TRUE;
+
   return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
 }
 
 static void
 transform_changed (ClutterActor *actor)
 {
+  gboolean affects_picking = FALSE;
+
   actor->priv->transform_valid = FALSE;
 
   if (actor->priv->parent)
@@ -2336,13 +2377,32 @@ transform_changed (ClutterActor *actor)
                            CLUTTER_ACTOR_TRAVERSE_DEPTH_FIRST,
                            absolute_geometry_changed_cb,
                            NULL,
-                           NULL);
+                           &affects_picking);
 
-  if (!clutter_actor_has_transitions (actor) &&
-      !CLUTTER_ACTOR_IN_RELAYOUT (actor))
+  /* Only reactive actors end up in the pick stack, so moving a subtree
+   * without any of them can't change what's under the pointer.
+   */
+  if (affects_picking)
     clutter_actor_update_devices (actor);
 }
 
+/* Transforms only change where the actor ends up on the stage, not what
+ * it paints in its own coordinate space, so there's no need to drop its
+ * retained paint nodes, nor to mark the actor itself dirty, which would
+ * make its offscreen effects draw their unchanged contents again.
+ */
+static void
+queue_redraw_for_transform (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  gboolean was_dirty = priv->is_dirty;
+
+  queue_redraw_internal (self, NULL, NULL);
+
+  if (!was_dirty)
+    priv->is_dirty = FALSE;
+}
+
 /*< private >
  * clutter_actor_set_allocation_internal:
  * @self: a #ClutterActor
@@ -2399,7 +2459,10 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
       transform_changed (self);
 
       if (size_changed)
-        queue_update_paint_volume (self);
+        {
+          queue_update_paint_volume (self);
+          clutter_actor_clear_retained_paint_node (self);
+        }
 
       g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
 
@@ -2473,7 +2536,10 @@ _clutter_actor_queue_redraw_on_clones (ClutterActor *self)
 
   g_hash_table_iter_init (&iter, priv->clones);
   while (g_hash_table_iter_next (&iter, &key, NULL))
-    clutter_actor_queue_redraw (key);
+    {
+      clutter_clone_invalidate_contents (key);
+      clutter_actor_queue_redraw (key);
+    }
 }
 
 static void
@@ -2525,6 +2591,38 @@ clutter_actor_needs_relayout (ClutterActor *self)
           priv->needs_allocation);
 }
 
+/* An actor with a fixed size and a valid allocation stops relayouts queued
+ * by its children from propagating further up: its preferred size, and thus
+ * the allocation its parent gives it, can't change because of them. It is
+ * instead queued on the stage to reallocate its children in place.
+ */
+static gboolean
+is_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) || !priv->parent)
+    return FALSE;
+
+  if (priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
+    return FALSE;
+
+  if (!priv->min_width_set || !priv->natural_width_set ||
+      !priv->min_height_set || !priv->natural_height_set)
+    return FALSE;
+
+  if (CLUTTER_ACTOR_IN_RELAYOUT (self))
+    return FALSE;
+
+  if (priv->needs_allocation && !priv->relayout_boundary_queued)
+    return FALSE;
+
+  if (clutter_actor_has_constraints (self))
+    return FALSE;
+
+  return clutter_actor_is_mapped (self);
+}
+
 static void
 clutter_actor_real_queue_relayout (ClutterActor *self)
 {
@@ -2537,6 +2635,7 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
   priv->needs_width_request  = TRUE;
   priv->needs_height_request = TRUE;
   priv->needs_allocation     = TRUE;
+  priv->size_request_stamp   = ++size_request_stamp_counter;
 
   /* reset the cached size requests */
   memset (priv->width_requests, 0,
@@ -2548,12 +2647,52 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
   if (priv->parent != NULL)
     {
       if (priv->parent->flags & CLUTTER_ACTOR_NO_LAYOUT)
-        clutter_actor_queue_shallow_relayout (self);
+        {
+          clutter_actor_queue_shallow_relayout (self);
+        }
+      else if (is_relayout_boundary (priv->parent))
+        {
+          ClutterActorPrivate *parent_priv = priv->parent->priv;
+
+          if (!parent_priv->relayout_boundary_queued)
+            {
+              parent_priv->needs_allocation = TRUE;
+              parent_priv->relayout_boundary_queued = TRUE;
+              clutter_actor_queue_shallow_relayout (priv->parent);
+            }
+        }
       else
-        _clutter_actor_queue_only_relayout (priv->parent);
+        {
+          _clutter_actor_queue_only_relayout (priv->parent);
+        }
     }
 }
 
+/*
+ * clutter_actor_reallocate:
+ * @self: a #ClutterActor
+ *
+ * Allocates the children of @self again, keeping the current allocation of
+ * @self. Used by the stage for relayout boundaries, see
+ * is_relayout_boundary().
+ */
+void
+clutter_actor_reallocate (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  priv->relayout_boundary_queued = FALSE;
+
+  if (!priv->needs_allocation)
+    return;
+
+  if (!clutter_actor_is_mapped (self) &&
+      !clutter_actor_has_mapped_clones (self))
+    return;
+
+  clutter_actor_allocate_internal (self, &priv->allocation);
+}
+
 /**
  * clutter_actor_apply_relative_transform_to_point:
  * @self: A #ClutterActor
@@ -3342,6 +3481,15 @@ clutter_actor_real_paint (ClutterActor        *actor,
     }
 }
 
+static void
+clutter_actor_clear_retained_paint_node (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  g_clear_pointer (&priv->retained_paint_node, clutter_paint_node_unref);
+  priv->retained_paint_framebuffer = NULL;
+}
+
 static gboolean
 clutter_actor_paint_node (ClutterActor        *actor,
                           ClutterPaintNode    *root,
@@ -3579,7 +3727,19 @@ clutter_actor_paint (ClutterActor        *self,
   if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_PAINT_VOLUMES))
     _clutter_actor_draw_paint_volume (self, actor_node);
 
-  clutter_paint_node_paint (root_node, paint_context);
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_ACTOR_COSTS))
+    {
+      ClutterStage *stage =
+        CLUTTER_STAGE (_clutter_actor_get_stage_internal (self));
+
+      clutter_stage_push_actor_cost (stage);
+      clutter_paint_node_paint (root_node, paint_context);
+      clutter_stage_pop_actor_cost (stage, self, FALSE);
+    }
+  else
+    {
+      clutter_paint_node_paint (root_node, paint_context);
+    }
 
   /* If we make it here then the actor has run through a complete
    * paint run including all the effects so it's no longer dirty,
@@ -3622,21 +3782,46 @@ clutter_actor_continue_paint (ClutterActor        *self,
     {
       CoglFramebuffer *framebuffer;
       ClutterPaintNode *dummy;
+      guint8 paint_opacity;
 
-      /* XXX - this will go away in 2.0, when we can get rid of this
-       * stuff and switch to a pure retained render tree of PaintNodes
-       * for the entire frame, starting from the Stage; the paint()
-       * virtual function can then be called directly.
-       */
       framebuffer = clutter_paint_context_get_base_framebuffer (paint_context);
-      dummy = _clutter_dummy_node_new (self, framebuffer);
-      clutter_paint_node_set_static_name (dummy, "Root");
+      paint_opacity = clutter_actor_get_paint_opacity_internal (self);
 
-      /* XXX - for 1.12, we use the return value of paint_node() to
-       * decide whether we should call the paint() vfunc.
-       */
-      clutter_actor_paint_node (self, dummy, paint_context);
-      clutter_paint_node_unref (dummy);
+      if (priv->retained_paint_node &&
+          priv->retained_paint_framebuffer == framebuffer &&
+          priv->retained_paint_opacity == paint_opacity)
+        {
+          /* Nothing queued a redraw on us since the nodes were built */
+          if (clutter_paint_node_get_n_children (priv->retained_paint_node) > 0)
+            clutter_paint_node_paint (priv->retained_paint_node, paint_context);
+        }
+      else
+        {
+          /* XXX - this will go away in 2.0, when we can get rid of this
+           * stuff and switch to a pure retained render tree of PaintNodes
+           * for the entire frame, starting from the Stage; the paint()
+           * virtual function can then be called directly.
+           */
+          dummy = _clutter_dummy_node_new (self, framebuffer);
+          clutter_paint_node_set_static_name (dummy, "Root");
+
+          /* XXX - for 1.12, we use the return value of paint_node() to
+           * decide whether we should call the paint() vfunc.
+           */
+          clutter_actor_paint_node (self, dummy, paint_context);
+
+          if (priv->retain_paint_nodes)
+            {
+              clutter_actor_clear_retained_paint_node (self);
+              priv->retained_paint_node = dummy;
+              priv->retained_paint_framebuffer = framebuffer;
+              priv->retained_paint_opacity = paint_opacity;
+            }
+          else
+            {
+              clutter_paint_node_unref (dummy);
+            }
+        }
 
       CLUTTER_ACTOR_GET_CLASS (self)->paint (self, paint_context);
     }
@@ -3770,7 +3955,19 @@ clutter_actor_pick (ClutterActor       *actor,
         _clutter_meta_group_peek_metas (priv->effects);
     }
 
-  clutter_actor_continue_pick (actor, pick_context);
+  if (G_UNLIKELY (clutter_paint_debug_flags & CLUTTER_DEBUG_ACTOR_COSTS))
+    {
+      ClutterStage *stage =
+        CLUTTER_STAGE (_clutter_actor_get_stage_internal (actor));
+
+      clutter_stage_push_actor_cost (stage);
+      clutter_actor_continue_pick (actor, pick_context);
+      clutter_stage_pop_actor_cost (stage, actor, TRUE);
+    }
+  else
+    {
+      clutter_actor_continue_pick (actor, pick_context);
+    }
 
   if (clip_set)
     clutter_pick_context_pop_clip (pick_context);
@@ -4144,7 +4341,7 @@ clutter_actor_set_pivot_point_internal (ClutterActor           *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 }
 
 static inline void
@@ -4160,7 +4357,7 @@ clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 }
 
 /*< private >
@@ -4192,7 +4389,7 @@ clutter_actor_set_translation_internal (ClutterActor *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
   g_object_notify_by_pspec (obj, pspec);
 }
 
@@ -4321,7 +4518,7 @@ clutter_actor_set_rotation_angle_internal (ClutterActor *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), pspec);
 }
@@ -4442,7 +4639,7 @@ clutter_actor_set_scale_factor_internal (ClutterActor *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
   g_object_notify_by_pspec (obj, pspec);
 }
 
@@ -4499,6 +4696,7 @@ clutter_actor_set_clip_rect (ClutterActor          *self,
 
   queue_update_paint_volume (self);
   clutter_actor_queue_redraw (self);
+  clutter_actor_update_devices (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
   g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
@@ -5333,6 +5531,7 @@ clutter_actor_dispose (GObject *object)
 
   g_clear_pointer (&priv->stage_views, g_list_free);
   g_clear_pointer (&priv->next_redraw_clips, g_array_unref);
+  clutter_actor_clear_retained_paint_node (self);
 
   G_OBJECT_CLASS (clutter_actor_parent_class)->dispose (object);
 }
@@ -7354,6 +7553,7 @@ clutter_actor_init (ClutterActor *self)
 
   priv->cached_width_age = 1;
   priv->cached_height_age = 1;
+  priv->size_request_stamp = ++size_request_stamp_counter;
 
   priv->opacity_override = -1;
   priv->enable_model_view_transform = TRUE;
@@ -7438,6 +7638,16 @@ void
 _clutter_actor_queue_redraw_full (ClutterActor             *self,
                                   const ClutterPaintVolume *volume,
                                   ClutterEffect            *effect)
+{
+  clutter_actor_clear_retained_paint_node (self);
+
+  queue_redraw_internal (self, volume, effect);
+}
+
+static void
+queue_redraw_internal (ClutterActor             *self,
+                       const ClutterPaintVolume *volume,
+                       ClutterEffect            *effect)
 {
   ClutterActorPrivate *priv = self->priv;
   ClutterActor *stage;
@@ -9120,6 +9330,7 @@ clutter_actor_set_request_mode (ClutterActor       *self,
 
   priv->needs_width_request = TRUE;
   priv->needs_height_request = TRUE;
+  priv->size_request_stamp = ++size_request_stamp_counter;
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_REQUEST_MODE]);
 
@@ -10276,6 +10487,56 @@ clutter_actor_get_offscreen_redirect (ClutterActor *self)
   return self->priv->offscreen_redirect;
 }
 
+/**
+ * clutter_actor_set_retain_paint_nodes:
+ * @self: A #ClutterActor
+ * @retain: whether to retain the paint nodes between frames
+ *
+ * Sets whether the paint nodes created for @self itself, through its
+ * background color, its [iface@Clutter.Content] and the
+ * [vfunc@Clutter.Actor.paint_node] virtual function, are kept after
+ * painting and reused for the following paints.
+ *
+ * The retained nodes are discarded whenever a redraw is queued on @self,
+ * its size changes, or it is painted into a different framebuffer or with
+ * a different paint opacity. This is only correct for actors whose nodes
+ * depend on nothing else, so it is disabled by default.
+ */
+void
+clutter_actor_set_retain_paint_nodes (ClutterActor *self,
+                                      gboolean      retain)
+{
+  ClutterActorPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  priv = self->priv;
+
+  if (priv->retain_paint_nodes == !!retain)
+    return;
+
+  priv->retain_paint_nodes = !!retain;
+
+  if (!priv->retain_paint_nodes)
+    clutter_actor_clear_retained_paint_node (self);
+}
+
+/**
+ * clutter_actor_get_retain_paint_nodes:
+ * @self: A #ClutterActor
+ *
+ * Retrieves whether @self retains its paint nodes between frames.
+ *
+ * Return value: %TRUE if the paint nodes are retained
+ */
+gboolean
+clutter_actor_get_retain_paint_nodes (ClutterActor *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
+
+  return self->priv->retain_paint_nodes;
+}
+
 /**
  * clutter_actor_set_name:
  * @self: A #ClutterActor
@@ -10327,7 +10588,7 @@ clutter_actor_set_z_position_internal (ClutterActor *self,
 
       transform_changed (self);
 
-      clutter_actor_queue_redraw (self);
+      queue_redraw_for_transform (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_Z_POSITION]);
     }
@@ -10511,6 +10772,7 @@ clutter_actor_set_clip (ClutterActor *self,
 
   queue_update_paint_volume (self);
   clutter_actor_queue_redraw (self);
+  clutter_actor_update_devices (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_CLIP_RECT]);
   g_object_notify_by_pspec (obj, obj_props[PROP_HAS_CLIP]);
@@ -10534,6 +10796,7 @@ clutter_actor_remove_clip (ClutterActor *self)
 
   queue_update_paint_volume (self);
   clutter_actor_queue_redraw (self);
+  clutter_actor_update_devices (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_HAS_CLIP]);
 }
@@ -12221,11 +12484,86 @@ clutter_actor_set_final_state (ClutterAnimatable *animatable,
         }
     }
 
-  clutter_actor_update_devices (actor);
-
   g_free (p_name);
 }
 
+/*< private >
+ * clutter_actor_interpolate_final_state:
+ * @actor: a #ClutterActor
+ * @pspec: the #GParamSpec of an animatable property of #ClutterActor
+ * @interval: a valid #ClutterInterval
+ * @progress: the progress of the transition
+ *
+ * Interpolates @interval and sets the result as the value of @pspec,
+ * like clutter_animatable_interpolate_value() followed by
+ * clutter_animatable_set_final_state() would, but without resolving
+ * the property name again on every frame of a transition.
+ *
+ * This is only done for floating point properties of #ClutterActor
+ * itself, and only if neither the #ClutterAnimatable implementation nor
+ * the interval have been overridden.
+ *
+ * Return value: %TRUE if the value was set, %FALSE if the caller has to
+ *   go through the #ClutterAnimatable interface instead
+ */
+gboolean
+clutter_actor_interpolate_final_state (ClutterActor    *actor,
+                                       GParamSpec      *pspec,
+                                       ClutterInterval *interval,
+                                       double           progress)
+{
+  ClutterAnimatableInterface *iface = CLUTTER_ANIMATABLE_GET_IFACE (actor);
+  GType value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
+  GValue value = G_VALUE_INIT;
+  GValue *initial, *final;
+
+  if (iface->set_final_state != clutter_actor_set_final_state ||
+      iface->interpolate_value != NULL)
+    return FALSE;
+
+  if (pspec->owner_type != CLUTTER_TYPE_ACTOR ||
+      (pspec->flags & CLUTTER_PARAM_ANIMATABLE) == 0)
+    return FALSE;
+
+  if (G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL ||
+      clutter_interval_get_value_type (interval) != value_type)
+    return FALSE;
+
+  initial = clutter_interval_peek_initial_value (interval);
+  final = clutter_interval_peek_final_value (interval);
+
+  g_value_init (&value, value_type);
+
+  switch (value_type)
+    {
+    case G_TYPE_FLOAT:
+      {
+        double ia = g_value_get_float (initial);
+        double ib = g_value_get_float (final);
+
+        g_value_set_float (&value, (progress * (ib - ia)) + ia);
+      }
+      break;
+
+    case G_TYPE_DOUBLE:
+      {
+        double ia = g_value_get_double (initial);
+        double ib = g_value_get_double (final);
+
+        g_value_set_double (&value, (progress * (ib - ia)) + ia);
+      }
+      break;
+
+    default:
+      g_value_unset (&value);
+      return FALSE;
+    }
+
+  clutter_actor_set_animatable_property (actor, pspec->param_id, &value, pspec);
+
+  return TRUE;
+}
+
 static ClutterActor *
 clutter_actor_get_actor (ClutterAnimatable *animatable)
 {
@@ -13277,7 +13615,7 @@ clutter_actor_set_transform_internal (ClutterActor            *self,
 
   transform_changed (self);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_TRANSFORM]);
 
@@ -14010,6 +14348,7 @@ clutter_actor_set_clip_to_allocation (ClutterActor *self,
 
       queue_update_paint_volume (self);
       clutter_actor_queue_redraw (self);
+      clutter_actor_update_devices (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CLIP_TO_ALLOCATION]);
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_HAS_CLIP]);
@@ -14572,6 +14911,20 @@ clutter_actor_clear_stage_views_recursive (ClutterActor *self,
                            NULL);
 }
 
+/*
+ * clutter_actor_get_size_request_stamp:
+ * @self: a #ClutterActor
+ *
+ * Returns a value that changes every time the preferred size of @self may
+ * have changed. Layout managers can compare it against a previously seen
+ * value to know whether a cached size request is still valid.
+ */
+guint64
+clutter_actor_get_size_request_stamp (ClutterActor *self)
+{
+  return self->priv->size_request_stamp;
+}
+
 float
 clutter_actor_get_real_resource_scale (ClutterActor *self)
 {
@@ -17870,7 +18223,7 @@ clutter_actor_set_child_transform_internal (ClutterActor            *self,
   while (clutter_actor_iter_next (&iter, &child))
     transform_changed (child);
 
-  clutter_actor_queue_redraw (self);
+  queue_redraw_for_transform (self);
 
   obj = G_OBJECT (self);
   g_object_notify_by_pspec (obj, obj_props[PROP_CHILD_TRANSFORM]);
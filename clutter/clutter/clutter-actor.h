@@ -522,6 +522,11 @@ void                            clutter_actor_set_offscreen_redirect
 CLUTTER_EXPORT
 ClutterOffscreenRedirect        clutter_actor_get_offscreen_redirect            (ClutterActor               *self);
 CLUTTER_EXPORT
+void                            clutter_actor_set_retain_paint_nodes            (ClutterActor               *self,
+                                                                                 gboolean                    retain);
+CLUTTER_EXPORT
+gboolean                        clutter_actor_get_retain_paint_nodes            (ClutterActor               *self);
+CLUTTER_EXPORT
 gboolean                        clutter_actor_should_pick                       (ClutterActor               *self,
                                                                                  ClutterPickContext         *pick_context);
 CLUTTER_EXPORT
@@ -118,6 +118,7 @@ clutter_backend_do_real_create_context (ClutterBackend  *backend,
                                         GError         **error)
 {
   ClutterBackendClass *klass;
+  g_autofree char *program_cache_dir = NULL;
   CoglSwapChain *swap_chain;
 
   klass = CLUTTER_BACKEND_GET_CLASS (backend);
@@ -183,6 +184,12 @@ clutter_backend_do_real_create_context (ClutterBackend  *backend,
   if (backend->cogl_context == NULL)
     goto error;
 
+  program_cache_dir = g_build_filename (g_get_user_cache_dir (),
+                                        "mutter", "programs",
+                                        NULL);
+  cogl_context_set_program_cache_dir (backend->cogl_context,
+                                      program_cache_dir);
+
   /* the display owns the renderer and the swap chain */
   g_object_unref (backend->cogl_renderer);
   g_object_unref (swap_chain);
@@ -19,17 +19,23 @@
 
 #include <glib-object.h>
 
+#include "clutter/clutter-enums.h"
 #include "cogl/cogl.h"
+#include "mtk/mtk.h"
 
 G_BEGIN_DECLS
 
 typedef struct _ClutterBlur ClutterBlur;
 
-ClutterBlur * clutter_blur_new (CoglTexture *texture,
-                                float        radius);
+ClutterBlur * clutter_blur_new (CoglTexture     *texture,
+                                float            radius,
+                                ClutterBlurMode  mode);
 
 void clutter_blur_apply (ClutterBlur *blur);
 
+void clutter_blur_apply_region (ClutterBlur        *blur,
+                                const MtkRectangle *area);
+
 CoglTexture * clutter_blur_get_texture (ClutterBlur *blur);
 
 void clutter_blur_free (ClutterBlur *blur);
@@ -65,6 +65,22 @@
  *
  * https://developer.nvidia.com/gpugems/GPUGems3/gpugems3_ch40.html
  *
+ * # Dual filter
+ *
+ * When created with %CLUTTER_BLUR_MODE_DUAL_FILTER, #ClutterBlur instead
+ * runs a chain of downsampling passes, each halving the size of the
+ * previous one, followed by the same number of upsampling passes back to
+ * the size of the source texture. Every pass takes a handful of bilinear
+ * samples around each pixel, and the reach of the blur doubles with every
+ * level, so large radii only cost a few more passes on small textures.
+ * This is the filter described by M. Bjørge in "Bandwidth-Efficient
+ * Rendering" (SIGGRAPH 2015).
+ *
+ * # Partial updates
+ *
+ * [method@Clutter.Blur.apply_region] only processes the part of each pass
+ * needed to produce the blurred contents of the given area; the rest of
+ * the resulting texture is left undefined.
  */
 
 static const char *gaussian_blur_glsl_declarations =
@@ -106,9 +122,44 @@ static const char *gaussian_blur_glsl =
 "                                                                          \n"
 "  cogl_texel = ret / gauss_coefficient_total;                             \n";
 
+static const char *dual_filter_glsl_declarations =
+"uniform vec2 half_pixel;                                                  \n"
+"uniform float offset;                                                     \n";
+
+static const char *dual_filter_downsample_glsl =
+"  vec2 uv = vec2 (cogl_tex_coord.st);                                     \n"
+"  vec2 o = half_pixel * offset;                                           \n"
+"                                                                          \n"
+"  vec4 ret = texture2D (cogl_sampler, uv) * 4.0;                          \n"
+"  ret += texture2D (cogl_sampler, uv - o);                                \n"
+"  ret += texture2D (cogl_sampler, uv + o);                                \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (o.x, -o.y));                 \n"
+"  ret += texture2D (cogl_sampler, uv - vec2 (o.x, -o.y));                 \n"
+"                                                                          \n"
+"  cogl_texel = ret / 8.0;                                                 \n";
+
+static const char *dual_filter_upsample_glsl =
+"  vec2 uv = vec2 (cogl_tex_coord.st);                                     \n"
+"  vec2 o = half_pixel * offset;                                           \n"
+"                                                                          \n"
+"  vec4 ret = texture2D (cogl_sampler, uv + vec2 (-o.x * 2.0, 0.0));       \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (-o.x, o.y)) * 2.0;           \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (0.0, o.y * 2.0));            \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (o.x, o.y)) * 2.0;            \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (o.x * 2.0, 0.0));            \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (o.x, -o.y)) * 2.0;           \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (0.0, -o.y * 2.0));           \n"
+"  ret += texture2D (cogl_sampler, uv + vec2 (-o.x, -o.y)) * 2.0;          \n"
+"                                                                          \n"
+"  cogl_texel = ret / 12.0;                                                \n";
+
 #define MIN_DOWNSCALE_SIZE 256.f
 #define MAX_SIGMA 6.f
 
+#define MAX_DUAL_FILTER_ITERATIONS 6
+#define MIN_DUAL_FILTER_SIZE 8
+#define MAX_DUAL_FILTER_OFFSET 2.f
+
 enum
 {
   VERTICAL,
@@ -126,22 +177,28 @@ typedef struct
 struct _ClutterBlur
 {
   CoglTexture *source_texture;
+  ClutterBlurMode mode;
   float sigma;
   float downscale_factor;
 
   BlurPass pass[2];
+
+  int n_iterations;
+  float offset;
+  BlurPass down_pass[MAX_DUAL_FILTER_ITERATIONS];
+  BlurPass up_pass[MAX_DUAL_FILTER_ITERATIONS];
 };
 
 static CoglPipeline*
-create_blur_pipeline (void)
+create_pipeline_from_snippet (CoglPipelineKey *key,
+                              const char      *declarations,
+                              const char      *source)
 {
-  static CoglPipelineKey blur_pipeline_key = "clutter-blur-pipeline-private";
   CoglContext *ctx =
     clutter_backend_get_cogl_context (clutter_get_default_backend ());
   CoglPipeline *blur_pipeline;
 
-  blur_pipeline =
-    cogl_context_get_named_pipeline (ctx, &blur_pipeline_key);
+  blur_pipeline = cogl_context_get_named_pipeline (ctx, key);
 
   if (G_UNLIKELY (blur_pipeline == NULL))
     {
@@ -158,18 +215,50 @@ create_blur_pipeline (void)
                                          COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
 
       snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
-                                  gaussian_blur_glsl_declarations,
+                                  declarations,
                                   NULL);
-      cogl_snippet_set_replace (snippet, gaussian_blur_glsl);
+      cogl_snippet_set_replace (snippet, source);
       cogl_pipeline_add_layer_snippet (blur_pipeline, 0, snippet);
       g_object_unref (snippet);
 
-      cogl_context_set_named_pipeline (ctx, &blur_pipeline_key, blur_pipeline);
+      cogl_context_set_named_pipeline (ctx, key, blur_pipeline);
     }
 
   return cogl_pipeline_copy (blur_pipeline);
 }
 
+static CoglPipeline*
+create_blur_pipeline (void)
+{
+  static CoglPipelineKey blur_pipeline_key = "clutter-blur-pipeline-private";
+
+  return create_pipeline_from_snippet (&blur_pipeline_key,
+                                       gaussian_blur_glsl_declarations,
+                                       gaussian_blur_glsl);
+}
+
+static CoglPipeline*
+create_dual_filter_pipeline (gboolean downsample)
+{
+  static CoglPipelineKey downsample_pipeline_key =
+    "clutter-blur-dual-filter-downsample-pipeline-private";
+  static CoglPipelineKey upsample_pipeline_key =
+    "clutter-blur-dual-filter-upsample-pipeline-private";
+
+  if (downsample)
+    {
+      return create_pipeline_from_snippet (&downsample_pipeline_key,
+                                           dual_filter_glsl_declarations,
+                                           dual_filter_downsample_glsl);
+    }
+  else
+    {
+      return create_pipeline_from_snippet (&upsample_pipeline_key,
+                                           dual_filter_glsl_declarations,
+                                           dual_filter_upsample_glsl);
+    }
+}
+
 static void
 update_blur_uniforms (ClutterBlur *blur,
                       BlurPass    *pass)
@@ -220,39 +309,82 @@ update_blur_uniforms (ClutterBlur *blur,
     }
 }
 
-static gboolean
-create_fbo (ClutterBlur *blur,
-            BlurPass    *pass)
+static void
+update_dual_filter_uniforms (ClutterBlur *blur,
+                             BlurPass    *pass,
+                             CoglTexture *input)
+{
+  int half_pixel_uniform;
+  int offset_uniform;
+
+  half_pixel_uniform =
+    cogl_pipeline_get_uniform_location (pass->pipeline, "half_pixel");
+  if (half_pixel_uniform > -1)
+    {
+      float half_pixel[2] = {
+        0.5f / cogl_texture_get_width (input),
+        0.5f / cogl_texture_get_height (input),
+      };
+
+      cogl_pipeline_set_uniform_float (pass->pipeline,
+                                       half_pixel_uniform,
+                                       2, 1,
+                                       half_pixel);
+    }
+
+  offset_uniform = cogl_pipeline_get_uniform_location (pass->pipeline,
+                                                       "offset");
+  if (offset_uniform > -1)
+    {
+      cogl_pipeline_set_uniform_1f (pass->pipeline,
+                                    offset_uniform,
+                                    blur->offset);
+    }
+}
+
+static void
+release_fbo (BlurPass *pass)
 {
   CoglContext *ctx =
     clutter_backend_get_cogl_context (clutter_get_default_backend ());
-  float scaled_height;
-  float scaled_width;
-  float height;
-  float width;
 
   g_clear_object (&pass->texture);
-  g_clear_object (&pass->framebuffer);
 
-  width = cogl_texture_get_width (blur->source_texture);
-  height = cogl_texture_get_height (blur->source_texture);
-  scaled_width = floorf (width / blur->downscale_factor);
-  scaled_height = floorf (height / blur->downscale_factor);
+  if (pass->framebuffer)
+    {
+      cogl_context_release_offscreen (ctx,
+                                      COGL_OFFSCREEN (g_steal_pointer (&pass->framebuffer)),
+                                      COGL_PIXEL_FORMAT_ANY);
+    }
+}
 
-  pass->texture = cogl_texture_2d_new_with_size (ctx,
-                                                 scaled_width,
-                                                 scaled_height);
-  if (!pass->texture)
-    return FALSE;
+static gboolean
+create_fbo (BlurPass *pass,
+            float     scaled_width,
+            float     scaled_height)
+{
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  CoglOffscreen *offscreen;
+  g_autoptr (GError) error = NULL;
 
-  pass->framebuffer =
-    COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (pass->texture));
-  if (!pass->framebuffer)
+  release_fbo (pass);
+
+  offscreen = cogl_context_acquire_offscreen (ctx,
+                                              scaled_width,
+                                              scaled_height,
+                                              COGL_PIXEL_FORMAT_ANY,
+                                              &error);
+  if (!offscreen)
     {
-      g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+      g_warning ("%s: Unable to create an Offscreen buffer: %s",
+                 G_STRLOC, error->message);
       return FALSE;
     }
 
+  pass->framebuffer = COGL_FRAMEBUFFER (offscreen);
+  pass->texture = g_object_ref (cogl_offscreen_get_texture (offscreen));
+
   cogl_framebuffer_orthographic (pass->framebuffer,
                                  0.0, 0.0,
                                  scaled_width,
@@ -267,17 +399,74 @@ setup_blur_pass (ClutterBlur *blur,
                  int          orientation,
                  CoglTexture *texture)
 {
+  float width = cogl_texture_get_width (blur->source_texture);
+  float height = cogl_texture_get_height (blur->source_texture);
+
   pass->orientation = orientation;
   pass->pipeline = create_blur_pipeline ();
   cogl_pipeline_set_layer_texture (pass->pipeline, 0, texture);
 
-  if (!create_fbo (blur, pass))
+  if (!create_fbo (pass,
+                   floorf (width / blur->downscale_factor),
+                   floorf (height / blur->downscale_factor)))
     return FALSE;
 
   update_blur_uniforms (blur, pass);
   return TRUE;
 }
 
+static gboolean
+setup_dual_filter_passes (ClutterBlur *blur)
+{
+  CoglTexture *input = blur->source_texture;
+  int width = cogl_texture_get_width (blur->source_texture);
+  int height = cogl_texture_get_height (blur->source_texture);
+  int i;
+
+  for (i = 0; i < blur->n_iterations; i++)
+    {
+      BlurPass *pass = &blur->down_pass[i];
+
+      if (!create_fbo (pass,
+                       MAX (width >> (i + 1), 1),
+                       MAX (height >> (i + 1), 1)))
+        return FALSE;
+
+      pass->pipeline = create_dual_filter_pipeline (TRUE);
+      cogl_pipeline_set_layer_texture (pass->pipeline, 0, input);
+      update_dual_filter_uniforms (blur, pass, input);
+
+      input = pass->texture;
+    }
+
+  for (i = blur->n_iterations - 1; i >= 0; i--)
+    {
+      BlurPass *pass = &blur->up_pass[i];
+
+      if (i == 0)
+        {
+          if (!create_fbo (pass, width, height))
+            return FALSE;
+        }
+      else
+        {
+          /* The downsampled contents of a level have been consumed by the
+           * time the upsampling passes get back to it, so reuse it.
+           */
+          pass->texture = g_object_ref (blur->down_pass[i - 1].texture);
+          pass->framebuffer = g_object_ref (blur->down_pass[i - 1].framebuffer);
+        }
+
+      pass->pipeline = create_dual_filter_pipeline (FALSE);
+      cogl_pipeline_set_layer_texture (pass->pipeline, 0, input);
+      update_dual_filter_uniforms (blur, pass, input);
+
+      input = pass->texture;
+    }
+
+  return TRUE;
+}
+
 static float
 calculate_downscale_factor (float width,
                             float height,
@@ -306,44 +495,127 @@ calculate_downscale_factor (float width,
   return downscale_factor;
 }
 
+static int
+calculate_dual_filter_iterations (int    width,
+                                  int    height,
+                                  float  radius,
+                                  float *offset)
+{
+  int n_iterations = 1;
+
+  /* Every level doubles the reach of the samples; keep adding levels until
+   * the sampling offset needed for the radius is small enough to not leave
+   * artifacts, or the smallest level would get too small.
+   */
+  while (n_iterations < MAX_DUAL_FILTER_ITERATIONS &&
+         radius / (1 << (n_iterations + 1)) > MAX_DUAL_FILTER_OFFSET &&
+         (width >> (n_iterations + 1)) >= MIN_DUAL_FILTER_SIZE &&
+         (height >> (n_iterations + 1)) >= MIN_DUAL_FILTER_SIZE)
+    n_iterations++;
+
+  *offset = radius / (1 << (n_iterations + 1));
+
+  return n_iterations;
+}
+
+static int
+calculate_blur_extent (ClutterBlur *blur)
+{
+  int extent = 0;
+  int i;
+
+  switch (blur->mode)
+    {
+    case CLUTTER_BLUR_MODE_GAUSSIAN:
+      /* Samples reach n_steps + 1 downscaled pixels away in each direction,
+       * plus one for the filtering when downscaling.
+       */
+      extent = ceilf ((ceilf (1.5f * blur->sigma / blur->downscale_factor) *
+                       2.f + 2.f) * blur->downscale_factor);
+      break;
+
+    case CLUTTER_BLUR_MODE_DUAL_FILTER:
+      /* Both passes of a level sample up to twice the offset away, in pixels
+       * of the smaller of the two levels.
+       */
+      for (i = 0; i < blur->n_iterations; i++)
+        extent += 2 * (((int) ceilf (blur->offset) + 2) << (i + 1));
+      break;
+    }
+
+  return extent;
+}
+
 static void
-apply_blur_pass (BlurPass *pass)
+apply_blur_pass (ClutterBlur        *blur,
+                 BlurPass           *pass,
+                 const MtkRectangle *area)
 {
+  float width = cogl_texture_get_width (pass->texture);
+  float height = cogl_texture_get_height (pass->texture);
+  float x1 = 0.f, y1 = 0.f, x2 = width, y2 = height;
   CoglColor transparent;
 
+  if (area)
+    {
+      float scale_x = width / cogl_texture_get_width (blur->source_texture);
+      float scale_y = height / cogl_texture_get_height (blur->source_texture);
+
+      x1 = CLAMP (floorf (area->x * scale_x), 0.f, width);
+      y1 = CLAMP (floorf (area->y * scale_y), 0.f, height);
+      x2 = CLAMP (ceilf ((area->x + area->width) * scale_x), 0.f, width);
+      y2 = CLAMP (ceilf ((area->y + area->height) * scale_y), 0.f, height);
+
+      if (x1 >= x2 || y1 >= y2)
+        return;
+
+      cogl_framebuffer_push_rectangle_clip (pass->framebuffer,
+                                            x1, y1, x2, y2);
+    }
+
+  cogl_framebuffer_push_gpu_trace (pass->framebuffer,
+                                   "GPU::Clutter::Blur::apply_pass()",
+                                   NULL);
+
   cogl_color_init_from_4ub (&transparent, 0, 0, 0, 0);
 
   cogl_framebuffer_clear (pass->framebuffer,
                           COGL_BUFFER_BIT_COLOR,
                           &transparent);
 
-  cogl_framebuffer_draw_rectangle (pass->framebuffer,
-                                   pass->pipeline,
-                                   0, 0,
-                                   cogl_texture_get_width (pass->texture),
-                                   cogl_texture_get_height (pass->texture));
+  cogl_framebuffer_draw_textured_rectangle (pass->framebuffer,
+                                            pass->pipeline,
+                                            x1, y1, x2, y2,
+                                            x1 / width, y1 / height,
+                                            x2 / width, y2 / height);
+
+  cogl_framebuffer_pop_gpu_trace (pass->framebuffer);
+
+  if (area)
+    cogl_framebuffer_pop_clip (pass->framebuffer);
 }
 
 static void
 clear_blur_pass (BlurPass *pass)
 {
   g_clear_object (&pass->pipeline);
-  g_clear_object (&pass->texture);
-  g_clear_object (&pass->framebuffer);
+  release_fbo (pass);
 }
 
 /**
  * clutter_blur_new:
  * @texture: a #CoglTexture
  * @sigma: blur sigma
+ * @mode: the blur algorithm to use
  *
  * Creates a new #ClutterBlur.
  *
  * Returns: (transfer full) (nullable): A newly created #ClutterBlur
  */
 ClutterBlur *
-clutter_blur_new (CoglTexture *texture,
-                  float        radius)
+clutter_blur_new (CoglTexture     *texture,
+                  float            radius,
+                  ClutterBlurMode  mode)
 {
   ClutterBlur *blur;
   unsigned int height;
@@ -358,6 +630,7 @@ clutter_blur_new (CoglTexture *texture,
   height = cogl_texture_get_height (texture);
 
   blur = g_new0 (ClutterBlur, 1);
+  blur->mode = mode;
   blur->sigma = radius / 2.0;
   blur->source_texture = g_object_ref (texture);
   blur->downscale_factor = calculate_downscale_factor (width,
@@ -367,6 +640,22 @@ clutter_blur_new (CoglTexture *texture,
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     goto out;
 
+  if (mode == CLUTTER_BLUR_MODE_DUAL_FILTER)
+    {
+      blur->n_iterations = calculate_dual_filter_iterations (width,
+                                                             height,
+                                                             radius,
+                                                             &blur->offset);
+
+      if (!setup_dual_filter_passes (blur))
+        {
+          clutter_blur_free (blur);
+          return NULL;
+        }
+
+      goto out;
+    }
+
   vpass = &blur->pass[VERTICAL];
   hpass = &blur->pass[HORIZONTAL];
 
@@ -391,11 +680,59 @@ out:
 void
 clutter_blur_apply (ClutterBlur *blur)
 {
+  clutter_blur_apply_region (blur, NULL);
+}
+
+/**
+ * clutter_blur_apply_region:
+ * @blur: a #ClutterBlur
+ * @area: (nullable): the area to blur, in pixels of the source texture
+ *
+ * Applies the blur, only doing the work needed to produce the blurred
+ * contents of @area. Outside of @area, the contents of the resulting
+ * texture are undefined. A %NULL @area is the same as
+ * [method@Clutter.Blur.apply].
+ */
+void
+clutter_blur_apply_region (ClutterBlur        *blur,
+                           const MtkRectangle *area)
+{
+  MtkRectangle padded_area;
+  int i;
+
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     return;
 
-  apply_blur_pass (&blur->pass[VERTICAL]);
-  apply_blur_pass (&blur->pass[HORIZONTAL]);
+  if (area)
+    {
+      int extent = calculate_blur_extent (blur);
+
+      /* Every pass only draws the padded area; what is left valid shrinks
+       * by the reach of each pass, down to the requested area at the end.
+       */
+      padded_area = (MtkRectangle) {
+        .x = area->x - extent,
+        .y = area->y - extent,
+        .width = area->width + 2 * extent,
+        .height = area->height + 2 * extent,
+      };
+      area = &padded_area;
+    }
+
+  switch (blur->mode)
+    {
+    case CLUTTER_BLUR_MODE_GAUSSIAN:
+      apply_blur_pass (blur, &blur->pass[VERTICAL], area);
+      apply_blur_pass (blur, &blur->pass[HORIZONTAL], area);
+      break;
+
+    case CLUTTER_BLUR_MODE_DUAL_FILTER:
+      for (i = 0; i < blur->n_iterations; i++)
+        apply_blur_pass (blur, &blur->down_pass[i], area);
+      for (i = blur->n_iterations - 1; i >= 0; i--)
+        apply_blur_pass (blur, &blur->up_pass[i], area);
+      break;
+    }
 }
 
 /**
@@ -412,6 +749,8 @@ clutter_blur_get_texture (ClutterBlur *blur)
 {
   if (G_APPROX_VALUE (blur->sigma, 0.0, FLT_EPSILON))
     return blur->source_texture;
+  else if (blur->mode == CLUTTER_BLUR_MODE_DUAL_FILTER)
+    return blur->up_pass[0].texture;
   else
     return blur->pass[HORIZONTAL].texture;
 }
@@ -425,10 +764,27 @@ clutter_blur_get_texture (ClutterBlur *blur)
 void
 clutter_blur_free (ClutterBlur *blur)
 {
+  int i;
+
   g_assert (blur);
 
+  /* Passes sample from each other, so drop all pipelines before handing
+   * back the offscreens, or they would still be in use */
+  g_clear_object (&blur->pass[VERTICAL].pipeline);
+  g_clear_object (&blur->pass[HORIZONTAL].pipeline);
+  for (i = 0; i < MAX_DUAL_FILTER_ITERATIONS; i++)
+    {
+      g_clear_object (&blur->down_pass[i].pipeline);
+      g_clear_object (&blur->up_pass[i].pipeline);
+    }
+
   clear_blur_pass (&blur->pass[VERTICAL]);
   clear_blur_pass (&blur->pass[HORIZONTAL]);
+  for (i = 0; i < MAX_DUAL_FILTER_ITERATIONS; i++)
+    {
+      clear_blur_pass (&blur->down_pass[i]);
+      clear_blur_pass (&blur->up_pass[i]);
+    }
   g_clear_object (&blur->source_texture);
   g_free (blur);
 }
@@ -55,6 +55,7 @@
 #include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-enum-types.h"
+#include "clutter/clutter-layout-manager-private.h"
 #include "clutter/clutter-layout-meta.h"
 #include "clutter/clutter-private.h"
 #include "clutter/clutter-types.h"
@@ -70,6 +71,8 @@ typedef struct _ClutterBoxLayoutPrivate
 
   ClutterOrientation orientation;
 
+  ClutterLayoutCache allocation_cache;
+
   guint is_homogeneous : 1;
 } ClutterBoxLayoutPrivate;
 
@@ -117,6 +120,7 @@ clutter_box_layout_set_container (ClutterLayoutManager *layout,
   ClutterLayoutManagerClass *parent_class;
 
   priv->container = container;
+  clutter_layout_cache_invalidate (&priv->allocation_cache);
 
   if (priv->container != NULL)
     {
@@ -640,6 +644,9 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
   gint x = 0, y = 0, i;
   gfloat child_size;
 
+  if (clutter_layout_cache_allocate (&priv->allocation_cache, container, box))
+    return;
+
   count_expand_children (layout, container, &nvis_children, &nexpand_children);
 
   CLUTTER_NOTE (LAYOUT, "BoxLayout for %s: visible=%d, expand=%d",
@@ -651,6 +658,8 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
   if (nvis_children <= 0)
     return;
 
+  clutter_layout_cache_begin (&priv->allocation_cache, container, box);
+
   sizes = g_newa (RequestedSize, nvis_children);
 
   if (priv->orientation == CLUTTER_ORIENTATION_VERTICAL)
@@ -849,6 +858,10 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
 
         }
 
+        clutter_layout_cache_add_child (&priv->allocation_cache,
+                                        child,
+                                        &child_allocation);
+
         allocate_box_child (CLUTTER_BOX_LAYOUT (layout),
                             container,
                             child,
@@ -856,6 +869,18 @@ clutter_box_layout_allocate (ClutterLayoutManager   *layout,
 
         i += 1;
     }
+
+  clutter_layout_cache_end (&priv->allocation_cache);
+}
+
+static void
+clutter_box_layout_layout_changed (ClutterLayoutManager *layout)
+{
+  ClutterBoxLayout *self = CLUTTER_BOX_LAYOUT (layout);
+  ClutterBoxLayoutPrivate *priv =
+    clutter_box_layout_get_instance_private (self);
+
+  clutter_layout_cache_invalidate (&priv->allocation_cache);
 }
 
 static void
@@ -916,6 +941,18 @@ clutter_box_layout_get_property (GObject    *gobject,
     }
 }
 
+static void
+clutter_box_layout_finalize (GObject *gobject)
+{
+  ClutterBoxLayout *self = CLUTTER_BOX_LAYOUT (gobject);
+  ClutterBoxLayoutPrivate *priv =
+    clutter_box_layout_get_instance_private (self);
+
+  clutter_layout_cache_clear (&priv->allocation_cache);
+
+  G_OBJECT_CLASS (clutter_box_layout_parent_class)->finalize (gobject);
+}
+
 static void
 clutter_box_layout_class_init (ClutterBoxLayoutClass *klass)
 {
@@ -928,6 +965,7 @@ clutter_box_layout_class_init (ClutterBoxLayoutClass *klass)
   layout_class->get_preferred_height = clutter_box_layout_get_preferred_height;
   layout_class->allocate = clutter_box_layout_allocate;
   layout_class->set_container = clutter_box_layout_set_container;
+  layout_class->layout_changed = clutter_box_layout_layout_changed;
 
   /**
    * ClutterBoxLayout:orientation:
@@ -965,6 +1003,7 @@ clutter_box_layout_class_init (ClutterBoxLayoutClass *klass)
                        G_PARAM_READWRITE |
                        G_PARAM_STATIC_STRINGS);
 
+  gobject_class->finalize = clutter_box_layout_finalize;
   gobject_class->set_property = clutter_box_layout_set_property;
   gobject_class->get_property = clutter_box_layout_get_property;
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
@@ -982,6 +1021,8 @@ clutter_box_layout_init (ClutterBoxLayout *self)
 
   priv->easing_mode = CLUTTER_EASE_OUT_CUBIC;
   priv->easing_duration = 500;
+
+  clutter_layout_cache_init (&priv->allocation_cache);
 }
 
 /**
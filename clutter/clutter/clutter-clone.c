@@ -33,14 +33,24 @@
  *
  * #ClutterClone does not require the presence of support for FBOs
  * in the underlying GL or GLES implementation.
+ *
+ * When [property@Clutter.Clone:cache-contents] is set, the source is
+ * instead painted into a texture at the size the clone is drawn at, and
+ * that texture is reused until the source is damaged. This bounds the
+ * cost of showing many small clones of large actors, such as window
+ * thumbnails.
  */
 
 #include "config.h"
 
+#include <math.h>
+
 #include "clutter/clutter-actor-private.h"
-#include "clutter/clutter-clone.h"
+#include "clutter/clutter-backend.h"
+#include "clutter/clutter-clone-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-main.h"
+#include "clutter/clutter-paint-context-private.h"
 #include "clutter/clutter-paint-volume-private.h"
 #include "clutter/clutter-private.h"
 
@@ -52,6 +62,11 @@ typedef struct _ClutterClonePrivate
   float x_scale, y_scale;
 
   gulong source_destroy_id;
+
+  gboolean cache_contents;
+  gboolean cache_valid;
+  CoglOffscreen *cache_framebuffer;
+  CoglPipeline *cache_pipeline;
 } ClutterClonePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterClone, clutter_clone, CLUTTER_TYPE_ACTOR)
@@ -61,6 +76,7 @@ enum
   PROP_0,
 
   PROP_SOURCE,
+  PROP_CACHE_CONTENTS,
 
   PROP_LAST
 };
@@ -134,19 +150,13 @@ clutter_clone_apply_transform (ClutterActor      *self,
 }
 
 static void
-clutter_clone_paint (ClutterActor        *actor,
-                     ClutterPaintContext *paint_context)
+paint_source (ClutterClone        *self,
+              ClutterPaintContext *paint_context,
+              uint8_t              opacity)
 {
-  ClutterClone *self = CLUTTER_CLONE (actor);
   ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
   gboolean was_unmapped = FALSE;
 
-  if (priv->clone_source == NULL)
-    return;
-
-  CLUTTER_NOTE (PAINT, "painting clone actor '%s'",
-                _clutter_actor_get_debug_name (actor));
-
   /* The final bits of magic:
    * - We need to override the paint opacity of the actor with our own
    *   opacity.
@@ -156,8 +166,7 @@ clutter_clone_paint (ClutterActor        *actor,
    *   the clone source actor.
    */
   _clutter_actor_set_in_clone_paint (priv->clone_source, TRUE);
-  clutter_actor_set_opacity_override (priv->clone_source,
-                                      clutter_actor_get_paint_opacity (actor));
+  clutter_actor_set_opacity_override (priv->clone_source, opacity);
   _clutter_actor_set_enable_model_view_transform (priv->clone_source, FALSE);
 
   if (!clutter_actor_is_mapped (priv->clone_source))
@@ -166,15 +175,9 @@ clutter_clone_paint (ClutterActor        *actor,
       was_unmapped = TRUE;
     }
 
-  /* If the source isn't ultimately parented to a toplevel, it can't be
-   * realized or painted.
-   */
-  if (clutter_actor_is_realized (priv->clone_source))
-    {
-      _clutter_actor_push_clone_paint ();
-      clutter_actor_paint (priv->clone_source, paint_context);
-      _clutter_actor_pop_clone_paint ();
-    }
+  _clutter_actor_push_clone_paint ();
+  clutter_actor_paint (priv->clone_source, paint_context);
+  _clutter_actor_pop_clone_paint ();
 
   if (was_unmapped)
     _clutter_actor_set_enable_paint_unmapped (priv->clone_source, FALSE);
@@ -184,6 +187,165 @@ clutter_clone_paint (ClutterActor        *actor,
   _clutter_actor_set_in_clone_paint (priv->clone_source, FALSE);
 }
 
+static void
+clear_cache (ClutterClone *self)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+
+  g_clear_object (&priv->cache_pipeline);
+  g_clear_object (&priv->cache_framebuffer);
+  priv->cache_valid = FALSE;
+}
+
+static gboolean
+update_cache (ClutterClone *self,
+              float         source_width,
+              float         source_height)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+  CoglFramebuffer *framebuffer;
+  ClutterPaintContext *cache_paint_context;
+  CoglColor clear_color;
+  float resource_scale;
+  int width, height;
+
+  /* Render at the size the clone is drawn at; the texture is mipmapped so
+   * that any further downscaling by ancestors still samples smoothly. */
+  resource_scale = clutter_actor_get_resource_scale (CLUTTER_ACTOR (self));
+  width = (int) ceilf (source_width * fabsf (priv->x_scale) * resource_scale);
+  height = (int) ceilf (source_height * fabsf (priv->y_scale) * resource_scale);
+  width = MAX (width, 1);
+  height = MAX (height, 1);
+
+  if (priv->cache_framebuffer)
+    {
+      CoglFramebuffer *cache_framebuffer =
+        COGL_FRAMEBUFFER (priv->cache_framebuffer);
+
+      if (cogl_framebuffer_get_width (cache_framebuffer) != width ||
+          cogl_framebuffer_get_height (cache_framebuffer) != height)
+        clear_cache (self);
+    }
+
+  if (!priv->cache_framebuffer)
+    {
+      CoglContext *ctx =
+        clutter_backend_get_cogl_context (clutter_get_default_backend ());
+      g_autoptr (CoglTexture) texture = NULL;
+      g_autoptr (CoglOffscreen) offscreen = NULL;
+      g_autoptr (GError) error = NULL;
+
+      texture = cogl_texture_2d_new_with_size (ctx, width, height);
+      cogl_primitive_texture_set_auto_mipmap (texture, TRUE);
+
+      offscreen = cogl_offscreen_new_with_texture (texture);
+      if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+        {
+          g_warning ("Failed to allocate clone cache: %s", error->message);
+          return FALSE;
+        }
+
+      priv->cache_pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_layer_texture (priv->cache_pipeline, 0, texture);
+      cogl_pipeline_set_layer_filters (priv->cache_pipeline, 0,
+                                       COGL_PIPELINE_FILTER_LINEAR_MIPMAP_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+      cogl_pipeline_set_layer_wrap_mode (priv->cache_pipeline, 0,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+      priv->cache_framebuffer = g_steal_pointer (&offscreen);
+    }
+
+  if (priv->cache_valid)
+    return TRUE;
+
+  framebuffer = COGL_FRAMEBUFFER (priv->cache_framebuffer);
+
+  cogl_color_init_from_4f (&clear_color, 0.f, 0.f, 0.f, 0.f);
+  cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0,
+                                 source_width, source_height,
+                                 -1.f, 1.f);
+
+  cache_paint_context =
+    clutter_paint_context_new_for_framebuffer (framebuffer, NULL,
+                                               CLUTTER_PAINT_FLAG_NONE);
+
+  clutter_actor_inhibit_culling (priv->clone_source);
+  paint_source (self, cache_paint_context, 255);
+  clutter_actor_uninhibit_culling (priv->clone_source);
+
+  clutter_paint_context_destroy (cache_paint_context);
+
+  priv->cache_valid = TRUE;
+
+  return TRUE;
+}
+
+static void
+paint_cached (ClutterClone        *self,
+              ClutterPaintContext *paint_context)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  CoglFramebuffer *framebuffer;
+  ClutterActorBox source_box;
+  float source_width, source_height;
+  uint8_t opacity;
+
+  clutter_actor_get_allocation_box (priv->clone_source, &source_box);
+  source_width = clutter_actor_box_get_width (&source_box);
+  source_height = clutter_actor_box_get_height (&source_box);
+
+  if (source_width <= 0.f || source_height <= 0.f)
+    return;
+
+  if (!update_cache (self, source_width, source_height))
+    {
+      paint_source (self, paint_context,
+                    clutter_actor_get_paint_opacity (actor));
+      return;
+    }
+
+  opacity = clutter_actor_get_paint_opacity (actor);
+  cogl_pipeline_set_color4ub (priv->cache_pipeline,
+                              opacity, opacity, opacity, opacity);
+
+  framebuffer = clutter_paint_context_get_framebuffer (paint_context);
+  cogl_framebuffer_draw_textured_rectangle (framebuffer,
+                                            priv->cache_pipeline,
+                                            0.f, 0.f,
+                                            source_width, source_height,
+                                            0.f, 0.f, 1.f, 1.f);
+}
+
+static void
+clutter_clone_paint (ClutterActor        *actor,
+                     ClutterPaintContext *paint_context)
+{
+  ClutterClone *self = CLUTTER_CLONE (actor);
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+
+  if (priv->clone_source == NULL)
+    return;
+
+  CLUTTER_NOTE (PAINT, "painting clone actor '%s'",
+                _clutter_actor_get_debug_name (actor));
+
+  /* If the source isn't ultimately parented to a toplevel, it can't be
+   * realized or painted.
+   */
+  if (!clutter_actor_is_realized (priv->clone_source))
+    return;
+
+  if (priv->cache_contents)
+    paint_cached (self, paint_context);
+  else
+    paint_source (self, paint_context,
+                  clutter_actor_get_paint_opacity (actor));
+}
+
 static gboolean
 clutter_clone_get_paint_volume (ClutterActor       *actor,
                                 ClutterPaintVolume *volume)
@@ -267,6 +429,7 @@ clutter_clone_allocate (ClutterActor           *self,
     {
       priv->x_scale = x_scale;
       priv->y_scale = y_scale;
+      priv->cache_valid = FALSE;
       clutter_actor_invalidate_transform (CLUTTER_ACTOR (self));
     }
 
@@ -301,6 +464,10 @@ clutter_clone_set_property (GObject      *gobject,
       clutter_clone_set_source (self, g_value_get_object (value));
       break;
 
+    case PROP_CACHE_CONTENTS:
+      clutter_clone_set_cache_contents (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -322,6 +489,10 @@ clutter_clone_get_property (GObject    *gobject,
       g_value_set_object (value, priv->clone_source);
       break;
 
+    case PROP_CACHE_CONTENTS:
+      g_value_set_boolean (value, priv->cache_contents);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -332,6 +503,7 @@ static void
 clutter_clone_dispose (GObject *gobject)
 {
   clutter_clone_set_source_internal (CLUTTER_CLONE (gobject), NULL);
+  clear_cache (CLUTTER_CLONE (gobject));
 
   G_OBJECT_CLASS (clutter_clone_parent_class)->dispose (gobject);
 }
@@ -366,6 +538,19 @@ clutter_clone_class_init (ClutterCloneClass *klass)
                          G_PARAM_READWRITE |
                          G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterClone:cache-contents:
+   *
+   * Whether the source is painted into a texture at the size of the
+   * clone, which is only updated when the source is damaged.
+   */
+  obj_props[PROP_CACHE_CONTENTS] =
+    g_param_spec_boolean ("cache-contents", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS |
+                          G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
 }
 
@@ -416,6 +601,8 @@ clutter_clone_set_source_internal (ClutterClone *self,
       priv->clone_source = NULL;
     }
 
+  clear_cache (self);
+
   if (source != NULL)
     {
       priv->clone_source = g_object_ref (source);
@@ -465,3 +652,65 @@ clutter_clone_get_source (ClutterClone *self)
   priv = clutter_clone_get_instance_private (self);
   return priv->clone_source;
 }
+
+/**
+ * clutter_clone_set_cache_contents:
+ * @self: a #ClutterClone
+ * @cache_contents: whether to cache the contents of the source
+ *
+ * Sets whether @self paints its source into a texture that is reused
+ * until the source is damaged, instead of painting the source every
+ * time @self is painted.
+ *
+ * The texture is rendered at the size @self is drawn at, so this is
+ * most useful for clones that are smaller than their source.
+ */
+void
+clutter_clone_set_cache_contents (ClutterClone *self,
+                                  gboolean      cache_contents)
+{
+  ClutterClonePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CLONE (self));
+
+  priv = clutter_clone_get_instance_private (self);
+
+  if (priv->cache_contents == cache_contents)
+    return;
+
+  priv->cache_contents = cache_contents;
+
+  if (!cache_contents)
+    clear_cache (self);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CACHE_CONTENTS]);
+}
+
+/**
+ * clutter_clone_get_cache_contents:
+ * @self: a #ClutterClone
+ *
+ * Retrieves whether @self caches the contents of its source.
+ *
+ * Return value: %TRUE if the contents are cached
+ */
+gboolean
+clutter_clone_get_cache_contents (ClutterClone *self)
+{
+  ClutterClonePrivate *priv;
+
+  g_return_val_if_fail (CLUTTER_IS_CLONE (self), FALSE);
+
+  priv = clutter_clone_get_instance_private (self);
+  return priv->cache_contents;
+}
+
+void
+clutter_clone_invalidate_contents (ClutterClone *self)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+
+  priv->cache_valid = FALSE;
+}
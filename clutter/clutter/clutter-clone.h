@@ -58,4 +58,10 @@ void            clutter_clone_set_source        (ClutterClone *self,
 CLUTTER_EXPORT
 ClutterActor *  clutter_clone_get_source        (ClutterClone *self);
 
+CLUTTER_EXPORT
+void            clutter_clone_set_cache_contents (ClutterClone *self,
+                                                  gboolean      cache_contents);
+CLUTTER_EXPORT
+gboolean        clutter_clone_get_cache_contents (ClutterClone *self);
+
 G_END_DECLS
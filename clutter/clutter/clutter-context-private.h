@@ -29,6 +29,9 @@ struct _ClutterContext
   ClutterStageManager *stage_manager;
 
   GAsyncQueue *events_queue;
+  /* The last event pushed onto events_queue while it is still queued,
+   * protected by the events_queue lock */
+  ClutterEvent *events_queue_tail;
 
   /* the event filters added via clutter_event_add_filter. these are
    * ordered from least recently added to most recently added */
@@ -31,6 +31,7 @@
 #include "clutter/clutter-settings-private.h"
 
 static gboolean clutter_disable_mipmap_text = FALSE;
+static gboolean clutter_enable_sdf_text = FALSE;
 static gboolean clutter_show_fps = FALSE;
 
 #ifdef CLUTTER_ENABLE_DEBUG
@@ -73,6 +74,9 @@ static const GDebugKey clutter_paint_debug_keys[] = {
   { "damage-region", CLUTTER_DEBUG_PAINT_DAMAGE_REGION },
   { "disable-dynamic-max-render-time", CLUTTER_DEBUG_DISABLE_DYNAMIC_MAX_RENDER_TIME },
   { "max-render-time", CLUTTER_DEBUG_PAINT_MAX_RENDER_TIME },
+  { "disable-triple-buffering", CLUTTER_DEBUG_DISABLE_TRIPLE_BUFFERING },
+  { "disable-motion-resampling", CLUTTER_DEBUG_DISABLE_MOTION_RESAMPLING },
+  { "actor-costs", CLUTTER_DEBUG_ACTOR_COSTS },
 };
 
 typedef struct _ClutterContextPrivate
@@ -242,6 +246,10 @@ init_clutter_debug (ClutterContext *context)
   env_string = g_getenv ("CLUTTER_DISABLE_MIPMAPPED_TEXT");
   if (env_string)
     clutter_disable_mipmap_text = TRUE;
+
+  env_string = g_getenv ("CLUTTER_ENABLE_SDF_TEXT");
+  if (env_string)
+    clutter_enable_sdf_text = TRUE;
 }
 
 ClutterContext *
@@ -303,6 +311,7 @@ clutter_context_get_pango_fontmap (ClutterContext *context)
 
   use_mipmapping = !clutter_disable_mipmap_text;
   cogl_pango_font_map_set_use_mipmapping (font_map, use_mipmapping);
+  cogl_pango_font_map_set_use_sdf (font_map, clutter_enable_sdf_text);
 
   context->font_map = font_map;
 
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterDamageTiles tracks damage as a fixed grid of tiles covering a
+ * stage view, one bit per tile. Adding damage costs at most one bit per
+ * covered tile no matter how many rectangles make up the damage, and
+ * converting back to a region yields at most one rectangle per run of
+ * damaged tiles in a row.
+ */
+
+#include "config.h"
+
+#include "clutter/clutter-damage-tiles.h"
+
+#include <string.h>
+
+#define BITS_PER_WORD 64
+
+struct _ClutterDamageTiles
+{
+  MtkRectangle layout;
+
+  int n_columns;
+  int n_rows;
+  int n_words_per_row;
+
+  int n_damaged_tiles;
+  uint64_t *bits;
+};
+
+ClutterDamageTiles *
+clutter_damage_tiles_new (const MtkRectangle *layout)
+{
+  ClutterDamageTiles *tiles;
+
+  tiles = g_new0 (ClutterDamageTiles, 1);
+  tiles->layout = *layout;
+  tiles->n_columns = (MAX (layout->width, 1) + CLUTTER_DAMAGE_TILE_SIZE - 1) /
+                     CLUTTER_DAMAGE_TILE_SIZE;
+  tiles->n_rows = (MAX (layout->height, 1) + CLUTTER_DAMAGE_TILE_SIZE - 1) /
+                  CLUTTER_DAMAGE_TILE_SIZE;
+  tiles->n_words_per_row = (tiles->n_columns + BITS_PER_WORD - 1) /
+                           BITS_PER_WORD;
+  tiles->bits = g_new0 (uint64_t, tiles->n_rows * tiles->n_words_per_row);
+
+  return tiles;
+}
+
+void
+clutter_damage_tiles_free (ClutterDamageTiles *tiles)
+{
+  g_free (tiles->bits);
+  g_free (tiles);
+}
+
+const MtkRectangle *
+clutter_damage_tiles_get_layout (ClutterDamageTiles *tiles)
+{
+  return &tiles->layout;
+}
+
+void
+clutter_damage_tiles_clear (ClutterDamageTiles *tiles)
+{
+  memset (tiles->bits, 0,
+          tiles->n_rows * tiles->n_words_per_row * sizeof (uint64_t));
+  tiles->n_damaged_tiles = 0;
+}
+
+static inline uint64_t
+bit_range_mask (int first_bit,
+                int last_bit)
+{
+  uint64_t mask;
+
+  mask = ~UINT64_C (0) << first_bit;
+  if (last_bit < BITS_PER_WORD - 1)
+    mask &= ~(~UINT64_C (0) << (last_bit + 1));
+
+  return mask;
+}
+
+void
+clutter_damage_tiles_add_rectangle (ClutterDamageTiles *tiles,
+                                    const MtkRectangle *rect)
+{
+  MtkRectangle clipped;
+  int first_column, last_column;
+  int first_row, last_row;
+  int row;
+
+  if (!mtk_rectangle_intersect (&tiles->layout, rect, &clipped))
+    return;
+
+  first_column = (clipped.x - tiles->layout.x) / CLUTTER_DAMAGE_TILE_SIZE;
+  last_column = (clipped.x + clipped.width - 1 - tiles->layout.x) /
+                CLUTTER_DAMAGE_TILE_SIZE;
+  first_row = (clipped.y - tiles->layout.y) / CLUTTER_DAMAGE_TILE_SIZE;
+  last_row = (clipped.y + clipped.height - 1 - tiles->layout.y) /
+             CLUTTER_DAMAGE_TILE_SIZE;
+
+  for (row = first_row; row <= last_row; row++)
+    {
+      uint64_t *row_bits = &tiles->bits[row * tiles->n_words_per_row];
+      int word;
+
+      for (word = first_column / BITS_PER_WORD;
+           word <= last_column / BITS_PER_WORD;
+           word++)
+        {
+          int word_first_column = word * BITS_PER_WORD;
+          uint64_t mask;
+
+          mask = bit_range_mask (MAX (first_column - word_first_column, 0),
+                                 MIN (last_column - word_first_column,
+                                      BITS_PER_WORD - 1));
+
+          tiles->n_damaged_tiles += __builtin_popcountll (mask & ~row_bits[word]);
+          row_bits[word] |= mask;
+        }
+    }
+}
+
+void
+clutter_damage_tiles_add_region (ClutterDamageTiles *tiles,
+                                 const MtkRegion    *region)
+{
+  int n_rects;
+  int i;
+
+  n_rects = mtk_region_num_rectangles (region);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (region, i);
+      clutter_damage_tiles_add_rectangle (tiles, &rect);
+    }
+}
+
+gboolean
+clutter_damage_tiles_is_empty (ClutterDamageTiles *tiles)
+{
+  return tiles->n_damaged_tiles == 0;
+}
+
+gboolean
+clutter_damage_tiles_is_full (ClutterDamageTiles *tiles)
+{
+  return tiles->n_damaged_tiles == tiles->n_columns * tiles->n_rows;
+}
+
+static inline gboolean
+is_tile_damaged (ClutterDamageTiles *tiles,
+                 int                 row,
+                 int                 column)
+{
+  uint64_t word = tiles->bits[row * tiles->n_words_per_row +
+                              column / BITS_PER_WORD];
+
+  return !!(word & (UINT64_C (1) << (column % BITS_PER_WORD)));
+}
+
+MtkRegion *
+clutter_damage_tiles_to_region (ClutterDamageTiles *tiles)
+{
+  g_autofree MtkRectangle *rects = NULL;
+  int n_rects = 0;
+  int row;
+
+  rects = g_new (MtkRectangle, (tiles->n_columns + 1) / 2 * tiles->n_rows + 1);
+
+  for (row = 0; row < tiles->n_rows; row++)
+    {
+      int column = 0;
+
+      while (column < tiles->n_columns)
+        {
+          MtkRectangle tile_rect;
+          MtkRectangle run_rect;
+          int first_column;
+
+          if (!is_tile_damaged (tiles, row, column))
+            {
+              column++;
+              continue;
+            }
+
+          first_column = column;
+          while (column < tiles->n_columns &&
+                 is_tile_damaged (tiles, row, column))
+            column++;
+
+          run_rect = (MtkRectangle) {
+            .x = tiles->layout.x + first_column * CLUTTER_DAMAGE_TILE_SIZE,
+            .y = tiles->layout.y + row * CLUTTER_DAMAGE_TILE_SIZE,
+            .width = (column - first_column) * CLUTTER_DAMAGE_TILE_SIZE,
+            .height = CLUTTER_DAMAGE_TILE_SIZE,
+          };
+
+          if (mtk_rectangle_intersect (&tiles->layout, &run_rect, &tile_rect))
+            rects[n_rects++] = tile_rect;
+        }
+    }
+
+  return mtk_region_create_rectangles (rects, n_rects);
+}
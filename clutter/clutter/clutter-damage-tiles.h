@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2024 Red Hat Inc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "clutter/clutter-macros.h"
+#include "mtk/mtk.h"
+
+#define CLUTTER_DAMAGE_TILE_SIZE 64
+
+typedef struct _ClutterDamageTiles ClutterDamageTiles;
+
+CLUTTER_EXPORT
+ClutterDamageTiles * clutter_damage_tiles_new (const MtkRectangle *layout);
+
+CLUTTER_EXPORT
+void clutter_damage_tiles_free (ClutterDamageTiles *tiles);
+
+CLUTTER_EXPORT
+const MtkRectangle * clutter_damage_tiles_get_layout (ClutterDamageTiles *tiles);
+
+CLUTTER_EXPORT
+void clutter_damage_tiles_clear (ClutterDamageTiles *tiles);
+
+CLUTTER_EXPORT
+void clutter_damage_tiles_add_rectangle (ClutterDamageTiles *tiles,
+                                         const MtkRectangle *rect);
+
+CLUTTER_EXPORT
+void clutter_damage_tiles_add_region (ClutterDamageTiles *tiles,
+                                      const MtkRegion    *region);
+
+CLUTTER_EXPORT
+gboolean clutter_damage_tiles_is_empty (ClutterDamageTiles *tiles);
+
+CLUTTER_EXPORT
+gboolean clutter_damage_tiles_is_full (ClutterDamageTiles *tiles);
+
+CLUTTER_EXPORT
+MtkRegion * clutter_damage_tiles_to_region (ClutterDamageTiles *tiles);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ClutterDamageTiles, clutter_damage_tiles_free)
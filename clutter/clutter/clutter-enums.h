@@ -1334,4 +1334,20 @@ typedef enum
                             CLUTTER_GRAB_STATE_KEYBOARD),
 } ClutterGrabState;
 
+/**
+ * ClutterBlurMode:
+ * @CLUTTER_BLUR_MODE_GAUSSIAN: Two pass gaussian blur, on a downscaled
+ *   copy of the contents for large radii
+ * @CLUTTER_BLUR_MODE_DUAL_FILTER: Dual filter blur, sampling through a
+ *   chain of downscaled and upscaled copies of the contents; cheaper than
+ *   the gaussian blur for large radii, at some cost in quality
+ *
+ * The algorithm used by a [class@BlurNode].
+ */
+typedef enum
+{
+  CLUTTER_BLUR_MODE_GAUSSIAN,
+  CLUTTER_BLUR_MODE_DUAL_FILTER,
+} ClutterBlurMode;
+
 G_END_DECLS
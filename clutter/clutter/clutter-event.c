@@ -958,16 +958,87 @@ clutter_event_get (void)
   ClutterContext *context = _clutter_context_get_default ();
   ClutterEvent *event;
 
-  event = g_async_queue_try_pop (context->events_queue);
+  g_async_queue_lock (context->events_queue);
+  event = g_async_queue_try_pop_unlocked (context->events_queue);
+  if (event == context->events_queue_tail)
+    context->events_queue_tail = NULL;
+  g_async_queue_unlock (context->events_queue);
 
   return event;
 }
 
+static gboolean
+can_coalesce_events (const ClutterEvent *queued,
+                     const ClutterEvent *event)
+{
+  if (queued->type != event->type)
+    return FALSE;
+
+  if (queued->any.device != event->any.device ||
+      queued->any.source_device != event->any.source_device ||
+      queued->any.flags != event->any.flags)
+    return FALSE;
+
+  if ((event->any.flags & CLUTTER_EVENT_FLAG_SYNTHETIC) != 0)
+    return FALSE;
+
+  switch (event->type)
+    {
+    case CLUTTER_MOTION:
+      return (queued->motion.tool == event->motion.tool &&
+              queued->motion.modifier_state == event->motion.modifier_state);
+    case CLUTTER_TOUCH_UPDATE:
+      return (queued->touch.sequence == event->touch.sequence &&
+              queued->touch.modifier_state == event->touch.modifier_state);
+    default:
+      return FALSE;
+    }
+}
+
+/* Folds @event into the @queued event that the main thread did not get to
+ * yet, the motion deltas are accumulated and everything else is taken from
+ * the newest event.
+ */
+static void
+coalesce_event (ClutterEvent *queued,
+                ClutterEvent *event)
+{
+  double *axes;
+
+  if (event->type == CLUTTER_MOTION)
+    {
+      queued->motion.time_us = event->motion.time_us;
+      queued->motion.x = event->motion.x;
+      queued->motion.y = event->motion.y;
+      queued->motion.dx += event->motion.dx;
+      queued->motion.dy += event->motion.dy;
+      queued->motion.dx_unaccel += event->motion.dx_unaccel;
+      queued->motion.dy_unaccel += event->motion.dy_unaccel;
+      queued->motion.dx_constrained += event->motion.dx_constrained;
+      queued->motion.dy_constrained += event->motion.dy_constrained;
+
+      axes = g_steal_pointer (&event->motion.axes);
+      g_free (queued->motion.axes);
+      queued->motion.axes = axes;
+    }
+  else
+    {
+      queued->touch.time_us = event->touch.time_us;
+      queued->touch.x = event->touch.x;
+      queued->touch.y = event->touch.y;
+
+      axes = g_steal_pointer (&event->touch.axes);
+      g_free (queued->touch.axes);
+      queued->touch.axes = axes;
+    }
+}
+
 void
 _clutter_event_push (const ClutterEvent *event,
                      gboolean            do_copy)
 {
   ClutterContext *context = _clutter_context_get_default ();
+  gboolean was_empty;
 
   g_assert (context != NULL);
 
@@ -979,8 +1050,32 @@ _clutter_event_push (const ClutterEvent *event,
       event = copy;
     }
 
-  g_async_queue_push (context->events_queue, (gpointer) event);
-  g_main_context_wakeup (NULL);
+  g_async_queue_lock (context->events_queue);
+
+  /* High rate devices can outpace a busy main thread, fold their motion
+   * into the event still waiting at the end of the queue instead of
+   * growing it. The stage compresses these events per frame anyway.
+   */
+  if (context->events_queue_tail &&
+      can_coalesce_events (context->events_queue_tail, event))
+    {
+      coalesce_event (context->events_queue_tail, (ClutterEvent *) event);
+      g_async_queue_unlock (context->events_queue);
+      clutter_event_free ((ClutterEvent *) event);
+      return;
+    }
+
+  was_empty = g_async_queue_length_unlocked (context->events_queue) <= 0;
+  g_async_queue_push_unlocked (context->events_queue, (gpointer) event);
+  context->events_queue_tail = (ClutterEvent *) event;
+  g_async_queue_unlock (context->events_queue);
+
+  /* A non-empty queue has already woken up the main context, and it keeps
+   * dispatching until the queue is drained, so only wake it up once per
+   * batch of events.
+   */
+  if (was_empty)
+    g_main_context_wakeup (NULL);
 }
 
 /**
@@ -37,6 +37,20 @@ static guint signals[N_SIGNALS];
 
 #define SYNC_DELAY_FALLBACK_FRACTION 0.875
 
+/* Number of frames the percentile estimator looks back at, and the fraction
+ * of those frames that must make it to their presentation time.
+ */
+#define UPDATE_DURATION_WINDOW_SIZE 128
+#define UPDATE_DURATION_PERCENTILE 0.98
+
+typedef enum _ClutterRenderTimeEstimator
+{
+  CLUTTER_RENDER_TIME_ESTIMATOR_PERCENTILE,
+  CLUTTER_RENDER_TIME_ESTIMATOR_DECAYING_MAX,
+} ClutterRenderTimeEstimator;
+
+static ClutterRenderTimeEstimator render_time_estimator;
+
 typedef struct _ClutterFrameListener
 {
   const ClutterFrameListenerIface *iface;
@@ -68,6 +82,12 @@ struct _ClutterFrameClock
   int64_t refresh_interval_us;
   ClutterFrameListener listener;
 
+  ClutterFrameClockMode mode;
+  /* Shortest allowed interval between two presentations when the clock is
+   * in variable mode, i.e. the upper end of the display's VRR range.
+   */
+  int64_t min_variable_refresh_interval_us;
+
   GSource *source;
 
   int64_t frame_count;
@@ -101,6 +121,14 @@ struct _ClutterFrameClock
   /* Short-term maximum update duration */
   int64_t shortterm_max_update_duration_us;
 
+  /* Sliding window of the most recent update durations, used by the
+   * percentile estimator.
+   */
+  int64_t update_duration_samples_us[UPDATE_DURATION_WINDOW_SIZE];
+  int n_update_duration_samples;
+  int next_update_duration_sample;
+  int64_t percentile_update_duration_us;
+
   /* If we got new measurements last frame. */
   gboolean got_measurements_last_frame;
   gboolean ever_got_measurements;
@@ -108,6 +136,19 @@ struct _ClutterFrameClock
   gboolean pending_reschedule;
   gboolean pending_reschedule_now;
 
+  /* Whether one more frame may be dispatched while the previous one is
+   * still waiting to be presented, as supported by the backend.
+   */
+  gboolean allow_triple_buffering;
+  /* Whether the recent frames took longer than a refresh interval to
+   * render; reset when the clock goes idle.
+   */
+  gboolean is_gpu_bound;
+  /* An older frame is still waiting to be presented while the state
+   * tracks the frame dispatched after it.
+   */
+  gboolean is_previous_frame_pending;
+
   int inhibit_count;
 
   GList *timelines;
@@ -138,6 +179,68 @@ clutter_frame_clock_set_refresh_rate (ClutterFrameClock *frame_clock,
     (int64_t) (0.5 + G_USEC_PER_SEC / refresh_rate);
 }
 
+ClutterFrameClockMode
+clutter_frame_clock_get_mode (ClutterFrameClock *frame_clock)
+{
+  return frame_clock->mode;
+}
+
+void
+clutter_frame_clock_set_max_variable_refresh_rate (ClutterFrameClock *frame_clock,
+                                                   float              max_refresh_rate)
+{
+  if (max_refresh_rate > 0.0)
+    {
+      frame_clock->min_variable_refresh_interval_us =
+        (int64_t) (0.5 + G_USEC_PER_SEC / max_refresh_rate);
+    }
+  else
+    {
+      frame_clock->min_variable_refresh_interval_us = 0;
+    }
+}
+
+void
+clutter_frame_clock_set_allow_triple_buffering (ClutterFrameClock *frame_clock,
+                                                gboolean           allow)
+{
+  frame_clock->allow_triple_buffering = allow;
+}
+
+static gboolean
+wants_triple_buffering (ClutterFrameClock *frame_clock)
+{
+  return (frame_clock->allow_triple_buffering &&
+          frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_FIXED &&
+          frame_clock->is_gpu_bound &&
+          !frame_clock->is_previous_frame_pending &&
+          !(clutter_paint_debug_flags &
+            CLUTTER_DEBUG_DISABLE_TRIPLE_BUFFERING));
+}
+
+static void
+unschedule_update (ClutterFrameClock *frame_clock)
+{
+  if (frame_clock->is_previous_frame_pending)
+    {
+      /* The queued frame was not dispatched yet, so all that is left is
+       * waiting for the previous one.
+       */
+      frame_clock->is_previous_frame_pending = FALSE;
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
+
+      if (frame_clock->is_next_presentation_time_valid)
+        {
+          frame_clock->next_presentation_time_us -=
+            frame_clock->refresh_interval_us;
+        }
+    }
+  else
+    {
+      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+    }
+}
+
 void
 clutter_frame_clock_add_timeline (ClutterFrameClock *frame_clock,
                                   ClutterTimeline   *timeline)
@@ -223,6 +326,17 @@ maybe_reschedule_update (ClutterFrameClock *frame_clock)
     }
 }
 
+static void
+go_idle (ClutterFrameClock *frame_clock)
+{
+  frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+  maybe_reschedule_update (frame_clock);
+
+  /* Nothing more to draw, so start over with double buffering */
+  if (frame_clock->state == CLUTTER_FRAME_CLOCK_STATE_IDLE)
+    frame_clock->is_gpu_bound = FALSE;
+}
+
 static void
 maybe_update_longterm_max_duration_us (ClutterFrameClock *frame_clock,
                                        ClutterFrameInfo  *frame_info)
@@ -253,6 +367,91 @@ maybe_update_longterm_max_duration_us (ClutterFrameClock *frame_clock,
   frame_clock->longterm_promotion_us = frame_info->presentation_time;
 }
 
+static int
+compare_int64 (gconstpointer a,
+               gconstpointer b)
+{
+  int64_t value_a = *(const int64_t *) a;
+  int64_t value_b = *(const int64_t *) b;
+
+  if (value_a < value_b)
+    return -1;
+  else if (value_a > value_b)
+    return 1;
+  else
+    return 0;
+}
+
+static void
+add_update_duration_sample (ClutterFrameClock *frame_clock,
+                            int64_t            update_duration_us)
+{
+  int64_t sorted_samples_us[UPDATE_DURATION_WINDOW_SIZE];
+  int n_samples;
+  int index;
+
+  frame_clock->update_duration_samples_us[frame_clock->next_update_duration_sample] =
+    update_duration_us;
+  frame_clock->next_update_duration_sample =
+    (frame_clock->next_update_duration_sample + 1) % UPDATE_DURATION_WINDOW_SIZE;
+  frame_clock->n_update_duration_samples =
+    MIN (frame_clock->n_update_duration_samples + 1,
+         UPDATE_DURATION_WINDOW_SIZE);
+
+  n_samples = frame_clock->n_update_duration_samples;
+  memcpy (sorted_samples_us, frame_clock->update_duration_samples_us,
+          n_samples * sizeof (int64_t));
+  qsort (sorted_samples_us, n_samples, sizeof (int64_t), compare_int64);
+
+  index = (int) ceilf (UPDATE_DURATION_PERCENTILE * n_samples) - 1;
+  index = CLAMP (index, 0, n_samples - 1);
+  frame_clock->percentile_update_duration_us = sorted_samples_us[index];
+}
+
+static int64_t
+estimate_update_duration_us (ClutterFrameClock *frame_clock)
+{
+  switch (render_time_estimator)
+    {
+    case CLUTTER_RENDER_TIME_ESTIMATOR_PERCENTILE:
+      return frame_clock->percentile_update_duration_us;
+    case CLUTTER_RENDER_TIME_ESTIMATOR_DECAYING_MAX:
+      return MAX (frame_clock->longterm_max_update_duration_us,
+                  frame_clock->shortterm_max_update_duration_us);
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+notify_previous_frame_presented (ClutterFrameClock *frame_clock,
+                                 ClutterFrameInfo  *frame_info)
+{
+  frame_clock->is_previous_frame_pending = FALSE;
+
+  if (frame_info->presentation_time > 0)
+    frame_clock->last_presentation_time_us = frame_info->presentation_time;
+
+  /* The dispatch timestamps already belong to the frame queued after this
+   * one, so only the GPU rendering time can be attributed to it.
+   */
+  if (frame_info->cpu_time_before_buffer_swap_us != 0)
+    {
+      frame_clock->is_gpu_bound =
+        frame_info->gpu_rendering_duration_ns / 1000 >
+        frame_clock->refresh_interval_us;
+    }
+
+  if (frame_info->refresh_rate > 1.0)
+    {
+      clutter_frame_clock_set_refresh_rate (frame_clock,
+                                            frame_info->refresh_rate);
+    }
+
+  if (frame_clock->state == CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED)
+    maybe_reschedule_update (frame_clock);
+}
+
 void
 clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                                       ClutterFrameInfo  *frame_info)
@@ -262,6 +461,12 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
   COGL_TRACE_DESCRIBE (ClutterFrameClockNotifyPresented,
                        frame_clock->output_name);
 
+  if (frame_clock->is_previous_frame_pending)
+    {
+      notify_previous_frame_presented (frame_clock, frame_info);
+      return;
+    }
+
   frame_clock->last_next_presentation_time_us =
     frame_clock->next_presentation_time_us;
   frame_clock->has_last_next_presentation_time =
@@ -346,6 +551,7 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
   if (frame_info->cpu_time_before_buffer_swap_us != 0)
     {
       int64_t dispatch_to_swap_us, swap_to_rendering_done_us, swap_to_flip_us;
+      int64_t update_duration_us;
 
       dispatch_to_swap_us =
         frame_info->cpu_time_before_buffer_swap_us -
@@ -363,14 +569,29 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
                     swap_to_rendering_done_us,
                     swap_to_flip_us);
 
+      update_duration_us =
+        frame_clock->last_dispatch_lateness_us + dispatch_to_swap_us +
+        MAX (swap_to_rendering_done_us, swap_to_flip_us);
+
       frame_clock->shortterm_max_update_duration_us =
-        CLAMP (frame_clock->last_dispatch_lateness_us + dispatch_to_swap_us +
-               MAX (swap_to_rendering_done_us, swap_to_flip_us),
+        CLAMP (update_duration_us,
                frame_clock->shortterm_max_update_duration_us,
                frame_clock->refresh_interval_us);
 
       maybe_update_longterm_max_duration_us (frame_clock, frame_info);
 
+      add_update_duration_sample (frame_clock,
+                                  CLAMP (update_duration_us,
+                                         0,
+                                         frame_clock->refresh_interval_us));
+
+      /* Waiting for the flip is not rendering, so leave it out when
+       * deciding whether an extra buffer would help.
+       */
+      frame_clock->is_gpu_bound =
+        (frame_clock->last_dispatch_lateness_us + dispatch_to_swap_us +
+         swap_to_rendering_done_us) > frame_clock->refresh_interval_us;
+
       frame_clock->got_measurements_last_frame = TRUE;
       frame_clock->ever_got_measurements = TRUE;
     }
@@ -396,8 +617,7 @@ clutter_frame_clock_notify_presented (ClutterFrameClock *frame_clock,
       break;
     case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
-      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
-      maybe_reschedule_update (frame_clock);
+      go_idle (frame_clock);
       break;
     }
 }
@@ -408,6 +628,14 @@ clutter_frame_clock_notify_ready (ClutterFrameClock *frame_clock)
   COGL_TRACE_BEGIN_SCOPED (ClutterFrameClockNotifyReady, "Clutter::FrameClock::ready()");
   COGL_TRACE_DESCRIBE (ClutterFrameClockNotifyReady, frame_clock->output_name);
 
+  if (frame_clock->is_previous_frame_pending)
+    {
+      frame_clock->is_previous_frame_pending = FALSE;
+      if (frame_clock->state == CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED)
+        maybe_reschedule_update (frame_clock);
+      return;
+    }
+
   switch (frame_clock->state)
     {
     case CLUTTER_FRAME_CLOCK_STATE_INIT:
@@ -418,8 +646,7 @@ clutter_frame_clock_notify_ready (ClutterFrameClock *frame_clock)
       break;
     case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
-      frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
-      maybe_reschedule_update (frame_clock);
+      go_idle (frame_clock);
       break;
     }
 }
@@ -448,10 +675,13 @@ clutter_frame_clock_compute_max_render_time_us (ClutterFrameClock *frame_clock)
    *   in parallel.
    * - The duration of vertical blank.
    * - A constant to account for variations in the above estimates.
+   *
+   * The update duration is predicted either from a percentile over the most
+   * recent frames, so that a single spike doesn't push the dispatch earlier
+   * for a long time, or from an exponentially decaying maximum.
    */
   max_render_time_us =
-    MAX (frame_clock->longterm_max_update_duration_us,
-         frame_clock->shortterm_max_update_duration_us) +
+    estimate_update_duration_us (frame_clock) +
     frame_clock->vblank_duration_us +
     clutter_max_render_time_constant_us;
 
@@ -607,6 +837,126 @@ calculate_next_update_time_us (ClutterFrameClock *frame_clock,
   *out_next_frame_deadline_us = next_presentation_time_us - min_render_time_allowed_us;
 }
 
+static void
+calculate_next_variable_update_time_us (ClutterFrameClock *frame_clock,
+                                        int64_t           *out_next_update_time_us,
+                                        int64_t           *out_next_presentation_time_us,
+                                        int64_t           *out_next_frame_deadline_us)
+{
+  int64_t now_us;
+  int64_t min_refresh_interval_us;
+  int64_t max_render_time_allowed_us;
+  int64_t next_presentation_time_us;
+  int64_t next_update_time_us;
+
+  now_us = g_get_monotonic_time ();
+
+  /* The display can not present faster than the current mode nor faster
+   * than the upper end of its variable refresh rate range.
+   */
+  min_refresh_interval_us = MAX (frame_clock->refresh_interval_us,
+                                 frame_clock->min_variable_refresh_interval_us);
+
+  if (frame_clock->last_presentation_time_us == 0)
+    {
+      *out_next_update_time_us =
+        frame_clock->last_dispatch_time_us ?
+        MAX ((frame_clock->last_dispatch_time_us -
+              frame_clock->last_dispatch_lateness_us) + min_refresh_interval_us,
+             now_us) :
+        now_us;
+
+      *out_next_presentation_time_us = 0;
+      *out_next_frame_deadline_us = 0;
+      return;
+    }
+
+  max_render_time_allowed_us =
+    clutter_frame_clock_compute_max_render_time_us (frame_clock);
+
+  /*
+   * With variable refresh rate, the display refreshes when a new buffer is
+   * flipped instead of on a fixed cadence, so there is no vblank to align
+   * to. Start the update as soon as possible, but not so early that the
+   * resulting presentation would happen before the minimum refresh interval
+   * since the last presentation has passed:
+   *
+   *       last_presentation_time_us
+   *      /          earliest possible next presentation
+   *     /          /   now_us
+   *    /          /   /
+   * |--|----------|--o----> time
+   *    \__________/
+   *          \
+   *    min_refresh_interval_us
+   */
+  next_presentation_time_us =
+    frame_clock->last_presentation_time_us + min_refresh_interval_us;
+
+  next_update_time_us = next_presentation_time_us - max_render_time_allowed_us;
+  if (next_update_time_us < now_us)
+    {
+      next_update_time_us = now_us;
+      next_presentation_time_us = now_us + max_render_time_allowed_us;
+    }
+
+  *out_next_update_time_us = next_update_time_us;
+  *out_next_presentation_time_us = next_presentation_time_us;
+  /* There is no vblank deadline to evade in variable mode. */
+  *out_next_frame_deadline_us = 0;
+}
+
+static const char *
+frame_clock_mode_to_string (ClutterFrameClockMode mode)
+{
+  switch (mode)
+    {
+    case CLUTTER_FRAME_CLOCK_MODE_FIXED:
+      return "fixed";
+    case CLUTTER_FRAME_CLOCK_MODE_VARIABLE:
+      return "variable";
+    case CLUTTER_FRAME_CLOCK_MODE_TEARING:
+      return "tearing";
+    }
+
+  g_assert_not_reached ();
+}
+
+void
+clutter_frame_clock_set_mode (ClutterFrameClock     *frame_clock,
+                              ClutterFrameClockMode  mode)
+{
+  if (frame_clock->mode == mode)
+    return;
+
+  CLUTTER_NOTE (FRAME_CLOCK, "Switching frame clock of %s to %s mode",
+                frame_clock->output_name,
+                frame_clock_mode_to_string (mode));
+
+  frame_clock->mode = mode;
+
+  switch (frame_clock->state)
+    {
+    case CLUTTER_FRAME_CLOCK_STATE_INIT:
+    case CLUTTER_FRAME_CLOCK_STATE_IDLE:
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
+      frame_clock->pending_reschedule = TRUE;
+      unschedule_update (frame_clock);
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
+      frame_clock->pending_reschedule = TRUE;
+      frame_clock->pending_reschedule_now = TRUE;
+      unschedule_update (frame_clock);
+      break;
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
+    case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      return;
+    }
+
+  maybe_reschedule_update (frame_clock);
+}
+
 void
 clutter_frame_clock_inhibit (ClutterFrameClock *frame_clock)
 {
@@ -621,12 +971,12 @@ clutter_frame_clock_inhibit (ClutterFrameClock *frame_clock)
           break;
         case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
           frame_clock->pending_reschedule = TRUE;
-          frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+          unschedule_update (frame_clock);
           break;
         case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
           frame_clock->pending_reschedule = TRUE;
           frame_clock->pending_reschedule_now = TRUE;
-          frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
+          unschedule_update (frame_clock);
           break;
         case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
         case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
@@ -648,6 +998,32 @@ clutter_frame_clock_uninhibit (ClutterFrameClock *frame_clock)
     maybe_reschedule_update (frame_clock);
 }
 
+static void
+schedule_queued_update (ClutterFrameClock      *frame_clock,
+                        ClutterFrameClockState  state)
+{
+  int64_t next_update_time_us;
+
+  /* The previous frame has not been presented yet, but rendering is what
+   * holds us back, so start on the next one right away and let it queue up
+   * behind the pending flip. It can at best be presented one refresh
+   * interval after the previous one.
+   */
+  frame_clock->is_previous_frame_pending = TRUE;
+
+  if (frame_clock->is_next_presentation_time_valid)
+    {
+      frame_clock->next_presentation_time_us +=
+        frame_clock->refresh_interval_us;
+    }
+  frame_clock->has_next_frame_deadline = FALSE;
+
+  next_update_time_us = g_get_monotonic_time ();
+  frame_clock->next_update_time_us = next_update_time_us;
+  g_source_set_ready_time (frame_clock->source, next_update_time_us);
+  frame_clock->state = state;
+}
+
 void
 clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
 {
@@ -669,8 +1045,15 @@ clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
       break;
     case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
       return;
-    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      if (wants_triple_buffering (frame_clock))
+        {
+          schedule_queued_update (frame_clock,
+                                  CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW);
+          return;
+        }
+      G_GNUC_FALLTHROUGH;
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
       frame_clock->pending_reschedule = TRUE;
       frame_clock->pending_reschedule_now = TRUE;
       return;
@@ -678,10 +1061,27 @@ clutter_frame_clock_schedule_update_now (ClutterFrameClock *frame_clock)
 
   g_warn_if_fail (next_update_time_us != -1);
 
+  if (frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_VARIABLE &&
+      frame_clock->state != CLUTTER_FRAME_CLOCK_STATE_INIT)
+    {
+      /* Still dispatch as early as possible, but respect the minimum
+       * refresh interval of the display.
+       */
+      calculate_next_variable_update_time_us (frame_clock,
+                                              &next_update_time_us,
+                                              &frame_clock->next_presentation_time_us,
+                                              &frame_clock->next_frame_deadline_us);
+      frame_clock->is_next_presentation_time_valid =
+        (frame_clock->next_presentation_time_us != 0);
+    }
+  else
+    {
+      frame_clock->is_next_presentation_time_valid = FALSE;
+    }
+
   frame_clock->next_update_time_us = next_update_time_us;
   g_source_set_ready_time (frame_clock->source, next_update_time_us);
   frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW;
-  frame_clock->is_next_presentation_time_valid = FALSE;
   frame_clock->has_next_frame_deadline = FALSE;
 }
 
@@ -702,10 +1102,29 @@ clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock)
       next_update_time_us = g_get_monotonic_time ();
       break;
     case CLUTTER_FRAME_CLOCK_STATE_IDLE:
-      calculate_next_update_time_us (frame_clock,
-                                     &next_update_time_us,
-                                     &frame_clock->next_presentation_time_us,
-                                     &frame_clock->next_frame_deadline_us);
+      switch (frame_clock->mode)
+        {
+        case CLUTTER_FRAME_CLOCK_MODE_FIXED:
+          calculate_next_update_time_us (frame_clock,
+                                         &next_update_time_us,
+                                         &frame_clock->next_presentation_time_us,
+                                         &frame_clock->next_frame_deadline_us);
+          break;
+        case CLUTTER_FRAME_CLOCK_MODE_VARIABLE:
+          calculate_next_variable_update_time_us (frame_clock,
+                                                  &next_update_time_us,
+                                                  &frame_clock->next_presentation_time_us,
+                                                  &frame_clock->next_frame_deadline_us);
+          break;
+        case CLUTTER_FRAME_CLOCK_MODE_TEARING:
+          /* Updates are presented as soon as they are ready, without
+           * waiting for the next vblank, so there is nothing to align to.
+           */
+          next_update_time_us = g_get_monotonic_time ();
+          frame_clock->next_presentation_time_us = 0;
+          frame_clock->next_frame_deadline_us = 0;
+          break;
+        }
       frame_clock->is_next_presentation_time_valid =
         (frame_clock->next_presentation_time_us != 0);
       frame_clock->has_next_frame_deadline =
@@ -714,8 +1133,15 @@ clutter_frame_clock_schedule_update (ClutterFrameClock *frame_clock)
     case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED:
     case CLUTTER_FRAME_CLOCK_STATE_SCHEDULED_NOW:
       return;
-    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
     case CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED:
+      if (wants_triple_buffering (frame_clock))
+        {
+          schedule_queued_update (frame_clock,
+                                  CLUTTER_FRAME_CLOCK_STATE_SCHEDULED);
+          return;
+        }
+      G_GNUC_FALLTHROUGH;
+    case CLUTTER_FRAME_CLOCK_STATE_DISPATCHING:
       frame_clock->pending_reschedule = TRUE;
       return;
     }
@@ -828,8 +1254,11 @@ clutter_frame_clock_dispatch (ClutterFrameClock *frame_clock,
           frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_PENDING_PRESENTED;
           break;
         case CLUTTER_FRAME_RESULT_IDLE:
-          frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_IDLE;
-          maybe_reschedule_update (frame_clock);
+          /* If nothing was queued, keep waiting for the previous frame */
+          if (frame_clock->is_previous_frame_pending)
+            unschedule_update (frame_clock);
+          else
+            go_idle (frame_clock);
           break;
         }
       break;
@@ -884,9 +1313,7 @@ clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clo
   else
     g_string_append_printf (string, " (no measurements last frame)");
 
-  max_update_duration_us =
-    MAX (frame_clock->longterm_max_update_duration_us,
-         frame_clock->shortterm_max_update_duration_us);
+  max_update_duration_us = estimate_update_duration_us (frame_clock);
 
   g_string_append_printf (string, "\nVblank duration: %ld µs +",
                           frame_clock->vblank_duration_us);
@@ -895,6 +1322,29 @@ clutter_frame_clock_get_max_render_time_debug_info (ClutterFrameClock *frame_clo
   g_string_append_printf (string, "\nConstant: %d µs",
                           clutter_max_render_time_constant_us);
 
+  switch (render_time_estimator)
+    {
+    case CLUTTER_RENDER_TIME_ESTIMATOR_PERCENTILE:
+      g_string_append_printf (string,
+                              "\nEstimator: %d%% percentile over %d/%d frames",
+                              (int) (UPDATE_DURATION_PERCENTILE * 100),
+                              frame_clock->n_update_duration_samples,
+                              UPDATE_DURATION_WINDOW_SIZE);
+      break;
+    case CLUTTER_RENDER_TIME_ESTIMATOR_DECAYING_MAX:
+      g_string_append_printf (string,
+                              "\nEstimator: decaying maximum "
+                              "(long-term %ld µs, short-term %ld µs)",
+                              frame_clock->longterm_max_update_duration_us,
+                              frame_clock->shortterm_max_update_duration_us);
+      break;
+    }
+
+  if (frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_VARIABLE)
+    g_string_append_printf (string, "\nVariable refresh rate");
+  else if (frame_clock->mode == CLUTTER_FRAME_CLOCK_MODE_TEARING)
+    g_string_append_printf (string, "\nTearing");
+
   return string;
 }
 
@@ -981,12 +1431,20 @@ static void
 clutter_frame_clock_init (ClutterFrameClock *frame_clock)
 {
   frame_clock->state = CLUTTER_FRAME_CLOCK_STATE_INIT;
+  frame_clock->mode = CLUTTER_FRAME_CLOCK_MODE_FIXED;
 }
 
 static void
 clutter_frame_clock_class_init (ClutterFrameClockClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  const char *estimator_str;
+
+  estimator_str = g_getenv ("CLUTTER_RENDER_TIME_ESTIMATOR");
+  if (g_strcmp0 (estimator_str, "decaying-max") == 0)
+    render_time_estimator = CLUTTER_RENDER_TIME_ESTIMATOR_DECAYING_MAX;
+  else
+    render_time_estimator = CLUTTER_RENDER_TIME_ESTIMATOR_PERCENTILE;
 
   object_class->dispose = clutter_frame_clock_dispose;
 
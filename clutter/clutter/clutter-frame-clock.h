@@ -33,6 +33,13 @@ typedef enum _ClutterFrameResult
   CLUTTER_FRAME_RESULT_IDLE,
 } ClutterFrameResult;
 
+typedef enum _ClutterFrameClockMode
+{
+  CLUTTER_FRAME_CLOCK_MODE_FIXED,
+  CLUTTER_FRAME_CLOCK_MODE_VARIABLE,
+  CLUTTER_FRAME_CLOCK_MODE_TEARING,
+} ClutterFrameClockMode;
+
 #define CLUTTER_TYPE_FRAME_CLOCK (clutter_frame_clock_get_type ())
 CLUTTER_EXPORT
 G_DECLARE_FINAL_TYPE (ClutterFrameClock, clutter_frame_clock,
@@ -92,6 +99,21 @@ void clutter_frame_clock_remove_timeline (ClutterFrameClock *frame_clock,
 CLUTTER_EXPORT
 float clutter_frame_clock_get_refresh_rate (ClutterFrameClock *frame_clock);
 
+CLUTTER_EXPORT
+void clutter_frame_clock_set_mode (ClutterFrameClock     *frame_clock,
+                                   ClutterFrameClockMode  mode);
+
+CLUTTER_EXPORT
+ClutterFrameClockMode clutter_frame_clock_get_mode (ClutterFrameClock *frame_clock);
+
+CLUTTER_EXPORT
+void clutter_frame_clock_set_max_variable_refresh_rate (ClutterFrameClock *frame_clock,
+                                                        float              max_refresh_rate);
+
+CLUTTER_EXPORT
+void clutter_frame_clock_set_allow_triple_buffering (ClutterFrameClock *frame_clock,
+                                                     gboolean           allow);
+
 void clutter_frame_clock_record_flip_time (ClutterFrameClock *frame_clock,
                                            int64_t            flip_time_us);
 
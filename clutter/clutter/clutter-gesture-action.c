@@ -451,15 +451,17 @@ clutter_gesture_action_handle_event (ClutterAction      *action,
 
       /* Check if a _TRIGGER_EDGE_BEFORE gesture needs to be cancelled because
        * the drag threshold has been exceeded. */
-      clutter_gesture_action_get_threshold_trigger_distance (gesture_action,
-                                                             &threshold_x,
-                                                             &threshold_y);
-      if (priv->edge == CLUTTER_GESTURE_TRIGGER_EDGE_BEFORE &&
-          ((fabsf (point->press_y - point->last_motion_y) > threshold_y) ||
-           (fabsf (point->press_x - point->last_motion_x) > threshold_x)))
+      if (priv->edge == CLUTTER_GESTURE_TRIGGER_EDGE_BEFORE)
         {
-          cancel_gesture (gesture_action);
-          return CLUTTER_EVENT_PROPAGATE;
+          clutter_gesture_action_get_threshold_trigger_distance (gesture_action,
+                                                                 &threshold_x,
+                                                                 &threshold_y);
+          if ((fabsf (point->press_y - point->last_motion_y) > threshold_y) ||
+              (fabsf (point->press_x - point->last_motion_x) > threshold_x))
+            {
+              cancel_gesture (gesture_action);
+              return CLUTTER_EVENT_PROPAGATE;
+            }
         }
       break;
 
@@ -1335,23 +1337,36 @@ clutter_gesture_action_get_threshold_trigger_distance (ClutterGestureAction *act
                                                        float                *y)
 {
   ClutterGestureActionPrivate *priv;
+  int default_threshold = -1;
 
   g_return_if_fail (CLUTTER_IS_GESTURE_ACTION (action));
 
   priv = clutter_gesture_action_get_instance_private (action);
 
+  /* This is called for touch updates, only look up the setting once */
   if (x != NULL)
     {
       if (priv->distance_x > 0.0)
-        *x = priv->distance_x;
+        {
+          *x = priv->distance_x;
+        }
       else
-        *x = gesture_get_default_threshold ();
+        {
+          default_threshold = gesture_get_default_threshold ();
+          *x = default_threshold;
+        }
     }
   if (y != NULL)
     {
       if (priv->distance_y > 0.0)
-        *y = priv->distance_y;
+        {
+          *y = priv->distance_y;
+        }
       else
-        *y = gesture_get_default_threshold ();
+        {
+          if (default_threshold < 0)
+            default_threshold = gesture_get_default_threshold ();
+          *y = default_threshold;
+        }
     }
 }
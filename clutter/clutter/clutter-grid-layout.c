@@ -36,6 +36,7 @@
 #include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-enum-types.h"
+#include "clutter/clutter-layout-manager-private.h"
 #include "clutter/clutter-layout-meta.h"
 #include "clutter/clutter-private.h"
 
@@ -108,6 +109,8 @@ struct _ClutterGridLayout
   ClutterOrientation orientation;
 
   ClutterGridLineData linedata[2];
+
+  ClutterLayoutCache allocation_cache;
 };
 
 #define ROWS(priv)    (&(priv)->linedata[CLUTTER_ORIENTATION_HORIZONTAL])
@@ -1253,6 +1256,7 @@ clutter_grid_layout_set_container (ClutterLayoutManager *self,
   ClutterLayoutManagerClass *parent_class;
 
   grid->container = container;
+  clutter_layout_cache_invalidate (&grid->allocation_cache);
 
   if (grid->container != NULL)
     {
@@ -1386,6 +1390,10 @@ clutter_grid_layout_allocate (ClutterLayoutManager   *layout,
   ClutterActorIter iter;
   ClutterActor *child;
 
+  if (clutter_layout_cache_allocate (&self->allocation_cache,
+                                     container, allocation))
+    return;
+
   request.grid = self;
 
   clutter_grid_request_update_attach (&request);
@@ -1411,6 +1419,8 @@ clutter_grid_layout_allocate (ClutterLayoutManager   *layout,
   clutter_grid_request_position (&request, 0);
   clutter_grid_request_position (&request, 1);
 
+  clutter_layout_cache_begin (&self->allocation_cache, container, allocation);
+
   clutter_actor_iter_init (&iter, CLUTTER_ACTOR (container));
   while (clutter_actor_iter_next (&iter, &child))
     {
@@ -1438,8 +1448,20 @@ clutter_grid_layout_allocate (ClutterLayoutManager   *layout,
       child_allocation.x2 = child_allocation.x1 + width;
       child_allocation.y2 = child_allocation.y1 + height;
 
+      clutter_layout_cache_add_child (&self->allocation_cache,
+                                      child, &child_allocation);
       clutter_actor_allocate (child, &child_allocation);
     }
+
+  clutter_layout_cache_end (&self->allocation_cache);
+}
+
+static void
+clutter_grid_layout_layout_changed (ClutterLayoutManager *layout)
+{
+  ClutterGridLayout *self = CLUTTER_GRID_LAYOUT (layout);
+
+  clutter_layout_cache_invalidate (&self->allocation_cache);
 }
 
 static GType
@@ -1522,6 +1544,16 @@ clutter_grid_layout_get_property (GObject    *gobject,
     }
 }
 
+static void
+clutter_grid_layout_finalize (GObject *gobject)
+{
+  ClutterGridLayout *self = CLUTTER_GRID_LAYOUT (gobject);
+
+  clutter_layout_cache_clear (&self->allocation_cache);
+
+  G_OBJECT_CLASS (clutter_grid_layout_parent_class)->finalize (gobject);
+}
+
 static void
 clutter_grid_layout_class_init (ClutterGridLayoutClass *klass)
 {
@@ -1530,6 +1562,7 @@ clutter_grid_layout_class_init (ClutterGridLayoutClass *klass)
 
   layout_class = CLUTTER_LAYOUT_MANAGER_CLASS (klass);
 
+  object_class->finalize = clutter_grid_layout_finalize;
   object_class->set_property = clutter_grid_layout_set_property;
   object_class->get_property = clutter_grid_layout_get_property;
 
@@ -1538,6 +1571,7 @@ clutter_grid_layout_class_init (ClutterGridLayoutClass *klass)
   layout_class->get_preferred_height = clutter_grid_layout_get_preferred_height;
   layout_class->allocate = clutter_grid_layout_allocate;
   layout_class->get_child_meta_type = clutter_grid_layout_get_child_meta_type;
+  layout_class->layout_changed = clutter_grid_layout_layout_changed;
 
   /**
    * ClutterGridLayout:orientation:
@@ -1603,6 +1637,8 @@ clutter_grid_layout_init (ClutterGridLayout *self)
 
   self->linedata[0].homogeneous = FALSE;
   self->linedata[1].homogeneous = FALSE;
+
+  clutter_layout_cache_init (&self->allocation_cache);
 }
 
 /**
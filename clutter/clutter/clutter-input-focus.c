@@ -19,6 +19,7 @@
 
 #include "config.h"
 
+#include "clutter/clutter-event.h"
 #include "clutter/clutter-input-focus.h"
 #include "clutter/clutter-input-focus-private.h"
 #include "clutter/clutter-input-method-private.h"
@@ -33,15 +34,145 @@ static void clutter_input_focus_set_preedit_text (ClutterInputFocus *focus,
                                                   unsigned int       cursor,
                                                   unsigned int       anchor);
 
+typedef struct _SurroundingText
+{
+  char *text;
+  guint cursor;
+  guint anchor;
+} SurroundingText;
+
 struct _ClutterInputFocusPrivate
 {
   ClutterInputMethod *im;
   char *preedit;
   ClutterPreeditResetMode mode;
+
+  /* Surrounding text and cursor location are coalesced until the next main
+   * loop iteration (or until the input method needs them), and only passed
+   * on to the input method if they differ from what it last got.
+   */
+  guint flush_idle_id;
+
+  SurroundingText pending_surrounding;
+  gboolean has_pending_surrounding;
+  SurroundingText surrounding;
+  gboolean has_surrounding;
+
+  graphene_rect_t pending_cursor_location;
+  gboolean has_pending_cursor_location;
+  graphene_rect_t cursor_location;
+  gboolean has_cursor_location;
 };
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (ClutterInputFocus, clutter_input_focus, G_TYPE_OBJECT)
 
+static void
+forget_sent_state (ClutterInputFocus *focus)
+{
+  ClutterInputFocusPrivate *priv =
+    clutter_input_focus_get_instance_private (focus);
+
+  g_clear_pointer (&priv->surrounding.text, g_free);
+  priv->has_surrounding = FALSE;
+  priv->has_cursor_location = FALSE;
+}
+
+static void
+discard_pending_state (ClutterInputFocus *focus)
+{
+  ClutterInputFocusPrivate *priv =
+    clutter_input_focus_get_instance_private (focus);
+
+  g_clear_handle_id (&priv->flush_idle_id, g_source_remove);
+  g_clear_pointer (&priv->pending_surrounding.text, g_free);
+  priv->has_pending_surrounding = FALSE;
+  priv->has_pending_cursor_location = FALSE;
+}
+
+static void
+flush_pending_state (ClutterInputFocus *focus)
+{
+  ClutterInputFocusPrivate *priv =
+    clutter_input_focus_get_instance_private (focus);
+
+  g_clear_handle_id (&priv->flush_idle_id, g_source_remove);
+
+  if (!priv->im)
+    {
+      discard_pending_state (focus);
+      return;
+    }
+
+  if (priv->has_pending_surrounding)
+    {
+      SurroundingText *pending = &priv->pending_surrounding;
+
+      priv->has_pending_surrounding = FALSE;
+
+      if (!priv->has_surrounding ||
+          g_strcmp0 (priv->surrounding.text, pending->text) != 0 ||
+          priv->surrounding.cursor != pending->cursor ||
+          priv->surrounding.anchor != pending->anchor)
+        {
+          g_free (priv->surrounding.text);
+          priv->surrounding = *pending;
+          priv->has_surrounding = TRUE;
+          pending->text = NULL;
+
+          clutter_input_method_set_surrounding (priv->im,
+                                                priv->surrounding.text,
+                                                priv->surrounding.cursor,
+                                                priv->surrounding.anchor);
+        }
+      else
+        {
+          g_clear_pointer (&pending->text, g_free);
+        }
+    }
+
+  if (priv->has_pending_cursor_location)
+    {
+      priv->has_pending_cursor_location = FALSE;
+
+      if (!priv->has_cursor_location ||
+          !graphene_rect_equal (&priv->cursor_location,
+                                &priv->pending_cursor_location))
+        {
+          priv->cursor_location = priv->pending_cursor_location;
+          priv->has_cursor_location = TRUE;
+
+          clutter_input_method_set_cursor_location (priv->im,
+                                                    &priv->cursor_location);
+        }
+    }
+}
+
+static gboolean
+flush_idle_cb (gpointer user_data)
+{
+  ClutterInputFocus *focus = user_data;
+  ClutterInputFocusPrivate *priv =
+    clutter_input_focus_get_instance_private (focus);
+
+  priv->flush_idle_id = 0;
+  flush_pending_state (focus);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_flush (ClutterInputFocus *focus)
+{
+  ClutterInputFocusPrivate *priv =
+    clutter_input_focus_get_instance_private (focus);
+
+  if (priv->flush_idle_id)
+    return;
+
+  priv->flush_idle_id = g_idle_add_full (CLUTTER_PRIORITY_EVENTS,
+                                         flush_idle_cb, focus, NULL);
+}
+
 static void
 clutter_input_focus_real_focus_in (ClutterInputFocus  *focus,
                                    ClutterInputMethod *im)
@@ -50,6 +181,8 @@ clutter_input_focus_real_focus_in (ClutterInputFocus  *focus,
 
   priv = clutter_input_focus_get_instance_private (focus);
   priv->im = im;
+
+  forget_sent_state (focus);
 }
 
 static void
@@ -59,6 +192,9 @@ clutter_input_focus_real_focus_out (ClutterInputFocus  *focus)
 
   priv = clutter_input_focus_get_instance_private (focus);
   priv->im = NULL;
+
+  discard_pending_state (focus);
+  forget_sent_state (focus);
 }
 
 static void
@@ -68,6 +204,8 @@ clutter_input_focus_finalize (GObject *object)
   ClutterInputFocusPrivate *priv =
     clutter_input_focus_get_instance_private (focus);
 
+  discard_pending_state (focus);
+  forget_sent_state (focus);
   g_clear_pointer (&priv->preedit, g_free);
 
   G_OBJECT_CLASS (clutter_input_focus_parent_class)->finalize (object);
@@ -109,6 +247,8 @@ clutter_input_focus_reset (ClutterInputFocus *focus)
 
   priv = clutter_input_focus_get_instance_private (focus);
 
+  flush_pending_state (focus);
+
   if (priv->preedit)
     {
       if (priv->mode == CLUTTER_PREEDIT_RESET_COMMIT)
@@ -120,6 +260,9 @@ clutter_input_focus_reset (ClutterInputFocus *focus)
 
   priv->mode = CLUTTER_PREEDIT_RESET_CLEAR;
   clutter_input_method_reset (priv->im);
+
+  /* The input method may drop its state on reset, so pass it on again */
+  forget_sent_state (focus);
 }
 
 void
@@ -133,7 +276,9 @@ clutter_input_focus_set_cursor_location (ClutterInputFocus     *focus,
 
   priv = clutter_input_focus_get_instance_private (focus);
 
-  clutter_input_method_set_cursor_location (priv->im, rect);
+  priv->pending_cursor_location = *rect;
+  priv->has_pending_cursor_location = TRUE;
+  queue_flush (focus);
 }
 
 void
@@ -149,7 +294,14 @@ clutter_input_focus_set_surrounding (ClutterInputFocus *focus,
 
   priv = clutter_input_focus_get_instance_private (focus);
 
-  clutter_input_method_set_surrounding (priv->im, text, cursor, anchor);
+  g_free (priv->pending_surrounding.text);
+  priv->pending_surrounding = (SurroundingText) {
+    .text = g_strdup (text),
+    .cursor = cursor,
+    .anchor = anchor,
+  };
+  priv->has_pending_surrounding = TRUE;
+  queue_flush (focus);
 }
 
 void
@@ -197,6 +349,9 @@ clutter_input_focus_filter_event (ClutterInputFocus  *focus,
   if (event_type == CLUTTER_KEY_PRESS ||
       event_type == CLUTTER_KEY_RELEASE)
     {
+      /* Key handling may depend on the surrounding text */
+      flush_pending_state (focus);
+
       return clutter_input_method_filter_key_event (priv->im, (ClutterKeyEvent *) event);
     }
 
@@ -320,7 +475,10 @@ clutter_input_focus_request_surrounding (ClutterInputFocus *focus)
 {
   g_return_if_fail (CLUTTER_IS_INPUT_FOCUS (focus));
 
+  /* The input method explicitly asked, so answer even if unchanged */
+  forget_sent_state (focus);
   CLUTTER_INPUT_FOCUS_GET_CLASS (focus)->request_surrounding (focus);
+  flush_pending_state (focus);
 }
 
 void
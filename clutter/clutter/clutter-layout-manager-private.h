@@ -0,0 +1,63 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "clutter/clutter-layout-manager.h"
+
+G_BEGIN_DECLS
+
+/*
+ * ClutterLayoutCache:
+ *
+ * Remembers the child allocations computed by a layout manager for a
+ * given container box, so that allocating again with the same box can
+ * skip querying the children and distributing space when none of the
+ * visible children changed their size request in between.
+ */
+typedef struct _ClutterLayoutCache
+{
+  ClutterActorBox box;
+  ClutterTextDirection text_direction;
+  ClutterRequestMode request_mode;
+  GArray *children;
+  gboolean valid;
+} ClutterLayoutCache;
+
+void clutter_layout_cache_init (ClutterLayoutCache *cache);
+
+void clutter_layout_cache_clear (ClutterLayoutCache *cache);
+
+void clutter_layout_cache_invalidate (ClutterLayoutCache *cache);
+
+gboolean clutter_layout_cache_allocate (ClutterLayoutCache    *cache,
+                                        ClutterActor          *container,
+                                        const ClutterActorBox *box);
+
+void clutter_layout_cache_begin (ClutterLayoutCache    *cache,
+                                 ClutterActor          *container,
+                                 const ClutterActorBox *box);
+
+void clutter_layout_cache_add_child (ClutterLayoutCache    *cache,
+                                     ClutterActor          *child,
+                                     const ClutterActorBox *child_box);
+
+void clutter_layout_cache_end (ClutterLayoutCache *cache);
+
+G_END_DECLS
@@ -93,8 +93,9 @@
 #include <glib-object.h>
 #include <gobject/gvaluecollector.h>
 
+#include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-debug.h"
-#include "clutter/clutter-layout-manager.h"
+#include "clutter/clutter-layout-manager-private.h"
 #include "clutter/clutter-layout-meta.h"
 #include "clutter/clutter-marshal.h"
 #include "clutter/clutter-private.h"
@@ -930,3 +931,133 @@ clutter_layout_manager_list_child_properties (ClutterLayoutManager *manager,
 
   return pspecs;
 }
+
+typedef struct _ClutterLayoutCacheChild
+{
+  ClutterActor *actor;
+  guint64 size_request_stamp;
+  ClutterActorBox allocation;
+} ClutterLayoutCacheChild;
+
+void
+clutter_layout_cache_init (ClutterLayoutCache *cache)
+{
+  cache->children = g_array_new (FALSE, FALSE,
+                                 sizeof (ClutterLayoutCacheChild));
+  cache->valid = FALSE;
+}
+
+void
+clutter_layout_cache_clear (ClutterLayoutCache *cache)
+{
+  g_clear_pointer (&cache->children, g_array_unref);
+  cache->valid = FALSE;
+}
+
+void
+clutter_layout_cache_invalidate (ClutterLayoutCache *cache)
+{
+  cache->valid = FALSE;
+}
+
+/*
+ * clutter_layout_cache_allocate:
+ * @cache: a #ClutterLayoutCache
+ * @container: the container being allocated
+ * @box: the allocation of @container
+ *
+ * Allocates the children of @container again with the allocations stored
+ * in @cache, if they are still valid for @box.
+ *
+ * Returns: %TRUE if the children were allocated, %FALSE if the layout
+ *   manager needs to compute the allocations itself
+ */
+gboolean
+clutter_layout_cache_allocate (ClutterLayoutCache    *cache,
+                               ClutterActor          *container,
+                               const ClutterActorBox *box)
+{
+  ClutterLayoutCacheChild *cached_children;
+  ClutterActorIter iter;
+  ClutterActor *child;
+  unsigned int i;
+
+  if (!cache->valid)
+    return FALSE;
+
+  if (!clutter_actor_box_equal (&cache->box, box) ||
+      cache->text_direction != clutter_actor_get_text_direction (container) ||
+      cache->request_mode != clutter_actor_get_request_mode (container))
+    return FALSE;
+
+  cached_children = (ClutterLayoutCacheChild *) cache->children->data;
+
+  i = 0;
+  clutter_actor_iter_init (&iter, container);
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      if (!clutter_actor_is_visible (child))
+        continue;
+
+      if (i >= cache->children->len ||
+          cached_children[i].actor != child ||
+          cached_children[i].size_request_stamp !=
+          clutter_actor_get_size_request_stamp (child))
+        return FALSE;
+
+      i++;
+    }
+
+  if (i != cache->children->len)
+    return FALSE;
+
+  CLUTTER_NOTE (LAYOUT, "Reusing cached allocations for %s",
+                _clutter_actor_get_debug_name (container));
+
+  for (i = 0; i < cache->children->len; i++)
+    clutter_actor_allocate (cached_children[i].actor,
+                            &cached_children[i].allocation);
+
+  return TRUE;
+}
+
+void
+clutter_layout_cache_begin (ClutterLayoutCache    *cache,
+                            ClutterActor          *container,
+                            const ClutterActorBox *box)
+{
+  cache->box = *box;
+  cache->text_direction = clutter_actor_get_text_direction (container);
+  cache->request_mode = clutter_actor_get_request_mode (container);
+  cache->valid = FALSE;
+  g_array_set_size (cache->children, 0);
+}
+
+/*
+ * clutter_layout_cache_add_child:
+ * @cache: a #ClutterLayoutCache
+ * @child: a visible child of the container
+ * @child_box: the allocation computed for @child
+ *
+ * Records the allocation of @child. Must be called for every visible
+ * child, in order, before allocating it.
+ */
+void
+clutter_layout_cache_add_child (ClutterLayoutCache    *cache,
+                                ClutterActor          *child,
+                                const ClutterActorBox *child_box)
+{
+  ClutterLayoutCacheChild cached_child;
+
+  cached_child.actor = child;
+  cached_child.size_request_stamp = clutter_actor_get_size_request_stamp (child);
+  cached_child.allocation = *child_box;
+
+  g_array_append_val (cache->children, cached_child);
+}
+
+void
+clutter_layout_cache_end (ClutterLayoutCache *cache)
+{
+  cache->valid = TRUE;
+}
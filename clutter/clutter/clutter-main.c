@@ -938,6 +938,7 @@ _clutter_clear_events_queue (void)
 
   events_queue = context->events_queue;
   context->events_queue = NULL;
+  context->events_queue_tail = NULL;
 
   g_async_queue_unlock (events_queue);
   g_async_queue_unref (events_queue);
@@ -76,6 +76,9 @@ typedef enum
   CLUTTER_DEBUG_PAINT_DAMAGE_REGION             = 1 << 8,
   CLUTTER_DEBUG_DISABLE_DYNAMIC_MAX_RENDER_TIME = 1 << 9,
   CLUTTER_DEBUG_PAINT_MAX_RENDER_TIME           = 1 << 10,
+  CLUTTER_DEBUG_DISABLE_TRIPLE_BUFFERING        = 1 << 11,
+  CLUTTER_DEBUG_DISABLE_MOTION_RESAMPLING       = 1 << 12,
+  CLUTTER_DEBUG_ACTOR_COSTS                     = 1 << 13,
 } ClutterDrawDebugFlag;
 
 /**
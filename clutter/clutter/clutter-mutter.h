@@ -63,6 +63,9 @@ gboolean clutter_actor_is_effectively_on_stage_view (ClutterActor     *self,
 CLUTTER_EXPORT
 int64_t clutter_stage_get_frame_counter (ClutterStage *stage);
 
+CLUTTER_EXPORT
+uint64_t clutter_stage_get_damage_serial (ClutterStage *stage);
+
 CLUTTER_EXPORT
 void clutter_stage_capture_view_into (ClutterStage     *stage,
                                       ClutterStageView *view,
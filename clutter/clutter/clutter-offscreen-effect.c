@@ -83,6 +83,10 @@
  *
  * In both cases, the "Pipeline" node is created with the return value
  * of [vfunc@OffscreenEffect.create_pipeline].
+ *
+ * When only part of the actor was damaged since its contents were last
+ * drawn, and the actor is drawn without rotation on a single stage view,
+ * only the damaged part of the offscreen buffer is drawn again.
  */
 
 #include "config.h"
@@ -122,6 +126,16 @@ typedef struct _ClutterOffscreenEffectPrivate
   int target_width;
   int target_height;
 
+  /* Whether the fbo holds the contents of the actor as last drawn in
+     stage space at contents_vertices, so that they can be updated in
+     place when only part of them is damaged */
+  gboolean contents_valid;
+  int contents_offset_x;
+  int contents_offset_y;
+  graphene_point3d_t contents_vertices[4];
+
+  MtkRegion *update_region;
+
   gulong purge_handler_id;
 } ClutterOffscreenEffectPrivate;
 
@@ -205,6 +219,78 @@ clutter_offscreen_effect_real_create_pipeline (ClutterOffscreenEffect *effect,
   return pipeline;
 }
 
+static gboolean
+uses_default_texture (ClutterOffscreenEffect *self)
+{
+  return (CLUTTER_OFFSCREEN_EFFECT_GET_CLASS (self)->create_texture ==
+          clutter_offscreen_effect_real_create_texture);
+}
+
+static void
+release_fbo (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  g_clear_object (&priv->pipeline);
+  g_clear_object (&priv->texture);
+
+  /* Offscreens backed by the default texture come from the context's
+   * pool; hand them back so effects of the same size can reuse them */
+  if (priv->offscreen && uses_default_texture (self))
+    {
+      cogl_context_release_offscreen (ctx,
+                                      g_steal_pointer (&priv->offscreen),
+                                      COGL_PIXEL_FORMAT_ANY);
+    }
+  else
+    {
+      g_clear_object (&priv->offscreen);
+    }
+}
+
+static CoglOffscreen *
+create_offscreen (ClutterOffscreenEffect  *self,
+                  int                      target_width,
+                  int                      target_height,
+                  GError                 **error)
+{
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  CoglOffscreen *offscreen;
+
+  if (uses_default_texture (self))
+    {
+      offscreen = cogl_context_acquire_offscreen (ctx,
+                                                  MAX (target_width, 1),
+                                                  MAX (target_height, 1),
+                                                  COGL_PIXEL_FORMAT_ANY,
+                                                  error);
+      if (offscreen)
+        priv->texture = g_object_ref (cogl_offscreen_get_texture (offscreen));
+
+      return offscreen;
+    }
+
+  priv->texture =
+    clutter_offscreen_effect_create_texture (self, target_width, target_height);
+  if (priv->texture == NULL)
+    return NULL;
+
+  offscreen = cogl_offscreen_new_with_texture (priv->texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    {
+      g_clear_object (&offscreen);
+      g_clear_object (&priv->texture);
+    }
+
+  return offscreen;
+}
+
 static void
 video_memory_purged (ClutterOffscreenEffect *self)
 {
@@ -264,25 +350,17 @@ update_fbo (ClutterEffect *effect,
       return TRUE;
     }
 
-  g_clear_object (&priv->texture);
-  g_clear_object (&priv->offscreen);
-
-  priv->texture =
-    clutter_offscreen_effect_create_texture (self, target_width, target_height);
-  if (priv->texture == NULL)
-    return FALSE;
-
-  priv->target_width = target_width;
-  priv->target_height = target_height;
+  release_fbo (self);
+  priv->contents_valid = FALSE;
 
-  offscreen = cogl_offscreen_new_with_texture (priv->texture);
-  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+  offscreen = create_offscreen (self, target_width, target_height, &error);
+  if (!offscreen)
     {
-      g_warning ("Failed to create offscreen effect framebuffer: %s",
-                 error->message);
-
-      g_object_unref (offscreen);
-      g_clear_object (&priv->pipeline);
+      if (error)
+        {
+          g_warning ("Failed to create offscreen effect framebuffer: %s",
+                     error->message);
+        }
 
       priv->target_width = 0;
       priv->target_height = 0;
@@ -290,14 +368,133 @@ update_fbo (ClutterEffect *effect,
       return FALSE;
     }
 
+  priv->target_width = target_width;
+  priv->target_height = target_height;
   priv->offscreen = offscreen;
 
-  g_clear_object (&priv->pipeline);
   priv->pipeline = offscreen_class->create_pipeline (self, priv->texture);
 
   return TRUE;
 }
 
+static void
+get_contents_vertices (ClutterOffscreenEffect *self,
+                       float                   target_width,
+                       float                   target_height,
+                       float                   scale,
+                       graphene_point3d_t      vertices[4])
+{
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+  float x1 = priv->fbo_offset_x;
+  float y1 = priv->fbo_offset_y;
+  float x2 = x1 + target_width / scale;
+  float y2 = y1 + target_height / scale;
+
+  clutter_actor_apply_transform_to_point (priv->actor,
+                                          &GRAPHENE_POINT3D_INIT (x1, y1, 0.f),
+                                          &vertices[0]);
+  clutter_actor_apply_transform_to_point (priv->actor,
+                                          &GRAPHENE_POINT3D_INIT (x2, y1, 0.f),
+                                          &vertices[1]);
+  clutter_actor_apply_transform_to_point (priv->actor,
+                                          &GRAPHENE_POINT3D_INIT (x2, y2, 0.f),
+                                          &vertices[2]);
+  clutter_actor_apply_transform_to_point (priv->actor,
+                                          &GRAPHENE_POINT3D_INIT (x1, y2, 0.f),
+                                          &vertices[3]);
+}
+
+/* Maps the redraw clip onto the fbo, if the damage it holds can be
+ * translated into the contents drawn last time.
+ */
+static MtkRegion *
+calculate_update_region (ClutterOffscreenEffect   *self,
+                         ClutterPaintContext      *paint_context,
+                         const graphene_point3d_t  vertices[4],
+                         int                       target_width,
+                         int                       target_height)
+{
+  ClutterOffscreenEffectPrivate *priv =
+    clutter_offscreen_effect_get_instance_private (self);
+  const MtkRegion *redraw_clip;
+  ClutterStageView *view;
+  MtkRectangle view_layout;
+  MtkRegion *update_region;
+  float width, height;
+  int i, n_rects;
+
+  if (!priv->contents_valid ||
+      priv->contents_offset_x != priv->fbo_offset_x ||
+      priv->contents_offset_y != priv->fbo_offset_y)
+    return NULL;
+
+  /* Clones draw the actor somewhere else than what the damage refers to */
+  if (clutter_actor_is_in_clone_paint (priv->actor) ||
+      clutter_actor_has_mapped_clones (priv->actor))
+    return NULL;
+
+  redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
+  view = clutter_paint_context_get_stage_view (paint_context);
+  if (!redraw_clip || !view)
+    return NULL;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (!graphene_point3d_equal (&vertices[i], &priv->contents_vertices[i]))
+        return NULL;
+    }
+
+  if (!G_APPROX_VALUE (vertices[0].x, vertices[3].x, FLT_EPSILON) ||
+      !G_APPROX_VALUE (vertices[1].x, vertices[2].x, FLT_EPSILON) ||
+      !G_APPROX_VALUE (vertices[0].y, vertices[1].y, FLT_EPSILON) ||
+      !G_APPROX_VALUE (vertices[2].y, vertices[3].y, FLT_EPSILON) ||
+      vertices[1].x <= vertices[0].x ||
+      vertices[3].y <= vertices[0].y)
+    return NULL;
+
+  /* Views are painted one after another, and only the first one to paint
+   * the actor sees it as damaged; make sure that is the only view.
+   */
+  clutter_stage_view_get_layout (view, &view_layout);
+  if (vertices[0].x < view_layout.x ||
+      vertices[0].y < view_layout.y ||
+      vertices[2].x > view_layout.x + view_layout.width ||
+      vertices[2].y > view_layout.y + view_layout.height)
+    return NULL;
+
+  width = vertices[1].x - vertices[0].x;
+  height = vertices[3].y - vertices[0].y;
+
+  update_region = mtk_region_create ();
+  n_rects = mtk_region_num_rectangles (redraw_clip);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (redraw_clip, i);
+      float x1, y1, x2, y2;
+
+      x1 = (rect.x - vertices[0].x) / width * target_width;
+      y1 = (rect.y - vertices[0].y) / height * target_height;
+      x2 = (rect.x + rect.width - vertices[0].x) / width * target_width;
+      y2 = (rect.y + rect.height - vertices[0].y) / height * target_height;
+
+      /* Leave room for filtering when drawing the texture on the stage */
+      x1 = CLAMP (floorf (x1) - 1, 0, target_width);
+      y1 = CLAMP (floorf (y1) - 1, 0, target_height);
+      x2 = CLAMP (ceilf (x2) + 1, 0, target_width);
+      y2 = CLAMP (ceilf (y2) + 1, 0, target_height);
+
+      if (x1 >= x2 || y1 >= y2)
+        continue;
+
+      mtk_region_union_rectangle (update_region,
+                                  &MTK_RECTANGLE_INIT (x1, y1,
+                                                       x2 - x1, y2 - y1));
+    }
+
+  return update_region;
+}
+
 static gboolean
 clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
                                     ClutterPaintNode    *node,
@@ -310,6 +507,7 @@ clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
   ClutterActorBox raw_box, box;
   ClutterActor *stage;
   graphene_matrix_t projection, modelview, transform;
+  graphene_point3d_t vertices[4];
   const ClutterPaintVolume *volume;
   gfloat stage_width, stage_height;
   gfloat target_width = -1, target_height = -1;
@@ -409,6 +607,20 @@ clutter_offscreen_effect_pre_paint (ClutterEffect       *effect,
 
   cogl_framebuffer_set_projection_matrix (offscreen, &projection);
 
+  get_contents_vertices (self, target_width, target_height,
+                         ceiled_resource_scale, vertices);
+
+  g_clear_pointer (&priv->update_region, mtk_region_unref);
+  priv->update_region = calculate_update_region (self, paint_context,
+                                                 vertices,
+                                                 target_width,
+                                                 target_height);
+
+  priv->contents_valid = TRUE;
+  priv->contents_offset_x = priv->fbo_offset_x;
+  priv->contents_offset_y = priv->fbo_offset_y;
+  memcpy (priv->contents_vertices, vertices, sizeof (vertices));
+
   return TRUE;
 
 disable_effect:
@@ -536,6 +748,9 @@ clutter_offscreen_effect_paint_node (ClutterEffect           *effect,
   layer_node = clutter_layer_node_new_to_framebuffer (fb, priv->pipeline);
   clutter_paint_node_set_static_name (layer_node,
                                       "ClutterOffscreenEffect (actor offscreen)");
+  clutter_layer_node_set_update_region (CLUTTER_LAYER_NODE (layer_node),
+                                        priv->update_region);
+  g_clear_pointer (&priv->update_region, mtk_region_unref);
   clutter_paint_node_add_child (node, layer_node);
   clutter_paint_node_unref (layer_node);
 
@@ -592,9 +807,8 @@ clutter_offscreen_effect_finalize (GObject *gobject)
   ClutterOffscreenEffectPrivate *priv =
     clutter_offscreen_effect_get_instance_private (self);
 
-  g_clear_object (&priv->offscreen);
-  g_clear_object (&priv->texture);
-  g_clear_object (&priv->pipeline);
+  release_fbo (self);
+  g_clear_pointer (&priv->update_region, mtk_region_unref);
 
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->finalize (gobject);
 }
@@ -29,6 +29,7 @@
 #include "clutter/clutter-backend.h"
 #include "clutter/clutter-paint-context.h"
 #include "clutter/clutter-paint-node.h"
+#include "clutter/clutter-paint-nodes.h"
 
 G_BEGIN_DECLS
 
@@ -107,6 +108,10 @@ ClutterPaintNode *      _clutter_dummy_node_new                         (Clutter
 G_GNUC_INTERNAL
 guint                   clutter_paint_node_get_n_children               (ClutterPaintNode      *node);
 
+G_GNUC_INTERNAL
+void                    clutter_layer_node_set_update_region            (ClutterLayerNode      *layer_node,
+                                                                         MtkRegion             *region);
+
 #define CLUTTER_TYPE_EFFECT_NODE                (clutter_effect_node_get_type ())
 #define CLUTTER_EFFECT_NODE(obj)                (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_EFFECT_NODE, ClutterEffectNode))
 #define CLUTTER_IS_EFFECT_NODE(obj)             (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_EFFECT_NODE))
@@ -59,6 +59,16 @@
 
 static inline void      clutter_paint_operation_clear   (ClutterPaintOperation *op);
 
+/* Most paint nodes only live for the frame they were created for, and are
+ * replaced by similar nodes on the next one, so instead of freeing their
+ * operation arrays they are kept around for reuse. Arrays that grew larger
+ * than MAX_POOLED_OPERATIONS are freed, to not hold on to their memory.
+ */
+#define OPERATIONS_POOL_SIZE 256
+#define MAX_POOLED_OPERATIONS 64
+
+static GPtrArray *operations_pool = NULL;
+
 static void clutter_paint_node_remove_child (ClutterPaintNode *node,
                                              ClutterPaintNode *child);
 
@@ -170,7 +180,19 @@ clutter_paint_node_real_finalize (ClutterPaintNode *node)
           clutter_paint_operation_clear (op);
         }
 
-      g_array_unref (node->operations);
+      if (!operations_pool)
+        operations_pool = g_ptr_array_sized_new (OPERATIONS_POOL_SIZE);
+
+      if (operations_pool->len < OPERATIONS_POOL_SIZE &&
+          node->operations->len <= MAX_POOLED_OPERATIONS)
+        {
+          g_array_set_size (node->operations, 0);
+          g_ptr_array_add (operations_pool, g_steal_pointer (&node->operations));
+        }
+      else
+        {
+          g_clear_pointer (&node->operations, g_array_unref);
+        }
     }
 
   iter = node->first_child;
@@ -668,6 +690,13 @@ clutter_paint_node_maybe_init_operations (ClutterPaintNode *node)
   if (node->operations != NULL)
     return;
 
+  if (operations_pool && operations_pool->len > 0)
+    {
+      node->operations = g_ptr_array_steal_index_fast (operations_pool,
+                                                       operations_pool->len - 1);
+      return;
+    }
+
   node->operations =
     g_array_new (FALSE, FALSE, sizeof (ClutterPaintOperation));
 }
@@ -1150,6 +1150,7 @@ struct _ClutterLayerNode
 
   CoglPipeline *pipeline;
   CoglFramebuffer *offscreen;
+  MtkRegion *update_region;
 
   guint8 opacity;
 };
@@ -1174,6 +1175,13 @@ clutter_layer_node_pre_draw (ClutterPaintNode *node,
     return FALSE;
 
   clutter_paint_context_push_framebuffer (paint_context, lnode->offscreen);
+  cogl_framebuffer_push_gpu_trace (lnode->offscreen,
+                                   "GPU::Clutter::LayerNode::draw()",
+                                   node->name);
+
+  /* leave the contents outside of the update region untouched */
+  if (lnode->update_region)
+    cogl_framebuffer_push_region_clip (lnode->offscreen, lnode->update_region);
 
   /* clear out the target framebuffer */
   cogl_framebuffer_clear4f (lnode->offscreen,
@@ -1199,6 +1207,9 @@ clutter_layer_node_post_draw (ClutterPaintNode    *node,
 
   /* switch to the previous framebuffer */
   cogl_framebuffer_pop_matrix (lnode->offscreen);
+  if (lnode->update_region)
+    cogl_framebuffer_pop_clip (lnode->offscreen);
+  cogl_framebuffer_pop_gpu_trace (lnode->offscreen);
   clutter_paint_context_pop_framebuffer (paint_context);
 
   if (!node->operations)
@@ -1264,6 +1275,7 @@ clutter_layer_node_finalize (ClutterPaintNode *node)
 
   g_clear_object (&lnode->pipeline);
   g_clear_object (&lnode->offscreen);
+  g_clear_pointer (&lnode->update_region, mtk_region_unref);
 
   CLUTTER_PAINT_NODE_CLASS (clutter_layer_node_parent_class)->finalize (node);
 }
@@ -1320,6 +1332,25 @@ clutter_layer_node_new_to_framebuffer (CoglFramebuffer *framebuffer,
   return (ClutterPaintNode *) res;
 }
 
+/*< private >
+ * clutter_layer_node_set_update_region:
+ * @layer_node: a #ClutterLayerNode
+ * @region: (nullable): the region to update, in framebuffer pixels
+ *
+ * Limits the drawing of the children of @layer_node, including the
+ * initial clear, to @region. The rest of the contents of the framebuffer
+ * are preserved. Only meaningful for nodes created with
+ * clutter_layer_node_new_to_framebuffer().
+ */
+void
+clutter_layer_node_set_update_region (ClutterLayerNode *layer_node,
+                                      MtkRegion        *region)
+{
+  g_clear_pointer (&layer_node->update_region, mtk_region_unref);
+  if (region)
+    layer_node->update_region = mtk_region_ref (region);
+}
+
 /*
  * ClutterBlitNode
  */
@@ -1493,10 +1524,131 @@ struct _ClutterBlurNode
 
   ClutterBlur *blur;
   unsigned int radius;
+
+  gboolean has_blur_area;
+  MtkRectangle blur_area;
 };
 
 G_DEFINE_TYPE (ClutterBlurNode, clutter_blur_node, CLUTTER_TYPE_LAYER_NODE)
 
+/* Finds the part of the blurred texture that ends up inside the redraw clip
+ * when drawn on the current framebuffer. This is only attempted for the
+ * simple case of a single axis aligned rectangle drawn straight on a view.
+ */
+static gboolean
+clutter_blur_node_get_blur_area (ClutterBlurNode     *blur_node,
+                                 ClutterPaintContext *paint_context,
+                                 MtkRectangle        *area)
+{
+  ClutterPaintNode *node = CLUTTER_PAINT_NODE (blur_node);
+  const ClutterPaintOperation *op;
+  graphene_matrix_t modelview, projection;
+  graphene_point3d_t vertices[4];
+  const MtkRegion *redraw_clip;
+  MtkRectangle clip_extents;
+  MtkRectangle view_layout;
+  ClutterStageView *view;
+  CoglFramebuffer *fb;
+  CoglTexture *texture;
+  float viewport[4];
+  float view_scale;
+  float x1, y1, x2, y2;
+  float tx1, ty1, tx2, ty2;
+
+  if (!node->operations || node->operations->len != 1)
+    return FALSE;
+
+  op = &g_array_index (node->operations, ClutterPaintOperation, 0);
+  if (op->opcode != PAINT_OP_TEX_RECT)
+    return FALSE;
+
+  redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
+  view = clutter_paint_context_get_stage_view (paint_context);
+  if (!redraw_clip || !view)
+    return FALSE;
+
+  fb = clutter_paint_context_get_framebuffer (paint_context);
+  if (fb != clutter_stage_view_get_framebuffer (view))
+    return FALSE;
+
+  cogl_framebuffer_get_modelview_matrix (fb, &modelview);
+  cogl_framebuffer_get_projection_matrix (fb, &projection);
+  cogl_framebuffer_get_viewport4fv (fb, viewport);
+
+  vertices[0] = GRAPHENE_POINT3D_INIT (op->op.texrect[0], op->op.texrect[1], 0.f);
+  vertices[1] = GRAPHENE_POINT3D_INIT (op->op.texrect[2], op->op.texrect[1], 0.f);
+  vertices[2] = GRAPHENE_POINT3D_INIT (op->op.texrect[2], op->op.texrect[3], 0.f);
+  vertices[3] = GRAPHENE_POINT3D_INIT (op->op.texrect[0], op->op.texrect[3], 0.f);
+
+  _clutter_util_fully_transform_vertices (&modelview, &projection, viewport,
+                                          vertices, vertices, 4);
+
+  if (!G_APPROX_VALUE (vertices[0].x, vertices[3].x, FLT_EPSILON) ||
+      !G_APPROX_VALUE (vertices[1].x, vertices[2].x, FLT_EPSILON) ||
+      !G_APPROX_VALUE (vertices[0].y, vertices[1].y, FLT_EPSILON) ||
+      !G_APPROX_VALUE (vertices[2].y, vertices[3].y, FLT_EPSILON) ||
+      vertices[1].x <= vertices[0].x ||
+      vertices[3].y <= vertices[0].y)
+    return FALSE;
+
+  tx1 = op->op.texrect[4];
+  ty1 = op->op.texrect[5];
+  tx2 = op->op.texrect[6];
+  ty2 = op->op.texrect[7];
+  if (tx2 <= tx1 || ty2 <= ty1)
+    return FALSE;
+
+  /* The redraw clip is in stage coordinates */
+  clip_extents = mtk_region_get_extents (redraw_clip);
+  clutter_stage_view_get_layout (view, &view_layout);
+  view_scale = clutter_stage_view_get_scale (view);
+
+  x1 = (clip_extents.x - view_layout.x) * view_scale;
+  y1 = (clip_extents.y - view_layout.y) * view_scale;
+  x2 = x1 + clip_extents.width * view_scale;
+  y2 = y1 + clip_extents.height * view_scale;
+
+  /* From framebuffer to texture coordinates */
+  x1 = tx1 + (x1 - vertices[0].x) / (vertices[1].x - vertices[0].x) * (tx2 - tx1);
+  x2 = tx1 + (x2 - vertices[0].x) / (vertices[1].x - vertices[0].x) * (tx2 - tx1);
+  y1 = ty1 + (y1 - vertices[0].y) / (vertices[3].y - vertices[0].y) * (ty2 - ty1);
+  y2 = ty1 + (y2 - vertices[0].y) / (vertices[3].y - vertices[0].y) * (ty2 - ty1);
+
+  texture = clutter_blur_get_texture (blur_node->blur);
+  x1 *= cogl_texture_get_width (texture);
+  x2 *= cogl_texture_get_width (texture);
+  y1 *= cogl_texture_get_height (texture);
+  y2 *= cogl_texture_get_height (texture);
+
+  /* Leave room for the filtering when drawing the blurred texture */
+  area->x = floorf (x1) - 1;
+  area->y = floorf (y1) - 1;
+  area->width = ceilf (x2) + 1 - area->x;
+  area->height = ceilf (y2) + 1 - area->y;
+
+  return TRUE;
+}
+
+static gboolean
+clutter_blur_node_pre_draw (ClutterPaintNode    *node,
+                            ClutterPaintContext *paint_context)
+{
+  ClutterPaintNodeClass *parent_class =
+    CLUTTER_PAINT_NODE_CLASS (clutter_blur_node_parent_class);
+  ClutterBlurNode *blur_node = CLUTTER_BLUR_NODE (node);
+
+  /* Nodes can be painted more than once, find out what is visible of this
+   * one on every paint.
+   */
+  blur_node->has_blur_area =
+    blur_node->blur &&
+    clutter_blur_node_get_blur_area (blur_node,
+                                     paint_context,
+                                     &blur_node->blur_area);
+
+  return parent_class->pre_draw (node, paint_context);
+}
+
 static void
 clutter_blur_node_post_draw (ClutterPaintNode    *node,
                              ClutterPaintContext *paint_context)
@@ -1505,7 +1657,10 @@ clutter_blur_node_post_draw (ClutterPaintNode    *node,
     CLUTTER_PAINT_NODE_CLASS (clutter_blur_node_parent_class);
   ClutterBlurNode *blur_node = CLUTTER_BLUR_NODE (node);
 
-  clutter_blur_apply (blur_node->blur);
+  if (blur_node->has_blur_area)
+    clutter_blur_apply_region (blur_node->blur, &blur_node->blur_area);
+  else
+    clutter_blur_apply (blur_node->blur);
 
   parent_class->post_draw (node, paint_context);
 }
@@ -1526,6 +1681,7 @@ clutter_blur_node_class_init (ClutterBlurNodeClass *klass)
   ClutterPaintNodeClass *node_class;
 
   node_class = CLUTTER_PAINT_NODE_CLASS (klass);
+  node_class->pre_draw = clutter_blur_node_pre_draw;
   node_class->post_draw = clutter_blur_node_post_draw;
   node_class->finalize = clutter_blur_node_finalize;
 }
@@ -1553,6 +1709,29 @@ ClutterPaintNode *
 clutter_blur_node_new (unsigned int width,
                        unsigned int height,
                        float        radius)
+{
+  return clutter_blur_node_new_with_mode (width, height, radius,
+                                          CLUTTER_BLUR_MODE_GAUSSIAN);
+}
+
+/**
+ * clutter_blur_node_new_with_mode:
+ * @width width of the blur layer
+ * @height: height of the blur layer
+ * @radius: radius (in pixels) of the blur
+ * @mode: the blur algorithm to use
+ *
+ * Creates a new #ClutterBlurNode using the given blur algorithm. Using
+ * %CLUTTER_BLUR_MODE_DUAL_FILTER is considerably cheaper for large radii.
+ *
+ * Return value: (transfer full): the newly created #ClutterBlurNode.
+ *   Use clutter_paint_node_unref() when done.
+ */
+ClutterPaintNode *
+clutter_blur_node_new_with_mode (unsigned int    width,
+                                 unsigned int    height,
+                                 float           radius,
+                                 ClutterBlurMode mode)
 {
   g_autoptr (CoglOffscreen) offscreen = NULL;
   g_autoptr (GError) error = NULL;
@@ -1580,7 +1759,7 @@ clutter_blur_node_new (unsigned int width,
       goto out;
     }
 
-  blur = clutter_blur_new (texture, radius);
+  blur = clutter_blur_new (texture, radius, mode);
   blur_node->blur = blur;
 
   if (!blur)
@@ -196,4 +196,10 @@ ClutterPaintNode * clutter_blur_node_new (unsigned int width,
                                           unsigned int height,
                                           float        radius);
 
+CLUTTER_EXPORT
+ClutterPaintNode * clutter_blur_node_new_with_mode (unsigned int    width,
+                                                    unsigned int    height,
+                                                    float           radius,
+                                                    ClutterBlurMode mode);
+
 G_END_DECLS
@@ -26,6 +26,13 @@ clutter_pick_context_new_for_view (ClutterStageView         *view,
                                    const graphene_point3d_t *point,
                                    const graphene_ray_t     *ray);
 
+ClutterPickContext *
+clutter_pick_context_new_for_view_multiple (ClutterStageView         *view,
+                                            ClutterPickMode           mode,
+                                            int                       n_points,
+                                            const graphene_point3d_t *points,
+                                            const graphene_ray_t     *rays);
+
 ClutterPickStack *
 clutter_pick_context_steal_stack (ClutterPickContext *pick_context);
 
@@ -27,6 +27,13 @@ struct _ClutterPickContext
   ClutterPickMode mode;
   ClutterPickStack *pick_stack;
 
+  /* Points picked by the same traversal, an actor is only culled if
+     it is hit by none of them. These point to the inline storage below
+     when there is only one */
+  int n_points;
+  graphene_ray_t *rays;
+  graphene_point3d_t *points;
+
   graphene_ray_t ray;
   graphene_point3d_t point;
 };
@@ -40,15 +47,41 @@ clutter_pick_context_new_for_view (ClutterStageView         *view,
                                    ClutterPickMode           mode,
                                    const graphene_point3d_t *point,
                                    const graphene_ray_t     *ray)
+{
+  return clutter_pick_context_new_for_view_multiple (view, mode,
+                                                     1, point, ray);
+}
+
+ClutterPickContext *
+clutter_pick_context_new_for_view_multiple (ClutterStageView         *view,
+                                            ClutterPickMode           mode,
+                                            int                       n_points,
+                                            const graphene_point3d_t *points,
+                                            const graphene_ray_t     *rays)
 {
   ClutterPickContext *pick_context;
   CoglContext *context;
 
+  g_return_val_if_fail (n_points > 0, NULL);
+
   pick_context = g_new0 (ClutterPickContext, 1);
   g_ref_count_init (&pick_context->ref_count);
   pick_context->mode = mode;
-  graphene_ray_init_from_ray (&pick_context->ray, ray);
-  graphene_point3d_init_from_point (&pick_context->point, point);
+  pick_context->n_points = n_points;
+
+  if (n_points == 1)
+    {
+      graphene_ray_init_from_ray (&pick_context->ray, rays);
+      graphene_point3d_init_from_point (&pick_context->point, points);
+      pick_context->rays = &pick_context->ray;
+      pick_context->points = &pick_context->point;
+    }
+  else
+    {
+      pick_context->rays = g_memdup2 (rays, n_points * sizeof (graphene_ray_t));
+      pick_context->points = g_memdup2 (points,
+                                        n_points * sizeof (graphene_point3d_t));
+    }
 
   context = clutter_backend_get_cogl_context (clutter_get_default_backend ());
   pick_context->pick_stack = clutter_pick_stack_new (context);
@@ -67,6 +100,11 @@ static void
 clutter_pick_context_dispose (ClutterPickContext *pick_context)
 {
   g_clear_pointer (&pick_context->pick_stack, clutter_pick_stack_unref);
+  if (pick_context->n_points > 1)
+    {
+      g_clear_pointer (&pick_context->rays, g_free);
+      g_clear_pointer (&pick_context->points, g_free);
+    }
 }
 
 void
@@ -208,6 +246,14 @@ gboolean
 clutter_pick_context_intersects_box (ClutterPickContext   *pick_context,
                                      const graphene_box_t *box)
 {
-  return graphene_box_contains_point (box, &pick_context->point) ||
-         graphene_ray_intersects_box (&pick_context->ray, box);
+  int i;
+
+  for (i = 0; i < pick_context->n_points; i++)
+    {
+      if (graphene_box_contains_point (box, &pick_context->points[i]) ||
+          graphene_ray_intersects_box (&pick_context->rays[i], box))
+        return TRUE;
+    }
+
+  return FALSE;
 }
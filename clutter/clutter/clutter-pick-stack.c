@@ -525,6 +525,13 @@ clutter_pick_stack_search_actor (ClutterPickStack          *pick_stack,
   /* Search all "painted" pickable actors from front to back. A linear search
    * is required, and also performs fine since there is typically only
    * on the order of dozens of actors in the list (on screen) at a time.
+   *
+   * A spatial index wouldn't pay off here: the pick stack is built for one
+   * or a handful of points and rays, with actors whose paint volume
+   * doesn't intersect any of the rays already culled while picking, and
+   * it is searched once per point.
+   * Repeated picks while the pointer moves are instead avoided with the
+   * clear area, within which the picked actor stays valid.
    */
   for (i = pick_stack->vertices_stack->len - 1; i >= 0; i--)
     {
@@ -32,6 +32,7 @@
 
 #include "clutter/clutter-property-transition.h"
 
+#include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-animatable.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-interval.h"
@@ -146,6 +147,13 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   clutter_property_transition_ensure_interval (self, animatable, interval);
 
+  if (CLUTTER_IS_ACTOR (animatable) &&
+      clutter_actor_interpolate_final_state (CLUTTER_ACTOR (animatable),
+                                             priv->pspec,
+                                             interval,
+                                             progress))
+    return;
+
   p_type = G_PARAM_SPEC_VALUE_TYPE (priv->pspec);
   i_type = clutter_interval_get_value_type (interval);
 
@@ -81,6 +81,9 @@ CLUTTER_EXPORT
 void                _clutter_stage_maybe_setup_viewport  (ClutterStage          *stage,
                                                           ClutterStageView      *view);
 void                clutter_stage_maybe_relayout         (ClutterActor          *stage);
+CLUTTER_EXPORT
+void                clutter_stage_maybe_relayout_for_view (ClutterStage         *stage,
+                                                           ClutterStageView     *view);
 GSList *            clutter_stage_find_updated_devices   (ClutterStage          *stage,
                                                           ClutterStageView      *view);
 void                clutter_stage_update_devices         (ClutterStage          *stage,
@@ -93,6 +96,9 @@ void     _clutter_stage_queue_event                       (ClutterStage *stage,
                                                            gboolean      copy_event);
 void     _clutter_stage_process_queued_events             (ClutterStage *stage);
 
+void clutter_stage_process_queued_events_for_presentation (ClutterStage *stage,
+                                                           int64_t       presentation_time_us);
+
 void            clutter_stage_presented                 (ClutterStage      *stage,
                                                          ClutterStageView  *view,
                                                          ClutterFrameInfo  *frame_info);
@@ -154,4 +160,31 @@ ClutterGrab * clutter_stage_grab_input_only (ClutterStage        *self,
 
 void clutter_stage_invalidate_devices (ClutterStage *stage);
 
+/* What the actors sharing a debug name cost to paint and pick, while
+ * CLUTTER_DEBUG_ACTOR_COSTS is set. Times are in microseconds and don't
+ * include the children of the actors.
+ */
+typedef struct _ClutterActorCost
+{
+  const char *name;
+  unsigned int n_paints;
+  int64_t paint_time_us;
+  unsigned int n_picks;
+  int64_t pick_time_us;
+  uint64_t n_journal_entries;
+  uint64_t n_draw_calls;
+} ClutterActorCost;
+
+void clutter_stage_push_actor_cost (ClutterStage *stage);
+
+void clutter_stage_pop_actor_cost (ClutterStage *stage,
+                                   ClutterActor *actor,
+                                   gboolean      is_pick);
+
+CLUTTER_EXPORT
+GArray * clutter_stage_get_actor_costs (ClutterStage *stage);
+
+CLUTTER_EXPORT
+void clutter_stage_reset_actor_costs (ClutterStage *stage);
+
 G_END_DECLS
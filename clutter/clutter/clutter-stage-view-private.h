@@ -21,6 +21,28 @@
 #include "clutter/clutter-types.h"
 #include "mtk/mtk.h"
 
+#define CLUTTER_STAGE_VIEW_N_FRAME_RECORDS 256
+
+/* Timings of a single frame of a view. Durations and times are in
+ * microseconds, times are CLOCK_MONOTONIC.
+ */
+typedef struct _ClutterFrameRecord
+{
+  int64_t frame_count;
+  int64_t dispatch_time_us;
+  int64_t layout_duration_us;
+  int64_t paint_duration_us;
+  int64_t pick_duration_us;
+  int64_t gpu_duration_us;
+  int64_t presentation_time_us;
+  int64_t target_presentation_time_us;
+  /* Time of the oldest input event the frame reflects, or 0 */
+  int64_t input_time_us;
+  gboolean is_presented;
+  gboolean missed_vblank;
+  gboolean is_scanout;
+} ClutterFrameRecord;
+
 CLUTTER_EXPORT
 void clutter_stage_view_after_paint (ClutterStageView *view,
                                      MtkRegion        *redraw_clip);
@@ -81,3 +103,11 @@ CLUTTER_EXPORT
 void clutter_stage_view_notify_ready (ClutterStageView *view);
 
 void clutter_stage_view_invalidate_input_devices (ClutterStageView *view);
+
+void clutter_stage_view_notify_input_processed (ClutterStageView *view,
+                                                int64_t           input_time_us);
+
+CLUTTER_EXPORT
+int clutter_stage_view_get_frame_records (ClutterStageView   *view,
+                                          ClutterFrameRecord *records,
+                                          int                 n_records);
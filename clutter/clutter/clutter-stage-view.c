@@ -27,6 +27,7 @@
 #include "clutter/clutter-damage-history.h"
 #include "clutter/clutter-frame-clock.h"
 #include "clutter/clutter-frame-private.h"
+#include "clutter/clutter-damage-tiles.h"
 #include "clutter/clutter-private.h"
 #include "clutter/clutter-mutter.h"
 #include "clutter/clutter-stage-private.h"
@@ -42,6 +43,7 @@ enum
   PROP_FRAMEBUFFER,
   PROP_OFFSCREEN,
   PROP_USE_SHADOWFB,
+  PROP_OFFSCREEN_FORMAT,
   PROP_SCALE,
   PROP_REFRESH_RATE,
   PROP_VBLANK_DURATION_US,
@@ -51,6 +53,8 @@ enum
 
 static GParamSpec *obj_props[PROP_LAST];
 
+#define MAX_REDRAW_CLIP_RECTANGLES 32
+
 enum
 {
   DESTROY,
@@ -73,6 +77,7 @@ typedef struct _ClutterStageViewPrivate
   CoglPipeline *offscreen_pipeline;
 
   gboolean use_shadowfb;
+  CoglPixelFormat offscreen_format;
   struct {
     CoglOffscreen *framebuffer;
   } shadow;
@@ -81,6 +86,11 @@ typedef struct _ClutterStageViewPrivate
 
   gboolean has_redraw_clip;
   MtkRegion *redraw_clip;
+  /* Once the redraw clip gets too complex, further damage is tracked with
+   * tiles instead, so that adding damage has a bounded cost.
+   */
+  gboolean use_redraw_tiles;
+  ClutterDamageTiles *redraw_tiles;
   gboolean has_accumulated_redraw_clip;
   MtkRegion *accumulated_redraw_clip;
 
@@ -96,6 +106,18 @@ typedef struct _ClutterStageViewPrivate
     int64_t worst_draw_time_us;
   } frame_timings;
 
+  /* Ring buffer of the most recent frames. Only ever accessed from the main
+   * thread, so no locking is needed.
+   */
+  struct {
+    ClutterFrameRecord records[CLUTTER_STAGE_VIEW_N_FRAME_RECORDS];
+    int n_records;
+    int next_record;
+    int n_pending_presentation;
+    /* Oldest input event processed since the last painted frame */
+    int64_t pending_input_time_us;
+  } frame_records;
+
   guint dirty_viewport   : 1;
   guint dirty_projection : 1;
   guint needs_update_devices : 1;
@@ -308,6 +330,7 @@ paint_transformed_framebuffer (ClutterStageView *view,
 
 static CoglOffscreen *
 create_offscreen_framebuffer (ClutterStageView  *view,
+                              CoglPixelFormat    format,
                               int                width,
                               int                height,
                               GError           **error)
@@ -319,7 +342,8 @@ create_offscreen_framebuffer (ClutterStageView  *view,
   CoglTexture *texture;
 
   cogl_context = cogl_framebuffer_get_context (priv->framebuffer);
-  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  texture = cogl_texture_2d_new_with_format (cogl_context, width, height,
+                                             format);
   cogl_primitive_texture_set_auto_mipmap (texture, FALSE);
 
   if (!cogl_texture_allocate (texture, error))
@@ -352,10 +376,12 @@ init_shadowfb (ClutterStageView *view)
   width = cogl_framebuffer_get_width (priv->framebuffer);
   height = cogl_framebuffer_get_height (priv->framebuffer);
 
-  offscreen = create_offscreen_framebuffer (view, width, height, &error);
+  offscreen = create_offscreen_framebuffer (view, priv->offscreen_format,
+                                            width, height, &error);
   if (!offscreen)
     {
       g_warning ("Failed to create shadow framebuffer: %s", error->message);
+      priv->use_shadowfb = FALSE;
       return;
     }
 
@@ -405,6 +431,9 @@ copy_shadowfb_to_onscreen (ClutterStageView *view,
   g_autoptr (MtkRegion) damage_region = NULL;
   int i;
 
+  /* The swap region includes the damage of the frames the back buffer
+   * missed, so it is only empty if the back buffer can't be trusted at all.
+   */
   if (mtk_region_is_empty (swap_region))
     {
       MtkRectangle full_damage = {
@@ -418,6 +447,10 @@ copy_shadowfb_to_onscreen (ClutterStageView *view,
       damage_region = mtk_region_copy (swap_region);
     }
 
+  cogl_framebuffer_push_gpu_trace (priv->framebuffer,
+                                   "GPU::Clutter::StageView::copy_shadowfb_to_onscreen()",
+                                   NULL);
+
   for (i = 0; i < mtk_region_num_rectangles (damage_region); i++)
     {
       CoglFramebuffer *shadowfb = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
@@ -434,9 +467,11 @@ copy_shadowfb_to_onscreen (ClutterStageView *view,
                                   &error))
         {
           g_warning ("Failed to blit shadow buffer: %s", error->message);
-          return;
+          break;
         }
     }
+
+  cogl_framebuffer_pop_gpu_trace (priv->framebuffer);
 }
 
 void
@@ -604,6 +639,55 @@ maybe_mark_full_redraw (ClutterStageView  *view,
     }
 }
 
+static void
+begin_redraw_tiles (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  if (priv->redraw_tiles &&
+      !mtk_rectangle_equal (clutter_damage_tiles_get_layout (priv->redraw_tiles),
+                            &priv->layout))
+    g_clear_pointer (&priv->redraw_tiles, clutter_damage_tiles_free);
+
+  if (!priv->redraw_tiles)
+    priv->redraw_tiles = clutter_damage_tiles_new (&priv->layout);
+  else
+    clutter_damage_tiles_clear (priv->redraw_tiles);
+
+  clutter_damage_tiles_add_region (priv->redraw_tiles, priv->redraw_clip);
+  g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+  priv->use_redraw_tiles = TRUE;
+}
+
+static void
+flush_redraw_tiles (ClutterStageView *view)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  if (!priv->use_redraw_tiles)
+    return;
+
+  g_assert (!priv->redraw_clip);
+
+  priv->redraw_clip = clutter_damage_tiles_to_region (priv->redraw_tiles);
+  priv->use_redraw_tiles = FALSE;
+}
+
+static void
+add_redraw_clip_tiles (ClutterStageView   *view,
+                       const MtkRectangle *clip)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  clutter_damage_tiles_add_rectangle (priv->redraw_tiles, clip);
+
+  if (clutter_damage_tiles_is_full (priv->redraw_tiles))
+    priv->use_redraw_tiles = FALSE;
+}
+
 void
 clutter_stage_view_add_redraw_clip (ClutterStageView   *view,
                                     const MtkRectangle *clip)
@@ -611,12 +695,13 @@ clutter_stage_view_add_redraw_clip (ClutterStageView   *view,
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
 
-  if (priv->has_redraw_clip && !priv->redraw_clip)
+  if (clutter_stage_view_has_full_redraw_clip (view))
     return;
 
   if (!clip)
     {
       g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+      priv->use_redraw_tiles = FALSE;
       priv->has_redraw_clip = TRUE;
       return;
     }
@@ -624,7 +709,11 @@ clutter_stage_view_add_redraw_clip (ClutterStageView   *view,
   if (clip->width == 0 || clip->height == 0)
     return;
 
-  if (!priv->redraw_clip)
+  if (priv->use_redraw_tiles)
+    {
+      add_redraw_clip_tiles (view, clip);
+    }
+  else if (!priv->redraw_clip)
     {
       if (!mtk_rectangle_equal (&priv->layout, clip))
         priv->redraw_clip = mtk_region_create_rectangle (clip);
@@ -633,6 +722,11 @@ clutter_stage_view_add_redraw_clip (ClutterStageView   *view,
     {
       mtk_region_union_rectangle (priv->redraw_clip, clip);
       maybe_mark_full_redraw (view, &priv->redraw_clip);
+
+      if (priv->redraw_clip &&
+          mtk_region_num_rectangles (priv->redraw_clip) >
+          MAX_REDRAW_CLIP_RECTANGLES)
+        begin_redraw_tiles (view);
     }
 
   priv->has_redraw_clip = TRUE;
@@ -653,7 +747,9 @@ clutter_stage_view_has_full_redraw_clip (ClutterStageView *view)
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
 
-  return priv->has_redraw_clip && !priv->redraw_clip;
+  return (priv->has_redraw_clip &&
+          !priv->redraw_clip &&
+          !priv->use_redraw_tiles);
 }
 
 MtkRegion *
@@ -678,6 +774,8 @@ clutter_stage_view_accumulate_redraw_clip (ClutterStageView *view)
 
   g_return_if_fail (priv->has_redraw_clip);
 
+  flush_redraw_tiles (view);
+
   if (priv->redraw_clip && priv->accumulated_redraw_clip)
     {
       mtk_region_union (priv->accumulated_redraw_clip, priv->redraw_clip);
@@ -791,8 +889,18 @@ handle_frame_clock_before_frame (ClutterFrameClock *frame_clock,
   ClutterStageView *view = user_data;
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
+  int64_t target_presentation_time_us;
 
-  _clutter_stage_process_queued_events (priv->stage);
+  if (clutter_frame_get_target_presentation_time (frame,
+                                                  &target_presentation_time_us))
+    {
+      clutter_stage_process_queued_events_for_presentation (priv->stage,
+                                                            target_presentation_time_us);
+    }
+  else
+    {
+      _clutter_stage_process_queued_events (priv->stage);
+    }
 }
 
 static void
@@ -859,6 +967,172 @@ end_frame_timing_measurement (ClutterStageView *view)
     }
 }
 
+static ClutterFrameRecord *
+begin_frame_record (ClutterStageView *view,
+                    ClutterFrame     *frame)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  ClutterFrameRecord *record;
+  int64_t target_presentation_time_us = 0;
+
+  record = &priv->frame_records.records[priv->frame_records.next_record];
+
+  /* Overwriting a record still waiting for its presentation feedback. */
+  if (priv->frame_records.n_records == CLUTTER_STAGE_VIEW_N_FRAME_RECORDS &&
+      !record->is_presented &&
+      priv->frame_records.n_pending_presentation > 0)
+    priv->frame_records.n_pending_presentation--;
+
+  clutter_frame_get_target_presentation_time (frame,
+                                              &target_presentation_time_us);
+
+  *record = (ClutterFrameRecord) {
+    .frame_count = clutter_frame_get_count (frame),
+    .dispatch_time_us = g_get_monotonic_time (),
+    .target_presentation_time_us = target_presentation_time_us,
+    .input_time_us = priv->frame_records.pending_input_time_us,
+  };
+
+  priv->frame_records.next_record =
+    (priv->frame_records.next_record + 1) % CLUTTER_STAGE_VIEW_N_FRAME_RECORDS;
+  priv->frame_records.n_records =
+    MIN (priv->frame_records.n_records + 1, CLUTTER_STAGE_VIEW_N_FRAME_RECORDS);
+
+  return record;
+}
+
+static void
+end_frame_record (ClutterStageView   *view,
+                  ClutterFrameRecord *record,
+                  ClutterFrameResult  result)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  if (result == CLUTTER_FRAME_RESULT_PENDING_PRESENTED)
+    priv->frame_records.n_pending_presentation++;
+  else
+    record->is_presented = TRUE;
+
+  /* Input that didn't result in anything being drawn is reflected by a
+   * later frame, if any.
+   */
+  if (result == CLUTTER_FRAME_RESULT_IDLE)
+    record->input_time_us = 0;
+  else
+    priv->frame_records.pending_input_time_us = 0;
+}
+
+static void
+record_frame_presented (ClutterStageView *view,
+                        ClutterFrameInfo *frame_info)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  ClutterFrameRecord *record;
+  int index;
+
+  if (priv->frame_records.n_pending_presentation == 0)
+    return;
+
+  /* Presentation feedback arrives in order, so it belongs to the oldest
+   * frame still waiting for it.
+   */
+  index = priv->frame_records.next_record -
+          priv->frame_records.n_pending_presentation;
+  if (index < 0)
+    index += CLUTTER_STAGE_VIEW_N_FRAME_RECORDS;
+
+  record = &priv->frame_records.records[index];
+  priv->frame_records.n_pending_presentation--;
+
+  record->is_presented = TRUE;
+  record->presentation_time_us = frame_info->presentation_time;
+  record->gpu_duration_us = frame_info->gpu_rendering_duration_ns / 1000;
+  record->is_scanout =
+    !!(frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY);
+
+  if (record->target_presentation_time_us != 0 &&
+      frame_info->presentation_time != 0)
+    {
+      int64_t refresh_interval_us =
+        (int64_t) (0.5 + G_USEC_PER_SEC / priv->refresh_rate);
+
+      record->missed_vblank =
+        frame_info->presentation_time - record->target_presentation_time_us >
+        refresh_interval_us / 2;
+    }
+
+  if (record->input_time_us != 0 &&
+      frame_info->presentation_time != 0)
+    {
+      COGL_TRACE_COUNTER ("Clutter input latency",
+                          priv->name ? priv->name : "unnamed view",
+                          frame_info->presentation_time -
+                          record->input_time_us);
+    }
+}
+
+/**
+ * clutter_stage_view_notify_input_processed:
+ * @view: a #ClutterStageView
+ * @input_time_us: time of the input event, CLOCK_MONOTONIC
+ *
+ * Tells @view that the stage processed an input event, so that the next
+ * frame painted for @view can be tagged with the oldest input event it
+ * reflects.
+ */
+void
+clutter_stage_view_notify_input_processed (ClutterStageView *view,
+                                           int64_t           input_time_us)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+
+  if (input_time_us <= 0)
+    return;
+
+  if (priv->frame_records.pending_input_time_us == 0 ||
+      input_time_us < priv->frame_records.pending_input_time_us)
+    priv->frame_records.pending_input_time_us = input_time_us;
+}
+
+/**
+ * clutter_stage_view_get_frame_records: (skip)
+ * @view: a #ClutterStageView
+ * @records: (out caller-allocates): array to copy the records into
+ * @n_records: the length of @records
+ *
+ * Copies the timings of the most recent frames of @view, oldest first.
+ *
+ * Returns: the number of records copied
+ */
+int
+clutter_stage_view_get_frame_records (ClutterStageView   *view,
+                                      ClutterFrameRecord *records,
+                                      int                 n_records)
+{
+  ClutterStageViewPrivate *priv =
+    clutter_stage_view_get_instance_private (view);
+  int first;
+  int i;
+
+  n_records = MIN (n_records, priv->frame_records.n_records);
+  first = priv->frame_records.next_record - n_records;
+  if (first < 0)
+    first += CLUTTER_STAGE_VIEW_N_FRAME_RECORDS;
+
+  for (i = 0; i < n_records; i++)
+    {
+      int index = (first + i) % CLUTTER_STAGE_VIEW_N_FRAME_RECORDS;
+
+      records[i] = priv->frame_records.records[index];
+    }
+
+  return n_records;
+}
+
 static ClutterFrameResult
 handle_frame_clock_frame (ClutterFrameClock *frame_clock,
                           ClutterFrame      *frame,
@@ -870,6 +1144,9 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
   ClutterStage *stage = priv->stage;
   ClutterStageWindow *stage_window = _clutter_stage_get_window (stage);
   g_autoptr (GSList) devices = NULL;
+  ClutterFrameRecord *record;
+  ClutterFrameResult result;
+  int64_t start_time_us;
 
   if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
     return CLUTTER_FRAME_RESULT_IDLE;
@@ -883,12 +1160,16 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
   if (_clutter_context_get_show_fps ())
     begin_frame_timing_measurement (view);
 
+  record = begin_frame_record (view, frame);
+
   _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_PRE_PAINT);
   clutter_stage_emit_before_update (stage, view, frame);
 
-  clutter_stage_maybe_relayout (CLUTTER_ACTOR (stage));
+  start_time_us = g_get_monotonic_time ();
+  clutter_stage_maybe_relayout_for_view (stage, view);
 
   clutter_stage_finish_layout (stage);
+  record->layout_duration_us = g_get_monotonic_time () - start_time_us;
 
   if (priv->needs_update_devices)
     devices = clutter_stage_find_updated_devices (stage, view);
@@ -900,7 +1181,9 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
     {
       clutter_stage_emit_before_paint (stage, view, frame);
 
+      start_time_us = g_get_monotonic_time ();
       _clutter_stage_window_redraw_view (stage_window, view, frame);
+      record->paint_duration_us = g_get_monotonic_time () - start_time_us;
 
       clutter_frame_clock_record_flip_time (frame_clock,
                                             g_get_monotonic_time ());
@@ -913,13 +1196,18 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
 
   _clutter_stage_window_finish_frame (stage_window, view, frame);
 
+  start_time_us = g_get_monotonic_time ();
   clutter_stage_update_devices (stage, devices);
   priv->needs_update_devices = FALSE;
+  record->pick_duration_us = g_get_monotonic_time () - start_time_us;
 
   _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_POST_PAINT);
   clutter_stage_after_update (stage, view, frame);
 
-  return clutter_frame_get_result (frame);
+  result = clutter_frame_get_result (frame);
+  end_frame_record (view, record, result);
+
+  return result;
 }
 
 static ClutterFrame *
@@ -948,6 +1236,8 @@ clutter_stage_view_notify_presented (ClutterStageView *view,
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
 
+  record_frame_presented (view, frame_info);
+
   clutter_stage_presented (priv->stage, view, frame_info);
   clutter_frame_clock_notify_presented (priv->frame_clock, frame_info);
 }
@@ -1022,6 +1312,9 @@ clutter_stage_view_get_property (GObject    *object,
     case PROP_USE_SHADOWFB:
       g_value_set_boolean (value, priv->use_shadowfb);
       break;
+    case PROP_OFFSCREEN_FORMAT:
+      g_value_set_enum (value, priv->offscreen_format);
+      break;
     case PROP_SCALE:
       g_value_set_float (value, priv->scale);
       break;
@@ -1056,6 +1349,7 @@ clutter_stage_view_set_property (GObject      *object,
       break;
     case PROP_LAYOUT:
       layout = g_value_get_boxed (value);
+      flush_redraw_tiles (view);
       priv->layout = *layout;
       break;
     case PROP_FRAMEBUFFER:
@@ -1067,6 +1361,9 @@ clutter_stage_view_set_property (GObject      *object,
     case PROP_USE_SHADOWFB:
       priv->use_shadowfb = g_value_get_boolean (value);
       break;
+    case PROP_OFFSCREEN_FORMAT:
+      priv->offscreen_format = g_value_get_enum (value);
+      break;
     case PROP_SCALE:
       priv->scale = g_value_get_float (value);
       break;
@@ -1119,6 +1416,7 @@ clutter_stage_view_dispose (GObject *object)
   g_clear_object (&priv->offscreen);
   g_clear_object (&priv->offscreen_pipeline);
   g_clear_pointer (&priv->redraw_clip, mtk_region_unref);
+  g_clear_pointer (&priv->redraw_tiles, clutter_damage_tiles_free);
   g_clear_pointer (&priv->accumulated_redraw_clip, mtk_region_unref);
   g_clear_pointer (&priv->frame_clock, clutter_frame_clock_destroy);
 
@@ -1205,6 +1503,17 @@ clutter_stage_view_class_init (ClutterStageViewClass *klass)
                           G_PARAM_CONSTRUCT_ONLY |
                           G_PARAM_STATIC_STRINGS);
 
+  /* The format of the intermediate framebuffers the view creates itself,
+   * e.g. the shadow framebuffer. HDR views use a half float format so no
+   * precision is lost before the contents reach the onscreen. */
+  obj_props[PROP_OFFSCREEN_FORMAT] =
+    g_param_spec_enum ("offscreen-format", NULL, NULL,
+                       COGL_TYPE_PIXEL_FORMAT,
+                       COGL_PIXEL_FORMAT_ANY,
+                       G_PARAM_READWRITE |
+                       G_PARAM_CONSTRUCT_ONLY |
+                       G_PARAM_STATIC_STRINGS);
+
   obj_props[PROP_SCALE] =
     g_param_spec_float ("scale", NULL, NULL,
                         0.5, G_MAXFLOAT, 1.0,
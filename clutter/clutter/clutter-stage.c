@@ -70,6 +70,15 @@
 
 #define MAX_FRUSTA 64
 
+/* Motion is resampled a bit before the presentation time, and never
+ * extrapolated further than half the interval between the last two samples,
+ * to limit overshooting when the pointer stops.
+ */
+#define MOTION_RESAMPLE_LATENCY_US (ms2us (5))
+#define MOTION_RESAMPLE_MIN_DELTA_US (ms2us (2))
+#define MOTION_RESAMPLE_MAX_DELTA_US (ms2us (20))
+#define MOTION_RESAMPLE_MAX_PREDICTION_US (ms2us (8))
+
 typedef struct _PickRecord
 {
   graphene_point_t vertex[4];
@@ -119,6 +128,9 @@ typedef struct _ClutterStagePrivate
   gchar *title;
   ClutterActor *key_focused_actor;
 
+  /* Incremented whenever any part of the stage is damaged */
+  uint64_t damage_serial;
+
   ClutterGrab *topmost_grab;
   ClutterGrabState grab_state;
 
@@ -135,9 +147,25 @@ typedef struct _ClutterStagePrivate
   GHashTable *pointer_devices;
   GHashTable *touch_sequences;
 
+  /* Debug name -> ClutterActorCost, and the actors being measured */
+  GHashTable *actor_costs;
+  GArray *actor_cost_stack;
+
   guint actor_needs_immediate_relayout : 1;
 } ClutterStagePrivate;
 
+typedef struct _ActorCostFrame
+{
+  int64_t start_time_us;
+  uint64_t start_n_journal_entries;
+  uint64_t start_n_draw_calls;
+
+  /* What the children measured so far cost, including their children */
+  int64_t children_time_us;
+  uint64_t children_n_journal_entries;
+  uint64_t children_n_draw_calls;
+} ActorCostFrame;
+
 struct _ClutterGrab
 {
   grefcount ref_count;
@@ -191,6 +219,13 @@ static void clutter_stage_update_view_perspective (ClutterStage *stage);
 static void clutter_stage_set_viewport (ClutterStage *stage,
                                         float         width,
                                         float         height);
+static void _clutter_stage_do_pick_multiple_on_view (ClutterStage      *stage,
+                                                     ClutterPickMode    mode,
+                                                     ClutterStageView  *view,
+                                                     int                n_points,
+                                                     graphene_point_t  *coords,
+                                                     ClutterActor     **actors,
+                                                     MtkRegion        **clear_areas);
 
 G_DEFINE_TYPE_WITH_PRIVATE (ClutterStage, clutter_stage, CLUTTER_TYPE_ACTOR)
 
@@ -242,8 +277,11 @@ static void
 clutter_stage_add_redraw_clip (ClutterStage *stage,
                                MtkRectangle *clip)
 {
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
   GList *l;
 
+  priv->damage_serial++;
+
   for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
     {
       ClutterStageView *view = l->data;
@@ -476,17 +514,25 @@ clutter_stage_paint_view (ClutterStage     *stage,
                           ClutterFrame     *frame)
 {
   ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  CoglFramebuffer *framebuffer;
 
   if (!priv->impl)
     return;
 
   COGL_TRACE_BEGIN_SCOPED (ClutterStagePaintView, "Clutter::Stage::paint_view()");
 
+  framebuffer = clutter_stage_view_get_framebuffer (view);
+  cogl_framebuffer_push_gpu_trace (framebuffer,
+                                   "GPU::Clutter::Stage::paint_view()",
+                                   NULL);
+
   if (g_signal_has_handler_pending (stage, stage_signals[PAINT_VIEW],
                                     0, TRUE))
     g_signal_emit (stage, stage_signals[PAINT_VIEW], 0, view, redraw_clip, frame);
   else
     CLUTTER_STAGE_GET_CLASS (stage)->paint_view (stage, view, redraw_clip, frame);
+
+  cogl_framebuffer_pop_gpu_trace (framebuffer);
 }
 
 void
@@ -696,11 +742,121 @@ clutter_stage_compress_motion (ClutterStage       *stage,
                                    NULL);
 }
 
-CLUTTER_EXPORT void
-_clutter_stage_process_queued_events (ClutterStage *stage)
+static ClutterEvent *
+clutter_stage_resample_motion (ClutterStage           *stage,
+                               ClutterEvent           *event,
+                               int64_t                 prev_time_us,
+                               const graphene_point_t *prev_coords,
+                               int64_t                 sample_time_us)
+{
+  double dx = 0.0, dy = 0.0;
+  double dx_unaccel = 0.0, dy_unaccel = 0.0;
+  double dx_constrained = 0.0, dy_constrained = 0.0;
+  graphene_point_t coords;
+  int64_t time_us;
+  int64_t delta_us;
+  double alpha;
+
+  if (clutter_event_get_device_tool (event))
+    return NULL;
+
+  time_us = clutter_event_get_time_us (event);
+  delta_us = time_us - prev_time_us;
+  if (delta_us < MOTION_RESAMPLE_MIN_DELTA_US ||
+      delta_us > MOTION_RESAMPLE_MAX_DELTA_US)
+    return NULL;
+
+  sample_time_us = MIN (sample_time_us,
+                        time_us + MIN (delta_us / 2,
+                                       MOTION_RESAMPLE_MAX_PREDICTION_US));
+  if (sample_time_us <= time_us)
+    return NULL;
+
+  clutter_event_get_position (event, &coords);
+  alpha = (double) (sample_time_us - prev_time_us) / delta_us;
+  coords.x = prev_coords->x + (coords.x - prev_coords->x) * alpha;
+  coords.y = prev_coords->y + (coords.y - prev_coords->y) * alpha;
+
+  /* Only the position is predicted, the relative motion is passed on as is,
+   * so that clients locking the pointer still see the raw motion.
+   */
+  clutter_event_get_relative_motion (event,
+                                     &dx, &dy,
+                                     &dx_unaccel, &dy_unaccel,
+                                     &dx_constrained, &dy_constrained);
+
+  return clutter_event_motion_new (clutter_event_get_flags (event),
+                                   clutter_event_get_time_us (event),
+                                   clutter_event_get_source_device (event),
+                                   NULL,
+                                   clutter_event_get_state (event),
+                                   coords,
+                                   GRAPHENE_POINT_INIT (dx, dy),
+                                   GRAPHENE_POINT_INIT (dx_unaccel, dy_unaccel),
+                                   GRAPHENE_POINT_INIT (dx_constrained,
+                                                        dy_constrained),
+                                   NULL);
+}
+
+static ClutterEvent *
+create_settle_motion (ClutterEvent *event)
+{
+  graphene_point_t coords;
+
+  /* Moves the pointer to where the device really is, if no further motion
+   * follows a predicted one. It carries no relative motion, as that was
+   * already passed on with the predicted event.
+   */
+  clutter_event_get_position (event, &coords);
+
+  return clutter_event_motion_new (clutter_event_get_flags (event) &
+                                   ~CLUTTER_EVENT_FLAG_RELATIVE_MOTION,
+                                   clutter_event_get_time_us (event),
+                                   clutter_event_get_source_device (event),
+                                   NULL,
+                                   clutter_event_get_state (event),
+                                   coords,
+                                   GRAPHENE_POINT_INIT (0, 0),
+                                   GRAPHENE_POINT_INIT (0, 0),
+                                   GRAPHENE_POINT_INIT (0, 0),
+                                   NULL);
+}
+
+static void
+notify_input_processed (ClutterStage *stage,
+                        GList        *events)
+{
+  GList *l;
+
+  /* Events are queued in order, so the first device event is the oldest */
+  for (l = events; l; l = l->next)
+    {
+      ClutterEvent *event = l->data;
+      GList *views;
+
+      if (!clutter_event_get_device (event) ||
+          (clutter_event_get_flags (event) & CLUTTER_EVENT_FLAG_SYNTHETIC))
+        continue;
+
+      for (views = clutter_stage_peek_stage_views (stage); views; views = views->next)
+        {
+          clutter_stage_view_notify_input_processed (views->data,
+                                                     clutter_event_get_time_us (event));
+        }
+      break;
+    }
+}
+
+static void
+process_queued_events (ClutterStage *stage,
+                       int64_t       sample_time_us)
 {
   ClutterStagePrivate *priv;
+  g_autoptr (GHashTable) settle_motions = NULL;
   GList *events, *l;
+  ClutterInputDevice *prev_motion_device = NULL;
+  graphene_point_t prev_motion_coords = { 0 };
+  int64_t prev_motion_time_us = 0;
 
   g_return_if_fail (CLUTTER_IS_STAGE (stage));
 
@@ -711,6 +867,14 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
   if (priv->event_queue->length == 0)
     return;
 
+  if (sample_time_us &&
+      !(clutter_paint_debug_flags & CLUTTER_DEBUG_DISABLE_MOTION_RESAMPLING))
+    {
+      settle_motions =
+        g_hash_table_new_full (NULL, NULL,
+                               NULL, (GDestroyNotify) clutter_event_free);
+    }
+
   /* In case the stage gets destroyed during event processing */
   g_object_ref (stage);
 
@@ -721,6 +885,8 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
   priv->event_queue->tail = NULL;
   priv->event_queue->length = 0;
 
+  notify_input_processed (stage, events);
+
   for (l = events; l != NULL; l = l->next)
     {
       ClutterEvent *event;
@@ -767,6 +933,10 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                 {
                   ClutterEvent *new_event;
 
+                  prev_motion_device = device;
+                  prev_motion_time_us = clutter_event_get_time_us (event);
+                  clutter_event_get_position (event, &prev_motion_coords);
+
                   new_event =
                     clutter_stage_compress_motion (stage, next_event, event);
                   if (new_event)
@@ -793,6 +963,36 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
             }
         }
 
+      if (settle_motions &&
+          device &&
+          clutter_event_type (event) == CLUTTER_MOTION)
+        {
+          ClutterEvent *resampled_event = NULL;
+
+          if (prev_motion_device == device)
+            {
+              resampled_event =
+                clutter_stage_resample_motion (stage, event,
+                                               prev_motion_time_us,
+                                               &prev_motion_coords,
+                                               sample_time_us);
+            }
+
+          if (resampled_event)
+            {
+              g_hash_table_insert (settle_motions, device,
+                                   create_settle_motion (event));
+              clutter_event_free (event);
+              event = resampled_event;
+            }
+          else
+            {
+              g_hash_table_remove (settle_motions, device);
+            }
+        }
+
+      prev_motion_device = NULL;
+
       clutter_stage_process_event (stage, event);
 
     next_event:
@@ -801,16 +1001,66 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
 
   g_list_free (events);
 
+  if (settle_motions)
+    {
+      GHashTableIter iter;
+      ClutterEvent *settle_motion;
+
+      g_hash_table_iter_init (&iter, settle_motions);
+      while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &settle_motion))
+        {
+          g_hash_table_iter_steal (&iter);
+          _clutter_stage_queue_event (stage, settle_motion, FALSE);
+        }
+    }
+
   g_object_unref (stage);
 }
 
+CLUTTER_EXPORT void
+_clutter_stage_process_queued_events (ClutterStage *stage)
+{
+  process_queued_events (stage, 0);
+}
+
+/*
+ * Like _clutter_stage_process_queued_events(), but predicts where the
+ * pointer will be when the frame is presented, so that motion appears at a
+ * steady pace instead of depending on how input and frames happen to line
+ * up.
+ */
+void
+clutter_stage_process_queued_events_for_presentation (ClutterStage *stage,
+                                                      int64_t       presentation_time_us)
+{
+  process_queued_events (stage,
+                         presentation_time_us - MOTION_RESAMPLE_LATENCY_US);
+}
+
 void
 clutter_stage_queue_actor_relayout (ClutterStage *stage,
                                     ClutterActor *actor)
 {
   ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  GList *stage_views = NULL;
+  GList *l;
 
-  clutter_stage_schedule_update (stage);
+  /* Only wake up the views the actor is on; the relayout is done as part of
+   * the update of one of those views. Actors that aren't on any view yet
+   * might end up anywhere, so let every view know about them.
+   */
+  if (actor != CLUTTER_ACTOR (stage))
+    stage_views = clutter_actor_peek_stage_views (actor);
+
+  if (stage_views)
+    {
+      for (l = stage_views; l; l = l->next)
+        clutter_stage_view_schedule_update (l->data);
+    }
+  else
+    {
+      clutter_stage_schedule_update (stage);
+    }
 
   priv->pending_relayouts = g_slist_prepend (priv->pending_relayouts,
                                              g_object_ref (actor));
@@ -851,12 +1101,31 @@ clutter_stage_invalidate_devices (ClutterStage *stage)
     }
 }
 
-void
-clutter_stage_maybe_relayout (ClutterActor *actor)
+static gboolean
+is_relayout_for_view (ClutterStage     *stage,
+                      ClutterActor     *actor,
+                      ClutterStageView *view)
 {
-  ClutterStage *stage = CLUTTER_STAGE (actor);
+  GList *stage_views;
+
+  if (!view || actor == CLUTTER_ACTOR (stage))
+    return TRUE;
+
+  stage_views = clutter_actor_peek_stage_views (actor);
+  if (!stage_views)
+    return TRUE;
+
+  return g_list_find (stage_views, view) != NULL;
+}
+
+static void
+relayout_actors (ClutterStage     *stage,
+                 ClutterStageView *view)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (stage);
   ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
   g_autoptr (GSList) stolen_list = NULL;
+  GSList *deferred_list = NULL;
   GSList *l;
   int count = 0;
 
@@ -872,12 +1141,23 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
   for (l = stolen_list; l; l = l->next)
     {
       g_autoptr (ClutterActor) queued_actor = l->data;
+      ClutterActor *parent;
       float x = 0.f;
       float y = 0.f;
 
       if (CLUTTER_ACTOR_IN_RELAYOUT (queued_actor))  /* avoid reentrancy */
         continue;
 
+      /* Actors that are only on other views are left for the update of
+       * those views.
+       */
+      if (!is_relayout_for_view (stage, queued_actor, view))
+        {
+          deferred_list = g_slist_prepend (deferred_list,
+                                           g_steal_pointer (&queued_actor));
+          continue;
+        }
+
       if (queued_actor == actor)
         CLUTTER_NOTE (ACTOR, "    Deep relayout of stage %s",
                       _clutter_actor_get_debug_name (queued_actor));
@@ -885,10 +1165,20 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
         CLUTTER_NOTE (ACTOR, "    Shallow relayout of actor %s",
                       _clutter_actor_get_debug_name (queued_actor));
 
+      parent = clutter_actor_get_parent (queued_actor);
+
       CLUTTER_SET_PRIVATE_FLAGS (queued_actor, CLUTTER_IN_RELAYOUT);
 
-      clutter_actor_get_fixed_position (queued_actor, &x, &y);
-      clutter_actor_allocate_preferred_size (queued_actor, x, y);
+      if (parent && !(clutter_actor_get_flags (parent) & CLUTTER_ACTOR_NO_LAYOUT))
+        {
+          /* A relayout boundary, its own allocation stays the same. */
+          clutter_actor_reallocate (queued_actor);
+        }
+      else
+        {
+          clutter_actor_get_fixed_position (queued_actor, &x, &y);
+          clutter_actor_allocate_preferred_size (queued_actor, x, y);
+        }
 
       CLUTTER_UNSET_PRIVATE_FLAGS (queued_actor, CLUTTER_IN_RELAYOUT);
 
@@ -897,8 +1187,28 @@ clutter_stage_maybe_relayout (ClutterActor *actor)
 
   CLUTTER_NOTE (ACTOR, "<<< Completed recomputing layout of %d subtrees", count);
 
-  if (count)
-    clutter_stage_invalidate_devices (stage);
+  priv->pending_relayouts = g_slist_concat (priv->pending_relayouts,
+                                            deferred_list);
+}
+
+void
+clutter_stage_maybe_relayout (ClutterActor *actor)
+{
+  relayout_actors (CLUTTER_STAGE (actor), NULL);
+}
+
+/**
+ * clutter_stage_maybe_relayout_for_view: (skip)
+ *
+ * Like clutter_stage_maybe_relayout(), but only relayouts the queued actors
+ * that are on @view, or that aren't on any view yet. The remaining queued
+ * actors are relayouted when the views they are on are updated.
+ */
+void
+clutter_stage_maybe_relayout_for_view (ClutterStage     *stage,
+                                       ClutterStageView *view)
+{
+  relayout_actors (stage, view);
 }
 
 GSList *
@@ -969,18 +1279,57 @@ clutter_stage_update_devices (ClutterStage *stage,
                               GSList       *devices)
 {
   ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  g_autofree ClutterInputDevice **pick_devices = NULL;
+  g_autofree graphene_point_t *coords = NULL;
+  g_autofree ClutterActor **actors = NULL;
+  g_autofree MtkRegion **clear_areas = NULL;
+  ClutterStageView *view = NULL;
+  int n_devices, n_picks = 0;
   GSList *l;
+  int i;
 
   COGL_TRACE_BEGIN_SCOPED (ClutterStageUpdateDevices, "Clutter::Stage::update_devices()");
 
+  n_devices = g_slist_length (devices);
+  if (n_devices == 0)
+    return;
+
+  pick_devices = g_new (ClutterInputDevice *, n_devices);
+  coords = g_new (graphene_point_t, n_devices);
+  actors = g_new0 (ClutterActor *, n_devices);
+  clear_areas = g_new0 (MtkRegion *, n_devices);
+
+  /* The devices were all found on the view that was just updated, see
+   * clutter_stage_find_updated_devices(), so they can all be resolved
+   * from a single pick traversal of that view instead of one each.
+   * Anything that would make the regular pick bail out early is picked
+   * on its own.
+   */
   for (l = devices; l; l = l->next)
     {
       ClutterInputDevice *device = l->data;
       PointerDeviceEntry *entry = NULL;
+      ClutterStageView *device_view;
 
       entry = g_hash_table_lookup (priv->pointer_devices, device);
       g_assert (entry != NULL);
 
+      device_view = clutter_stage_get_view_at (stage,
+                                               entry->coords.x,
+                                               entry->coords.y);
+      if (!view)
+        view = device_view;
+
+      if (device_view && device_view == view &&
+          !CLUTTER_ACTOR_IN_DESTRUCTION (stage) &&
+          !G_UNLIKELY (clutter_pick_debug_flags & CLUTTER_DEBUG_NOP_PICKING))
+        {
+          pick_devices[n_picks] = device;
+          coords[n_picks] = entry->coords;
+          n_picks++;
+          continue;
+        }
+
       clutter_stage_pick_and_update_device (stage,
                                             device,
                                             NULL, NULL,
@@ -989,6 +1338,27 @@ clutter_stage_update_devices (ClutterStage *stage,
                                             entry->coords,
                                             CLUTTER_CURRENT_TIME);
     }
+
+  if (n_picks == 0)
+    return;
+
+  _clutter_stage_do_pick_multiple_on_view (stage, CLUTTER_PICK_REACTIVE, view,
+                                           n_picks, coords,
+                                           actors, clear_areas);
+
+  for (i = 0; i < n_picks; i++)
+    {
+      clutter_stage_update_device (stage,
+                                   pick_devices[i], NULL,
+                                   NULL,
+                                   coords[i],
+                                   CLUTTER_CURRENT_TIME,
+                                   actors[i],
+                                   clear_areas[i],
+                                   TRUE);
+
+      g_clear_pointer (&clear_areas[i], mtk_region_unref);
+    }
 }
 
 static void
@@ -1079,6 +1449,53 @@ _clutter_stage_do_pick_on_view (ClutterStage      *stage,
   return actor ? actor : CLUTTER_ACTOR (stage);
 }
 
+/* Like _clutter_stage_do_pick_on_view() for each of @coords, but culls
+ * and collects the pickable actors just once for all of them.
+ */
+static void
+_clutter_stage_do_pick_multiple_on_view (ClutterStage      *stage,
+                                         ClutterPickMode    mode,
+                                         ClutterStageView  *view,
+                                         int                n_points,
+                                         graphene_point_t  *coords,
+                                         ClutterActor     **actors,
+                                         MtkRegion        **clear_areas)
+{
+  g_autoptr (ClutterPickStack) pick_stack = NULL;
+  g_autofree graphene_point3d_t *points = NULL;
+  g_autofree graphene_ray_t *rays = NULL;
+  ClutterPickContext *pick_context;
+  int i;
+
+  COGL_TRACE_BEGIN_SCOPED (ClutterStagePickViewMultiple,
+                           "Clutter::Stage::do_pick_multiple_on_view()");
+
+  points = g_new (graphene_point3d_t, n_points);
+  rays = g_new (graphene_ray_t, n_points);
+
+  for (i = 0; i < n_points; i++)
+    setup_ray_for_coordinates (stage, coords[i].x, coords[i].y,
+                               &points[i], &rays[i]);
+
+  pick_context = clutter_pick_context_new_for_view_multiple (view, mode,
+                                                             n_points,
+                                                             points, rays);
+
+  clutter_actor_pick (CLUTTER_ACTOR (stage), pick_context);
+  pick_stack = clutter_pick_context_steal_stack (pick_context);
+  clutter_pick_context_destroy (pick_context);
+
+  for (i = 0; i < n_points; i++)
+    {
+      ClutterActor *actor;
+
+      actor = clutter_pick_stack_search_actor (pick_stack,
+                                               &points[i], &rays[i],
+                                               &clear_areas[i]);
+      actors[i] = actor ? actor : CLUTTER_ACTOR (stage);
+    }
+}
+
 /**
  * clutter_stage_get_view_at: (skip)
  */
@@ -1278,6 +1695,9 @@ clutter_stage_finalize (GObject *object)
   g_hash_table_destroy (priv->pointer_devices);
   g_hash_table_destroy (priv->touch_sequences);
 
+  g_clear_pointer (&priv->actor_costs, g_hash_table_unref);
+  g_clear_pointer (&priv->actor_cost_stack, g_array_unref);
+
   g_free (priv->title);
 
   G_OBJECT_CLASS (clutter_stage_parent_class)->finalize (object);
@@ -2542,6 +2962,7 @@ void
 clutter_stage_add_to_redraw_clip (ClutterStage       *stage,
                                   ClutterPaintVolume *redraw_clip)
 {
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
   ClutterStageWindow *stage_window;
   ClutterActorBox bounding_box;
   ClutterActorBox intersection_box;
@@ -2550,6 +2971,10 @@ clutter_stage_add_to_redraw_clip (ClutterStage       *stage,
   if (CLUTTER_ACTOR_IN_DESTRUCTION (CLUTTER_ACTOR (stage)))
     return;
 
+  /* Count the damage even if it ends up not adding anything to the redraw
+   * clips, e.g. because a full redraw is already queued */
+  priv->damage_serial++;
+
   stage_window = _clutter_stage_get_window (stage);
   if (stage_window == NULL)
     return;
@@ -2602,6 +3027,25 @@ clutter_stage_get_frame_counter (ClutterStage          *stage)
   return _clutter_stage_window_get_frame_counter (stage_window);
 }
 
+/**
+ * clutter_stage_get_damage_serial: (skip)
+ * @stage: a #ClutterStage
+ *
+ * Returns a serial that changes whenever any part of @stage, visible on a
+ * view or not, is queued to be redrawn. Since anything that changes how
+ * the stage looks queues a redraw, state derived from the scene graph can
+ * be reused as long as the serial stays the same.
+ *
+ * Returns: the damage serial of @stage
+ */
+uint64_t
+clutter_stage_get_damage_serial (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+
+  return priv->damage_serial;
+}
+
 void
 clutter_stage_presented (ClutterStage     *stage,
                          ClutterStageView *view,
@@ -4568,3 +5012,135 @@ clutter_stage_pointing_input_foreach (ClutterStage                 *self,
 
   return TRUE;
 }
+
+static void
+get_draw_counters (uint64_t *n_journal_entries,
+                   uint64_t *n_draw_calls)
+{
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  cogl_context_get_draw_counters (cogl_context,
+                                  n_journal_entries,
+                                  n_draw_calls);
+}
+
+void
+clutter_stage_push_actor_cost (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  ActorCostFrame frame = { 0 };
+
+  if (!priv->actor_cost_stack)
+    priv->actor_cost_stack = g_array_new (FALSE, FALSE, sizeof (ActorCostFrame));
+
+  frame.start_time_us = g_get_monotonic_time ();
+  get_draw_counters (&frame.start_n_journal_entries,
+                     &frame.start_n_draw_calls);
+  g_array_append_val (priv->actor_cost_stack, frame);
+}
+
+void
+clutter_stage_pop_actor_cost (ClutterStage *stage,
+                              ClutterActor *actor,
+                              gboolean      is_pick)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  ActorCostFrame frame;
+  ClutterActorCost *cost;
+  const char *name;
+  int64_t time_us;
+  uint64_t n_journal_entries;
+  uint64_t n_draw_calls;
+
+  g_return_if_fail (priv->actor_cost_stack && priv->actor_cost_stack->len > 0);
+
+  frame = g_array_index (priv->actor_cost_stack, ActorCostFrame,
+                         priv->actor_cost_stack->len - 1);
+  g_array_set_size (priv->actor_cost_stack, priv->actor_cost_stack->len - 1);
+
+  time_us = g_get_monotonic_time () - frame.start_time_us;
+  get_draw_counters (&n_journal_entries, &n_draw_calls);
+  n_journal_entries -= frame.start_n_journal_entries;
+  n_draw_calls -= frame.start_n_draw_calls;
+
+  if (priv->actor_cost_stack->len > 0)
+    {
+      ActorCostFrame *parent_frame =
+        &g_array_index (priv->actor_cost_stack, ActorCostFrame,
+                        priv->actor_cost_stack->len - 1);
+
+      parent_frame->children_time_us += time_us;
+      parent_frame->children_n_journal_entries += n_journal_entries;
+      parent_frame->children_n_draw_calls += n_draw_calls;
+    }
+
+  if (!priv->actor_costs)
+    {
+      priv->actor_costs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                 g_free, g_free);
+    }
+
+  name = _clutter_actor_get_debug_name (actor);
+  cost = g_hash_table_lookup (priv->actor_costs, name);
+  if (!cost)
+    {
+      char *key = g_strdup (name);
+
+      cost = g_new0 (ClutterActorCost, 1);
+      cost->name = key;
+      g_hash_table_insert (priv->actor_costs, key, cost);
+    }
+
+  if (is_pick)
+    {
+      cost->n_picks++;
+      cost->pick_time_us += time_us - frame.children_time_us;
+    }
+  else
+    {
+      cost->n_paints++;
+      cost->paint_time_us += time_us - frame.children_time_us;
+    }
+
+  cost->n_journal_entries +=
+    n_journal_entries - frame.children_n_journal_entries;
+  cost->n_draw_calls += n_draw_calls - frame.children_n_draw_calls;
+}
+
+/**
+ * clutter_stage_get_actor_costs: (skip)
+ * @stage: a #ClutterStage
+ *
+ * Retrieves what painting and picking cost per actor debug name, since
+ * CLUTTER_DEBUG_ACTOR_COSTS was set or clutter_stage_reset_actor_costs()
+ * was last called. The names are valid until the latter.
+ *
+ * Returns: (transfer full): an array of #ClutterActorCost
+ */
+GArray *
+clutter_stage_get_actor_costs (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+  GArray *costs;
+  GHashTableIter iter;
+  ClutterActorCost *cost;
+
+  costs = g_array_new (FALSE, FALSE, sizeof (ClutterActorCost));
+  if (!priv->actor_costs)
+    return costs;
+
+  g_hash_table_iter_init (&iter, priv->actor_costs);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &cost))
+    g_array_append_val (costs, *cost);
+
+  return costs;
+}
+
+void
+clutter_stage_reset_actor_costs (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = clutter_stage_get_instance_private (stage);
+
+  g_clear_pointer (&priv->actor_costs, g_hash_table_unref);
+}
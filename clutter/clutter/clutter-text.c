@@ -94,6 +94,54 @@ struct _LayoutCache
   guint age;
 };
 
+/* Layouts of non-editable text are shared between all the actors showing
+ * the same contents with the same settings, as e.g. window titles end up
+ * in several labels at once. The least recently used ones are dropped
+ * above N_SHARED_LAYOUTS.
+ */
+#define N_SHARED_LAYOUTS        256
+
+typedef struct _SharedLayoutKey
+{
+  char *text;
+  PangoFontDescription *font_desc;
+  PangoAttrList *attrs;
+  gint width;
+  gint height;
+  PangoDirection direction;
+  PangoEllipsizeMode ellipsize;
+  PangoWrapMode wrap_mode;
+  PangoAlignment alignment;
+  gboolean single_line_mode;
+  gboolean justify;
+} SharedLayoutKey;
+
+typedef struct _SharedLayout
+{
+  /* Must be first, the hash table uses the entry as its own key */
+  SharedLayoutKey key;
+  PangoLayout *layout;
+  GList link;
+} SharedLayout;
+
+static GHashTable *shared_layouts = NULL;
+static GQueue shared_layouts_lru = G_QUEUE_INIT;
+static PangoContext *shared_layout_contexts[2] = { NULL, };
+
+/* Contents shorter than this are always shaped synchronously, even when
+ * asynchronous shaping is enabled, as shaping them is quicker than the
+ * round trip to a worker thread.
+ */
+#define ASYNC_SHAPING_MIN_BYTES (16 * 1024)
+
+typedef struct _ShapingJob
+{
+  PangoLayout *layout;
+  gint width;
+  gint height;
+  PangoEllipsizeMode ellipsize;
+} ShapingJob;
+
 struct _ClutterTextInputFocus
 {
   ClutterInputFocus parent_instance;
@@ -189,6 +237,12 @@ typedef struct _ClutterTextPrivate
   uint32_t last_click_time_ms;
   int click_count;
 
+  /* Layouts being shaped in a worker thread, and the layout that is
+   * used in the meantime */
+  GList *shaping_jobs;
+  GCancellable *shaping_cancellable;
+  PangoLayout *shaping_fallback_layout;
+
   /* bitfields */
   guint alignment               : 2;
   guint wrap                    : 1;
@@ -214,6 +268,7 @@ typedef struct _ClutterTextPrivate
   guint show_password_hint      : 1;
   guint password_hint_visible   : 1;
   guint resolved_direction      : 4;
+  guint async_shaping           : 1;
 } ClutterTextPrivate;
 
 enum
@@ -686,6 +741,69 @@ clutter_text_ensure_effective_attributes (ClutterText *self)
     }
 }
 
+static ClutterTextDirection
+clutter_text_resolve_direction (ClutterText *text,
+                                const char  *contents,
+                                gsize        contents_len)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ClutterTextDirection dir;
+
+  if (priv->password_char != 0)
+    dir = CLUTTER_TEXT_DIRECTION_DEFAULT;
+  else
+    dir = _clutter_find_base_dir (contents, contents_len);
+
+  if (dir == CLUTTER_TEXT_DIRECTION_DEFAULT)
+    {
+      ClutterBackend *backend = clutter_get_default_backend ();
+
+      if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
+        {
+          ClutterSeat *seat;
+          ClutterKeymap *keymap;
+
+          seat = clutter_backend_get_default_seat (backend);
+          keymap = clutter_seat_get_keymap (seat);
+          dir = clutter_keymap_get_direction (keymap);
+        }
+      else
+        {
+          dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+        }
+    }
+
+  priv->resolved_direction = dir;
+
+  return dir;
+}
+
+static void
+clutter_text_apply_layout_params (ClutterText        *text,
+                                  PangoLayout        *layout,
+                                  gint                width,
+                                  gint                height,
+                                  PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+
+  /* This will merge the markup attributes and the attributes
+   * property if needed */
+  clutter_text_ensure_effective_attributes (text);
+
+  if (priv->effective_attrs != NULL)
+    pango_layout_set_attributes (layout, priv->effective_attrs);
+
+  pango_layout_set_alignment (layout, priv->alignment);
+  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
+  pango_layout_set_justify (layout, priv->justify);
+  pango_layout_set_wrap (layout, priv->wrap_mode);
+
+  pango_layout_set_ellipsize (layout, ellipsize);
+  pango_layout_set_width (layout, width);
+  pango_layout_set_height (layout, height);
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -736,59 +854,222 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
       PangoDirection pango_dir;
       PangoContext *context;
 
-      if (priv->password_char != 0)
-        dir = CLUTTER_TEXT_DIRECTION_DEFAULT;
-      else
-        dir = _clutter_find_base_dir (contents, contents_len);
-
-      if (dir == CLUTTER_TEXT_DIRECTION_DEFAULT)
-        {
-          ClutterBackend *backend = clutter_get_default_backend ();
-
-          if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
-            {
-              ClutterSeat *seat;
-              ClutterKeymap *keymap;
-
-              seat = clutter_backend_get_default_seat (backend);
-              keymap = clutter_seat_get_keymap (seat);
-              dir = clutter_keymap_get_direction (keymap);
-            }
-          else
-            {
-              dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
-            }
-        }
+      dir = clutter_text_resolve_direction (text, contents, contents_len);
 
       pango_dir = clutter_text_direction_to_pango_direction (dir);
       context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
 
       pango_context_set_base_dir (context, pango_dir);
 
-      priv->resolved_direction = dir;
-
       pango_layout_set_text (layout, contents, contents_len);
     }
 
-  /* This will merge the markup attributes and the attributes
-   * property if needed */
+  clutter_text_apply_layout_params (text, layout, width, height, ellipsize);
+
+  g_free (contents);
+
+  return layout;
+}
+
+static guint
+shared_layout_key_hash (gconstpointer data)
+{
+  const SharedLayoutKey *key = data;
+  guint hash;
+
+  hash = g_str_hash (key->text);
+  hash = hash * 31 + pango_font_description_hash (key->font_desc);
+  hash = hash * 31 + (guint) key->width;
+  hash = hash * 31 + (guint) key->height;
+  hash = hash * 31 + key->direction;
+
+  return hash;
+}
+
+static gboolean
+shared_layout_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const SharedLayoutKey *key_a = a;
+  const SharedLayoutKey *key_b = b;
+
+  if (key_a->width != key_b->width ||
+      key_a->height != key_b->height ||
+      key_a->direction != key_b->direction ||
+      key_a->ellipsize != key_b->ellipsize ||
+      key_a->wrap_mode != key_b->wrap_mode ||
+      key_a->alignment != key_b->alignment ||
+      key_a->single_line_mode != key_b->single_line_mode ||
+      key_a->justify != key_b->justify)
+    return FALSE;
+
+  if (g_strcmp0 (key_a->text, key_b->text) != 0)
+    return FALSE;
+
+  if (!pango_font_description_equal (key_a->font_desc, key_b->font_desc))
+    return FALSE;
+
+  if (key_a->attrs == key_b->attrs)
+    return TRUE;
+
+  if (!key_a->attrs || !key_b->attrs)
+    return FALSE;
+
+  return pango_attr_list_equal (key_a->attrs, key_b->attrs);
+}
+
+static void
+shared_layout_free (SharedLayout *shared_layout)
+{
+  g_free (shared_layout->key.text);
+  pango_font_description_free (shared_layout->key.font_desc);
+  g_clear_pointer (&shared_layout->key.attrs, pango_attr_list_unref);
+  g_object_unref (shared_layout->layout);
+  g_free (shared_layout);
+}
+
+static void
+clear_shared_layouts (void)
+{
+  SharedLayout *shared_layout;
+
+  while ((shared_layout = g_queue_pop_head (&shared_layouts_lru)))
+    {
+      g_hash_table_remove (shared_layouts, &shared_layout->key);
+      shared_layout_free (shared_layout);
+    }
+
+  g_clear_object (&shared_layout_contexts[0]);
+  g_clear_object (&shared_layout_contexts[1]);
+}
+
+static void
+on_backend_fonts_changed (ClutterBackend *backend,
+                          gpointer        user_data)
+{
+  clear_shared_layouts ();
+}
+
+static PangoContext *
+get_shared_layout_context (ClutterText    *text,
+                           PangoDirection  direction)
+{
+  PangoContext **context;
+
+  context = &shared_layout_contexts[direction == PANGO_DIRECTION_RTL ? 1 : 0];
+  if (!*context)
+    {
+      *context = clutter_actor_create_pango_context (CLUTTER_ACTOR (text));
+      pango_context_set_base_dir (*context, direction);
+    }
+
+  return *context;
+}
+
+/*
+ * clutter_text_get_shared_layout:
+ * @text: a #ClutterText
+ * @width: the width of the layout, in Pango units
+ * @height: the height of the layout, in Pango units
+ * @ellipsize: the ellipsize mode of the layout
+ *
+ * Looks up a layout for the contents and settings of @text in the
+ * layouts shared by all #ClutterText actors, creating it if needed.
+ * Shared layouts are created with a #PangoContext that isn't the one
+ * of any actor, so that they are unaffected by changes to it.
+ *
+ * Return value: (transfer full): the shared layout
+ */
+static PangoLayout *
+clutter_text_get_shared_layout (ClutterText        *text,
+                                gint                width,
+                                gint                height,
+                                PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  SharedLayout *shared_layout;
+  SharedLayoutKey key;
+  ClutterTextDirection dir;
+  PangoDirection pango_dir;
+  g_autofree char *contents = NULL;
+  gsize contents_len;
+
+  if (G_UNLIKELY (!shared_layouts))
+    {
+      ClutterBackend *backend = clutter_get_default_backend ();
+
+      shared_layouts = g_hash_table_new (shared_layout_key_hash,
+                                         shared_layout_key_equal);
+
+      g_signal_connect (backend, "resolution-changed",
+                        G_CALLBACK (on_backend_fonts_changed), NULL);
+      g_signal_connect (backend, "font-changed",
+                        G_CALLBACK (on_backend_fonts_changed), NULL);
+    }
+
+  contents = clutter_text_get_display_text (text);
+  contents_len = strlen (contents);
+
+  dir = clutter_text_resolve_direction (text, contents, contents_len);
+  pango_dir = clutter_text_direction_to_pango_direction (dir);
+
   clutter_text_ensure_effective_attributes (text);
 
-  if (priv->effective_attrs != NULL)
-    pango_layout_set_attributes (layout, priv->effective_attrs);
+  key = (SharedLayoutKey) {
+    .text = contents,
+    .font_desc = priv->font_desc,
+    .attrs = priv->effective_attrs,
+    .width = width,
+    .height = height,
+    .direction = pango_dir,
+    .ellipsize = ellipsize,
+    .wrap_mode = priv->wrap_mode,
+    .alignment = priv->alignment,
+    .single_line_mode = priv->single_line_mode,
+    .justify = priv->justify,
+  };
+
+  shared_layout = g_hash_table_lookup (shared_layouts, &key);
+  if (shared_layout)
+    {
+      CLUTTER_NOTE (ACTOR, "ClutterText: %p: shared layout cache hit", text);
 
-  pango_layout_set_alignment (layout, priv->alignment);
-  pango_layout_set_single_paragraph_mode (layout, priv->single_line_mode);
-  pango_layout_set_justify (layout, priv->justify);
-  pango_layout_set_wrap (layout, priv->wrap_mode);
+      g_queue_unlink (&shared_layouts_lru, &shared_layout->link);
+      g_queue_push_head_link (&shared_layouts_lru, &shared_layout->link);
 
-  pango_layout_set_ellipsize (layout, ellipsize);
-  pango_layout_set_width (layout, width);
-  pango_layout_set_height (layout, height);
+      return g_object_ref (shared_layout->layout);
+    }
 
-  g_free (contents);
+  if (shared_layouts_lru.length >= N_SHARED_LAYOUTS)
+    {
+      SharedLayout *oldest = g_queue_pop_tail (&shared_layouts_lru);
 
-  return layout;
+      g_hash_table_remove (shared_layouts, &oldest->key);
+      shared_layout_free (oldest);
+    }
+
+  shared_layout = g_new0 (SharedLayout, 1);
+  shared_layout->link.data = shared_layout;
+  shared_layout->key = key;
+  shared_layout->key.text = g_steal_pointer (&contents);
+  shared_layout->key.font_desc = pango_font_description_copy (priv->font_desc);
+  if (priv->effective_attrs)
+    shared_layout->key.attrs = pango_attr_list_ref (priv->effective_attrs);
+
+  shared_layout->layout =
+    pango_layout_new (get_shared_layout_context (text, pango_dir));
+  pango_layout_set_font_description (shared_layout->layout, priv->font_desc);
+  pango_layout_set_text (shared_layout->layout,
+                         shared_layout->key.text, contents_len);
+  clutter_text_apply_layout_params (text, shared_layout->layout,
+                                    width, height, ellipsize);
+
+  cogl_pango_ensure_glyph_cache_for_layout (shared_layout->layout);
+
+  g_hash_table_add (shared_layouts, shared_layout);
+  g_queue_push_head_link (&shared_layouts_lru, &shared_layout->link);
+
+  return g_object_ref (shared_layout->layout);
 }
 
 static void
@@ -797,6 +1078,28 @@ clutter_text_dirty_cache (ClutterText *text)
   ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
   int i;
 
+  if (priv->async_shaping)
+    {
+      LayoutCache *newest_cache = NULL;
+
+      /* Keep showing the most recently used layout until the new ones
+       * are shaped */
+      for (i = 0; i < N_CACHED_LAYOUTS; i++)
+        {
+          if (priv->cached_layouts[i].layout &&
+              (!newest_cache ||
+               priv->cached_layouts[i].age > newest_cache->age))
+            newest_cache = priv->cached_layouts + i;
+        }
+
+      if (newest_cache)
+        g_set_object (&priv->shaping_fallback_layout, newest_cache->layout);
+
+      g_cancellable_cancel (priv->shaping_cancellable);
+      g_clear_object (&priv->shaping_cancellable);
+      g_clear_pointer (&priv->shaping_jobs, g_list_free);
+    }
+
   /* Delete the cached layouts so they will be recreated the next time
      they are needed */
   for (i = 0; i < N_CACHED_LAYOUTS; i++)
@@ -897,6 +1200,210 @@ clutter_text_direction_changed_cb (GObject    *gobject,
   /* no need to queue a relayout: set_text_direction() will do that for us */
 }
 
+static void
+shaping_job_free (ShapingJob *job)
+{
+  g_object_unref (job->layout);
+  g_free (job);
+}
+
+static gboolean
+clutter_text_should_shape_async (ClutterText *text)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+
+  if (!priv->async_shaping)
+    return FALSE;
+
+  /* Cursor and selection handling need a layout matching the buffer */
+  if (priv->editable || priv->selectable || priv->password_char != 0)
+    return FALSE;
+
+  return clutter_text_buffer_get_bytes (get_buffer (text)) >=
+         ASYNC_SHAPING_MIN_BYTES;
+}
+
+/*
+ * clutter_text_create_layout_for_shaping:
+ *
+ * Like clutter_text_create_layout_no_cache(), but the layout uses a font
+ * map of its own rather than the one shared by all actors, since Pango
+ * font maps can't be used from several threads at once. The layout is
+ * only set up, the shaping happens the first time it is measured.
+ */
+static PangoLayout *
+clutter_text_create_layout_for_shaping (ClutterText        *text,
+                                        gint                width,
+                                        gint                height,
+                                        PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  CoglPangoFontMap *main_font_map =
+    COGL_PANGO_FONT_MAP (clutter_get_font_map ());
+  g_autoptr (PangoFontMap) font_map = NULL;
+  g_autoptr (PangoContext) context = NULL;
+  PangoContext *actor_context;
+  PangoLayout *layout;
+  ClutterTextDirection dir;
+  g_autofree char *contents = NULL;
+  gsize contents_len;
+
+  actor_context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
+
+  font_map = cogl_pango_font_map_new ();
+  cogl_pango_font_map_set_resolution (COGL_PANGO_FONT_MAP (font_map),
+                                      pango_cairo_context_get_resolution (actor_context));
+  cogl_pango_font_map_set_use_mipmapping (COGL_PANGO_FONT_MAP (font_map),
+                                          cogl_pango_font_map_get_use_mipmapping (main_font_map));
+
+  context = cogl_pango_font_map_create_context (COGL_PANGO_FONT_MAP (font_map));
+  pango_cairo_context_set_font_options (context,
+                                        pango_cairo_context_get_font_options (actor_context));
+  pango_cairo_context_set_resolution (context,
+                                      pango_cairo_context_get_resolution (actor_context));
+  pango_context_set_language (context,
+                              pango_context_get_language (actor_context));
+  pango_context_set_font_description (context,
+                                      pango_context_get_font_description (actor_context));
+
+  contents = clutter_text_get_display_text (text);
+  contents_len = strlen (contents);
+
+  dir = clutter_text_resolve_direction (text, contents, contents_len);
+  pango_context_set_base_dir (context,
+                              clutter_text_direction_to_pango_direction (dir));
+
+  layout = pango_layout_new (context);
+  pango_layout_set_font_description (layout, priv->font_desc);
+  pango_layout_set_text (layout, contents, contents_len);
+  clutter_text_apply_layout_params (text, layout, width, height, ellipsize);
+
+  return layout;
+}
+
+static void
+shape_layout_in_thread (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+  ShapingJob *job = task_data;
+  PangoRectangle logical_rect;
+
+  /* Measuring the layout makes Pango itemize, shape and break the
+   * lines of the whole text */
+  pango_layout_get_extents (job->layout, NULL, &logical_rect);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+on_layout_shaped (GObject      *source_object,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+  ClutterText *text = CLUTTER_TEXT (source_object);
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ShapingJob *job = g_task_get_task_data (G_TASK (result));
+  LayoutCache *oldest_cache = NULL;
+  int i;
+
+  /* Cancelled because the contents or settings changed meanwhile */
+  if (!g_task_propagate_boolean (G_TASK (result), NULL))
+    return;
+
+  priv->shaping_jobs = g_list_remove (priv->shaping_jobs, job);
+
+  for (i = 0; i < N_CACHED_LAYOUTS; i++)
+    {
+      if (priv->cached_layouts[i].layout == NULL)
+        {
+          oldest_cache = priv->cached_layouts + i;
+          break;
+        }
+
+      if (!oldest_cache ||
+          priv->cached_layouts[i].age < oldest_cache->age)
+        oldest_cache = priv->cached_layouts + i;
+    }
+
+  g_clear_object (&oldest_cache->layout);
+  oldest_cache->layout = g_object_ref (job->layout);
+  oldest_cache->age = priv->cache_age++;
+
+  cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+
+  if (!priv->shaping_jobs)
+    g_clear_object (&priv->shaping_fallback_layout);
+
+  clutter_actor_invalidate_paint_volume (CLUTTER_ACTOR (text));
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (text));
+}
+
+/*
+ * clutter_text_shape_layout_async:
+ *
+ * Starts shaping a layout for the current contents of @text in a worker
+ * thread, unless one with the same size is already being shaped.
+ *
+ * Return value: (transfer none): the layout to use until the shaping is
+ *   done; either the last layout of @text or an empty one
+ */
+static PangoLayout *
+clutter_text_shape_layout_async (ClutterText        *text,
+                                 gint                width,
+                                 gint                height,
+                                 PangoEllipsizeMode  ellipsize)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  g_autoptr (GTask) task = NULL;
+  ShapingJob *job;
+  GList *l;
+
+  for (l = priv->shaping_jobs; l; l = l->next)
+    {
+      job = l->data;
+
+      if (job->width == width &&
+          job->height == height &&
+          job->ellipsize == ellipsize)
+        break;
+    }
+
+  if (!l)
+    {
+      if (!priv->shaping_cancellable)
+        priv->shaping_cancellable = g_cancellable_new ();
+
+      job = g_new0 (ShapingJob, 1);
+      job->layout = clutter_text_create_layout_for_shaping (text,
+                                                            width,
+                                                            height,
+                                                            ellipsize);
+      job->width = width;
+      job->height = height;
+      job->ellipsize = ellipsize;
+
+      priv->shaping_jobs = g_list_prepend (priv->shaping_jobs, job);
+
+      task = g_task_new (text, priv->shaping_cancellable,
+                         on_layout_shaped, NULL);
+      g_task_set_source_tag (task, clutter_text_shape_layout_async);
+      g_task_set_task_data (task, job, (GDestroyNotify) shaping_job_free);
+      g_task_run_in_thread (task, shape_layout_in_thread);
+    }
+
+  if (!priv->shaping_fallback_layout)
+    {
+      priv->shaping_fallback_layout =
+        clutter_actor_create_pango_layout (CLUTTER_ACTOR (text), NULL);
+      pango_layout_set_font_description (priv->shaping_fallback_layout,
+                                         priv->font_desc);
+    }
+
+  return priv->shaping_fallback_layout;
+}
+
 /*
  * clutter_text_create_layout:
  * @text: a #ClutterText
@@ -1063,15 +1570,32 @@ clutter_text_create_layout (ClutterText *text,
                 allocation_width,
                 allocation_height);
 
+  if (clutter_text_should_shape_async (text))
+    return clutter_text_shape_layout_async (text, width, height, ellipsize);
+
+  if (!priv->shaping_jobs)
+    g_clear_object (&priv->shaping_fallback_layout);
+
   /* If we make it here then we didn't have a cached version so we
      need to recreate the layout */
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  /* Static text doesn't depend on any per-actor state beyond what the
+   * shared layouts are keyed with, so identical labels can share one
+   */
+  if (!priv->editable && priv->password_char == 0)
+    {
+      oldest_cache->layout =
+        clutter_text_get_shared_layout (text, width, height, ellipsize);
+    }
+  else
+    {
+      oldest_cache->layout =
+        clutter_text_create_layout_no_cache (text, width, height, ellipsize);
 
-  cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+      cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+    }
 
   /* Mark the 'time' this cache was created and advance the time */
   oldest_cache->age = priv->cache_age++;
@@ -1744,6 +2268,7 @@ clutter_text_dispose (GObject *gobject)
 
   /* get rid of the entire cache */
   clutter_text_dirty_cache (self);
+  g_clear_object (&priv->shaping_fallback_layout);
 
   g_clear_signal_handler (&priv->direction_changed_id, self);
   g_clear_signal_handler (&priv->settings_changed_id,
@@ -4781,12 +5306,67 @@ clutter_text_set_editable (ClutterText *self,
             clutter_text_im_focus (self);
         }
 
+      /* Ellipsization and layout sharing depend on the editability */
+      clutter_text_dirty_cache (self);
       clutter_text_queue_redraw (CLUTTER_ACTOR (self));
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_EDITABLE]);
     }
 }
 
+/**
+ * clutter_text_set_async_shaping:
+ * @self: a #ClutterText
+ * @async_shaping: whether to shape long contents in a worker thread
+ *
+ * Sets whether long contents of a non-editable and non-selectable
+ * #ClutterText are shaped in a worker thread instead of when the layout
+ * is first needed.
+ *
+ * While the shaping is in progress the previous layout of @self is
+ * painted, or nothing if there wasn't any, and a relayout is queued once
+ * the new layout is ready.
+ */
+void
+clutter_text_set_async_shaping (ClutterText *self,
+                                gboolean     async_shaping)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXT (self));
+
+  priv = clutter_text_get_instance_private (self);
+
+  if (priv->async_shaping == !!async_shaping)
+    return;
+
+  clutter_text_dirty_cache (self);
+  priv->async_shaping = !!async_shaping;
+  g_clear_object (&priv->shaping_fallback_layout);
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+}
+
+/**
+ * clutter_text_get_async_shaping:
+ * @self: a #ClutterText
+ *
+ * Retrieves whether long contents of @self are shaped in a worker thread.
+ *
+ * Return value: %TRUE if asynchronous shaping is enabled
+ */
+gboolean
+clutter_text_get_async_shaping (ClutterText *self)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_val_if_fail (CLUTTER_IS_TEXT (self), FALSE);
+
+  priv = clutter_text_get_instance_private (self);
+
+  return priv->async_shaping;
+}
+
 /**
  * clutter_text_get_editable:
  * @self: a #ClutterText
@@ -165,6 +165,11 @@ void                  clutter_text_set_editable         (ClutterText          *s
 CLUTTER_EXPORT
 gboolean              clutter_text_get_editable         (ClutterText          *self);
 CLUTTER_EXPORT
+void                  clutter_text_set_async_shaping    (ClutterText          *self,
+                                                         gboolean              async_shaping);
+CLUTTER_EXPORT
+gboolean              clutter_text_get_async_shaping    (ClutterText          *self);
+CLUTTER_EXPORT
 void                  clutter_text_set_activatable      (ClutterText          *self,
                                                          gboolean              activatable);
 CLUTTER_EXPORT
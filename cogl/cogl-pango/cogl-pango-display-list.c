@@ -32,6 +32,7 @@
 #include <string.h>
 
 #include "cogl-pango/cogl-pango-display-list.h"
+#include "cogl-pango/cogl-pango-glyph-cache.h"
 #include "cogl-pango/cogl-pango-pipeline-cache.h"
 #include "cogl/cogl-context-private.h"
 
@@ -52,6 +53,9 @@ struct _CoglPangoDisplayList
   GSList                 *nodes;
   GSList                 *last_node;
   CoglPangoPipelineCache *pipeline_cache;
+  /* Number of times the list has been rendered since it was last
+     cleared */
+  unsigned int            n_renders;
 };
 
 /* This matches the format expected by cogl_rectangles_with_texture_coords */
@@ -81,6 +85,9 @@ struct _CoglPangoDisplayListNode
       GArray *rectangles;
       /* A primitive representing those vertices */
       CoglPrimitive *primitive;
+      /* Location of the smoothing uniform if the texture is a
+         distance field, or -1 */
+      int sdf_smoothing_location;
       guint has_color : 1;
     } texture;
 
@@ -376,24 +383,47 @@ emit_vertex_buffer_geometry (CoglFramebuffer *fb,
 
 static void
 _cogl_framebuffer_draw_display_list_texture (CoglFramebuffer *fb,
+                                             CoglPangoDisplayList *dl,
                                              CoglPipeline *pipeline,
                                              CoglPangoDisplayListNode *node)
 {
   /* For small runs of text like icon labels, we can get better performance
    * going through the Cogl journal since text may then be batched together
-   * with other geometry. */
+   * with other geometry. That only holds while the text is changing
+   * though: once a list is replayed unchanged the journal would redo the
+   * same software transform every frame, whereas the vertex buffer is
+   * built once and stays valid until the layout or the glyph atlas
+   * changes, which throws the list away. */
   /* FIXME: 25 is a number I plucked out of thin air; it would be good
    * to determine this empirically! */
-  if (node->d.texture.rectangles->len < 25)
+  if (dl->n_renders == 0 && node->d.texture.rectangles->len < 25)
     emit_rectangles_through_journal (fb, pipeline, node);
   else
     emit_vertex_buffer_geometry (fb, pipeline, node);
 }
 
+static void
+set_sdf_smoothing (CoglPangoDisplayListNode *node,
+                   float                     scale)
+{
+  float smoothing;
+
+  /* One framebuffer pixel spans OVERSAMPLE / scale texels, and the
+     distance field changes by 1 / (2 * SPREAD) per texel, so this is
+     the half width of a ramp covering a single pixel */
+  smoothing = ((float) COGL_PANGO_GLYPH_CACHE_SDF_OVERSAMPLE /
+               (4.0f * COGL_PANGO_GLYPH_CACHE_SDF_SPREAD * MAX (scale, 0.001f)));
+
+  cogl_pipeline_set_uniform_1f (node->pipeline,
+                                node->d.texture.sdf_smoothing_location,
+                                MIN (smoothing, 0.5f));
+}
+
 void
 _cogl_pango_display_list_render (CoglFramebuffer *fb,
                                  CoglPangoDisplayList *dl,
-                                 const CoglColor *color)
+                                 const CoglColor *color,
+                                 float scale)
 {
   GSList *l;
 
@@ -405,9 +435,19 @@ _cogl_pango_display_list_render (CoglFramebuffer *fb,
       if (node->pipeline == NULL)
         {
           if (node->type == COGL_PANGO_DISPLAY_LIST_TEXTURE)
-            node->pipeline =
-              _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
-                                              node->d.texture.texture);
+            {
+              node->pipeline =
+                _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
+                                                node->d.texture.texture);
+
+              if (_cogl_pango_glyph_cache_is_sdf_texture (node->d.texture.texture))
+                node->d.texture.sdf_smoothing_location =
+                  cogl_pipeline_get_uniform_location
+                    (node->pipeline,
+                     COGL_PANGO_PIPELINE_CACHE_SDF_SMOOTHING_UNIFORM);
+              else
+                node->d.texture.sdf_smoothing_location = -1;
+            }
           else
             node->pipeline =
               _cogl_pango_pipeline_cache_get (dl->pipeline_cache,
@@ -433,7 +473,11 @@ _cogl_pango_display_list_render (CoglFramebuffer *fb,
       switch (node->type)
         {
         case COGL_PANGO_DISPLAY_LIST_TEXTURE:
-          _cogl_framebuffer_draw_display_list_texture (fb, node->pipeline, node);
+          if (node->d.texture.sdf_smoothing_location != -1)
+            set_sdf_smoothing (node, scale);
+
+          _cogl_framebuffer_draw_display_list_texture (fb, dl,
+                                                       node->pipeline, node);
           break;
 
         case COGL_PANGO_DISPLAY_LIST_RECTANGLE:
@@ -452,6 +496,8 @@ _cogl_pango_display_list_render (CoglFramebuffer *fb,
           break;
         }
     }
+
+  dl->n_renders++;
 }
 
 static void
@@ -481,6 +527,7 @@ _cogl_pango_display_list_clear (CoglPangoDisplayList *dl)
                      _cogl_pango_display_list_node_free);
   dl->nodes = NULL;
   dl->last_node = NULL;
+  dl->n_renders = 0;
 }
 
 void
@@ -68,10 +68,13 @@ _cogl_pango_display_list_add_trapezoid (CoglPangoDisplayList *dl,
                                         float x_12,
                                         float x_22);
 
+/* @scale is the number of framebuffer pixels covered by one unit of
+   the layout. It is only used to anti-alias distance field glyphs */
 void
 _cogl_pango_display_list_render (CoglFramebuffer *framebuffer,
                                  CoglPangoDisplayList *dl,
-                                 const CoglColor *color);
+                                 const CoglColor *color,
+                                 float scale);
 
 void
 _cogl_pango_display_list_clear (CoglPangoDisplayList *dl);
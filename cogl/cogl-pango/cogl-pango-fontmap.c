@@ -150,6 +150,23 @@ cogl_pango_font_map_get_use_mipmapping (CoglPangoFontMap *fm)
     _cogl_pango_renderer_get_use_mipmapping (COGL_PANGO_RENDERER (renderer));
 }
 
+void
+cogl_pango_font_map_set_use_sdf (CoglPangoFontMap *fm,
+                                 gboolean          value)
+{
+  PangoRenderer *renderer = _cogl_pango_font_map_get_renderer (fm);
+
+  _cogl_pango_renderer_set_use_sdf (COGL_PANGO_RENDERER (renderer), value);
+}
+
+gboolean
+cogl_pango_font_map_get_use_sdf (CoglPangoFontMap *fm)
+{
+  PangoRenderer *renderer = _cogl_pango_font_map_get_renderer (fm);
+
+  return _cogl_pango_renderer_get_use_sdf (COGL_PANGO_RENDERER (renderer));
+}
+
 static GQuark
 cogl_pango_font_map_get_priv_key (void)
 {
@@ -64,6 +64,10 @@ struct _CoglPangoGlyphCache
   /* Whether mipmapping is being used for this cache. This only
      affects whether we decide to put the glyph in the global atlas */
   gboolean          use_mipmapping;
+
+  /* Whether glyphs are stored as signed distance fields. These always
+     go in local atlases so the textures can be told apart */
+  gboolean          use_sdf;
 };
 
 struct _CoglPangoGlyphCacheKey
@@ -72,6 +76,17 @@ struct _CoglPangoGlyphCacheKey
   PangoGlyph  glyph;
 };
 
+static GQuark
+cogl_pango_glyph_cache_get_sdf_key (void)
+{
+  static GQuark key = 0;
+
+  if (G_UNLIKELY (key == 0))
+    key = g_quark_from_static_string ("CoglPangoGlyphCacheSdf");
+
+  return key;
+}
+
 static void
 cogl_pango_glyph_cache_value_free (CoglPangoGlyphCacheValue *value)
 {
@@ -141,10 +156,29 @@ cogl_pango_glyph_cache_new (CoglContext *ctx,
   cache->using_global_atlas = FALSE;
 
   cache->use_mipmapping = use_mipmapping;
+  cache->use_sdf = FALSE;
 
   return cache;
 }
 
+CoglPangoGlyphCache *
+_cogl_pango_glyph_cache_new_sdf (CoglContext *ctx)
+{
+  CoglPangoGlyphCache *cache;
+
+  cache = cogl_pango_glyph_cache_new (ctx, FALSE);
+  cache->use_sdf = TRUE;
+
+  return cache;
+}
+
+gboolean
+_cogl_pango_glyph_cache_is_sdf_texture (CoglTexture *texture)
+{
+  return g_object_get_qdata (G_OBJECT (texture),
+                             cogl_pango_glyph_cache_get_sdf_key ()) != NULL;
+}
+
 static void
 cogl_pango_glyph_cache_reorganize_cb (void *user_data)
 {
@@ -200,8 +234,13 @@ cogl_pango_glyph_cache_update_position_cb (void                        *user_dat
 
   value->tx1 = rect->x / tex_width;
   value->ty1 = rect->y / tex_height;
-  value->tx2 = (rect->x + value->draw_width) / tex_width;
-  value->ty2 = (rect->y + value->draw_height) / tex_height;
+  value->tx2 = (rect->x + value->tex_width) / tex_width;
+  value->ty2 = (rect->y + value->tex_height) / tex_height;
+
+  if (value->sdf)
+    g_object_set_qdata (G_OBJECT (new_texture),
+                        cogl_pango_glyph_cache_get_sdf_key (),
+                        GINT_TO_POINTER (TRUE));
 
   value->tx_pixel = rect->x;
   value->ty_pixel = rect->y;
@@ -227,6 +266,11 @@ cogl_pango_glyph_cache_add_to_global_atlas (CoglPangoGlyphCache *cache,
   if (cache->use_mipmapping)
     return FALSE;
 
+  /* Distance fields need their own pipeline, so keep them out of the
+     atlas shared with everything else */
+  if (cache->use_sdf)
+    return FALSE;
+
   texture = cogl_atlas_texture_new_with_size (cache->ctx,
                                               value->draw_width,
                                               value->draw_height);
@@ -271,8 +315,8 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
   /* Look for an atlas that can reserve the space */
   for (l = cache->atlases; l; l = l->next)
     if (_cogl_atlas_reserve_space (l->data,
-                                   value->draw_width + 1,
-                                   value->draw_height + 1,
+                                   value->tex_width + 1,
+                                   value->tex_height + 1,
                                    value))
       {
         atlas = l->data;
@@ -290,8 +334,8 @@ cogl_pango_glyph_cache_add_to_local_atlas (CoglPangoGlyphCache *cache,
       /* If we still can't reserve space then something has gone
          seriously wrong so we'll just give up */
       if (!_cogl_atlas_reserve_space (atlas,
-                                      value->draw_width + 1,
-                                      value->draw_height + 1,
+                                      value->tex_width + 1,
+                                      value->tex_height + 1,
                                       value))
         {
           g_object_unref (atlas);
@@ -336,6 +380,8 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
       value->draw_y = ink_rect.y;
       value->draw_width = ink_rect.width;
       value->draw_height = ink_rect.height;
+      value->tex_width = ink_rect.width;
+      value->tex_height = ink_rect.height;
 
       /* If the glyph is zero-sized then we don't need to reserve any
          space for it and we can just avoid painting anything */
@@ -343,6 +389,24 @@ cogl_pango_glyph_cache_lookup (CoglPangoGlyphCache *cache,
         value->dirty = FALSE;
       else
         {
+          if (cache->use_sdf)
+            {
+              int pad = (COGL_PANGO_GLYPH_CACHE_SDF_SPREAD /
+                         COGL_PANGO_GLYPH_CACHE_SDF_OVERSAMPLE);
+
+              /* Leave room around the outline for the distance ramp
+                 so it doesn't get cut off at the quad edges */
+              value->sdf = TRUE;
+              value->draw_x -= pad;
+              value->draw_y -= pad;
+              value->draw_width += pad * 2;
+              value->draw_height += pad * 2;
+              value->tex_width =
+                value->draw_width * COGL_PANGO_GLYPH_CACHE_SDF_OVERSAMPLE;
+              value->tex_height =
+                value->draw_height * COGL_PANGO_GLYPH_CACHE_SDF_OVERSAMPLE;
+            }
+
           /* Try adding the glyph to the global atlas... */
           if (!cogl_pango_glyph_cache_add_to_global_atlas (cache,
                                                            font,
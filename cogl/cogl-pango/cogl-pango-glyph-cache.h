@@ -55,13 +55,28 @@ struct _CoglPangoGlyphCacheValue
   int draw_width;
   int draw_height;
 
+  /* Size of the glyph image in the texture. This is the same as the
+     draw size unless the glyph is stored as a distance field, which
+     is rendered oversampled */
+  int tex_width;
+  int tex_height;
+
   /* This will be set to TRUE when the glyph atlas is reorganized
      which means the glyph will need to be redrawn */
   guint dirty : 1;
   /* Set to TRUE if the glyph has colors (eg. emoji) */
   guint has_color : 1;
+  /* Set to TRUE if the texture contains a signed distance field of
+     the glyph rather than its coverage */
+  guint sdf : 1;
 };
 
+/* Distance field glyphs are rasterized at this multiple of their
+   size, and store distances of up to COGL_PANGO_GLYPH_CACHE_SDF_SPREAD
+   texels from the outline */
+#define COGL_PANGO_GLYPH_CACHE_SDF_OVERSAMPLE 2
+#define COGL_PANGO_GLYPH_CACHE_SDF_SPREAD 4
+
 typedef void (* CoglPangoGlyphCacheDirtyFunc) (PangoFont *font,
                                                PangoGlyph glyph,
                                                CoglPangoGlyphCacheValue *value);
@@ -70,6 +85,12 @@ COGL_EXPORT CoglPangoGlyphCache *
 cogl_pango_glyph_cache_new (CoglContext *ctx,
                             gboolean use_mipmapping);
 
+CoglPangoGlyphCache *
+_cogl_pango_glyph_cache_new_sdf (CoglContext *ctx);
+
+gboolean
+_cogl_pango_glyph_cache_is_sdf_texture (CoglTexture *texture);
+
 COGL_EXPORT void
 cogl_pango_glyph_cache_free (CoglPangoGlyphCache *cache);
 
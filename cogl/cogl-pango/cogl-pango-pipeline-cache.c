@@ -35,6 +35,7 @@
 
 #include <glib.h>
 
+#include "cogl-pango/cogl-pango-glyph-cache.h"
 #include "cogl-pango/cogl-pango-pipeline-cache.h"
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-texture-private.h"
@@ -93,6 +94,7 @@ _cogl_pango_pipeline_cache_new (CoglContext *ctx,
 
   cache->base_texture_rgba_pipeline = NULL;
   cache->base_texture_alpha_pipeline = NULL;
+  cache->base_texture_sdf_pipeline = NULL;
 
   cache->use_mipmapping = use_mipmapping;
 
@@ -154,6 +156,45 @@ get_base_texture_alpha_pipeline (CoglPangoPipelineCache *cache)
   return cache->base_texture_alpha_pipeline;
 }
 
+static CoglPipeline *
+get_base_texture_sdf_pipeline (CoglPangoPipelineCache *cache)
+{
+  if (cache->base_texture_sdf_pipeline == NULL)
+    {
+      CoglPipeline *pipeline;
+      CoglSnippet *snippet;
+
+      pipeline = cogl_pipeline_copy (get_base_texture_alpha_pipeline (cache));
+      cache->base_texture_sdf_pipeline = pipeline;
+
+      /* The distance field has to be interpolated, and mipmaps of it
+         are meaningless */
+      cogl_pipeline_set_layer_filters (pipeline, 0,
+                                       COGL_PIPELINE_FILTER_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+
+      /* The texture stores 0.5 on the outline, so turn the distance
+       * back into coverage with a ramp about one screen pixel wide.
+       * The width depends on the scale the text is drawn at, which the
+       * display list passes in as a uniform for each draw since
+       * fwidth() isn't available in the GLSL versions we target.
+       */
+      snippet =
+        cogl_snippet_new (COGL_SNIPPET_HOOK_TEXTURE_LOOKUP,
+                          "uniform float "
+                          COGL_PANGO_PIPELINE_CACHE_SDF_SMOOTHING_UNIFORM ";\n",
+                          "cogl_texel.a = smoothstep (0.5 - "
+                          COGL_PANGO_PIPELINE_CACHE_SDF_SMOOTHING_UNIFORM ",\n"
+                          "                           0.5 + "
+                          COGL_PANGO_PIPELINE_CACHE_SDF_SMOOTHING_UNIFORM ",\n"
+                          "                           cogl_texel.a);\n");
+      cogl_pipeline_add_layer_snippet (pipeline, 0, snippet);
+      g_object_unref (snippet);
+    }
+
+  return cache->base_texture_sdf_pipeline;
+}
+
 typedef struct
 {
   CoglPangoPipelineCache *cache;
@@ -192,7 +233,9 @@ _cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
 
       entry->texture = g_object_ref (texture);
 
-      if (_cogl_texture_get_format (entry->texture) == COGL_PIXEL_FORMAT_A_8)
+      if (_cogl_pango_glyph_cache_is_sdf_texture (entry->texture))
+        base = get_base_texture_sdf_pipeline (cache);
+      else if (_cogl_texture_get_format (entry->texture) == COGL_PIXEL_FORMAT_A_8)
         base = get_base_texture_alpha_pipeline (cache);
       else
         base = get_base_texture_rgba_pipeline (cache);
@@ -233,6 +276,8 @@ _cogl_pango_pipeline_cache_free (CoglPangoPipelineCache *cache)
     g_object_unref (cache->base_texture_rgba_pipeline);
   if (cache->base_texture_alpha_pipeline)
     g_object_unref (cache->base_texture_alpha_pipeline);
+  if (cache->base_texture_sdf_pipeline)
+    g_object_unref (cache->base_texture_sdf_pipeline);
 
   g_hash_table_destroy (cache->hash_table);
 
@@ -47,6 +47,7 @@ typedef struct _CoglPangoPipelineCache
 
   CoglPipeline *base_texture_alpha_pipeline;
   CoglPipeline *base_texture_rgba_pipeline;
+  CoglPipeline *base_texture_sdf_pipeline;
 
   gboolean use_mipmapping;
 } CoglPangoPipelineCache;
@@ -63,6 +64,10 @@ CoglPipeline *
 _cogl_pango_pipeline_cache_get (CoglPangoPipelineCache *cache,
                                 CoglTexture *texture);
 
+/* Name of the float uniform holding half the width, in distance field
+   units, of the anti-aliasing ramp applied to distance field glyphs */
+#define COGL_PANGO_PIPELINE_CACHE_SDF_SMOOTHING_UNIFORM "cogl_pango_sdf_smoothing"
+
 void
 _cogl_pango_pipeline_cache_free (CoglPangoPipelineCache *cache);
 
@@ -51,6 +51,12 @@ _cogl_pango_renderer_set_use_mipmapping (CoglPangoRenderer *renderer,
 gboolean
 _cogl_pango_renderer_get_use_mipmapping (CoglPangoRenderer *renderer);
 
+void
+_cogl_pango_renderer_set_use_sdf (CoglPangoRenderer *renderer,
+                                  gboolean value);
+gboolean
+_cogl_pango_renderer_get_use_sdf (CoglPangoRenderer *renderer);
+
 
 
 CoglContext *
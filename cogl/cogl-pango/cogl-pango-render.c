@@ -40,6 +40,7 @@
 #include <pango/pango-renderer.h>
 #include <cairo.h>
 #include <cairo-ft.h>
+#include <math.h>
 
 #include "cogl/cogl-debug.h"
 #include "cogl/cogl-context-private.h"
@@ -75,8 +76,16 @@ struct _CoglPangoRenderer
      caches, one with mipmapped textures and one without */
   CoglPangoRendererCaches no_mipmap_caches;
   CoglPangoRendererCaches mipmap_caches;
+  /* Glyphs stored as distance fields, used for text that is drawn
+     scaled or rotated when use_sdf is enabled */
+  CoglPangoRendererCaches sdf_caches;
 
   gboolean use_mipmapping;
+  gboolean use_sdf;
+
+  /* Whether the layout currently being prepared or drawn uses the
+     distance field caches */
+  gboolean sdf_active;
 
   /* The current display list that is being built */
   CoglPangoDisplayList *display_list;
@@ -103,6 +112,9 @@ struct _CoglPangoLayoutQdata
      need to regenerate the display list if the mipmapping value is
      changed because it will be using a different set of textures */
   gboolean mipmapping_used;
+  /* Likewise for whether the glyphs came from the distance field
+     cache */
+  gboolean sdf_used;
 };
 
 static void
@@ -121,6 +133,83 @@ _cogl_pango_renderer_new (CoglContext *context)
                                        "context", context, NULL));
 }
 
+static CoglPangoRendererCaches *
+cogl_pango_renderer_get_default_caches (CoglPangoRenderer *priv)
+{
+  /* Glyphs that can't be distance fields still come from the regular
+     caches when drawing with distance fields, and the display list
+     then uses the distance field pipeline cache for all of them. That
+     cache is never mipmapped so neither are these glyphs */
+  if (priv->use_mipmapping && !priv->sdf_active)
+    return &priv->mipmap_caches;
+  else
+    return &priv->no_mipmap_caches;
+}
+
+static CoglPangoRendererCaches *
+cogl_pango_renderer_get_pipeline_caches (CoglPangoRenderer *priv)
+{
+  if (priv->sdf_active)
+    return &priv->sdf_caches;
+  else
+    return cogl_pango_renderer_get_default_caches (priv);
+}
+
+static void
+map_to_window (const graphene_matrix_t *mvp,
+               const float             *viewport,
+               float                    x,
+               float                    y,
+               graphene_point_t        *out)
+{
+  graphene_vec4_t point;
+
+  graphene_vec4_init (&point, x, y, 0.0f, 1.0f);
+  graphene_matrix_transform_vec4 (mvp, &point, &point);
+
+  out->x = viewport[0] + (graphene_vec4_get_x (&point) /
+                          graphene_vec4_get_w (&point) + 1.0f) * viewport[2] / 2.0f;
+  out->y = viewport[1] + (graphene_vec4_get_y (&point) /
+                          graphene_vec4_get_w (&point) + 1.0f) * viewport[3] / 2.0f;
+}
+
+/* Works out how many framebuffer pixels one unit of the layout covers
+ * around its origin. Returns TRUE if the text is drawn at its natural
+ * size without rotation, which is where the bitmap glyphs look best.
+ */
+static gboolean
+cogl_pango_get_text_scale (CoglFramebuffer *fb,
+                           float           *scale)
+{
+  graphene_matrix_t modelview, projection, mvp;
+  graphene_point_t origin, x_axis, y_axis;
+  float viewport[4];
+  float dx_x, dx_y, dy_x, dy_y;
+
+  cogl_framebuffer_get_modelview_matrix (fb, &modelview);
+  cogl_framebuffer_get_projection_matrix (fb, &projection);
+  graphene_matrix_multiply (&modelview, &projection, &mvp);
+  cogl_framebuffer_get_viewport4fv (fb, viewport);
+
+  map_to_window (&mvp, viewport, 0.0f, 0.0f, &origin);
+  map_to_window (&mvp, viewport, 1.0f, 0.0f, &x_axis);
+  map_to_window (&mvp, viewport, 0.0f, 1.0f, &y_axis);
+
+  dx_x = x_axis.x - origin.x;
+  dx_y = x_axis.y - origin.y;
+  dy_x = y_axis.x - origin.x;
+  dy_y = y_axis.y - origin.y;
+
+  *scale = sqrtf (fabsf (dx_x * dy_y - dx_y * dy_x));
+
+  /* Whether the y axis ends up flipped depends on the framebuffer, so
+     only its length matters */
+  return (G_APPROX_VALUE (dx_x, 1.0f, 0.01f) &&
+          G_APPROX_VALUE (dx_y, 0.0f, 0.01f) &&
+          G_APPROX_VALUE (dy_x, 0.0f, 0.01f) &&
+          G_APPROX_VALUE (fabsf (dy_y), 1.0f, 0.01f));
+}
+
 static void
 cogl_pango_renderer_slice_cb (CoglTexture *texture,
                               const float *slice_coords,
@@ -217,11 +306,15 @@ _cogl_pango_renderer_constructed (GObject *gobject)
     _cogl_pango_pipeline_cache_new (ctx, FALSE);
   renderer->mipmap_caches.pipeline_cache =
     _cogl_pango_pipeline_cache_new (ctx, TRUE);
+  renderer->sdf_caches.pipeline_cache =
+    _cogl_pango_pipeline_cache_new (ctx, FALSE);
 
   renderer->no_mipmap_caches.glyph_cache =
     cogl_pango_glyph_cache_new (ctx, FALSE);
   renderer->mipmap_caches.glyph_cache =
     cogl_pango_glyph_cache_new (ctx, TRUE);
+  renderer->sdf_caches.glyph_cache =
+    _cogl_pango_glyph_cache_new_sdf (ctx);
 
   _cogl_pango_renderer_set_use_mipmapping (renderer, FALSE);
 
@@ -290,9 +383,11 @@ cogl_pango_renderer_finalize (GObject *object)
 
   cogl_pango_glyph_cache_free (priv->no_mipmap_caches.glyph_cache);
   cogl_pango_glyph_cache_free (priv->mipmap_caches.glyph_cache);
+  cogl_pango_glyph_cache_free (priv->sdf_caches.glyph_cache);
 
   _cogl_pango_pipeline_cache_free (priv->no_mipmap_caches.pipeline_cache);
   _cogl_pango_pipeline_cache_free (priv->mipmap_caches.pipeline_cache);
+  _cogl_pango_pipeline_cache_free (priv->sdf_caches.pipeline_cache);
 
   G_OBJECT_CLASS (cogl_pango_renderer_parent_class)->finalize (object);
 }
@@ -336,6 +431,16 @@ cogl_pango_layout_qdata_forget_display_list (CoglPangoLayoutQdata *qdata)
         &qdata->renderer->mipmap_caches :
         &qdata->renderer->no_mipmap_caches;
 
+      if (qdata->sdf_used)
+        {
+          caches = &qdata->renderer->no_mipmap_caches;
+
+          _cogl_pango_glyph_cache_remove_reorganize_callback
+            (qdata->renderer->sdf_caches.glyph_cache,
+             (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
+             qdata);
+        }
+
       _cogl_pango_glyph_cache_remove_reorganize_callback
         (caches->glyph_cache,
          (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
@@ -366,12 +471,19 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
   PangoContext *context;
   CoglPangoRenderer *priv;
   CoglPangoLayoutQdata *qdata;
+  gboolean use_sdf;
+  float scale = 1.0f;
 
   context = pango_layout_get_context (layout);
   priv = cogl_pango_get_renderer_from_context (context);
   if (G_UNLIKELY (!priv))
     return;
 
+  cogl_framebuffer_push_matrix (fb);
+  cogl_framebuffer_translate (fb, x, y, 0);
+
+  use_sdf = (priv->use_sdf && !cogl_pango_get_text_scale (fb, &scale));
+
   qdata = g_object_get_qdata (G_OBJECT (layout),
                               cogl_pango_layout_get_qdata_key ());
 
@@ -392,14 +504,16 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
   if (qdata->display_list &&
       ((qdata->first_line &&
         qdata->first_line->layout != layout) ||
-       qdata->mipmapping_used != priv->use_mipmapping))
+       qdata->mipmapping_used != priv->use_mipmapping ||
+       qdata->sdf_used != use_sdf))
     cogl_pango_layout_qdata_forget_display_list (qdata);
 
   if (qdata->display_list == NULL)
     {
-      CoglPangoRendererCaches *caches = priv->use_mipmapping ?
-        &priv->mipmap_caches :
-        &priv->no_mipmap_caches;
+      CoglPangoRendererCaches *caches;
+
+      priv->sdf_active = use_sdf;
+      caches = cogl_pango_renderer_get_pipeline_caches (priv);
 
       cogl_pango_ensure_glyph_cache_for_layout (layout);
 
@@ -409,23 +523,28 @@ cogl_pango_show_layout (CoglFramebuffer *fb,
       /* Register for notification of when the glyph cache changes so
          we can rebuild the display list */
       _cogl_pango_glyph_cache_add_reorganize_callback
-        (caches->glyph_cache,
+        (cogl_pango_renderer_get_default_caches (priv)->glyph_cache,
          (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
          qdata);
+      if (use_sdf)
+        _cogl_pango_glyph_cache_add_reorganize_callback
+          (priv->sdf_caches.glyph_cache,
+           (GHookFunc) cogl_pango_layout_qdata_forget_display_list,
+           qdata);
 
       priv->display_list = qdata->display_list;
       pango_renderer_draw_layout (PANGO_RENDERER (priv), layout, 0, 0);
       priv->display_list = NULL;
+      priv->sdf_active = FALSE;
 
       qdata->mipmapping_used = priv->use_mipmapping;
+      qdata->sdf_used = use_sdf;
     }
 
-  cogl_framebuffer_push_matrix (fb);
-  cogl_framebuffer_translate (fb, x, y, 0);
-
   _cogl_pango_display_list_render (fb,
                                    qdata->display_list,
-                                   color);
+                                   color,
+                                   scale);
 
   cogl_framebuffer_pop_matrix (fb);
 
@@ -455,15 +574,16 @@ cogl_pango_show_layout_line (CoglFramebuffer *fb,
   CoglPangoRendererCaches *caches;
   int pango_x = x * PANGO_SCALE;
   int pango_y = y * PANGO_SCALE;
+  float scale = 1.0f;
 
   context = pango_layout_get_context (line->layout);
   priv = cogl_pango_get_renderer_from_context (context);
   if (G_UNLIKELY (!priv))
     return;
 
-  caches = (priv->use_mipmapping ?
-            &priv->mipmap_caches :
-            &priv->no_mipmap_caches);
+  priv->sdf_active = (priv->use_sdf &&
+                      !cogl_pango_get_text_scale (fb, &scale));
+  caches = cogl_pango_renderer_get_pipeline_caches (priv);
 
   priv->display_list = _cogl_pango_display_list_new (caches->pipeline_cache);
 
@@ -474,10 +594,12 @@ cogl_pango_show_layout_line (CoglFramebuffer *fb,
 
   _cogl_pango_display_list_render (fb,
                                    priv->display_list,
-                                   color);
+                                   color,
+                                   scale);
 
   _cogl_pango_display_list_free (priv->display_list);
   priv->display_list = NULL;
+  priv->sdf_active = FALSE;
 }
 
 void
@@ -485,6 +607,7 @@ _cogl_pango_renderer_clear_glyph_cache (CoglPangoRenderer *renderer)
 {
   cogl_pango_glyph_cache_clear (renderer->mipmap_caches.glyph_cache);
   cogl_pango_glyph_cache_clear (renderer->no_mipmap_caches.glyph_cache);
+  cogl_pango_glyph_cache_clear (renderer->sdf_caches.glyph_cache);
 }
 
 void
@@ -500,19 +623,17 @@ _cogl_pango_renderer_get_use_mipmapping (CoglPangoRenderer *renderer)
   return renderer->use_mipmapping;
 }
 
-static CoglPangoGlyphCacheValue *
-cogl_pango_renderer_get_cached_glyph (PangoRenderer *renderer,
-                                      gboolean       create,
-                                      PangoFont     *font,
-                                      PangoGlyph     glyph)
+void
+_cogl_pango_renderer_set_use_sdf (CoglPangoRenderer *renderer,
+                                  gboolean           value)
 {
-  CoglPangoRenderer *priv = COGL_PANGO_RENDERER (renderer);
-  CoglPangoRendererCaches *caches = (priv->use_mipmapping ?
-                                     &priv->mipmap_caches :
-                                     &priv->no_mipmap_caches);
+  renderer->use_sdf = value;
+}
 
-  return cogl_pango_glyph_cache_lookup (caches->glyph_cache,
-                                        create, font, glyph);
+gboolean
+_cogl_pango_renderer_get_use_sdf (CoglPangoRenderer *renderer)
+{
+  return renderer->use_sdf;
 }
 
 static gboolean
@@ -533,6 +654,161 @@ font_has_color_glyphs (const PangoFont *font)
   return has_color;
 }
 
+static CoglPangoGlyphCacheValue *
+cogl_pango_renderer_get_cached_glyph (PangoRenderer *renderer,
+                                      gboolean       create,
+                                      PangoFont     *font,
+                                      PangoGlyph     glyph)
+{
+  CoglPangoRenderer *priv = COGL_PANGO_RENDERER (renderer);
+  CoglPangoRendererCaches *caches;
+
+  /* A distance field only has a single channel so color glyphs keep
+     using the regular bitmaps */
+  if (priv->sdf_active && !font_has_color_glyphs (font))
+    caches = &priv->sdf_caches;
+  else
+    caches = cogl_pango_renderer_get_default_caches (priv);
+
+  return cogl_pango_glyph_cache_lookup (caches->glyph_cache,
+                                        create, font, glyph);
+}
+
+static inline uint8_t
+get_coverage (const uint8_t *coverage,
+              int            stride,
+              int            width,
+              int            height,
+              int            x,
+              int            y)
+{
+  if (x < 0 || y < 0 || x >= width || y >= height)
+    return 0;
+
+  return coverage[y * stride + x];
+}
+
+/* Turns an anti-aliased coverage mask into a signed distance field,
+ * where 0.5 is on the outline and every 1 / (2 * SPREAD) step away
+ * from that is one texel further inside or outside. Partially covered
+ * texels sit on the outline, and their coverage is used to place the
+ * outline within them, which keeps the result accurate to a fraction
+ * of a texel. Glyphs are small and the search is limited to the
+ * spread, so a direct search is cheap enough here.
+ */
+static void
+compute_distance_field (const uint8_t *coverage,
+                        int            stride,
+                        int            width,
+                        int            height,
+                        uint8_t       *field)
+{
+  int spread = COGL_PANGO_GLYPH_CACHE_SDF_SPREAD;
+  int x, y;
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          uint8_t a = get_coverage (coverage, stride, width, height, x, y);
+          float d;
+
+          if (a > 0 && a < 255)
+            {
+              d = a / 255.0f - 0.5f;
+            }
+          else
+            {
+              gboolean inside = a == 255;
+              float best = spread;
+              int dx, dy;
+
+              for (dy = -spread; dy <= spread; dy++)
+                {
+                  for (dx = -spread; dx <= spread; dx++)
+                    {
+                      uint8_t b = get_coverage (coverage, stride,
+                                                width, height,
+                                                x + dx, y + dy);
+                      float dist;
+
+                      if ((b >= 128) == inside)
+                        continue;
+
+                      dist = sqrtf (dx * dx + dy * dy);
+                      if (inside)
+                        dist += b / 255.0f - 0.5f;
+                      else
+                        dist += 0.5f - b / 255.0f;
+
+                      best = MIN (best, dist);
+                    }
+                }
+
+              d = inside ? best : -best;
+            }
+
+          d = 0.5f + d / (2.0f * spread);
+          field[y * width + x] = (uint8_t) (CLAMP (d, 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+}
+
+static void
+cogl_pango_renderer_set_dirty_sdf_glyph (PangoFont                *font,
+                                         PangoGlyph                glyph,
+                                         CoglPangoGlyphCacheValue *value)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  cairo_glyph_t cairo_glyph;
+  g_autofree uint8_t *field = NULL;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_A8,
+                                        value->tex_width,
+                                        value->tex_height);
+  cr = cairo_create (surface);
+
+  cairo_set_scaled_font (cr,
+                         pango_cairo_font_get_scaled_font (PANGO_CAIRO_FONT (font)));
+  cairo_scale (cr,
+               COGL_PANGO_GLYPH_CACHE_SDF_OVERSAMPLE,
+               COGL_PANGO_GLYPH_CACHE_SDF_OVERSAMPLE);
+  cairo_set_source_rgba (cr, 1.0, 1.0, 1.0, 1.0);
+
+  cairo_glyph.x = -value->draw_x;
+  cairo_glyph.y = -value->draw_y;
+  cairo_glyph.index = glyph;
+  cairo_show_glyphs (cr, &cairo_glyph, 1);
+
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  field = g_malloc (value->tex_width * value->tex_height);
+  compute_distance_field (cairo_image_surface_get_data (surface),
+                          cairo_image_surface_get_stride (surface),
+                          value->tex_width,
+                          value->tex_height,
+                          field);
+
+  cairo_surface_destroy (surface);
+
+  cogl_texture_set_region (value->texture,
+                           0, /* src_x */
+                           0, /* src_y */
+                           value->tx_pixel, /* dst_x */
+                           value->ty_pixel, /* dst_y */
+                           value->tex_width, /* dst_width */
+                           value->tex_height, /* dst_height */
+                           value->tex_width, /* width */
+                           value->tex_height, /* height */
+                           COGL_PIXEL_FORMAT_A_8,
+                           value->tex_width,
+                           field);
+
+  value->has_color = FALSE;
+}
+
 static void
 cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
                                      PangoGlyph glyph,
@@ -552,6 +828,12 @@ cogl_pango_renderer_set_dirty_glyph (PangoFont *font,
      here */
   g_return_if_fail (value->texture != NULL);
 
+  if (value->sdf)
+    {
+      cogl_pango_renderer_set_dirty_sdf_glyph (font, glyph, value);
+      return;
+    }
+
   if (_cogl_texture_get_format (value->texture) == COGL_PIXEL_FORMAT_A_8)
     {
       format_cairo = CAIRO_FORMAT_A8;
@@ -652,6 +934,8 @@ _cogl_pango_set_dirty_glyphs (CoglPangoRenderer *priv)
     (priv->mipmap_caches.glyph_cache, cogl_pango_renderer_set_dirty_glyph);
   _cogl_pango_glyph_cache_set_dirty_glyphs
     (priv->no_mipmap_caches.glyph_cache, cogl_pango_renderer_set_dirty_glyph);
+  _cogl_pango_glyph_cache_set_dirty_glyphs
+    (priv->sdf_caches.glyph_cache, cogl_pango_renderer_set_dirty_glyph);
 }
 
 static void
@@ -149,6 +149,32 @@ cogl_pango_font_map_set_use_mipmapping (CoglPangoFontMap *font_map,
 COGL_EXPORT gboolean
 cogl_pango_font_map_get_use_mipmapping (CoglPangoFontMap *font_map);
 
+/**
+ * cogl_pango_font_map_set_use_sdf:
+ * @font_map: a #CoglPangoFontMap
+ * @value: %TRUE to render transformed text from distance fields
+ *
+ * Sets whether the renderer for the passed font map should draw text
+ * that is scaled or rotated from signed distance fields of the glyphs
+ * instead of stretching the bitmaps rasterized at the natural size.
+ * Text drawn at its natural size keeps using the bitmaps.
+ */
+COGL_EXPORT void
+cogl_pango_font_map_set_use_sdf (CoglPangoFontMap *font_map,
+                                 gboolean value);
+
+/**
+ * cogl_pango_font_map_get_use_sdf:
+ * @font_map: a #CoglPangoFontMap
+ *
+ * Retrieves whether the [class@CoglPango.Renderer] used by @font_map will
+ * use distance fields to draw transformed text.
+ *
+ * Return value: %TRUE if distance fields are used, %FALSE otherwise.
+ */
+COGL_EXPORT gboolean
+cogl_pango_font_map_get_use_sdf (CoglPangoFontMap *font_map);
+
 /**
  * cogl_pango_font_map_get_renderer:
  * @font_map: a #CoglPangoFontMap
@@ -45,6 +45,15 @@
 
 #include <stdlib.h>
 
+/* Atlases are split into pages of at most this size instead of growing
+ * up to the maximum texture size. Once a page is full the users of the
+ * atlas start a new one, so growing never has to copy more than one
+ * page worth of textures */
+#define COGL_ATLAS_MAX_PAGE_SIZE 2048
+
+/* Compact an atlas once less than this fraction of it is in use */
+#define COGL_ATLAS_COMPACT_THRESHOLD 4
+
 G_DEFINE_TYPE (CoglAtlas, cogl_atlas, G_TYPE_OBJECT);
 
 static void
@@ -54,6 +63,8 @@ cogl_atlas_dispose (GObject *object)
 
   COGL_NOTE (ATLAS, "%p: Atlas destroyed", atlas);
 
+  g_clear_handle_id (&atlas->compact_idle_id, g_source_remove);
+
   if (atlas->texture)
     g_object_unref (atlas->texture);
   if (atlas->map)
@@ -247,8 +258,12 @@ _cogl_atlas_create_map (CoglPixelFormat          format,
                                           &gl_type);
 
   /* Keep trying increasingly larger atlases until we can fit all of
-     the textures */
-  while (ctx->texture_driver->size_supported (ctx,
+     the textures. Pages don't grow past the maximum page size unless
+     they only hold a single texture that wouldn't fit otherwise */
+  while ((n_textures == 1 ||
+          (map_width <= COGL_ATLAS_MAX_PAGE_SIZE &&
+           map_height <= COGL_ATLAS_MAX_PAGE_SIZE)) &&
+         ctx->texture_driver->size_supported (ctx,
                                               GL_TEXTURE_2D,
                                               gl_intformat,
                                               gl_format,
@@ -552,6 +567,133 @@ _cogl_atlas_reserve_space (CoglAtlas             *atlas,
   return ret;
 }
 
+static void
+_cogl_atlas_compact (CoglAtlas *atlas)
+{
+  CoglAtlasGetRectanglesData data;
+  CoglRectangleMap *new_map;
+  CoglTexture *new_tex;
+  unsigned int map_width = 0, map_height = 0;
+  unsigned int n_rectangles;
+
+  n_rectangles = _cogl_rectangle_map_get_n_rectangles (atlas->map);
+
+  _cogl_atlas_get_initial_size (atlas->texture_format,
+                                &map_width, &map_height);
+
+  /* An empty atlas will be destroyed along with its last texture */
+  if (n_rectangles == 0 || map_width == 0)
+    return;
+
+  data.n_textures = 0;
+  data.textures = g_new (CoglAtlasRepositionData, n_rectangles);
+  _cogl_rectangle_map_foreach (atlas->map,
+                               _cogl_atlas_get_rectangles_cb,
+                               &data);
+
+  qsort (data.textures, data.n_textures,
+         sizeof (CoglAtlasRepositionData),
+         _cogl_atlas_compare_size_cb);
+
+  new_map = _cogl_atlas_create_map (atlas->texture_format,
+                                    map_width, map_height,
+                                    data.n_textures, data.textures);
+
+  /* Only bother migrating if the textures fit in a smaller page */
+  if (new_map &&
+      (_cogl_rectangle_map_get_width (new_map) *
+       _cogl_rectangle_map_get_height (new_map) >=
+       _cogl_rectangle_map_get_width (atlas->map) *
+       _cogl_rectangle_map_get_height (atlas->map)))
+    g_clear_pointer (&new_map, _cogl_rectangle_map_free);
+
+  if (new_map == NULL)
+    {
+      g_free (data.textures);
+      return;
+    }
+
+  new_tex = _cogl_atlas_create_texture (atlas,
+                                        _cogl_rectangle_map_get_width (new_map),
+                                        _cogl_rectangle_map_get_height (new_map));
+  if (new_tex == NULL)
+    {
+      _cogl_rectangle_map_free (new_map);
+      g_free (data.textures);
+      return;
+    }
+
+  COGL_NOTE (ATLAS, "%p: Atlas compacted from %ix%i to %ix%i",
+             atlas,
+             _cogl_rectangle_map_get_width (atlas->map),
+             _cogl_rectangle_map_get_height (atlas->map),
+             _cogl_rectangle_map_get_width (new_map),
+             _cogl_rectangle_map_get_height (new_map));
+
+  _cogl_atlas_notify_pre_reorganize (atlas);
+
+  _cogl_atlas_migrate (atlas,
+                       data.n_textures,
+                       data.textures,
+                       atlas->texture,
+                       new_tex,
+                       NULL);
+  _cogl_rectangle_map_free (atlas->map);
+  g_object_unref (atlas->texture);
+
+  atlas->map = new_map;
+  atlas->texture = new_tex;
+
+  _cogl_atlas_notify_post_reorganize (atlas);
+
+  g_free (data.textures);
+}
+
+static gboolean
+_cogl_atlas_compact_idle_cb (gpointer user_data)
+{
+  CoglAtlas *atlas = user_data;
+
+  atlas->compact_idle_id = 0;
+
+  _cogl_atlas_compact (atlas);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+_cogl_atlas_maybe_queue_compact (CoglAtlas *atlas)
+{
+  unsigned int map_width = _cogl_rectangle_map_get_width (atlas->map);
+  unsigned int map_height = _cogl_rectangle_map_get_height (atlas->map);
+  unsigned int used_space;
+  unsigned int initial_width = 0, initial_height = 0;
+
+  if (atlas->compact_idle_id)
+    return;
+
+  _cogl_atlas_get_initial_size (atlas->texture_format,
+                                &initial_width, &initial_height);
+
+  /* The atlas can't get any smaller than a new one would be */
+  if (map_width * map_height <= initial_width * initial_height)
+    return;
+
+  used_space = (map_width * map_height -
+                _cogl_rectangle_map_get_remaining_space (atlas->map));
+
+  if (used_space * COGL_ATLAS_COMPACT_THRESHOLD >= map_width * map_height)
+    return;
+
+  /* Removing a texture often happens while painting, so the repacking
+   * is left for when the main loop is idle instead of flushing the
+   * journals in the middle of a frame */
+  atlas->compact_idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                            _cogl_atlas_compact_idle_cb,
+                                            atlas,
+                                            NULL);
+}
+
 void
 _cogl_atlas_remove (CoglAtlas *atlas,
                     const CoglRectangleMapEntry *rectangle)
@@ -570,6 +712,8 @@ _cogl_atlas_remove (CoglAtlas *atlas,
              _cogl_rectangle_map_get_remaining_space (atlas->map) *
              100 / (_cogl_rectangle_map_get_width (atlas->map) *
                     _cogl_rectangle_map_get_height (atlas->map)));
+
+  _cogl_atlas_maybe_queue_compact (atlas);
 };
 
 static CoglTexture *
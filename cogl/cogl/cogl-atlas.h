@@ -67,6 +67,10 @@ struct _CoglAtlas
 
   GHookList pre_reorganize_callbacks;
   GHookList post_reorganize_callbacks;
+
+  /* Idle source used to repack the atlas into a smaller texture once
+   * enough of its rectangles have been removed */
+  unsigned int compact_idle_id;
 };
 
 COGL_EXPORT CoglAtlas *
@@ -35,9 +35,21 @@
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-texture-private.h"
 #include "cogl/cogl-half-float.h"
+#include "cogl/cogl-cpu-caps.h"
 
 #include <string.h>
 
+#if defined (__x86_64) && defined (__GNUC__)
+#include <immintrin.h>
+#define HAVE_SSSE3_KERNELS 1
+#define HAVE_AVX2_KERNELS 1
+#endif
+
+#if defined (__ARM_NEON) && defined (__aarch64__)
+#include <arm_neon.h>
+#define HAVE_NEON_KERNELS 1
+#endif
+
 typedef enum
 {
   MEDIUM_TYPE_8,
@@ -345,10 +357,146 @@ _cogl_premult_alpha_last_four_pixels_sse2 (uint8_t *p)
 
 #endif /* COGL_USE_PREMULT_SSE2 */
 
+#ifdef HAVE_AVX2_KERNELS
+
+/* Widens the bytes of the pixels to 16 bits, multiplies the color
+   components by the alpha word selected by ALPHA_SHUFFLE and narrows
+   them back, using the same rounding as MULT() */
+#define PREMULT_EIGHT_PIXELS_AVX2(pixels, alpha_shuffle, alpha_mask)        \
+  G_STMT_START {                                                            \
+    const __m256i zero = _mm256_setzero_si256 ();                           \
+    const __m256i half = _mm256_set1_epi16 (128);                           \
+    __m256i lo = _mm256_unpacklo_epi8 (pixels, zero);                       \
+    __m256i hi = _mm256_unpackhi_epi8 (pixels, zero);                       \
+    __m256i alpha_lo =                                                      \
+      _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (lo, alpha_shuffle),   \
+                              alpha_shuffle);                               \
+    __m256i alpha_hi =                                                      \
+      _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (hi, alpha_shuffle),   \
+                              alpha_shuffle);                               \
+                                                                            \
+    lo = _mm256_add_epi16 (_mm256_mullo_epi16 (lo, alpha_lo), half);        \
+    hi = _mm256_add_epi16 (_mm256_mullo_epi16 (hi, alpha_hi), half);        \
+    lo = _mm256_srli_epi16 (_mm256_add_epi16 (lo, _mm256_srli_epi16 (lo, 8)), \
+                            8);                                             \
+    hi = _mm256_srli_epi16 (_mm256_add_epi16 (hi, _mm256_srli_epi16 (hi, 8)), \
+                            8);                                             \
+                                                                            \
+    /* Keep the original alpha bytes */                                     \
+    pixels = _mm256_blendv_epi8 (_mm256_packus_epi16 (lo, hi),              \
+                                 pixels,                                    \
+                                 alpha_mask);                               \
+  } G_STMT_END
+
+__attribute__ ((target ("avx2")))
+static int
+_cogl_premult_alpha_last_pixels_avx2 (uint8_t *data,
+                                      int      width)
+{
+  const __m256i alpha_mask = _mm256_set1_epi32 ((int) 0xff000000);
+  int x;
+
+  for (x = 0; x + 8 <= width; x += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((__m256i *) (data + x * 4));
+
+      PREMULT_EIGHT_PIXELS_AVX2 (pixels, 0xff, alpha_mask);
+      _mm256_storeu_si256 ((__m256i *) (data + x * 4), pixels);
+    }
+
+  return x;
+}
+
+__attribute__ ((target ("avx2")))
+static int
+_cogl_premult_alpha_first_pixels_avx2 (uint8_t *data,
+                                       int      width)
+{
+  const __m256i alpha_mask = _mm256_set1_epi32 (0x000000ff);
+  int x;
+
+  for (x = 0; x + 8 <= width; x += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((__m256i *) (data + x * 4));
+
+      PREMULT_EIGHT_PIXELS_AVX2 (pixels, 0x00, alpha_mask);
+      _mm256_storeu_si256 ((__m256i *) (data + x * 4), pixels);
+    }
+
+  return x;
+}
+
+#undef PREMULT_EIGHT_PIXELS_AVX2
+
+#endif /* HAVE_AVX2_KERNELS */
+
+#ifdef HAVE_NEON_KERNELS
+
+/* Deinterleaves sixteen pixels so that each color component can be
+   multiplied by the alpha with the same rounding as MULT() */
+static int
+_cogl_premult_pixels_neon (uint8_t  *data,
+                           int       width,
+                           gboolean  alpha_first)
+{
+  const uint16x8_t half = vdupq_n_u16 (128);
+  int alpha_index = alpha_first ? 0 : 3;
+  int x;
+
+  for (x = 0; x + 16 <= width; x += 16)
+    {
+      uint8x16x4_t pixels = vld4q_u8 (data + x * 4);
+      uint8x16_t alpha = pixels.val[alpha_index];
+      int i;
+
+      for (i = 0; i < 4; i++)
+        {
+          uint16x8_t lo, hi;
+
+          if (i == alpha_index)
+            continue;
+
+          lo = vmlal_u8 (half,
+                         vget_low_u8 (pixels.val[i]),
+                         vget_low_u8 (alpha));
+          hi = vmlal_u8 (half,
+                         vget_high_u8 (pixels.val[i]),
+                         vget_high_u8 (alpha));
+          pixels.val[i] = vcombine_u8 (vshrn_n_u16 (vsraq_n_u16 (lo, lo, 8), 8),
+                                       vshrn_n_u16 (vsraq_n_u16 (hi, hi, 8), 8));
+        }
+
+      vst4q_u8 (data + x * 4, pixels);
+    }
+
+  return x;
+}
+
+#endif /* HAVE_NEON_KERNELS */
+
 static void
 _cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
                                       int width)
 {
+#ifdef HAVE_AVX2_KERNELS
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+    {
+      int done = _cogl_premult_alpha_last_pixels_avx2 (data, width);
+
+      data += done * 4;
+      width -= done;
+    }
+#endif
+
+#ifdef HAVE_NEON_KERNELS
+  {
+    int done = _cogl_premult_pixels_neon (data, width, FALSE);
+
+    data += done * 4;
+    width -= done;
+  }
+#endif
+
 #ifdef COGL_USE_PREMULT_SSE2
 
   /* Process 4 pixels at a time */
@@ -371,6 +519,52 @@ _cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
     }
 }
 
+static void
+_cogl_bitmap_premult_alpha_first_span_8 (uint8_t *data,
+                                         int      width)
+{
+#ifdef HAVE_AVX2_KERNELS
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+    {
+      int done = _cogl_premult_alpha_first_pixels_avx2 (data, width);
+
+      data += done * 4;
+      width -= done;
+    }
+#endif
+
+#ifdef HAVE_NEON_KERNELS
+  {
+    int done = _cogl_premult_pixels_neon (data, width, TRUE);
+
+    data += done * 4;
+    width -= done;
+  }
+#endif
+
+  while (width-- > 0)
+    {
+      _cogl_premult_alpha_first (data);
+      data += 4;
+    }
+}
+
+static void
+_cogl_bitmap_unpremult_alpha_first_span_8 (uint8_t *data,
+                                           int      width)
+{
+  int x;
+
+  for (x = 0; x < width; x++)
+    {
+      if (data[0] == 0)
+        _cogl_unpremult_alpha_0 (data);
+      else
+        _cogl_unpremult_alpha_first (data);
+      data += 4;
+    }
+}
+
 static void
 _cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
                                         int width)
@@ -403,6 +597,8 @@ _cogl_bitmap_unpremult_unpacked_span_16 (uint16_t *data,
           data[1] = (data[1] * 65535) / alpha;
           data[2] = (data[2] * 65535) / alpha;
         }
+
+      data += 4;
     }
 }
 
@@ -417,6 +613,8 @@ _cogl_bitmap_premult_unpacked_span_16 (uint16_t *data,
       data[0] = (data[0] * alpha) / 65535;
       data[1] = (data[1] * alpha) / 65535;
       data[2] = (data[2] * alpha) / 65535;
+
+      data += 4;
     }
 }
 
@@ -436,6 +634,8 @@ _cogl_bitmap_unpremult_unpacked_span_float (float *data,
           data[1] = data[1] / alpha;
           data[2] = data[2] / alpha;
         }
+
+      data += 4;
     }
 }
 
@@ -450,6 +650,162 @@ _cogl_bitmap_premult_unpacked_span_float (float *data,
       data[0] = data[0] * alpha;
       data[1] = data[1] * alpha;
       data[2] = data[2] * alpha;
+
+      data += 4;
+    }
+}
+
+/* Byte swizzling between the 8888 formats with an alpha channel. The
+   permutation gives the source byte for each byte of a destination
+   pixel */
+
+static void
+_cogl_swizzle_8888_generic (const uint8_t *src,
+                            uint8_t       *dst,
+                            int            width,
+                            const uint8_t  permutation[4])
+{
+  while (width-- > 0)
+    {
+      dst[0] = src[permutation[0]];
+      dst[1] = src[permutation[1]];
+      dst[2] = src[permutation[2]];
+      dst[3] = src[permutation[3]];
+
+      src += 4;
+      dst += 4;
+    }
+}
+
+#ifdef HAVE_SSSE3_KERNELS
+
+__attribute__ ((target ("ssse3")))
+static int
+_cogl_swizzle_8888_ssse3 (const uint8_t *src,
+                          uint8_t       *dst,
+                          int            width,
+                          const uint8_t  shuffle[16])
+{
+  const __m128i mask = _mm_loadu_si128 ((const __m128i *) shuffle);
+  int x;
+
+  for (x = 0; x + 4 <= width; x += 4)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) (src + x * 4));
+
+      _mm_storeu_si128 ((__m128i *) (dst + x * 4),
+                        _mm_shuffle_epi8 (pixels, mask));
+    }
+
+  return x;
+}
+
+#endif /* HAVE_SSSE3_KERNELS */
+
+#ifdef HAVE_AVX2_KERNELS
+
+__attribute__ ((target ("avx2")))
+static int
+_cogl_swizzle_8888_avx2 (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width,
+                         const uint8_t  shuffle[16])
+{
+  /* The shuffle works within each 128-bit lane so the same mask is
+     used for both halves */
+  const __m256i mask =
+    _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) shuffle));
+  int x;
+
+  for (x = 0; x + 8 <= width; x += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((const __m256i *) (src + x * 4));
+
+      _mm256_storeu_si256 ((__m256i *) (dst + x * 4),
+                           _mm256_shuffle_epi8 (pixels, mask));
+    }
+
+  return x;
+}
+
+#endif /* HAVE_AVX2_KERNELS */
+
+#ifdef HAVE_NEON_KERNELS
+
+static int
+_cogl_swizzle_8888_neon (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width,
+                         const uint8_t  shuffle[16])
+{
+  const uint8x16_t mask = vld1q_u8 (shuffle);
+  int x;
+
+  for (x = 0; x + 4 <= width; x += 4)
+    vst1q_u8 (dst + x * 4, vqtbl1q_u8 (vld1q_u8 (src + x * 4), mask));
+
+  return x;
+}
+
+#endif /* HAVE_NEON_KERNELS */
+
+static void
+_cogl_swizzle_8888 (const uint8_t *src,
+                    uint8_t       *dst,
+                    int            width,
+                    const uint8_t  permutation[4])
+{
+#if defined (HAVE_SSSE3_KERNELS) || defined (HAVE_NEON_KERNELS)
+  uint8_t shuffle[16];
+  int done = 0;
+  int i;
+
+  for (i = 0; i < 16; i++)
+    shuffle[i] = (i & ~3) + permutation[i & 3];
+
+#ifdef HAVE_AVX2_KERNELS
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+    done = _cogl_swizzle_8888_avx2 (src, dst, width, shuffle);
+#endif
+
+#ifdef HAVE_SSSE3_KERNELS
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_SSSE3))
+    done += _cogl_swizzle_8888_ssse3 (src + done * 4, dst + done * 4,
+                                      width - done, shuffle);
+#else
+  done = _cogl_swizzle_8888_neon (src, dst, width, shuffle);
+#endif
+
+  src += done * 4;
+  dst += done * 4;
+  width -= done;
+#endif
+
+  _cogl_swizzle_8888_generic (src, dst, width, permutation);
+}
+
+/* Gets the byte offsets of the red, green, blue and alpha components
+   for the 8888 formats that can be converted with a plain swizzle */
+static gboolean
+get_8888_component_offsets (CoglPixelFormat format,
+                            uint8_t         offsets[4])
+{
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+      offsets[0] = 0; offsets[1] = 1; offsets[2] = 2; offsets[3] = 3;
+      return TRUE;
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      offsets[0] = 2; offsets[1] = 1; offsets[2] = 0; offsets[3] = 3;
+      return TRUE;
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+      offsets[0] = 1; offsets[1] = 2; offsets[2] = 3; offsets[3] = 0;
+      return TRUE;
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      offsets[0] = 3; offsets[1] = 2; offsets[2] = 1; offsets[3] = 0;
+      return TRUE;
+    default:
+      return FALSE;
     }
 }
 
@@ -557,6 +913,84 @@ calculate_medium_size_pixel_size (MediumType medium_type)
   g_assert_not_reached ();
 }
 
+/* RGBA half float rows have the same component order as the unpacked
+   float medium so they can be converted with the batched helpers */
+static gboolean
+is_rgba_fp_16161616 (CoglPixelFormat format)
+{
+  return (format & ~COGL_PREMULT_BIT) == COGL_PIXEL_FORMAT_RGBA_FP_16161616;
+}
+
+/* Converts between two of the 8888 formats with an alpha channel by
+   swizzling the bytes directly into the destination instead of going
+   through the unpacked medium */
+static gboolean
+_cogl_bitmap_swizzle_into_bitmap (CoglBitmap    *src_bmp,
+                                  CoglBitmap    *dst_bmp,
+                                  const uint8_t  src_offsets[4],
+                                  const uint8_t  dst_offsets[4],
+                                  gboolean       need_premult,
+                                  GError       **error)
+{
+  CoglPixelFormat dst_format = cogl_bitmap_get_format (dst_bmp);
+  int src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
+  int dst_rowstride = cogl_bitmap_get_rowstride (dst_bmp);
+  int width = cogl_bitmap_get_width (src_bmp);
+  int height = cogl_bitmap_get_height (src_bmp);
+  gboolean alpha_first = dst_offsets[3] == 0;
+  uint8_t permutation[4];
+  uint8_t *src_data;
+  uint8_t *dst_data;
+  int i, y;
+
+  for (i = 0; i < 4; i++)
+    permutation[dst_offsets[i]] = src_offsets[i];
+
+  src_data = _cogl_bitmap_map (src_bmp, COGL_BUFFER_ACCESS_READ, 0, error);
+  if (src_data == NULL)
+    return FALSE;
+  dst_data = _cogl_bitmap_map (dst_bmp,
+                               COGL_BUFFER_ACCESS_WRITE,
+                               COGL_BUFFER_MAP_HINT_DISCARD,
+                               error);
+  if (dst_data == NULL)
+    {
+      _cogl_bitmap_unmap (src_bmp);
+      return FALSE;
+    }
+
+  for (y = 0; y < height; y++)
+    {
+      uint8_t *src = src_data + y * src_rowstride;
+      uint8_t *dst = dst_data + y * dst_rowstride;
+
+      _cogl_swizzle_8888 (src, dst, width, permutation);
+
+      if (!need_premult)
+        continue;
+
+      if (dst_format & COGL_PREMULT_BIT)
+        {
+          if (alpha_first)
+            _cogl_bitmap_premult_alpha_first_span_8 (dst, width);
+          else
+            _cogl_bitmap_premult_unpacked_span_8 (dst, width);
+        }
+      else
+        {
+          if (alpha_first)
+            _cogl_bitmap_unpremult_alpha_first_span_8 (dst, width);
+          else
+            _cogl_bitmap_unpremult_unpacked_span_8 (dst, width);
+        }
+    }
+
+  _cogl_bitmap_unmap (src_bmp);
+  _cogl_bitmap_unmap (dst_bmp);
+
+  return TRUE;
+}
+
 gboolean
 _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
                                   CoglBitmap *dst_bmp,
@@ -575,6 +1009,9 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
   CoglPixelFormat dst_format;
   MediumType medium_type;
   gboolean need_premult;
+  gboolean unpack_half_floats;
+  gboolean pack_half_floats;
+  uint8_t src_offsets[4], dst_offsets[4];
 
   src_format = cogl_bitmap_get_format (src_bmp);
   src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
@@ -621,6 +1058,13 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       return TRUE;
     }
 
+  if (get_8888_component_offsets (src_format, src_offsets) &&
+      get_8888_component_offsets (dst_format, dst_offsets))
+    return _cogl_bitmap_swizzle_into_bitmap (src_bmp, dst_bmp,
+                                             src_offsets, dst_offsets,
+                                             need_premult,
+                                             error);
+
   src_data = _cogl_bitmap_map (src_bmp, COGL_BUFFER_ACCESS_READ, 0, error);
   if (src_data == NULL)
     return FALSE;
@@ -636,6 +1080,11 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
 
   medium_type = determine_medium_size (dst_format);
 
+  unpack_half_floats = (medium_type == MEDIUM_TYPE_FLOAT &&
+                        is_rgba_fp_16161616 (src_format));
+  pack_half_floats = (medium_type == MEDIUM_TYPE_FLOAT &&
+                      is_rgba_fp_16161616 (dst_format));
+
   /* Allocate a buffer to hold a temporary RGBA row */
   tmp_row = g_malloc (width * calculate_medium_size_pixel_size (medium_type));
 
@@ -654,7 +1103,10 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
           _cogl_unpack_16 (src_format, src, tmp_row, width);
           break;
         case MEDIUM_TYPE_FLOAT:
-          _cogl_unpack_float (src_format, src, tmp_row, width);
+          if (unpack_half_floats)
+            cogl_half_to_float_n ((const uint16_t *) src, tmp_row, width * 4);
+          else
+            _cogl_unpack_float (src_format, src, tmp_row, width);
           break;
         }
 
@@ -702,7 +1154,10 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
           _cogl_pack_16 (dst_format, tmp_row, dst, width);
           break;
         case MEDIUM_TYPE_FLOAT:
-          _cogl_pack_float (dst_format, tmp_row, dst, width);
+          if (pack_half_floats)
+            cogl_float_to_half_n (tmp_row, (uint16_t *) dst, width * 4);
+          else
+            _cogl_pack_float (dst_format, tmp_row, dst, width);
           break;
         }
     }
@@ -834,7 +1289,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -872,16 +1327,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
       else
         {
           if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  if (p[0] == 0)
-                    _cogl_unpremult_alpha_0 (p);
-                  else
-                    _cogl_unpremult_alpha_first (p);
-                  p += 4;
-                }
-            }
+            _cogl_bitmap_unpremult_alpha_first_span_8 (p, width);
           else
             _cogl_bitmap_unpremult_unpacked_span_8 (p, width);
         }
@@ -902,7 +1348,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -939,13 +1385,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
       else
         {
           if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  _cogl_premult_alpha_first (p);
-                  p += 4;
-                }
-            }
+            _cogl_bitmap_premult_alpha_first_span_8 (p, width);
           else
             _cogl_bitmap_premult_unpacked_span_8 (p, width);
         }
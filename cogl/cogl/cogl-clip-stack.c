@@ -49,6 +49,10 @@
 #include "cogl/cogl-matrix-stack.h"
 #include "mtk/mtk.h"
 
+/* How far apart, in window pixels, the corners of a transformed clip
+ * rectangle may be and still be considered axis aligned */
+#define COGL_CLIP_STACK_ALIGNED_EPSILON (1.0f / 1024.0f)
+
 static void *
 _cogl_clip_stack_push_entry (CoglClipStack *clip_stack,
                              size_t size,
@@ -181,17 +185,19 @@ _cogl_clip_stack_push_rectangle (CoglClipStack *stack,
   _cogl_transform_point (&modelview, &projection, viewport, &rect[4], &rect[5]);
   _cogl_transform_point (&modelview, &projection, viewport, &rect[6], &rect[7]);
 
+  memcpy (entry->window_corners, rect, sizeof (rect));
+
   /* If the fully transformed rectangle isn't still axis aligned we
    * can't handle it using a scissor.
    *
-   * We don't use an epsilon here since we only really aim to catch
-   * simple cases where the transform doesn't leave the rectangle screen
-   * aligned and don't mind some false positives.
+   * The epsilon only absorbs the rounding errors of the transform so
+   * that scaled or flipped rectangles still end up as a scissor; it is
+   * far below anything that would move a pixel center across an edge.
    */
-  if (rect[0] != rect[6] ||
-      rect[1] != rect[3] ||
-      rect[2] != rect[4] ||
-      rect[7] != rect[5])
+  if (!G_APPROX_VALUE (rect[0], rect[6], COGL_CLIP_STACK_ALIGNED_EPSILON) ||
+      !G_APPROX_VALUE (rect[1], rect[3], COGL_CLIP_STACK_ALIGNED_EPSILON) ||
+      !G_APPROX_VALUE (rect[2], rect[4], COGL_CLIP_STACK_ALIGNED_EPSILON) ||
+      !G_APPROX_VALUE (rect[7], rect[5], COGL_CLIP_STACK_ALIGNED_EPSILON))
     {
       entry->can_be_scissor = FALSE;
 
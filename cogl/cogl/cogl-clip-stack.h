@@ -136,6 +136,12 @@ struct _CoglClipStackRect
      journal. In that case we can use the original clip coordinates
      and modify the rectangle instead. */
   gboolean can_be_scissor;
+
+  /* The corners of the transformed rectangle in window coordinates,
+     in the same space as the bounds. This lets the flush skip the
+     stencil for rectangles that don't clip anything within the
+     scissor */
+  float window_corners[8];
 };
 
 struct _CoglClipStackPrimitive
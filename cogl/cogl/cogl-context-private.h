@@ -44,13 +44,16 @@
 #include "cogl/cogl-texture-driver.h"
 #include "cogl/cogl-pipeline-cache.h"
 #include "cogl/cogl-texture-2d.h"
+#include "cogl/cogl-pixel-buffer.h"
 #include "cogl/cogl-sampler-cache-private.h"
 #include "cogl/cogl-gl-header.h"
 #include "cogl/cogl-framebuffer-private.h"
 #include "cogl/cogl-offscreen-private.h"
+#include "cogl/cogl-offscreen-pool-private.h"
 #include "cogl/cogl-onscreen-private.h"
 #include "cogl/cogl-fence-private.h"
 #include "cogl/cogl-poll-private.h"
+#include "cogl/cogl-stream-buffer-private.h"
 #include "cogl/cogl-private.h"
 #include "cogl/winsys/cogl-winsys-private.h"
 
@@ -66,6 +69,19 @@ struct _CoglTimestampQuery
   unsigned int id;
 };
 
+typedef struct _CoglGpuTraceSpan
+{
+  const char *name;
+  char *description;
+  int depth;
+
+  /* Converts GPU timestamps to CLOCK_MONOTONIC */
+  int64_t cpu_time_offset_ns;
+
+  CoglTimestampQuery *begin_query;
+  CoglTimestampQuery *end_query;
+} CoglGpuTraceSpan;
+
 struct _CoglContext
 {
   GObject parent_instance;
@@ -133,6 +149,16 @@ struct _CoglContext
 
   CoglPipelineCache *pipeline_cache;
 
+  /* Directory where linked GLSL program binaries are stored, or NULL */
+  char *program_cache_dir;
+
+  /* GPU trace spans waiting for their timestamp queries to complete */
+  GQueue pending_gpu_trace_spans;
+
+  /* Totals since the context was created, see cogl_context_get_draw_counters() */
+  uint64_t n_journal_entries;
+  uint64_t n_draw_calls;
+
   /* Textures */
   CoglTexture *default_gl_texture_2d_tex;
 
@@ -144,6 +170,16 @@ struct _CoglContext
   GArray           *journal_flush_attributes_array;
   GArray           *journal_clip_bounds;
 
+  /* Persistently mapped buffer for streaming vertices, created lazily */
+  CoglStreamBuffer *stream_buffer;
+  gboolean          stream_buffer_unsupported;
+
+  /* Pixel buffer that large texture uploads are staged in */
+  CoglPixelBuffer  *upload_pixel_buffer;
+
+  /* Offscreens released by effects, kept around for reuse */
+  CoglOffscreenPool *offscreen_pool;
+
   /* Some simple caching, to minimize state changes... */
   CoglPipeline     *current_pipeline;
   unsigned long     current_pipeline_changes_since_flush;
@@ -152,6 +188,11 @@ struct _CoglContext
   unsigned long     current_pipeline_age;
 
   gboolean          gl_blend_enable_cache;
+  CoglPipelineBlendState blend_state_cache;
+
+  gboolean          cull_face_enabled_cache;
+  GLenum            cull_face_mode_cache;
+  GLenum            front_face_cache;
 
   gboolean              depth_test_enabled_cache;
   CoglDepthTestFunction depth_test_function_cache;
@@ -161,6 +202,8 @@ struct _CoglContext
 
   CoglBuffer       *current_buffer[COGL_BUFFER_BIND_TARGET_COUNT];
 
+  int               max_texture_size;
+
   /* Framebuffers */
   unsigned long     current_draw_buffer_state_flushed;
   unsigned long     current_draw_buffer_changes;
@@ -311,3 +354,11 @@ _cogl_context_set_current_projection_entry (CoglContext *context,
 void
 _cogl_context_set_current_modelview_entry (CoglContext *context,
                                            CoglMatrixEntry *entry);
+
+void
+_cogl_context_free_gpu_trace_span (CoglContext      *context,
+                                   CoglGpuTraceSpan *span);
+
+void
+_cogl_context_queue_gpu_trace_span (CoglContext      *context,
+                                    CoglGpuTraceSpan *span);
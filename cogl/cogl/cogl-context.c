@@ -45,6 +45,7 @@
 #include "cogl/cogl-onscreen-private.h"
 #include "cogl/cogl-attribute-private.h"
 #include "cogl/cogl1-context.h"
+#include "cogl/cogl-trace.h"
 #include "cogl/winsys/cogl-winsys-private.h"
 
 #include <gio/gio.h>
@@ -73,6 +74,10 @@ cogl_context_dispose (GObject *object)
   const CoglWinsysVtable *winsys = _cogl_context_get_winsys (context);
   const CoglDriverVtable *driver = _cogl_context_get_driver (context);
 
+  g_clear_pointer (&context->stream_buffer, _cogl_stream_buffer_free);
+  g_clear_object (&context->upload_pixel_buffer);
+  g_clear_pointer (&context->offscreen_pool, _cogl_offscreen_pool_free);
+
   winsys->context_deinit (context);
 
   if (context->default_gl_texture_2d_tex)
@@ -134,6 +139,12 @@ cogl_context_dispose (GObject *object)
 
   g_byte_array_free (context->buffer_map_fallback_array, TRUE);
 
+  while (!g_queue_is_empty (&context->pending_gpu_trace_spans))
+    {
+      _cogl_context_free_gpu_trace_span (context,
+                                         g_queue_pop_head (&context->pending_gpu_trace_spans));
+    }
+
   driver->context_deinit (context);
 
   g_object_unref (context->display);
@@ -141,6 +152,8 @@ cogl_context_dispose (GObject *object)
   g_hash_table_remove_all (context->named_pipelines);
   g_hash_table_destroy (context->named_pipelines);
 
+  g_clear_pointer (&context->program_cache_dir, g_free);
+
   G_OBJECT_CLASS (cogl_context_parent_class)->dispose (object);
 }
 
@@ -344,12 +357,28 @@ cogl_context_new (CoglDisplay *display,
 
   context->max_texture_units = -1;
   context->max_activateable_texture_units = -1;
+  context->max_texture_size = -1;
 
   context->current_gl_program = 0;
 
   context->current_gl_dither_enabled = TRUE;
 
   context->gl_blend_enable_cache = FALSE;
+  /* These match the initial state of a GL context */
+  context->blend_state_cache = (CoglPipelineBlendState) {
+    .blend_equation_rgb = GL_FUNC_ADD,
+    .blend_equation_alpha = GL_FUNC_ADD,
+    .blend_src_factor_rgb = GL_ONE,
+    .blend_dst_factor_rgb = GL_ZERO,
+    .blend_src_factor_alpha = GL_ONE,
+    .blend_dst_factor_alpha = GL_ZERO,
+  };
+  cogl_color_init_from_4f (&context->blend_state_cache.blend_constant,
+                           0.0, 0.0, 0.0, 0.0);
+
+  context->cull_face_enabled_cache = FALSE;
+  context->cull_face_mode_cache = GL_BACK;
+  context->front_face_cache = GL_CCW;
 
   context->depth_test_enabled_cache = FALSE;
   context->depth_test_function_cache = COGL_DEPTH_TEST_FUNCTION_LESS;
@@ -359,6 +388,8 @@ cogl_context_new (CoglDisplay *display,
 
   context->pipeline_cache = _cogl_pipeline_cache_new (context);
 
+  context->offscreen_pool = _cogl_offscreen_pool_new ();
+
   for (i = 0; i < COGL_BUFFER_BIND_TARGET_COUNT; i++)
     context->current_buffer[i] = NULL;
 
@@ -506,6 +537,25 @@ cogl_context_get_named_pipeline (CoglContext     *context,
   return g_hash_table_lookup (context->named_pipelines, key);
 }
 
+void
+cogl_context_set_program_cache_dir (CoglContext *context,
+                                    const char  *path)
+{
+  g_return_if_fail (COGL_IS_CONTEXT (context));
+
+  g_free (context->program_cache_dir);
+  context->program_cache_dir = g_strdup (path);
+}
+
+void
+cogl_context_get_draw_counters (CoglContext *context,
+                                uint64_t    *n_journal_entries,
+                                uint64_t    *n_draw_calls)
+{
+  *n_journal_entries = context->n_journal_entries;
+  *n_draw_calls = context->n_draw_calls;
+}
+
 /**
  * cogl_context_free_timestamp_query:
  * @context: a #CoglContext object
@@ -527,6 +577,64 @@ cogl_context_timestamp_query_get_time_ns (CoglContext        *context,
   return context->driver_vtable->timestamp_query_get_time_ns (context, query);
 }
 
+void
+_cogl_context_free_gpu_trace_span (CoglContext      *context,
+                                   CoglGpuTraceSpan *span)
+{
+  if (span->begin_query)
+    cogl_context_free_timestamp_query (context, span->begin_query);
+  if (span->end_query)
+    cogl_context_free_timestamp_query (context, span->end_query);
+  g_free (span->description);
+  g_free (span);
+}
+
+static void
+resolve_gpu_trace_spans (CoglContext *context)
+{
+  const CoglDriverVtable *driver = context->driver_vtable;
+  CoglGpuTraceSpan *span;
+
+  /* Queries complete in submission order, so stop at the first one that
+   * is still pending instead of waiting for it.
+   */
+  while ((span = g_queue_peek_head (&context->pending_gpu_trace_spans)))
+    {
+      int64_t begin_time_ns;
+      int64_t end_time_ns;
+
+      if (!driver->timestamp_query_is_available (context, span->end_query))
+        break;
+
+      g_queue_pop_head (&context->pending_gpu_trace_spans);
+
+      begin_time_ns = driver->timestamp_query_get_time_ns (context,
+                                                           span->begin_query);
+      end_time_ns = driver->timestamp_query_get_time_ns (context,
+                                                         span->end_query);
+
+#ifdef HAVE_PROFILER
+      if (cogl_is_tracing_enabled ())
+        {
+          cogl_trace_add_span (span->name,
+                               span->description,
+                               begin_time_ns + span->cpu_time_offset_ns,
+                               end_time_ns - begin_time_ns);
+        }
+#endif
+
+      _cogl_context_free_gpu_trace_span (context, span);
+    }
+}
+
+void
+_cogl_context_queue_gpu_trace_span (CoglContext      *context,
+                                    CoglGpuTraceSpan *span)
+{
+  g_queue_push_tail (&context->pending_gpu_trace_spans, span);
+  resolve_gpu_trace_spans (context);
+}
+
 int64_t
 cogl_context_get_gpu_time_ns (CoglContext *context)
 {
@@ -536,3 +644,81 @@ cogl_context_get_gpu_time_ns (CoglContext *context)
 
   return context->driver_vtable->get_gpu_time_ns (context);
 }
+
+int
+cogl_context_get_max_texture_size (CoglContext *context)
+{
+  if (!context->driver_vtable->get_max_texture_size)
+    return 0;
+
+  return context->driver_vtable->get_max_texture_size (context);
+}
+
+CoglOffscreen *
+cogl_context_acquire_offscreen (CoglContext      *context,
+                                int               width,
+                                int               height,
+                                CoglPixelFormat   format,
+                                GError          **error)
+{
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  CoglFramebuffer *framebuffer;
+  graphene_matrix_t identity;
+  CoglTexture *texture;
+
+  offscreen = _cogl_offscreen_pool_take (context->offscreen_pool,
+                                         width, height, format);
+  if (offscreen)
+    {
+      framebuffer = COGL_FRAMEBUFFER (offscreen);
+
+      graphene_matrix_init_identity (&identity);
+      cogl_framebuffer_identity_matrix (framebuffer);
+      cogl_framebuffer_set_projection_matrix (framebuffer, &identity);
+      cogl_framebuffer_set_viewport (framebuffer, 0, 0, width, height);
+
+      return g_steal_pointer (&offscreen);
+    }
+
+  if (format == COGL_PIXEL_FORMAT_ANY)
+    texture = cogl_texture_2d_new_with_size (context, width, height);
+  else
+    texture = cogl_texture_2d_new_with_format (context, width, height, format);
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  g_object_unref (texture);
+
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), error))
+    return NULL;
+
+  return g_steal_pointer (&offscreen);
+}
+
+void
+cogl_context_release_offscreen (CoglContext     *context,
+                                CoglOffscreen   *offscreen,
+                                CoglPixelFormat  format)
+{
+  _cogl_offscreen_pool_give (context->offscreen_pool, offscreen, format);
+}
+
+void
+cogl_context_trim_offscreen_pool (CoglContext *context)
+{
+  _cogl_offscreen_pool_trim (context->offscreen_pool, TRUE);
+}
+
+int
+cogl_context_get_latest_sync_fd (CoglContext *context)
+{
+  const CoglWinsysVtable *winsys;
+
+  g_return_val_if_fail (cogl_has_feature (context, COGL_FEATURE_ID_SYNC_FD),
+                        -1);
+
+  winsys = _cogl_context_get_winsys (context);
+  if (!winsys->get_sync_fd)
+    return -1;
+
+  return winsys->get_sync_fd (context);
+}
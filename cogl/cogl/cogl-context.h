@@ -44,6 +44,7 @@ typedef struct _CoglTimestampQuery CoglTimestampQuery;
 
 #include "cogl/cogl-display.h"
 #include "cogl/cogl-pipeline.h"
+#include "cogl/cogl-offscreen.h"
 #include "cogl/cogl-primitive.h"
 
 #include <glib-object.h>
@@ -173,6 +174,10 @@ cogl_context_get_renderer (CoglContext *context);
  *    expected to return age values other than 0.
  * @COGL_FEATURE_ID_BLIT_FRAMEBUFFER: Whether blitting using
  *    cogl_blit_framebuffer() is supported.
+ * @COGL_FEATURE_ID_TIMESTAMP_QUERY: Whether GPU timestamp queries are
+ *    supported.
+ * @COGL_FEATURE_ID_SYNC_FD: Whether cogl_context_get_latest_sync_fd() can
+ *    export the completion of the submitted rendering as a sync file.
  *
  * All the capabilities that can vary between different GPUs supported
  * by Cogl. Applications that depend on any of these features should explicitly
@@ -192,6 +197,7 @@ typedef enum _CoglFeatureID
   COGL_FEATURE_ID_TEXTURE_EGL_IMAGE_EXTERNAL,
   COGL_FEATURE_ID_BLIT_FRAMEBUFFER,
   COGL_FEATURE_ID_TIMESTAMP_QUERY,
+  COGL_FEATURE_ID_SYNC_FD,
 
   /*< private >*/
   _COGL_N_FEATURE_IDS   /*< skip >*/
@@ -342,6 +348,41 @@ COGL_EXPORT CoglPipeline *
 cogl_context_get_named_pipeline (CoglContext     *context,
                                  CoglPipelineKey *key);
 
+/**
+ * cogl_context_set_program_cache_dir:
+ * @context: a #CoglContext pointer
+ * @path: (nullable): a directory to store linked programs in
+ *
+ * Sets a directory where linked GLSL programs are stored when the driver
+ * supports retrieving program binaries. Programs found there are loaded
+ * instead of being linked again, which avoids stalls the first time a
+ * pipeline is used after restarting. Passing %NULL disables the cache.
+ *
+ * The cache is keyed on the shader sources and the driver identity, so
+ * binaries never get reused with a different driver.
+ */
+COGL_EXPORT void
+cogl_context_set_program_cache_dir (CoglContext *context,
+                                    const char  *path);
+
+/**
+ * cogl_context_get_draw_counters:
+ * @context: a #CoglContext pointer
+ * @n_journal_entries: (out): return location for the number of rectangles
+ *   logged into framebuffer journals
+ * @n_draw_calls: (out): return location for the number of draw calls
+ *   submitted to the driver
+ *
+ * Retrieves running totals of the drawing done with @context, meant to
+ * be compared between two points in time. Since journals are batched,
+ * the draw calls are counted when a journal is flushed, not when the
+ * rectangles are logged.
+ */
+COGL_EXPORT void
+cogl_context_get_draw_counters (CoglContext *context,
+                                uint64_t    *n_journal_entries,
+                                uint64_t    *n_draw_calls);
+
 COGL_EXPORT void
 cogl_context_free_timestamp_query (CoglContext        *context,
                                    CoglTimestampQuery *query);
@@ -362,4 +403,80 @@ cogl_context_timestamp_query_get_time_ns (CoglContext        *context,
 COGL_EXPORT int64_t
 cogl_context_get_gpu_time_ns (CoglContext *context);
 
+/**
+ * cogl_context_get_max_texture_size:
+ * @context: a #CoglContext pointer
+ *
+ * Queries the largest width or height a non-sliced texture can have.
+ * Larger textures can only be allocated as #CoglTexture2DSliced.
+ *
+ * Return value: the maximum texture size in pixels, or 0 if unknown
+ */
+COGL_EXPORT int
+cogl_context_get_max_texture_size (CoglContext *context);
+
+/**
+ * cogl_context_acquire_offscreen:
+ * @context: a #CoglContext pointer
+ * @width: width of the offscreen in pixels
+ * @height: height of the offscreen in pixels
+ * @format: the internal format of the texture, or %COGL_PIXEL_FORMAT_ANY
+ * @error: return location for a #GError
+ *
+ * Returns an allocated offscreen framebuffer backed by a 2D texture of
+ * exactly @width by @height pixels, reusing one that was handed back
+ * with cogl_context_release_offscreen() when possible. A reused
+ * offscreen gets an identity modelview and projection and a viewport
+ * covering the whole texture, but the contents are undefined.
+ *
+ * Return value: (transfer full): a #CoglOffscreen, or %NULL on failure
+ */
+COGL_EXPORT CoglOffscreen *
+cogl_context_acquire_offscreen (CoglContext      *context,
+                                int               width,
+                                int               height,
+                                CoglPixelFormat   format,
+                                GError          **error);
+
+/**
+ * cogl_context_release_offscreen:
+ * @context: a #CoglContext pointer
+ * @offscreen: (transfer full): an offscreen from cogl_context_acquire_offscreen()
+ * @format: the format @offscreen was acquired with
+ *
+ * Gives up the caller's reference on @offscreen. If nothing else refers
+ * to the offscreen or its texture any more, it is kept for a while so a
+ * later cogl_context_acquire_offscreen() of the same size can reuse it.
+ */
+COGL_EXPORT void
+cogl_context_release_offscreen (CoglContext     *context,
+                                CoglOffscreen   *offscreen,
+                                CoglPixelFormat  format);
+
+/**
+ * cogl_context_trim_offscreen_pool:
+ * @context: a #CoglContext pointer
+ *
+ * Frees all offscreens kept for reuse by cogl_context_release_offscreen(),
+ * e.g. when the system is low on memory.
+ */
+COGL_EXPORT void
+cogl_context_trim_offscreen_pool (CoglContext *context);
+
+/**
+ * cogl_context_get_latest_sync_fd:
+ * @context: a #CoglContext pointer
+ *
+ * Flushes the rendering submitted so far and returns a sync file
+ * descriptor that signals once the GPU has completed it. The caller owns
+ * the returned file descriptor.
+ *
+ * This function should only be called if the COGL_FEATURE_ID_SYNC_FD
+ * feature is advertised.
+ *
+ * Return value: a sync file descriptor, or -1 on failure
+ */
+COGL_EXPORT int
+cogl_context_get_latest_sync_fd (CoglContext *context);
+
 G_END_DECLS
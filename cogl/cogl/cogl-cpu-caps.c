@@ -64,13 +64,15 @@ cpuid (uint32_t  ax,
        uint32_t *p)
 {
 #ifdef __GCC_ASM_FLAG_OUTPUTS__
+   /* Sub-leaf 0 is selected for the leaves that have them */
    __asm __volatile (
      "cpuid\n\t"
      : "=a" (p[0]),
        "=b" (p[1]),
        "=c" (p[2]),
        "=d" (p[3])
-     : "0" (ax)
+     : "0" (ax),
+       "2" (0)
    );
 #else
    p[0] = 0;
@@ -96,11 +98,24 @@ cogl_init_cpu_caps (void)
 
       cpuid (0x00000001, regs2);
 
+      if ((regs2[2] >> 9) & 1) /* SSSE3 */
+        cogl_cpu_caps |= COGL_CPU_CAP_SSSE3;
+
       has_avx = (((regs2[2] >> 28) & 1) && /* AVX */
                  ((regs2[2] >> 27) & 1) && /* OSXSAVE */
                  ((xgetbv () & 6) == 6));   /* XMM & YMM */
       if (((regs2[2] >> 29) & 1) && has_avx)
         cogl_cpu_caps |= COGL_CPU_CAP_F16C;
+
+      if (regs[0] >= 0x00000007 && has_avx)
+        {
+          uint32_t regs7[4];
+
+          cpuid (0x00000007, regs7);
+
+          if ((regs7[1] >> 5) & 1) /* AVX2 */
+            cogl_cpu_caps |= COGL_CPU_CAP_AVX2;
+        }
     }
 #endif
 }
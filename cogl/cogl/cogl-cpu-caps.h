@@ -38,11 +38,14 @@
 typedef enum _CoglCpuCaps
 {
   COGL_CPU_CAP_F16C = 1 << 0,
+  COGL_CPU_CAP_AVX2 = 1 << 1,
+  COGL_CPU_CAP_SSSE3 = 1 << 2,
 } CoglCpuCaps;
 
 COGL_EXPORT
 CoglCpuCaps cogl_cpu_caps;
 
+COGL_EXPORT_TEST
 void cogl_init_cpu_caps (void);
 
 static inline gboolean
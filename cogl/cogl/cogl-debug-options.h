@@ -135,6 +135,12 @@ OPT (DISABLE_SOFTWARE_CLIP,
      "disable-software-clip",
      N_("Disable software clipping"),
      N_("Disables Cogl's attempts to clip some rectangles in software."))
+OPT (DISABLE_JOURNAL_REORDER,
+     N_("Root Cause"),
+     "disable-journal-reorder",
+     N_("Disable journal reordering"),
+     N_("Disables moving non-overlapping rectangles next to each other "
+        "to improve batching."))
 OPT (SHOW_SOURCE,
      N_("Cogl Tracing"),
      "show-source",
@@ -219,6 +219,14 @@ struct _CoglDriverVtable
                        unsigned int size,
                        GError **error);
 
+  /* Allocates immutable storage for the buffer and maps the whole of
+   * it for writing for the rest of the buffer's lifetime. Writes are
+   * coherent so the caller only needs to make sure the GPU is done
+   * with a range before it is overwritten. Optional. */
+  void *
+  (* buffer_map_persistent) (CoglBuffer *buffer,
+                             GError **error);
+
   void
   (*sampler_init) (CoglContext *context,
                    CoglSamplerCacheEntry *entry);
@@ -243,8 +251,17 @@ struct _CoglDriverVtable
   (* timestamp_query_get_time_ns) (CoglContext *context,
                                    CoglTimestampQuery *query);
 
+  /* Whether the result can be retrieved without blocking */
+  gboolean
+  (* timestamp_query_is_available) (CoglContext *context,
+                                    CoglTimestampQuery *query);
+
   int64_t
   (* get_gpu_time_ns) (CoglContext *context);
+
+  /* Returns the largest width or height a texture can have */
+  int
+  (* get_max_texture_size) (CoglContext *context);
 };
 
 #define COGL_DRIVER_ERROR (_cogl_driver_error_quark ())
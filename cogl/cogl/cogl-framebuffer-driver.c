@@ -29,6 +29,9 @@
 
 #include "cogl/cogl-framebuffer-driver.h"
 
+#include "cogl/cogl-context-private.h"
+#include "cogl/cogl-framebuffer.h"
+
 enum
 {
   PROP_0,
@@ -110,6 +113,11 @@ cogl_framebuffer_driver_draw_attributes (CoglFramebufferDriver  *driver,
                                          int                     n_attributes,
                                          CoglDrawFlags           flags)
 {
+  CoglFramebuffer *framebuffer =
+    cogl_framebuffer_driver_get_framebuffer (driver);
+
+  cogl_framebuffer_get_context (framebuffer)->n_draw_calls++;
+
   COGL_FRAMEBUFFER_DRIVER_GET_CLASS (driver)->draw_attributes (driver,
                                                                pipeline,
                                                                mode,
@@ -133,6 +141,10 @@ cogl_framebuffer_driver_draw_indexed_attributes (CoglFramebufferDriver  *driver,
 {
   CoglFramebufferDriverClass *klass =
     COGL_FRAMEBUFFER_DRIVER_GET_CLASS (driver);
+  CoglFramebuffer *framebuffer =
+    cogl_framebuffer_driver_get_framebuffer (driver);
+
+  cogl_framebuffer_get_context (framebuffer)->n_draw_calls++;
 
   klass->draw_indexed_attributes (driver,
                                   pipeline,
@@ -33,6 +33,8 @@
 
 #include <string.h>
 
+#include "cogl/cogl-attribute-private.h"
+#include "cogl/cogl-bitmap-private.h"
 #include "cogl/cogl-debug.h"
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-display-private.h"
@@ -46,6 +48,7 @@
 #include "cogl/cogl-pipeline-state-private.h"
 #include "cogl/cogl-primitive-private.h"
 #include "cogl/cogl-offscreen.h"
+#include "cogl/cogl-pixel-buffer.h"
 #include "cogl/cogl1-context.h"
 #include "cogl/cogl-private.h"
 #include "cogl/cogl-primitives-private.h"
@@ -142,6 +145,11 @@ typedef struct _CoglFramebufferPrivate
  * usually means it needs to be cleared before being reused next.
  */
   gboolean depth_buffer_clear_needed;
+
+  /* Open GPU trace spans, innermost first, and the nesting depth
+   * including the spans that weren't recorded */
+  GList *gpu_trace_spans;
+  int gpu_trace_depth;
 } CoglFramebufferPrivate;
 
 G_DEFINE_ABSTRACT_TYPE_WITH_PRIVATE (CoglFramebuffer, cogl_framebuffer,
@@ -342,6 +350,13 @@ cogl_framebuffer_dispose (GObject *object)
       _cogl_fence_cancel_fences_for_framebuffer (framebuffer);
     }
 
+  while (priv->gpu_trace_spans)
+    {
+      _cogl_context_free_gpu_trace_span (ctx, priv->gpu_trace_spans->data);
+      priv->gpu_trace_spans = g_list_delete_link (priv->gpu_trace_spans,
+                                                  priv->gpu_trace_spans);
+    }
+
   g_clear_pointer (&priv->clip_stack, _cogl_clip_stack_unref);
   g_clear_object (&priv->modelview_stack);
   g_clear_object (&priv->projection_stack);
@@ -1553,6 +1568,266 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
   return ret;
 }
 
+typedef struct _CoglReadPixelsAsyncData
+{
+  CoglFramebuffer *framebuffer;
+  CoglBitmap *read_bitmap;
+  CoglPixelFormat format;
+} CoglReadPixelsAsyncData;
+
+static void
+read_pixels_async_data_free (CoglReadPixelsAsyncData *data)
+{
+  g_clear_object (&data->read_bitmap);
+  g_clear_object (&data->framebuffer);
+  g_free (data);
+}
+
+static gboolean
+flip_bitmap_in_place (CoglBitmap  *bitmap,
+                      GError     **error)
+{
+  int rowstride = cogl_bitmap_get_rowstride (bitmap);
+  int height = cogl_bitmap_get_height (bitmap);
+  uint8_t *temprow;
+  uint8_t *pixels;
+  int y;
+
+  pixels = _cogl_bitmap_map (bitmap,
+                             COGL_BUFFER_ACCESS_READ |
+                             COGL_BUFFER_ACCESS_WRITE,
+                             0, /* hints */
+                             error);
+  if (pixels == NULL)
+    return FALSE;
+
+  temprow = g_alloca (rowstride);
+
+  for (y = 0; y < height / 2; y++)
+    {
+      memcpy (temprow, pixels + y * rowstride, rowstride);
+      memcpy (pixels + y * rowstride,
+              pixels + (height - y - 1) * rowstride, rowstride);
+      memcpy (pixels + (height - y - 1) * rowstride, temprow, rowstride);
+    }
+
+  _cogl_bitmap_unmap (bitmap);
+
+  return TRUE;
+}
+
+static void
+complete_read_pixels_async (GTask *task)
+{
+  CoglReadPixelsAsyncData *data = g_task_get_task_data (task);
+  CoglFramebuffer *framebuffer = data->framebuffer;
+  CoglContext *context = cogl_framebuffer_get_context (framebuffer);
+  CoglPixelFormat internal_format =
+    cogl_framebuffer_get_internal_format (framebuffer);
+  CoglPixelFormat read_format = cogl_bitmap_get_format (data->read_bitmap);
+  int width = cogl_bitmap_get_width (data->read_bitmap);
+  int height = cogl_bitmap_get_height (data->read_bitmap);
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  GError *error = NULL;
+  gboolean succeeded;
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  bitmap = _cogl_bitmap_new_with_malloc_buffer (context,
+                                                width, height,
+                                                data->format,
+                                                &error);
+  if (!bitmap)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* Mapping the pixel buffer here is what actually waits for the
+   * transfer, but by now the fence has told us that the GPU is done
+   * with it. Without an alpha channel there is nothing to premultiply
+   * so the premult bits are dropped like the synchronous path does. */
+  if (!(internal_format & COGL_A_BIT))
+    {
+      _cogl_bitmap_set_format (data->read_bitmap,
+                               read_format & ~COGL_PREMULT_BIT);
+      _cogl_bitmap_set_format (bitmap, data->format & ~COGL_PREMULT_BIT);
+    }
+
+  succeeded = _cogl_bitmap_convert_into_bitmap (data->read_bitmap,
+                                                bitmap,
+                                                &error);
+
+  _cogl_bitmap_set_format (bitmap, data->format);
+
+  /* The read was done in OpenGL's bottom-up row order */
+  if (succeeded && !cogl_framebuffer_is_y_flipped (framebuffer))
+    succeeded = flip_bitmap_in_place (bitmap, &error);
+
+  if (!succeeded)
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_pointer (task, g_steal_pointer (&bitmap), g_object_unref);
+}
+
+static void
+read_pixels_fence_cb (CoglFence *fence,
+                      void      *user_data)
+{
+  g_autoptr (GTask) task = user_data;
+
+  complete_read_pixels_async (task);
+}
+
+static void
+read_pixels_sync (GTask           *task,
+                  CoglFramebuffer *framebuffer,
+                  int              x,
+                  int              y,
+                  int              width,
+                  int              height,
+                  CoglPixelFormat  format)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  GError *error = NULL;
+
+  bitmap = _cogl_bitmap_new_with_malloc_buffer (priv->context,
+                                                width, height,
+                                                format,
+                                                &error);
+  if (!bitmap ||
+      !_cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  x, y,
+                                                  COGL_READ_PIXELS_COLOR_BUFFER,
+                                                  bitmap,
+                                                  &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  g_task_return_pointer (task, g_steal_pointer (&bitmap), g_object_unref);
+}
+
+void
+cogl_framebuffer_read_pixels_async (CoglFramebuffer     *framebuffer,
+                                    int                  x,
+                                    int                  y,
+                                    int                  width,
+                                    int                  height,
+                                    CoglPixelFormat      format,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+  CoglContext *ctx = priv->context;
+  g_autoptr (GTask) task = NULL;
+  g_autoptr (CoglPixelBuffer) pixel_buffer = NULL;
+  CoglReadPixelsAsyncData *data;
+  CoglPixelFormat internal_format;
+  CoglPixelFormat read_format;
+  GLenum gl_format;
+  GLenum gl_type;
+  GError *error = NULL;
+  int rowstride;
+
+  g_return_if_fail (cogl_is_framebuffer (framebuffer));
+  g_return_if_fail (cogl_pixel_format_get_n_planes (format) == 1);
+
+  task = g_task_new (framebuffer, cancellable, callback, user_data);
+  g_task_set_source_tag (task, cogl_framebuffer_read_pixels_async);
+
+  if (!cogl_framebuffer_allocate (framebuffer, &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* Without pixel buffers or fences there is nothing to wait on, so
+   * fall back to a blocking read but still report it asynchronously */
+  if (!_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_PBOS) ||
+      !cogl_has_feature (ctx, COGL_FEATURE_ID_FENCE))
+    {
+      read_pixels_sync (task, framebuffer, x, y, width, height, format);
+      return;
+    }
+
+  /* Read in the format the driver would read in anyway, with the
+   * premult state of the framebuffer and a tightly packed rowstride.
+   * Otherwise the driver would go through a temporary buffer and
+   * convert it on the CPU straight away, which is the stall we are
+   * trying to avoid. */
+  internal_format = cogl_framebuffer_get_internal_format (framebuffer);
+  read_format = ctx->driver_vtable->get_read_pixels_format (ctx,
+                                                            internal_format,
+                                                            format,
+                                                            &gl_format,
+                                                            &gl_type);
+  if (COGL_PIXEL_FORMAT_CAN_HAVE_PREMULT (read_format))
+    read_format = ((read_format & ~COGL_PREMULT_BIT) |
+                   (internal_format & COGL_PREMULT_BIT));
+
+  rowstride = cogl_pixel_format_get_bytes_per_pixel (read_format, 0) * width;
+  pixel_buffer = cogl_pixel_buffer_new (ctx, rowstride * height, NULL);
+
+  data = g_new0 (CoglReadPixelsAsyncData, 1);
+  data->framebuffer = g_object_ref (framebuffer);
+  data->read_bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (pixel_buffer),
+                                                   read_format,
+                                                   width, height,
+                                                   rowstride,
+                                                   0);
+  data->format = format;
+  g_task_set_task_data (task, data,
+                        (GDestroyNotify) read_pixels_async_data_free);
+
+  /* With the bitmap backed by a pixel buffer glReadPixels only queues
+   * the transfer. Skip flipping, which would need to map the buffer
+   * straight away, and flip once the data arrives instead. */
+  if (!_cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                  x, y,
+                                                  COGL_READ_PIXELS_COLOR_BUFFER |
+                                                  COGL_READ_PIXELS_NO_FLIP,
+                                                  data->read_bitmap,
+                                                  &error))
+    {
+      g_task_return_error (task, error);
+      return;
+    }
+
+  /* The task data keeps the framebuffer alive, so the fence can't be
+   * cancelled by the framebuffer being disposed under it */
+  if (cogl_framebuffer_add_fence_callback (framebuffer,
+                                           read_pixels_fence_cb,
+                                           task))
+    {
+      g_steal_pointer (&task);
+      return;
+    }
+
+  complete_read_pixels_async (task);
+}
+
+CoglBitmap *
+cogl_framebuffer_read_pixels_finish (CoglFramebuffer  *framebuffer,
+                                     GAsyncResult     *result,
+                                     GError          **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, framebuffer), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) ==
+                        cogl_framebuffer_read_pixels_async, NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 gboolean
 cogl_framebuffer_is_y_flipped (CoglFramebuffer *framebuffer)
 {
@@ -2453,6 +2728,21 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
     }
 }
 
+void
+cogl_framebuffer_precompile_pipelines (CoglFramebuffer  *framebuffer,
+                                       CoglPipeline    **pipelines,
+                                       int               n_pipelines)
+{
+  int i;
+
+  g_return_if_fail (COGL_IS_FRAMEBUFFER (framebuffer));
+
+  /* Flushing the pipeline state is what triggers code generation and
+   * linking; with no attributes nothing gets drawn. */
+  for (i = 0; i < n_pipelines; i++)
+    _cogl_flush_attributes_state (framebuffer, pipelines[i], 0, NULL, 0);
+}
+
 void
 cogl_framebuffer_draw_rectangle (CoglFramebuffer *framebuffer,
                                  CoglPipeline *pipeline,
@@ -2629,3 +2919,55 @@ cogl_framebuffer_create_timestamp_query (CoglFramebuffer *framebuffer)
 
   return driver_vtable->create_timestamp_query (priv->context);
 }
+
+void
+cogl_framebuffer_push_gpu_trace (CoglFramebuffer *framebuffer,
+                                 const char      *name,
+                                 const char      *description)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+#ifdef HAVE_PROFILER
+  CoglContext *context = priv->context;
+
+  if (cogl_is_tracing_enabled () &&
+      cogl_has_feature (context, COGL_FEATURE_ID_TIMESTAMP_QUERY))
+    {
+      CoglGpuTraceSpan *span;
+
+      span = g_new0 (CoglGpuTraceSpan, 1);
+      span->name = name;
+      span->description = g_strdup (description);
+      span->depth = priv->gpu_trace_depth;
+      span->begin_query = cogl_framebuffer_create_timestamp_query (framebuffer);
+      span->cpu_time_offset_ns = (g_get_monotonic_time () * 1000 -
+                                  cogl_context_get_gpu_time_ns (context));
+
+      priv->gpu_trace_spans = g_list_prepend (priv->gpu_trace_spans, span);
+    }
+#endif
+
+  priv->gpu_trace_depth++;
+}
+
+void
+cogl_framebuffer_pop_gpu_trace (CoglFramebuffer *framebuffer)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+  CoglGpuTraceSpan *span;
+
+  g_return_if_fail (priv->gpu_trace_depth > 0);
+
+  priv->gpu_trace_depth--;
+
+  span = priv->gpu_trace_spans ? priv->gpu_trace_spans->data : NULL;
+  if (!span || span->depth != priv->gpu_trace_depth)
+    return;
+
+  priv->gpu_trace_spans = g_list_delete_link (priv->gpu_trace_spans,
+                                              priv->gpu_trace_spans);
+
+  span->end_query = cogl_framebuffer_create_timestamp_query (framebuffer);
+  _cogl_context_queue_gpu_trace_span (priv->context, span);
+}
@@ -40,6 +40,7 @@
 #include "cogl/cogl-texture.h"
 #include "mtk/mtk.h"
 
+#include <gio/gio.h>
 #include <glib-object.h>
 
 #include <graphene.h>
@@ -906,6 +907,22 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
                           float blue,
                           float alpha);
 
+/**
+ * cogl_framebuffer_precompile_pipelines:
+ * @framebuffer: A destination #CoglFramebuffer
+ * @pipelines: (array length=n_pipelines): the pipelines to prepare
+ * @n_pipelines: the number of pipelines
+ *
+ * Generates, compiles and links the programs needed to draw with each of
+ * @pipelines on @framebuffer without drawing anything. This can be used to
+ * move the cost of building shaders to a point where a stall is not
+ * noticeable, for example before starting an animation.
+ */
+COGL_EXPORT void
+cogl_framebuffer_precompile_pipelines (CoglFramebuffer  *framebuffer,
+                                       CoglPipeline    **pipelines,
+                                       int               n_pipelines);
+
 /**
  * cogl_framebuffer_draw_rectangle:
  * @framebuffer: A destination #CoglFramebuffer
@@ -1266,6 +1283,58 @@ cogl_framebuffer_read_pixels (CoglFramebuffer *framebuffer,
                               CoglPixelFormat format,
                               uint8_t *pixels);
 
+/**
+ * cogl_framebuffer_read_pixels_async:
+ * @framebuffer: A #CoglFramebuffer
+ * @x: The x position to read from
+ * @y: The y position to read from
+ * @width: The width of the region of rectangles to read
+ * @height: The height of the region of rectangles to read
+ * @format: The pixel format to store the data in
+ * @cancellable: (nullable): A #GCancellable
+ * @callback: (scope async): Called when the pixels are available
+ * @user_data: (closure): Data passed to @callback
+ *
+ * Starts reading a rectangle of pixels from the color buffer of
+ * @framebuffer without waiting for the GPU to finish rendering.
+ *
+ * When pixel buffers and fences are supported the pixels are
+ * transferred into a pixel buffer and @callback is only called once
+ * the GPU is done with it, so the CPU never blocks on the read.
+ * Otherwise this falls back to the same blocking read as
+ * cogl_framebuffer_read_pixels_into_bitmap().
+ *
+ * Nothing rendered to @framebuffer after this call is part of the
+ * result. Call cogl_framebuffer_read_pixels_finish() from @callback
+ * to get the pixels.
+ */
+COGL_EXPORT void
+cogl_framebuffer_read_pixels_async (CoglFramebuffer     *framebuffer,
+                                    int                  x,
+                                    int                  y,
+                                    int                  width,
+                                    int                  height,
+                                    CoglPixelFormat      format,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data);
+
+/**
+ * cogl_framebuffer_read_pixels_finish:
+ * @framebuffer: A #CoglFramebuffer
+ * @result: The #GAsyncResult passed to the callback
+ * @error: Return location for a #GError
+ *
+ * Finishes a read started with cogl_framebuffer_read_pixels_async().
+ *
+ * Return value: (transfer full): A #CoglBitmap in the requested
+ *   format with (0, 0) as its top left pixel, or %NULL on error.
+ */
+COGL_EXPORT CoglBitmap *
+cogl_framebuffer_read_pixels_finish (CoglFramebuffer  *framebuffer,
+                                     GAsyncResult     *result,
+                                     GError          **error);
+
 COGL_EXPORT uint32_t
 cogl_framebuffer_error_quark (void);
 
@@ -1381,4 +1450,33 @@ cogl_framebuffer_flush (CoglFramebuffer *framebuffer);
 COGL_EXPORT CoglTimestampQuery *
 cogl_framebuffer_create_timestamp_query (CoglFramebuffer *framebuffer);
 
+/**
+ * cogl_framebuffer_push_gpu_trace: (skip)
+ * @framebuffer: A #CoglFramebuffer
+ * @name: Name of the span, must be a static string
+ * @description: (nullable): Description of the span
+ *
+ * Starts measuring the GPU time of the rendering submitted to @framebuffer
+ * until the matching cogl_framebuffer_pop_gpu_trace(). Once the GPU is done
+ * with it, the span is added to the trace of the calling thread, without
+ * ever waiting for the GPU.
+ *
+ * Nothing is measured unless tracing is enabled on the calling thread and
+ * the COGL_FEATURE_ID_TIMESTAMP_QUERY feature is advertised. Since it
+ * flushes the journal, it should only be used around whole passes.
+ */
+COGL_EXPORT void
+cogl_framebuffer_push_gpu_trace (CoglFramebuffer *framebuffer,
+                                 const char      *name,
+                                 const char      *description);
+
+/**
+ * cogl_framebuffer_pop_gpu_trace: (skip)
+ * @framebuffer: A #CoglFramebuffer
+ *
+ * Ends the span started by the last cogl_framebuffer_push_gpu_trace().
+ */
+COGL_EXPORT void
+cogl_framebuffer_pop_gpu_trace (CoglFramebuffer *framebuffer);
+
 G_END_DECLS
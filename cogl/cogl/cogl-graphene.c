@@ -27,6 +27,22 @@
  */
 
 #include "cogl/cogl-graphene.h"
+#include "cogl/cogl-cpu-caps.h"
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#define HAVE_SSE2_KERNELS 1
+#endif
+
+#if defined (HAVE_SSE2_KERNELS) && defined (__x86_64) && defined (__GNUC__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS 1
+#endif
+
+#if defined (__ARM_NEON)
+#include <arm_neon.h>
+#define HAVE_NEON_KERNELS 1
+#endif
 
 typedef struct _Point2f
 {
@@ -63,6 +79,156 @@ init_matrix_rows (const graphene_matrix_t *matrix,
     graphene_matrix_get_row (&m, i, &rows[i]);
 }
 
+/* The vectorized kernels below transform a point as the sum of the
+ * matrix rows scaled by its components, so each point costs a couple
+ * of multiplies and adds instead of three dot products. Only the two
+ * component variant is specialized since that is what the journal uses
+ * to transform every quad it logs. */
+
+#if defined (HAVE_SSE2_KERNELS) || defined (HAVE_NEON_KERNELS)
+static void
+get_matrix_rows (const graphene_matrix_t *matrix,
+                 float                    rows[4][4])
+{
+  unsigned int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      graphene_vec4_t row;
+
+      graphene_matrix_get_row (matrix, i, &row);
+      graphene_vec4_to_float (&row, rows[i]);
+    }
+}
+#endif
+
+#ifdef HAVE_SSE2_KERNELS
+static inline void
+store_point3f_sse2 (float  *o,
+                    __m128  v)
+{
+  /* The output may be interleaved with other vertex data so only the
+   * three components can be written */
+  _mm_storel_pi ((__m64 *) o, v);
+  _mm_store_ss (o + 2, _mm_movehl_ps (v, v));
+}
+
+static inline __m128
+transform_point_f2_sse2 (__m128       r0,
+                         __m128       r1,
+                         __m128       r3,
+                         const float *p)
+{
+  return _mm_add_ps (_mm_add_ps (_mm_mul_ps (r0, _mm_set1_ps (p[0])),
+                                 _mm_mul_ps (r1, _mm_set1_ps (p[1]))),
+                     r3);
+}
+
+static void
+transform_points_f2_sse2 (const float  rows[4][4],
+                          size_t       stride_in,
+                          const void  *points_in,
+                          size_t       stride_out,
+                          void        *points_out,
+                          int          n_points)
+{
+  __m128 r0 = _mm_loadu_ps (rows[0]);
+  __m128 r1 = _mm_loadu_ps (rows[1]);
+  __m128 r3 = _mm_loadu_ps (rows[3]);
+  int i;
+
+  for (i = 0; i < n_points; i++)
+    {
+      const float *p = (const float *)((const uint8_t *)points_in +
+                                       i * stride_in);
+      float *o = (float *)((uint8_t *)points_out + i * stride_out);
+
+      store_point3f_sse2 (o, transform_point_f2_sse2 (r0, r1, r3, p));
+    }
+}
+#endif
+
+#ifdef HAVE_AVX2_KERNELS
+__attribute__ ((target ("avx2")))
+static void
+transform_points_f2_avx2 (const float  rows[4][4],
+                          size_t       stride_in,
+                          const void  *points_in,
+                          size_t       stride_out,
+                          void        *points_out,
+                          int          n_points)
+{
+  __m256 r0 = _mm256_broadcast_ps ((const __m128 *) rows[0]);
+  __m256 r1 = _mm256_broadcast_ps ((const __m128 *) rows[1]);
+  __m256 r3 = _mm256_broadcast_ps ((const __m128 *) rows[3]);
+  int i;
+
+  /* Two points per iteration, one in each lane. Both are loaded before
+   * anything is stored so that transforming in place works */
+  for (i = 0; i + 1 < n_points; i += 2)
+    {
+      const float *p0 = (const float *)((const uint8_t *)points_in +
+                                        i * stride_in);
+      const float *p1 = (const float *)((const uint8_t *)points_in +
+                                        (i + 1) * stride_in);
+      float *o0 = (float *)((uint8_t *)points_out + i * stride_out);
+      float *o1 = (float *)((uint8_t *)points_out + (i + 1) * stride_out);
+      __m256 x, y, v;
+
+      x = _mm256_setr_m128 (_mm_set1_ps (p0[0]), _mm_set1_ps (p1[0]));
+      y = _mm256_setr_m128 (_mm_set1_ps (p0[1]), _mm_set1_ps (p1[1]));
+      v = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (r0, x),
+                                        _mm256_mul_ps (r1, y)),
+                         r3);
+
+      store_point3f_sse2 (o0, _mm256_castps256_ps128 (v));
+      store_point3f_sse2 (o1, _mm256_extractf128_ps (v, 1));
+    }
+
+  if (i < n_points)
+    {
+      const float *p = (const float *)((const uint8_t *)points_in +
+                                       i * stride_in);
+      float *o = (float *)((uint8_t *)points_out + i * stride_out);
+
+      store_point3f_sse2 (o,
+                          transform_point_f2_sse2 (_mm256_castps256_ps128 (r0),
+                                                   _mm256_castps256_ps128 (r1),
+                                                   _mm256_castps256_ps128 (r3),
+                                                   p));
+    }
+}
+#endif
+
+#ifdef HAVE_NEON_KERNELS
+static void
+transform_points_f2_neon (const float  rows[4][4],
+                          size_t       stride_in,
+                          const void  *points_in,
+                          size_t       stride_out,
+                          void        *points_out,
+                          int          n_points)
+{
+  float32x4_t r0 = vld1q_f32 (rows[0]);
+  float32x4_t r1 = vld1q_f32 (rows[1]);
+  float32x4_t r3 = vld1q_f32 (rows[3]);
+  int i;
+
+  for (i = 0; i < n_points; i++)
+    {
+      const float *p = (const float *)((const uint8_t *)points_in +
+                                       i * stride_in);
+      float *o = (float *)((uint8_t *)points_out + i * stride_out);
+      float32x4_t v;
+
+      v = vmlaq_n_f32 (vmlaq_n_f32 (r3, r0, p[0]), r1, p[1]);
+
+      vst1_f32 (o, vget_low_f32 (v));
+      vst1q_lane_f32 (o + 2, v, 2);
+    }
+}
+#endif
+
 static void
 transform_points_f2 (const graphene_matrix_t *matrix,
                      size_t                   stride_in,
@@ -74,6 +240,38 @@ transform_points_f2 (const graphene_matrix_t *matrix,
   graphene_vec4_t rows[3];
   int i;
 
+#if defined (HAVE_SSE2_KERNELS) || defined (HAVE_NEON_KERNELS)
+  {
+    float matrix_rows[4][4];
+
+    get_matrix_rows (matrix, matrix_rows);
+
+#ifdef HAVE_AVX2_KERNELS
+    if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+      {
+        transform_points_f2_avx2 (matrix_rows,
+                                  stride_in, points_in,
+                                  stride_out, points_out,
+                                  n_points);
+        return;
+      }
+#endif
+
+#ifdef HAVE_SSE2_KERNELS
+    transform_points_f2_sse2 (matrix_rows,
+                              stride_in, points_in,
+                              stride_out, points_out,
+                              n_points);
+#else
+    transform_points_f2_neon (matrix_rows,
+                              stride_in, points_in,
+                              stride_out, points_out,
+                              n_points);
+#endif
+    return;
+  }
+#endif
+
   init_matrix_rows (matrix, G_N_ELEMENTS (rows), rows);
 
   for (i = 0; i < n_points; i++)
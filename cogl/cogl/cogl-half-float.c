@@ -269,3 +269,90 @@ uint16_t cogl_uint16_div_64k_to_half (uint16_t v)
 
   return (e << 10) | m;
 }
+
+#ifdef __x86_64
+__attribute__ ((target ("avx,f16c")))
+static void
+cogl_half_to_float_n_f16c (const uint16_t *src,
+                           float          *dst,
+                           int             n)
+{
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      __m128i in = _mm_loadu_si128 ((const __m128i *) (src + i));
+
+      _mm256_storeu_ps (dst + i, _mm256_cvtph_ps (in));
+    }
+
+  for (; i < n; i++)
+    dst[i] = cogl_half_to_float (src[i]);
+}
+
+__attribute__ ((target ("avx,f16c")))
+static void
+cogl_float_to_half_n_f16c (const float *src,
+                           uint16_t    *dst,
+                           int          n)
+{
+  int i;
+
+  for (i = 0; i + 8 <= n; i += 8)
+    {
+      __m256 in = _mm256_loadu_ps (src + i);
+
+      /* 0 = round to nearest, like cogl_float_to_half() */
+      _mm_storeu_si128 ((__m128i *) (dst + i), _mm256_cvtps_ph (in, 0));
+    }
+
+  for (; i < n; i++)
+    dst[i] = cogl_float_to_half (src[i]);
+}
+#endif
+
+/**
+ * Converts @n half floats to floats, eight at a time when the CPU
+ * supports F16C.
+ */
+void
+cogl_half_to_float_n (const uint16_t *src,
+                      float          *dst,
+                      int             n)
+{
+  int i;
+
+#ifdef __x86_64
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_F16C))
+    {
+      cogl_half_to_float_n_f16c (src, dst, n);
+      return;
+    }
+#endif
+
+  for (i = 0; i < n; i++)
+    dst[i] = cogl_half_to_float_slow (src[i]);
+}
+
+/**
+ * Converts @n floats to half floats rounding to nearest, eight at a
+ * time when the CPU supports F16C.
+ */
+void
+cogl_float_to_half_n (const float *src,
+                      uint16_t    *dst,
+                      int          n)
+{
+  int i;
+
+#ifdef __x86_64
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_F16C))
+    {
+      cogl_float_to_half_n_f16c (src, dst, n);
+      return;
+    }
+#endif
+
+  for (i = 0; i < n; i++)
+    dst[i] = cogl_float_to_half_slow (src[i]);
+}
@@ -56,6 +56,16 @@ uint16_t cogl_uint16_div_64k_to_half (uint16_t v);
 COGL_EXPORT
 uint16_t cogl_float_to_float16_rtz_slow (float val);
 
+COGL_EXPORT
+void cogl_half_to_float_n (const uint16_t *src,
+                           float          *dst,
+                           int             n);
+
+COGL_EXPORT
+void cogl_float_to_half_n (const float *src,
+                           uint16_t    *dst,
+                           int          n);
+
 static inline uint16_t
 cogl_float_to_half (float val)
 {
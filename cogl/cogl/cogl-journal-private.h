@@ -52,6 +52,11 @@ typedef struct _CoglJournal
   GArray *vertices;
   size_t needed_vbo_len;
 
+  /* Scratch arrays used when reordering the entries at flush time.
+     They are kept around to avoid reallocating them for every flush */
+  GArray *reordered_entries;
+  GArray *entry_bounds;
+
   /* A pool of attribute buffers is used so that we can avoid repeatedly
      reallocating buffers. Only one of these buffers at a time will be
      used by Cogl but we keep more than one alive anyway in case the
@@ -117,6 +117,18 @@ typedef struct _CoglJournalFlushState
   CoglPipeline *pipeline;
 } CoglJournalFlushState;
 
+/* Eye space bounds of a journal entry, used to check whether entries
+ * can be reordered without changing the result */
+typedef struct _EntryBounds
+{
+  float x_1, y_1;
+  float x_2, y_2;
+  float z;
+  /* FALSE if the quad isn't parallel to the screen, in which case
+   * nothing may be moved across it */
+  gboolean flat;
+} EntryBounds;
+
 typedef void (*CoglJournalBatchCallback) (CoglJournalEntry *start,
                                           int n_entries,
                                           void *data);
@@ -135,6 +147,10 @@ cogl_journal_dispose (GObject *object)
     g_array_free (journal->entries, TRUE);
   if (journal->vertices)
     g_array_free (journal->vertices, TRUE);
+  if (journal->reordered_entries)
+    g_array_free (journal->reordered_entries, TRUE);
+  if (journal->entry_bounds)
+    g_array_free (journal->entry_bounds, TRUE);
 
   for (i = 0; i < COGL_JOURNAL_VBO_POOL_SIZE; i++)
     if (journal->vbo_pool[i])
@@ -164,6 +180,9 @@ _cogl_journal_new (CoglFramebuffer *framebuffer)
   journal->framebuffer = framebuffer;
   journal->entries = g_array_new (FALSE, FALSE, sizeof (CoglJournalEntry));
   journal->vertices = g_array_new (FALSE, FALSE, sizeof (float));
+  journal->reordered_entries =
+    g_array_new (FALSE, FALSE, sizeof (CoglJournalEntry));
+  journal->entry_bounds = g_array_new (FALSE, FALSE, sizeof (EntryBounds));
 
   _cogl_list_init (&journal->pending_fences);
 
@@ -1126,6 +1145,282 @@ compare_entry_viewports (CoglJournalEntry *entry0, CoglJournalEntry *entry1)
   return memcmp (entry0->viewport, entry1->viewport, sizeof (float) * 4) == 0;
 }
 
+/* Don't look further ahead than this for entries to pull forward so
+ * that reordering stays cheap for long journals */
+#define REORDER_WINDOW 32
+
+static gboolean
+compare_entries_for_reorder (CoglJournalEntry *entry0,
+                             CoglJournalEntry *entry1,
+                             unsigned long     layer_differences)
+{
+  /* Only pull an entry forward if it would end up in the same batch at
+   * every level, otherwise moving it gains nothing */
+  if (!compare_entry_viewports (entry0, entry1) ||
+      !compare_entry_dither_states (entry0, entry1) ||
+      !compare_entry_clip_stacks (entry0, entry1) ||
+      !compare_entry_strides (entry0, entry1))
+    return FALSE;
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)) &&
+      !compare_entry_modelviews (entry0, entry1))
+    return FALSE;
+
+  if (entry0->pipeline == entry1->pipeline)
+    return TRUE;
+
+  return (compare_entry_layer_numbers (entry0, entry1) &&
+          _cogl_pipeline_equal (entry0->pipeline,
+                                entry1->pipeline,
+                                (COGL_PIPELINE_STATE_ALL &
+                                 ~COGL_PIPELINE_STATE_COLOR),
+                                layer_differences));
+}
+
+static void
+get_entry_bounds (CoglJournal             *journal,
+                  const CoglJournalEntry  *entry,
+                  const graphene_matrix_t *modelview,
+                  EntryBounds             *bounds)
+{
+  size_t stride = GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+  const float *v = &g_array_index (journal->vertices, float,
+                                   entry->array_offset + 1);
+  float corners[8];
+  float eye[12];
+  int i;
+
+  corners[0] = v[0];
+  corners[1] = v[1];
+  corners[2] = v[0];
+  corners[3] = v[stride + 1];
+  corners[4] = v[stride];
+  corners[5] = v[stride + 1];
+  corners[6] = v[stride];
+  corners[7] = v[1];
+
+  cogl_graphene_matrix_transform_points (modelview,
+                                         2, /* n_components */
+                                         sizeof (float) * 2, /* stride_in */
+                                         corners, /* points_in */
+                                         sizeof (float) * 3, /* stride_out */
+                                         eye, /* points_out */
+                                         4 /* n_points */);
+
+  bounds->x_1 = bounds->x_2 = eye[0];
+  bounds->y_1 = bounds->y_2 = eye[1];
+  bounds->z = eye[2];
+  bounds->flat = TRUE;
+
+  for (i = 1; i < 4; i++)
+    {
+      bounds->x_1 = MIN (bounds->x_1, eye[i * 3]);
+      bounds->y_1 = MIN (bounds->y_1, eye[i * 3 + 1]);
+      bounds->x_2 = MAX (bounds->x_2, eye[i * 3]);
+      bounds->y_2 = MAX (bounds->y_2, eye[i * 3 + 1]);
+
+      if (!G_APPROX_VALUE (eye[i * 3 + 2], bounds->z, FLT_EPSILON))
+        bounds->flat = FALSE;
+    }
+}
+
+static gboolean
+entries_may_overlap (const CoglJournalEntry *entry0,
+                     const EntryBounds      *bounds0,
+                     const CoglJournalEntry *entry1,
+                     const EntryBounds      *bounds1)
+{
+  /* All entries share the projection, so quads in the same plane
+   * parallel to the screen that don't overlap in eye space don't
+   * overlap on screen either, as long as they use the same viewport */
+  if (!bounds0->flat || !bounds1->flat ||
+      bounds0->z != bounds1->z ||
+      !compare_entry_viewports ((CoglJournalEntry *) entry0,
+                                (CoglJournalEntry *) entry1))
+    return TRUE;
+
+  return (bounds0->x_1 < bounds1->x_2 && bounds1->x_1 < bounds0->x_2 &&
+          bounds0->y_1 < bounds1->y_2 && bounds1->y_1 < bounds0->y_2);
+}
+
+/* Entries with different textures can't be drawn in one batch, but
+ * when everything else about their pipelines matches, switching from
+ * one to the other only needs the textures to be rebound. This looks
+ * for such an entry to start the next batch with, instead of
+ * first_unused, so that for example window textures in an overview get
+ * drawn one after another rather than interleaved with their
+ * decorations. */
+static int
+find_next_batch_start (CoglJournalEntry *entries,
+                       EntryBounds      *bounds,
+                       const gboolean   *used,
+                       int               n_entries,
+                       int               first_unused,
+                       CoglJournalEntry *last)
+{
+  unsigned long layer_differences =
+    COGL_PIPELINE_LAYER_STATE_ALL & ~COGL_PIPELINE_LAYER_STATE_TEXTURE_DATA;
+  int j, k;
+
+  if (compare_entries_for_reorder (last, &entries[first_unused],
+                                   layer_differences))
+    return first_unused;
+
+  for (j = first_unused + 1;
+       j < n_entries && j <= first_unused + REORDER_WINDOW;
+       j++)
+    {
+      gboolean can_move = TRUE;
+
+      /* An entry that isn't parallel to the screen can't be moved
+       * across, and nothing after it can be either */
+      if (!bounds[j - 1].flat && !used[j - 1])
+        break;
+
+      if (used[j])
+        continue;
+
+      if (!compare_entries_for_reorder (last, &entries[j],
+                                        layer_differences))
+        continue;
+
+      for (k = first_unused; can_move && k < j; k++)
+        {
+          if (!used[k] &&
+              entries_may_overlap (&entries[j], &bounds[j],
+                                   &entries[k], &bounds[k]))
+            can_move = FALSE;
+        }
+
+      if (can_move)
+        return j;
+    }
+
+  return first_unused;
+}
+
+/* Interleaved drawing, like text on top of backgrounds, means that
+ * consecutive entries rarely share a pipeline even though many of them
+ * could be drawn together. This moves entries forward next to an
+ * earlier entry they could be batched with, as long as they don't
+ * overlap any of the entries they are moved in front of, so the result
+ * is the same as drawing everything in the original order. */
+static void
+reorder_entries (CoglJournal *journal)
+{
+  CoglJournalEntry *entries = (CoglJournalEntry *) journal->entries->data;
+  int n_entries = journal->entries->len;
+  CoglMatrixEntry *last_modelview_entry = NULL;
+  graphene_matrix_t modelview;
+  EntryBounds *bounds;
+  g_autofree gboolean *used = NULL;
+  CoglJournalEntry *last = NULL;
+  int skipped[REORDER_WINDOW * 2 + 1];
+  int first_unused = 0;
+  GArray *tmp;
+  gboolean moved_any = FALSE;
+  int i, j;
+
+  if (n_entries < 3)
+    return;
+
+  g_array_set_size (journal->entry_bounds, n_entries);
+  bounds = (EntryBounds *) journal->entry_bounds->data;
+
+  for (i = 0; i < n_entries; i++)
+    {
+      if (entries[i].modelview_entry != last_modelview_entry)
+        {
+          cogl_matrix_entry_get (entries[i].modelview_entry, &modelview);
+          last_modelview_entry = entries[i].modelview_entry;
+        }
+
+      get_entry_bounds (journal, &entries[i], &modelview, &bounds[i]);
+    }
+
+  used = g_new0 (gboolean, n_entries);
+  g_array_set_size (journal->reordered_entries, 0);
+
+  while (first_unused < n_entries)
+    {
+      int n_skipped = 0;
+
+      if (last)
+        i = find_next_batch_start (entries, bounds, used, n_entries,
+                                   first_unused, last);
+      else
+        i = first_unused;
+
+      /* Anything pulled in front of the start of this batch also ends
+       * up in front of the unused entries it skipped over */
+      for (j = first_unused; j < i; j++)
+        {
+          if (!used[j])
+            skipped[n_skipped++] = j;
+        }
+
+      moved_any |= n_skipped > 0;
+      last = &entries[i];
+
+      used[i] = TRUE;
+      g_array_append_val (journal->reordered_entries, entries[i]);
+
+      for (j = i + 1; j < n_entries && j <= i + REORDER_WINDOW; j++)
+        {
+          gboolean can_move;
+          int k;
+
+          if (used[j])
+            continue;
+
+          can_move = compare_entries_for_reorder (last, &entries[j],
+                                                  COGL_PIPELINE_LAYER_STATE_ALL);
+
+          for (k = 0; can_move && k < n_skipped; k++)
+            {
+              int s = skipped[k];
+
+              if (entries_may_overlap (&entries[j], &bounds[j],
+                                       &entries[s], &bounds[s]))
+                can_move = FALSE;
+            }
+
+          if (can_move)
+            {
+              used[j] = TRUE;
+              g_array_append_val (journal->reordered_entries, entries[j]);
+              last = &entries[j];
+              moved_any |= n_skipped > 0;
+            }
+          else
+            {
+              /* Nothing can be moved across an entry that isn't
+               * parallel to the screen, so stop looking */
+              if (!bounds[j].flat)
+                break;
+
+              skipped[n_skipped++] = j;
+            }
+        }
+
+      while (first_unused < n_entries && used[first_unused])
+        first_unused++;
+    }
+
+  if (!moved_any)
+    return;
+
+  if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
+    g_print ("BATCHING: reordered journal entries\n");
+
+  /* The entries are plain structs so swapping the arrays transfers the
+   * references they hold */
+  tmp = journal->entries;
+  journal->entries = journal->reordered_entries;
+  journal->reordered_entries = tmp;
+  g_array_set_size (journal->reordered_entries, 0);
+}
+
 /* Gets a new vertex array from the pool. A reference is taken on the
    array so it can be treated as if it was just newly allocated */
 static CoglAttributeBuffer *
@@ -1161,10 +1456,12 @@ upload_vertices (CoglJournal *journal,
                  const CoglJournalEntry *entries,
                  int n_entries,
                  size_t needed_vbo_len,
-                 GArray *vertices)
+                 GArray *vertices,
+                 size_t *array_offset_out)
 {
+  CoglContext *ctx = cogl_framebuffer_get_context (journal->framebuffer);
   CoglAttributeBuffer *attribute_buffer;
-  CoglBuffer *buffer;
+  CoglBuffer *buffer = NULL;
   const float *vin;
   float *vout;
   int entry_num;
@@ -1174,14 +1471,33 @@ upload_vertices (CoglJournal *journal,
 
   g_assert (needed_vbo_len);
 
-  attribute_buffer = create_attribute_buffer (journal, needed_vbo_len * 4);
-  buffer = COGL_BUFFER (attribute_buffer);
-  cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
+  /* Prefer writing straight into the context's persistently mapped
+   * stream buffer. The journal debug output maps the attribute buffer
+   * back for reading so that always uses a buffer of its own. */
+  if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_JOURNAL)))
+    vout = _cogl_stream_buffer_alloc (ctx,
+                                      needed_vbo_len * 4,
+                                      &attribute_buffer,
+                                      array_offset_out);
+  else
+    vout = NULL;
 
-  vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
-                                                      0, /* offset */
-                                                      needed_vbo_len * 4);
-  vin = &g_array_index (vertices, float, 0);
+  if (vout)
+    {
+      g_object_ref (attribute_buffer);
+    }
+  else
+    {
+      attribute_buffer = create_attribute_buffer (journal,
+                                                  needed_vbo_len * 4);
+      buffer = COGL_BUFFER (attribute_buffer);
+      cogl_buffer_set_update_hint (buffer, COGL_BUFFER_UPDATE_HINT_DYNAMIC);
+
+      vout = _cogl_buffer_map_range_for_fill_or_fallback (buffer,
+                                                          0, /* offset */
+                                                          needed_vbo_len * 4);
+      *array_offset_out = 0;
+    }
 
   /* Expand the number of vertices from 2 to 4 while uploading */
   for (entry_num = 0; entry_num < n_entries; entry_num++)
@@ -1191,6 +1507,10 @@ upload_vertices (CoglJournal *journal,
       size_t array_stride =
         GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
 
+      /* The entries may have been reordered so the logged vertices
+       * aren't necessarily in the same order */
+      vin = &g_array_index (vertices, float, entry->array_offset);
+
       /* Copy the color to all four of the vertices */
       for (i = 0; i < 4; i++)
         memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
@@ -1220,8 +1540,13 @@ upload_vertices (CoglJournal *journal,
           v[6] = vin[array_stride];
           v[7] = vin[1];
 
+          /* Resolving an entry walks the whole matrix stack, so only do
+           * it when the modelview changes between consecutive quads */
           if (entry->modelview_entry != last_modelview_entry)
-            cogl_matrix_entry_get (entry->modelview_entry, &modelview);
+            {
+              cogl_matrix_entry_get (entry->modelview_entry, &modelview);
+              last_modelview_entry = entry->modelview_entry;
+            }
           cogl_graphene_matrix_transform_points (&modelview,
                                                  2, /* n_components */
                                                  sizeof (float) * 2, /* stride_in */
@@ -1247,11 +1572,11 @@ upload_vertices (CoglJournal *journal,
           tout[vb_stride * 3 + 1 + i * 2] = tin[i * 2 + 1];
         }
 
-      vin += array_stride * 2;
       vout += vb_stride * 4;
     }
 
-  _cogl_buffer_unmap_for_fill_or_fallback (buffer);
+  if (buffer)
+    _cogl_buffer_unmap_for_fill_or_fallback (buffer);
 
   return attribute_buffer;
 }
@@ -1439,6 +1764,10 @@ _cogl_journal_flush (CoglJournal *journal)
                       &state); /* data */
     }
 
+  if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_JOURNAL_REORDER)) &&
+      G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_BATCHING)))
+    reorder_entries (journal);
+
   /* We upload the vertices after the clip stack pass in case it
      modifies the entries */
   state.attribute_buffer =
@@ -1446,8 +1775,8 @@ _cogl_journal_flush (CoglJournal *journal)
                      &g_array_index (journal->entries, CoglJournalEntry, 0),
                      journal->entries->len,
                      journal->needed_vbo_len,
-                     journal->vertices);
-  state.array_offset = 0;
+                     journal->vertices,
+                     &state.array_offset);
 
   /* batch_and_call() batches a list of journal entries according to some
    * given criteria and calls a callback once for each determined batch.
@@ -1582,6 +1911,8 @@ _cogl_journal_log_quad (CoglJournal  *journal,
       _cogl_journal_dump_logged_quad ((uint8_t *)v, n_layers);
     }
 
+  cogl_framebuffer_get_context (framebuffer)->n_journal_entries++;
+
   next_entry = journal->entries->len;
   g_array_set_size (journal->entries, next_entry + 1);
   entry = &g_array_index (journal->entries, CoglJournalEntry, next_entry);
@@ -50,12 +50,30 @@ typedef enum _CoglMatrixOp
   COGL_MATRIX_OP_SAVE,
 } CoglMatrixOp;
 
+typedef struct _CoglMatrixEntryComposite
+{
+  graphene_matrix_t matrix;
+  graphene_matrix_t inverse;
+  gboolean inverse_valid;
+  gboolean has_inverse;
+} CoglMatrixEntryComposite;
+
 struct _CoglMatrixEntry
 {
   CoglMatrixEntry *parent;
   CoglMatrixOp op;
   unsigned int ref_count;
 
+  /* Whether the entry is in the table of interned entries so that
+   * pushing an identical operation onto the same parent shares it */
+  gboolean interned;
+
+  /* The matrix composed from this entry up to its root, allocated the
+   * first time it is composed. Entries never change once pushed so
+   * this never needs to be invalidated; an entry pointer doubles as
+   * the version of its matrix. */
+  CoglMatrixEntryComposite *composite;
+
   /* Debugging, only used when defined(COGL_ENABLE_DEBUG)
    * Used for performance tracing */
   int composite_gets;
@@ -33,6 +33,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-graphene.h"
 #include "cogl/cogl-matrix-stack.h"
@@ -45,6 +47,12 @@ G_DEFINE_BOXED_TYPE (CoglMatrixEntry, cogl_matrix_entry,
                      cogl_matrix_entry_unref);
 
 static CoglMagazine *cogl_matrix_stack_magazine;
+static CoglMagazine *cogl_matrix_composite_magazine;
+
+/* Entries that are currently alive, keyed by their parent, operation
+ * and arguments. The table doesn't hold a reference; entries remove
+ * themselves when they are freed. */
+static GHashTable *cogl_matrix_entry_table;
 
 /* XXX: Note: this leaves entry->parent uninitialized! */
 static CoglMatrixEntry *
@@ -55,6 +63,8 @@ _cogl_matrix_entry_new (CoglMatrixOp operation)
 
   entry->ref_count = 1;
   entry->op = operation;
+  entry->interned = FALSE;
+  entry->composite = NULL;
 
 #ifdef COGL_ENABLE_DEBUG
   entry->composite_gets = 0;
@@ -121,6 +131,145 @@ _cogl_matrix_stack_push_operation (CoglMatrixStack *stack,
   return entry;
 }
 
+/* Writes the arguments of the operation of @entry into @args and
+ * returns how many there are */
+static int
+_cogl_matrix_entry_get_args (const CoglMatrixEntry *entry,
+                             float                  args[16])
+{
+  switch (entry->op)
+    {
+    case COGL_MATRIX_OP_LOAD_IDENTITY:
+    case COGL_MATRIX_OP_SAVE:
+      return 0;
+
+    case COGL_MATRIX_OP_TRANSLATE:
+      {
+        const CoglMatrixEntryTranslate *translate =
+          (const CoglMatrixEntryTranslate *) entry;
+
+        args[0] = translate->translate.x;
+        args[1] = translate->translate.y;
+        args[2] = translate->translate.z;
+        return 3;
+      }
+    case COGL_MATRIX_OP_ROTATE:
+      {
+        const CoglMatrixEntryRotate *rotate =
+          (const CoglMatrixEntryRotate *) entry;
+
+        args[0] = rotate->angle;
+        graphene_vec3_to_float (&rotate->axis, &args[1]);
+        return 4;
+      }
+    case COGL_MATRIX_OP_ROTATE_EULER:
+      {
+        const CoglMatrixEntryRotateEuler *rotate =
+          (const CoglMatrixEntryRotateEuler *) entry;
+
+        args[0] = graphene_euler_get_x (&rotate->euler);
+        args[1] = graphene_euler_get_y (&rotate->euler);
+        args[2] = graphene_euler_get_z (&rotate->euler);
+        args[3] = graphene_euler_get_order (&rotate->euler);
+        return 4;
+      }
+    case COGL_MATRIX_OP_SCALE:
+      {
+        const CoglMatrixEntryScale *scale =
+          (const CoglMatrixEntryScale *) entry;
+
+        args[0] = scale->x;
+        args[1] = scale->y;
+        args[2] = scale->z;
+        return 3;
+      }
+    case COGL_MATRIX_OP_MULTIPLY:
+      {
+        const CoglMatrixEntryMultiply *multiply =
+          (const CoglMatrixEntryMultiply *) entry;
+
+        graphene_matrix_to_float (&multiply->matrix, args);
+        return 16;
+      }
+    case COGL_MATRIX_OP_LOAD:
+      {
+        const CoglMatrixEntryLoad *load = (const CoglMatrixEntryLoad *) entry;
+
+        graphene_matrix_to_float (&load->matrix, args);
+        return 16;
+      }
+    }
+
+  g_assert_not_reached ();
+  return 0;
+}
+
+static unsigned int
+_cogl_matrix_entry_hash (gconstpointer key)
+{
+  const CoglMatrixEntry *entry = key;
+  float args[16];
+  int n_args = _cogl_matrix_entry_get_args (entry, args);
+  unsigned int hash = 0;
+
+  hash = _cogl_util_one_at_a_time_hash (hash, &entry->parent,
+                                        sizeof (entry->parent));
+  hash = _cogl_util_one_at_a_time_hash (hash, &entry->op,
+                                        sizeof (entry->op));
+  /* The arguments are compared bitwise so they are hashed bitwise too,
+   * which keeps the hash consistent for 0 and -0 */
+  hash = _cogl_util_one_at_a_time_hash (hash, args,
+                                        n_args * sizeof (float));
+
+  return _cogl_util_one_at_a_time_mix (hash);
+}
+
+static gboolean
+_cogl_matrix_entry_key_equal (gconstpointer a,
+                              gconstpointer b)
+{
+  const CoglMatrixEntry *entry0 = a;
+  const CoglMatrixEntry *entry1 = b;
+  float args0[16];
+  float args1[16];
+  int n_args;
+
+  if (entry0->parent != entry1->parent || entry0->op != entry1->op)
+    return FALSE;
+
+  n_args = _cogl_matrix_entry_get_args (entry0, args0);
+  _cogl_matrix_entry_get_args (entry1, args1);
+
+  return memcmp (args0, args1, n_args * sizeof (float)) == 0;
+}
+
+/* Replaces the entry that was just pushed and initialized with an
+ * identical one that is already alive, if there is one. Repeatedly
+ * pushing the same transforms then results in the same entries, which
+ * lets everything that caches by entry pointer (the composed matrices,
+ * the flushed matrix state, journal batching) hit. */
+static void
+_cogl_matrix_stack_intern_top (CoglMatrixStack *stack)
+{
+  CoglMatrixEntry *entry = stack->last_entry;
+  CoglMatrixEntry *interned;
+
+  interned = g_hash_table_lookup (cogl_matrix_entry_table, entry);
+  if (interned)
+    {
+      /* The new entry owns the reference on the parent that the stack
+       * used to hold while the interned entry holds its own, so
+       * dropping the new entry leaves the parent with the right count */
+      stack->last_entry = cogl_matrix_entry_ref (interned);
+      cogl_matrix_entry_unref (entry);
+    }
+  else
+    {
+      g_hash_table_add (cogl_matrix_entry_table, entry);
+      entry->interned = TRUE;
+    }
+}
+
 static void *
 _cogl_matrix_stack_push_replacement_entry (CoglMatrixStack *stack,
                                            CoglMatrixOp operation)
@@ -154,6 +303,8 @@ _cogl_matrix_entry_identity_init (CoglMatrixEntry *entry)
   entry->ref_count = 1;
   entry->op = COGL_MATRIX_OP_LOAD_IDENTITY;
   entry->parent = NULL;
+  entry->interned = FALSE;
+  entry->composite = NULL;
 #ifdef COGL_ENABLE_DEBUG
   entry->composite_gets = 0;
 #endif
@@ -308,6 +459,7 @@ cogl_matrix_stack_push (CoglMatrixStack *stack)
   entry = _cogl_matrix_stack_push_operation (stack, COGL_MATRIX_OP_SAVE);
 
   entry->cache_valid = FALSE;
+  _cogl_matrix_stack_intern_top (stack);
 }
 
 CoglMatrixEntry *
@@ -329,6 +481,13 @@ cogl_matrix_entry_unref (CoglMatrixEntry *entry)
   for (; entry && --entry->ref_count <= 0; entry = parent)
     {
       parent = entry->parent;
+
+      if (entry->interned)
+        g_hash_table_remove (cogl_matrix_entry_table, entry);
+      if (entry->composite)
+        _cogl_magazine_chunk_free (cogl_matrix_composite_magazine,
+                                   entry->composite);
+
       _cogl_magazine_chunk_free (cogl_matrix_stack_magazine, entry);
     }
 }
@@ -374,13 +533,7 @@ gboolean
 cogl_matrix_stack_get_inverse (CoglMatrixStack   *stack,
                                graphene_matrix_t *inverse)
 {
-  graphene_matrix_t matrix;
-  graphene_matrix_t *internal = cogl_matrix_stack_get (stack, &matrix);
-
-  if (internal)
-    return graphene_matrix_inverse (internal, inverse);
-  else
-    return graphene_matrix_inverse (&matrix, inverse);
+  return cogl_matrix_entry_get_inverse (stack->last_entry, inverse);
 }
 
 /* In addition to writing the stack matrix into the give @matrix
@@ -395,12 +548,26 @@ cogl_matrix_entry_get (CoglMatrixEntry   *entry,
   CoglMatrixEntry *current;
   int depth;
 
+  if (entry->composite)
+    {
+      *matrix = entry->composite->matrix;
+      return &entry->composite->matrix;
+    }
+
   graphene_matrix_init_identity (matrix);
 
   for (current = entry, depth = 0;
        current;
        current = current->parent, depth++)
     {
+      /* Stop walking at the first ancestor that was already composed */
+      if (current->composite)
+        {
+          graphene_matrix_multiply (matrix, &current->composite->matrix,
+                                    matrix);
+          goto applied;
+        }
+
       switch (current->op)
         {
         case COGL_MATRIX_OP_TRANSLATE:
@@ -508,7 +675,14 @@ applied:
       return NULL;
     }
 
-  return NULL;
+  /* Keep the result around for the next time this entry is
+   * composed, e.g. by every pick record or journal entry sharing it */
+  entry->composite =
+    _cogl_magazine_chunk_alloc (cogl_matrix_composite_magazine);
+  entry->composite->matrix = *matrix;
+  entry->composite->inverse_valid = FALSE;
+
+  return &entry->composite->matrix;
 }
 
 CoglMatrixEntry *
@@ -538,6 +712,11 @@ cogl_matrix_stack_new (CoglContext *ctx)
     {
       cogl_matrix_stack_magazine =
         _cogl_magazine_new (sizeof (CoglMatrixEntryFull), 20);
+      cogl_matrix_composite_magazine =
+        _cogl_magazine_new (sizeof (CoglMatrixEntryComposite), 20);
+      cogl_matrix_entry_table =
+        g_hash_table_new (_cogl_matrix_entry_hash,
+                          _cogl_matrix_entry_key_equal);
     }
 
   stack->context = ctx;
@@ -561,6 +740,56 @@ _cogl_matrix_entry_skip_saves (CoglMatrixEntry *entry)
   return entry;
 }
 
+static CoglMatrixEntryComposite *
+_cogl_matrix_entry_ensure_composite (CoglMatrixEntry *entry)
+{
+  if (!entry->composite)
+    {
+      graphene_matrix_t matrix;
+
+      cogl_matrix_entry_get (entry, &matrix);
+
+      /* Entries that are a matrix on their own don't get one */
+      if (!entry->composite)
+        {
+          entry->composite =
+            _cogl_magazine_chunk_alloc (cogl_matrix_composite_magazine);
+          entry->composite->matrix = matrix;
+          entry->composite->inverse_valid = FALSE;
+        }
+    }
+
+  return entry->composite;
+}
+
+gboolean
+cogl_matrix_entry_get_inverse (CoglMatrixEntry   *entry,
+                               graphene_matrix_t *inverse)
+{
+  CoglMatrixEntryComposite *composite;
+
+  entry = _cogl_matrix_entry_skip_saves (entry);
+
+  if (entry->op == COGL_MATRIX_OP_LOAD_IDENTITY)
+    {
+      graphene_matrix_init_identity (inverse);
+      return TRUE;
+    }
+
+  composite = _cogl_matrix_entry_ensure_composite (entry);
+
+  if (!composite->inverse_valid)
+    {
+      composite->has_inverse = graphene_matrix_inverse (&composite->matrix,
+                                                        &composite->inverse);
+      composite->inverse_valid = TRUE;
+    }
+
+  *inverse = composite->inverse;
+
+  return composite->has_inverse;
+}
+
 gboolean
 cogl_matrix_entry_calculate_translation (CoglMatrixEntry *entry0,
                                          CoglMatrixEntry *entry1,
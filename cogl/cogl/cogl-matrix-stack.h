@@ -453,6 +453,21 @@ COGL_EXPORT graphene_matrix_t *
 cogl_matrix_entry_get (CoglMatrixEntry   *entry,
                        graphene_matrix_t *matrix);
 
+/**
+ * cogl_matrix_entry_get_inverse:
+ * @entry: A #CoglMatrixEntry
+ * @inverse: (out): The destination for a 4x4 inverse transformation matrix
+ *
+ * Gets the inverse of the transform of @entry. The inverse is cached
+ * with the entry so asking for it again is cheap.
+ *
+ * Return value: %TRUE if the inverse was successfully calculated or %FALSE
+ *   for degenerate transformations that can't be inverted
+ */
+COGL_EXPORT gboolean
+cogl_matrix_entry_get_inverse (CoglMatrixEntry   *entry,
+                               graphene_matrix_t *inverse);
+
 /**
  * cogl_matrix_stack_set:
  * @stack: A #CoglMatrixStack
@@ -0,0 +1,195 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2025 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ */
+
+#include "config.h"
+
+#include "cogl/cogl-offscreen-pool-private.h"
+#include "cogl/cogl-framebuffer-private.h"
+#include "cogl/cogl-journal-private.h"
+#include "cogl/cogl-texture.h"
+
+/* Offscreens that haven't been reused for this long are freed */
+#define MAX_IDLE_TIME_US (G_USEC_PER_SEC * 10)
+
+/* Upper bounds for what the pool holds on to, the least recently
+ * released offscreens are freed first when going over them */
+#define MAX_ENTRIES 32
+#define MAX_BYTES (64 * 1024 * 1024)
+
+typedef struct _CoglOffscreenPoolEntry
+{
+  CoglOffscreen *offscreen;
+
+  int width;
+  int height;
+  CoglPixelFormat format;
+  size_t n_bytes;
+
+  int64_t release_time_us;
+} CoglOffscreenPoolEntry;
+
+struct _CoglOffscreenPool
+{
+  /* Most recently released first */
+  GQueue entries;
+
+  size_t n_bytes;
+};
+
+static void
+free_entry (CoglOffscreenPoolEntry *entry)
+{
+  g_object_unref (entry->offscreen);
+  g_free (entry);
+}
+
+CoglOffscreenPool *
+_cogl_offscreen_pool_new (void)
+{
+  CoglOffscreenPool *pool;
+
+  pool = g_new0 (CoglOffscreenPool, 1);
+  g_queue_init (&pool->entries);
+
+  return pool;
+}
+
+void
+_cogl_offscreen_pool_free (CoglOffscreenPool *pool)
+{
+  _cogl_offscreen_pool_trim (pool, TRUE);
+  g_free (pool);
+}
+
+static void
+remove_link (CoglOffscreenPool *pool,
+             GList             *link)
+{
+  CoglOffscreenPoolEntry *entry = link->data;
+
+  pool->n_bytes -= entry->n_bytes;
+  g_queue_delete_link (&pool->entries, link);
+}
+
+CoglOffscreen *
+_cogl_offscreen_pool_take (CoglOffscreenPool *pool,
+                           int                width,
+                           int                height,
+                           CoglPixelFormat    format)
+{
+  GList *l;
+
+  _cogl_offscreen_pool_trim (pool, FALSE);
+
+  for (l = pool->entries.head; l; l = l->next)
+    {
+      CoglOffscreenPoolEntry *entry = l->data;
+      CoglOffscreen *offscreen;
+
+      if (entry->width != width ||
+          entry->height != height ||
+          entry->format != format)
+        continue;
+
+      offscreen = g_steal_pointer (&entry->offscreen);
+      remove_link (pool, l);
+      g_free (entry);
+
+      return offscreen;
+    }
+
+  return NULL;
+}
+
+static gboolean
+is_only_reference (gpointer object)
+{
+  return g_atomic_int_get (&G_OBJECT (object)->ref_count) == 1;
+}
+
+void
+_cogl_offscreen_pool_give (CoglOffscreenPool *pool,
+                           CoglOffscreen     *offscreen,
+                           CoglPixelFormat    format)
+{
+  CoglTexture *texture = cogl_offscreen_get_texture (offscreen);
+  CoglOffscreenPoolEntry *entry;
+
+  /* Anything still referring to the offscreen or its texture, like a
+   * pipeline or a journal that hasn't been flushed yet, could still
+   * read from it, so it can only be handed out again once it is ours
+   * alone */
+  if (!is_only_reference (offscreen) || !is_only_reference (texture))
+    {
+      g_object_unref (offscreen);
+      return;
+    }
+
+  /* Nothing can read back what is still queued up for it either, so
+   * drop it rather than keeping the pipelines it uses alive */
+  _cogl_journal_discard (cogl_framebuffer_get_journal (COGL_FRAMEBUFFER (offscreen)));
+
+  entry = g_new0 (CoglOffscreenPoolEntry, 1);
+  entry->offscreen = offscreen;
+  entry->width = cogl_texture_get_width (texture);
+  entry->height = cogl_texture_get_height (texture);
+  entry->format = format;
+  entry->n_bytes = ((size_t) entry->width * entry->height *
+                    (format == COGL_PIXEL_FORMAT_ANY ?
+                     4 : cogl_pixel_format_get_bytes_per_pixel (format, 0)));
+  entry->release_time_us = g_get_monotonic_time ();
+
+  g_queue_push_head (&pool->entries, entry);
+  pool->n_bytes += entry->n_bytes;
+
+  _cogl_offscreen_pool_trim (pool, FALSE);
+}
+
+void
+_cogl_offscreen_pool_trim (CoglOffscreenPool *pool,
+                           gboolean           release_all)
+{
+  int64_t now_us = g_get_monotonic_time ();
+
+  while (pool->entries.tail)
+    {
+      GList *link = pool->entries.tail;
+      CoglOffscreenPoolEntry *entry = link->data;
+
+      if (!release_all &&
+          pool->entries.length <= MAX_ENTRIES &&
+          pool->n_bytes <= MAX_BYTES &&
+          now_us - entry->release_time_us < MAX_IDLE_TIME_US)
+        break;
+
+      remove_link (pool, link);
+      free_entry (entry);
+    }
+}
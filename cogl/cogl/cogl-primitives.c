@@ -709,13 +709,29 @@ cogl_2d_primitives_immediate (CoglFramebuffer *framebuffer,
   CoglAttributeBuffer *attribute_buffer;
   CoglAttribute *attributes[1];
   size_t vertices_size = sizeof (CoglVertexP2) * n_vertices;
+  size_t offset;
+  void *data;
+
+  /* Avoid creating a new buffer object for every draw if the vertices
+   * can be streamed through the context's mapped buffer */
+  data = _cogl_stream_buffer_alloc (ctx, vertices_size,
+                                    &attribute_buffer, &offset);
+  if (data)
+    {
+      memcpy (data, vertices, vertices_size);
+      g_object_ref (attribute_buffer);
+    }
+  else
+    {
+      attribute_buffer =
+        cogl_attribute_buffer_new (ctx, vertices_size, vertices);
+      offset = 0;
+    }
 
-  attribute_buffer =
-    cogl_attribute_buffer_new (ctx, vertices_size, vertices);
   attributes[0] = cogl_attribute_new (attribute_buffer,
                                       "cogl_position_in",
                                       sizeof (CoglVertexP2), /* stride */
-                                      0, /* offset */
+                                      offset,
                                       2, /* n_components */
                                       COGL_ATTRIBUTE_TYPE_FLOAT);
 
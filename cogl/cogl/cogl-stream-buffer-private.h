@@ -0,0 +1,58 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ */
+
+#pragma once
+
+#include "cogl/cogl-attribute-buffer.h"
+#include "cogl/cogl-context.h"
+
+/* A single persistently mapped attribute buffer shared by everything
+ * that streams vertices to the GPU once per draw, such as the journal.
+ * The buffer is split into regions which are reused in a ring. Before
+ * a region is written to again we wait on a fence that was inserted
+ * after the last draw sourcing from it.
+ */
+typedef struct _CoglStreamBuffer CoglStreamBuffer;
+
+/* Reserves @size bytes and returns a pointer to write the vertices to.
+ * The buffer and the offset of the reservation within it are returned
+ * in @buffer_out and @offset_out; no reference is taken on the buffer.
+ * The reserved memory must be written and drawn from before the next
+ * call. Returns NULL if the driver can't persistently map buffers or
+ * the request doesn't fit, in which case the caller should fall back
+ * to a buffer of its own. */
+void *
+_cogl_stream_buffer_alloc (CoglContext *ctx,
+                           size_t size,
+                           CoglAttributeBuffer **buffer_out,
+                           size_t *offset_out);
+
+void
+_cogl_stream_buffer_free (CoglStreamBuffer *stream);
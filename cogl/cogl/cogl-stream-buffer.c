@@ -0,0 +1,189 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2024 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *
+ */
+
+#include "config.h"
+
+#include "cogl/cogl-buffer-private.h"
+#include "cogl/cogl-context-private.h"
+#include "cogl/cogl-private.h"
+#include "cogl/cogl-stream-buffer-private.h"
+
+#define COGL_STREAM_BUFFER_SIZE (4 * 1024 * 1024)
+#define COGL_STREAM_BUFFER_N_REGIONS 4
+#define COGL_STREAM_BUFFER_ALIGNMENT 16
+
+/* How long to wait for the GPU to release a region before giving up
+ * and falling back to a separate buffer */
+#define COGL_STREAM_BUFFER_WAIT_TIMEOUT G_GUINT64_CONSTANT (1000000000) /* ns */
+
+struct _CoglStreamBuffer
+{
+  CoglContext *context;
+  CoglAttributeBuffer *buffer;
+  uint8_t *data;
+
+  size_t region_size;
+  int current_region;
+  size_t region_offset;
+
+#ifdef GL_ARB_sync
+  GLsync fences[COGL_STREAM_BUFFER_N_REGIONS];
+#endif
+};
+
+#ifdef GL_ARB_sync
+static CoglStreamBuffer *
+ensure_stream_buffer (CoglContext *ctx)
+{
+  CoglStreamBuffer *stream;
+  CoglAttributeBuffer *buffer;
+  g_autoptr (GError) error = NULL;
+  void *data;
+
+  if (ctx->stream_buffer || ctx->stream_buffer_unsupported)
+    return ctx->stream_buffer;
+
+  ctx->stream_buffer_unsupported = TRUE;
+
+  if (!_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_BUFFER_STORAGE) ||
+      !ctx->driver_vtable->buffer_map_persistent)
+    return NULL;
+
+  buffer = cogl_attribute_buffer_new_with_size (ctx, COGL_STREAM_BUFFER_SIZE);
+  data = ctx->driver_vtable->buffer_map_persistent (COGL_BUFFER (buffer),
+                                                    &error);
+  if (!data)
+    {
+      g_debug ("Not streaming vertices through a persistent buffer: %s",
+               error->message);
+      g_object_unref (buffer);
+      return NULL;
+    }
+
+  stream = g_new0 (CoglStreamBuffer, 1);
+  stream->context = ctx;
+  stream->buffer = buffer;
+  stream->data = data;
+  stream->region_size = COGL_STREAM_BUFFER_SIZE / COGL_STREAM_BUFFER_N_REGIONS;
+
+  ctx->stream_buffer = stream;
+  ctx->stream_buffer_unsupported = FALSE;
+
+  return stream;
+}
+
+static gboolean
+advance_region (CoglStreamBuffer *stream)
+{
+  CoglContext *ctx = stream->context;
+  int next_region;
+
+  /* Everything written to the current region has been drawn from by
+   * now, so this fence tells us when the GPU is done with it */
+  if (!stream->fences[stream->current_region])
+    stream->fences[stream->current_region] =
+      ctx->glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  next_region = (stream->current_region + 1) % COGL_STREAM_BUFFER_N_REGIONS;
+
+  if (stream->fences[next_region])
+    {
+      GLenum status;
+
+      status = ctx->glClientWaitSync (stream->fences[next_region],
+                                      GL_SYNC_FLUSH_COMMANDS_BIT,
+                                      COGL_STREAM_BUFFER_WAIT_TIMEOUT);
+      if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        return FALSE;
+
+      ctx->glDeleteSync (stream->fences[next_region]);
+      stream->fences[next_region] = NULL;
+    }
+
+  stream->current_region = next_region;
+  stream->region_offset = 0;
+
+  return TRUE;
+}
+#endif
+
+void *
+_cogl_stream_buffer_alloc (CoglContext *ctx,
+                           size_t size,
+                           CoglAttributeBuffer **buffer_out,
+                           size_t *offset_out)
+{
+#ifdef GL_ARB_sync
+  CoglStreamBuffer *stream;
+  size_t offset;
+
+  stream = ensure_stream_buffer (ctx);
+  if (!stream)
+    return NULL;
+
+  size = (size + COGL_STREAM_BUFFER_ALIGNMENT - 1) &
+         ~((size_t) COGL_STREAM_BUFFER_ALIGNMENT - 1);
+  if (size > stream->region_size)
+    return NULL;
+
+  if (stream->region_offset + size > stream->region_size &&
+      !advance_region (stream))
+    return NULL;
+
+  offset = stream->current_region * stream->region_size +
+           stream->region_offset;
+  stream->region_offset += size;
+
+  *buffer_out = stream->buffer;
+  *offset_out = offset;
+
+  return stream->data + offset;
+#else
+  return NULL;
+#endif
+}
+
+void
+_cogl_stream_buffer_free (CoglStreamBuffer *stream)
+{
+#ifdef GL_ARB_sync
+  int i;
+
+  for (i = 0; i < COGL_STREAM_BUFFER_N_REGIONS; i++)
+    {
+      if (stream->fences[i])
+        stream->context->glDeleteSync (stream->fences[i]);
+    }
+#endif
+
+  /* Deleting the buffer object implicitly unmaps it */
+  g_object_unref (stream->buffer);
+  g_free (stream);
+}
@@ -470,6 +470,75 @@ cogl_texture_set_region_from_bitmap (CoglTexture *texture,
   return status;
 }
 
+/* Uploads of at least this many bytes are staged in a pixel buffer */
+#define COGL_TEXTURE_PIXEL_BUFFER_UPLOAD_THRESHOLD (256 * 1024)
+
+/* Copies the data into the context's upload pixel buffer and returns a
+ * bitmap for it, so that the upload itself can be done asynchronously
+ * by the driver with glTexSubImage2D sourcing from the buffer, instead
+ * of the driver having to copy from client memory before returning.
+ * Returns NULL if the data should be uploaded directly instead. */
+static CoglBitmap *
+stage_region_in_pixel_buffer (CoglTexture     *texture,
+                              int              width,
+                              int              height,
+                              CoglPixelFormat  format,
+                              int              rowstride,
+                              const uint8_t   *data)
+{
+  CoglContext *ctx = cogl_texture_get_context (texture);
+  int bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+  size_t row_size = (size_t) width * bpp;
+  size_t size = row_size * height;
+  CoglBuffer *buffer;
+  uint8_t *dst;
+  int y;
+
+  if (size < COGL_TEXTURE_PIXEL_BUFFER_UPLOAD_THRESHOLD ||
+      !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_PBOS) ||
+      !COGL_IS_TEXTURE_2D (texture))
+    return NULL;
+
+  /* If the data needs converting on the CPU then it would have to be
+   * read back from the buffer */
+  if (format != _cogl_texture_get_format (texture))
+    return NULL;
+
+  if (ctx->upload_pixel_buffer &&
+      cogl_buffer_get_size (COGL_BUFFER (ctx->upload_pixel_buffer)) < size)
+    g_clear_object (&ctx->upload_pixel_buffer);
+
+  if (!ctx->upload_pixel_buffer)
+    {
+      ctx->upload_pixel_buffer = cogl_pixel_buffer_new (ctx, size, NULL);
+      cogl_buffer_set_update_hint (COGL_BUFFER (ctx->upload_pixel_buffer),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+    }
+
+  buffer = COGL_BUFFER (ctx->upload_pixel_buffer);
+
+  /* Discarding the previous contents lets the driver hand out new
+   * storage while the GPU may still be reading the last upload,
+   * instead of waiting for it to finish */
+  dst = _cogl_buffer_map (buffer,
+                          COGL_BUFFER_ACCESS_WRITE,
+                          COGL_BUFFER_MAP_HINT_DISCARD,
+                          NULL);
+  if (!dst)
+    return NULL;
+
+  for (y = 0; y < height; y++)
+    memcpy (dst + y * row_size, data + y * rowstride, row_size);
+
+  cogl_buffer_unmap (buffer);
+
+  return cogl_bitmap_new_from_buffer (buffer,
+                                      format,
+                                      width, height,
+                                      row_size,
+                                      0);
+}
+
 gboolean
 _cogl_texture_set_region (CoglTexture *texture,
                           int width,
@@ -494,11 +563,17 @@ _cogl_texture_set_region (CoglTexture *texture,
     rowstride = cogl_pixel_format_get_bytes_per_pixel (format, 0) * width;
 
   /* Init source bitmap */
-  source_bmp = cogl_bitmap_new_for_data (ctx,
-                                         width, height,
-                                         format,
-                                         rowstride,
-                                         (uint8_t *) data);
+  source_bmp = stage_region_in_pixel_buffer (texture,
+                                             width, height,
+                                             format,
+                                             rowstride,
+                                             data);
+  if (!source_bmp)
+    source_bmp = cogl_bitmap_new_for_data (ctx,
+                                           width, height,
+                                           format,
+                                           rowstride,
+                                           (uint8_t *) data);
 
   ret = _cogl_texture_set_region_from_bitmap (texture,
                                               0, 0,
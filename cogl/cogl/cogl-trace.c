@@ -40,11 +40,40 @@
 
 #define COGL_TRACE_OUTPUT_FILE "cogl-trace-sp-capture.syscap"
 #define BUFFER_LENGTH (4096 * 4)
+#define FLIGHT_RECORDER_N_EVENTS 4096
+
+typedef struct _CoglTraceEvent
+{
+  uint64_t begin_time;
+  uint64_t duration;
+  const char *name;
+  char *description;
+} CoglTraceEvent;
+
+/* Fixed size ring of the most recent events of a thread. The lock is only
+ * ever contended while the flight recorder is being dumped.
+ */
+typedef struct _CoglTraceRing
+{
+  GMutex mutex;
+  GPid pid;
+  char *group;
+
+  CoglTraceEvent events[FLIGHT_RECORDER_N_EVENTS];
+  unsigned int next_event;
+  unsigned int n_events;
+} CoglTraceRing;
 
 struct _CoglTraceContext
 {
   gatomicrefcount ref_count;
   SysprofCaptureWriter *writer;
+
+  /* "category/name" -> counter id */
+  GHashTable *counters;
+
+  /* Rings of all threads traced by the flight recorder, or NULL */
+  GPtrArray *rings;
 };
 
 typedef struct _CoglTraceThreadContext
@@ -53,6 +82,7 @@ typedef struct _CoglTraceThreadContext
   GPid pid;
   char *group;
   CoglTraceContext *trace_context;
+  CoglTraceRing *ring;
 } CoglTraceThreadContext;
 
 typedef struct
@@ -79,6 +109,95 @@ GPrivate cogl_trace_thread_data = G_PRIVATE_INIT (cogl_trace_thread_context_free
 CoglTraceContext *cogl_trace_context;
 GMutex cogl_trace_mutex;
 
+static CoglTraceRing *
+cogl_trace_ring_new (GPid        pid,
+                     const char *group)
+{
+  CoglTraceRing *ring;
+
+  ring = g_new0 (CoglTraceRing, 1);
+  g_mutex_init (&ring->mutex);
+  ring->pid = pid;
+  ring->group = g_strdup (group);
+
+  return ring;
+}
+
+static void
+cogl_trace_ring_free (CoglTraceRing *ring)
+{
+  unsigned int i;
+
+  for (i = 0; i < FLIGHT_RECORDER_N_EVENTS; i++)
+    g_free (ring->events[i].description);
+  g_free (ring->group);
+  g_mutex_clear (&ring->mutex);
+  g_free (ring);
+}
+
+static void
+cogl_trace_ring_add_event (CoglTraceRing *ring,
+                           uint64_t       begin_time,
+                           uint64_t       duration,
+                           const char    *name,
+                           const char    *description)
+{
+  CoglTraceEvent *event;
+
+  g_mutex_lock (&ring->mutex);
+  event = &ring->events[ring->next_event];
+  event->begin_time = begin_time;
+  event->duration = duration;
+  event->name = name;
+  g_free (event->description);
+  event->description = g_strdup (description);
+
+  ring->next_event = (ring->next_event + 1) % FLIGHT_RECORDER_N_EVENTS;
+  ring->n_events = MIN (ring->n_events + 1, FLIGHT_RECORDER_N_EVENTS);
+  g_mutex_unlock (&ring->mutex);
+}
+
+static void
+cogl_trace_ring_write (CoglTraceRing        *ring,
+                       SysprofCaptureWriter *writer)
+{
+  unsigned int first_event;
+  unsigned int i;
+
+  g_mutex_lock (&ring->mutex);
+  first_event = (ring->next_event + FLIGHT_RECORDER_N_EVENTS -
+                 ring->n_events) % FLIGHT_RECORDER_N_EVENTS;
+  for (i = 0; i < ring->n_events; i++)
+    {
+      CoglTraceEvent *event =
+        &ring->events[(first_event + i) % FLIGHT_RECORDER_N_EVENTS];
+
+      sysprof_capture_writer_add_mark (writer,
+                                       event->begin_time,
+                                       -1,
+                                       ring->pid,
+                                       event->duration,
+                                       ring->group,
+                                       event->name,
+                                       event->description);
+    }
+  g_mutex_unlock (&ring->mutex);
+}
+
+static CoglTraceContext *
+cogl_trace_context_new_flight_recorder (void)
+{
+  CoglTraceContext *context;
+
+  g_debug ("Initializing flight recorder trace context");
+
+  context = g_new0 (CoglTraceContext, 1);
+  context->rings =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) cogl_trace_ring_free);
+  g_atomic_ref_count_init (&context->ref_count);
+  return context;
+}
+
 static CoglTraceContext *
 cogl_trace_context_new (int         fd,
                         const char *filename)
@@ -107,6 +226,8 @@ cogl_trace_context_new (int         fd,
 
   context = g_new0 (CoglTraceContext, 1);
   context->writer = writer;
+  context->counters = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free, NULL);
   g_atomic_ref_count_init (&context->ref_count);
   return context;
 }
@@ -119,6 +240,8 @@ cogl_trace_context_unref (CoglTraceContext *trace_context)
       if (trace_context->writer)
         sysprof_capture_writer_flush (trace_context->writer);
       g_clear_pointer (&trace_context->writer, sysprof_capture_writer_unref);
+      g_clear_pointer (&trace_context->counters, g_hash_table_unref);
+      g_clear_pointer (&trace_context->rings, g_ptr_array_unref);
       g_free (trace_context);
     }
 }
@@ -133,6 +256,7 @@ cogl_trace_context_ref (CoglTraceContext *trace_context)
 static gboolean
 setup_trace_context (int          fd,
                      const char  *filename,
+                     gboolean     flight_recorder,
                      GError     **error)
 {
   g_autoptr (GMutexLocker) locker = NULL;
@@ -145,7 +269,10 @@ setup_trace_context (int          fd,
       return FALSE;
     }
 
-  cogl_trace_context = cogl_trace_context_new (fd, filename);
+  if (flight_recorder)
+    cogl_trace_context = cogl_trace_context_new_flight_recorder ();
+  else
+    cogl_trace_context = cogl_trace_context_new (fd, filename);
 
   if (!cogl_trace_context)
     {
@@ -173,6 +300,16 @@ cogl_trace_thread_context_new (const char       *group,
     group ? g_strdup (group) : g_strdup_printf ("t:%d", tid);
   thread_context->trace_context = cogl_trace_context_ref (trace_context);
 
+  if (trace_context->rings)
+    {
+      thread_context->ring = cogl_trace_ring_new (thread_context->pid,
+                                                  thread_context->group);
+
+      g_mutex_lock (&cogl_trace_mutex);
+      g_ptr_array_add (trace_context->rings, thread_context->ring);
+      g_mutex_unlock (&cogl_trace_mutex);
+    }
+
   return thread_context;
 }
 
@@ -229,14 +366,75 @@ gboolean
 cogl_start_tracing_with_path (const char  *filename,
                               GError     **error)
 {
-  return setup_trace_context (-1, filename, error);
+  return setup_trace_context (-1, filename, FALSE, error);
 }
 
 gboolean
 cogl_start_tracing_with_fd (int      fd,
                             GError **error)
 {
-  return setup_trace_context (fd, NULL, error);
+  return setup_trace_context (fd, NULL, FALSE, error);
+}
+
+/**
+ * cogl_start_flight_recorder:
+ * @error: return location for a #GError, or %NULL
+ *
+ * Starts tracing into an in-memory ring of the most recent events of each
+ * thread with tracing enabled, instead of into a capture file. The rings
+ * can be written out with cogl_dump_flight_recorder_to_fd() at any time,
+ * and are discarded with cogl_stop_tracing(). Counters are not recorded.
+ *
+ * Returns: %TRUE if the flight recorder was started
+ */
+gboolean
+cogl_start_flight_recorder (GError **error)
+{
+  return setup_trace_context (-1, NULL, TRUE, error);
+}
+
+/**
+ * cogl_dump_flight_recorder_to_fd:
+ * @fd: file descriptor to write the capture to
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes the events currently held by the flight recorder to @fd as a
+ * sysprof capture. On success, @fd is owned and closed by Cogl.
+ *
+ * Returns: %TRUE if the capture was written
+ */
+gboolean
+cogl_dump_flight_recorder_to_fd (int      fd,
+                                 GError **error)
+{
+  g_autoptr (GMutexLocker) locker = NULL;
+  SysprofCaptureWriter *writer;
+  unsigned int i;
+
+  locker = g_mutex_locker_new (&cogl_trace_mutex);
+  if (!cogl_trace_context || !cogl_trace_context->rings)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Flight recorder not running");
+      return FALSE;
+    }
+
+  writer = sysprof_capture_writer_new_from_fd (fd, BUFFER_LENGTH);
+  if (!writer)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to create capture writer");
+      return FALSE;
+    }
+
+  for (i = 0; i < cogl_trace_context->rings->len; i++)
+    cogl_trace_ring_write (g_ptr_array_index (cogl_trace_context->rings, i),
+                           writer);
+
+  sysprof_capture_writer_flush (writer);
+  sysprof_capture_writer_unref (writer);
+
+  return TRUE;
 }
 
 void
@@ -311,6 +509,16 @@ cogl_trace_end_with_description (CoglTraceHead *head,
   trace_thread_context = g_private_get (&cogl_trace_thread_data);
   trace_context = trace_thread_context->trace_context;
 
+  if (trace_thread_context->ring)
+    {
+      cogl_trace_ring_add_event (trace_thread_context->ring,
+                                 head->begin_time,
+                                 (uint64_t) end_time - head->begin_time,
+                                 head->name,
+                                 description);
+      return;
+    }
+
   g_mutex_lock (&cogl_trace_mutex);
   if (!sysprof_capture_writer_add_mark (trace_context->writer,
                                         head->begin_time,
@@ -342,20 +550,37 @@ void
 cogl_trace_mark (const char *name,
                  const char *description)
 {
-  SysprofTimeStamp time;
+  cogl_trace_add_span (name, description, g_get_monotonic_time () * 1000, 0);
+}
+
+/* Adds a span that was measured by other means than CoglTraceHead, e.g.
+ * on the GPU, with the begin time in the CLOCK_MONOTONIC domain. */
+void
+cogl_trace_add_span (const char *name,
+                     const char *description,
+                     int64_t     begin_time_ns,
+                     int64_t     duration_ns)
+{
   CoglTraceContext *trace_context;
   CoglTraceThreadContext *trace_thread_context;
 
-  time = g_get_monotonic_time () * 1000;
   trace_thread_context = g_private_get (&cogl_trace_thread_data);
   trace_context = trace_thread_context->trace_context;
 
+  if (trace_thread_context->ring)
+    {
+      cogl_trace_ring_add_event (trace_thread_context->ring,
+                                 begin_time_ns, duration_ns,
+                                 name, description);
+      return;
+    }
+
   g_mutex_lock (&cogl_trace_mutex);
   if (!sysprof_capture_writer_add_mark (trace_context->writer,
-                                        time,
+                                        begin_time_ns,
                                         trace_thread_context->cpu_id,
                                         trace_thread_context->pid,
-                                        0,
+                                        duration_ns,
                                         trace_thread_context->group,
                                         name,
                                         description))
@@ -370,6 +595,74 @@ cogl_trace_mark (const char *name,
   g_mutex_unlock (&cogl_trace_mutex);
 }
 
+static unsigned int
+ensure_counter (CoglTraceContext       *trace_context,
+                CoglTraceThreadContext *trace_thread_context,
+                SysprofTimeStamp        time,
+                const char             *category,
+                const char             *name)
+{
+  g_autofree char *key = NULL;
+  SysprofCaptureCounter counter = { 0 };
+  gpointer id;
+
+  key = g_strdup_printf ("%s/%s", category, name);
+  if (g_hash_table_lookup_extended (trace_context->counters, key, NULL, &id))
+    return GPOINTER_TO_UINT (id);
+
+  counter.id = sysprof_capture_writer_request_counter (trace_context->writer, 1);
+  counter.type = SYSPROF_CAPTURE_COUNTER_INT64;
+  g_strlcpy (counter.category, category, sizeof (counter.category));
+  g_strlcpy (counter.name, name, sizeof (counter.name));
+
+  sysprof_capture_writer_define_counters (trace_context->writer,
+                                          time,
+                                          trace_thread_context->cpu_id,
+                                          trace_thread_context->pid,
+                                          &counter, 1);
+
+  g_hash_table_insert (trace_context->counters,
+                       g_steal_pointer (&key),
+                       GUINT_TO_POINTER (counter.id));
+
+  return counter.id;
+}
+
+void
+cogl_trace_set_counter (const char *category,
+                        const char *name,
+                        int64_t     value)
+{
+  SysprofTimeStamp time;
+  CoglTraceContext *trace_context;
+  CoglTraceThreadContext *trace_thread_context;
+  SysprofCaptureCounterValue counter_value = { .v64 = value };
+  unsigned int id;
+
+  time = g_get_monotonic_time () * 1000;
+  trace_thread_context = g_private_get (&cogl_trace_thread_data);
+  trace_context = trace_thread_context->trace_context;
+
+  if (trace_thread_context->ring)
+    return;
+
+  g_mutex_lock (&cogl_trace_mutex);
+  id = ensure_counter (trace_context, trace_thread_context,
+                       time, category, name);
+  if (!sysprof_capture_writer_set_counters (trace_context->writer,
+                                            time,
+                                            trace_thread_context->cpu_id,
+                                            trace_thread_context->pid,
+                                            &id,
+                                            &counter_value,
+                                            1))
+    {
+      if (errno == EPIPE)
+        cogl_set_tracing_disabled_on_thread (g_main_context_get_thread_default ());
+    }
+  g_mutex_unlock (&cogl_trace_mutex);
+}
+
 void
 cogl_trace_describe (CoglTraceHead *head,
                      const char    *description)
@@ -408,6 +701,23 @@ cogl_start_tracing_with_fd (int      fd,
   return FALSE;
 }
 
+gboolean
+cogl_start_flight_recorder (GError **error)
+{
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+               "Tracing disabled at build time");
+  return FALSE;
+}
+
+gboolean
+cogl_dump_flight_recorder_to_fd (int      fd,
+                                 GError **error)
+{
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+               "Tracing disabled at build time");
+  return FALSE;
+}
+
 void
 cogl_stop_tracing (void)
 {
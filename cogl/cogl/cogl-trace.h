@@ -61,6 +61,13 @@ COGL_EXPORT
 gboolean cogl_start_tracing_with_fd (int      fd,
                                      GError **error);
 
+COGL_EXPORT
+gboolean cogl_start_flight_recorder (GError **error);
+
+COGL_EXPORT
+gboolean cogl_dump_flight_recorder_to_fd (int      fd,
+                                          GError **error);
+
 COGL_EXPORT
 void cogl_stop_tracing (void);
 
@@ -90,6 +97,17 @@ COGL_EXPORT void
 cogl_trace_mark (const char *name,
                  const char *description);
 
+COGL_EXPORT void
+cogl_trace_add_span (const char *name,
+                     const char *description,
+                     int64_t     begin_time_ns,
+                     int64_t     duration_ns);
+
+COGL_EXPORT void
+cogl_trace_set_counter (const char *category,
+                        const char *name,
+                        int64_t     value);
+
 static inline void
 cogl_auto_trace_end_helper (CoglTraceHead **head)
 {
@@ -147,6 +165,14 @@ cogl_is_tracing_enabled (void)
     } \
   G_STMT_END
 
+#define COGL_TRACE_COUNTER(category, name, value) \
+  G_STMT_START \
+    { \
+      if (cogl_is_tracing_enabled ()) \
+        cogl_trace_set_counter (category, name, value); \
+    } \
+  G_STMT_END
+
 #else /* HAVE_PROFILER */
 
 #include <stdio.h>
@@ -157,6 +183,7 @@ cogl_is_tracing_enabled (void)
 #define COGL_TRACE_SCOPED_ANCHOR(Name) (void) 0
 #define COGL_TRACE_BEGIN_ANCHORED(Name, name) (void) 0
 #define COGL_TRACE_MESSAGE(name, ...) (void) 0
+#define COGL_TRACE_COUNTER(category, name, value) (void) 0
 
 COGL_EXPORT
 gboolean cogl_start_tracing_with_path (const char  *filename,
@@ -166,6 +193,13 @@ COGL_EXPORT
 gboolean cogl_start_tracing_with_fd (int      fd,
                                      GError **error);
 
+COGL_EXPORT
+gboolean cogl_start_flight_recorder (GError **error);
+
+COGL_EXPORT
+gboolean cogl_dump_flight_recorder_to_fd (int      fd,
+                                          GError **error);
+
 COGL_EXPORT
 void cogl_stop_tracing (void);
 
@@ -75,6 +75,12 @@
 #ifndef GL_MAP_INVALIDATE_BUFFER_BIT
 #define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
 #endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
 
 void
 _cogl_buffer_gl_create (CoglBuffer *buffer)
@@ -381,6 +387,61 @@ _cogl_buffer_gl_set_data (CoglBuffer *buffer,
   return status;
 }
 
+void *
+_cogl_buffer_gl_map_persistent (CoglBuffer *buffer,
+                                GError **error)
+{
+  CoglContext *ctx = buffer->context;
+  GLbitfield gl_flags =
+    GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  GLenum gl_target;
+  void *data;
+
+  /* Immutable storage can only be allocated once so this has to be the
+   * first thing done with the buffer */
+  if (!ctx->glBufferStorage ||
+      !(buffer->flags & COGL_BUFFER_FLAG_BUFFER_OBJECT) ||
+      buffer->store_created)
+    {
+      g_set_error_literal (error,
+                           COGL_SYSTEM_ERROR,
+                           COGL_SYSTEM_ERROR_UNSUPPORTED,
+                           "Persistent buffer mappings are not supported");
+      return NULL;
+    }
+
+  _cogl_buffer_bind_no_create (buffer, buffer->last_target);
+
+  gl_target = convert_bind_target_to_gl_target (buffer->last_target);
+
+  /* Clear any GL errors */
+  _cogl_gl_util_clear_gl_errors (ctx);
+
+  ctx->glBufferStorage (gl_target, buffer->size, NULL, gl_flags);
+
+  if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+    {
+      _cogl_buffer_gl_unbind (buffer);
+      return NULL;
+    }
+
+  buffer->store_created = TRUE;
+
+  data = ctx->glMapBufferRange (gl_target, 0, buffer->size, gl_flags);
+
+  if (_cogl_gl_util_catch_out_of_memory (ctx, error))
+    data = NULL;
+  else if (!data)
+    g_set_error_literal (error,
+                         COGL_SYSTEM_ERROR,
+                         COGL_SYSTEM_ERROR_UNSUPPORTED,
+                         "Failed to map the buffer persistently");
+
+  _cogl_buffer_gl_unbind (buffer);
+
+  return data;
+}
+
 void *
 _cogl_buffer_gl_bind (CoglBuffer *buffer,
                       CoglBufferBindTarget target,
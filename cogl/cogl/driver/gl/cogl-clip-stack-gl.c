@@ -389,6 +389,63 @@ add_stencil_clip_primitive (CoglFramebuffer *framebuffer,
                                primitive);
 }
 
+static float
+edge_side (const float *a,
+           const float *b,
+           float        x,
+           float        y)
+{
+  return (b[0] - a[0]) * (y - a[1]) - (b[1] - a[1]) * (x - a[0]);
+}
+
+/* Checks whether every pixel center inside the scissor is strictly
+ * inside the transformed, convex quad of a rectangle entry. In that
+ * case drawing the rectangle into the stencil buffer wouldn't clip
+ * anything that the scissor doesn't already clip. */
+static gboolean
+rect_covers_scissor (CoglClipStackRect *rect,
+                     int                scissor_x0,
+                     int                scissor_y0,
+                     int                scissor_x1,
+                     int                scissor_y1)
+{
+  const float *corners = rect->window_corners;
+  float points[8] = {
+    scissor_x0 + 0.5f, scissor_y0 + 0.5f,
+    scissor_x1 - 0.5f, scissor_y0 + 0.5f,
+    scissor_x1 - 0.5f, scissor_y1 - 0.5f,
+    scissor_x0 + 0.5f, scissor_y1 - 0.5f,
+  };
+  float winding = 0.0f;
+  int i, j;
+
+  for (i = 0; i < 4; i++)
+    {
+      const float *a = corners + i * 2;
+      const float *b = corners + ((i + 1) % 4) * 2;
+      const float *c = corners + ((i + 2) % 4) * 2;
+      float turn = edge_side (a, b, c[0], c[1]);
+
+      /* A quad that isn't strictly convex, for example because of a
+       * perspective transform putting corners behind the viewer, is
+       * left to the stencil buffer */
+      if (turn == 0.0f ||
+          (winding != 0.0f && (turn > 0.0f) != (winding > 0.0f)))
+        return FALSE;
+      winding = turn;
+
+      for (j = 0; j < 4; j++)
+        {
+          float side = edge_side (a, b, points[j * 2], points[j * 2 + 1]);
+
+          if (side == 0.0f || (side > 0.0f) != (turn > 0.0f))
+            return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 void
 _cogl_clip_stack_gl_flush (CoglClipStack *stack,
                            CoglFramebuffer *framebuffer)
@@ -401,6 +458,9 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
   int scissor_y1;
   CoglClipStack *entry;
   int scissor_y_start;
+  int n_scissor_entries = 0;
+  int n_skipped_entries = 0;
+  int n_stencil_entries = 0;
 
   /* If we have already flushed this state then we don't need to do
      anything */
@@ -470,6 +530,14 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
                       scissor_x1 - scissor_x0,
                       scissor_y1 - scissor_y0));
 
+  /* Nothing can be drawn through an empty scissor so there is no
+     point in setting up the stencil for the rest of the entries */
+  if (scissor_x0 == scissor_x1)
+    {
+      COGL_NOTE (CLIPPING, "Clip stack flushed to an empty scissor");
+      return;
+    }
+
   /* Add all of the entries. This will end up adding them in the
      reverse order that they were specified but as all of the clips
      are intersecting it should work out the same regardless of the
@@ -485,6 +553,7 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
 
               COGL_NOTE (CLIPPING, "Adding stencil clip for primitive");
 
+              n_stencil_entries++;
               add_stencil_clip_primitive (framebuffer,
                                           primitive_entry->matrix_entry,
                                           primitive_entry->primitive,
@@ -504,11 +573,27 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
 
               /* We don't need to do anything extra if the clip for this
                  rectangle was entirely described by its scissor bounds */
-              if (!rect->can_be_scissor ||
-                  G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)))
+              if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)) &&
+                  rect->can_be_scissor)
+                {
+                  n_scissor_entries++;
+                }
+              /* Likewise if the other entries already narrowed the
+                 scissor down to something that is inside the
+                 transformed rectangle */
+              else if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)) &&
+                       rect_covers_scissor (rect,
+                                            scissor_x0, scissor_y0,
+                                            scissor_x1, scissor_y1))
+                {
+                  n_skipped_entries++;
+                }
+              else
                 {
                   COGL_NOTE (CLIPPING, "Adding stencil clip for rectangle");
 
+                  n_stencil_entries++;
+
                   add_stencil_clip_rectangle (framebuffer,
                                               rect->matrix_entry,
                                               rect->x0,
@@ -524,14 +609,34 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
             {
               CoglClipStackRegion *region = (CoglClipStackRegion *) entry;
 
+              MtkRectangle scissor_rect = {
+                scissor_x0, scissor_y0,
+                scissor_x1 - scissor_x0, scissor_y1 - scissor_y0,
+              };
+
               /* If nrectangles <= 1, it can be fully represented with the
                * scissor clip.
                */
-              if (mtk_region_num_rectangles (region->region) > 1 ||
-                  G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)))
+              if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)) &&
+                  mtk_region_num_rectangles (region->region) <= 1)
+                {
+                  n_scissor_entries++;
+                }
+              /* Nor does it need the stencil if the scissor is entirely
+               * inside the region */
+              else if (G_LIKELY (!COGL_DEBUG_ENABLED (COGL_DEBUG_STENCILLING)) &&
+                       mtk_region_contains_rectangle (region->region,
+                                                      &scissor_rect) ==
+                       MTK_REGION_OVERLAP_IN)
+                {
+                  n_skipped_entries++;
+                }
+              else
                 {
                   COGL_NOTE (CLIPPING, "Adding stencil clip for region");
 
+                  n_stencil_entries++;
+
                   add_stencil_clip_region (framebuffer, region->region,
                                            using_stencil_buffer);
                   using_stencil_buffer = TRUE;
@@ -540,4 +645,9 @@ _cogl_clip_stack_gl_flush (CoglClipStack *stack,
             }
         }
     }
+
+  COGL_NOTE (CLIPPING,
+             "Clip stack flushed with %i scissored, %i skipped and "
+             "%i stenciled entries",
+             n_scissor_entries, n_skipped_entries, n_stencil_entries);
 }
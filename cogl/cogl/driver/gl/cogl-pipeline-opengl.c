@@ -73,6 +73,7 @@ texture_unit_init (CoglContext *ctx,
   unit->gl_texture = 0;
   unit->gl_target = 0;
   unit->dirty_gl_texture = FALSE;
+  unit->gl_sampler = 0;
   unit->matrix_stack = cogl_matrix_stack_new (ctx);
 
   unit->layer = NULL;
@@ -246,6 +247,126 @@ blend_factor_uses_constant (GLenum blend_factor)
           blend_factor == GL_ONE_MINUS_CONSTANT_ALPHA);
 }
 
+static void
+flush_blend_state (CoglContext            *ctx,
+                   CoglPipelineBlendState *blend_state)
+{
+  CoglPipelineBlendState *cache = &ctx->blend_state_cache;
+
+  if ((blend_factor_uses_constant (blend_state->blend_src_factor_rgb) ||
+       blend_factor_uses_constant (blend_state->blend_src_factor_alpha) ||
+       blend_factor_uses_constant (blend_state->blend_dst_factor_rgb) ||
+       blend_factor_uses_constant (blend_state->blend_dst_factor_alpha)) &&
+      !cogl_color_equal (&cache->blend_constant, &blend_state->blend_constant))
+    {
+      float red =
+        cogl_color_get_red_float (&blend_state->blend_constant);
+      float green =
+        cogl_color_get_green_float (&blend_state->blend_constant);
+      float blue =
+        cogl_color_get_blue_float (&blend_state->blend_constant);
+      float alpha =
+        cogl_color_get_alpha_float (&blend_state->blend_constant);
+
+      GE (ctx, glBlendColor (red, green, blue, alpha));
+      cache->blend_constant = blend_state->blend_constant;
+    }
+
+  if (cache->blend_equation_rgb != blend_state->blend_equation_rgb ||
+      cache->blend_equation_alpha != blend_state->blend_equation_alpha)
+    {
+      GE (ctx, glBlendEquationSeparate (blend_state->blend_equation_rgb,
+                                        blend_state->blend_equation_alpha));
+      cache->blend_equation_rgb = blend_state->blend_equation_rgb;
+      cache->blend_equation_alpha = blend_state->blend_equation_alpha;
+    }
+
+  if (cache->blend_src_factor_rgb != blend_state->blend_src_factor_rgb ||
+      cache->blend_dst_factor_rgb != blend_state->blend_dst_factor_rgb ||
+      cache->blend_src_factor_alpha != blend_state->blend_src_factor_alpha ||
+      cache->blend_dst_factor_alpha != blend_state->blend_dst_factor_alpha)
+    {
+      GE (ctx, glBlendFuncSeparate (blend_state->blend_src_factor_rgb,
+                                    blend_state->blend_dst_factor_rgb,
+                                    blend_state->blend_src_factor_alpha,
+                                    blend_state->blend_dst_factor_alpha));
+      cache->blend_src_factor_rgb = blend_state->blend_src_factor_rgb;
+      cache->blend_dst_factor_rgb = blend_state->blend_dst_factor_rgb;
+      cache->blend_src_factor_alpha = blend_state->blend_src_factor_alpha;
+      cache->blend_dst_factor_alpha = blend_state->blend_dst_factor_alpha;
+    }
+}
+
+static void
+flush_cull_face_state (CoglContext               *ctx,
+                       CoglPipelineCullFaceState *cull_face_state)
+{
+  gboolean invert_winding;
+  GLenum cull_face_mode;
+  GLenum front_face;
+
+  if (cull_face_state->mode == COGL_PIPELINE_CULL_FACE_MODE_NONE)
+    {
+      if (ctx->cull_face_enabled_cache)
+        {
+          GE (ctx, glDisable (GL_CULL_FACE));
+          ctx->cull_face_enabled_cache = FALSE;
+        }
+      return;
+    }
+
+  if (!ctx->cull_face_enabled_cache)
+    {
+      GE (ctx, glEnable (GL_CULL_FACE));
+      ctx->cull_face_enabled_cache = TRUE;
+    }
+
+  switch (cull_face_state->mode)
+    {
+    case COGL_PIPELINE_CULL_FACE_MODE_FRONT:
+      cull_face_mode = GL_FRONT;
+      break;
+
+    case COGL_PIPELINE_CULL_FACE_MODE_BACK:
+      cull_face_mode = GL_BACK;
+      break;
+
+    case COGL_PIPELINE_CULL_FACE_MODE_BOTH:
+      cull_face_mode = GL_FRONT_AND_BACK;
+      break;
+
+    case COGL_PIPELINE_CULL_FACE_MODE_NONE:
+    default:
+      g_assert_not_reached ();
+    }
+
+  if (ctx->cull_face_mode_cache != cull_face_mode)
+    {
+      GE (ctx, glCullFace (cull_face_mode));
+      ctx->cull_face_mode_cache = cull_face_mode;
+    }
+
+  invert_winding = cogl_framebuffer_is_y_flipped (ctx->current_draw_buffer);
+
+  switch (cull_face_state->front_winding)
+    {
+    case COGL_WINDING_CLOCKWISE:
+      front_face = invert_winding ? GL_CCW : GL_CW;
+      break;
+
+    case COGL_WINDING_COUNTER_CLOCKWISE:
+    default:
+      front_face = invert_winding ? GL_CW : GL_CCW;
+      break;
+    }
+
+  if (ctx->front_face_cache != front_face)
+    {
+      GE (ctx, glFrontFace (front_face));
+      ctx->front_face_cache = front_face;
+    }
+}
+
 static void
 flush_depth_state (CoglContext *ctx,
                    CoglDepthState *depth_state)
@@ -315,32 +436,7 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       CoglPipelineBlendState *blend_state =
         &authority->big_state->blend_state;
 
-      if (blend_factor_uses_constant (blend_state->blend_src_factor_rgb) ||
-          blend_factor_uses_constant (blend_state
-                                      ->blend_src_factor_alpha) ||
-          blend_factor_uses_constant (blend_state->blend_dst_factor_rgb) ||
-          blend_factor_uses_constant (blend_state->blend_dst_factor_alpha))
-        {
-          float red =
-            cogl_color_get_red_float (&blend_state->blend_constant);
-          float green =
-            cogl_color_get_green_float (&blend_state->blend_constant);
-          float blue =
-            cogl_color_get_blue_float (&blend_state->blend_constant);
-          float alpha =
-            cogl_color_get_alpha_float (&blend_state->blend_constant);
-
-
-          GE (ctx, glBlendColor (red, green, blue, alpha));
-        }
-
-      GE (ctx, glBlendEquationSeparate (blend_state->blend_equation_rgb,
-                                        blend_state->blend_equation_alpha));
-
-      GE (ctx, glBlendFuncSeparate (blend_state->blend_src_factor_rgb,
-                                    blend_state->blend_dst_factor_rgb,
-                                    blend_state->blend_src_factor_alpha,
-                                    blend_state->blend_dst_factor_alpha));
+      flush_blend_state (ctx, blend_state);
     }
 
   if (pipelines_difference & COGL_PIPELINE_STATE_DEPTH)
@@ -359,46 +455,7 @@ _cogl_pipeline_flush_color_blend_alpha_depth_state (
       CoglPipelineCullFaceState *cull_face_state
         = &authority->big_state->cull_face_state;
 
-      if (cull_face_state->mode == COGL_PIPELINE_CULL_FACE_MODE_NONE)
-        GE( ctx, glDisable (GL_CULL_FACE) );
-      else
-        {
-          gboolean invert_winding;
-
-          GE( ctx, glEnable (GL_CULL_FACE) );
-
-          switch (cull_face_state->mode)
-            {
-            case COGL_PIPELINE_CULL_FACE_MODE_NONE:
-              g_assert_not_reached ();
-
-            case COGL_PIPELINE_CULL_FACE_MODE_FRONT:
-              GE( ctx, glCullFace (GL_FRONT) );
-              break;
-
-            case COGL_PIPELINE_CULL_FACE_MODE_BACK:
-              GE( ctx, glCullFace (GL_BACK) );
-              break;
-
-            case COGL_PIPELINE_CULL_FACE_MODE_BOTH:
-              GE( ctx, glCullFace (GL_FRONT_AND_BACK) );
-              break;
-            }
-
-          invert_winding =
-            cogl_framebuffer_is_y_flipped (ctx->current_draw_buffer);
-
-          switch (cull_face_state->front_winding)
-            {
-            case COGL_WINDING_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CCW : GL_CW) );
-              break;
-
-            case COGL_WINDING_COUNTER_CLOCKWISE:
-              GE( ctx, glFrontFace (invert_winding ? GL_CW : GL_CCW) );
-              break;
-            }
-        }
+      flush_cull_face_state (ctx, cull_face_state);
     }
 
   if (pipeline->real_blend_enable != ctx->gl_blend_enable_cache)
@@ -560,7 +617,11 @@ flush_layers_common_gl_state_cb (CoglPipelineLayer *layer, void *user_data)
 
       sampler_state = _cogl_pipeline_layer_get_sampler_state (layer);
 
-      GE( ctx, glBindSampler (unit_index, sampler_state->sampler_object) );
+      if (unit->gl_sampler != sampler_state->sampler_object)
+        {
+          GE( ctx, glBindSampler (unit_index, sampler_state->sampler_object) );
+          unit->gl_sampler = sampler_state->sampler_object;
+        }
     }
 
   g_object_ref (layer);
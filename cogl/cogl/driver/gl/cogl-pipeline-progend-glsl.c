@@ -33,6 +33,9 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <math.h>
 #include <string.h>
 
 #include "cogl/cogl-util.h"
@@ -59,10 +62,12 @@
 
 typedef void (* UpdateUniformFunc) (CoglPipeline *pipeline,
                                     int uniform_location,
+                                    float *flushed_value,
                                     void *getter_func);
 
 static void update_float_uniform (CoglPipeline *pipeline,
                                   int uniform_location,
+                                  float *flushed_value,
                                   void *getter_func);
 
 typedef struct
@@ -93,6 +98,14 @@ typedef struct _UnitState
   GLint combine_constant_uniform;
 
   GLint texture_matrix_uniform;
+
+  /* The values last uploaded to the uniforms above so that switching
+     between pipelines sharing the program doesn't upload them again
+     when they haven't changed */
+  unsigned int flushed_combine_constant_valid:1;
+  unsigned int flushed_texture_matrix_valid:1;
+  float flushed_combine_constant[4];
+  float flushed_texture_matrix[16];
 } UnitState;
 
 typedef struct
@@ -107,6 +120,9 @@ typedef struct
 
   unsigned long dirty_builtin_uniforms;
   GLint builtin_uniform_locations[G_N_ELEMENTS (builtin_uniforms)];
+  /* Values last uploaded for the builtin uniforms. These are reset to
+     NaN when the program is relinked so they never compare equal */
+  float flushed_builtin_uniform_values[G_N_ELEMENTS (builtin_uniforms)];
 
   GLint modelview_uniform;
   GLint projection_uniform;
@@ -337,12 +353,12 @@ dirty_program_state (CoglPipeline *pipeline)
                            NULL);
 }
 
-static void
+static gboolean
 link_program (GLint gl_program)
 {
   GLint link_status;
 
-  _COGL_GET_CONTEXT (ctx, NO_RETVAL);
+  _COGL_GET_CONTEXT (ctx, FALSE);
 
   GE( ctx, glLinkProgram (gl_program) );
 
@@ -366,6 +382,148 @@ link_program (GLint gl_program)
 
       g_free (log);
     }
+
+  return link_status;
+}
+
+/* Linked programs are stored on disk as this header followed by the
+ * binary returned by the driver.
+ */
+#define PROGRAM_BINARY_MAGIC "CoglPrg1"
+
+typedef struct
+{
+  char magic[8];
+  uint32_t format;
+} ProgramBinaryHeader;
+
+static char *
+get_program_cache_path (CoglContext  *ctx,
+                        const GLuint *shaders,
+                        int           n_shaders)
+{
+  const GLenum driver_strings[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+  g_autoptr (GChecksum) checksum = NULL;
+  int i;
+
+  if (!ctx->program_cache_dir ||
+      !_cogl_has_private_feature (ctx, COGL_PRIVATE_FEATURE_PROGRAM_BINARY) ||
+      G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES)))
+    return NULL;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+
+  /* Binaries are only valid for the driver that created them */
+  for (i = 0; i < G_N_ELEMENTS (driver_strings); i++)
+    {
+      const char *str = (const char *) ctx->glGetString (driver_strings[i]);
+
+      if (!str)
+        return NULL;
+
+      g_checksum_update (checksum, (const guchar *) str, strlen (str) + 1);
+    }
+
+  for (i = 0; i < n_shaders; i++)
+    {
+      g_autofree char *source = NULL;
+      GLint source_length = 0;
+
+      GE( ctx, glGetShaderiv (shaders[i], GL_SHADER_SOURCE_LENGTH,
+                              &source_length) );
+      if (source_length <= 0)
+        return NULL;
+
+      source = g_malloc (source_length);
+      GE( ctx, glGetShaderSource (shaders[i], source_length, NULL, source) );
+
+      g_checksum_update (checksum, (const guchar *) source, source_length);
+    }
+
+  return g_build_filename (ctx->program_cache_dir,
+                           g_checksum_get_string (checksum),
+                           NULL);
+}
+
+static gboolean
+load_program_binary (CoglContext *ctx,
+                     GLuint       gl_program,
+                     const char  *path)
+{
+  g_autofree char *contents = NULL;
+  ProgramBinaryHeader header;
+  GLint link_status = GL_FALSE;
+  gsize length;
+
+  if (!g_file_get_contents (path, &contents, &length, NULL))
+    return FALSE;
+
+  if (length <= sizeof (header))
+    goto discard;
+
+  memcpy (&header, contents, sizeof (header));
+  if (memcmp (header.magic, PROGRAM_BINARY_MAGIC, sizeof (header.magic)) != 0)
+    goto discard;
+
+  _cogl_gl_util_clear_gl_errors (ctx);
+  ctx->glProgramBinary (gl_program,
+                        header.format,
+                        contents + sizeof (header),
+                        length - sizeof (header));
+  if (_cogl_gl_util_get_error (ctx) != GL_NO_ERROR)
+    goto discard;
+
+  GE( ctx, glGetProgramiv (gl_program, GL_LINK_STATUS, &link_status) );
+  if (!link_status)
+    goto discard;
+
+  return TRUE;
+
+discard:
+  /* Most likely made stale by a driver update; link the program again
+   * and replace it */
+  g_unlink (path);
+  return FALSE;
+}
+
+static void
+save_program_binary (CoglContext *ctx,
+                     GLuint       gl_program,
+                     const char  *path)
+{
+  g_autoptr (GError) error = NULL;
+  g_autofree char *contents = NULL;
+  ProgramBinaryHeader header;
+  GLint binary_length = 0;
+  GLsizei out_length = 0;
+  GLenum format = 0;
+
+  GE( ctx, glGetProgramiv (gl_program, GL_PROGRAM_BINARY_LENGTH,
+                           &binary_length) );
+  if (binary_length <= 0)
+    return;
+
+  contents = g_malloc (sizeof (header) + binary_length);
+  GE( ctx, glGetProgramBinary (gl_program, binary_length, &out_length,
+                               &format, contents + sizeof (header)) );
+  if (out_length <= 0)
+    return;
+
+  memcpy (header.magic, PROGRAM_BINARY_MAGIC, sizeof (header.magic));
+  header.format = format;
+  memcpy (contents, &header, sizeof (header));
+
+  if (g_mkdir_with_parents (ctx->program_cache_dir, 0700) != 0)
+    {
+      g_warning ("Failed to create program cache directory %s: %s",
+                 ctx->program_cache_dir, g_strerror (errno));
+      return;
+    }
+
+  if (!g_file_set_contents_full (path, contents, sizeof (header) + out_length,
+                                 G_FILE_SET_CONTENTS_CONSISTENT, 0600,
+                                 &error))
+    g_warning ("Failed to store program binary: %s", error->message);
 }
 
 typedef struct
@@ -425,6 +583,11 @@ get_uniform_cb (CoglPipeline *pipeline,
 
   unit_state->texture_matrix_uniform = uniform_location;
 
+  /* Relinking resets the uniforms so anything we previously flushed
+     is lost */
+  unit_state->flushed_combine_constant_valid = FALSE;
+  unit_state->flushed_texture_matrix_valid = FALSE;
+
   state->unit++;
 
   return TRUE;
@@ -448,8 +611,18 @@ update_constants_cb (CoglPipeline *pipeline,
       _cogl_pipeline_get_layer_combine_constant (pipeline,
                                                  layer_index,
                                                  constant);
-      GE (ctx, glUniform4fv (unit_state->combine_constant_uniform,
-                             1, constant));
+
+      if (!unit_state->flushed_combine_constant_valid ||
+          memcmp (unit_state->flushed_combine_constant,
+                  constant, sizeof (constant)) != 0)
+        {
+          GE (ctx, glUniform4fv (unit_state->combine_constant_uniform,
+                                 1, constant));
+          memcpy (unit_state->flushed_combine_constant,
+                  constant, sizeof (constant));
+          unit_state->flushed_combine_constant_valid = TRUE;
+        }
+
       unit_state->dirty_combine_constant = FALSE;
     }
 
@@ -461,8 +634,18 @@ update_constants_cb (CoglPipeline *pipeline,
 
       matrix = _cogl_pipeline_get_layer_matrix (pipeline, layer_index);
       graphene_matrix_to_float (matrix, array);
-      GE (ctx, glUniformMatrix4fv (unit_state->texture_matrix_uniform,
-                                   1, FALSE, array));
+
+      if (!unit_state->flushed_texture_matrix_valid ||
+          memcmp (unit_state->flushed_texture_matrix,
+                  array, sizeof (array)) != 0)
+        {
+          GE (ctx, glUniformMatrix4fv (unit_state->texture_matrix_uniform,
+                                       1, FALSE, array));
+          memcpy (unit_state->flushed_texture_matrix,
+                  array, sizeof (array));
+          unit_state->flushed_texture_matrix_valid = TRUE;
+        }
+
       unit_state->dirty_texture_matrix = FALSE;
     }
 
@@ -486,6 +669,8 @@ update_builtin_uniforms (CoglContext *context,
       builtin_uniforms[i].update_func (pipeline,
                                        program_state
                                        ->builtin_uniform_locations[i],
+                                       &program_state
+                                       ->flushed_builtin_uniform_values[i],
                                        builtin_uniforms[i].getter_func);
 
   program_state->dirty_builtin_uniforms = 0;
@@ -811,11 +996,15 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
 
   if (program_state->program == 0)
     {
+      g_autoptr (GArray) shaders = NULL;
+      g_autofree char *cache_path = NULL;
       GLuint backend_shader;
       GSList *l;
 
       GE_RET( program_state->program, ctx, glCreateProgram () );
 
+      shaders = g_array_new (FALSE, FALSE, sizeof (GLuint));
+
       /* Attach all of the shader from the user program */
       if (user_program)
         {
@@ -827,6 +1016,7 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
 
               GE( ctx, glAttachShader (program_state->program,
                                        shader->gl_handle) );
+              g_array_append_val (shaders, shader->gl_handle);
             }
 
           program_state->user_program_age = user_program->age;
@@ -834,9 +1024,15 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
 
       /* Attach any shaders from the GLSL backends */
       if ((backend_shader = _cogl_pipeline_fragend_glsl_get_shader (pipeline)))
-        GE( ctx, glAttachShader (program_state->program, backend_shader) );
+        {
+          GE( ctx, glAttachShader (program_state->program, backend_shader) );
+          g_array_append_val (shaders, backend_shader);
+        }
       if ((backend_shader = _cogl_pipeline_vertend_glsl_get_shader (pipeline)))
-        GE( ctx, glAttachShader (program_state->program, backend_shader) );
+        {
+          GE( ctx, glAttachShader (program_state->program, backend_shader) );
+          g_array_append_val (shaders, backend_shader);
+        }
 
       /* XXX: OpenGL as a special case requires the vertex position to
        * be bound to generic attribute 0 so for simplicity we
@@ -845,7 +1041,21 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       GE( ctx, glBindAttribLocation (program_state->program,
                                      0, "cogl_position_in"));
 
-      link_program (program_state->program);
+      cache_path = get_program_cache_path (ctx,
+                                           (const GLuint *) shaders->data,
+                                           shaders->len);
+
+      if (!cache_path ||
+          !load_program_binary (ctx, program_state->program, cache_path))
+        {
+          if (cache_path && ctx->glProgramParameteri)
+            GE( ctx, glProgramParameteri (program_state->program,
+                                          GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                          GL_TRUE) );
+
+          if (link_program (program_state->program) && cache_path)
+            save_program_binary (ctx, program_state->program, cache_path);
+        }
 
       program_changed = TRUE;
     }
@@ -896,9 +1106,12 @@ _cogl_pipeline_progend_glsl_end (CoglPipeline *pipeline,
       clear_flushed_matrix_stacks (program_state);
 
       for (i = 0; i < G_N_ELEMENTS (builtin_uniforms); i++)
-        GE_RET( program_state->builtin_uniform_locations[i], ctx,
-                glGetUniformLocation (gl_program,
-                                      builtin_uniforms[i].uniform_name) );
+        {
+          GE_RET( program_state->builtin_uniform_locations[i], ctx,
+                  glGetUniformLocation (gl_program,
+                                        builtin_uniforms[i].uniform_name) );
+          program_state->flushed_builtin_uniform_values[i] = NAN;
+        }
 
       GE_RET( program_state->modelview_uniform, ctx,
               glGetUniformLocation (gl_program,
@@ -1148,6 +1361,7 @@ _cogl_pipeline_progend_glsl_pre_paint (CoglPipeline *pipeline,
 static void
 update_float_uniform (CoglPipeline *pipeline,
                       int uniform_location,
+                      float *flushed_value,
                       void *getter_func)
 {
   float (* float_getter_func) (CoglPipeline *) = getter_func;
@@ -1156,7 +1370,14 @@ update_float_uniform (CoglPipeline *pipeline,
   _COGL_GET_CONTEXT (ctx, NO_RETVAL);
 
   value = float_getter_func (pipeline);
+
+  /* A pipeline sharing the program with the last one will usually
+     have the same value so there is no need to upload it again */
+  if (value == *flushed_value)
+    return;
+
   GE( ctx, glUniform1f (uniform_location, value) );
+  *flushed_value = value;
 }
 
 const CoglPipelineProgend _cogl_pipeline_glsl_progend =
@@ -157,9 +157,19 @@ int64_t
 cogl_gl_timestamp_query_get_time_ns (CoglContext        *context,
                                      CoglTimestampQuery *query);
 
+gboolean
+cogl_gl_timestamp_query_is_available (CoglContext        *context,
+                                      CoglTimestampQuery *query);
+
 int64_t
 cogl_gl_get_gpu_time_ns (CoglContext *context);
 
+int
+cogl_gl_get_max_texture_size (CoglContext *context);
+
+gboolean
+_cogl_gl_util_has_program_binary (CoglContext *context);
+
 #ifndef GL_FRAMEBUFFER
 #define GL_FRAMEBUFFER		0x8D40
 #endif
@@ -249,7 +259,20 @@ cogl_gl_get_gpu_time_ns (CoglContext *context);
 #ifndef GL_QUERY_RESULT
 #define GL_QUERY_RESULT 0x8866
 #endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
 
 #ifndef GL_TEXTURE_LOD_BIAS
 #define GL_TEXTURE_LOD_BIAS 0x8501
 #endif
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
@@ -552,6 +552,19 @@ cogl_gl_timestamp_query_get_time_ns (CoglContext        *context,
   return query_time_ns;
 }
 
+gboolean
+cogl_gl_timestamp_query_is_available (CoglContext        *context,
+                                      CoglTimestampQuery *query)
+{
+  int64_t available = 0;
+
+  GE (context, glGetQueryObjecti64v (query->id,
+                                     GL_QUERY_RESULT_AVAILABLE,
+                                     &available));
+
+  return available != 0;
+}
+
 int64_t
 cogl_gl_get_gpu_time_ns (CoglContext *context)
 {
@@ -564,3 +577,31 @@ cogl_gl_get_gpu_time_ns (CoglContext *context)
   GE (context, glGetInteger64v (GL_TIMESTAMP, &gpu_time_ns));
   return gpu_time_ns;
 }
+
+int
+cogl_gl_get_max_texture_size (CoglContext *context)
+{
+  if (G_UNLIKELY (context->max_texture_size == -1))
+    {
+      GLint max_size = 0;
+
+      GE (context, glGetIntegerv (GL_MAX_TEXTURE_SIZE, &max_size));
+      context->max_texture_size = max_size;
+    }
+
+  return context->max_texture_size;
+}
+
+gboolean
+_cogl_gl_util_has_program_binary (CoglContext *context)
+{
+  GLint n_formats = 0;
+
+  if (!context->glGetProgramBinary || !context->glProgramBinary)
+    return FALSE;
+
+  /* Drivers may expose the entry points without supporting any format */
+  GE (context, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats));
+
+  return n_formats > 0;
+}
@@ -509,6 +509,14 @@ _cogl_driver_update_features (CoglContext *ctx,
     COGL_FLAGS_SET (private_features,
                     COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS, TRUE);
 
+  if (_cogl_gl_util_has_program_binary (ctx))
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+
+  if (ctx->glBufferStorage && ctx->glMapBufferRange && ctx->glFenceSync)
+    COGL_FLAGS_SET (private_features,
+                    COGL_PRIVATE_FEATURE_BUFFER_STORAGE, TRUE);
+
   if (COGL_CHECK_GL_VERSION (gl_major, gl_minor, 3, 3) ||
       _cogl_check_extension ("GL_ARB_texture_swizzle", gl_extensions) ||
       _cogl_check_extension ("GL_EXT_texture_swizzle", gl_extensions))
@@ -590,11 +598,14 @@ _cogl_driver_gl =
     _cogl_buffer_gl_map_range,
     _cogl_buffer_gl_unmap,
     _cogl_buffer_gl_set_data,
+    _cogl_buffer_gl_map_persistent,
     _cogl_sampler_gl_init,
     _cogl_sampler_gl_free,
     _cogl_gl_set_uniform, /* XXX name is weird... */
     cogl_gl_create_timestamp_query,
     cogl_gl_free_timestamp_query,
     cogl_gl_timestamp_query_get_time_ns,
+    cogl_gl_timestamp_query_is_available,
     cogl_gl_get_gpu_time_ns,
+    cogl_gl_get_max_texture_size,
   };
@@ -655,6 +655,15 @@ _cogl_driver_update_features (CoglContext *context,
   if (context->glGenSamplers)
     COGL_FLAGS_SET (private_features, COGL_PRIVATE_FEATURE_SAMPLER_OBJECTS, TRUE);
 
+  if (_cogl_gl_util_has_program_binary (context))
+    COGL_FLAGS_SET (private_features, COGL_PRIVATE_FEATURE_PROGRAM_BINARY, TRUE);
+
+#ifdef GL_ARB_sync
+  if (context->glBufferStorage && context->glMapBufferRange &&
+      context->glFenceSync)
+    COGL_FLAGS_SET (private_features, COGL_PRIVATE_FEATURE_BUFFER_STORAGE, TRUE);
+#endif
+
   if (context->glBlitFramebuffer)
     COGL_FLAGS_SET (context->features,
                     COGL_FEATURE_ID_BLIT_FRAMEBUFFER, TRUE);
@@ -794,11 +803,14 @@ _cogl_driver_gles =
     _cogl_buffer_gl_map_range,
     _cogl_buffer_gl_unmap,
     _cogl_buffer_gl_set_data,
+    _cogl_buffer_gl_map_persistent,
     _cogl_sampler_gl_init,
     _cogl_sampler_gl_free,
     _cogl_gl_set_uniform,
     cogl_gl_create_timestamp_query,
     cogl_gl_free_timestamp_query,
     cogl_gl_timestamp_query_get_time_ns,
+    cogl_gl_timestamp_query_is_available,
     cogl_gl_get_gpu_time_ns,
+    cogl_gl_get_max_texture_size,
   };
@@ -184,6 +184,35 @@ COGL_EXT_FUNCTION (void, glSamplerParameterf,
                     GLfloat param))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (get_program_binary, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0OES\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glGetProgramBinary,
+                   (GLuint program,
+                    GLsizei bufSize,
+                    GLsizei *length,
+                    GLenum *binaryFormat,
+                    void *binary))
+COGL_EXT_FUNCTION (void, glProgramBinary,
+                   (GLuint program,
+                    GLenum binaryFormat,
+                    const void *binary,
+                    GLsizei length))
+COGL_EXT_END ()
+
+/* Not part of GL_OES_get_program_binary; there binaries are always
+ * retrievable */
+COGL_EXT_BEGIN (program_parameteri, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glProgramParameteri,
+                   (GLuint program,
+                    GLenum pname,
+                    GLint value))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (only_gl3, 3, 0,
                 COGL_EXT_IN_GLES3,
                 "\0",
@@ -228,6 +257,17 @@ COGL_EXT_FUNCTION (void, glDeleteSync,
 COGL_EXT_END ()
 #endif
 
+COGL_EXT_BEGIN (buffer_storage, 4, 4,
+                0,
+                "ARB:\0EXT\0",
+                "buffer_storage\0")
+COGL_EXT_FUNCTION (void, glBufferStorage,
+                   (GLenum target,
+                    GLsizeiptr size,
+                    const GLvoid *data,
+                    GLbitfield flags))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (sync_get_int64, 3, 2,
                 0,
                 "ARB:\0",
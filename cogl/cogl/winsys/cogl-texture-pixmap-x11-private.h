@@ -53,6 +53,10 @@ struct _CoglDamageRectangle
   unsigned int y2;
 };
 
+/* The most damaged rectangles tracked individually, before falling back
+ * to updating their bounding box */
+#define COGL_TEXTURE_PIXMAP_X11_MAX_DAMAGE_PARTS 16
+
 /* For stereo, there are a pair of textures, but we want to share most
  * other state (the GLXPixmap, visual, etc.) The way we do this is that
  * the left-eye texture has all the state (there is in fact, no internal
@@ -88,6 +92,9 @@ struct _CoglTexturePixmapX11
   CoglTexturePixmapX11ReportLevel damage_report_level;
   gboolean damage_owned;
   CoglDamageRectangle damage_rect;
+  /* The rectangles making up damage_rect, or -1 if there were too many */
+  CoglDamageRectangle damage_parts[COGL_TEXTURE_PIXMAP_X11_MAX_DAMAGE_PARTS];
+  int n_damage_parts;
 
   void *winsys;
 
@@ -124,6 +124,44 @@ cogl_damage_rectangle_union (CoglDamageRectangle *damage_rect,
     }
 }
 
+static void
+add_damage (CoglTexturePixmapX11 *tex_pixmap,
+            int                   x,
+            int                   y,
+            int                   width,
+            int                   height)
+{
+  if (width <= 0 || height <= 0)
+    return;
+
+  cogl_damage_rectangle_union (&tex_pixmap->damage_rect,
+                               x, y, width, height);
+
+  if (tex_pixmap->n_damage_parts < 0)
+    return;
+
+  if (tex_pixmap->n_damage_parts == COGL_TEXTURE_PIXMAP_X11_MAX_DAMAGE_PARTS)
+    {
+      tex_pixmap->n_damage_parts = -1;
+      return;
+    }
+
+  tex_pixmap->damage_parts[tex_pixmap->n_damage_parts++] =
+    (CoglDamageRectangle) {
+      .x1 = x,
+      .y1 = y,
+      .x2 = x + width,
+      .y2 = y + height,
+    };
+}
+
+static void
+clear_damage (CoglTexturePixmapX11 *tex_pixmap)
+{
+  memset (&tex_pixmap->damage_rect, 0, sizeof (CoglDamageRectangle));
+  tex_pixmap->n_damage_parts = 0;
+}
+
 static void
 process_damage_event (CoglTexturePixmapX11 *tex_pixmap,
                       XDamageNotifyEvent *damage_event)
@@ -186,7 +224,7 @@ process_damage_event (CoglTexturePixmapX11 *tex_pixmap,
       XRectangle *r_damage;
 
       /* We need to extract the damage region so we can get the
-         bounding box */
+         bounding box, and the rectangles in it to only fetch those */
 
       parts = XFixesCreateRegion (display, 0, 0);
       XDamageSubtract (display, tex_pixmap->damage, None, parts);
@@ -194,11 +232,31 @@ process_damage_event (CoglTexturePixmapX11 *tex_pixmap,
                                              parts,
                                              &r_count,
                                              &r_bounds);
-      cogl_damage_rectangle_union (&tex_pixmap->damage_rect,
-                                   r_bounds.x,
-                                   r_bounds.y,
-                                   r_bounds.width,
-                                   r_bounds.height);
+      if (r_damage &&
+          tex_pixmap->n_damage_parts >= 0 &&
+          tex_pixmap->n_damage_parts + r_count <=
+          COGL_TEXTURE_PIXMAP_X11_MAX_DAMAGE_PARTS)
+        {
+          int i;
+
+          for (i = 0; i < r_count; i++)
+            {
+              add_damage (tex_pixmap,
+                          r_damage[i].x,
+                          r_damage[i].y,
+                          r_damage[i].width,
+                          r_damage[i].height);
+            }
+        }
+      else if (r_count > 0)
+        {
+          tex_pixmap->n_damage_parts = -1;
+          cogl_damage_rectangle_union (&tex_pixmap->damage_rect,
+                                       r_bounds.x,
+                                       r_bounds.y,
+                                       r_bounds.width,
+                                       r_bounds.height);
+        }
       if (r_damage)
         XFree (r_damage);
 
@@ -211,11 +269,11 @@ process_damage_event (CoglTexturePixmapX11 *tex_pixmap,
            don't care what the region actually was */
         XDamageSubtract (display, tex_pixmap->damage, None, None);
 
-      cogl_damage_rectangle_union (&tex_pixmap->damage_rect,
-                                   damage_event->area.x,
-                                   damage_event->area.y,
-                                   damage_event->area.width,
-                                   damage_event->area.height);
+      add_damage (tex_pixmap,
+                  damage_event->area.x,
+                  damage_event->area.y,
+                  damage_event->area.width,
+                  damage_event->area.height);
     }
 
   if (tex_pixmap->winsys)
@@ -448,24 +506,104 @@ try_alloc_shm (CoglTexturePixmapX11 *tex_pixmap)
   tex_pixmap->shm_info.shmid = -1;
 }
 
+static void
+upload_image_area (CoglTexturePixmapX11 *tex_pixmap,
+                   XImage               *image,
+                   int                   src_x,
+                   int                   src_y,
+                   int                   x,
+                   int                   y,
+                   int                   width,
+                   int                   height)
+{
+  Visual *visual = tex_pixmap->visual;
+  CoglPixelFormat image_format;
+  int bpp;
+  int offset;
+  GError *ignore = NULL;
+
+  image_format =
+    _cogl_util_pixel_format_from_masks (visual->red_mask,
+                                        visual->green_mask,
+                                        visual->blue_mask,
+                                        image->depth,
+                                        image->bits_per_pixel,
+                                        image->byte_order == LSBFirst);
+  g_return_if_fail (cogl_pixel_format_get_n_planes (image_format) == 1);
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (image_format, 0);
+  offset = image->bytes_per_line * src_y + bpp * src_x;
+
+  _cogl_texture_set_region (tex_pixmap->tex,
+                            width,
+                            height,
+                            image_format,
+                            image->bytes_per_line,
+                            ((const uint8_t *) image->data) + offset,
+                            x, y,
+                            0, /* level */
+                            &ignore);
+}
+
+static void
+update_image_texture_area (CoglTexturePixmapX11 *tex_pixmap,
+                           Display              *display,
+                           int                   x,
+                           int                   y,
+                           int                   width,
+                           int                   height)
+{
+  XImage *image;
+
+  if (tex_pixmap->shm_info.shmid != -1)
+    {
+      /* Create a temporary image using the beginning of the
+         shared memory segment and the right size for the region
+         we want to update. We need to reallocate the XImage every
+         time because there is no XShmGetSubImage. */
+      image = XShmCreateImage (display,
+                               tex_pixmap->visual,
+                               tex_pixmap->depth,
+                               ZPixmap,
+                               NULL,
+                               &tex_pixmap->shm_info,
+                               width,
+                               height);
+      image->data = tex_pixmap->shm_info.shmaddr;
+
+      XShmGetImage (display, tex_pixmap->pixmap, image, x, y, AllPlanes);
+
+      upload_image_area (tex_pixmap, image, 0, 0, x, y, width, height);
+
+      /* The XImage is a temporary one with no data allocated so we can
+         just XFree it */
+      XFree (image);
+    }
+  else
+    {
+      image = tex_pixmap->image;
+
+      XGetSubImage (display,
+                    tex_pixmap->pixmap,
+                    x, y, width, height,
+                    AllPlanes, ZPixmap,
+                    image,
+                    x, y);
+
+      upload_image_area (tex_pixmap, image, x, y, x, y, width, height);
+    }
+}
+
 static void
 _cogl_texture_pixmap_x11_update_image_texture (CoglTexturePixmapX11 *tex_pixmap)
 {
   CoglTexture *tex = COGL_TEXTURE (tex_pixmap);
   Display *display;
-  Visual *visual;
   CoglContext *ctx;
-  CoglPixelFormat image_format;
-  XImage *image;
-  int src_x, src_y;
   int x, y, width, height;
-  int bpp;
-  int offset;
-  GError *ignore = NULL;
 
   ctx = cogl_texture_get_context (COGL_TEXTURE (tex_pixmap));
   display = cogl_xlib_renderer_get_display (ctx->display->renderer);
-  visual = tex_pixmap->visual;
 
   /* If the damage region is empty then there's nothing to do */
   if (tex_pixmap->damage_rect.x2 == tex_pixmap->damage_rect.x1)
@@ -493,101 +631,65 @@ _cogl_texture_pixmap_x11_update_image_texture (CoglTexturePixmapX11 *tex_pixmap)
                                                  texture_format);
     }
 
-  if (tex_pixmap->image == NULL)
+  /* If we also haven't got a shm segment then this must be the
+     first time we've tried to update, so lets try allocating shm
+     first */
+  if (tex_pixmap->image == NULL && tex_pixmap->shm_info.shmid == -1)
+    try_alloc_shm (tex_pixmap);
+
+  if (tex_pixmap->image == NULL && tex_pixmap->shm_info.shmid == -1)
+    {
+      COGL_NOTE (TEXTURE_PIXMAP, "Updating %p using XGetImage", tex_pixmap);
+
+      /* We'll fallback to using a regular XImage. We'll download
+         the entire area instead of a sub region because presumably
+         if this is the first update then the entire pixmap is
+         needed anyway and it saves trying to manually allocate an
+         XImage at the right size */
+      tex_pixmap->image = XGetImage (display,
+                                     tex_pixmap->pixmap,
+                                     0, 0,
+                                     cogl_texture_get_width (tex),
+                                     cogl_texture_get_height (tex),
+                                     AllPlanes, ZPixmap);
+
+      upload_image_area (tex_pixmap, tex_pixmap->image,
+                         x, y, x, y, width, height);
+    }
+  else if (tex_pixmap->n_damage_parts > 0)
     {
-      /* If we also haven't got a shm segment then this must be the
-         first time we've tried to update, so lets try allocating shm
-         first */
-      if (tex_pixmap->shm_info.shmid == -1)
-        try_alloc_shm (tex_pixmap);
+      int i;
 
-      if (tex_pixmap->shm_info.shmid == -1)
-        {
-          COGL_NOTE (TEXTURE_PIXMAP, "Updating %p using XGetImage", tex_pixmap);
-
-          /* We'll fallback to using a regular XImage. We'll download
-             the entire area instead of a sub region because presumably
-             if this is the first update then the entire pixmap is
-             needed anyway and it saves trying to manually allocate an
-             XImage at the right size */
-          tex_pixmap->image = XGetImage (display,
-                                         tex_pixmap->pixmap,
-                                         0, 0,
-                                         cogl_texture_get_width (tex),
-                                         cogl_texture_get_height (tex),
-                                         AllPlanes, ZPixmap);
-          image = tex_pixmap->image;
-          src_x = x;
-          src_y = y;
-        }
-      else
+      /* Only fetch what was damaged, rather than the bounding box of
+         all damage, which for a few small updates far apart is mostly
+         unchanged content */
+      COGL_NOTE (TEXTURE_PIXMAP, "Updating %d rectangles of %p using %s",
+                 tex_pixmap->n_damage_parts, tex_pixmap,
+                 tex_pixmap->shm_info.shmid != -1 ? "XShmGetImage"
+                                                  : "XGetSubImage");
+
+      for (i = 0; i < tex_pixmap->n_damage_parts; i++)
         {
-          COGL_NOTE (TEXTURE_PIXMAP, "Updating %p using XShmGetImage",
-                     tex_pixmap);
-
-          /* Create a temporary image using the beginning of the
-             shared memory segment and the right size for the region
-             we want to update. We need to reallocate the XImage every
-             time because there is no XShmGetSubImage. */
-          image = XShmCreateImage (display,
-                                   tex_pixmap->visual,
-                                   tex_pixmap->depth,
-                                   ZPixmap,
-                                   NULL,
-                                   &tex_pixmap->shm_info,
-                                   width,
-                                   height);
-          image->data = tex_pixmap->shm_info.shmaddr;
-          src_x = 0;
-          src_y = 0;
-
-          XShmGetImage (display, tex_pixmap->pixmap, image, x, y, AllPlanes);
+          CoglDamageRectangle *part = &tex_pixmap->damage_parts[i];
+
+          update_image_texture_area (tex_pixmap, display,
+                                     part->x1, part->y1,
+                                     part->x2 - part->x1,
+                                     part->y2 - part->y1);
         }
     }
   else
     {
-      COGL_NOTE (TEXTURE_PIXMAP, "Updating %p using XGetSubImage", tex_pixmap);
-
-      image = tex_pixmap->image;
-      src_x = x;
-      src_y = y;
+      COGL_NOTE (TEXTURE_PIXMAP, "Updating %p using %s",
+                 tex_pixmap,
+                 tex_pixmap->shm_info.shmid != -1 ? "XShmGetImage"
+                                                  : "XGetSubImage");
 
-      XGetSubImage (display,
-                    tex_pixmap->pixmap,
-                    x, y, width, height,
-                    AllPlanes, ZPixmap,
-                    image,
-                    x, y);
+      update_image_texture_area (tex_pixmap, display,
+                                 x, y, width, height);
     }
 
-  image_format =
-    _cogl_util_pixel_format_from_masks (visual->red_mask,
-                                        visual->green_mask,
-                                        visual->blue_mask,
-                                        image->depth,
-                                        image->bits_per_pixel,
-                                        image->byte_order == LSBFirst);
-  g_return_if_fail (cogl_pixel_format_get_n_planes (image_format) == 1);
-
-  bpp = cogl_pixel_format_get_bytes_per_pixel (image_format, 0);
-  offset = image->bytes_per_line * src_y + bpp * src_x;
-
-  _cogl_texture_set_region (tex_pixmap->tex,
-                            width,
-                            height,
-                            image_format,
-                            image->bytes_per_line,
-                            ((const uint8_t *) image->data) + offset,
-                            x, y,
-                            0, /* level */
-                            &ignore);
-
-  /* If we have a shared memory segment then the XImage would be a
-     temporary one with no data allocated so we can just XFree it */
-  if (tex_pixmap->shm_info.shmid != -1)
-    XFree (image);
-
-  memset (&tex_pixmap->damage_rect, 0, sizeof (CoglDamageRectangle));
+  clear_damage (tex_pixmap);
 }
 
 static void
@@ -990,6 +1092,7 @@ _cogl_texture_pixmap_x11_new (CoglContext *ctx,
   tex_pixmap->damage_rect.x2 = pixmap_width;
   tex_pixmap->damage_rect.y1 = 0;
   tex_pixmap->damage_rect.y2 = pixmap_height;
+  tex_pixmap->n_damage_parts = -1;
 
   winsys = _cogl_texture_pixmap_x11_get_winsys (tex_pixmap);
   if (winsys->texture_pixmap_x11_create)
@@ -1082,8 +1185,7 @@ cogl_texture_pixmap_x11_update_area (CoglTexturePixmapX11 *tex_pixmap,
       winsys->texture_pixmap_x11_damage_notify (tex_pixmap);
     }
 
-  cogl_damage_rectangle_union (&tex_pixmap->damage_rect,
-                               x, y, width, height);
+  add_damage (tex_pixmap, x, y, width, height);
 }
 
 gboolean
@@ -520,6 +520,13 @@ _cogl_winsys_context_init (CoglContext *context, GError **error)
       _cogl_has_private_feature (context, COGL_PRIVATE_FEATURE_OES_EGL_SYNC))
     COGL_FLAGS_SET (context->features, COGL_FEATURE_ID_FENCE, TRUE);
 
+#ifdef EGL_ANDROID_native_fence_sync
+  if ((egl_renderer->private_features & COGL_EGL_WINSYS_FEATURE_FENCE_SYNC) &&
+      (egl_renderer->private_features &
+       COGL_EGL_WINSYS_FEATURE_NATIVE_FENCE_SYNC))
+    COGL_FLAGS_SET (context->features, COGL_FEATURE_ID_SYNC_FD, TRUE);
+#endif
+
   if (egl_renderer->private_features & COGL_EGL_WINSYS_FEATURE_BUFFER_AGE)
     {
       COGL_FLAGS_SET (context->winsys_features,
@@ -586,6 +593,41 @@ _cogl_winsys_fence_destroy (CoglContext *context, void *fence)
 }
 #endif
 
+#if defined(EGL_KHR_fence_sync) && defined(EGL_ANDROID_native_fence_sync)
+static int
+_cogl_winsys_get_sync_fd (CoglContext *context)
+{
+  CoglRendererEGL *renderer = context->display->renderer->winsys;
+  static const EGLint attribs[] = {
+    EGL_SYNC_NATIVE_FENCE_FD_ANDROID, EGL_NO_NATIVE_FENCE_FD_ANDROID,
+    EGL_NONE
+  };
+  EGLSyncKHR sync;
+  int fd;
+
+  if (!renderer->pf_eglCreateSync || !renderer->pf_eglDupNativeFenceFD)
+    return -1;
+
+  sync = renderer->pf_eglCreateSync (renderer->edpy,
+                                     EGL_SYNC_NATIVE_FENCE_ANDROID,
+                                     attribs);
+  if (sync == EGL_NO_SYNC_KHR)
+    return -1;
+
+  /* The native fence only gets a file descriptor once it has been
+   * flushed to the kernel */
+  context->glFlush ();
+
+  fd = renderer->pf_eglDupNativeFenceFD (renderer->edpy, sync);
+  renderer->pf_eglDestroySync (renderer->edpy, sync);
+
+  if (fd == EGL_NO_NATIVE_FENCE_FD_ANDROID)
+    return -1;
+
+  return fd;
+}
+#endif
+
 static CoglWinsysVtable _cogl_winsys_vtable =
   {
     .constraints = COGL_RENDERER_CONSTRAINT_USES_EGL,
@@ -606,6 +648,9 @@ static CoglWinsysVtable _cogl_winsys_vtable =
     .fence_add = _cogl_winsys_fence_add,
     .fence_is_complete = _cogl_winsys_fence_is_complete,
     .fence_destroy = _cogl_winsys_fence_destroy,
+#endif
+#if defined(EGL_KHR_fence_sync) && defined(EGL_ANDROID_native_fence_sync)
+    .get_sync_fd = _cogl_winsys_get_sync_fd,
 #endif
   };
 
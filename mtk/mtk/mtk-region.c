@@ -27,11 +27,86 @@
 
 #include "mtk/mtk-region.h"
 
+/* Regions are copy-on-write: copies share the pixman region, which is only
+ * duplicated once one of the sharing regions is about to be modified.
+ */
+typedef struct _MtkRegionData
+{
+  gatomicrefcount ref_count;
+  pixman_region32_t region;
+} MtkRegionData;
+
 struct _MtkRegion
 {
-  pixman_region32_t inner_region;
+  MtkRegionData *data;
 };
 
+static MtkRegionData *
+region_data_new (void)
+{
+  MtkRegionData *data;
+
+  data = g_new0 (MtkRegionData, 1);
+  g_atomic_ref_count_init (&data->ref_count);
+
+  return data;
+}
+
+static MtkRegionData *
+region_data_ref (MtkRegionData *data)
+{
+  g_atomic_ref_count_inc (&data->ref_count);
+
+  return data;
+}
+
+static void
+region_data_unref (MtkRegionData *data)
+{
+  if (g_atomic_ref_count_dec (&data->ref_count))
+    {
+      pixman_region32_fini (&data->region);
+      g_free (data);
+    }
+}
+
+static MtkRegion *
+region_new (void)
+{
+  MtkRegion *region;
+
+  region = g_atomic_rc_box_new0 (MtkRegion);
+  region->data = region_data_new ();
+
+  return region;
+}
+
+static inline const pixman_region32_t *
+region_get_pixman (const MtkRegion *region)
+{
+  return &region->data->region;
+}
+
+static pixman_region32_t *
+region_ensure_writable (MtkRegion *region)
+{
+  MtkRegionData *data = region->data;
+
+  if (!g_atomic_ref_count_compare (&data->ref_count, 1))
+    {
+      MtkRegionData *copy;
+
+      copy = region_data_new ();
+      pixman_region32_init (&copy->region);
+      pixman_region32_copy (&copy->region, &data->region);
+
+      region->data = copy;
+      region_data_unref (data);
+    }
+
+  return &region->data->region;
+}
+
 /**
  * mtk_region_ref:
  * @region: A region
@@ -53,7 +128,7 @@ clear_region (gpointer data)
 {
   MtkRegion *region = data;
 
-  pixman_region32_fini (&region->inner_region);
+  region_data_unref (region->data);
 }
 
 void
@@ -72,9 +147,9 @@ mtk_region_create (void)
 {
   MtkRegion *region;
 
-  region = g_atomic_rc_box_new0 (MtkRegion);
+  region = region_new ();
 
-  pixman_region32_init (&region->inner_region);
+  pixman_region32_init (&region->data->region);
 
   return region;
 }
@@ -84,22 +159,22 @@ mtk_region_create (void)
  * mtk_region_copy:
  * @region: The region to copy
  *
+ * The copy shares its rectangles with @region until either of them is
+ * modified, so copying is cheap regardless of the region complexity.
+ *
  * Returns: (transfer full): A copy of the passed region
  */
 MtkRegion *
 mtk_region_copy (const MtkRegion *region)
 {
-  g_autoptr (MtkRegion) copy = NULL;
+  MtkRegion *copy;
 
   g_return_val_if_fail (region != NULL, NULL);
 
-  copy = mtk_region_create ();
-
-  if (!pixman_region32_copy (&copy->inner_region,
-                             &region->inner_region))
-    return NULL;
+  copy = g_atomic_rc_box_new0 (MtkRegion);
+  copy->data = region_data_ref (region->data);
 
-  return g_steal_pointer (&copy);
+  return copy;
 }
 
 gboolean
@@ -112,8 +187,11 @@ mtk_region_equal (const MtkRegion *region,
   if (region == NULL || other == NULL)
     return FALSE;
 
-  return pixman_region32_equal (&region->inner_region,
-                                &other->inner_region);
+  if (region->data == other->data)
+    return TRUE;
+
+  return pixman_region32_equal (region_get_pixman (region),
+                                region_get_pixman (other));
 }
 
 gboolean
@@ -121,7 +199,7 @@ mtk_region_is_empty (const MtkRegion *region)
 {
   g_return_val_if_fail (region != NULL, TRUE);
 
-  return !pixman_region32_not_empty (&region->inner_region);
+  return !pixman_region32_not_empty (region_get_pixman (region));
 }
 
 MtkRectangle
@@ -131,7 +209,7 @@ mtk_region_get_extents (const MtkRegion *region)
 
   g_return_val_if_fail (region != NULL, MTK_RECTANGLE_INIT (0, 0, 0, 0));
 
-  extents = pixman_region32_extents (&region->inner_region);
+  extents = pixman_region32_extents (region_get_pixman (region));
   return MTK_RECTANGLE_INIT (extents->x1,
                              extents->y1,
                              extents->x2 - extents->x1,
@@ -143,7 +221,7 @@ mtk_region_num_rectangles (const MtkRegion *region)
 {
   g_return_val_if_fail (region != NULL, 0);
 
-  return pixman_region32_n_rects (&region->inner_region);
+  return pixman_region32_n_rects (region_get_pixman (region));
 }
 
 void
@@ -153,7 +231,10 @@ mtk_region_translate (MtkRegion *region,
 {
   g_return_if_fail (region != NULL);
 
-  pixman_region32_translate (&region->inner_region, dx, dy);
+  if (dx == 0 && dy == 0)
+    return;
+
+  pixman_region32_translate (region_ensure_writable (region), dx, dy);
 }
 
 gboolean
@@ -163,49 +244,211 @@ mtk_region_contains_point (MtkRegion *region,
 {
   g_return_val_if_fail (region != NULL, FALSE);
 
-  return pixman_region32_contains_point (&region->inner_region, x, y, NULL);
+  return pixman_region32_contains_point (region_get_pixman (region),
+                                         x, y, NULL);
+}
+
+static inline pixman_box32_t
+box_from_rectangle (const MtkRectangle *rect)
+{
+  return (pixman_box32_t) {
+    .x1 = rect->x,
+    .y1 = rect->y,
+    .x2 = rect->x + rect->width,
+    .y2 = rect->y + rect->height,
+  };
+}
+
+static inline gboolean
+box_is_empty (const pixman_box32_t *box)
+{
+  return box->x1 >= box->x2 || box->y1 >= box->y2;
+}
+
+static inline gboolean
+box_contains_box (const pixman_box32_t *outer,
+                  const pixman_box32_t *inner)
+{
+  return (outer->x1 <= inner->x1 && outer->y1 <= inner->y1 &&
+          outer->x2 >= inner->x2 && outer->y2 >= inner->y2);
+}
+
+static inline gboolean
+box_overlaps_box (const pixman_box32_t *a,
+                  const pixman_box32_t *b)
+{
+  return (a->x1 < b->x2 && b->x1 < a->x2 &&
+          a->y1 < b->y2 && b->y1 < a->y2);
+}
+
+/* pixman keeps a region made of a single rectangle inline in its extents
+ * and only allocates rectangle storage once there are several of them, or
+ * points at a shared sentinel when the region is empty.
+ */
+static inline gboolean
+region_is_single_box (const pixman_region32_t *region)
+{
+  return region->data == NULL;
+}
+
+/* The box operations below handle the trivial cases, which are by far the
+ * most common ones when culling and tracking damage, without setting up a
+ * temporary pixman region, and leave everything else to pixman.
+ */
+static void
+region_union_box (MtkRegion      *region,
+                  pixman_box32_t  box)
+{
+  const pixman_region32_t *pixman_region = region_get_pixman (region);
+  const pixman_box32_t *extents;
+  pixman_region32_t box_region;
+  pixman_region32_t *dest;
+
+  if (box_is_empty (&box))
+    return;
+
+  extents = pixman_region32_extents (pixman_region);
+  if (!pixman_region32_not_empty (pixman_region) ||
+      box_contains_box (&box, extents))
+    {
+      pixman_region32_reset (region_ensure_writable (region), &box);
+      return;
+    }
+
+  if (region_is_single_box (pixman_region) &&
+      box_contains_box (extents, &box))
+    return;
+
+  dest = region_ensure_writable (region);
+  pixman_region32_init_with_extents (&box_region, &box);
+  pixman_region32_union (dest, dest, &box_region);
+  pixman_region32_fini (&box_region);
+}
+
+static void
+region_subtract_box (MtkRegion      *region,
+                     pixman_box32_t  box)
+{
+  const pixman_region32_t *pixman_region = region_get_pixman (region);
+  const pixman_box32_t *extents;
+  pixman_region32_t box_region;
+  pixman_region32_t *dest;
+
+  if (box_is_empty (&box) || !pixman_region32_not_empty (pixman_region))
+    return;
+
+  extents = pixman_region32_extents (pixman_region);
+  if (!box_overlaps_box (&box, extents))
+    return;
+
+  if (box_contains_box (&box, extents))
+    {
+      pixman_region32_clear (region_ensure_writable (region));
+      return;
+    }
+
+  dest = region_ensure_writable (region);
+  pixman_region32_init_with_extents (&box_region, &box);
+  pixman_region32_subtract (dest, dest, &box_region);
+  pixman_region32_fini (&box_region);
+}
+
+static void
+region_intersect_box (MtkRegion      *region,
+                      pixman_box32_t  box)
+{
+  const pixman_region32_t *pixman_region = region_get_pixman (region);
+  const pixman_box32_t *extents;
+  pixman_region32_t box_region;
+  pixman_region32_t *dest;
+
+  if (!pixman_region32_not_empty (pixman_region))
+    return;
+
+  extents = pixman_region32_extents (pixman_region);
+  if (box_is_empty (&box) || !box_overlaps_box (&box, extents))
+    {
+      pixman_region32_clear (region_ensure_writable (region));
+      return;
+    }
+
+  if (box_contains_box (&box, extents))
+    return;
+
+  if (region_is_single_box (pixman_region))
+    {
+      pixman_box32_t intersection = {
+        .x1 = MAX (box.x1, extents->x1),
+        .y1 = MAX (box.y1, extents->y1),
+        .x2 = MIN (box.x2, extents->x2),
+        .y2 = MIN (box.y2, extents->y2),
+      };
+
+      pixman_region32_reset (region_ensure_writable (region), &intersection);
+      return;
+    }
+
+  dest = region_ensure_writable (region);
+  pixman_region32_init_with_extents (&box_region, &box);
+  pixman_region32_intersect (dest, dest, &box_region);
+  pixman_region32_fini (&box_region);
 }
 
 void
 mtk_region_union (MtkRegion       *region,
                   const MtkRegion *other)
 {
+  pixman_region32_t *dest;
+
   g_return_if_fail (region != NULL);
   g_return_if_fail (other != NULL);
 
-  pixman_region32_union (&region->inner_region,
-                         &region->inner_region,
-                         &other->inner_region);
+  if (region_is_single_box (region_get_pixman (other)))
+    {
+      region_union_box (region, region_get_pixman (other)->extents);
+      return;
+    }
+
+  if (region->data == other->data)
+    return;
+
+  dest = region_ensure_writable (region);
+  pixman_region32_union (dest, dest, region_get_pixman (other));
 }
 
 void
 mtk_region_union_rectangle (MtkRegion          *region,
                             const MtkRectangle *rect)
 {
-  pixman_region32_t pixman_region;
-
   g_return_if_fail (region != NULL);
   g_return_if_fail (rect != NULL);
 
-  pixman_region32_init_rect (&pixman_region,
-                             rect->x, rect->y,
-                             rect->width, rect->height);
-  pixman_region32_union (&region->inner_region,
-                         &region->inner_region,
-                         &pixman_region);
-  pixman_region32_fini (&pixman_region);
+  region_union_box (region, box_from_rectangle (rect));
 }
 
 void
 mtk_region_subtract (MtkRegion       *region,
                      const MtkRegion *other)
 {
+  pixman_region32_t *dest;
+
   g_return_if_fail (region != NULL);
   g_return_if_fail (other != NULL);
 
-  pixman_region32_subtract (&region->inner_region,
-                            &region->inner_region,
-                            &other->inner_region);
+  if (region_is_single_box (region_get_pixman (other)))
+    {
+      region_subtract_box (region, region_get_pixman (other)->extents);
+      return;
+    }
+
+  if (region->data == other->data)
+    {
+      pixman_region32_clear (region_ensure_writable (region));
+      return;
+    }
+
+  dest = region_ensure_writable (region);
+  pixman_region32_subtract (dest, dest, region_get_pixman (other));
 }
 
 void
@@ -215,45 +458,39 @@ mtk_region_subtract_rectangle (MtkRegion          *region,
   g_return_if_fail (region != NULL);
   g_return_if_fail (rect != NULL);
 
-  pixman_region32_t pixman_region;
-  pixman_region32_init_rect (&pixman_region,
-                             rect->x, rect->y,
-                             rect->width, rect->height);
-
-  pixman_region32_subtract (&region->inner_region,
-                            &region->inner_region,
-                            &pixman_region);
-  pixman_region32_fini (&pixman_region);
+  region_subtract_box (region, box_from_rectangle (rect));
 }
 
 void
 mtk_region_intersect (MtkRegion       *region,
                       const MtkRegion *other)
 {
+  pixman_region32_t *dest;
+
   g_return_if_fail (region != NULL);
   g_return_if_fail (other != NULL);
 
-  pixman_region32_intersect (&region->inner_region,
-                             &region->inner_region,
-                             &other->inner_region);
+  if (region_is_single_box (region_get_pixman (other)))
+    {
+      region_intersect_box (region, region_get_pixman (other)->extents);
+      return;
+    }
+
+  if (region->data == other->data)
+    return;
+
+  dest = region_ensure_writable (region);
+  pixman_region32_intersect (dest, dest, region_get_pixman (other));
 }
 
 void
 mtk_region_intersect_rectangle (MtkRegion          *region,
                                 const MtkRectangle *rect)
 {
-  pixman_region32_t pixman_region;
-
   g_return_if_fail (region != NULL);
+  g_return_if_fail (rect != NULL);
 
-  pixman_region32_init_rect (&pixman_region,
-                             rect->x, rect->y,
-                             rect->width, rect->height);
-
-  pixman_region32_intersect (&region->inner_region,
-                             &region->inner_region,
-                             &pixman_region);
-  pixman_region32_fini (&pixman_region);
+  region_intersect_box (region, box_from_rectangle (rect));
 }
 
 MtkRectangle
@@ -264,7 +501,7 @@ mtk_region_get_rectangle (const MtkRegion *region,
 
   g_return_val_if_fail (region != NULL, MTK_RECTANGLE_INIT (0, 0, 0, 0));
 
-  box = pixman_region32_rectangles (&region->inner_region, NULL) + nth;
+  box = pixman_region32_rectangles (region_get_pixman (region), NULL) + nth;
   return MTK_RECTANGLE_INIT (box->x1, box->y1, box->x2 - box->x1, box->y2 - box->y1);
 }
 
@@ -274,9 +511,9 @@ mtk_region_create_rectangle (const MtkRectangle *rect)
   MtkRegion *region;
   g_return_val_if_fail (rect != NULL, NULL);
 
-  region = g_atomic_rc_box_new0 (MtkRegion);
+  region = region_new ();
 
-  pixman_region32_init_rect (&region->inner_region,
+  pixman_region32_init_rect (&region->data->region,
                              rect->x, rect->y,
                              rect->width, rect->height);
   return region;
@@ -294,11 +531,11 @@ mtk_region_create_rectangles (const MtkRectangle *rects,
   g_return_val_if_fail (rects != NULL, NULL);
   g_return_val_if_fail (n_rects != 0, NULL);
 
-  region = g_atomic_rc_box_new0 (MtkRegion);
+  region = region_new ();
 
   if (n_rects == 1)
     {
-      pixman_region32_init_rect (&region->inner_region,
+      pixman_region32_init_rect (&region->data->region,
                                  rects->x, rects->y,
                                  rects->width, rects->height);
 
@@ -320,7 +557,7 @@ mtk_region_create_rectangles (const MtkRectangle *rects,
       boxes[i].y2 = rects[i].y + rects[i].height;
     }
 
-  i = pixman_region32_init_rects (&region->inner_region,
+  i = pixman_region32_init_rects (&region->data->region,
                                   boxes, n_rects);
 
   if (boxes != stack_boxes)
@@ -342,12 +579,9 @@ mtk_region_contains_rectangle (const MtkRegion    *region,
   g_return_val_if_fail (region != NULL, MTK_REGION_OVERLAP_OUT);
   g_return_val_if_fail (rect != NULL, MTK_REGION_OVERLAP_OUT);
 
-  box.x1 = rect->x;
-  box.y1 = rect->y;
-  box.x2 = rect->x + rect->width;
-  box.y2 = rect->y + rect->height;
+  box = box_from_rectangle (rect);
 
-  overlap = pixman_region32_contains_rectangle (&region->inner_region,
+  overlap = pixman_region32_contains_rectangle (region_get_pixman (region),
                                                 &box);
   switch (overlap)
     {
@@ -524,10 +758,9 @@ mtk_region_iterator_next (MtkRegionIterator *iter)
  * creates regions for small groups of rectangles and merges them together in
  * a binary tree.
  *
- * Possible improvement: From a glance at the code, accumulating all the rectangles
- *  into a flat array and then calling the (not usefully documented)
- *  mtk_region_create_rectangles() would have the same behavior and would be
- *  simpler and a bit more efficient.
+ * Callers that already have all their rectangles at hand can pass them in one
+ * go with mtk_region_builder_add_rectangles(), which lets pixman sort and
+ * coalesce the whole batch at once.
  */
 
 /* Optimium performance seems to be with MAX_CHUNK_RECTANGLES=4; 8 is about 10% slower.
@@ -544,6 +777,31 @@ mtk_region_builder_init (MtkRegionBuilder *builder)
   builder->n_levels = 1;
 }
 
+static void
+builder_insert_chunk (MtkRegionBuilder *builder,
+                      MtkRegion        *chunk,
+                      int               level)
+{
+  int i;
+
+  for (i = level; i < MTK_REGION_BUILDER_MAX_LEVELS; i++)
+    {
+      if (builder->levels[i] == NULL)
+        {
+          builder->levels[i] = chunk;
+          builder->n_levels = MAX (builder->n_levels, i + 1);
+          return;
+        }
+
+      mtk_region_union (chunk, builder->levels[i]);
+      g_clear_pointer (&builder->levels[i], mtk_region_unref);
+    }
+
+  /* Out of levels, keep accumulating at the top one */
+  builder->levels[MTK_REGION_BUILDER_MAX_LEVELS - 1] = chunk;
+  builder->n_levels = MTK_REGION_BUILDER_MAX_LEVELS;
+}
+
 void
 mtk_region_builder_add_rectangle (MtkRegionBuilder *builder,
                                   int               x,
@@ -552,7 +810,6 @@ mtk_region_builder_add_rectangle (MtkRegionBuilder *builder,
                                   int               height)
 {
   MtkRectangle rect;
-  int i;
 
   if (builder->levels[0] == NULL)
     builder->levels[0] = mtk_region_create ();
@@ -564,29 +821,52 @@ mtk_region_builder_add_rectangle (MtkRegionBuilder *builder,
 
   mtk_region_union_rectangle (builder->levels[0], &rect);
   if (mtk_region_num_rectangles (builder->levels[0]) >= MAX_CHUNK_RECTANGLES)
+    builder_insert_chunk (builder, g_steal_pointer (&builder->levels[0]), 1);
+}
+
+/**
+ * mtk_region_builder_add_rectangles:
+ * @builder: A region builder
+ * @rects: (array length=n_rects): The rectangles to add
+ * @n_rects: The number of rectangles
+ *
+ * Adds a batch of possibly unsorted and overlapping rectangles at once.
+ * The batch is sorted and coalesced in one go, which is O(N log N) in the
+ * number of rectangles, and then merged into the builder like a chunk of
+ * matching size.
+ */
+void
+mtk_region_builder_add_rectangles (MtkRegionBuilder   *builder,
+                                   const MtkRectangle *rects,
+                                   int                 n_rects)
+{
+  MtkRegion *chunk;
+  int level;
+  int i;
+
+  g_return_if_fail (n_rects == 0 || rects != NULL);
+
+  if (n_rects < MAX_CHUNK_RECTANGLES)
     {
-      for (i = 1; i < builder->n_levels + 1; i++)
+      for (i = 0; i < n_rects; i++)
         {
-          if (builder->levels[i] == NULL)
-            {
-              if (i < MTK_REGION_BUILDER_MAX_LEVELS)
-                {
-                  builder->levels[i] = builder->levels[i - 1];
-                  builder->levels[i - 1] = NULL;
-                  if (i == builder->n_levels)
-                    builder->n_levels++;
-                }
-
-              break;
-            }
-          else
-            {
-              mtk_region_union (builder->levels[i], builder->levels[i - 1]);
-              mtk_region_unref (builder->levels[i - 1]);
-              builder->levels[i - 1] = NULL;
-            }
+          mtk_region_builder_add_rectangle (builder,
+                                            rects[i].x, rects[i].y,
+                                            rects[i].width, rects[i].height);
         }
+      return;
     }
+
+  chunk = mtk_region_create_rectangles (rects, n_rects);
+  if (G_UNLIKELY (chunk == NULL))
+    return;
+
+  level = 1;
+  while (level < MTK_REGION_BUILDER_MAX_LEVELS - 1 &&
+         (MAX_CHUNK_RECTANGLES << level) <= n_rects)
+    level++;
+
+  builder_insert_chunk (builder, chunk, level);
 }
 
 MtkRegion *
@@ -206,5 +206,10 @@ void mtk_region_builder_add_rectangle (MtkRegionBuilder *builder,
                                        int               width,
                                        int               height);
 
+MTK_EXPORT
+void mtk_region_builder_add_rectangles (MtkRegionBuilder   *builder,
+                                        const MtkRectangle *rects,
+                                        int                 n_rects);
+
 MTK_EXPORT
 MtkRegion * mtk_region_builder_finish (MtkRegionBuilder *builder);
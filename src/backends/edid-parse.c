@@ -44,6 +44,7 @@ decode_edid_range_limits (const struct di_edid_display_range_limits *range_limit
                           MetaEdidInfo                              *info)
 {
   info->min_vert_rate_hz = range_limits->min_vert_rate_hz;
+  info->max_vert_rate_hz = range_limits->max_vert_rate_hz;
 }
 
 static void
@@ -611,7 +612,29 @@ meta_edid_info_new_parse (const uint8_t *edid,
     }
   else
     {
-      g_free (info);
+      meta_edid_info_free (info);
       return NULL;
     }
 }
+
+MetaEdidInfo *
+meta_edid_info_copy (const MetaEdidInfo *info)
+{
+  MetaEdidInfo *copy;
+
+  copy = g_memdup2 (info, sizeof (MetaEdidInfo));
+  copy->manufacturer_code = g_strdup (info->manufacturer_code);
+  copy->dsc_serial_number = g_strdup (info->dsc_serial_number);
+  copy->dsc_product_name = g_strdup (info->dsc_product_name);
+
+  return copy;
+}
+
+void
+meta_edid_info_free (MetaEdidInfo *info)
+{
+  g_free (info->manufacturer_code);
+  g_free (info->dsc_serial_number);
+  g_free (info->dsc_product_name);
+  g_free (info);
+}
@@ -89,6 +89,7 @@ struct _MetaEdidInfo
   char *dsc_product_name;
 
   int32_t min_vert_rate_hz;
+  int32_t max_vert_rate_hz;
 
   MetaEdidColorimetry colorimetry;
   MetaEdidHdrStaticMetadata hdr_static_metadata;
@@ -97,3 +98,11 @@ struct _MetaEdidInfo
 META_EXPORT_TEST
 MetaEdidInfo *meta_edid_info_new_parse (const uint8_t *edid,
                                         size_t size);
+
+META_EXPORT_TEST
+MetaEdidInfo *meta_edid_info_copy (const MetaEdidInfo *info);
+
+META_EXPORT_TEST
+void meta_edid_info_free (MetaEdidInfo *info);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaEdidInfo, meta_edid_info_free)
@@ -119,6 +119,7 @@ enum
 static guint signals[N_SIGNALS];
 
 #define HIDDEN_POINTER_TIMEOUT 300 /* ms */
+#define MAX_EVENTS_PER_DISPATCH 64
 
 #ifndef BTN_LEFT
 #define BTN_LEFT 0x110
@@ -540,7 +541,10 @@ meta_backend_real_post_init (MetaBackend *backend)
   clutter_actor_realize (priv->stage);
   META_BACKEND_GET_CLASS (backend)->select_stage_events (backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendSetupMonitors,
+                           "Meta::Backend::post_init#monitors()");
   meta_monitor_manager_setup (priv->monitor_manager);
+  COGL_TRACE_END (MetaBackendSetupMonitors);
 
   meta_backend_update_stage (backend);
 
@@ -1143,9 +1147,19 @@ clutter_source_dispatch (GSource     *source,
 {
   MetaBackendSource *backend_source = (MetaBackendSource *) source;
 
+  int i;
+
   COGL_TRACE_BEGIN_SCOPED (Dispatch, "Meta::BackendSource::dispatch()");
 
-  dispatch_clutter_event (backend_source->backend);
+  /* High rate input devices can queue many events between two main loop
+   * iterations, so handle them in batches, but bounded so that other sources
+   * still get to run while events keep coming in.
+   */
+  for (i = 0; i < MAX_EVENTS_PER_DISPATCH; i++)
+    {
+      if (!dispatch_clutter_event (backend_source->backend))
+        break;
+    }
 
   return TRUE;
 }
@@ -1218,15 +1232,26 @@ meta_backend_initable_init (GInitable     *initable,
   MetaBackend *backend = META_BACKEND (initable);
   MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInit, "Meta::Backend::init()");
+
   priv->orientation_manager = g_object_new (META_TYPE_ORIENTATION_MANAGER, NULL);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitMonitorManager,
+                           "Meta::Backend::init#monitor_manager()");
   priv->monitor_manager = meta_backend_create_monitor_manager (backend, error);
+  COGL_TRACE_END (MetaBackendInitMonitorManager);
   if (!priv->monitor_manager)
     return FALSE;
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitColorManager,
+                           "Meta::Backend::init#color_manager()");
   priv->color_manager = meta_backend_create_color_manager (backend);
+  COGL_TRACE_END (MetaBackendInitColorManager);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitRenderer,
+                           "Meta::Backend::init#renderer()");
   priv->renderer = meta_backend_create_renderer (backend, error);
+  COGL_TRACE_END (MetaBackendInitRenderer);
   if (!priv->renderer)
     return FALSE;
 
@@ -1241,10 +1266,16 @@ meta_backend_initable_init (GInitable     *initable,
              system_bus_gotten_cb,
              backend);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitClutter,
+                           "Meta::Backend::init#clutter()");
   if (!init_clutter (backend, error))
     return FALSE;
+  COGL_TRACE_END (MetaBackendInitClutter);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaBackendInitPostInit,
+                           "Meta::Backend::init#post_init()");
   meta_backend_post_init (backend);
+  COGL_TRACE_END (MetaBackendInitPostInit);
 
   while (TRUE)
     {
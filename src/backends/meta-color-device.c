@@ -205,51 +205,28 @@ on_cd_device_changed (CdDevice        *cd_device,
   update_assigned_profile (color_device);
 }
 
-typedef struct
-{
-  GMainLoop *loop;
-  CdDevice *cd_device;
-  GError *error;
-} FindDeviceData;
-
 static void
-on_find_device (GObject      *source_object,
-                GAsyncResult *res,
-                gpointer      user_data)
+on_find_device_to_delete (GObject      *source_object,
+                          GAsyncResult *res,
+                          gpointer      user_data)
 {
   CdClient *cd_client = CD_CLIENT (source_object);
-  FindDeviceData *data = user_data;
+  g_autofree char *cd_device_id = user_data;
+  g_autoptr (CdDevice) cd_device = NULL;
+  g_autoptr (GError) error = NULL;
 
-  data->cd_device = cd_client_find_device_finish (cd_client, res, &data->error);
-  g_main_loop_quit (data->loop);
-}
+  cd_device = cd_client_find_device_finish (cd_client, res, &error);
+  if (!cd_device)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
+        {
+          g_warning ("Failed to find colord device %s: %s",
+                     cd_device_id, error->message);
+        }
+      return;
+    }
 
-static CdDevice *
-find_device_sync (CdClient    *cd_client,
-                  const char  *cd_device_id,
-                  GError     **error)
-{
-  g_autoptr (GMainContext) main_context = NULL;
-  g_autoptr (GMainLoop) main_loop = NULL;
-  FindDeviceData data = {};
-
-  main_context = g_main_context_new ();
-  main_loop = g_main_loop_new (main_context, FALSE);
-  g_main_context_push_thread_default (main_context);
-
-  data = (FindDeviceData) {
-    .loop = main_loop,
-  };
-  cd_client_find_device (cd_client, cd_device_id, NULL,
-                         on_find_device,
-                         &data);
-  g_main_loop_run (main_loop);
-
-  g_main_context_pop_thread_default (main_context);
-
-  if (data.error)
-    g_propagate_error (error, data.error);
-  return data.cd_device;
+  cd_client_delete_device (cd_client, cd_device, NULL, NULL, NULL);
 }
 
 static void
@@ -280,23 +257,20 @@ meta_color_device_dispose (GObject *object)
 
   cd_device = color_device->cd_device;
   cd_device_id = color_device->cd_device_id;
-  if (!cd_device && cd_device_id)
+  if (cd_device)
     {
-      g_autoptr (GError) error = NULL;
-
-      cd_device = find_device_sync (cd_client,
-                                    cd_device_id,
-                                    &error);
-      if (!cd_device &&
-          !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND))
-        {
-          g_warning ("Failed to find colord device %s: %s",
-                     cd_device_id, error->message);
-        }
+      cd_client_delete_device (cd_client, cd_device, NULL, NULL, NULL);
+    }
+  else if (cd_device_id)
+    {
+      /* The device may still be in the process of being created; look it up
+       * without blocking, the request is handled by colord after the
+       * creation one.
+       */
+      cd_client_find_device (cd_client, cd_device_id, NULL,
+                             on_find_device_to_delete,
+                             g_strdup (cd_device_id));
     }
-
-  if (cd_device)
-    cd_client_delete_device (cd_client, cd_device, NULL, NULL, NULL);
 
   g_clear_pointer (&color_device->cd_device_id, g_free);
   g_clear_object (&color_device->cd_device);
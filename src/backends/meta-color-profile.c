@@ -26,6 +26,7 @@
 #include <gio/gio.h>
 
 #include "backends/meta-color-manager-private.h"
+#include "backends/meta-crtc.h"
 
 enum
 {
@@ -36,6 +37,14 @@ enum
 
 static guint signals[N_SIGNALS];
 
+#define MAX_CACHED_GAMMA_LUTS 4
+
+typedef struct _CachedGammaLut
+{
+  unsigned int temperature;
+  MetaGammaLut *lut;
+} CachedGammaLut;
+
 struct _MetaColorProfile
 {
   GObject parent;
@@ -53,57 +62,46 @@ struct _MetaColorProfile
   guint notify_ready_id;
 
   gboolean is_ready;
+
+  /* Most recently used first */
+  GQueue cached_gamma_luts;
 };
 
 G_DEFINE_TYPE (MetaColorProfile, meta_color_profile,
                G_TYPE_OBJECT)
 
-typedef struct
-{
-  GMainLoop *loop;
-  CdProfile *cd_profile;
-  GError *error;
-} FindProfileData;
-
 static void
-on_find_profile (GObject      *source_object,
-                 GAsyncResult *res,
-                 gpointer      user_data)
+on_find_profile_to_delete (GObject      *source_object,
+                           GAsyncResult *res,
+                           gpointer      user_data)
 {
   CdClient *cd_client = CD_CLIENT (source_object);
-  FindProfileData *data = user_data;
+  g_autofree char *cd_profile_id = user_data;
+  g_autoptr (CdProfile) cd_profile = NULL;
+  g_autoptr (GError) error = NULL;
 
-  data->cd_profile = cd_client_find_profile_finish (cd_client, res,
-                                                    &data->error);
-  g_main_loop_quit (data->loop);
+  cd_profile = cd_client_find_profile_finish (cd_client, res, &error);
+  if (!cd_profile)
+    {
+      if (!g_error_matches (error,
+                            CD_CLIENT_ERROR,
+                            CD_CLIENT_ERROR_NOT_FOUND))
+        {
+          g_warning ("Failed to find colord profile %s: %s",
+                     cd_profile_id,
+                     error->message);
+        }
+      return;
+    }
+
+  cd_client_delete_profile (cd_client, cd_profile, NULL, NULL, NULL);
 }
 
-static CdProfile *
-find_profile_sync (CdClient    *cd_client,
-                   const char  *cd_profile_id,
-                   GError     **error)
+static void
+cached_gamma_lut_free (CachedGammaLut *cached_lut)
 {
-  g_autoptr (GMainContext) main_context = NULL;
-  g_autoptr (GMainLoop) main_loop = NULL;
-  FindProfileData data = {};
-
-  main_context = g_main_context_new ();
-  main_loop = g_main_loop_new (main_context, FALSE);
-  g_main_context_push_thread_default (main_context);
-
-  data = (FindProfileData) {
-    .loop = main_loop,
-  };
-  cd_client_find_profile (cd_client, cd_profile_id, NULL,
-                          on_find_profile,
-                          &data);
-  g_main_loop_run (main_loop);
-
-  g_main_context_pop_thread_default (main_context);
-
-  if (data.error)
-    g_propagate_error (error, data.error);
-  return data.cd_profile;
+  meta_gamma_lut_free (cached_lut->lut);
+  g_free (cached_lut);
 }
 
 static void
@@ -122,26 +120,22 @@ meta_color_profile_finalize (GObject *object)
       CdProfile *cd_profile;
 
       cd_profile = color_profile->cd_profile;
-      if (!cd_profile && !color_profile->is_ready)
+      if (cd_profile)
         {
-          g_autoptr (GError) error = NULL;
-
-          cd_profile = find_profile_sync (cd_client,
-                                          color_profile->cd_profile_id,
-                                          &error);
-          if (!cd_profile &&
-              !g_error_matches (error,
-                                CD_CLIENT_ERROR,
-                                CD_CLIENT_ERROR_NOT_FOUND))
-            {
-              g_warning ("Failed to find colord profile %s: %s",
-                         color_profile->cd_profile_id,
-                         error->message);
-            }
+          cd_client_delete_profile (cd_client, cd_profile, NULL, NULL, NULL);
+        }
+      else if (!color_profile->is_ready)
+        {
+          /* The profile may still be in the process of being created; look
+           * it up without blocking, the request is handled by colord after
+           * the creation one.
+           */
+          cd_client_find_profile (cd_client,
+                                  color_profile->cd_profile_id,
+                                  NULL,
+                                  on_find_profile_to_delete,
+                                  g_strdup (color_profile->cd_profile_id));
         }
-
-      if (cd_profile)
-        cd_client_delete_profile (cd_client, cd_profile, NULL, NULL, NULL);
     }
 
   g_clear_pointer (&color_profile->cd_profile_id, g_free);
@@ -149,6 +143,8 @@ meta_color_profile_finalize (GObject *object)
   g_clear_pointer (&color_profile->bytes, g_bytes_unref);
   g_clear_object (&color_profile->cd_profile);
   g_clear_pointer (&color_profile->calibration, meta_color_calibration_free);
+  g_queue_clear_full (&color_profile->cached_gamma_luts,
+                      (GDestroyNotify) cached_gamma_lut_free);
 
   G_OBJECT_CLASS (meta_color_profile_parent_class)->finalize (object);
 }
@@ -500,23 +496,81 @@ generate_gamma_lut (MetaColorProfile *color_profile,
   return lut;
 }
 
+static MetaGammaLut *
+lookup_cached_gamma_lut (MetaColorProfile *color_profile,
+                         unsigned int      temperature,
+                         size_t            lut_size)
+{
+  GList *l;
+
+  for (l = color_profile->cached_gamma_luts.head; l; l = l->next)
+    {
+      CachedGammaLut *cached_lut = l->data;
+
+      if (cached_lut->temperature != temperature ||
+          cached_lut->lut->size != lut_size)
+        continue;
+
+      if (l != color_profile->cached_gamma_luts.head)
+        {
+          g_queue_unlink (&color_profile->cached_gamma_luts, l);
+          g_queue_push_head_link (&color_profile->cached_gamma_luts, l);
+        }
+
+      return cached_lut->lut;
+    }
+
+  return NULL;
+}
+
+static void
+cache_gamma_lut (MetaColorProfile *color_profile,
+                 unsigned int      temperature,
+                 MetaGammaLut     *lut)
+{
+  CachedGammaLut *cached_lut;
+
+  if (color_profile->cached_gamma_luts.length >= MAX_CACHED_GAMMA_LUTS)
+    {
+      cached_gamma_lut_free (g_queue_pop_tail (&color_profile->cached_gamma_luts));
+    }
+
+  cached_lut = g_new0 (CachedGammaLut, 1);
+  cached_lut->temperature = temperature;
+  cached_lut->lut = lut;
+  g_queue_push_head (&color_profile->cached_gamma_luts, cached_lut);
+}
+
 MetaGammaLut *
 meta_color_profile_generate_gamma_lut (MetaColorProfile *color_profile,
                                        unsigned int      temperature,
                                        size_t            lut_size)
 {
+  MetaGammaLut *lut;
+
   g_assert (lut_size > 0);
 
+  /* Monitors sharing a profile, and switching back and forth between
+   * temperatures, keep asking for the same few LUTs.
+   */
+  lut = lookup_cached_gamma_lut (color_profile, temperature, lut_size);
+  if (lut)
+    return meta_gamma_lut_copy (lut);
+
   if (color_profile->calibration->has_vcgt)
     {
-      return generate_gamma_lut_from_vcgt (color_profile,
-                                           color_profile->calibration->vcgt,
-                                           temperature, lut_size);
+      lut = generate_gamma_lut_from_vcgt (color_profile,
+                                          color_profile->calibration->vcgt,
+                                          temperature, lut_size);
     }
   else
     {
-      return generate_gamma_lut (color_profile, temperature, lut_size);
+      lut = generate_gamma_lut (color_profile, temperature, lut_size);
     }
+
+  cache_gamma_lut (color_profile, temperature, lut);
+
+  return meta_gamma_lut_copy (lut);
 }
 
 const MetaColorCalibration *
@@ -482,6 +482,22 @@ meta_cursor_renderer_get_cursor (MetaCursorRenderer *renderer)
   return priv->overlay_cursor;
 }
 
+/**
+ * meta_cursor_renderer_is_overlay_visible:
+ * @renderer: a #MetaCursorRenderer
+ *
+ * Returns: %TRUE if the cursor is painted as part of the stage, rather than
+ *   being shown using a hardware cursor plane
+ */
+gboolean
+meta_cursor_renderer_is_overlay_visible (MetaCursorRenderer *renderer)
+{
+  MetaCursorRendererPrivate *priv =
+    meta_cursor_renderer_get_instance_private (renderer);
+
+  return priv->overlay_cursor && priv->needs_overlay;
+}
+
 ClutterInputDevice *
 meta_cursor_renderer_get_input_device (MetaCursorRenderer *renderer)
 {
@@ -269,6 +269,12 @@ meta_cursor_sprite_xcursor_get_current_image (MetaCursorSpriteXcursor *sprite_xc
   return sprite_xcursor->xcursor_images->images[sprite_xcursor->current_frame];
 }
 
+XcursorImages *
+meta_cursor_sprite_xcursor_get_images (MetaCursorSpriteXcursor *sprite_xcursor)
+{
+  return sprite_xcursor->xcursor_images;
+}
+
 static void
 meta_cursor_sprite_xcursor_tick_frame (MetaCursorSprite *sprite)
 {
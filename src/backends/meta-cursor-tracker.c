@@ -58,6 +58,7 @@ typedef struct _MetaCursorTrackerPrivate
 
   int track_position_count;
 
+  /* Last position position-invalidated was emitted for */
   float x;
   float y;
 
@@ -457,6 +458,20 @@ meta_cursor_tracker_set_root_cursor (MetaCursorTracker *tracker,
 void
 meta_cursor_tracker_invalidate_position (MetaCursorTracker *tracker)
 {
+  MetaCursorTrackerPrivate *priv =
+    meta_cursor_tracker_get_instance_private (tracker);
+  graphene_point_t position;
+
+  /* Position tracking polls, so most invalidations are for a pointer that
+   * didn't move; every emission makes listeners such as screen casts
+   * schedule a stage update, so only emit for actual changes */
+  meta_cursor_tracker_get_pointer (tracker, &position, NULL);
+  if (position.x == priv->x && position.y == priv->y)
+    return;
+
+  priv->x = position.x;
+  priv->y = position.y;
+
   g_signal_emit (tracker, signals[POSITION_INVALIDATED], 0);
 }
 
@@ -494,6 +509,10 @@ meta_cursor_tracker_track_position (MetaCursorTracker *tracker)
       MetaCursorTrackerClass *klass =
         META_CURSOR_TRACKER_GET_CLASS (tracker);
 
+      /* Make sure new trackers get told about the current position */
+      priv->x = -1.0;
+      priv->y = -1.0;
+
       klass->set_force_track_position (tracker, TRUE);
     }
 }
@@ -443,6 +443,23 @@ meta_egl_create_pbuffer_surface (MetaEgl      *egl,
   return surface;
 }
 
+gboolean
+meta_egl_query_surface (MetaEgl   *egl,
+                        EGLDisplay display,
+                        EGLSurface surface,
+                        EGLint     attribute,
+                        EGLint    *value,
+                        GError   **error)
+{
+  if (!eglQuerySurface (display, surface, attribute, value))
+    {
+      set_egl_error (error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 gboolean
 meta_egl_destroy_surface (MetaEgl   *egl,
                           EGLDisplay display,
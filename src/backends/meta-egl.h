@@ -128,6 +128,13 @@ EGLSurface meta_egl_create_pbuffer_surface (MetaEgl      *egl,
                                             const EGLint *attrib_list,
                                             GError      **error);
 
+gboolean meta_egl_query_surface (MetaEgl   *egl,
+                                EGLDisplay display,
+                                EGLSurface surface,
+                                EGLint     attribute,
+                                EGLint    *value,
+                                GError   **error);
+
 gboolean meta_egl_destroy_surface (MetaEgl   *egl,
                                    EGLDisplay display,
                                    EGLSurface surface,
@@ -41,6 +41,19 @@ struct _MetaEisDevice
 
   guchar button_state[(MAX_BUTTON + 7) / 8];
   guchar key_state[(MAX_KEY + 7) / 8];
+
+  /* Motion received since the last time pending events were flushed,
+   * coalesced into a single motion event each */
+  gboolean has_pending_relative_motion;
+  double pending_dx;
+  double pending_dy;
+
+  /* Absolute motion is kept in the coordinate space of the viewport it
+   * was received for and only transformed when flushed */
+  gboolean has_pending_absolute_motion;
+  MetaEisViewport *pending_viewport;
+  double pending_x;
+  double pending_y;
 };
 
 struct _MetaEisClient
@@ -371,20 +384,48 @@ add_device (MetaEisClient           *client,
   return device;
 }
 
+static void
+flush_pending_motion (MetaEisDevice *device)
+{
+  if (device->has_pending_relative_motion)
+    {
+      clutter_virtual_input_device_notify_relative_motion (device->device,
+                                                           g_get_monotonic_time (),
+                                                           device->pending_dx,
+                                                           device->pending_dy);
+      device->has_pending_relative_motion = FALSE;
+      device->pending_dx = 0.0;
+      device->pending_dy = 0.0;
+    }
+
+  if (device->has_pending_absolute_motion)
+    {
+      double x, y;
+
+      if (meta_eis_viewport_transform_coordinate (device->pending_viewport,
+                                                  device->pending_x,
+                                                  device->pending_y,
+                                                  &x, &y))
+        {
+          clutter_virtual_input_device_notify_absolute_motion (device->device,
+                                                               g_get_monotonic_time (),
+                                                               x, y);
+        }
+      device->has_pending_absolute_motion = FALSE;
+      device->pending_viewport = NULL;
+    }
+}
+
 static void
 handle_motion_relative (MetaEisClient	 *client,
                         struct eis_event *event)
 {
   struct eis_device *eis_device = eis_event_get_device (event);
   MetaEisDevice *device = eis_device_get_user_data (eis_device);
-  double dx, dy;
-
-  dx = eis_event_pointer_get_dx (event);
-  dy = eis_event_pointer_get_dy (event);
 
-  clutter_virtual_input_device_notify_relative_motion (device->device,
-                                                       g_get_monotonic_time (),
-                                                       dx, dy);
+  device->pending_dx += eis_event_pointer_get_dx (event);
+  device->pending_dy += eis_event_pointer_get_dy (event);
+  device->has_pending_relative_motion = TRUE;
 }
 
 static MetaEisViewport *
@@ -414,20 +455,18 @@ handle_motion_absolute (MetaEisClient    *client,
   struct eis_device *eis_device = eis_event_get_device (event);
   MetaEisDevice *device = eis_device_get_user_data (eis_device);
   MetaEisViewport *viewport;
-  double x, y;
 
   viewport = find_viewport (event);
   if (!viewport)
     return;
 
-  x = eis_event_pointer_get_absolute_x (event);
-  y = eis_event_pointer_get_absolute_y (event);
-  if (!meta_eis_viewport_transform_coordinate (viewport, x, y, &x, &y))
-    return;
-
-  clutter_virtual_input_device_notify_absolute_motion (device->device,
-                                                       g_get_monotonic_time (),
-                                                       x, y);
+  /* Only the last position of a burst is delivered, so transforming it,
+   * which for window streams means going through the actor transforms,
+   * is deferred until the burst is flushed */
+  device->pending_viewport = viewport;
+  device->pending_x = eis_event_pointer_get_absolute_x (event);
+  device->pending_y = eis_event_pointer_get_absolute_y (event);
+  device->has_pending_absolute_motion = TRUE;
 }
 
 static void
@@ -685,6 +724,22 @@ meta_eis_client_process_event (MetaEisClient    *client,
   enum eis_event_type type = eis_event_get_type (event);
   struct eis_seat *eis_seat;
 
+  switch (type)
+    {
+    case EIS_EVENT_BUTTON_BUTTON:
+    case EIS_EVENT_SCROLL_DELTA:
+    case EIS_EVENT_SCROLL_STOP:
+    case EIS_EVENT_SCROLL_CANCEL:
+    case EIS_EVENT_SCROLL_DISCRETE:
+    case EIS_EVENT_KEYBOARD_KEY:
+    case EIS_EVENT_DEVICE_STOP_EMULATING:
+      /* Don't reorder anything else relative to the coalesced motion */
+      flush_pending_motion (eis_device_get_user_data (eis_event_get_device (event)));
+      break;
+    default:
+      break;
+    }
+
   switch (type)
     {
     case EIS_EVENT_SEAT_BIND:
@@ -744,7 +799,9 @@ meta_eis_client_process_event (MetaEisClient    *client,
       handle_key (client, event);
       break;
     case EIS_EVENT_FRAME:
-      /* FIXME: we should be accumulating the above events */
+      /* Motion is accumulated over all frames received in one go, and
+       * applied once the whole burst was processed, see
+       * meta_eis_client_flush_events() */
       break;
     case EIS_EVENT_DEVICE_START_EMULATING:
       break;
@@ -758,6 +815,25 @@ meta_eis_client_process_event (MetaEisClient    *client,
   return TRUE;
 }
 
+/**
+ * meta_eis_client_flush_events:
+ * @client: a #MetaEisClient
+ *
+ * Emits the events that were held back while processing the events
+ * dispatched from the client so far, i.e. a single motion event per device
+ * for any number of motion events received since the last flush.
+ */
+void
+meta_eis_client_flush_events (MetaEisClient *client)
+{
+  GHashTableIter iter;
+  MetaEisDevice *device;
+
+  g_hash_table_iter_init (&iter, client->eis_devices);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &device))
+    flush_pending_motion (device);
+}
+
 static gboolean
 drop_abs_devices (gpointer key,
                   gpointer value,
@@ -122,12 +122,19 @@ static void
 process_events (MetaEis *eis)
 {
   struct eis_event *e;
+  GHashTableIter iter;
+  MetaEisClient *client;
 
   while ((e = eis_get_event (eis->eis)))
     {
       process_event (eis, e);
       eis_event_unref (e);
     }
+
+  /* Apply the held back events of the whole burst at once */
+  g_hash_table_iter_init (&iter, eis->eis_clients);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &client))
+    meta_eis_client_flush_events (client);
 }
 
 static MetaEventSource *
@@ -34,7 +34,7 @@ typedef struct
   GDestroyNotify            notify;
   guint64                   timeout_msec;
   int                       idle_source_id;
-  GSource                  *timeout_source;
+  gboolean                  fired;
 } MetaIdleMonitorWatch;
 
 struct _MetaIdleMonitorClass
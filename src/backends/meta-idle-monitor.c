@@ -61,6 +61,12 @@ struct _MetaIdleMonitor
   GHashTable *watches;
   ClutterInputDevice *device;
   int64_t last_event_time;
+
+  /* Idle watches sorted by timeout, all sharing a single timeout source */
+  GList *idle_watches;
+  GSource *timeout_source;
+  gboolean has_fired_watches;
+  unsigned int n_user_active_watches;
 };
 
 G_DEFINE_TYPE (MetaIdleMonitor, meta_idle_monitor, G_TYPE_OBJECT)
@@ -77,6 +83,12 @@ meta_idle_monitor_watch_fire (MetaIdleMonitorWatch *watch)
 
   g_clear_handle_id (&watch->idle_source_id, g_source_remove);
 
+  if (watch->timeout_msec != 0)
+    {
+      watch->fired = TRUE;
+      monitor->has_fired_watches = TRUE;
+    }
+
   id = watch->id;
   is_user_active_watch = (watch->timeout_msec == 0);
 
@@ -97,6 +109,12 @@ meta_idle_monitor_dispose (GObject *object)
   g_clear_pointer (&monitor->watches, g_hash_table_destroy);
   g_clear_object (&monitor->session_proxy);
 
+  if (monitor->timeout_source)
+    {
+      g_source_destroy (monitor->timeout_source);
+      g_clear_pointer (&monitor->timeout_source, g_source_unref);
+    }
+
   G_OBJECT_CLASS (meta_idle_monitor_parent_class)->dispose (object);
 }
 
@@ -172,34 +190,73 @@ free_watch (gpointer data)
   if (watch->notify != NULL)
     watch->notify (watch->user_data);
 
-  if (watch->timeout_source != NULL)
-    g_source_destroy (watch->timeout_source);
+  if (watch->timeout_msec == 0)
+    monitor->n_user_active_watches--;
+  else
+    monitor->idle_watches = g_list_remove (monitor->idle_watches, watch);
 
   g_object_unref (monitor);
   g_free (watch);
 }
 
-static void
-update_inhibited_watch (gpointer key,
-                        gpointer value,
-                        gpointer user_data)
+static int64_t
+get_watch_ready_time (MetaIdleMonitor      *monitor,
+                      MetaIdleMonitorWatch *watch)
 {
-  MetaIdleMonitor *monitor = user_data;
-  MetaIdleMonitorWatch *watch = value;
+  return monitor->last_event_time + watch->timeout_msec * 1000;
+}
 
-  if (!watch->timeout_source)
-    return;
+static MetaIdleMonitorWatch *
+find_next_idle_watch (MetaIdleMonitor *monitor)
+{
+  GList *l;
 
-  if (monitor->inhibited)
+  for (l = monitor->idle_watches; l; l = l->next)
     {
-      g_source_set_ready_time (watch->timeout_source, -1);
+      MetaIdleMonitorWatch *watch = l->data;
+
+      if (!watch->fired)
+        return watch;
     }
+
+  return NULL;
+}
+
+/*
+ * The timeout source is armed for the earliest watch that hasn't fired
+ * since the last user activity. User activity doesn't rearm it, as that
+ * only moves the deadlines later; when the source wakes up early, it
+ * simply rearms itself for the actual deadline.
+ */
+static void
+update_timeout_source (MetaIdleMonitor *monitor)
+{
+  MetaIdleMonitorWatch *watch;
+
+  watch = find_next_idle_watch (monitor);
+  if (!watch || monitor->inhibited)
+    g_source_set_ready_time (monitor->timeout_source, -1);
   else
+    g_source_set_ready_time (monitor->timeout_source,
+                             get_watch_ready_time (monitor, watch));
+}
+
+static void
+reset_fired_watches (MetaIdleMonitor *monitor)
+{
+  GList *l;
+
+  if (!monitor->has_fired_watches)
+    return;
+
+  for (l = monitor->idle_watches; l; l = l->next)
     {
-      g_source_set_ready_time (watch->timeout_source,
-                               monitor->last_event_time +
-                               watch->timeout_msec * 1000);
+      MetaIdleMonitorWatch *watch = l->data;
+
+      watch->fired = FALSE;
     }
+
+  monitor->has_fired_watches = FALSE;
 }
 
 static void
@@ -211,9 +268,10 @@ update_inhibited (MetaIdleMonitor *monitor,
 
   monitor->inhibited = inhibited;
 
-  g_hash_table_foreach (monitor->watches,
-                        update_inhibited_watch,
-                        monitor);
+  if (!inhibited)
+    reset_fired_watches (monitor);
+
+  update_timeout_source (monitor);
 }
 
 static void
@@ -239,6 +297,42 @@ meta_idle_monitor_inhibited_actions_changed (GDBusProxy  *session,
     }
 }
 
+static gboolean
+idle_monitor_dispatch_timeout (GSource     *source,
+                               GSourceFunc  callback,
+                               gpointer     user_data)
+{
+  MetaIdleMonitor *monitor = META_IDLE_MONITOR (user_data);
+  MetaIdleMonitorWatch *watch;
+  int64_t now;
+
+  g_object_ref (monitor);
+
+  now = g_source_get_time (source);
+
+  /* Watches may be added or removed by the callbacks, so look up the next
+   * one again after firing each.
+   */
+  while ((watch = find_next_idle_watch (monitor)) &&
+         !monitor->inhibited &&
+         get_watch_ready_time (monitor, watch) <= now)
+    meta_idle_monitor_watch_fire (watch);
+
+  if (monitor->timeout_source)
+    update_timeout_source (monitor);
+
+  g_object_unref (monitor);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs idle_monitor_source_funcs = {
+  .prepare = NULL,
+  .check = NULL,
+  .dispatch = idle_monitor_dispatch_timeout,
+  .finalize = NULL,
+};
+
 static void
 meta_idle_monitor_init (MetaIdleMonitor *monitor)
 {
@@ -247,6 +341,12 @@ meta_idle_monitor_init (MetaIdleMonitor *monitor)
   monitor->watches = g_hash_table_new_full (NULL, NULL, NULL, free_watch);
   monitor->last_event_time = g_get_monotonic_time ();
 
+  monitor->timeout_source = g_source_new (&idle_monitor_source_funcs,
+                                          sizeof (GSource));
+  g_source_set_name (monitor->timeout_source, "[mutter] Idle monitor");
+  g_source_set_callback (monitor->timeout_source, NULL, monitor, NULL);
+  g_source_attach (monitor->timeout_source, NULL);
+
   /* Monitor inhibitors */
   monitor->session_proxy =
     g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SESSION,
@@ -285,34 +385,21 @@ get_next_watch_serial (void)
   return serial;
 }
 
-static gboolean
-idle_monitor_dispatch_timeout (GSource     *source,
-                               GSourceFunc  callback,
-                               gpointer     user_data)
+static int
+compare_watch_timeouts (gconstpointer a,
+                        gconstpointer b)
 {
-  MetaIdleMonitorWatch *watch = (MetaIdleMonitorWatch *) user_data;
-  int64_t now;
-  int64_t ready_time;
-
-  now = g_source_get_time (source);
-  ready_time = g_source_get_ready_time (source);
-  if (ready_time > now)
-    return G_SOURCE_CONTINUE;
+  const MetaIdleMonitorWatch *watch_a = a;
+  const MetaIdleMonitorWatch *watch_b = b;
 
-  g_source_set_ready_time (watch->timeout_source, -1);
-
-  meta_idle_monitor_watch_fire (watch);
-
-  return G_SOURCE_CONTINUE;
+  if (watch_a->timeout_msec < watch_b->timeout_msec)
+    return -1;
+  else if (watch_a->timeout_msec > watch_b->timeout_msec)
+    return 1;
+  else
+    return 0;
 }
 
-static GSourceFuncs idle_monitor_source_funcs = {
-  .prepare = NULL,
-  .check = NULL,
-  .dispatch = idle_monitor_dispatch_timeout,
-  .finalize = NULL,
-};
-
 static MetaIdleMonitorWatch *
 make_watch (MetaIdleMonitor           *monitor,
             guint64                    timeout_msec,
@@ -331,28 +418,22 @@ make_watch (MetaIdleMonitor           *monitor,
   watch->notify = notify;
   watch->timeout_msec = timeout_msec;
 
+  g_hash_table_insert (monitor->watches,
+                       GUINT_TO_POINTER (watch->id),
+                       watch);
+
   if (timeout_msec != 0)
     {
-      GSource *source = g_source_new (&idle_monitor_source_funcs,
-                                      sizeof (GSource));
-      g_source_set_name (source, "[mutter] Idle monitor");
-
-      g_source_set_callback (source, NULL, watch, NULL);
-      if (!monitor->inhibited)
-        {
-          g_source_set_ready_time (source,
-                                   monitor->last_event_time +
-                                   timeout_msec * 1000);
-        }
-      g_source_attach (source, NULL);
-      g_source_unref (source);
-
-      watch->timeout_source = source;
+      monitor->idle_watches = g_list_insert_sorted (monitor->idle_watches,
+                                                    watch,
+                                                    compare_watch_timeouts);
+      update_timeout_source (monitor);
+    }
+  else
+    {
+      monitor->n_user_active_watches++;
     }
 
-  g_hash_table_insert (monitor->watches,
-                       GUINT_TO_POINTER (watch->id),
-                       watch);
   return watch;
 }
 
@@ -470,42 +551,38 @@ meta_idle_monitor_get_idletime (MetaIdleMonitor *monitor)
 void
 meta_idle_monitor_reset_idletime (MetaIdleMonitor *monitor)
 {
-  GList *node, *watch_ids;
-
   monitor->last_event_time = g_get_monotonic_time ();
 
-  watch_ids = g_hash_table_get_keys (monitor->watches);
+  /* Idle watches that already fired need to be rearmed, as their deadlines
+   * may be earlier than the one the timeout source is armed for.
+   */
+  if (monitor->has_fired_watches)
+    {
+      reset_fired_watches (monitor);
+      update_timeout_source (monitor);
+    }
 
-  for (node = watch_ids; node != NULL; node = node->next)
+  if (monitor->n_user_active_watches > 0)
     {
-      guint watch_id = GPOINTER_TO_UINT (node->data);
-      MetaIdleMonitorWatch *watch;
+      GList *node, *watch_ids;
 
-      watch = g_hash_table_lookup (monitor->watches,
-                                   GUINT_TO_POINTER (watch_id));
-      if (!watch)
-        continue;
+      watch_ids = g_hash_table_get_keys (monitor->watches);
 
-      if (watch->timeout_msec == 0)
+      for (node = watch_ids; node != NULL; node = node->next)
         {
+          guint watch_id = GPOINTER_TO_UINT (node->data);
+          MetaIdleMonitorWatch *watch;
+
+          watch = g_hash_table_lookup (monitor->watches,
+                                       GUINT_TO_POINTER (watch_id));
+          if (!watch || watch->timeout_msec != 0)
+            continue;
+
           meta_idle_monitor_watch_fire (watch);
         }
-      else
-        {
-          if (monitor->inhibited)
-            {
-              g_source_set_ready_time (watch->timeout_source, -1);
-            }
-          else
-            {
-              g_source_set_ready_time (watch->timeout_source,
-                                       monitor->last_event_time +
-                                       watch->timeout_msec * 1000);
-            }
-        }
-    }
 
-  g_list_free (watch_ids);
+      g_list_free (watch_ids);
+    }
 }
 
 MetaIdleManager *
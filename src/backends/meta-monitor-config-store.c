@@ -114,6 +114,7 @@ struct _MetaMonitorConfigStore
   GHashTable *configs;
 
   GCancellable *save_cancellable;
+  guint save_timeout_id;
 
   GFile *user_file;
   GFile *custom_read_file;
@@ -126,6 +127,8 @@ struct _MetaMonitorConfigStore
   MetaMonitorConfigPolicy policy;
 };
 
+#define SAVE_TIMEOUT_MS 500
+
 #define META_MONITOR_CONFIG_STORE_ERROR (meta_monitor_config_store_error_quark ())
 static GQuark meta_monitor_config_store_error_quark (void);
 
@@ -1855,16 +1858,52 @@ meta_monitor_config_store_save (MetaMonitorConfigStore *config_store)
                                  saved_cb, data);
 }
 
-static void
-maybe_save_configs (MetaMonitorConfigStore *config_store)
+static gboolean
+should_save_configs (MetaMonitorConfigStore *config_store)
 {
   /*
    * If a custom file is used, it means we are run by the test suite. When this
    * is done, avoid replacing the user configuration file with test data,
    * except if a custom write file is set as well.
    */
-  if (!config_store->custom_read_file || config_store->custom_write_file)
+  return !config_store->custom_read_file || config_store->custom_write_file;
+}
+
+static gboolean
+save_timeout_cb (gpointer user_data)
+{
+  MetaMonitorConfigStore *config_store = user_data;
+
+  config_store->save_timeout_id = 0;
+
+  if (should_save_configs (config_store))
     meta_monitor_config_store_save (config_store);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+maybe_save_configs (MetaMonitorConfigStore *config_store)
+{
+  if (!should_save_configs (config_store))
+    return;
+
+  if (config_store->custom_write_file)
+    {
+      meta_monitor_config_store_save (config_store);
+      return;
+    }
+
+  /*
+   * Applying a configuration usually adds and removes several configurations
+   * in a row, write them out together instead of rewriting the file for each.
+   */
+  if (config_store->save_timeout_id)
+    return;
+
+  config_store->save_timeout_id = g_timeout_add (SAVE_TIMEOUT_MS,
+                                                 save_timeout_cb,
+                                                 config_store);
 }
 
 static gboolean
@@ -1975,6 +2014,16 @@ meta_monitor_config_store_dispose (GObject *object)
 
       meta_monitor_config_store_save_sync (config_store);
     }
+  else if (config_store->save_timeout_id &&
+           should_save_configs (config_store) &&
+           (!config_store->has_stores_policy ||
+            g_list_find (config_store->stores_policy,
+                         GINT_TO_POINTER (META_CONFIG_STORE_USER))))
+    {
+      meta_monitor_config_store_save_sync (config_store);
+    }
+
+  g_clear_handle_id (&config_store->save_timeout_id, g_source_remove);
 
   g_clear_pointer (&config_store->configs, g_hash_table_destroy);
 
@@ -74,6 +74,20 @@ typedef enum
   META_PRIVACY_SCREEN_CHANGE_STATE_PENDING_SETTING,
 } MetaPrivacyScreenChangeState;
 
+/* What changed in the last rebuild of the logical monitors */
+typedef enum
+{
+  META_MONITORS_CHANGED_FLAG_NONE = 0,
+  META_MONITORS_CHANGED_FLAG_LAYOUT = 1 << 0,
+  META_MONITORS_CHANGED_FLAG_SCALE = 1 << 1,
+  META_MONITORS_CHANGED_FLAG_TRANSFORM = 1 << 2,
+  META_MONITORS_CHANGED_FLAG_PROPERTIES = 1 << 3,
+} MetaMonitorsChangedFlag;
+
+#define META_MONITORS_CHANGED_FLAG_GEOMETRY (META_MONITORS_CHANGED_FLAG_LAYOUT | \
+                                             META_MONITORS_CHANGED_FLAG_SCALE | \
+                                             META_MONITORS_CHANGED_FLAG_TRANSFORM)
+
 /*
  * MetaCrtcAssignment:
  *
@@ -167,6 +181,8 @@ struct _MetaMonitorManager
   MetaMonitorSwitchConfigType current_switch_config;
 
   MetaPrivacyScreenChangeState privacy_screen_change_state;
+
+  MetaMonitorsChangedFlag changed_flags;
 };
 
 /**
@@ -289,6 +305,9 @@ MetaLogicalMonitor *meta_monitor_manager_get_logical_monitor_from_number (MetaMo
 META_EXPORT_TEST
 MetaLogicalMonitor *meta_monitor_manager_get_primary_logical_monitor (MetaMonitorManager *manager);
 
+META_EXPORT_TEST
+MetaMonitorsChangedFlag meta_monitor_manager_get_changed_flags (MetaMonitorManager *manager);
+
 MetaLogicalMonitor *meta_monitor_manager_get_logical_monitor_at (MetaMonitorManager *manager,
                                                                  float               x,
                                                                  float               y);
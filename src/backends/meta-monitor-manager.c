@@ -3747,6 +3747,79 @@ meta_monitor_manager_update_logical_state (MetaMonitorManager *manager,
   meta_monitor_manager_rebuild_logical_monitors (manager, config);
 }
 
+static gboolean
+logical_monitor_has_same_monitors (MetaLogicalMonitor *logical_monitor,
+                                   MetaLogicalMonitor *other)
+{
+  GList *l, *k;
+
+  for (l = logical_monitor->monitors, k = other->monitors;
+       l && k;
+       l = l->next, k = k->next)
+    {
+      if (!meta_monitor_spec_equals (meta_monitor_get_spec (l->data),
+                                     meta_monitor_get_spec (k->data)))
+        return FALSE;
+    }
+
+  return !l && !k;
+}
+
+static MetaMonitorsChangedFlag
+calculate_changed_flags (MetaMonitorManager *manager,
+                         GList              *old_logical_monitors)
+{
+  MetaMonitorsChangedFlag flags = META_MONITORS_CHANGED_FLAG_PROPERTIES;
+  GList *l, *k;
+
+  if (g_list_length (old_logical_monitors) !=
+      g_list_length (manager->logical_monitors))
+    return flags | META_MONITORS_CHANGED_FLAG_GEOMETRY;
+
+  for (l = old_logical_monitors, k = manager->logical_monitors;
+       l && k;
+       l = l->next, k = k->next)
+    {
+      MetaLogicalMonitor *old_logical_monitor = l->data;
+      MetaLogicalMonitor *logical_monitor = k->data;
+
+      if (old_logical_monitor->number != logical_monitor->number ||
+          old_logical_monitor->is_primary != logical_monitor->is_primary ||
+          old_logical_monitor->winsys_id != logical_monitor->winsys_id ||
+          !mtk_rectangle_equal (&old_logical_monitor->rect,
+                                &logical_monitor->rect) ||
+          !logical_monitor_has_same_monitors (old_logical_monitor,
+                                              logical_monitor))
+        flags |= META_MONITORS_CHANGED_FLAG_LAYOUT;
+
+      if (!G_APPROX_VALUE (old_logical_monitor->scale, logical_monitor->scale,
+                           FLT_EPSILON))
+        flags |= META_MONITORS_CHANGED_FLAG_SCALE;
+
+      if (old_logical_monitor->transform != logical_monitor->transform)
+        flags |= META_MONITORS_CHANGED_FLAG_TRANSFORM;
+    }
+
+  return flags;
+}
+
+/**
+ * meta_monitor_manager_get_changed_flags:
+ * @manager: A #MetaMonitorManager object
+ *
+ * Returns what changed when the logical monitors were last rebuilt. Logical
+ * monitors are always recreated, so references to them must be updated
+ * regardless, but handlers of #MetaMonitorManager::monitors-changed can use
+ * this to avoid relayouting when the geometry stayed the same.
+ *
+ * Returns: the #MetaMonitorsChangedFlag of the last change
+ */
+MetaMonitorsChangedFlag
+meta_monitor_manager_get_changed_flags (MetaMonitorManager *manager)
+{
+  return manager->changed_flags;
+}
+
 void
 meta_monitor_manager_rebuild (MetaMonitorManager *manager,
                               MetaMonitorsConfig *config)
@@ -3761,6 +3834,8 @@ meta_monitor_manager_rebuild (MetaMonitorManager *manager,
   old_logical_monitors = manager->logical_monitors;
 
   meta_monitor_manager_update_logical_state (manager, config);
+  manager->changed_flags = calculate_changed_flags (manager,
+                                                    old_logical_monitors);
 
   ensure_privacy_screen_settings (manager);
   ensure_hdr_settings (manager);
@@ -3812,6 +3887,8 @@ meta_monitor_manager_rebuild_derived (MetaMonitorManager *manager,
   old_logical_monitors = manager->logical_monitors;
 
   meta_monitor_manager_update_logical_state_derived (manager, config);
+  manager->changed_flags = calculate_changed_flags (manager,
+                                                    old_logical_monitors);
 
   meta_monitor_manager_notify_monitors_changed (manager);
 
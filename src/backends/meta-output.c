@@ -36,6 +36,11 @@ enum
 
 static GParamSpec *obj_props[N_PROPS];
 
+#define MAX_CACHED_EDIDS 32
+
+G_LOCK_DEFINE_STATIC (edid_cache);
+static GHashTable *edid_cache;
+
 enum
 {
   COLOR_SPACE_CHANGED,
@@ -111,7 +116,7 @@ meta_output_info_unref (MetaOutputInfo *output_info)
       g_free (output_info->product);
       g_free (output_info->serial);
       g_free (output_info->edid_checksum_md5);
-      g_free (output_info->edid_info);
+      g_clear_pointer (&output_info->edid_info, meta_edid_info_free);
       g_free (output_info->modes);
       g_free (output_info->possible_crtcs);
       g_free (output_info->possible_clones);
@@ -354,6 +359,54 @@ set_output_details_from_edid (MetaOutputInfo *output_info,
     }
 }
 
+/* Outputs are recreated on every reprobe, with the same EDID most of the
+ * time, so keep the parsed EDIDs of the most recently seen blobs around.
+ */
+static MetaEdidInfo *
+parse_edid_cached (GBytes *edid)
+{
+  MetaEdidInfo *edid_info;
+  size_t size;
+  gconstpointer data;
+
+  G_LOCK (edid_cache);
+  if (edid_cache)
+    {
+      edid_info = g_hash_table_lookup (edid_cache, edid);
+      if (edid_info)
+        {
+          edid_info = meta_edid_info_copy (edid_info);
+          G_UNLOCK (edid_cache);
+          return edid_info;
+        }
+    }
+  G_UNLOCK (edid_cache);
+
+  data = g_bytes_get_data (edid, &size);
+  edid_info = meta_edid_info_new_parse (data, size);
+  if (!edid_info)
+    return NULL;
+
+  G_LOCK (edid_cache);
+  if (!edid_cache)
+    {
+      edid_cache = g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+                                          (GDestroyNotify) g_bytes_unref,
+                                          (GDestroyNotify) meta_edid_info_free);
+    }
+  else if (g_hash_table_size (edid_cache) >= MAX_CACHED_EDIDS)
+    {
+      g_hash_table_remove_all (edid_cache);
+    }
+
+  g_hash_table_replace (edid_cache,
+                        g_bytes_ref (edid),
+                        meta_edid_info_copy (edid_info));
+  G_UNLOCK (edid_cache);
+
+  return edid_info;
+}
+
 void
 meta_output_info_parse_edid (MetaOutputInfo *output_info,
                              GBytes         *edid)
@@ -366,7 +419,7 @@ meta_output_info_parse_edid (MetaOutputInfo *output_info,
   g_return_if_fail (edid);
 
   data = g_bytes_get_data (edid, &size);
-  edid_info = meta_edid_info_new_parse (data, size);
+  edid_info = parse_edid_cached (edid);
 
   output_info->edid_checksum_md5 = g_compute_checksum_for_data (G_CHECKSUM_MD5,
                                                                 data, size);
@@ -557,6 +610,25 @@ meta_output_info_get_min_refresh_rate (const MetaOutputInfo *output_info,
   return TRUE;
 }
 
+gboolean
+meta_output_info_get_max_refresh_rate (const MetaOutputInfo *output_info,
+                                       int                  *max_refresh_rate)
+{
+  int max_vert_rate_hz;
+
+  if (!output_info->edid_info)
+    return FALSE;
+
+  max_vert_rate_hz = output_info->edid_info->max_vert_rate_hz;
+
+  if (max_vert_rate_hz <= 0)
+    return FALSE;
+
+  *max_refresh_rate = max_vert_rate_hz;
+
+  return TRUE;
+}
+
 gboolean
 meta_output_is_color_space_supported (MetaOutput           *output,
                                       MetaOutputColorspace  color_space)
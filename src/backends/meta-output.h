@@ -151,6 +151,7 @@ typedef struct _MetaOutputInfo
 
   gboolean supports_underscanning;
   gboolean supports_color_transform;
+  gboolean supports_vrr;
 
   unsigned int max_bpc_min;
   unsigned int max_bpc_max;
@@ -195,6 +196,9 @@ gboolean meta_output_info_is_color_space_supported (const MetaOutputInfo *output
 gboolean meta_output_info_get_min_refresh_rate (const MetaOutputInfo *output_info,
                                                 int                  *min_refresh_rate);
 
+gboolean meta_output_info_get_max_refresh_rate (const MetaOutputInfo *output_info,
+                                                int                  *max_refresh_rate);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaOutputInfo, meta_output_info_unref)
 
 #define META_TYPE_OUTPUT (meta_output_get_type ())
@@ -54,6 +54,10 @@ typedef struct _MetaRendererViewPrivate
   MetaMonitorTransform transform;
 
   MetaCrtc *crtc;
+
+  MetaRendererViewVrrPolicy vrr_policy;
+  gboolean has_frame_sync_surface;
+  gboolean allows_tearing;
 } MetaRendererViewPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaRendererView, meta_renderer_view,
@@ -77,6 +81,110 @@ meta_renderer_view_get_crtc (MetaRendererView *view)
   return priv->crtc;
 }
 
+static void
+update_frame_clock_mode (MetaRendererView *view)
+{
+  MetaRendererViewPrivate *priv =
+    meta_renderer_view_get_instance_private (view);
+  ClutterFrameClock *frame_clock =
+    clutter_stage_view_get_frame_clock (CLUTTER_STAGE_VIEW (view));
+  ClutterFrameClockMode mode;
+
+  switch (priv->vrr_policy)
+    {
+    case META_RENDERER_VIEW_VRR_POLICY_FULLSCREEN:
+      mode = priv->has_frame_sync_surface ? CLUTTER_FRAME_CLOCK_MODE_VARIABLE
+                                          : CLUTTER_FRAME_CLOCK_MODE_FIXED;
+      break;
+    case META_RENDERER_VIEW_VRR_POLICY_ALWAYS:
+      mode = CLUTTER_FRAME_CLOCK_MODE_VARIABLE;
+      break;
+    case META_RENDERER_VIEW_VRR_POLICY_NEVER:
+    default:
+      mode = CLUTTER_FRAME_CLOCK_MODE_FIXED;
+      break;
+    }
+
+  /* Presenting immediately takes precedence over following the surface
+   * with a variable refresh rate */
+  if (priv->allows_tearing)
+    mode = CLUTTER_FRAME_CLOCK_MODE_TEARING;
+
+  if (frame_clock)
+    clutter_frame_clock_set_mode (frame_clock, mode);
+}
+
+void
+meta_renderer_view_set_vrr_policy (MetaRendererView          *view,
+                                   MetaRendererViewVrrPolicy  vrr_policy)
+{
+  MetaRendererViewPrivate *priv =
+    meta_renderer_view_get_instance_private (view);
+
+  if (priv->vrr_policy == vrr_policy)
+    return;
+
+  priv->vrr_policy = vrr_policy;
+  update_frame_clock_mode (view);
+  clutter_stage_view_schedule_update (CLUTTER_STAGE_VIEW (view));
+}
+
+MetaRendererViewVrrPolicy
+meta_renderer_view_get_vrr_policy (MetaRendererView *view)
+{
+  MetaRendererViewPrivate *priv =
+    meta_renderer_view_get_instance_private (view);
+
+  return priv->vrr_policy;
+}
+
+/**
+ * meta_renderer_view_set_has_frame_sync_surface:
+ * @view: a #MetaRendererView
+ * @has_frame_sync_surface: whether a single surface drives the view contents
+ *
+ * Tells the view whether there currently is a surface covering the whole
+ * view, that the refresh rate of the display can follow when the variable
+ * refresh rate policy is %META_RENDERER_VIEW_VRR_POLICY_FULLSCREEN.
+ */
+void
+meta_renderer_view_set_has_frame_sync_surface (MetaRendererView *view,
+                                               gboolean          has_frame_sync_surface)
+{
+  MetaRendererViewPrivate *priv =
+    meta_renderer_view_get_instance_private (view);
+
+  if (priv->has_frame_sync_surface == has_frame_sync_surface)
+    return;
+
+  priv->has_frame_sync_surface = has_frame_sync_surface;
+  update_frame_clock_mode (view);
+}
+
+/**
+ * meta_renderer_view_set_allows_tearing:
+ * @view: a #MetaRendererView
+ * @allows_tearing: whether the view contents may be presented with tearing
+ *
+ * Tells the view whether the surface driving its contents asked to be
+ * presented without waiting for vertical blanking. While set, the frame
+ * clock of the view dispatches updates as soon as possible, and scanouts
+ * are flipped asynchronously.
+ */
+void
+meta_renderer_view_set_allows_tearing (MetaRendererView *view,
+                                       gboolean          allows_tearing)
+{
+  MetaRendererViewPrivate *priv =
+    meta_renderer_view_get_instance_private (view);
+
+  if (priv->allows_tearing == allows_tearing)
+    return;
+
+  priv->allows_tearing = allows_tearing;
+  update_frame_clock_mode (view);
+}
+
 static void
 meta_renderer_view_get_offscreen_transformation_matrix (ClutterStageView  *view,
                                                         graphene_matrix_t *matrix)
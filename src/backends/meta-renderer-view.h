@@ -21,6 +21,17 @@
 #include "backends/meta-stage-impl-private.h"
 #include "backends/meta-stage-view-private.h"
 
+typedef enum _MetaRendererViewVrrPolicy
+{
+  /* Never enable variable refresh rate on the view. */
+  META_RENDERER_VIEW_VRR_POLICY_NEVER,
+  /* Enable variable refresh rate on the output, and let the frame clock run
+   * in variable mode while a surface covers the whole view. */
+  META_RENDERER_VIEW_VRR_POLICY_FULLSCREEN,
+  /* Always drive the frame clock in variable mode. */
+  META_RENDERER_VIEW_VRR_POLICY_ALWAYS,
+} MetaRendererViewVrrPolicy;
+
 #define META_TYPE_RENDERER_VIEW (meta_renderer_view_get_type ())
 META_EXPORT_TEST
 G_DECLARE_DERIVABLE_TYPE (MetaRendererView, meta_renderer_view,
@@ -36,3 +47,14 @@ MetaMonitorTransform meta_renderer_view_get_transform (MetaRendererView *view);
 
 META_EXPORT_TEST
 MetaCrtc *meta_renderer_view_get_crtc (MetaRendererView *view);
+
+void meta_renderer_view_set_vrr_policy (MetaRendererView          *view,
+                                        MetaRendererViewVrrPolicy  vrr_policy);
+
+MetaRendererViewVrrPolicy meta_renderer_view_get_vrr_policy (MetaRendererView *view);
+
+void meta_renderer_view_set_has_frame_sync_surface (MetaRendererView *view,
+                                                    gboolean          has_frame_sync_surface);
+
+void meta_renderer_view_set_allows_tearing (MetaRendererView *view,
+                                            gboolean          allows_tearing);
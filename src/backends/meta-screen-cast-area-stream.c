@@ -89,6 +89,7 @@ meta_screen_cast_area_stream_new (MetaScreenCastSession     *session,
                                   GDBusConnection           *connection,
                                   MtkRectangle              *area,
                                   ClutterStage              *stage,
+                                  float                      max_scale,
                                   MetaScreenCastCursorMode   cursor_mode,
                                   MetaScreenCastFlag         flags,
                                   GError                   **error)
@@ -103,6 +104,11 @@ meta_screen_cast_area_stream_new (MetaScreenCastSession     *session,
       return NULL;
     }
 
+  /* Painting at a lower scale renders the area directly at the size the
+   * stream is consumed at, rather than at the monitor resolution. */
+  if (max_scale > 0.0f)
+    scale = MIN (scale, max_scale);
+
   area_stream = g_initable_new (META_TYPE_SCREEN_CAST_AREA_STREAM,
                                 NULL,
                                 error,
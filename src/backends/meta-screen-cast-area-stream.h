@@ -33,6 +33,7 @@ MetaScreenCastAreaStream * meta_screen_cast_area_stream_new (MetaScreenCastSessi
                                                              GDBusConnection           *connection,
                                                              MtkRectangle              *area,
                                                              ClutterStage              *stage,
+                                                             float                      max_scale,
                                                              MetaScreenCastCursorMode   cursor_mode,
                                                              MetaScreenCastFlag         flags,
                                                              GError                   **error);
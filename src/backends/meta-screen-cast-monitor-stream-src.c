@@ -40,7 +40,11 @@ struct _MetaScreenCastMonitorStreamSrc
   MetaScreenCastStreamSrc parent;
 
   gboolean cursor_bitmap_invalid;
-  gboolean hw_cursor_inhibited;
+
+  /* Where the cursor was drawn into the stream in the last frame, when it
+   * is shown using a hardware cursor plane, in stream coordinates */
+  gboolean has_cursor_rect;
+  MtkRectangle cursor_rect;
 
   GList *watches;
 
@@ -51,14 +55,9 @@ struct _MetaScreenCastMonitorStreamSrc
   guint maybe_record_idle_id;
 };
 
-static void
-hw_cursor_inhibitor_iface_init (MetaHwCursorInhibitorInterface *iface);
-
-G_DEFINE_TYPE_WITH_CODE (MetaScreenCastMonitorStreamSrc,
-                         meta_screen_cast_monitor_stream_src,
-                         META_TYPE_SCREEN_CAST_STREAM_SRC,
-                         G_IMPLEMENT_INTERFACE (META_TYPE_HW_CURSOR_INHIBITOR,
-                                                hw_cursor_inhibitor_iface_init))
+G_DEFINE_TYPE (MetaScreenCastMonitorStreamSrc,
+               meta_screen_cast_monitor_stream_src,
+               META_TYPE_SCREEN_CAST_STREAM_SRC)
 
 static MetaBackend *
 get_backend (MetaScreenCastMonitorStreamSrc *monitor_src)
@@ -162,6 +161,8 @@ stage_painted (MetaStage        *stage,
     META_SCREEN_CAST_RECORD_RESULT_RECORDED_NOTHING;
   int64_t presentation_time_us;
 
+  meta_screen_cast_stream_src_add_view_damage (src, view, redraw_clip);
+
   if (monitor_src->maybe_record_idle_id)
     return;
 
@@ -205,13 +206,16 @@ before_stage_painted (MetaStage        *stage,
   MetaScreenCastRecordFlag flags;
   int64_t presentation_time_us;
 
-  if (monitor_src->maybe_record_idle_id)
+  if (!clutter_stage_view_peek_scanout (view))
     return;
 
-  if (!meta_screen_cast_stream_src_uses_dma_bufs (src))
+  /* A directly scanned out buffer isn't painted, so there is no damage */
+  meta_screen_cast_stream_src_add_buffer_damage (src, NULL);
+
+  if (monitor_src->maybe_record_idle_id)
     return;
 
-  if (!clutter_stage_view_peek_scanout (view))
+  if (!meta_screen_cast_stream_src_uses_dma_bufs (src))
     return;
 
   if (!clutter_frame_get_target_presentation_time (frame, &presentation_time_us))
@@ -309,6 +313,42 @@ sync_cursor_state (MetaScreenCastMonitorStreamSrc *monitor_src)
                                                   NULL);
 }
 
+static void
+queue_minimal_redraw (MetaScreenCastMonitorStreamSrc *monitor_src)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  ClutterStage *stage = get_stage (monitor_src);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  MtkRectangle logical_monitor_layout;
+  GList *l;
+
+  monitor = get_monitor (monitor_src);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      MetaRendererView *view = l->data;
+      MtkRectangle view_layout;
+      MtkRectangle damage;
+
+      clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
+
+      if (!mtk_rectangle_overlap (&logical_monitor_layout, &view_layout))
+        continue;
+
+      damage = (MtkRectangle) {
+        .x = view_layout.x,
+        .y = view_layout.y,
+        .width = 1,
+        .height = 1,
+      };
+      clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (stage), &damage);
+    }
+}
+
 static void
 pointer_position_invalidated (MetaCursorTracker              *cursor_tracker,
                               MetaScreenCastMonitorStreamSrc *monitor_src)
@@ -326,43 +366,38 @@ cursor_changed (MetaCursorTracker              *cursor_tracker,
   sync_cursor_state (monitor_src);
 }
 
-static void
-on_prepare_frame (ClutterStage                   *stage,
-                  ClutterStageView               *stage_view,
-                  ClutterFrame                   *frame,
-                  MetaScreenCastMonitorStreamSrc *monitor_src)
+static gboolean
+is_cursor_drawn_into_stream (MetaScreenCastMonitorStreamSrc *monitor_src)
 {
-  sync_cursor_state (monitor_src);
+  MetaBackend *backend = get_backend (monitor_src);
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+
+  return (!meta_cursor_renderer_is_overlay_visible (cursor_renderer) &&
+          is_cursor_in_stream (monitor_src));
 }
 
 static void
-inhibit_hw_cursor (MetaScreenCastMonitorStreamSrc *monitor_src)
+embedded_cursor_invalidated (MetaCursorTracker              *cursor_tracker,
+                             MetaScreenCastMonitorStreamSrc *monitor_src)
 {
-  MetaHwCursorInhibitor *inhibitor;
-  MetaBackend *backend;
-
-  g_return_if_fail (!monitor_src->hw_cursor_inhibited);
-
-  backend = get_backend (monitor_src);
-  inhibitor = META_HW_CURSOR_INHIBITOR (monitor_src);
-  meta_backend_add_hw_cursor_inhibitor (backend, inhibitor);
+  /* A cursor on a hardware cursor plane doesn't cause the stage to be
+   * painted when it moves or changes, so paint the least possible, to
+   * get a frame in which the cursor is drawn into the stream again. */
+  if (!monitor_src->has_cursor_rect &&
+      !is_cursor_drawn_into_stream (monitor_src))
+    return;
 
-  monitor_src->hw_cursor_inhibited = TRUE;
+  queue_minimal_redraw (monitor_src);
 }
 
 static void
-uninhibit_hw_cursor (MetaScreenCastMonitorStreamSrc *monitor_src)
+on_prepare_frame (ClutterStage                   *stage,
+                  ClutterStageView               *stage_view,
+                  ClutterFrame                   *frame,
+                  MetaScreenCastMonitorStreamSrc *monitor_src)
 {
-  MetaHwCursorInhibitor *inhibitor;
-  MetaBackend *backend;
-
-  g_return_if_fail (monitor_src->hw_cursor_inhibited);
-
-  backend = get_backend (monitor_src);
-  inhibitor = META_HW_CURSOR_INHIBITOR (monitor_src);
-  meta_backend_remove_hw_cursor_inhibitor (backend, inhibitor);
-
-  monitor_src->hw_cursor_inhibited = FALSE;
+  sync_cursor_state (monitor_src);
 }
 
 static void
@@ -421,6 +456,8 @@ reattach_watches (MetaScreenCastMonitorStreamSrc *monitor_src)
     meta_stage_remove_watch (META_STAGE (stage), l->data);
   g_clear_pointer (&monitor_src->watches, g_list_free);
 
+  meta_screen_cast_stream_src_add_buffer_damage (src, NULL);
+
   add_view_watches (monitor_src,
                     META_STAGE_WATCH_BEFORE_PAINT,
                     before_stage_painted);
@@ -482,7 +519,14 @@ meta_screen_cast_monitor_stream_src_enable (MetaScreenCastStreamSrc *src)
     case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
       break;
     case META_SCREEN_CAST_CURSOR_MODE_EMBEDDED:
-      inhibit_hw_cursor (monitor_src);
+      monitor_src->position_invalidated_handler_id =
+        g_signal_connect_after (cursor_tracker, "position-invalidated",
+                                G_CALLBACK (embedded_cursor_invalidated),
+                                monitor_src);
+      monitor_src->cursor_changed_handler_id =
+        g_signal_connect_after (cursor_tracker, "cursor-changed",
+                                G_CALLBACK (embedded_cursor_invalidated),
+                                monitor_src);
       meta_cursor_tracker_track_position (cursor_tracker);
       break;
     }
@@ -518,8 +562,7 @@ meta_screen_cast_monitor_stream_src_disable (MetaScreenCastStreamSrc *src)
     }
   g_clear_pointer (&monitor_src->watches, g_list_free);
 
-  if (monitor_src->hw_cursor_inhibited)
-    uninhibit_hw_cursor (monitor_src);
+  monitor_src->has_cursor_rect = FALSE;
 
   g_clear_signal_handler (&monitor_src->position_invalidated_handler_id,
                           cursor_tracker);
@@ -553,6 +596,9 @@ meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc
   MetaScreenCastMonitorStreamSrc *monitor_src =
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
   MetaScreenCastStream *stream = meta_screen_cast_stream_src_get_stream (src);
+  MetaScreenCastSession *session = meta_screen_cast_stream_get_session (stream);
+  MetaScreenCast *screen_cast =
+    meta_screen_cast_session_get_screen_cast (session);
   MetaBackend *backend = get_backend (monitor_src);
   ClutterStage *stage;
   MetaMonitor *monitor;
@@ -580,17 +626,124 @@ meta_screen_cast_monitor_stream_src_record_to_buffer (MetaScreenCastStreamSrc
       break;
     }
 
-  if (!clutter_stage_paint_to_buffer (stage, &logical_monitor->rect, scale,
-                                      data,
-                                      stride,
-                                      COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
-                                      paint_flags,
-                                      error))
+  if (!meta_screen_cast_paint_stage_to_buffer (screen_cast,
+                                               stage,
+                                               &logical_monitor->rect, scale,
+                                               data,
+                                               stride,
+                                               paint_flags,
+                                               error))
     return FALSE;
 
   return TRUE;
 }
 
+/*
+ * Keeps track of where the cursor is to be drawn into the stream, and
+ * reports both where it was drawn in the previous frame and where it will
+ * be drawn now as damage, so that buffers reused by the stream get the
+ * cursor removed from its old position.
+ */
+static gboolean
+track_cursor_damage (MetaScreenCastMonitorStreamSrc *monitor_src,
+                     float                           view_scale,
+                     int                             x,
+                     int                             y)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (monitor_src);
+  MetaBackend *backend = get_backend (monitor_src);
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+  g_autoptr (MtkRegion) damage = NULL;
+  MetaCursorSprite *cursor_sprite;
+  gboolean had_cursor_rect;
+
+  had_cursor_rect = monitor_src->has_cursor_rect;
+  damage = mtk_region_create ();
+
+  if (had_cursor_rect)
+    mtk_region_union_rectangle (damage, &monitor_src->cursor_rect);
+
+  cursor_sprite = meta_cursor_renderer_get_cursor (cursor_renderer);
+  if (cursor_sprite &&
+      meta_cursor_sprite_get_cogl_texture (cursor_sprite) &&
+      is_cursor_drawn_into_stream (monitor_src))
+    {
+      MetaMonitor *monitor = get_monitor (monitor_src);
+      MetaLogicalMonitor *logical_monitor =
+        meta_monitor_get_logical_monitor (monitor);
+      MtkRectangle logical_monitor_layout =
+        meta_logical_monitor_get_layout (logical_monitor);
+      graphene_rect_t cursor_rect;
+
+      cursor_rect = meta_cursor_renderer_calculate_rect (cursor_renderer,
+                                                         cursor_sprite);
+      graphene_rect_offset (&cursor_rect,
+                            -logical_monitor_layout.x,
+                            -logical_monitor_layout.y);
+      graphene_rect_scale (&cursor_rect, view_scale, view_scale, &cursor_rect);
+      mtk_rectangle_from_graphene_rect (&cursor_rect,
+                                        MTK_ROUNDING_STRATEGY_GROW,
+                                        &monitor_src->cursor_rect);
+      monitor_src->has_cursor_rect = TRUE;
+
+      mtk_region_union_rectangle (damage, &monitor_src->cursor_rect);
+    }
+  else
+    {
+      monitor_src->has_cursor_rect = FALSE;
+    }
+
+  if (had_cursor_rect || monitor_src->has_cursor_rect)
+    {
+      mtk_region_translate (damage, -x, -y);
+      meta_screen_cast_stream_src_add_buffer_damage (src, damage);
+    }
+
+  return monitor_src->has_cursor_rect;
+}
+
+static void
+draw_cursor_sprite (MetaScreenCastMonitorStreamSrc *monitor_src,
+                    CoglFramebuffer                *framebuffer)
+{
+  MetaBackend *backend = get_backend (monitor_src);
+  MetaCursorRenderer *cursor_renderer =
+    meta_backend_get_cursor_renderer (backend);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  MetaCursorSprite *cursor_sprite;
+  CoglTexture *cursor_texture;
+  MtkRectangle *rect = &monitor_src->cursor_rect;
+  graphene_matrix_t matrix;
+
+  cursor_sprite = meta_cursor_renderer_get_cursor (cursor_renderer);
+  cursor_texture = meta_cursor_sprite_get_cogl_texture (cursor_sprite);
+
+  pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_layer_texture (pipeline, 0, cursor_texture);
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+
+  graphene_matrix_init_identity (&matrix);
+  meta_monitor_transform_transform_matrix (
+    meta_cursor_sprite_get_texture_transform (cursor_sprite),
+    &matrix);
+  cogl_pipeline_set_layer_matrix (pipeline, 0, &matrix);
+
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0,
+                                 cogl_framebuffer_get_width (framebuffer),
+                                 cogl_framebuffer_get_height (framebuffer),
+                                 -1, 1);
+  cogl_framebuffer_draw_rectangle (framebuffer,
+                                   pipeline,
+                                   rect->x, rect->y,
+                                   rect->x + rect->width,
+                                   rect->y + rect->height);
+}
+
 static gboolean
 meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamSrc   *src,
                                                            MetaScreenCastPaintPhase   paint_phase,
@@ -612,6 +765,9 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
   MtkRectangle view_layout;
   MetaCrtc *crtc;
   gboolean do_stage_paint = TRUE;
+  gboolean embeds_cursor;
+  gboolean is_cursor_tracked = FALSE;
+  gboolean draw_cursor = FALSE;
   float view_scale;
   GList *outputs;
   int x, y;
@@ -625,6 +781,9 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
   else
     view_scale = 1.0;
 
+  embeds_cursor = (meta_screen_cast_stream_get_cursor_mode (stream) ==
+                   META_SCREEN_CAST_CURSOR_MODE_EMBEDDED);
+
   if (paint_phase == META_SCREEN_CAST_PAINT_PHASE_DETACHED)
     goto stage_paint;
 
@@ -643,6 +802,12 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
   x = (int) roundf ((view_layout.x - logical_monitor_layout.x) * view_scale);
   y = (int) roundf ((view_layout.y - logical_monitor_layout.y) * view_scale);
 
+  if (embeds_cursor)
+    {
+      draw_cursor = track_cursor_damage (monitor_src, view_scale, x, y);
+      is_cursor_tracked = TRUE;
+    }
+
   switch (paint_phase)
     {
     case META_SCREEN_CAST_PAINT_PHASE_PRE_PAINT:
@@ -664,13 +829,11 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
         CoglFramebuffer *view_framebuffer =
           clutter_stage_view_get_framebuffer (view);
 
-        cogl_blit_framebuffer (view_framebuffer,
-                               framebuffer,
-                               0, 0,
-                               x, y,
-                               cogl_framebuffer_get_width (view_framebuffer),
-                               cogl_framebuffer_get_height (view_framebuffer),
-                               &local_error);
+        meta_screen_cast_stream_src_blit_damage (src,
+                                                 view_framebuffer,
+                                                 framebuffer,
+                                                 x, y,
+                                                 &local_error);
       }
       break;
 
@@ -686,9 +849,17 @@ meta_screen_cast_monitor_stream_src_record_to_framebuffer (MetaScreenCastStreamS
 
   do_stage_paint = local_error != NULL;
 
+  if (!do_stage_paint && draw_cursor)
+    draw_cursor_sprite (monitor_src, framebuffer);
+
 stage_paint:
   if (do_stage_paint)
     {
+      /* The cursor is painted along with the stage, but it still has to
+       * be removed from wherever it ends up when the buffer is reused. */
+      if (embeds_cursor && !is_cursor_tracked)
+        track_cursor_damage (monitor_src, view_scale, 0, 0);
+
       ClutterPaintFlag paint_flags = CLUTTER_PAINT_FLAG_CLEAR;
 
       switch (meta_screen_cast_stream_get_cursor_mode (stream))
@@ -720,39 +891,10 @@ meta_screen_cast_monitor_stream_record_follow_up (MetaScreenCastStreamSrc *src)
 {
   MetaScreenCastMonitorStreamSrc *monitor_src =
     META_SCREEN_CAST_MONITOR_STREAM_SRC (src);
-  MetaBackend *backend = get_backend (monitor_src);
-  MetaRenderer *renderer = meta_backend_get_renderer (backend);
-  ClutterStage *stage = get_stage (monitor_src);
-  MetaMonitor *monitor;
-  MetaLogicalMonitor *logical_monitor;
-  MtkRectangle logical_monitor_layout;
-  GList *l;
 
   g_clear_handle_id (&monitor_src->maybe_record_idle_id, g_source_remove);
 
-  monitor = get_monitor (monitor_src);
-  logical_monitor = meta_monitor_get_logical_monitor (monitor);
-  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
-
-  for (l = meta_renderer_get_views (renderer); l; l = l->next)
-    {
-      MetaRendererView *view = l->data;
-      MtkRectangle view_layout;
-      MtkRectangle damage;
-
-      clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
-
-      if (!mtk_rectangle_overlap (&logical_monitor_layout, &view_layout))
-        continue;
-
-      damage = (MtkRectangle) {
-        .x = view_layout.x,
-        .y = view_layout.y,
-        .width = 1,
-        .height = 1,
-      };
-      clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (stage), &damage);
-    }
+  queue_minimal_redraw (monitor_src);
 }
 
 static void
@@ -841,22 +983,6 @@ meta_screen_cast_monitor_stream_src_set_cursor_metadata (MetaScreenCastStreamSrc
     }
 }
 
-static gboolean
-meta_screen_cast_monitor_stream_src_is_cursor_inhibited (MetaHwCursorInhibitor *inhibitor)
-{
-  MetaScreenCastMonitorStreamSrc *monitor_src =
-    META_SCREEN_CAST_MONITOR_STREAM_SRC (inhibitor);
-
-  return is_cursor_in_stream (monitor_src);
-}
-
-static void
-hw_cursor_inhibitor_iface_init (MetaHwCursorInhibitorInterface *iface)
-{
-  iface->is_cursor_inhibited =
-    meta_screen_cast_monitor_stream_src_is_cursor_inhibited;
-}
-
 MetaScreenCastMonitorStreamSrc *
 meta_screen_cast_monitor_stream_src_new (MetaScreenCastMonitorStream  *monitor_stream,
                                          GError                      **error)
@@ -644,6 +644,7 @@ handle_record_area (MetaDBusScreenCastSession *skeleton,
   ClutterStage *stage;
   MetaScreenCastCursorMode cursor_mode;
   gboolean is_recording;
+  double max_scale;
   MetaScreenCastFlag flags;
   g_autoptr (GError) error = NULL;
   MtkRectangle rect;
@@ -677,6 +678,18 @@ handle_record_area (MetaDBusScreenCastSession *skeleton,
   if (!g_variant_lookup (properties_variant, "is-recording", "b", &is_recording))
     is_recording = FALSE;
 
+  if (!g_variant_lookup (properties_variant, "max-scale", "d", &max_scale))
+    {
+      max_scale = 0.0;
+    }
+  else if (max_scale <= 0.0)
+    {
+      g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "Invalid max scale");
+      return TRUE;
+    }
+
   interface_skeleton = G_DBUS_INTERFACE_SKELETON (skeleton);
   connection = g_dbus_interface_skeleton_get_connection (interface_skeleton);
   backend = meta_dbus_session_manager_get_backend (session->session_manager);
@@ -696,6 +709,7 @@ handle_record_area (MetaDBusScreenCastSession *skeleton,
                                                   connection,
                                                   &rect,
                                                   stage,
+                                                  (float) max_scale,
                                                   cursor_mode,
                                                   flags,
                                                   &error);
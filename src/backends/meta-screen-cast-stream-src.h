@@ -143,5 +143,21 @@ void meta_screen_cast_stream_src_set_cursor_sprite_metadata (MetaScreenCastStrea
 
 gboolean meta_screen_cast_stream_src_uses_dma_bufs (MetaScreenCastStreamSrc *src);
 
+void meta_screen_cast_stream_src_add_buffer_damage (MetaScreenCastStreamSrc *src,
+                                                    const MtkRegion         *damage);
+
+void meta_screen_cast_stream_src_add_view_damage (MetaScreenCastStreamSrc *src,
+                                                  ClutterStageView        *view,
+                                                  const MtkRegion         *redraw_clip);
+
+MtkRegion * meta_screen_cast_stream_src_get_buffer_repair_region (MetaScreenCastStreamSrc *src);
+
+gboolean meta_screen_cast_stream_src_blit_damage (MetaScreenCastStreamSrc  *src,
+                                                  CoglFramebuffer          *src_framebuffer,
+                                                  CoglFramebuffer          *framebuffer,
+                                                  int                       x,
+                                                  int                       y,
+                                                  GError                  **error);
+
 CoglPixelFormat
 meta_screen_cast_stream_src_get_preferred_format (MetaScreenCastStreamSrc *src);
@@ -46,6 +46,11 @@ struct _MetaScreenCastVirtualStreamSrc
   gulong prepare_frame_handler_id;
 
   gulong monitors_changed_handler_id;
+
+  /* Frame clock of the virtual monitor view, inhibited while nobody
+   * consumes the stream. */
+  ClutterFrameClock *inhibited_frame_clock;
+  gulong inhibit_monitors_changed_handler_id;
 };
 
 static void
@@ -121,6 +126,47 @@ meta_screen_cast_virtual_stream_src_logical_monitor (MetaScreenCastVirtualStream
   return meta_monitor_get_logical_monitor (monitor);
 }
 
+static void
+sync_frame_clock_inhibition (MetaScreenCastVirtualStreamSrc *virtual_src,
+                             gboolean                        is_enabled)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (virtual_src);
+  ClutterFrameClock *frame_clock = NULL;
+
+  if (virtual_src->virtual_monitor && !is_enabled)
+    {
+      ClutterStageView *view = view_from_src (src);
+
+      if (view)
+        frame_clock = clutter_stage_view_get_frame_clock (view);
+    }
+
+  if (frame_clock == virtual_src->inhibited_frame_clock)
+    return;
+
+  if (virtual_src->inhibited_frame_clock)
+    {
+      clutter_frame_clock_uninhibit (virtual_src->inhibited_frame_clock);
+      g_clear_object (&virtual_src->inhibited_frame_clock);
+    }
+
+  if (frame_clock)
+    {
+      clutter_frame_clock_inhibit (frame_clock);
+      virtual_src->inhibited_frame_clock = g_object_ref (frame_clock);
+    }
+}
+
+static void
+on_monitors_changed_sync_inhibition (MetaMonitorManager             *monitor_manager,
+                                     MetaScreenCastVirtualStreamSrc *virtual_src)
+{
+  MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (virtual_src);
+
+  sync_frame_clock_inhibition (virtual_src,
+                               meta_screen_cast_stream_src_is_enabled (src));
+}
+
 static void
 sync_cursor_state (MetaScreenCastVirtualStreamSrc *virtual_src)
 {
@@ -207,12 +253,19 @@ actors_painted (MetaStage        *stage,
   MetaScreenCastStreamSrc *src = META_SCREEN_CAST_STREAM_SRC (user_data);
   MetaScreenCastPaintPhase paint_phase;
   MetaScreenCastRecordFlag flags;
+  int64_t presentation_time_us;
+
+  meta_screen_cast_stream_src_add_view_damage (src, view, redraw_clip);
+
+  if (!clutter_frame_get_target_presentation_time (frame, &presentation_time_us))
+    presentation_time_us = g_get_monotonic_time ();
 
   flags = META_SCREEN_CAST_RECORD_FLAG_NONE;
   paint_phase = META_SCREEN_CAST_PAINT_PHASE_PRE_SWAP_BUFFER;
-  meta_screen_cast_stream_src_maybe_record_frame (src, flags,
-                                                  paint_phase,
-                                                  redraw_clip);
+  meta_screen_cast_stream_src_maybe_record_frame_with_timestamp (src, flags,
+                                                                 paint_phase,
+                                                                 redraw_clip,
+                                                                 presentation_time_us);
 }
 
 static void
@@ -256,6 +309,8 @@ on_monitors_changed (MetaMonitorManager             *monitor_manager,
   virtual_src->watch = NULL;
   add_watch (virtual_src);
 
+  meta_screen_cast_stream_src_add_buffer_damage (src, NULL);
+
   meta_eis_viewport_notify_changed (META_EIS_VIEWPORT (stream));
 }
 
@@ -324,6 +379,7 @@ meta_screen_cast_virtual_stream_src_enable (MetaScreenCastStreamSrc *src)
       break;
     }
 
+  sync_frame_clock_inhibition (virtual_src, TRUE);
   init_record_callbacks (virtual_src);
   clutter_actor_queue_redraw_with_clip (CLUTTER_ACTOR (stage_from_src (src)),
                                         NULL);
@@ -371,6 +427,43 @@ meta_screen_cast_virtual_stream_src_disable (MetaScreenCastStreamSrc *src)
     case META_SCREEN_CAST_CURSOR_MODE_HIDDEN:
       break;
     }
+
+  /* Without a consumer there is no point in painting the view at all */
+  sync_frame_clock_inhibition (virtual_src, FALSE);
+}
+
+static gboolean
+read_view_into_buffer (MetaScreenCastStreamSrc  *src,
+                       int                       width,
+                       int                       height,
+                       int                       stride,
+                       uint8_t                  *data,
+                       GError                  **error)
+{
+  ClutterStageView *view = view_from_src (src);
+  CoglFramebuffer *view_framebuffer;
+  CoglContext *cogl_context;
+  g_autoptr (CoglBitmap) bitmap = NULL;
+
+  view_framebuffer = clutter_stage_view_get_framebuffer (view);
+  cogl_context = cogl_framebuffer_get_context (view_framebuffer);
+  bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                     width, height,
+                                     COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                     stride,
+                                     data);
+
+  if (!cogl_framebuffer_read_pixels_into_bitmap (view_framebuffer,
+                                                 0, 0,
+                                                 COGL_READ_PIXELS_COLOR_BUFFER,
+                                                 bitmap))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to read back virtual monitor view");
+      return FALSE;
+    }
+
+  return TRUE;
 }
 
 static gboolean
@@ -390,6 +483,19 @@ meta_screen_cast_virtual_stream_src_record_to_buffer (MetaScreenCastStreamSrc
 
   stream = meta_screen_cast_stream_src_get_stream (src);
   view = view_from_src (src);
+
+  /* The view was just painted with what the stream wants, so read it back
+   * instead of painting the stage a second time. */
+  if (paint_phase == META_SCREEN_CAST_PAINT_PHASE_PRE_SWAP_BUFFER)
+    {
+      CoglFramebuffer *view_framebuffer =
+        clutter_stage_view_get_framebuffer (view);
+
+      if (cogl_framebuffer_get_width (view_framebuffer) == width &&
+          cogl_framebuffer_get_height (view_framebuffer) == height)
+        return read_view_into_buffer (src, width, height, stride, data, error);
+    }
+
   scale = clutter_stage_view_get_scale (view);
   clutter_stage_view_get_layout (view, &view_rect);
 
@@ -429,13 +535,11 @@ meta_screen_cast_virtual_stream_src_record_to_framebuffer (MetaScreenCastStreamS
 
   view = view_from_src (src);
   view_framebuffer = clutter_stage_view_get_framebuffer (view);
-  if (!cogl_blit_framebuffer (view_framebuffer,
-                              framebuffer,
-                              0, 0,
-                              0, 0,
-                              cogl_framebuffer_get_width (view_framebuffer),
-                              cogl_framebuffer_get_height (view_framebuffer),
-                              error))
+  if (!meta_screen_cast_stream_src_blit_damage (src,
+                                                view_framebuffer,
+                                                framebuffer,
+                                                0, 0,
+                                                error))
     return FALSE;
 
   cogl_framebuffer_flush (framebuffer);
@@ -645,6 +749,11 @@ ensure_virtual_monitor (MetaScreenCastVirtualStreamSrc *virtual_src,
     }
   virtual_src->virtual_monitor = virtual_monitor;
 
+  virtual_src->inhibit_monitors_changed_handler_id =
+    g_signal_connect (monitor_manager, "monitors-changed-internal",
+                      G_CALLBACK (on_monitors_changed_sync_inhibition),
+                      virtual_src);
+
   meta_monitor_manager_reload (monitor_manager);
 }
 
@@ -693,6 +802,18 @@ meta_screen_cast_virtual_stream_src_dispose (GObject *object)
 
   parent_class->dispose (object);
 
+  if (virtual_src->inhibit_monitors_changed_handler_id)
+    {
+      MetaBackend *backend =
+        backend_from_src (META_SCREEN_CAST_STREAM_SRC (virtual_src));
+      MetaMonitorManager *monitor_manager =
+        meta_backend_get_monitor_manager (backend);
+
+      g_clear_signal_handler (&virtual_src->inhibit_monitors_changed_handler_id,
+                              monitor_manager);
+    }
+
+  sync_frame_clock_inhibition (virtual_src, TRUE);
   g_clear_object (&virtual_src->virtual_monitor);
 }
 
@@ -23,20 +23,43 @@
 #include "backends/meta-screen-cast.h"
 
 #include <pipewire/pipewire.h>
+#include <string.h>
 
 #include "backends/meta-backend-private.h"
 #include "backends/meta-remote-desktop-session.h"
 #include "backends/meta-screen-cast-session.h"
+#include "clutter/clutter-mutter.h"
 
 #define META_SCREEN_CAST_DBUS_SERVICE "org.gnome.Mutter.ScreenCast"
 #define META_SCREEN_CAST_DBUS_PATH "/org/gnome/Mutter/ScreenCast"
-#define META_SCREEN_CAST_API_VERSION 4
+#define META_SCREEN_CAST_API_VERSION 5
+
+/*
+ * The result of the last painting of a part of the stage into system
+ * memory, so that streams recording the same contents within the same
+ * frame can copy it rather than painting and reading it back again.
+ */
+typedef struct _MetaScreenCastCapture
+{
+  int64_t frame_counter;
+  MtkRectangle rect;
+  float scale;
+  ClutterPaintFlag paint_flags;
+
+  int width;
+  int height;
+  int stride;
+  uint8_t *data;
+} MetaScreenCastCapture;
 
 struct _MetaScreenCast
 {
   MetaDbusSessionManager parent;
 
   gboolean disable_dma_bufs;
+
+  MetaScreenCastCapture *capture;
+  guint clear_capture_idle_id;
 };
 
 G_DEFINE_TYPE (MetaScreenCast, meta_screen_cast,
@@ -93,6 +116,137 @@ meta_screen_cast_create_dma_buf_handle (MetaScreenCast  *screen_cast,
   return dmabuf_handle;
 }
 
+static void
+meta_screen_cast_capture_free (MetaScreenCastCapture *capture)
+{
+  g_free (capture->data);
+  g_free (capture);
+}
+
+static gboolean
+clear_capture_idle (gpointer user_data)
+{
+  MetaScreenCast *screen_cast = META_SCREEN_CAST (user_data);
+
+  g_clear_pointer (&screen_cast->capture, meta_screen_cast_capture_free);
+  screen_cast->clear_capture_idle_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+is_capture_reusable (MetaScreenCastCapture *capture,
+                     int64_t                frame_counter,
+                     const MtkRectangle    *rect,
+                     float                  scale,
+                     ClutterPaintFlag       paint_flags)
+{
+  return (capture &&
+          capture->frame_counter == frame_counter &&
+          mtk_rectangle_equal (&capture->rect, rect) &&
+          capture->scale == scale &&
+          capture->paint_flags == paint_flags);
+}
+
+static void
+copy_rows (uint8_t       *dst,
+           int            dst_stride,
+           const uint8_t *src,
+           int            src_stride,
+           int            row_length,
+           int            n_rows)
+{
+  int i;
+
+  if (dst_stride == src_stride)
+    {
+      memcpy (dst, src, (size_t) src_stride * n_rows);
+      return;
+    }
+
+  for (i = 0; i < n_rows; i++)
+    memcpy (dst + i * dst_stride, src + i * src_stride, row_length);
+}
+
+/**
+ * meta_screen_cast_paint_stage_to_buffer:
+ *
+ * Paints @rect of @stage into @data like clutter_stage_paint_to_buffer(),
+ * except that the result is reused when another stream already painted the
+ * same area with the same scale and flags since the stage last presented a
+ * frame. This avoids doing the capture once per stream when multiple
+ * sessions record the same monitor.
+ */
+gboolean
+meta_screen_cast_paint_stage_to_buffer (MetaScreenCast      *screen_cast,
+                                        ClutterStage        *stage,
+                                        const MtkRectangle  *rect,
+                                        float                scale,
+                                        uint8_t             *data,
+                                        int                  stride,
+                                        ClutterPaintFlag     paint_flags,
+                                        GError             **error)
+{
+  MetaScreenCastCapture *capture;
+  int64_t frame_counter;
+  int width, height;
+
+  width = (int) roundf (rect->width * scale);
+  height = (int) roundf (rect->height * scale);
+  frame_counter = clutter_stage_get_frame_counter (stage);
+
+  capture = screen_cast->capture;
+  if (is_capture_reusable (capture, frame_counter, rect, scale, paint_flags))
+    {
+      meta_topic (META_DEBUG_SCREEN_CAST,
+                  "Reusing capture of %dx%d+%d+%d for another stream",
+                  rect->width, rect->height, rect->x, rect->y);
+
+      copy_rows (data, stride,
+                 capture->data, capture->stride,
+                 width * 4, height);
+      return TRUE;
+    }
+
+  if (!clutter_stage_paint_to_buffer (stage, rect, scale,
+                                      data, stride,
+                                      COGL_PIXEL_FORMAT_CAIRO_ARGB32_COMPAT,
+                                      paint_flags,
+                                      error))
+    return FALSE;
+
+  if (!capture ||
+      capture->width != width ||
+      capture->height != height ||
+      capture->stride != stride)
+    {
+      g_clear_pointer (&screen_cast->capture, meta_screen_cast_capture_free);
+
+      capture = g_new0 (MetaScreenCastCapture, 1);
+      capture->width = width;
+      capture->height = height;
+      capture->stride = stride;
+      capture->data = g_malloc ((size_t) stride * height);
+      screen_cast->capture = capture;
+    }
+
+  capture->frame_counter = frame_counter;
+  capture->rect = *rect;
+  capture->scale = scale;
+  capture->paint_flags = paint_flags;
+  memcpy (capture->data, data, (size_t) stride * height);
+
+  /* Only keep the capture around for streams recording in the same main
+   * loop iteration, so that nothing outlives the frame it was taken in. */
+  if (!screen_cast->clear_capture_idle_id)
+    {
+      screen_cast->clear_capture_idle_id =
+        g_idle_add (clear_capture_idle, screen_cast);
+    }
+
+  return TRUE;
+}
+
 static MetaRemoteDesktopSession *
 find_remote_desktop_session (MetaDbusSessionManager  *session_manager,
                              const char              *remote_desktop_session_id,
@@ -228,10 +382,22 @@ meta_screen_cast_init (MetaScreenCast *screen_cast)
     }
 }
 
+static void
+meta_screen_cast_finalize (GObject *object)
+{
+  MetaScreenCast *screen_cast = META_SCREEN_CAST (object);
+
+  g_clear_handle_id (&screen_cast->clear_capture_idle_id, g_source_remove);
+  g_clear_pointer (&screen_cast->capture, meta_screen_cast_capture_free);
+
+  G_OBJECT_CLASS (meta_screen_cast_parent_class)->finalize (object);
+}
+
 static void
 meta_screen_cast_class_init (MetaScreenCastClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->constructed = meta_screen_cast_constructed;
+  object_class->finalize = meta_screen_cast_finalize;
 }
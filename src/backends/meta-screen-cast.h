@@ -56,4 +56,13 @@ CoglDmaBufHandle * meta_screen_cast_create_dma_buf_handle (MetaScreenCast  *scre
                                                            int              width,
                                                            int              height);
 
+gboolean meta_screen_cast_paint_stage_to_buffer (MetaScreenCast      *screen_cast,
+                                                 ClutterStage        *stage,
+                                                 const MtkRectangle  *rect,
+                                                 float                scale,
+                                                 uint8_t             *data,
+                                                 int                  stride,
+                                                 ClutterPaintFlag     paint_flags,
+                                                 GError             **error);
+
 MetaScreenCast * meta_screen_cast_new (MetaBackend *backend);
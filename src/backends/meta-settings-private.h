@@ -31,6 +31,9 @@ typedef enum _MetaExperimentalFeature
   META_EXPERIMENTAL_FEATURE_SCALE_MONITOR_FRAMEBUFFER = (1 << 0),
   META_EXPERIMENTAL_FEATURE_KMS_MODIFIERS  = (1 << 1),
   META_EXPERIMENTAL_FEATURE_AUTOCLOSE_XWAYLAND  = (1 << 2),
+  META_EXPERIMENTAL_FEATURE_VARIABLE_REFRESH_RATE = (1 << 3),
+  META_EXPERIMENTAL_FEATURE_INFER_OPAQUE_REGIONS = (1 << 4),
+  META_EXPERIMENTAL_FEATURE_XWAYLAND_WARM_STANDBY = (1 << 5),
 } MetaExperimentalFeature;
 
 typedef enum _MetaXwaylandExtension
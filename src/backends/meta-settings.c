@@ -294,6 +294,12 @@ experimental_features_handler (GVariant *features_variant,
         feature = META_EXPERIMENTAL_FEATURE_KMS_MODIFIERS;
       else if (g_str_equal (feature_str, "autoclose-xwayland"))
         feature = META_EXPERIMENTAL_FEATURE_AUTOCLOSE_XWAYLAND;
+      else if (g_str_equal (feature_str, "variable-refresh-rate"))
+        feature = META_EXPERIMENTAL_FEATURE_VARIABLE_REFRESH_RATE;
+      else if (g_str_equal (feature_str, "infer-opaque-regions"))
+        feature = META_EXPERIMENTAL_FEATURE_INFER_OPAQUE_REGIONS;
+      else if (g_str_equal (feature_str, "xwayland-warm-standby"))
+        feature = META_EXPERIMENTAL_FEATURE_XWAYLAND_WARM_STANDBY;
 
       if (feature)
         g_message ("Enabling experimental feature '%s'", feature_str);
@@ -458,6 +458,46 @@ transform_swap_region_to_onscreen (ClutterStageView *stage_view,
   return transformed_region;
 }
 
+/*
+ * Blitting many small rectangles from the shadow framebuffer costs more than
+ * blitting their bounding box, once the bounding box doesn't add much that
+ * wasn't damaged anyway.
+ */
+#define MAX_SHADOWFB_DAMAGE_RECTS 16
+
+static void
+maybe_coalesce_shadowfb_damage (MtkRegion **damage_region)
+{
+  MtkRectangle extents;
+  int64_t extents_area;
+  int64_t damage_area = 0;
+  int n_rects;
+  int i;
+
+  n_rects = mtk_region_num_rectangles (*damage_region);
+  if (n_rects <= 1)
+    return;
+
+  extents = mtk_region_get_extents (*damage_region);
+
+  if (n_rects <= MAX_SHADOWFB_DAMAGE_RECTS)
+    {
+      for (i = 0; i < n_rects; i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (*damage_region, i);
+
+          damage_area += (int64_t) rect.width * rect.height;
+        }
+
+      extents_area = (int64_t) extents.width * extents.height;
+      if (extents_area - damage_area > damage_area / 4)
+        return;
+    }
+
+  g_clear_pointer (damage_region, mtk_region_unref);
+  *damage_region = mtk_region_create_rectangle (&extents);
+}
+
 static gboolean
 should_use_clipped_redraw (gboolean              is_full_redraw,
                            gboolean              has_buffer_age,
@@ -509,7 +549,9 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
   CoglFramebuffer *onscreen = clutter_stage_view_get_onscreen (stage_view);
   MtkRectangle view_rect;
   gboolean is_full_redraw;
+  gboolean has_shadowfb;
   gboolean use_clipped_redraw;
+  gboolean use_clipped_swap;
   gboolean buffer_has_valid_damage_history = FALSE;
   gboolean has_buffer_age;
   gboolean swap_with_damage;
@@ -555,7 +597,7 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
 
   meta_get_clutter_debug_flags (NULL, &paint_debug_flags, NULL);
 
-  use_clipped_redraw =
+  use_clipped_swap =
     should_use_clipped_redraw (is_full_redraw,
                                has_buffer_age,
                                buffer_has_valid_damage_history,
@@ -563,6 +605,26 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
                                onscreen,
                                stage_window);
 
+  /* The shadow framebuffer keeps its contents between frames, so only the
+   * new damage has to be painted into it, even when the back buffer it is
+   * copied to is too old to be repaired and gets a full copy.
+   */
+  has_shadowfb = clutter_stage_view_has_shadowfb (stage_view);
+  if (has_shadowfb)
+    {
+      use_clipped_redraw =
+        should_use_clipped_redraw (is_full_redraw,
+                                   has_buffer_age,
+                                   buffer_has_valid_damage_history,
+                                   paint_debug_flags,
+                                   fb,
+                                   stage_window);
+    }
+  else
+    {
+      use_clipped_redraw = use_clipped_swap;
+    }
+
   if (use_clipped_redraw)
     {
       fb_clip_region = offset_scale_and_clamp_region (redraw_clip,
@@ -607,10 +669,8 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
    * artefacts.
    */
   /* swap_region does not need damage history, set it up before that */
-  if (!use_clipped_redraw)
+  if (!use_clipped_swap)
     swap_region = mtk_region_create ();
-  else if (clutter_stage_view_has_shadowfb (stage_view))
-    swap_region = mtk_region_ref (fb_clip_region);
   else
     swap_region = mtk_region_copy (fb_clip_region);
 
@@ -619,23 +679,29 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
     {
       clutter_damage_history_record (damage_history, fb_clip_region);
 
-      if (use_clipped_redraw)
+      if (use_clipped_swap)
         {
+          MtkRegion *repair_region;
           int age;
 
+          /* With a shadow framebuffer the missed damage only needs to be
+           * copied to the back buffer, not painted again.
+           */
+          repair_region = has_shadowfb ? swap_region : fb_clip_region;
+
           for (age = 1; age <= buffer_age; age++)
             {
               const MtkRegion *old_damage;
 
               old_damage =
                 clutter_damage_history_lookup (damage_history, age);
-              mtk_region_union (fb_clip_region, old_damage);
+              mtk_region_union (repair_region, old_damage);
             }
 
           meta_topic (META_DEBUG_BACKEND,
                       "Reusing back buffer(age=%d) - repairing region: num rects: %d",
                       buffer_age,
-                      mtk_region_num_rectangles (fb_clip_region));
+                      mtk_region_num_rectangles (repair_region));
 
           swap_with_damage = TRUE;
         }
@@ -643,6 +709,9 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
       clutter_damage_history_step (damage_history);
     }
 
+  if (has_shadowfb && use_clipped_swap)
+    maybe_coalesce_shadowfb_damage (&swap_region);
+
   if (use_clipped_redraw)
     {
       /* Regenerate redraw_clip because:
@@ -669,7 +738,10 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
     }
   else if (use_clipped_redraw)
     {
-      queue_damage_region (stage_window, stage_view, fb_clip_region);
+      if (!has_shadowfb)
+        queue_damage_region (stage_window, stage_view, fb_clip_region);
+      else if (use_clipped_swap)
+        queue_damage_region (stage_window, stage_view, swap_region);
 
       cogl_framebuffer_push_region_clip (fb, fb_clip_region);
 
@@ -41,6 +41,14 @@
 struct _MetaBarrierManagerNative
 {
   GHashTable *barriers;
+
+  /* Barriers are either horizontal or vertical, and are kept sorted by
+   * their y respectively x coordinate, so that a motion only needs to be
+   * tested against the barriers it can possibly cross.
+   */
+  GPtrArray *horizontal_barriers;
+  GPtrArray *vertical_barriers;
+
   GMutex mutex;
   MetaBarrierImplNative *pointer_trap;
 };
@@ -292,6 +300,92 @@ update_closest_barrier (gpointer key,
     }
 }
 
+static float
+get_barrier_position (MetaBarrierImplNative *barrier_impl)
+{
+  MetaBarrier *barrier = barrier_impl->barrier;
+  MetaBorder *border = meta_barrier_get_border (barrier);
+
+  if (is_barrier_horizontal (barrier))
+    return border->line.a.y;
+  else
+    return border->line.a.x;
+}
+
+static GPtrArray *
+get_barrier_index (MetaBarrierManagerNative *manager,
+                   MetaBarrierImplNative    *barrier_impl)
+{
+  if (is_barrier_horizontal (barrier_impl->barrier))
+    return manager->horizontal_barriers;
+  else
+    return manager->vertical_barriers;
+}
+
+/* Returns the index of the first barrier at or after position. */
+static unsigned int
+find_barrier_index_lower_bound (GPtrArray *barrier_index,
+                                float      position)
+{
+  unsigned int low = 0;
+  unsigned int high = barrier_index->len;
+
+  while (low < high)
+    {
+      unsigned int mid = low + (high - low) / 2;
+
+      if (get_barrier_position (g_ptr_array_index (barrier_index, mid)) <
+          position)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
+static void
+add_barrier_to_index (MetaBarrierManagerNative *manager,
+                      MetaBarrierImplNative    *barrier_impl)
+{
+  GPtrArray *barrier_index = get_barrier_index (manager, barrier_impl);
+  unsigned int i;
+
+  i = find_barrier_index_lower_bound (barrier_index,
+                                      get_barrier_position (barrier_impl));
+  g_ptr_array_insert (barrier_index, i, barrier_impl);
+}
+
+static void
+remove_barrier_from_index (MetaBarrierManagerNative *manager,
+                           MetaBarrierImplNative    *barrier_impl)
+{
+  g_ptr_array_remove (get_barrier_index (manager, barrier_impl),
+                      barrier_impl);
+}
+
+static void
+update_closest_barrier_in_range (GPtrArray              *barrier_index,
+                                 float                   start,
+                                 float                   end,
+                                 MetaClosestBarrierData *data)
+{
+  unsigned int i;
+
+  for (i = find_barrier_index_lower_bound (barrier_index, MIN (start, end));
+       i < barrier_index->len;
+       i++)
+    {
+      MetaBarrierImplNative *barrier_impl =
+        g_ptr_array_index (barrier_index, i);
+
+      if (get_barrier_position (barrier_impl) > MAX (start, end))
+        break;
+
+      update_closest_barrier (barrier_impl, NULL, data);
+    }
+}
+
 static gboolean
 get_closest_barrier (MetaBarrierManagerNative *manager,
                      float                     prev_x,
@@ -319,9 +413,14 @@ get_closest_barrier (MetaBarrierManagerNative *manager,
     },
   };
 
-  g_hash_table_foreach (manager->barriers,
-                        update_closest_barrier,
-                        &closest_barrier_data);
+  /* A horizontal barrier can only be crossed by a motion spanning its y
+   * coordinate, and a vertical barrier by one spanning its x coordinate. */
+  update_closest_barrier_in_range (manager->horizontal_barriers,
+                                   prev_y, y,
+                                   &closest_barrier_data);
+  update_closest_barrier_in_range (manager->vertical_barriers,
+                                   prev_x, x,
+                                   &closest_barrier_data);
 
   if (closest_barrier_data.out.barrier_impl != NULL)
     {
@@ -654,6 +753,7 @@ meta_barrier_impl_native_destroy (MetaBarrierImpl *impl)
   if (self->manager->pointer_trap == self)
     self->manager->pointer_trap = NULL;
   g_hash_table_remove (self->manager->barriers, self);
+  remove_barrier_from_index (self->manager, self);
   g_mutex_unlock (&self->manager->mutex);
   g_main_context_unref (self->main_context);
   self->is_active = FALSE;
@@ -677,6 +777,7 @@ meta_barrier_impl_native_new (MetaBarrier *barrier)
   self->manager = manager;
   g_mutex_lock (&manager->mutex);
   g_hash_table_add (manager->barriers, self);
+  add_barrier_to_index (manager, self);
   g_mutex_unlock (&manager->mutex);
 
   return META_BARRIER_IMPL (self);
@@ -705,6 +806,8 @@ meta_barrier_manager_native_new (void)
   manager = g_new0 (MetaBarrierManagerNative, 1);
 
   manager->barriers = g_hash_table_new (NULL, NULL);
+  manager->horizontal_barriers = g_ptr_array_new ();
+  manager->vertical_barriers = g_ptr_array_new ();
   g_mutex_init (&manager->mutex);
 
   return manager;
@@ -53,6 +53,7 @@ struct _MetaCrtcKms
 
   MetaKmsPlane *assigned_primary_plane;
   MetaKmsPlane *assigned_cursor_plane;
+  MetaKmsPlane *assigned_overlay_plane;
 };
 
 static GQuark kms_crtc_crtc_kms_quark;
@@ -210,6 +211,7 @@ typedef struct _CrtcKmsAssignment
 {
   MetaKmsPlane *primary_plane;
   MetaKmsPlane *cursor_plane;
+  MetaKmsPlane *overlay_plane;
 } CrtcKmsAssignment;
 
 static gboolean
@@ -240,7 +242,9 @@ is_plane_assigned (MetaKmsPlane     *plane,
             return TRUE;
           break;
         case META_KMS_PLANE_TYPE_OVERLAY:
-          g_assert_not_reached ();
+          if (kms_assignment->overlay_plane == plane)
+            return TRUE;
+          break;
         }
     }
 
@@ -285,6 +289,7 @@ meta_crtc_kms_assign_extra (MetaCrtc            *crtc,
   MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
   MetaKmsPlane *primary_plane;
   MetaKmsPlane *cursor_plane;
+  MetaKmsPlane *overlay_plane;
   CrtcKmsAssignment *kms_assignment;
 
   primary_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_PRIMARY,
@@ -303,10 +308,13 @@ meta_crtc_kms_assign_extra (MetaCrtc            *crtc,
 
   cursor_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_CURSOR,
                                         crtc_assignments);
+  overlay_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_OVERLAY,
+                                         crtc_assignments);
 
   kms_assignment = g_new0 (CrtcKmsAssignment, 1);
   kms_assignment->primary_plane = primary_plane;
   kms_assignment->cursor_plane = cursor_plane;
+  kms_assignment->overlay_plane = overlay_plane;
 
   crtc_assignment->backend_private = kms_assignment;
   crtc_assignment->backend_private_destroy = g_free;
@@ -324,6 +332,7 @@ meta_crtc_kms_set_config (MetaCrtc             *crtc,
 
   crtc_kms->assigned_primary_plane = kms_assignment->primary_plane;
   crtc_kms->assigned_cursor_plane = kms_assignment->cursor_plane;
+  crtc_kms->assigned_overlay_plane = kms_assignment->overlay_plane;
 }
 
 static gboolean
@@ -360,6 +369,12 @@ meta_crtc_kms_get_assigned_primary_plane (MetaCrtcKms *crtc_kms)
   return crtc_kms->assigned_primary_plane;
 }
 
+MetaKmsPlane *
+meta_crtc_kms_get_assigned_overlay_plane (MetaCrtcKms *crtc_kms)
+{
+  return crtc_kms->assigned_overlay_plane;
+}
+
 static GList *
 generate_crtc_connector_list (MetaGpu  *gpu,
                               MetaCrtc *crtc)
@@ -416,6 +431,18 @@ meta_crtc_kms_set_mode (MetaCrtcKms   *crtc_kms,
                   meta_crtc_get_id (crtc));
     }
 
+  if (meta_kms_crtc_adopt_state (crtc_kms->kms_crtc, kms_mode, connectors))
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "Adopting current mode of CRTC (%" G_GUINT64_FORMAT ")",
+                  meta_crtc_get_id (crtc));
+
+      /* Connector properties set along with the mode may still need it */
+      meta_kms_update_set_needs_modeset (kms_update);
+      g_list_free (connectors);
+      return;
+    }
+
   meta_kms_update_mode_set (kms_update,
                             meta_crtc_kms_get_kms_crtc (crtc_kms),
                             g_steal_pointer (&connectors),
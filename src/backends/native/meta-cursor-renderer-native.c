@@ -60,6 +60,9 @@
 #include "wayland/meta-wayland-buffer.h"
 #endif
 
+/* Enough for the frames of an animated cursor at a couple of scales */
+#define MAX_CACHED_CURSOR_BUFFERS 64
+
 static GQuark quark_cursor_sprite = 0;
 
 typedef struct _CursorStageView
@@ -91,12 +94,26 @@ struct _MetaCursorRendererNativePrivate
 };
 typedef struct _MetaCursorRendererNativePrivate MetaCursorRendererNativePrivate;
 
+typedef struct _CursorBufferKey
+{
+  GBytes *pixels;
+  int width;
+  int height;
+  uint32_t gbm_format;
+  float scale;
+  MetaMonitorTransform transform;
+} CursorBufferKey;
+
 typedef struct _MetaCursorRendererNativeGpuData
 {
   gboolean hw_cursor_broken;
 
   uint64_t cursor_width;
   uint64_t cursor_height;
+
+  /* Ready to scan out cursor buffers, most recently used first */
+  GHashTable *cursor_buffers;
+  GQueue cursor_buffer_keys;
 } MetaCursorRendererNativeGpuData;
 
 typedef struct _MetaCursorNativePrivate
@@ -157,16 +174,64 @@ meta_cursor_renderer_native_gpu_data_from_gpu (MetaGpuKms *gpu_kms)
                              quark_cursor_renderer_native_gpu_data);
 }
 
+static void
+cursor_buffer_key_free (CursorBufferKey *key)
+{
+  g_bytes_unref (key->pixels);
+  g_free (key);
+}
+
+static guint
+cursor_buffer_key_hash (gconstpointer data)
+{
+  const CursorBufferKey *key = data;
+
+  return (g_bytes_hash (key->pixels) ^
+          (key->width << 16) ^
+          key->height ^
+          (key->transform << 24));
+}
+
+static gboolean
+cursor_buffer_key_equal (gconstpointer a,
+                         gconstpointer b)
+{
+  const CursorBufferKey *key_a = a;
+  const CursorBufferKey *key_b = b;
+
+  return (key_a->width == key_b->width &&
+          key_a->height == key_b->height &&
+          key_a->gbm_format == key_b->gbm_format &&
+          key_a->scale == key_b->scale &&
+          key_a->transform == key_b->transform &&
+          g_bytes_equal (key_a->pixels, key_b->pixels));
+}
+
+static void
+meta_cursor_renderer_native_gpu_data_free (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data)
+{
+  g_queue_clear (&cursor_renderer_gpu_data->cursor_buffer_keys);
+  g_clear_pointer (&cursor_renderer_gpu_data->cursor_buffers,
+                   g_hash_table_unref);
+  g_free (cursor_renderer_gpu_data);
+}
+
 static MetaCursorRendererNativeGpuData *
 meta_create_cursor_renderer_native_gpu_data (MetaGpuKms *gpu_kms)
 {
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
 
   cursor_renderer_gpu_data = g_new0 (MetaCursorRendererNativeGpuData, 1);
+  cursor_renderer_gpu_data->cursor_buffers =
+    g_hash_table_new_full (cursor_buffer_key_hash,
+                           cursor_buffer_key_equal,
+                           (GDestroyNotify) cursor_buffer_key_free,
+                           g_object_unref);
+  g_queue_init (&cursor_renderer_gpu_data->cursor_buffer_keys);
   g_object_set_qdata_full (G_OBJECT (gpu_kms),
                            quark_cursor_renderer_native_gpu_data,
                            cursor_renderer_gpu_data,
-                           g_free);
+                           (GDestroyNotify) meta_cursor_renderer_native_gpu_data_free);
 
   return cursor_renderer_gpu_data;
 }
@@ -583,39 +648,30 @@ calculate_crtc_cursor_hotspot (MetaCursorSprite     *cursor_sprite,
   *hotspot = GRAPHENE_POINT_INIT (hot_x * scale, hot_y * scale);
 }
 
-static gboolean
-load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
-                                        MetaCrtcKms              *crtc_kms,
-                                        MetaCursorSprite         *cursor_sprite,
-                                        uint8_t                  *pixels,
-                                        uint                      width,
-                                        uint                      height,
-                                        int                       rowstride,
-                                        float                     scale,
-                                        MetaMonitorTransform      transform,
-                                        uint32_t                  gbm_format)
+static MetaDrmBuffer *
+create_cursor_buffer_for_gpu (MetaCursorRendererNative *native,
+                              MetaGpuKms               *gpu_kms,
+                              uint8_t                  *pixels,
+                              uint                      width,
+                              uint                      height,
+                              int                       rowstride,
+                              uint32_t                  gbm_format)
 {
   MetaCursorRendererNativePrivate *priv =
     meta_cursor_renderer_native_get_instance_private (native);
   MetaBackendNative *backend_native = META_BACKEND_NATIVE (priv->backend);
-  MetaKms *kms = meta_backend_native_get_kms (backend_native);
-  MetaKmsCursorManager *kms_cursor_manager = meta_kms_get_cursor_manager (kms);
   MetaDevicePool *device_pool =
     meta_backend_native_get_device_pool (backend_native);
-  MetaGpu *gpu = meta_crtc_get_gpu (META_CRTC (crtc_kms));
-  MetaGpuKms *gpu_kms = META_GPU_KMS (gpu);
-  MetaKmsCrtc *kms_crtc;
   uint64_t cursor_width, cursor_height;
-  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  MetaDrmBuffer *buffer;
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
   g_autoptr (MetaDeviceFile) device_file = NULL;
   g_autoptr (GError) error = NULL;
-  graphene_point_t hotspot;
 
   cursor_renderer_gpu_data =
     meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
   if (!cursor_renderer_gpu_data)
-    return FALSE;
+    return NULL;
 
   cursor_width = (uint64_t) cursor_renderer_gpu_data->cursor_width;
   cursor_height = (uint64_t) cursor_renderer_gpu_data->cursor_height;
@@ -624,7 +680,7 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
     {
       meta_warning ("Invalid theme cursor size (must be at most %ux%u)",
                     (unsigned int)cursor_width, (unsigned int)cursor_height);
-      return FALSE;
+      return NULL;
     }
 
   device_file = meta_device_pool_open (device_pool,
@@ -637,7 +693,7 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
                  meta_gpu_kms_get_file_path (gpu_kms),
                  error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return FALSE;
+      return NULL;
     }
 
   buffer = create_cursor_drm_buffer (gpu_kms, device_file,
@@ -651,9 +707,28 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
     {
       g_warning ("Realizing HW cursor failed: %s", error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return FALSE;
+      return NULL;
     }
 
+  return buffer;
+}
+
+static void
+update_crtc_cursor_buffer (MetaCursorRendererNative *native,
+                           MetaCrtcKms              *crtc_kms,
+                           MetaCursorSprite         *cursor_sprite,
+                           MetaDrmBuffer            *buffer,
+                           float                     scale,
+                           MetaMonitorTransform      transform)
+{
+  MetaCursorRendererNativePrivate *priv =
+    meta_cursor_renderer_native_get_instance_private (native);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (priv->backend);
+  MetaKms *kms = meta_backend_native_get_kms (backend_native);
+  MetaKmsCursorManager *kms_cursor_manager = meta_kms_get_cursor_manager (kms);
+  MetaKmsCrtc *kms_crtc;
+  graphene_point_t hotspot;
+
   calculate_crtc_cursor_hotspot (cursor_sprite, scale, transform, &hotspot);
 
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
@@ -662,7 +737,6 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
                                          buffer,
                                          transform,
                                          &hotspot);
-  return TRUE;
 }
 
 static cairo_surface_t *
@@ -753,19 +827,46 @@ gbm_format_to_cairo_format (uint32_t gbm_format)
     }
 }
 
-static gboolean
-load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
-                                           MetaCrtcKms              *crtc_kms,
-                                           MetaCursorSprite         *cursor_sprite,
-                                           float                     relative_scale,
-                                           MetaMonitorTransform      relative_transform,
-                                           uint8_t                  *data,
-                                           int                       width,
-                                           int                       height,
-                                           int                       rowstride,
-                                           uint32_t                  gbm_format)
+static CursorBufferKey *
+cursor_buffer_key_new (uint8_t              *data,
+                       int                   width,
+                       int                   height,
+                       int                   rowstride,
+                       uint32_t              gbm_format,
+                       float                 scale,
+                       MetaMonitorTransform  transform)
+{
+  CursorBufferKey *key;
+  uint8_t *pixels;
+  int i;
+
+  pixels = g_malloc (width * height * 4);
+  for (i = 0; i < height; i++)
+    memcpy (pixels + i * width * 4, data + i * rowstride, width * 4);
+
+  key = g_new0 (CursorBufferKey, 1);
+  key->pixels = g_bytes_new_take (pixels, width * height * 4);
+  key->width = width;
+  key->height = height;
+  key->gbm_format = gbm_format;
+  key->scale = scale;
+  key->transform = transform;
+
+  return key;
+}
+
+static MetaDrmBuffer *
+create_scaled_and_transformed_cursor_buffer (MetaCursorRendererNative *native,
+                                             MetaGpuKms               *gpu_kms,
+                                             float                     relative_scale,
+                                             MetaMonitorTransform      relative_transform,
+                                             uint8_t                  *data,
+                                             int                       width,
+                                             int                       height,
+                                             int                       rowstride,
+                                             uint32_t                  gbm_format)
 {
-  gboolean retval = FALSE;
+  MetaDrmBuffer *buffer;
 
   if (!G_APPROX_VALUE (relative_scale, 1.f, FLT_EPSILON) ||
       relative_transform != META_MONITOR_TRANSFORM_NORMAL ||
@@ -783,35 +884,143 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                                                        relative_scale,
                                                        relative_transform);
 
-      retval =
-        load_cursor_sprite_gbm_buffer_for_crtc (native,
-                                                crtc_kms,
-                                                cursor_sprite,
-                                                cairo_image_surface_get_data (surface),
-                                                cairo_image_surface_get_width (surface),
-                                                cairo_image_surface_get_width (surface),
-                                                cairo_image_surface_get_stride (surface),
-                                                relative_scale,
-                                                relative_transform,
-                                                GBM_FORMAT_ARGB8888);
+      buffer =
+        create_cursor_buffer_for_gpu (native,
+                                      gpu_kms,
+                                      cairo_image_surface_get_data (surface),
+                                      cairo_image_surface_get_width (surface),
+                                      cairo_image_surface_get_height (surface),
+                                      cairo_image_surface_get_stride (surface),
+                                      GBM_FORMAT_ARGB8888);
 
       cairo_surface_destroy (surface);
     }
   else
     {
-      retval = load_cursor_sprite_gbm_buffer_for_crtc (native,
-                                                       crtc_kms,
-                                                       cursor_sprite,
-                                                       data,
-                                                       width,
-                                                       height,
-                                                       rowstride,
-                                                       relative_scale,
-                                                       relative_transform,
-                                                       gbm_format);
+      buffer = create_cursor_buffer_for_gpu (native,
+                                             gpu_kms,
+                                             data,
+                                             width,
+                                             height,
+                                             rowstride,
+                                             gbm_format);
     }
 
-  return retval;
+  return buffer;
+}
+
+static MetaDrmBuffer *
+ensure_cursor_buffer (MetaCursorRendererNative *native,
+                      MetaGpuKms               *gpu_kms,
+                      float                     relative_scale,
+                      MetaMonitorTransform      relative_transform,
+                      uint8_t                  *data,
+                      int                       width,
+                      int                       height,
+                      int                       rowstride,
+                      uint32_t                  gbm_format,
+                      gboolean                 *out_created)
+{
+  MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
+  CursorBufferKey *key;
+  CursorBufferKey *cached_key;
+  MetaDrmBuffer *buffer;
+
+  cursor_renderer_gpu_data =
+    meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
+  if (!cursor_renderer_gpu_data)
+    return NULL;
+
+  key = cursor_buffer_key_new (data, width, height, rowstride, gbm_format,
+                               relative_scale, relative_transform);
+
+  if (g_hash_table_lookup_extended (cursor_renderer_gpu_data->cursor_buffers,
+                                    key,
+                                    (gpointer *) &cached_key,
+                                    (gpointer *) &buffer))
+    {
+      cursor_buffer_key_free (key);
+
+      g_queue_remove (&cursor_renderer_gpu_data->cursor_buffer_keys,
+                      cached_key);
+      g_queue_push_head (&cursor_renderer_gpu_data->cursor_buffer_keys,
+                         cached_key);
+
+      if (out_created)
+        *out_created = FALSE;
+      return buffer;
+    }
+
+  buffer = create_scaled_and_transformed_cursor_buffer (native,
+                                                        gpu_kms,
+                                                        relative_scale,
+                                                        relative_transform,
+                                                        data,
+                                                        width,
+                                                        height,
+                                                        rowstride,
+                                                        gbm_format);
+  if (!buffer)
+    {
+      cursor_buffer_key_free (key);
+      return NULL;
+    }
+
+  if (g_queue_get_length (&cursor_renderer_gpu_data->cursor_buffer_keys) >=
+      MAX_CACHED_CURSOR_BUFFERS)
+    {
+      CursorBufferKey *oldest_key;
+
+      oldest_key =
+        g_queue_pop_tail (&cursor_renderer_gpu_data->cursor_buffer_keys);
+      g_hash_table_remove (cursor_renderer_gpu_data->cursor_buffers,
+                           oldest_key);
+    }
+
+  g_hash_table_insert (cursor_renderer_gpu_data->cursor_buffers, key, buffer);
+  g_queue_push_head (&cursor_renderer_gpu_data->cursor_buffer_keys, key);
+
+  if (out_created)
+    *out_created = TRUE;
+  return buffer;
+}
+
+static gboolean
+load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
+                                           MetaCrtcKms              *crtc_kms,
+                                           MetaCursorSprite         *cursor_sprite,
+                                           float                     relative_scale,
+                                           MetaMonitorTransform      relative_transform,
+                                           uint8_t                  *data,
+                                           int                       width,
+                                           int                       height,
+                                           int                       rowstride,
+                                           uint32_t                  gbm_format)
+{
+  MetaGpu *gpu = meta_crtc_get_gpu (META_CRTC (crtc_kms));
+  MetaDrmBuffer *buffer;
+
+  buffer = ensure_cursor_buffer (native,
+                                 META_GPU_KMS (gpu),
+                                 relative_scale,
+                                 relative_transform,
+                                 data,
+                                 width,
+                                 height,
+                                 rowstride,
+                                 gbm_format,
+                                 NULL);
+  if (!buffer)
+    return FALSE;
+
+  update_crtc_cursor_buffer (native,
+                             crtc_kms,
+                             cursor_sprite,
+                             buffer,
+                             relative_scale,
+                             relative_transform);
+
+  return TRUE;
 }
 
 #ifdef HAVE_WAYLAND
@@ -1004,12 +1213,15 @@ realize_cursor_sprite_from_xcursor_for_crtc (MetaCursorRenderer      *renderer,
     meta_cursor_renderer_native_get_instance_private (native);
   MetaCursorSprite *cursor_sprite = META_CURSOR_SPRITE (sprite_xcursor);
   MetaCrtc *crtc = META_CRTC (crtc_kms);
+  MetaGpuKms *gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
   MetaLogicalMonitor *logical_monitor;
   MetaMonitor *monitor;
   MetaMonitorTransform logical_transform;
   XcursorImage *xc_image;
   float relative_scale;
   MetaMonitorTransform relative_transform;
+  MetaDrmBuffer *buffer;
+  gboolean created;
 
   monitor = meta_output_get_monitor (meta_crtc_get_outputs (crtc)->data);
   logical_monitor = meta_monitor_get_logical_monitor (monitor);
@@ -1026,16 +1238,57 @@ realize_cursor_sprite_from_xcursor_for_crtc (MetaCursorRenderer      *renderer,
 
   xc_image = meta_cursor_sprite_xcursor_get_current_image (sprite_xcursor);
 
-  return load_scaled_and_transformed_cursor_sprite (native,
-                                                    crtc_kms,
-                                                    cursor_sprite,
-                                                    relative_scale,
-                                                    relative_transform,
-                                                    (uint8_t *) xc_image->pixels,
-                                                    xc_image->width,
-                                                    xc_image->height,
-                                                    xc_image->width * 4,
-                                                    GBM_FORMAT_ARGB8888);
+  buffer = ensure_cursor_buffer (native,
+                                 gpu_kms,
+                                 relative_scale,
+                                 relative_transform,
+                                 (uint8_t *) xc_image->pixels,
+                                 xc_image->width,
+                                 xc_image->height,
+                                 xc_image->width * 4,
+                                 GBM_FORMAT_ARGB8888,
+                                 &created);
+  if (!buffer)
+    return FALSE;
+
+  /* Having to create a frame of an animated cursor means a new cursor, scale
+   * or transform; realize the remaining frames right away so that animating
+   * only flips between prepared buffers. */
+  if (created && meta_cursor_sprite_is_animated (cursor_sprite))
+    {
+      XcursorImages *xc_images;
+      int i;
+
+      xc_images = meta_cursor_sprite_xcursor_get_images (sprite_xcursor);
+      for (i = 0; i < xc_images->nimage; i++)
+        {
+          XcursorImage *frame_image = xc_images->images[i];
+
+          if (frame_image == xc_image)
+            continue;
+
+          if (!ensure_cursor_buffer (native,
+                                     gpu_kms,
+                                     relative_scale,
+                                     relative_transform,
+                                     (uint8_t *) frame_image->pixels,
+                                     frame_image->width,
+                                     frame_image->height,
+                                     frame_image->width * 4,
+                                     GBM_FORMAT_ARGB8888,
+                                     NULL))
+            break;
+        }
+    }
+
+  update_crtc_cursor_buffer (native,
+                             crtc_kms,
+                             cursor_sprite,
+                             buffer,
+                             relative_scale,
+                             relative_transform);
+
+  return TRUE;
 }
 
 static gboolean
@@ -111,40 +111,89 @@ meta_drm_buffer_import_get_modifier (MetaDrmBuffer *buffer)
   return meta_drm_buffer_get_modifier (importee);
 }
 
+static gboolean
+should_import_with_modifier (MetaDrmBufferGbm *buffer_gbm)
+{
+  MetaDrmBuffer *buffer = META_DRM_BUFFER (buffer_gbm);
+
+  if (meta_drm_buffer_get_flags (buffer) & META_DRM_BUFFER_FLAG_DISABLE_MODIFIERS)
+    return FALSE;
+
+  return meta_drm_buffer_get_modifier (buffer) != DRM_FORMAT_MOD_INVALID;
+}
+
 static struct gbm_bo *
-dmabuf_to_gbm_bo (struct gbm_device *importer,
-                  int                dmabuf_fd,
-                  uint32_t           width,
-                  uint32_t           height,
-                  uint32_t           stride,
-                  uint32_t           format)
-{
-  struct gbm_import_fd_data data = {
-    .fd = dmabuf_fd,
-    .width = width,
-    .height = height,
-    .stride = stride,
-    .format = format
+import_bo_with_modifier (struct gbm_device *importer,
+                         struct gbm_bo     *primary_bo,
+                         GError           **error)
+{
+  struct gbm_import_fd_modifier_data data;
+  struct gbm_bo *imported_bo;
+  int n_planes;
+  int i;
+
+  n_planes = gbm_bo_get_plane_count (primary_bo);
+  if (n_planes > 4)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Too many planes (%d) to import", n_planes);
+      return NULL;
+    }
+
+  data = (struct gbm_import_fd_modifier_data) {
+    .width = gbm_bo_get_width (primary_bo),
+    .height = gbm_bo_get_height (primary_bo),
+    .format = gbm_bo_get_format (primary_bo),
+    .num_fds = n_planes,
+    .fds = { -1, -1, -1, -1 },
+    .modifier = gbm_bo_get_modifier (primary_bo),
   };
 
-  return gbm_bo_import (importer,
-                        GBM_BO_IMPORT_FD,
-                        &data,
-                        GBM_BO_USE_SCANOUT);
+  for (i = 0; i < n_planes; i++)
+    {
+      data.fds[i] = gbm_bo_get_fd_for_plane (primary_bo, i);
+      if (data.fds[i] == -1)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "getting dmabuf fd for plane %d failed", i);
+          imported_bo = NULL;
+          goto out_close;
+        }
+
+      data.strides[i] = gbm_bo_get_stride_for_plane (primary_bo, i);
+      data.offsets[i] = gbm_bo_get_offset (primary_bo, i);
+    }
+
+  imported_bo = gbm_bo_import (importer,
+                               GBM_BO_IMPORT_FD_MODIFIER,
+                               &data,
+                               GBM_BO_USE_SCANOUT);
+  if (!imported_bo)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                   "importing dmabuf with modifier 0x%" G_GINT64_MODIFIER "x "
+                   "failed: %s",
+                   (uint64_t) data.modifier, g_strerror (errno));
+    }
+
+out_close:
+  for (i = 0; i < n_planes; i++)
+    {
+      if (data.fds[i] >= 0)
+        close (data.fds[i]);
+    }
+
+  return imported_bo;
 }
 
-static gboolean
-import_gbm_buffer (MetaDrmBufferImport  *buffer_import,
-                   struct gbm_device    *importer,
-                   GError              **error)
+static struct gbm_bo *
+import_bo_implicit (struct gbm_device *importer,
+                    struct gbm_bo     *primary_bo,
+                    GError           **error)
 {
-  MetaDrmFbArgs fb_args = { 0, };
-  struct gbm_bo *primary_bo;
+  struct gbm_import_fd_data data;
   struct gbm_bo *imported_bo;
   int dmabuf_fd;
-  gboolean ret;
-
-  primary_bo = meta_drm_buffer_gbm_get_bo (buffer_import->importee);
 
   dmabuf_fd = gbm_bo_get_fd (primary_bo);
   if (dmabuf_fd == -1)
@@ -153,32 +202,81 @@ import_gbm_buffer (MetaDrmBufferImport  *buffer_import,
                    G_IO_ERROR,
                    G_IO_ERROR_FAILED,
                    "getting dmabuf fd failed");
-      return FALSE;
+      return NULL;
     }
 
-  fb_args.strides[0] = gbm_bo_get_stride (primary_bo);
-  fb_args.width = gbm_bo_get_width (primary_bo);
-  fb_args.height = gbm_bo_get_height (primary_bo);
-  fb_args.format = gbm_bo_get_format (primary_bo);
-  fb_args.handle = gbm_bo_get_handle (primary_bo).u32;
+  data = (struct gbm_import_fd_data) {
+    .fd = dmabuf_fd,
+    .width = gbm_bo_get_width (primary_bo),
+    .height = gbm_bo_get_height (primary_bo),
+    .stride = gbm_bo_get_stride (primary_bo),
+    .format = gbm_bo_get_format (primary_bo),
+  };
 
-  imported_bo = dmabuf_to_gbm_bo (importer,
-                                  dmabuf_fd,
-                                  fb_args.width,
-                                  fb_args.height,
-                                  fb_args.strides[0],
-                                  fb_args.format);
+  imported_bo = gbm_bo_import (importer,
+                               GBM_BO_IMPORT_FD,
+                               &data,
+                               GBM_BO_USE_SCANOUT);
   if (!imported_bo)
     {
       g_set_error (error,
                    G_IO_ERROR,
                    G_IO_ERROR_FAILED,
                    "importing dmabuf fd failed");
-      ret = FALSE;
-      goto out_close;
     }
 
-  fb_args.handles[0] = gbm_bo_get_handle (imported_bo).u32;
+  close (dmabuf_fd);
+
+  return imported_bo;
+}
+
+static gboolean
+import_gbm_buffer (MetaDrmBufferImport  *buffer_import,
+                   struct gbm_device    *importer,
+                   GError              **error)
+{
+  MetaDrmFbArgs fb_args = { 0, };
+  struct gbm_bo *primary_bo;
+  struct gbm_bo *imported_bo;
+  gboolean ret;
+
+  primary_bo = meta_drm_buffer_gbm_get_bo (buffer_import->importee);
+
+  fb_args.width = gbm_bo_get_width (primary_bo);
+  fb_args.height = gbm_bo_get_height (primary_bo);
+  fb_args.format = gbm_bo_get_format (primary_bo);
+  fb_args.handle = gbm_bo_get_handle (primary_bo).u32;
+
+  /* With an explicit modifier the display device is told the exact
+   * layout the render device used; without it, it has to guess, so only
+   * single plane buffers the importer interprets as linear can work.
+   */
+  if (should_import_with_modifier (buffer_import->importee))
+    {
+      int i;
+
+      imported_bo = import_bo_with_modifier (importer, primary_bo, error);
+      if (!imported_bo)
+        return FALSE;
+
+      for (i = 0; i < gbm_bo_get_plane_count (imported_bo); i++)
+        {
+          fb_args.handles[i] = gbm_bo_get_handle_for_plane (imported_bo, i).u32;
+          fb_args.strides[i] = gbm_bo_get_stride_for_plane (imported_bo, i);
+          fb_args.offsets[i] = gbm_bo_get_offset (imported_bo, i);
+          fb_args.modifiers[i] = gbm_bo_get_modifier (imported_bo);
+        }
+    }
+  else
+    {
+      imported_bo = import_bo_implicit (importer, primary_bo, error);
+      if (!imported_bo)
+        return FALSE;
+
+      fb_args.handles[0] = gbm_bo_get_handle (imported_bo).u32;
+      fb_args.strides[0] = gbm_bo_get_stride (primary_bo);
+      fb_args.modifiers[0] = DRM_FORMAT_MOD_INVALID;
+    }
 
   ret = meta_drm_buffer_do_ensure_fb_id (META_DRM_BUFFER (buffer_import),
                                          &fb_args,
@@ -186,9 +284,6 @@ import_gbm_buffer (MetaDrmBufferImport  *buffer_import,
 
   gbm_bo_destroy (imported_bo);
 
-out_close:
-  close (dmabuf_fd);
-
   return ret;
 }
 
@@ -199,10 +294,14 @@ meta_drm_buffer_import_new (MetaDeviceFile     *device_file,
                             GError            **error)
 {
   MetaDrmBufferImport *buffer_import;
+  MetaDrmBufferFlags flags = META_DRM_BUFFER_FLAG_NONE;
+
+  if (!should_import_with_modifier (buffer_gbm))
+    flags |= META_DRM_BUFFER_FLAG_DISABLE_MODIFIERS;
 
   buffer_import = g_object_new (META_TYPE_DRM_BUFFER_IMPORT,
                                 "device-file", device_file,
-                                "flags", META_DRM_BUFFER_FLAG_DISABLE_MODIFIERS,
+                                "flags", flags,
                                 NULL);
   g_set_object (&buffer_import->importee, buffer_gbm);
 
@@ -240,6 +240,14 @@ meta_drm_buffer_get_modifier (MetaDrmBuffer *buffer)
   return META_DRM_BUFFER_GET_CLASS (buffer)->get_modifier (buffer);
 }
 
+MetaDrmBufferFlags
+meta_drm_buffer_get_flags (MetaDrmBuffer *buffer)
+{
+  MetaDrmBufferPrivate *priv = meta_drm_buffer_get_instance_private (buffer);
+
+  return priv->flags;
+}
+
 static void
 meta_drm_buffer_get_property (GObject    *object,
                               guint       prop_id,
@@ -522,6 +522,7 @@ update_internal_xkb_state (MetaInputDeviceNative *device,
                          latched_mods,
                          locked_mods,
                          0, 0, group_mods);
+  meta_seat_impl_publish_modifier_state_in_impl (seat_impl);
   notify_stickykeys_mask (device);
 
   g_rw_lock_writer_unlock (&seat_impl->state_lock);
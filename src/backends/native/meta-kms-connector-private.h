@@ -40,6 +40,7 @@ typedef enum _MetaKmsConnectorProp
   META_KMS_CONNECTOR_PROP_COLORSPACE,
   META_KMS_CONNECTOR_PROP_HDR_OUTPUT_METADATA,
   META_KMS_CONNECTOR_PROP_BROADCAST_RGB,
+  META_KMS_CONNECTOR_PROP_VRR_CAPABLE,
   META_KMS_CONNECTOR_N_PROPS
 } MetaKmsConnectorProp;
 
@@ -149,6 +150,9 @@ MetaKmsConnector * meta_kms_connector_new (MetaKmsImplDevice *impl_device,
 gboolean meta_kms_connector_is_same_as (MetaKmsConnector *connector,
                                         drmModeConnector *drm_connector);
 
+gboolean meta_kms_connector_needs_probe (MetaKmsConnector *connector,
+                                         drmModeConnector *drm_connector_current);
+
 uint64_t meta_output_color_space_to_drm_color_space (MetaOutputColorspace color_space);
 
 uint64_t meta_output_rgb_range_to_drm_broadcast_rgb (MetaOutputRGBRange rgb_range);
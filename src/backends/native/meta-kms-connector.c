@@ -75,8 +75,11 @@ struct _MetaKmsConnector
 
   MetaKmsConnectorPropTable prop_table;
 
+  /* What was seen when last probed; if unchanged there is no need to probe
+   * again on an unspecific hotplug event */
   uint32_t edid_blob_id;
   uint32_t tile_blob_id;
+  int n_probed_modes;
 
   gboolean fd_held;
 };
@@ -261,6 +264,12 @@ meta_kms_connector_is_broadcast_rgb_supported (MetaKmsConnector   *connector,
   return !!(connector->current_state->broadcast_rgb.supported & (1 << broadcast_rgb));
 }
 
+gboolean
+meta_kms_connector_is_vrr_capable (MetaKmsConnector *connector)
+{
+  return connector->current_state && connector->current_state->vrr_capable;
+}
+
 static void
 set_panel_orientation (MetaKmsConnectorState *state,
                        MetaKmsProp           *panel_orientation)
@@ -472,6 +481,10 @@ state_set_properties (MetaKmsConnectorState *state,
       state->broadcast_rgb.supported =
         supported_drm_broadcast_rgb_to_output_rgb_range (prop->supported_variants);
     }
+
+  prop = &props[META_KMS_CONNECTOR_PROP_VRR_CAPABLE];
+  if (prop->prop_id)
+    state->vrr_capable = !!prop->value;
 }
 
 static CoglSubpixelOrder
@@ -776,6 +789,7 @@ out:
 
 static void
 state_set_blobs (MetaKmsConnectorState *state,
+                 MetaKmsConnectorState *current_state,
                  MetaKmsConnector      *connector,
                  MetaKmsImplDevice     *impl_device,
                  drmModeConnector      *drm_connector)
@@ -785,7 +799,14 @@ state_set_blobs (MetaKmsConnectorState *state,
 
   prop = &props[META_KMS_CONNECTOR_PROP_EDID];
   if (prop->prop_id && prop->value)
-    state_set_edid (state, connector, impl_device, prop->value);
+    {
+      /* Property blobs are immutable, so the same blob means the same EDID */
+      if (current_state && current_state->edid_data &&
+          prop->value == connector->edid_blob_id)
+        state->edid_data = g_bytes_ref (current_state->edid_data);
+      else
+        state_set_edid (state, connector, impl_device, prop->value);
+    }
 
   prop = &props[META_KMS_CONNECTOR_PROP_TILE];
   if (prop->prop_id && prop->value)
@@ -1081,6 +1102,9 @@ meta_kms_connector_state_changes (MetaKmsConnectorState *state,
       state->broadcast_rgb.supported != new_state->broadcast_rgb.supported)
     return META_KMS_RESOURCE_CHANGE_FULL;
 
+  if (state->vrr_capable != new_state->vrr_capable)
+    return META_KMS_RESOURCE_CHANGE_FULL;
+
   if (state->privacy_screen_state != new_state->privacy_screen_state)
     return META_KMS_RESOURCE_CHANGE_PRIVACY_SCREEN;
 
@@ -1141,7 +1165,8 @@ meta_kms_connector_read_state (MetaKmsConnector  *connector,
 
   state = meta_kms_connector_state_new ();
 
-  state_set_blobs (state, connector, impl_device, drm_connector);
+  state_set_blobs (state, current_state, connector, impl_device,
+                   drm_connector);
 
   state_set_properties (state, impl_device, connector, drm_connector);
 
@@ -1154,6 +1179,12 @@ meta_kms_connector_read_state (MetaKmsConnector  *connector,
 
   state_set_crtc_state (state, drm_connector, impl_device, drm_resources);
 
+  connector->edid_blob_id =
+    connector->prop_table.props[META_KMS_CONNECTOR_PROP_EDID].value;
+  connector->tile_blob_id =
+    connector->prop_table.props[META_KMS_CONNECTOR_PROP_TILE].value;
+  connector->n_probed_modes = drm_connector->count_modes;
+
   if (drm_connector->connection != connector->connection)
     {
       connector->connection = drm_connector->connection;
@@ -1434,6 +1465,11 @@ init_properties (MetaKmsConnector  *connector,
           .num_enum_values = META_KMS_CONNECTOR_BROADCAST_RGB_N_PROPS,
           .default_value = META_KMS_CONNECTOR_BROADCAST_RGB_UNKNOWN,
         },
+      [META_KMS_CONNECTOR_PROP_VRR_CAPABLE] =
+        {
+          .name = "vrr_capable",
+          .type = DRM_MODE_PROP_RANGE,
+        },
     },
     .dpms_enum = {
       [META_KMS_CONNECTOR_DPMS_ON] =
@@ -1655,6 +1691,61 @@ make_connector_name (drmModeConnector *drm_connector)
                             drm_connector->connector_type_id);
 }
 
+static uint64_t
+find_drm_prop_value (drmModeConnector *drm_connector,
+                     uint32_t          prop_id,
+                     uint64_t          default_value)
+{
+  int i;
+
+  for (i = 0; i < drm_connector->count_props; i++)
+    {
+      if (drm_connector->props[i] == prop_id)
+        return drm_connector->prop_values[i];
+    }
+
+  return default_value;
+}
+
+/*
+ * Compares the cheaply retrieved, unprobed state of the connector with what
+ * was seen when it was last probed. Changing monitors or their EDID is
+ * detected by the kernel before notifying about the hotplug, so connectors
+ * where nothing changed can skip the expensive forced probe.
+ */
+gboolean
+meta_kms_connector_needs_probe (MetaKmsConnector *connector,
+                                drmModeConnector *drm_connector_current)
+{
+  MetaKmsProp *props = connector->prop_table.props;
+
+  if (drm_connector_current->connection != connector->connection)
+    return TRUE;
+
+  if (drm_connector_current->connection != DRM_MODE_CONNECTED)
+    return FALSE;
+
+  if (!connector->current_state)
+    return TRUE;
+
+  if (drm_connector_current->count_modes != connector->n_probed_modes)
+    return TRUE;
+
+  if (props[META_KMS_CONNECTOR_PROP_EDID].prop_id &&
+      find_drm_prop_value (drm_connector_current,
+                           props[META_KMS_CONNECTOR_PROP_EDID].prop_id,
+                           0) != connector->edid_blob_id)
+    return TRUE;
+
+  if (props[META_KMS_CONNECTOR_PROP_TILE].prop_id &&
+      find_drm_prop_value (drm_connector_current,
+                           props[META_KMS_CONNECTOR_PROP_TILE].prop_id,
+                           0) != connector->tile_blob_id)
+    return TRUE;
+
+  return FALSE;
+}
+
 gboolean
 meta_kms_connector_is_same_as (MetaKmsConnector *connector,
                                drmModeConnector *drm_connector)
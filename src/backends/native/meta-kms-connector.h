@@ -74,6 +74,8 @@ typedef struct _MetaKmsConnectorState
     MetaOutputRGBRange value;
     uint64_t supported;
   } broadcast_rgb;
+
+  gboolean vrr_capable;
 } MetaKmsConnectorState;
 
 META_EXPORT_TEST
@@ -107,3 +109,5 @@ gboolean meta_kms_connector_is_broadcast_rgb_supported (MetaKmsConnector   *conn
                                                         MetaOutputRGBRange  broadcast_rgb);
 
 gboolean meta_kms_connector_is_hdr_metadata_supported (MetaKmsConnector *connector);
+
+gboolean meta_kms_connector_is_vrr_capable (MetaKmsConnector *connector);
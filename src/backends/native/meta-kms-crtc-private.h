@@ -28,6 +28,8 @@ typedef enum _MetaKmsCrtcProp
   META_KMS_CRTC_PROP_ACTIVE,
   META_KMS_CRTC_PROP_GAMMA_LUT,
   META_KMS_CRTC_PROP_GAMMA_LUT_SIZE,
+  META_KMS_CRTC_PROP_CTM,
+  META_KMS_CRTC_PROP_VRR_ENABLED,
   META_KMS_CRTC_N_PROPS
 } MetaKmsCrtcProp;
 
@@ -53,6 +55,14 @@ uint64_t meta_kms_crtc_get_prop_drm_value (MetaKmsCrtc     *crtc,
                                            MetaKmsCrtcProp  prop,
                                            uint64_t         value);
 
+void meta_kms_crtc_record_latency (MetaKmsCrtc        *crtc,
+                                   MetaKmsCrtcLatency  latency,
+                                   int64_t             duration_us);
+
+void meta_kms_crtc_count_merged_update (MetaKmsCrtc *crtc);
+
+void meta_kms_crtc_count_discarded_update (MetaKmsCrtc *crtc);
+
 gboolean meta_kms_crtc_determine_deadline (MetaKmsCrtc  *crtc,
                                            int64_t      *out_next_deadline_us,
                                            int64_t      *out_next_presentation_us,
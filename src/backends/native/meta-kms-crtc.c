@@ -20,6 +20,7 @@
 #include "backends/native/meta-kms-crtc.h"
 #include "backends/native/meta-kms-crtc-private.h"
 
+#include "backends/native/meta-kms-connector.h"
 #include "backends/native/meta-kms-device-private.h"
 #include "backends/native/meta-kms-impl-device.h"
 #include "backends/native/meta-kms-impl-device-atomic.h"
@@ -27,6 +28,7 @@
 #include "backends/native/meta-kms-mode.h"
 #include "backends/native/meta-kms-update-private.h"
 #include "backends/native/meta-kms-utils.h"
+#include "cogl/cogl.h"
 
 #define DEADLINE_EVASION_US 800
 #define DEADLINE_EVASION_WITH_KMS_TOPIC_US 1000
@@ -48,6 +50,13 @@ struct _MetaKmsCrtc
   MetaKmsCrtcState current_state;
 
   MetaKmsCrtcPropTable prop_table;
+
+  /* Whether the CRTC still shows what was set up before we took over */
+  gboolean is_state_adoptable;
+
+  GMutex stats_mutex;
+  MetaKmsCrtcStats stats;
+  char *trace_category;
 };
 
 G_DEFINE_TYPE (MetaKmsCrtc, meta_kms_crtc, G_TYPE_OBJECT)
@@ -99,12 +108,86 @@ meta_kms_crtc_get_prop_drm_value (MetaKmsCrtc     *crtc,
   return meta_kms_prop_convert_value (prop, value);
 }
 
+/**
+ * meta_kms_crtc_adopt_state:
+ * @crtc: A #MetaKmsCrtc
+ * @mode: The mode that is about to be set
+ * @connectors: (element-type MetaKmsConnector): The connectors to drive
+ *
+ * Checks whether the mode and connectors the CRTC was left with, e.g. by the
+ * firmware or a boot splash, are the ones about to be configured. If so, the
+ * mode set can be left out and the first frame presented with a page flip,
+ * avoiding a flash and the delay of reconfiguring the display.
+ *
+ * Adopting is only possible for the first mode set of a CRTC; later ones
+ * always return %FALSE.
+ *
+ * Returns: %TRUE if the current state was adopted
+ */
+gboolean
+meta_kms_crtc_adopt_state (MetaKmsCrtc *crtc,
+                           MetaKmsMode *mode,
+                           GList       *connectors)
+{
+  MetaKmsImplDevice *impl_device =
+    meta_kms_device_get_impl_device (crtc->device);
+  const MetaKmsCrtcState *crtc_state = &crtc->current_state;
+  GList *l;
+
+  if (!crtc->is_state_adoptable)
+    return FALSE;
+
+  crtc->is_state_adoptable = FALSE;
+
+  /* The legacy backend relies on its own mode sets for page flipping */
+  if (!META_IS_KMS_IMPL_DEVICE_ATOMIC (impl_device))
+    return FALSE;
+
+  if (!mode || !connectors)
+    return FALSE;
+
+  if (!crtc_state->is_active || !crtc_state->is_drm_mode_valid)
+    return FALSE;
+
+  if (!meta_drm_mode_equal (&crtc_state->drm_mode,
+                            meta_kms_mode_get_drm_mode (mode)))
+    return FALSE;
+
+  for (l = meta_kms_device_get_connectors (crtc->device); l; l = l->next)
+    {
+      MetaKmsConnector *connector = l->data;
+      const MetaKmsConnectorState *connector_state;
+      gboolean is_driven;
+
+      connector_state = meta_kms_connector_get_current_state (connector);
+      is_driven = (connector_state &&
+                   connector_state->current_crtc_id == crtc->id);
+
+      if (is_driven != !!g_list_find (connectors, connector))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 gboolean
 meta_kms_crtc_is_active (MetaKmsCrtc *crtc)
 {
   return crtc->current_state.is_active;
 }
 
+gboolean
+meta_kms_crtc_is_vrr_supported (MetaKmsCrtc *crtc)
+{
+  return crtc->current_state.vrr.supported;
+}
+
+gboolean
+meta_kms_crtc_is_ctm_supported (MetaKmsCrtc *crtc)
+{
+  return crtc->prop_table.props[META_KMS_CRTC_PROP_CTM].prop_id != 0;
+}
+
 static void
 read_crtc_gamma (MetaKmsCrtc       *crtc,
                  MetaKmsCrtcState  *crtc_state,
@@ -239,6 +322,7 @@ meta_kms_crtc_read_state (MetaKmsCrtc             *crtc,
   MetaKmsCrtcState crtc_state = {0};
   MetaKmsResourceChanges changes = META_KMS_RESOURCE_CHANGE_NONE;
   MetaKmsProp *active_prop;
+  MetaKmsProp *vrr_enabled_prop;
 
   meta_kms_impl_device_update_prop_table (impl_device,
                                           drm_props->props,
@@ -266,6 +350,13 @@ meta_kms_crtc_read_state (MetaKmsCrtc             *crtc,
 
   read_gamma_state (crtc, &crtc_state, impl_device, drm_crtc);
 
+  vrr_enabled_prop = &crtc->prop_table.props[META_KMS_CRTC_PROP_VRR_ENABLED];
+  if (vrr_enabled_prop->prop_id)
+    {
+      crtc_state.vrr.supported = TRUE;
+      crtc_state.vrr.enabled = !!vrr_enabled_prop->value;
+    }
+
   if (!crtc_state.is_active)
     {
       if (crtc->current_state.is_active)
@@ -281,11 +372,12 @@ meta_kms_crtc_read_state (MetaKmsCrtc             *crtc,
   crtc->current_state = crtc_state;
 
   meta_topic (META_DEBUG_KMS,
-              "Read CRTC %u state: active: %d, mode: %s, changed: %s",
+              "Read CRTC %u state: active: %d, mode: %s, vrr: %d, changed: %s",
               crtc->id, crtc->current_state.is_active,
               crtc->current_state.is_drm_mode_valid
                 ? crtc->current_state.drm_mode.name
                 : "(nil)",
+              crtc->current_state.vrr.enabled,
               changes == META_KMS_RESOURCE_CHANGE_NONE
                 ? "no"
                 : "yes");
@@ -341,6 +433,7 @@ meta_kms_crtc_predict_state_in_impl (MetaKmsCrtc   *crtc,
 {
   GList *mode_sets;
   GList *crtc_color_updates;
+  GList *crtc_updates;
   GList *l;
 
   mode_sets = meta_kms_update_get_mode_sets (update);
@@ -396,6 +489,19 @@ meta_kms_crtc_predict_state_in_impl (MetaKmsCrtc   *crtc,
         }
       break;
     }
+
+  crtc_updates = meta_kms_update_get_crtc_updates (update);
+  for (l = crtc_updates; l; l = l->next)
+    {
+      MetaKmsCrtcUpdate *crtc_update = l->data;
+
+      if (crtc_update->crtc != crtc)
+        continue;
+
+      if (crtc_update->vrr.has_update)
+        crtc->current_state.vrr.enabled = crtc_update->vrr.is_enabled;
+      break;
+    }
 }
 
 static void
@@ -427,6 +533,16 @@ init_properties (MetaKmsCrtc       *crtc,
           .name = "GAMMA_LUT_SIZE",
           .type = DRM_MODE_PROP_RANGE,
         },
+      [META_KMS_CRTC_PROP_CTM] =
+        {
+          .name = "CTM",
+          .type = DRM_MODE_PROP_BLOB,
+        },
+      [META_KMS_CRTC_PROP_VRR_ENABLED] =
+        {
+          .name = "VRR_ENABLED",
+          .type = DRM_MODE_PROP_RANGE,
+        },
     }
   };
 }
@@ -456,6 +572,9 @@ meta_kms_crtc_new (MetaKmsImplDevice  *impl_device,
   crtc->id = drm_crtc->crtc_id;
   crtc->idx = idx;
 
+  crtc->trace_category = g_strdup_printf ("KMS CRTC %u", crtc->id);
+  crtc->is_state_adoptable = TRUE;
+
   init_properties (crtc, impl_device, drm_crtc);
 
   meta_kms_crtc_read_state (crtc, impl_device, drm_crtc, drm_props);
@@ -471,6 +590,8 @@ meta_kms_crtc_finalize (GObject *object)
   MetaKmsCrtc *crtc = META_KMS_CRTC (object);
 
   g_clear_pointer (&crtc->current_state.gamma.value, meta_gamma_lut_free);
+  g_clear_pointer (&crtc->trace_category, g_free);
+  g_mutex_clear (&crtc->stats_mutex);
 
   G_OBJECT_CLASS (meta_kms_crtc_parent_class)->finalize (object);
 }
@@ -480,6 +601,8 @@ meta_kms_crtc_init (MetaKmsCrtc *crtc)
 {
   crtc->current_state.gamma.size = 0;
   crtc->current_state.gamma.value = NULL;
+
+  g_mutex_init (&crtc->stats_mutex);
 }
 
 static void
@@ -490,6 +613,73 @@ meta_kms_crtc_class_init (MetaKmsCrtcClass *klass)
   object_class->finalize = meta_kms_crtc_finalize;
 }
 
+const char *
+meta_kms_crtc_latency_to_string (MetaKmsCrtcLatency latency)
+{
+  switch (latency)
+    {
+    case META_KMS_CRTC_LATENCY_POST_TO_COMMIT:
+      return "post-to-commit";
+    case META_KMS_CRTC_LATENCY_COMMIT_DURATION:
+      return "commit-duration";
+    case META_KMS_CRTC_LATENCY_COMMIT_TO_FLIP:
+      return "commit-to-flip";
+    case META_KMS_CRTC_LATENCY_DEADLINE_SLACK:
+      return "deadline-slack";
+    case META_KMS_CRTC_N_LATENCIES:
+      break;
+    }
+
+  g_assert_not_reached ();
+}
+
+void
+meta_kms_crtc_get_stats (MetaKmsCrtc      *crtc,
+                         MetaKmsCrtcStats *stats)
+{
+  g_mutex_lock (&crtc->stats_mutex);
+  *stats = crtc->stats;
+  g_mutex_unlock (&crtc->stats_mutex);
+}
+
+void
+meta_kms_crtc_record_latency (MetaKmsCrtc        *crtc,
+                              MetaKmsCrtcLatency  latency,
+                              int64_t             duration_us)
+{
+  int bucket;
+
+  COGL_TRACE_COUNTER (crtc->trace_category,
+                      meta_kms_crtc_latency_to_string (latency),
+                      duration_us);
+
+  if (duration_us > 0)
+    bucket = MIN (g_bit_nth_msf ((gulong) duration_us, -1),
+                  META_KMS_CRTC_STATS_N_BUCKETS - 1);
+  else
+    bucket = 0;
+
+  g_mutex_lock (&crtc->stats_mutex);
+  crtc->stats.latencies[latency][bucket]++;
+  g_mutex_unlock (&crtc->stats_mutex);
+}
+
+void
+meta_kms_crtc_count_merged_update (MetaKmsCrtc *crtc)
+{
+  g_mutex_lock (&crtc->stats_mutex);
+  crtc->stats.n_merged_updates++;
+  g_mutex_unlock (&crtc->stats_mutex);
+}
+
+void
+meta_kms_crtc_count_discarded_update (MetaKmsCrtc *crtc)
+{
+  g_mutex_lock (&crtc->stats_mutex);
+  crtc->stats.n_discarded_updates++;
+  g_mutex_unlock (&crtc->stats_mutex);
+}
+
 static drmVBlankSeqType
 get_crtc_type_bitmask (MetaKmsCrtc *crtc)
 {
@@ -39,8 +39,38 @@ typedef struct _MetaKmsCrtcState
     int size;
     gboolean supported;
   } gamma;
+
+  struct {
+    gboolean supported;
+    gboolean enabled;
+  } vrr;
 } MetaKmsCrtcState;
 
+typedef enum _MetaKmsCrtcLatency
+{
+  META_KMS_CRTC_LATENCY_POST_TO_COMMIT,
+  META_KMS_CRTC_LATENCY_COMMIT_DURATION,
+  META_KMS_CRTC_LATENCY_COMMIT_TO_FLIP,
+  META_KMS_CRTC_LATENCY_DEADLINE_SLACK,
+
+  META_KMS_CRTC_N_LATENCIES,
+} MetaKmsCrtcLatency;
+
+#define META_KMS_CRTC_STATS_N_BUCKETS 16
+
+/*
+ * Latencies are histograms with power-of-two buckets, i.e. bucket n counts
+ * values between 2^n and 2^(n+1) µs; the first and last bucket also count
+ * anything below or above.
+ */
+typedef struct _MetaKmsCrtcStats
+{
+  uint64_t latencies[META_KMS_CRTC_N_LATENCIES][META_KMS_CRTC_STATS_N_BUCKETS];
+
+  uint64_t n_merged_updates;
+  uint64_t n_discarded_updates;
+} MetaKmsCrtcStats;
+
 #define META_TYPE_KMS_CRTC (meta_kms_crtc_get_type ())
 META_EXPORT_TEST
 G_DECLARE_FINAL_TYPE (MetaKmsCrtc, meta_kms_crtc,
@@ -60,3 +90,17 @@ int meta_kms_crtc_get_idx (MetaKmsCrtc *crtc);
 
 META_EXPORT_TEST
 gboolean meta_kms_crtc_is_active (MetaKmsCrtc *crtc);
+
+gboolean meta_kms_crtc_adopt_state (MetaKmsCrtc *crtc,
+                                    MetaKmsMode *mode,
+                                    GList       *connectors);
+
+gboolean meta_kms_crtc_is_vrr_supported (MetaKmsCrtc *crtc);
+
+META_EXPORT_TEST
+gboolean meta_kms_crtc_is_ctm_supported (MetaKmsCrtc *crtc);
+
+void meta_kms_crtc_get_stats (MetaKmsCrtc      *crtc,
+                              MetaKmsCrtcStats *stats);
+
+const char * meta_kms_crtc_latency_to_string (MetaKmsCrtcLatency latency);
@@ -67,6 +67,12 @@ struct _MetaKmsCursorManager
   GObject parent;
 
   MetaKms *kms;
+
+  /* The latest pointer position reported by the input thread, and whether
+   * a task handling it is already queued for the KMS thread. */
+  GMutex position_mutex;
+  graphene_point_t pending_position;
+  gboolean is_position_change_pending;
 };
 
 G_DEFINE_TYPE (MetaKmsCursorManager, meta_kms_cursor_manager,
@@ -584,6 +590,8 @@ meta_kms_cursor_manager_finalize (GObject *object)
                                     finalize_in_impl, NULL, NULL);
   g_clear_pointer (&crtc_states, g_ptr_array_unref);
 
+  g_mutex_clear (&cursor_manager->position_mutex);
+
   G_OBJECT_CLASS (meta_kms_cursor_manager_parent_class)->finalize (object);
 }
 
@@ -601,6 +609,7 @@ meta_kms_cursor_manager_class_init (MetaKmsCursorManagerClass *klass)
 static void
 meta_kms_cursor_manager_init (MetaKmsCursorManager *cursor_manager)
 {
+  g_mutex_init (&cursor_manager->position_mutex);
 }
 
 MetaKmsCursorManager *
@@ -659,10 +668,17 @@ position_changed_in_impl (MetaThreadImpl  *thread_impl,
 {
   MetaKmsCursorManagerImpl *cursor_manager_impl =
     ensure_cursor_manager_impl (META_KMS_IMPL (thread_impl));
-  const graphene_point_t *position = user_data;
+  MetaKmsCursorManager *cursor_manager = user_data;
+  graphene_point_t latest_position;
+  const graphene_point_t *position = &latest_position;
   GPtrArray *crtc_states;
   int i;
 
+  g_mutex_lock (&cursor_manager->position_mutex);
+  latest_position = cursor_manager->pending_position;
+  cursor_manager->is_position_change_pending = FALSE;
+  g_mutex_unlock (&cursor_manager->position_mutex);
+
   crtc_states = cursor_manager_impl->crtc_states;
   g_return_val_if_fail (crtc_states, NULL);
 
@@ -711,20 +727,28 @@ position_changed_in_impl (MetaThreadImpl  *thread_impl,
   return NULL;
 }
 
-static graphene_point_t *
-copy_point (const graphene_point_t *point)
-{
-  return graphene_point_init_from_point (graphene_point_alloc (), point);
-}
-
 void
 meta_kms_cursor_manager_position_changed_in_input_impl (MetaKmsCursorManager   *cursor_manager,
                                                         const graphene_point_t *position)
 {
+  gboolean was_position_change_pending;
+
+  /* The cursor plane itself is positioned from the position queried when
+   * the update is built, so a task that hasn't run yet just picks up the
+   * new position, and high rate pointer devices don't flood the KMS thread
+   * with a task per motion event. */
+  g_mutex_lock (&cursor_manager->position_mutex);
+  cursor_manager->pending_position = *position;
+  was_position_change_pending = cursor_manager->is_position_change_pending;
+  cursor_manager->is_position_change_pending = TRUE;
+  g_mutex_unlock (&cursor_manager->position_mutex);
+
+  if (was_position_change_pending)
+    return;
+
   meta_thread_post_impl_task (META_THREAD (cursor_manager->kms),
                               position_changed_in_impl,
-                              copy_point (position),
-                              (GDestroyNotify) graphene_point_free,
+                              cursor_manager, NULL,
                               NULL, NULL);
 }
 
@@ -140,6 +140,15 @@ meta_kms_device_uses_monotonic_clock (MetaKmsDevice *device)
   return device->caps.uses_monotonic_clock;
 }
 
+gboolean
+meta_kms_device_supports_async_page_flip (MetaKmsDevice *device)
+{
+  if (META_IS_KMS_IMPL_DEVICE_ATOMIC (device->impl_device))
+    return device->caps.atomic_async_page_flip;
+  else
+    return device->caps.async_page_flip;
+}
+
 GList *
 meta_kms_device_get_connectors (MetaKmsDevice *device)
 {
@@ -259,7 +268,8 @@ meta_kms_device_disable (MetaKmsDevice *device)
 MetaKmsResourceChanges
 meta_kms_device_update_states_in_impl (MetaKmsDevice *device,
                                        uint32_t       crtc_id,
-                                       uint32_t       connector_id)
+                                       uint32_t       connector_id,
+                                       gboolean       probe_all)
 {
   MetaKmsImplDevice *impl_device = meta_kms_device_get_impl_device (device);
   MetaKmsResourceChanges changes;
@@ -268,7 +278,7 @@ meta_kms_device_update_states_in_impl (MetaKmsDevice *device,
   meta_assert_is_waiting_for_kms_impl_task (device->kms);
 
   changes = meta_kms_impl_device_update_states (impl_device, crtc_id,
-                                                connector_id);
+                                                connector_id, probe_all);
 
   if (changes == META_KMS_RESOURCE_CHANGE_NONE)
     return changes;
@@ -345,6 +355,8 @@ meta_kms_device_post_update (MetaKmsDevice       *device,
 
   g_return_if_fail (meta_kms_update_get_device (update) == device);
 
+  meta_kms_update_set_post_time (update, g_get_monotonic_time ());
+
   data = g_new0 (PostUpdateData, 1);
   *data = (PostUpdateData) {
     .update = update,
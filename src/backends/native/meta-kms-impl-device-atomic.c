@@ -19,6 +19,8 @@
 
 #include "backends/native/meta-kms-impl-device-atomic.h"
 
+#include <errno.h>
+
 #include "backends/native/meta-backend-native-private.h"
 #include "backends/native/meta-kms-connector-private.h"
 #include "backends/native/meta-kms-crtc-private.h"
@@ -36,11 +38,29 @@ typedef gboolean (* MetaKmsAtomicProcessFunc) (MetaKmsImplDevice  *impl_device,
                                                gpointer            user_data,
                                                GError            **error);
 
+/* Interned blobs are kept around until this many different ones exist */
+#define MAX_CACHED_BLOBS 32
+
+typedef struct _PropValue
+{
+  uint32_t object_id;
+  uint32_t prop_id;
+  uint64_t value;
+} PropValue;
+
 struct _MetaKmsImplDeviceAtomic
 {
   MetaKmsImplDevice parent;
 
   GHashTable *page_flip_datas;
+
+  /* Last committed value of each property, and the values added to the
+   * request currently being built; used to leave out unchanged properties.
+   */
+  GHashTable *committed_props;
+  GHashTable *pending_props;
+
+  GHashTable *cached_blobs;
 };
 
 static GInitableIface *initable_parent_iface;
@@ -63,6 +83,139 @@ G_DEFINE_TYPE_WITH_CODE (MetaKmsImplDeviceAtomic, meta_kms_impl_device_atomic,
                          G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE,
                                                 initable_iface_init))
 
+static guint
+prop_value_hash (gconstpointer key)
+{
+  const PropValue *prop_value = key;
+
+  return prop_value->object_id ^ (prop_value->prop_id << 16);
+}
+
+static gboolean
+prop_value_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const PropValue *prop_value_a = a;
+  const PropValue *prop_value_b = b;
+
+  return (prop_value_a->object_id == prop_value_b->object_id &&
+          prop_value_a->prop_id == prop_value_b->prop_id);
+}
+
+static gboolean
+is_prop_value_unchanged (MetaKmsImplDevice *impl_device,
+                         uint32_t           object_id,
+                         uint32_t           prop_id,
+                         uint64_t           value)
+{
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
+  PropValue key = { .object_id = object_id, .prop_id = prop_id };
+  PropValue *prop_value;
+
+  if (!impl_device_atomic->pending_props)
+    return FALSE;
+
+  prop_value = g_hash_table_lookup (impl_device_atomic->pending_props, &key);
+  if (!prop_value)
+    prop_value = g_hash_table_lookup (impl_device_atomic->committed_props, &key);
+
+  return prop_value && prop_value->value == value;
+}
+
+static void
+record_prop_value (MetaKmsImplDevice *impl_device,
+                   uint32_t           object_id,
+                   uint32_t           prop_id,
+                   uint64_t           value)
+{
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
+  PropValue *prop_value;
+
+  if (!impl_device_atomic->pending_props)
+    return;
+
+  prop_value = g_new0 (PropValue, 1);
+  prop_value->object_id = object_id;
+  prop_value->prop_id = prop_id;
+  prop_value->value = value;
+  g_hash_table_add (impl_device_atomic->pending_props, prop_value);
+}
+
+static void
+apply_pending_prop_values (MetaKmsImplDeviceAtomic *impl_device_atomic)
+{
+  GHashTableIter iter;
+  PropValue *prop_value;
+
+  g_hash_table_iter_init (&iter, impl_device_atomic->pending_props);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &prop_value, NULL))
+    {
+      g_hash_table_iter_steal (&iter);
+      g_hash_table_add (impl_device_atomic->committed_props, prop_value);
+    }
+}
+
+static void
+reset_cached_state (MetaKmsImplDeviceAtomic *impl_device_atomic)
+{
+  MetaKmsImplDevice *impl_device = META_KMS_IMPL_DEVICE (impl_device_atomic);
+  GHashTableIter iter;
+  gpointer blob_id;
+
+  if (g_hash_table_size (impl_device_atomic->cached_blobs) > 0)
+    {
+      int fd = meta_kms_impl_device_get_fd (impl_device);
+
+      g_hash_table_iter_init (&iter, impl_device_atomic->cached_blobs);
+      while (g_hash_table_iter_next (&iter, NULL, &blob_id))
+        drmModeDestroyPropertyBlob (fd, GPOINTER_TO_UINT (blob_id));
+    }
+
+  g_hash_table_remove_all (impl_device_atomic->cached_blobs);
+
+  /* Destroyed blob IDs may be reused, so committed values referring to them
+   * can't be trusted anymore.
+   */
+  g_hash_table_remove_all (impl_device_atomic->committed_props);
+}
+
+static uint32_t
+intern_blob (MetaKmsImplDevice  *impl_device,
+             const void         *data,
+             size_t              size,
+             GError            **error)
+{
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
+  g_autoptr (GBytes) bytes = NULL;
+  gpointer blob_id;
+  uint32_t new_blob_id;
+  int fd;
+  int ret;
+
+  bytes = g_bytes_new (data, size);
+  if (g_hash_table_lookup_extended (impl_device_atomic->cached_blobs,
+                                    bytes, NULL, &blob_id))
+    return GPOINTER_TO_UINT (blob_id);
+
+  fd = meta_kms_impl_device_get_fd (impl_device);
+  ret = drmModeCreatePropertyBlob (fd, data, size, &new_blob_id);
+  if (ret < 0)
+    {
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                   "drmModeCreatePropertyBlob: %s", g_strerror (-ret));
+      return 0;
+    }
+
+  g_hash_table_insert (impl_device_atomic->cached_blobs,
+                       g_steal_pointer (&bytes),
+                       GUINT_TO_POINTER (new_blob_id));
+
+  return new_blob_id;
+}
+
 static uint32_t
 store_new_blob (MetaKmsImplDevice  *impl_device,
                 GArray             *blob_ids,
@@ -124,6 +277,11 @@ add_connector_property (MetaKmsImplDevice     *impl_device,
 
   value = meta_kms_connector_get_prop_drm_value (connector, prop, value);
 
+  if (is_prop_value_unchanged (impl_device,
+                               meta_kms_connector_get_id (connector),
+                               prop_id, value))
+    return TRUE;
+
   meta_topic (META_DEBUG_KMS,
               "[atomic] Setting connector %u (%s) property '%s' (%u) to %"
               G_GUINT64_FORMAT,
@@ -146,6 +304,10 @@ add_connector_property (MetaKmsImplDevice     *impl_device,
       return FALSE;
     }
 
+  record_prop_value (impl_device,
+                     meta_kms_connector_get_id (connector),
+                     prop_id, value);
+
   return TRUE;
 }
 
@@ -275,11 +437,10 @@ process_connector_update (MetaKmsImplDevice  *impl_device,
 
           meta_set_drm_hdr_metadata (&connector_update->hdr.value, &metadata);
 
-          hdr_blob_id = store_new_blob (impl_device,
-                                        blob_ids,
-                                        &metadata,
-                                        sizeof (metadata),
-                                        error);
+          hdr_blob_id = intern_blob (impl_device,
+                                     &metadata,
+                                     sizeof (metadata),
+                                     error);
           if (!hdr_blob_id)
             return FALSE;
         }
@@ -336,6 +497,11 @@ add_crtc_property (MetaKmsImplDevice  *impl_device,
 
   value = meta_kms_crtc_get_prop_drm_value (crtc, prop, value);
 
+  if (is_prop_value_unchanged (impl_device,
+                               meta_kms_crtc_get_id (crtc),
+                               prop_id, value))
+    return TRUE;
+
   meta_topic (META_DEBUG_KMS,
               "[atomic] Setting CRTC %u (%s) property '%s' (%u) to %"
               G_GUINT64_FORMAT,
@@ -359,6 +525,10 @@ add_crtc_property (MetaKmsImplDevice  *impl_device,
       return FALSE;
     }
 
+  record_prop_value (impl_device,
+                     meta_kms_crtc_get_id (crtc),
+                     prop_id, value);
+
   return TRUE;
 }
 
@@ -381,12 +551,13 @@ process_mode_set (MetaKmsImplDevice  *impl_device,
       uint32_t mode_id;
       GList *l;
 
-      mode_id = meta_kms_mode_create_blob_id (mode, error);
+      mode_id = intern_blob (impl_device,
+                             meta_kms_mode_get_drm_mode (mode),
+                             sizeof (drmModeModeInfo),
+                             error);
       if (mode_id == 0)
         return FALSE;
 
-      g_array_append_val (blob_ids, mode_id);
-
       meta_topic (META_DEBUG_KMS,
                   "[atomic] Setting mode of CRTC %u (%s) to %s",
                   meta_kms_crtc_get_id (crtc),
@@ -444,6 +615,24 @@ process_mode_set (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+static gboolean
+is_plane_prop_diffable (MetaKmsPlaneProp prop)
+{
+  switch (prop)
+    {
+    /* Always add these, as they are either only valid for a single commit,
+     * or what pulls the plane, and thus the CRTC, into the commit.
+     */
+    case META_KMS_PLANE_PROP_FB_ID:
+    case META_KMS_PLANE_PROP_CRTC_ID:
+    case META_KMS_PLANE_PROP_IN_FENCE_FD:
+    case META_KMS_PLANE_PROP_FB_DAMAGE_CLIPS_ID:
+      return FALSE;
+    default:
+      return TRUE;
+    }
+}
+
 static gboolean
 add_plane_property (MetaKmsImplDevice  *impl_device,
                     MetaKmsPlane       *plane,
@@ -467,6 +656,12 @@ add_plane_property (MetaKmsImplDevice  *impl_device,
 
   value = meta_kms_plane_get_prop_drm_value (plane, prop, value);
 
+  if (is_plane_prop_diffable (prop) &&
+      is_prop_value_unchanged (impl_device,
+                               meta_kms_plane_get_id (plane),
+                               prop_id, value))
+    return TRUE;
+
   switch (meta_kms_plane_get_prop_internal_type (plane, prop))
     {
     case META_KMS_PROP_TYPE_RAW:
@@ -504,6 +699,13 @@ add_plane_property (MetaKmsImplDevice  *impl_device,
       return FALSE;
     }
 
+  if (is_plane_prop_diffable (prop))
+    {
+      record_prop_value (impl_device,
+                         meta_kms_plane_get_id (plane),
+                         prop_id, value);
+    }
+
   return TRUE;
 }
 
@@ -618,21 +820,25 @@ process_plane_assignment (MetaKmsImplDevice  *impl_device,
             return FALSE;
         }
 
-      if (plane_assignment->flags & META_KMS_ASSIGN_PLANE_FLAG_DIRECT_SCANOUT)
+      if (plane_assignment->in_fence_fd >= 0 ||
+          plane_assignment->flags & META_KMS_ASSIGN_PLANE_FLAG_DIRECT_SCANOUT)
         {
-          int signaled_sync_file;
+          int in_fence_fd;
 
-          signaled_sync_file =
-            meta_kms_impl_device_get_signaled_sync_file (impl_device);
+          if (plane_assignment->in_fence_fd >= 0)
+            in_fence_fd = plane_assignment->in_fence_fd;
+          else
+            in_fence_fd =
+              meta_kms_impl_device_get_signaled_sync_file (impl_device);
 
-          if (signaled_sync_file >= 0)
+          if (in_fence_fd >= 0)
             {
               g_autoptr (GError) local_error = NULL;
 
               if (!add_plane_property (impl_device,
                                        plane, req,
                                        META_KMS_PLANE_PROP_IN_FENCE_FD,
-                                       signaled_sync_file,
+                                       in_fence_fd,
                                        &local_error))
                 {
                   meta_topic (META_DEBUG_KMS,
@@ -777,11 +983,10 @@ process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
               drm_color_lut[i].blue = gamma->blue[i];
             }
 
-          color_lut_blob_id = store_new_blob (impl_device,
-                                              blob_ids,
-                                              drm_color_lut,
-                                              color_lut_size,
-                                              error);
+          color_lut_blob_id = intern_blob (impl_device,
+                                           drm_color_lut,
+                                           color_lut_size,
+                                           error);
 
           meta_topic (META_DEBUG_KMS,
                       "[atomic] Setting CRTC (%u, %s) gamma, size: %zu",
@@ -805,6 +1010,74 @@ process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
         return FALSE;
     }
 
+  if (color_update->ctm.has_update)
+    {
+      uint32_t ctm_blob_id = 0;
+
+      if (!color_update->ctm.is_bypass)
+        {
+          struct drm_color_ctm drm_ctm;
+
+          meta_kms_crtc_color_update_get_drm_ctm (color_update, &drm_ctm);
+          ctm_blob_id = intern_blob (impl_device,
+                                     &drm_ctm,
+                                     sizeof (drm_ctm),
+                                     error);
+          if (!ctm_blob_id)
+            return FALSE;
+
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) color transformation matrix",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+      else
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[atomic] Setting CRTC (%u, %s) color transformation matrix to bypass",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+
+      if (!add_crtc_property (impl_device,
+                              crtc, req,
+                              META_KMS_CRTC_PROP_CTM,
+                              ctm_blob_id,
+                              error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+process_crtc_updates (MetaKmsImplDevice  *impl_device,
+                      MetaKmsUpdate      *update,
+                      drmModeAtomicReq   *req,
+                      GArray             *blob_ids,
+                      gpointer            update_entry,
+                      gpointer            user_data,
+                      GError            **error)
+{
+  MetaKmsCrtcUpdate *crtc_update = update_entry;
+  MetaKmsCrtc *crtc = crtc_update->crtc;
+
+  if (crtc_update->vrr.has_update)
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "[atomic] Setting VRR mode on CRTC %u (%s) to %s",
+                  meta_kms_crtc_get_id (crtc),
+                  meta_kms_impl_device_get_path (impl_device),
+                  crtc_update->vrr.is_enabled ? "enabled" : "disabled");
+
+      if (!add_crtc_property (impl_device,
+                              crtc, req,
+                              META_KMS_CRTC_PROP_VRR_ENABLED,
+                              !!crtc_update->vrr.is_enabled,
+                              error))
+        return FALSE;
+    }
+
   return TRUE;
 }
 
@@ -856,6 +1129,74 @@ process_page_flip_listener (MetaKmsImplDevice  *impl_device,
   return TRUE;
 }
 
+static gboolean
+has_pending_prop_values (MetaKmsImplDeviceAtomic *impl_device_atomic,
+                         uint32_t                 object_id)
+{
+  GHashTableIter iter;
+  PropValue *prop_value;
+
+  g_hash_table_iter_init (&iter, impl_device_atomic->pending_props);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &prop_value, NULL))
+    {
+      if (prop_value->object_id == object_id)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+ensure_page_flip_crtcs_in_request (MetaKmsImplDevice  *impl_device,
+                                   MetaKmsUpdate      *update,
+                                   drmModeAtomicReq   *req,
+                                   GError            **error)
+{
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
+  GList *l;
+
+  for (l = meta_kms_update_get_page_flip_listeners (update); l; l = l->next)
+    {
+      MetaKmsPageFlipListener *listener = l->data;
+      MetaKmsCrtc *crtc = listener->crtc;
+      PropValue key;
+      GList *k;
+
+      for (k = meta_kms_update_get_plane_assignments (update); k; k = k->next)
+        {
+          MetaKmsPlaneAssignment *plane_assignment = k->data;
+
+          if (plane_assignment->crtc == crtc)
+            break;
+        }
+
+      if (k)
+        continue;
+
+      if (has_pending_prop_values (impl_device_atomic,
+                                   meta_kms_crtc_get_id (crtc)))
+        continue;
+
+      /* Everything on this CRTC was left out as unchanged; re-add a
+       * property so that the kernel still sends a page flip event for it.
+       */
+      key = (PropValue) {
+        .object_id = meta_kms_crtc_get_id (crtc),
+        .prop_id = meta_kms_crtc_get_prop_id (crtc, META_KMS_CRTC_PROP_ACTIVE),
+      };
+      g_hash_table_remove (impl_device_atomic->committed_props, &key);
+      if (!add_crtc_property (impl_device,
+                              crtc, req,
+                              META_KMS_CRTC_PROP_ACTIVE,
+                              meta_kms_crtc_is_active (crtc),
+                              error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 process_entries (MetaKmsImplDevice         *impl_device,
                  MetaKmsUpdate             *update,
@@ -931,7 +1272,7 @@ static const char *
 commit_flags_string (uint32_t commit_flags)
 {
   static char static_commit_flags_string[255];
-  const char *commit_flag_strings[4] = { NULL };
+  const char *commit_flag_strings[6] = { NULL };
   int i = 0;
   g_autofree char *commit_flags_string = NULL;
 
@@ -943,6 +1284,8 @@ commit_flags_string (uint32_t commit_flags)
     commit_flag_strings[i++] = "PAGE_FLIP_EVENT";
   if (commit_flags & DRM_MODE_ATOMIC_TEST_ONLY)
     commit_flag_strings[i++] = "TEST_ONLY";
+  if (commit_flags & DRM_MODE_PAGE_FLIP_ASYNC)
+    commit_flag_strings[i++] = "PAGE_FLIP_ASYNC";
 
   commit_flags_string = g_strjoinv ("|", (char **) commit_flag_strings);
   strncpy (static_commit_flags_string, commit_flags_string,
@@ -1049,6 +1392,8 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
                                             MetaKmsUpdate     *update,
                                             MetaKmsUpdateFlag  flags)
 {
+  MetaKmsImplDeviceAtomic *impl_device_atomic =
+    META_KMS_IMPL_DEVICE_ATOMIC (impl_device);
   GError *error = NULL;
   GList *failed_planes = NULL;
   drmModeAtomicReq *req;
@@ -1061,6 +1406,12 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
 
   meta_topic (META_DEBUG_KMS, "[atomic] Processing update");
 
+  if (g_hash_table_size (impl_device_atomic->cached_blobs) >= MAX_CACHED_BLOBS)
+    reset_cached_state (impl_device_atomic);
+
+  impl_device_atomic->pending_props =
+    g_hash_table_new_full (prop_value_hash, prop_value_equal, g_free, NULL);
+
   req = drmModeAtomicAlloc ();
   if (!req)
     {
@@ -1116,6 +1467,19 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
                         &error))
     goto err;
 
+  if (!process_entries (impl_device,
+                        update,
+                        req,
+                        blob_ids,
+                        meta_kms_update_get_crtc_updates (update),
+                        NULL,
+                        process_crtc_updates,
+                        &error))
+    goto err;
+
+  if (!ensure_page_flip_crtcs_in_request (impl_device, update, req, &error))
+    goto err;
+
   if (meta_kms_update_get_needs_modeset (update))
     commit_flags |= DRM_MODE_ATOMIC_ALLOW_MODESET;
   else
@@ -1127,12 +1491,29 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
   if (flags & META_KMS_UPDATE_FLAG_TEST_ONLY)
     commit_flags |= DRM_MODE_ATOMIC_TEST_ONLY;
 
+  if (meta_kms_update_is_async_page_flip (update) &&
+      !meta_kms_update_get_needs_modeset (update) &&
+      meta_kms_impl_device_get_caps (impl_device)->atomic_async_page_flip)
+    commit_flags |= DRM_MODE_PAGE_FLIP_ASYNC;
+
   meta_topic (META_DEBUG_KMS,
               "[atomic] Committing update flags: %s",
               commit_flags_string (commit_flags));
 
   fd = meta_kms_impl_device_get_fd (impl_device);
   ret = drmModeAtomicCommit (fd, req, commit_flags, impl_device);
+  if (ret == -EINVAL && (commit_flags & DRM_MODE_PAGE_FLIP_ASYNC))
+    {
+      /* Asynchronous flips can only change the primary plane buffer; if the
+       * update touches anything else, apply it on the next vblank instead.
+       */
+      meta_topic (META_DEBUG_KMS,
+                  "[atomic] Asynchronous page flip rejected, retrying "
+                  "synchronously");
+
+      commit_flags &= ~DRM_MODE_PAGE_FLIP_ASYNC;
+      ret = drmModeAtomicCommit (fd, req, commit_flags, impl_device);
+    }
   if (ret < 0)
     {
       g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (-ret),
@@ -1142,6 +1523,10 @@ meta_kms_impl_device_atomic_process_update (MetaKmsImplDevice *impl_device,
 
   drmModeAtomicFree (req);
 
+  if (!(flags & META_KMS_UPDATE_FLAG_TEST_ONLY))
+    apply_pending_prop_values (impl_device_atomic);
+  g_clear_pointer (&impl_device_atomic->pending_props, g_hash_table_unref);
+
   process_entries (impl_device,
                    update,
                    req,
@@ -1161,6 +1546,7 @@ err:
   if (req)
     drmModeAtomicFree (req);
 
+  g_clear_pointer (&impl_device_atomic->pending_props, g_hash_table_unref);
   release_blob_ids (impl_device, blob_ids);
 
   return meta_kms_feedback_new_failed (failed_planes, error);
@@ -1198,6 +1584,7 @@ meta_kms_impl_device_atomic_disable (MetaKmsImplDevice *impl_device)
   fd = meta_kms_impl_device_get_fd (impl_device);
   ret = drmModeAtomicCommit (fd, req, DRM_MODE_ATOMIC_ALLOW_MODESET, impl_device);
   drmModeAtomicFree (req);
+  reset_cached_state (META_KMS_IMPL_DEVICE_ATOMIC (impl_device));
   if (ret < 0)
     {
       g_set_error (&error, G_IO_ERROR, g_io_error_from_errno (-ret),
@@ -1225,6 +1612,12 @@ meta_kms_impl_device_atomic_discard_pending_page_flips (MetaKmsImplDevice *impl_
 {
 }
 
+static void
+meta_kms_impl_device_atomic_invalidate_cached_state (MetaKmsImplDevice *impl_device)
+{
+  reset_cached_state (META_KMS_IMPL_DEVICE_ATOMIC (impl_device));
+}
+
 static gboolean
 dispose_page_flip_data (gpointer key,
                         gpointer value,
@@ -1259,6 +1652,8 @@ meta_kms_impl_device_atomic_finalize (GObject *object)
   g_assert (g_hash_table_size (impl_device_atomic->page_flip_datas) == 0);
 
   g_hash_table_unref (impl_device_atomic->page_flip_datas);
+  g_hash_table_unref (impl_device_atomic->committed_props);
+  g_hash_table_unref (impl_device_atomic->cached_blobs);
 
   G_OBJECT_CLASS (meta_kms_impl_device_atomic_parent_class)->finalize (object);
 }
@@ -1408,6 +1803,11 @@ static void
 meta_kms_impl_device_atomic_init (MetaKmsImplDeviceAtomic *impl_device_atomic)
 {
   impl_device_atomic->page_flip_datas = g_hash_table_new (NULL, NULL);
+  impl_device_atomic->committed_props =
+    g_hash_table_new_full (prop_value_hash, prop_value_equal, g_free, NULL);
+  impl_device_atomic->cached_blobs =
+    g_hash_table_new_full (g_bytes_hash, g_bytes_equal,
+                           (GDestroyNotify) g_bytes_unref, NULL);
 }
 
 static void
@@ -1441,4 +1841,6 @@ meta_kms_impl_device_atomic_class_init (MetaKmsImplDeviceAtomicClass *klass)
     meta_kms_impl_device_atomic_discard_pending_page_flips;
   impl_device_class->prepare_shutdown =
     meta_kms_impl_device_atomic_prepare_shutdown;
+  impl_device_class->invalidate_cached_state =
+    meta_kms_impl_device_atomic_invalidate_cached_state;
 }
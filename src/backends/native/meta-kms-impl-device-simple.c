@@ -553,6 +553,128 @@ process_crtc_color_updates (MetaKmsImplDevice  *impl_device,
         }
     }
 
+  if (color_update->ctm.has_update)
+    {
+      uint32_t prop_id;
+      uint32_t blob_id = 0;
+      int fd;
+      int ret;
+
+      prop_id = meta_kms_crtc_get_prop_id (crtc, META_KMS_CRTC_PROP_CTM);
+      if (!prop_id)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       "Property (%s) not found on CRTC %u",
+                       meta_kms_crtc_get_prop_name (crtc,
+                                                    META_KMS_CRTC_PROP_CTM),
+                       meta_kms_crtc_get_id (crtc));
+          return FALSE;
+        }
+
+      fd = meta_kms_impl_device_get_fd (impl_device);
+
+      if (!color_update->ctm.is_bypass)
+        {
+          struct drm_color_ctm drm_ctm;
+
+          meta_kms_crtc_color_update_get_drm_ctm (color_update, &drm_ctm);
+          ret = drmModeCreatePropertyBlob (fd, &drm_ctm, sizeof (drm_ctm),
+                                           &blob_id);
+          if (ret < 0)
+            {
+              g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                           "drmModeCreatePropertyBlob: %s", g_strerror (-ret));
+              return FALSE;
+            }
+
+          meta_topic (META_DEBUG_KMS,
+                      "[simple] Setting CRTC %u (%s) color transformation matrix",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+      else
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[simple] Setting CRTC %u (%s) color transformation matrix "
+                      "to bypass",
+                      meta_kms_crtc_get_id (crtc),
+                      meta_kms_impl_device_get_path (impl_device));
+        }
+
+      ret = drmModeObjectSetProperty (fd,
+                                      meta_kms_crtc_get_id (crtc),
+                                      DRM_MODE_OBJECT_CRTC,
+                                      prop_id,
+                                      blob_id);
+
+      /* The CRTC keeps its own reference to the blob */
+      if (blob_id)
+        drmModeDestroyPropertyBlob (fd, blob_id);
+
+      if (ret != 0)
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                       "Failed to set CRTC %u property %u: %s",
+                       meta_kms_crtc_get_id (crtc),
+                       prop_id,
+                       g_strerror (-ret));
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
+static gboolean
+process_crtc_updates (MetaKmsImplDevice  *impl_device,
+                      MetaKmsUpdate      *update,
+                      gpointer            update_entry,
+                      GError            **error)
+{
+  MetaKmsCrtcUpdate *crtc_update = update_entry;
+  MetaKmsCrtc *crtc = crtc_update->crtc;
+
+  if (crtc_update->vrr.has_update)
+    {
+      uint32_t prop_id;
+      int fd;
+      int ret;
+
+      prop_id = meta_kms_crtc_get_prop_id (crtc,
+                                           META_KMS_CRTC_PROP_VRR_ENABLED);
+      if (!prop_id)
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       "Property (%s) not found on CRTC %u",
+                       meta_kms_crtc_get_prop_name (crtc,
+                                                    META_KMS_CRTC_PROP_VRR_ENABLED),
+                       meta_kms_crtc_get_id (crtc));
+          return FALSE;
+        }
+
+      meta_topic (META_DEBUG_KMS,
+                  "[simple] Setting VRR mode on CRTC %u (%s) to %s",
+                  meta_kms_crtc_get_id (crtc),
+                  meta_kms_impl_device_get_path (impl_device),
+                  crtc_update->vrr.is_enabled ? "enabled" : "disabled");
+
+      fd = meta_kms_impl_device_get_fd (impl_device);
+      ret = drmModeObjectSetProperty (fd,
+                                      meta_kms_crtc_get_id (crtc),
+                                      DRM_MODE_OBJECT_CRTC,
+                                      prop_id,
+                                      !!crtc_update->vrr.is_enabled);
+      if (ret != 0)
+        {
+          g_set_error (error, G_IO_ERROR, g_io_error_from_errno (-ret),
+                       "Failed to set CRTC %u property %u: %s",
+                       meta_kms_crtc_get_id (crtc),
+                       prop_id,
+                       g_strerror (-ret));
+          return FALSE;
+        }
+    }
+
   return TRUE;
 }
 
@@ -989,21 +1111,39 @@ dispatch_page_flip (MetaKmsImplDevice    *impl_device,
   else
     {
       uint32_t fb_id;
+      uint32_t page_flip_flags = DRM_MODE_PAGE_FLIP_EVENT;
 
       fb_id = meta_drm_buffer_get_fb_id (plane_assignment->buffer);
 
+      if (meta_kms_update_is_async_page_flip (update) &&
+          meta_kms_impl_device_get_caps (impl_device)->async_page_flip)
+        page_flip_flags |= DRM_MODE_PAGE_FLIP_ASYNC;
+
       meta_topic (META_DEBUG_KMS,
-                  "[simple] Page flipping CRTC %u (%s) with %u, data: %p",
+                  "[simple] Page flipping CRTC %u (%s) with %u%s, data: %p",
                   meta_kms_crtc_get_id (crtc),
                   meta_kms_impl_device_get_path (impl_device),
                   fb_id,
+                  page_flip_flags & DRM_MODE_PAGE_FLIP_ASYNC ? " (async)" : "",
                   page_flip_data);
 
       ret = drmModePageFlip (fd,
                              meta_kms_crtc_get_id (crtc),
                              fb_id,
-                             DRM_MODE_PAGE_FLIP_EVENT,
+                             page_flip_flags,
                              page_flip_data);
+      if (ret == -EINVAL && (page_flip_flags & DRM_MODE_PAGE_FLIP_ASYNC))
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "[simple] Asynchronous page flip rejected, retrying "
+                      "synchronously");
+
+          ret = drmModePageFlip (fd,
+                                 meta_kms_crtc_get_id (crtc),
+                                 fb_id,
+                                 DRM_MODE_PAGE_FLIP_EVENT,
+                                 page_flip_data);
+        }
     }
 
   if (ret == -EBUSY)
@@ -1540,6 +1680,13 @@ meta_kms_impl_device_simple_process_update (MetaKmsImplDevice *impl_device,
                         &error))
     goto err;
 
+  if (!process_entries (impl_device,
+                        update,
+                        meta_kms_update_get_crtc_updates (update),
+                        process_crtc_updates,
+                        &error))
+    goto err;
+
   if (!process_plane_assignments (impl_device, update, &failed_planes, &error))
     goto err;
 
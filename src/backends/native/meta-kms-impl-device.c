@@ -44,6 +44,25 @@
 #include "meta-default-modes.h"
 #include "meta-private-enum-types.h"
 
+#ifndef DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP
+#define DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP 0x15
+#endif
+
+/* A device is considered slow when committing to it blocks the KMS thread
+ * for longer than this, on average. Deadline-timer commits to slow devices
+ * are dispatched after those of other devices that are due at the same time.
+ */
+#define SLOW_COMMIT_THRESHOLD_US 2000
+#define FAST_COMMIT_THRESHOLD_US 1000
+
+/* Updates are only held back until the deadline if at least this much time
+ * is left, otherwise they are committed right away.
+ */
+#define LATE_LATCH_MIN_SLACK_US 1000
+
+#define DEADLINE_SOURCE_PRIORITY (G_PRIORITY_HIGH + 1)
+#define SLOW_DEVICE_DEADLINE_SOURCE_PRIORITY (G_PRIORITY_HIGH + 2)
+
 enum
 {
   PROP_0,
@@ -65,6 +84,7 @@ typedef struct _CrtcDeadline
   MetaKmsUpdate *pending_update;
   gboolean await_flush;
   gboolean pending_page_flip;
+  int64_t commit_time_us;
 
   struct {
     int timer_fd;
@@ -109,6 +129,9 @@ typedef struct _MetaKmsImplDevicePrivate
 
   MetaDeadlineTimerState deadline_timer_state;
 
+  int64_t average_commit_time_us;
+  gboolean is_slow;
+
   gboolean sync_file_retrieved;
   int sync_file;
 } MetaKmsImplDevicePrivate;
@@ -349,6 +372,7 @@ init_caps (MetaKmsImplDevice *impl_device)
   uint64_t prefer_shadow;
   uint64_t uses_monotonic_clock;
   uint64_t addfb2_modifiers;
+  uint64_t async_page_flip;
 
   fd = meta_device_file_get_fd (priv->device_file);
   if (drmGetCap (fd, DRM_CAP_CURSOR_WIDTH, &cursor_width) == 0 &&
@@ -376,6 +400,16 @@ init_caps (MetaKmsImplDevice *impl_device)
     {
       priv->caps.addfb2_modifiers = (addfb2_modifiers != 0);
     }
+
+  if (drmGetCap (fd, DRM_CAP_ASYNC_PAGE_FLIP, &async_page_flip) == 0)
+    {
+      priv->caps.async_page_flip = (async_page_flip != 0);
+    }
+
+  if (drmGetCap (fd, DRM_CAP_ATOMIC_ASYNC_PAGE_FLIP, &async_page_flip) == 0)
+    {
+      priv->caps.atomic_async_page_flip = (async_page_flip != 0);
+    }
 }
 
 static void
@@ -443,7 +477,8 @@ find_existing_connector (MetaKmsImplDevice *impl_device,
 static MetaKmsResourceChanges
 update_connectors (MetaKmsImplDevice *impl_device,
                    drmModeRes        *drm_resources,
-                   uint32_t           updated_connector_id)
+                   uint32_t           updated_connector_id,
+                   gboolean           probe_all)
 {
   MetaKmsImplDevicePrivate *priv =
     meta_kms_impl_device_get_instance_private (impl_device);
@@ -457,19 +492,44 @@ update_connectors (MetaKmsImplDevice *impl_device,
 
   for (i = 0; i < drm_resources->count_connectors; i++)
     {
+      uint32_t connector_id = drm_resources->connectors[i];
       drmModeConnector *drm_connector;
       MetaKmsConnector *connector;
+      gboolean needs_probe;
 
-      drm_connector = drmModeGetConnector (fd, drm_resources->connectors[i]);
+      /* Retrieving the current state doesn't probe the connector, which on
+       * e.g. DP-MST hubs can take a long time; only probe connectors that
+       * are new, were the target of the event, or changed otherwise. */
+      drm_connector = drmModeGetConnectorCurrent (fd, connector_id);
       if (!drm_connector)
         continue;
 
       connector = find_existing_connector (impl_device, drm_connector);
+      if (!connector || probe_all)
+        needs_probe = TRUE;
+      else if (updated_connector_id != 0)
+        needs_probe = connector_id == updated_connector_id;
+      else
+        needs_probe = meta_kms_connector_needs_probe (connector, drm_connector);
+
+      if (needs_probe)
+        {
+          drmModeFreeConnector (drm_connector);
+          drm_connector = drmModeGetConnector (fd, connector_id);
+          if (!drm_connector)
+            continue;
+        }
+      else
+        {
+          meta_topic (META_DEBUG_KMS,
+                      "Skipping probe of unchanged connector %u on %s",
+                      connector_id, priv->path);
+        }
+
       if (connector)
         {
           connector = g_object_ref (connector);
-          if (updated_connector_id == 0 ||
-              meta_kms_connector_get_id (connector) == updated_connector_id)
+          if (needs_probe)
             {
               changes |= meta_kms_connector_update_state_in_impl (connector,
                                                                   drm_resources,
@@ -941,7 +1001,8 @@ clear_latched_fd_hold (MetaKmsImplDevice *impl_device)
 MetaKmsResourceChanges
 meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device,
                                     uint32_t           crtc_id,
-                                    uint32_t           connector_id)
+                                    uint32_t           connector_id,
+                                    gboolean           probe_all)
 {
   MetaKmsImplDevicePrivate *priv =
     meta_kms_impl_device_get_instance_private (impl_device);
@@ -972,7 +1033,8 @@ meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device,
       goto err;
     }
 
-  changes = update_connectors (impl_device, drm_resources, connector_id);
+  changes = update_connectors (impl_device, drm_resources, connector_id,
+                               probe_all);
 
   for (l = priv->crtcs; l; l = l->next)
     {
@@ -1166,19 +1228,27 @@ crtc_page_flip_feedback_flipped (MetaKmsCrtc  *crtc,
                                  gpointer      user_data)
 {
   CrtcFrame *crtc_frame = user_data;
+  struct timeval page_flip_timeval;
+  int64_t presentation_time_us;
+
+  page_flip_timeval = (struct timeval) {
+    .tv_sec = tv_sec,
+    .tv_usec = tv_usec,
+  };
+  presentation_time_us = meta_timeval_to_microseconds (&page_flip_timeval);
+
+  if (crtc_frame->commit_time_us && presentation_time_us)
+    {
+      meta_kms_crtc_record_latency (crtc,
+                                    META_KMS_CRTC_LATENCY_COMMIT_TO_FLIP,
+                                    presentation_time_us -
+                                    crtc_frame->commit_time_us);
+    }
+  crtc_frame->commit_time_us = 0;
 
   if (crtc_frame->deadline.is_deadline_page_flip &&
       meta_is_topic_enabled (META_DEBUG_KMS))
     {
-      struct timeval page_flip_timeval;
-      int64_t presentation_time_us;
-
-      page_flip_timeval = (struct timeval) {
-        .tv_sec = tv_sec,
-        .tv_usec = tv_usec,
-      };
-      presentation_time_us = meta_timeval_to_microseconds (&page_flip_timeval);
-
       meta_topic (META_DEBUG_KMS,
                   "Deadline page flip presentation time: %"G_GINT64_FORMAT" us, "
                   "expected %"G_GINT64_FORMAT" us "
@@ -1218,6 +1288,8 @@ crtc_page_flip_feedback_discarded (MetaKmsCrtc  *crtc,
   CrtcFrame *crtc_frame = user_data;
 
   crtc_frame->pending_page_flip = FALSE;
+  crtc_frame->commit_time_us = 0;
+  meta_kms_crtc_count_discarded_update (crtc);
 }
 
 static const MetaKmsPageFlipListenerVtable crtc_page_flip_listener_vtable = {
@@ -1257,6 +1329,61 @@ queue_result_feedback (MetaKmsImplDevice *impl_device,
     }
 }
 
+static int
+get_deadline_source_priority (MetaKmsImplDevice *impl_device)
+{
+  MetaKmsImplDevicePrivate *priv =
+    meta_kms_impl_device_get_instance_private (impl_device);
+
+  if (priv->is_slow)
+    return SLOW_DEVICE_DEADLINE_SOURCE_PRIORITY;
+  else
+    return DEADLINE_SOURCE_PRIORITY;
+}
+
+static void
+update_commit_time (MetaKmsImplDevice *impl_device,
+                    int64_t            commit_time_us)
+{
+  MetaKmsImplDevicePrivate *priv =
+    meta_kms_impl_device_get_instance_private (impl_device);
+  gboolean is_slow;
+  GHashTableIter iter;
+  CrtcFrame *crtc_frame;
+
+  if (priv->average_commit_time_us == 0)
+    priv->average_commit_time_us = commit_time_us;
+  else
+    priv->average_commit_time_us =
+      (priv->average_commit_time_us * 7 + commit_time_us) / 8;
+
+  if (priv->is_slow)
+    is_slow = priv->average_commit_time_us > FAST_COMMIT_THRESHOLD_US;
+  else
+    is_slow = priv->average_commit_time_us > SLOW_COMMIT_THRESHOLD_US;
+
+  if (is_slow == priv->is_slow)
+    return;
+
+  meta_topic (META_DEBUG_KMS,
+              "Device %s is now considered %s (average commit time %ld us)",
+              priv->path,
+              is_slow ? "slow" : "fast",
+              priv->average_commit_time_us);
+
+  priv->is_slow = is_slow;
+
+  g_hash_table_iter_init (&iter, priv->crtc_frames);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &crtc_frame))
+    {
+      if (crtc_frame->deadline.source)
+        {
+          g_source_set_priority (crtc_frame->deadline.source,
+                                 get_deadline_source_priority (impl_device));
+        }
+    }
+}
+
 static MetaKmsFeedback *
 do_process (MetaKmsImplDevice *impl_device,
             MetaKmsCrtc       *latch_crtc,
@@ -1272,6 +1399,7 @@ do_process (MetaKmsImplDevice *impl_device,
   CrtcFrame *crtc_frame = NULL;
   MetaKmsFeedback *feedback;
   MetaKmsResourceChanges changes = META_KMS_RESOURCE_CHANGE_NONE;
+  int64_t commit_start_us;
 
   COGL_TRACE_BEGIN_SCOPED (MetaKmsImplDeviceProcess,
                            "Meta::KmsImplDevice::do_process()");
@@ -1303,6 +1431,7 @@ do_process (MetaKmsImplDevice *impl_device,
           crtc_frame = get_crtc_frame (impl_device, latch_crtc);
           if (crtc_frame && crtc_frame->pending_update)
             {
+              meta_kms_crtc_count_merged_update (latch_crtc);
               meta_kms_update_merge_from (crtc_frame->pending_update, update);
               meta_kms_update_free (update);
               update = g_steal_pointer (&crtc_frame->pending_update);
@@ -1323,11 +1452,37 @@ do_process (MetaKmsImplDevice *impl_device,
         }
     }
 
+  commit_start_us = g_get_monotonic_time ();
+
+  if (crtc_frame && meta_kms_update_get_post_time (update))
+    {
+      meta_kms_crtc_record_latency (crtc_frame->crtc,
+                                    META_KMS_CRTC_LATENCY_POST_TO_COMMIT,
+                                    commit_start_us -
+                                    meta_kms_update_get_post_time (update));
+    }
+
   feedback = klass->process_update (impl_device, update, flags);
 
-  if (meta_kms_feedback_get_result (feedback) != META_KMS_FEEDBACK_PASSED &&
-      crtc_frame)
-    crtc_frame->pending_page_flip = FALSE;
+  if (crtc_frame)
+    {
+      meta_kms_crtc_record_latency (crtc_frame->crtc,
+                                    META_KMS_CRTC_LATENCY_COMMIT_DURATION,
+                                    g_get_monotonic_time () - commit_start_us);
+    }
+
+  /* Mode sets are expected to block, only track time spent on page flips */
+  if (!(flags & META_KMS_UPDATE_FLAG_TEST_ONLY) &&
+      !(flags & META_KMS_UPDATE_FLAG_MODE_SET))
+    update_commit_time (impl_device, g_get_monotonic_time () - commit_start_us);
+
+  if (crtc_frame)
+    {
+      if (meta_kms_feedback_get_result (feedback) == META_KMS_FEEDBACK_PASSED)
+        crtc_frame->commit_time_us = commit_start_us;
+      else
+        crtc_frame->pending_page_flip = FALSE;
+    }
 
   if (!(flags & META_KMS_UPDATE_FLAG_TEST_ONLY))
     changes = meta_kms_impl_device_predict_states (impl_device, update);
@@ -1374,6 +1529,11 @@ crtc_frame_deadline_dispatch (MetaThreadImpl  *thread_impl,
       return GINT_TO_POINTER (FALSE);
     }
 
+  meta_kms_crtc_record_latency (crtc_frame->crtc,
+                                META_KMS_CRTC_LATENCY_DEADLINE_SLACK,
+                                crtc_frame->deadline.expected_presentation_time_us -
+                                g_get_monotonic_time ());
+
   feedback = do_process (impl_device,
                          crtc_frame->crtc,
                          g_steal_pointer (&crtc_frame->pending_update),
@@ -1459,7 +1619,8 @@ ensure_crtc_frame (MetaKmsImplDevice *impl_device,
                               meta_kms_crtc_get_id (latch_crtc),
                               priv->path);
       g_source_set_name (source, name);
-      g_source_set_priority (source, G_PRIORITY_HIGH + 1);
+      g_source_set_priority (source,
+                             get_deadline_source_priority (impl_device));
       g_source_set_can_recurse (source, FALSE);
       g_source_set_ready_time (source, -1);
 
@@ -1483,6 +1644,7 @@ queue_update (MetaKmsImplDevice *impl_device,
 
   if (crtc_frame->pending_update)
     {
+      meta_kms_crtc_count_merged_update (crtc_frame->crtc);
       meta_kms_update_merge_from (crtc_frame->pending_update, update);
       meta_kms_update_free (update);
     }
@@ -1492,6 +1654,58 @@ queue_update (MetaKmsImplDevice *impl_device,
     }
 }
 
+static gboolean
+maybe_late_latch_update (MetaKmsImplDevice *impl_device,
+                         CrtcFrame         *crtc_frame,
+                         MetaKmsUpdate     *update,
+                         MetaKmsUpdateFlag  flags)
+{
+  MetaKmsImplDevicePrivate *priv =
+    meta_kms_impl_device_get_instance_private (impl_device);
+  const MetaKmsCrtcState *crtc_state;
+  int64_t next_deadline_us;
+  int64_t next_presentation_us;
+
+  if (flags != META_KMS_UPDATE_FLAG_NONE)
+    return FALSE;
+
+  if (!is_using_deadline_timer (impl_device))
+    return FALSE;
+
+  if (meta_kms_update_get_mode_sets (update) ||
+      meta_kms_update_is_async_page_flip (update))
+    return FALSE;
+
+  /* With VRR, committing earlier means presenting earlier */
+  crtc_state = meta_kms_crtc_get_current_state (crtc_frame->crtc);
+  if (crtc_state->vrr.enabled)
+    return FALSE;
+
+  if (!crtc_frame->deadline.armed)
+    {
+      if (!meta_kms_crtc_determine_deadline (crtc_frame->crtc,
+                                             &next_deadline_us,
+                                             &next_presentation_us,
+                                             NULL))
+        return FALSE;
+
+      if (next_deadline_us - g_get_monotonic_time () < LATE_LATCH_MIN_SLACK_US)
+        return FALSE;
+
+      arm_crtc_frame_deadline_timer (crtc_frame,
+                                     next_deadline_us,
+                                     next_presentation_us);
+    }
+
+  meta_topic (META_DEBUG_KMS,
+              "Latching update on CRTC %u (%s) at deadline",
+              meta_kms_crtc_get_id (crtc_frame->crtc),
+              priv->path);
+
+  queue_update (impl_device, crtc_frame, update);
+  return TRUE;
+}
+
 void
 meta_kms_impl_device_handle_update (MetaKmsImplDevice *impl_device,
                                     MetaKmsUpdate     *update,
@@ -1543,16 +1757,24 @@ meta_kms_impl_device_handle_update (MetaKmsImplDevice *impl_device,
       return;
     }
 
+  meta_kms_device_handle_flush (priv->device, latch_crtc);
+
+  /* Hold the update back until the deadline, so that cursor, overlay plane
+   * and scanout updates posted in the mean time make it into the same
+   * commit.
+   */
+  if (maybe_late_latch_update (impl_device, crtc_frame, update, flags))
+    return;
+
   if (crtc_frame->pending_update)
     {
+      meta_kms_crtc_count_merged_update (latch_crtc);
       meta_kms_update_merge_from (crtc_frame->pending_update, update);
       meta_kms_update_free (update);
       update = g_steal_pointer (&crtc_frame->pending_update);
       disarm_crtc_frame_deadline_timer (crtc_frame);
     }
 
-  meta_kms_device_handle_flush (priv->device, latch_crtc);
-
   feedback = do_process (impl_device, latch_crtc, update, flags);
   meta_kms_feedback_unref (feedback);
   return;
@@ -1688,6 +1910,9 @@ process_mode_set_update (MetaKmsImplDevice *impl_device,
       crtc_frame->deadline.is_deadline_page_flip = FALSE;
       crtc_frame->await_flush = FALSE;
       crtc_frame->pending_page_flip = FALSE;
+      crtc_frame->commit_time_us = 0;
+      if (crtc_frame->pending_update)
+        meta_kms_crtc_count_discarded_update (crtc_frame->crtc);
       g_clear_pointer (&crtc_frame->pending_update, meta_kms_update_free);
       disarm_crtc_frame_deadline_timer (crtc_frame);
     }
@@ -1803,6 +2028,15 @@ clear_fd_source (MetaKmsImplDevice *impl_device)
   g_clear_pointer (&priv->fd_source, g_source_unref);
 }
 
+static void
+invalidate_cached_state (MetaKmsImplDevice *impl_device)
+{
+  MetaKmsImplDeviceClass *klass = META_KMS_IMPL_DEVICE_GET_CLASS (impl_device);
+
+  if (klass->invalidate_cached_state)
+    klass->invalidate_cached_state (impl_device);
+}
+
 void
 meta_kms_impl_device_unhold_fd (MetaKmsImplDevice *impl_device)
 {
@@ -1817,6 +2051,7 @@ meta_kms_impl_device_unhold_fd (MetaKmsImplDevice *impl_device)
   priv->fd_hold_count--;
   if (priv->fd_hold_count == 0)
     {
+      invalidate_cached_state (impl_device);
       g_clear_pointer (&priv->device_file, meta_device_file_release);
       clear_fd_source (impl_device);
     }
@@ -1933,7 +2168,7 @@ meta_kms_impl_device_init_mode_setting (MetaKmsImplDevice  *impl_device,
 
   init_fallback_modes (impl_device);
 
-  update_connectors (impl_device, drm_resources, 0);
+  update_connectors (impl_device, drm_resources, 0, TRUE);
 
   drmModeFreeResources (drm_resources);
 
@@ -1948,6 +2183,10 @@ meta_kms_impl_device_resume (MetaKmsImplDevice *impl_device)
 
   if (priv->deadline_timer_state == META_DEADLINE_TIMER_STATE_INHIBITED)
     priv->deadline_timer_state = META_DEADLINE_TIMER_STATE_ENABLED;
+
+  /* Someone else may have changed the KMS state while we were away */
+  if (priv->device_file)
+    invalidate_cached_state (impl_device);
 }
 
 void
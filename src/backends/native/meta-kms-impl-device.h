@@ -38,6 +38,8 @@ typedef struct _MetaKmsDeviceCaps
   gboolean prefers_shadow_buffer;
   gboolean uses_monotonic_clock;
   gboolean addfb2_modifiers;
+  gboolean async_page_flip;
+  gboolean atomic_async_page_flip;
 } MetaKmsDeviceCaps;
 
 
@@ -95,6 +97,7 @@ struct _MetaKmsImplDeviceClass
                                       MetaKmsPageFlipData *page_flip_data);
   void (* discard_pending_page_flips) (MetaKmsImplDevice *impl_device);
   void (* prepare_shutdown) (MetaKmsImplDevice *impl_device);
+  void (* invalidate_cached_state) (MetaKmsImplDevice *impl_device);
 };
 
 enum
@@ -149,7 +152,8 @@ int meta_kms_impl_device_get_signaled_sync_file (MetaKmsImplDevice *impl_device)
 
 MetaKmsResourceChanges meta_kms_impl_device_update_states (MetaKmsImplDevice *impl_device,
                                                            uint32_t           crtc_id,
-                                                           uint32_t           connector_id);
+                                                           uint32_t           connector_id,
+                                                           gboolean           probe_all);
 
 void meta_kms_impl_device_notify_modes_set (MetaKmsImplDevice *impl_device);
 
@@ -35,8 +35,24 @@ typedef struct _MetaKmsCrtcColorUpdate
     gboolean has_update;
     MetaGammaLut *state;
   } gamma;
+
+  struct {
+    gboolean has_update;
+    gboolean is_bypass;
+    float matrix[9];
+  } ctm;
 } MetaKmsCrtcColorUpdate;
 
+typedef struct _MetaKmsCrtcUpdate
+{
+  MetaKmsCrtc *crtc;
+
+  struct {
+    gboolean has_update;
+    gboolean is_enabled;
+  } vrr;
+} MetaKmsCrtcUpdate;
+
 typedef struct _MetaKmsFeedback
 {
   gatomicrefcount ref_count;
@@ -64,6 +80,7 @@ typedef struct _MetaKmsPlaneAssignment
   MetaKmsAssignPlaneFlag flags;
   MetaKmsFbDamage *fb_damage;
   MetaKmsPlaneRotation rotation;
+  int in_fence_fd;
 
   struct {
     gboolean has_update;
@@ -185,6 +202,13 @@ GList * meta_kms_update_get_connector_updates (MetaKmsUpdate *update);
 META_EXPORT_TEST
 GList * meta_kms_update_get_crtc_color_updates (MetaKmsUpdate *update);
 
+META_EXPORT_TEST
+void meta_kms_crtc_color_update_get_drm_ctm (MetaKmsCrtcColorUpdate *color_update,
+                                             struct drm_color_ctm   *drm_ctm);
+
+META_EXPORT_TEST
+GList * meta_kms_update_get_crtc_updates (MetaKmsUpdate *update);
+
 MetaKmsCustomPageFlip * meta_kms_update_take_custom_page_flip_func (MetaKmsUpdate *update);
 
 META_EXPORT_TEST
@@ -206,6 +230,13 @@ void meta_kms_update_realize (MetaKmsUpdate     *update,
 
 gboolean meta_kms_update_get_needs_modeset (MetaKmsUpdate *update);
 
+gboolean meta_kms_update_is_async_page_flip (MetaKmsUpdate *update);
+
+void meta_kms_update_set_post_time (MetaKmsUpdate *update,
+                                    int64_t        post_time_us);
+
+int64_t meta_kms_update_get_post_time (MetaKmsUpdate *update);
+
 MetaKmsCrtc * meta_kms_update_get_latch_crtc (MetaKmsUpdate *update);
 
 void meta_kms_page_flip_listener_unref (MetaKmsPageFlipListener *listener);
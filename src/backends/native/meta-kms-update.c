@@ -20,6 +20,10 @@
 #include "backends/native/meta-kms-update.h"
 #include "backends/native/meta-kms-update-private.h"
 
+#include <glib/gstdio.h>
+#include <math.h>
+#include <string.h>
+
 #include "backends/meta-display-config-shared.h"
 #include "backends/native/meta-kms-connector.h"
 #include "backends/native/meta-kms-crtc.h"
@@ -41,6 +45,7 @@ struct _MetaKmsUpdate
   GList *plane_assignments;
   GList *connector_updates;
   GList *crtc_color_updates;
+  GList *crtc_updates;
 
   MetaKmsCustomPageFlip *custom_page_flip;
 
@@ -48,6 +53,9 @@ struct _MetaKmsUpdate
   GList *result_listeners;
 
   gboolean needs_modeset;
+  gboolean is_async_page_flip;
+
+  int64_t post_time_us;
 
   MetaKmsImplDevice *impl_device;
 };
@@ -190,6 +198,7 @@ static void
 meta_kms_plane_assignment_free (MetaKmsPlaneAssignment *plane_assignment)
 {
   g_clear_pointer (&plane_assignment->fb_damage, meta_kms_fb_damage_free);
+  g_clear_fd (&plane_assignment->in_fence_fd, NULL);
   g_free (plane_assignment);
 }
 
@@ -296,6 +305,7 @@ meta_kms_update_assign_plane (MetaKmsUpdate          *update,
     .src_rect = src_rect,
     .dst_rect = dst_rect,
     .flags = flags,
+    .in_fence_fd = -1,
   };
 
   update->plane_assignments = g_list_prepend (update->plane_assignments,
@@ -324,6 +334,7 @@ meta_kms_update_unassign_plane (MetaKmsUpdate *update,
     .crtc = crtc,
     .plane = plane,
     .buffer = NULL,
+    .in_fence_fd = -1,
   };
 
   update->plane_assignments = g_list_prepend (update->plane_assignments,
@@ -523,12 +534,96 @@ meta_kms_update_set_crtc_gamma (MetaKmsUpdate      *update,
     gamma_update = meta_gamma_lut_copy_to_size (gamma, crtc_state->gamma.size);
 
   color_update = ensure_color_update (update, crtc);
+  if (color_update->gamma.has_update)
+    g_clear_pointer (&color_update->gamma.state, meta_gamma_lut_free);
   color_update->gamma.state = gamma_update;
   color_update->gamma.has_update = TRUE;
 
   update_latch_crtc (update, crtc);
 }
 
+/*
+ * Sets the row-major 3x3 color transformation matrix the CRTC applies
+ * between its degamma and gamma stages, e.g. to convert between color
+ * gamuts on the display hardware rather than when painting. Passing NULL
+ * sets it to bypass.
+ */
+void
+meta_kms_update_set_crtc_ctm (MetaKmsUpdate *update,
+                              MetaKmsCrtc   *crtc,
+                              const float   *matrix)
+{
+  MetaKmsCrtcColorUpdate *color_update;
+
+  g_assert (meta_kms_crtc_get_device (crtc) == update->device);
+  g_return_if_fail (meta_kms_crtc_is_ctm_supported (crtc));
+
+  color_update = ensure_color_update (update, crtc);
+  color_update->ctm.has_update = TRUE;
+  color_update->ctm.is_bypass = matrix == NULL;
+  if (matrix)
+    memcpy (color_update->ctm.matrix, matrix, sizeof (color_update->ctm.matrix));
+
+  update_latch_crtc (update, crtc);
+}
+
+static MetaKmsCrtcUpdate *
+ensure_crtc_update (MetaKmsUpdate *update,
+                    MetaKmsCrtc   *crtc)
+{
+  GList *l;
+  MetaKmsCrtcUpdate *crtc_update;
+
+  for (l = update->crtc_updates; l; l = l->next)
+    {
+      crtc_update = l->data;
+
+      if (crtc_update->crtc == crtc)
+        return crtc_update;
+    }
+
+  crtc_update = g_new0 (MetaKmsCrtcUpdate, 1);
+  crtc_update->crtc = crtc;
+
+  update->crtc_updates = g_list_prepend (update->crtc_updates, crtc_update);
+
+  return crtc_update;
+}
+
+void
+meta_kms_crtc_color_update_get_drm_ctm (MetaKmsCrtcColorUpdate *color_update,
+                                        struct drm_color_ctm   *drm_ctm)
+{
+  int i;
+
+  /* The coefficients are in sign-magnitude S31.32 fixed point */
+  for (i = 0; i < G_N_ELEMENTS (drm_ctm->matrix); i++)
+    {
+      double value = color_update->ctm.matrix[i];
+
+      drm_ctm->matrix[i] = (uint64_t) (fabs (value) * (1ull << 32));
+      if (value < 0.0)
+        drm_ctm->matrix[i] |= 1ull << 63;
+    }
+}
+
+void
+meta_kms_update_set_vrr (MetaKmsUpdate *update,
+                         MetaKmsCrtc   *crtc,
+                         gboolean       enabled)
+{
+  MetaKmsCrtcUpdate *crtc_update;
+
+  g_assert (meta_kms_crtc_get_device (crtc) == update->device);
+  g_return_if_fail (meta_kms_crtc_is_vrr_supported (crtc));
+
+  crtc_update = ensure_crtc_update (update, crtc);
+  crtc_update->vrr.has_update = TRUE;
+  crtc_update->vrr.is_enabled = enabled;
+
+  update_latch_crtc (update, crtc);
+}
+
 static void
 meta_kms_crtc_color_updates_free (MetaKmsCrtcColorUpdate *color_update)
 {
@@ -616,6 +711,14 @@ meta_kms_plane_assignment_set_rotation (MetaKmsPlaneAssignment *plane_assignment
   plane_assignment->rotation = rotation;
 }
 
+void
+meta_kms_plane_assignment_set_in_fence_fd (MetaKmsPlaneAssignment *plane_assignment,
+                                           int                     fd)
+{
+  g_clear_fd (&plane_assignment->in_fence_fd, NULL);
+  plane_assignment->in_fence_fd = fd;
+}
+
 void
 meta_kms_plane_assignment_set_cursor_hotspot (MetaKmsPlaneAssignment *plane_assignment,
                                               int                     x,
@@ -755,6 +858,12 @@ meta_kms_update_get_crtc_color_updates (MetaKmsUpdate *update)
   return update->crtc_color_updates;
 }
 
+GList *
+meta_kms_update_get_crtc_updates (MetaKmsUpdate *update)
+{
+  return update->crtc_updates;
+}
+
 MetaKmsDevice *
 meta_kms_update_get_device (MetaKmsUpdate *update)
 {
@@ -908,7 +1017,20 @@ merge_crtc_color_updates_from (MetaKmsUpdate *update,
       el = find_color_update_link_for (update, crtc);
       if (el)
         {
-          meta_kms_crtc_color_updates_free (el->data);
+          MetaKmsCrtcColorUpdate *crtc_color_update = el->data;
+
+          /* Properties only set by the earlier update must be kept */
+          if (!other_crtc_color_update->ctm.has_update)
+            other_crtc_color_update->ctm = crtc_color_update->ctm;
+
+          if (!other_crtc_color_update->gamma.has_update)
+            {
+              other_crtc_color_update->gamma = crtc_color_update->gamma;
+              crtc_color_update->gamma.has_update = FALSE;
+              crtc_color_update->gamma.state = NULL;
+            }
+
+          meta_kms_crtc_color_updates_free (crtc_color_update);
           update->crtc_color_updates =
             g_list_insert_before_link (update->crtc_color_updates, el, l);
           update->crtc_color_updates =
@@ -924,6 +1046,56 @@ merge_crtc_color_updates_from (MetaKmsUpdate *update,
     }
 }
 
+static GList *
+find_crtc_update_link_for (MetaKmsUpdate *update,
+                           MetaKmsCrtc   *crtc)
+{
+  GList *l;
+
+  for (l = update->crtc_updates; l; l = l->next)
+    {
+      MetaKmsCrtcUpdate *crtc_update = l->data;
+
+      if (crtc_update->crtc == crtc)
+        return l;
+    }
+
+  return NULL;
+}
+
+static void
+merge_crtc_updates_from (MetaKmsUpdate *update,
+                         MetaKmsUpdate *other_update)
+{
+  while (other_update->crtc_updates)
+    {
+      GList *l = other_update->crtc_updates;
+      MetaKmsCrtcUpdate *other_crtc_update = l->data;
+      MetaKmsCrtc *crtc = other_crtc_update->crtc;
+      GList *el;
+
+      other_update->crtc_updates =
+        g_list_remove_link (other_update->crtc_updates, l);
+      el = find_crtc_update_link_for (update, crtc);
+      if (el)
+        {
+          MetaKmsCrtcUpdate *crtc_update = el->data;
+
+          if (other_crtc_update->vrr.has_update)
+            crtc_update->vrr = other_crtc_update->vrr;
+
+          g_list_free_full (l, g_free);
+        }
+      else
+        {
+          update->crtc_updates =
+            g_list_insert_before_link (update->crtc_updates,
+                                       update->crtc_updates,
+                                       l);
+        }
+    }
+}
+
 static GList *
 find_connector_update_link_for (MetaKmsUpdate    *update,
                                 MetaKmsConnector *connector)
@@ -1038,10 +1210,38 @@ meta_kms_update_merge_from (MetaKmsUpdate *update,
   merge_mode_sets (update, other_update);
   merge_plane_assignments_from (update, other_update);
   merge_crtc_color_updates_from (update, other_update);
+  merge_crtc_updates_from (update, other_update);
   merge_connector_updates_from (update, other_update);
   merge_custom_page_flip_from (update, other_update);
   merge_page_flip_listeners_from (update, other_update);
   merge_result_listeners_from (update, other_update);
+
+  if (other_update->is_async_page_flip)
+    update->is_async_page_flip = TRUE;
+
+  if (other_update->needs_modeset)
+    update->needs_modeset = TRUE;
+
+  if (other_update->post_time_us &&
+      (!update->post_time_us ||
+       other_update->post_time_us < update->post_time_us))
+    update->post_time_us = other_update->post_time_us;
+}
+
+/**
+ * meta_kms_update_set_needs_modeset:
+ * @update: A #MetaKmsUpdate
+ *
+ * Allows the update to cause a full mode set even though it doesn't set any
+ * CRTC mode, e.g. when connector properties are changed on a CRTC whose mode
+ * was adopted as is.
+ */
+void
+meta_kms_update_set_needs_modeset (MetaKmsUpdate *update)
+{
+  g_assert (!update->is_sealed);
+
+  update->needs_modeset = TRUE;
 }
 
 gboolean
@@ -1050,6 +1250,43 @@ meta_kms_update_get_needs_modeset (MetaKmsUpdate *update)
   return update->needs_modeset || update->mode_sets;
 }
 
+/**
+ * meta_kms_update_set_async_page_flip:
+ * @update: A #MetaKmsUpdate
+ * @async_page_flip: Whether to flip without waiting for the vblank
+ *
+ * Asks for the update to be applied immediately, which may cause tearing.
+ * Drivers only support this for updates that change nothing but the buffer
+ * on the primary plane; other updates fall back to a regular page flip.
+ */
+void
+meta_kms_update_set_async_page_flip (MetaKmsUpdate *update,
+                                     gboolean       async_page_flip)
+{
+  g_assert (!update->is_sealed);
+
+  update->is_async_page_flip = async_page_flip;
+}
+
+gboolean
+meta_kms_update_is_async_page_flip (MetaKmsUpdate *update)
+{
+  return update->is_async_page_flip;
+}
+
+void
+meta_kms_update_set_post_time (MetaKmsUpdate *update,
+                               int64_t        post_time_us)
+{
+  update->post_time_us = post_time_us;
+}
+
+int64_t
+meta_kms_update_get_post_time (MetaKmsUpdate *update)
+{
+  return update->post_time_us;
+}
+
 MetaKmsUpdate *
 meta_kms_update_new (MetaKmsDevice *device)
 {
@@ -1079,6 +1316,7 @@ meta_kms_update_free (MetaKmsUpdate *update)
   g_list_free_full (update->connector_updates, g_free);
   g_list_free_full (update->crtc_color_updates,
                     (GDestroyNotify) meta_kms_crtc_color_updates_free);
+  g_list_free_full (update->crtc_updates, g_free);
   g_clear_pointer (&update->custom_page_flip, meta_kms_custom_page_flip_free);
 
   g_free (update);
@@ -1111,5 +1349,6 @@ meta_kms_update_is_empty (MetaKmsUpdate *update)
   return (!update->mode_sets &&
           !update->plane_assignments &&
           !update->connector_updates &&
-          !update->crtc_color_updates);
+          !update->crtc_color_updates &&
+          !update->crtc_updates);
 }
@@ -104,6 +104,11 @@ void meta_kms_update_free (MetaKmsUpdate *update);
 void meta_kms_update_set_flushing (MetaKmsUpdate *update,
                                    MetaKmsCrtc   *crtc);
 
+void meta_kms_update_set_async_page_flip (MetaKmsUpdate *update,
+                                          gboolean       async_page_flip);
+
+void meta_kms_update_set_needs_modeset (MetaKmsUpdate *update);
+
 META_EXPORT_TEST
 MetaKmsDevice * meta_kms_update_get_device (MetaKmsUpdate *update);
 
@@ -152,6 +157,16 @@ void meta_kms_update_set_crtc_gamma (MetaKmsUpdate      *update,
                                      MetaKmsCrtc        *crtc,
                                      const MetaGammaLut *gamma);
 
+META_EXPORT_TEST
+void meta_kms_update_set_crtc_ctm (MetaKmsUpdate *update,
+                                   MetaKmsCrtc   *crtc,
+                                   const float   *matrix);
+
+META_EXPORT_TEST
+void meta_kms_update_set_vrr (MetaKmsUpdate *update,
+                              MetaKmsCrtc   *crtc,
+                              gboolean       enabled);
+
 void meta_kms_plane_assignment_set_fb_damage (MetaKmsPlaneAssignment *plane_assignment,
                                               const int              *rectangles,
                                               int                     n_rectangles);
@@ -181,6 +196,9 @@ void meta_kms_update_set_custom_page_flip (MetaKmsUpdate             *update,
                                            MetaKmsCustomPageFlipFunc  func,
                                            gpointer                   user_data);
 
+void meta_kms_plane_assignment_set_in_fence_fd (MetaKmsPlaneAssignment *plane_assignment,
+                                                int                     fd);
+
 META_EXPORT_TEST
 void meta_kms_plane_assignment_set_cursor_hotspot (MetaKmsPlaneAssignment *plane_assignment,
                                                    int                     x,
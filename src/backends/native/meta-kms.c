@@ -182,6 +182,7 @@ typedef struct _UpdateStatesData
   const char *device_path;
   uint32_t crtc_id;
   uint32_t connector_id;
+  gboolean probe_all;
 } UpdateStatesData;
 
 static MetaKmsResourceChanges
@@ -220,7 +221,8 @@ meta_kms_update_states_in_impl (MetaKms          *kms,
       changes |=
         meta_kms_device_update_states_in_impl (kms_device,
                                                update_data->crtc_id,
-                                               update_data->connector_id);
+                                               update_data->connector_id,
+                                               update_data->probe_all);
     }
 
   return changes;
@@ -255,6 +257,12 @@ meta_kms_update_states_sync (MetaKms     *kms,
         CLAMP (g_udev_device_get_property_as_int (udev_device, "CONNECTOR"),
                0, UINT32_MAX);
     }
+  else
+    {
+      /* Without a uevent, e.g. when resuming, anything might have changed
+       * without the kernel having noticed yet */
+      data.probe_all = TRUE;
+    }
 
   ret = meta_kms_run_impl_task_sync (kms, update_states_in_impl, &data, NULL);
 
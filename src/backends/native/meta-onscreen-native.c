@@ -30,8 +30,11 @@
 #include "backends/native/meta-onscreen-native.h"
 
 #include <drm_fourcc.h>
+#include <glib/gstdio.h>
+#include <string.h>
 
 #include "backends/meta-egl-ext.h"
+#include "backends/meta-renderer-view.h"
 #include "backends/native/meta-crtc-kms.h"
 #include "backends/native/meta-device-pool.h"
 #include "backends/native/meta-drm-buffer-dumb.h"
@@ -40,6 +43,7 @@
 #include "backends/native/meta-drm-buffer.h"
 #include "backends/native/meta-frame-native.h"
 #include "backends/native/meta-kms-connector.h"
+#include "backends/native/meta-kms-crtc.h"
 #include "backends/native/meta-kms-device.h"
 #include "backends/native/meta-kms-plane.h"
 #include "backends/native/meta-kms-utils.h"
@@ -62,6 +66,48 @@ typedef enum _MetaSharedFramebufferImportStatus
   META_SHARED_FRAMEBUFFER_IMPORT_STATUS_OK
 } MetaSharedFramebufferImportStatus;
 
+/* How the frames of an onscreen on a secondary GPU get to its display */
+typedef enum _MetaSharedFramebufferPath
+{
+  META_SHARED_FRAMEBUFFER_PATH_NONE,
+  META_SHARED_FRAMEBUFFER_PATH_ZERO_COPY,
+  META_SHARED_FRAMEBUFFER_PATH_SECONDARY_GPU_COPY,
+  META_SHARED_FRAMEBUFFER_PATH_PRIMARY_GPU_COPY,
+  META_SHARED_FRAMEBUFFER_PATH_CPU_COPY,
+} MetaSharedFramebufferPath;
+
+/* How long the result of a plane TEST_ONLY commit is reused before the
+ * kernel is asked again, since e.g. bandwidth limitations may change */
+#define PLANE_TEST_RESULT_TIMEOUT_US (G_USEC_PER_SEC * 5)
+#define MAX_PLANE_TEST_RESULTS 64
+
+typedef struct _PlaneTestKey
+{
+  uint32_t plane_id;
+  uint32_t format;
+  uint64_t modifier;
+  int width;
+  int height;
+  MetaFixed16Rectangle src_rect;
+  MtkRectangle dst_rect;
+  MetaMonitorTransform transform;
+
+  /* Buffer on the primary plane when testing an overlay plane */
+  uint32_t primary_format;
+  uint64_t primary_modifier;
+  int primary_width;
+  int primary_height;
+} PlaneTestKey;
+
+typedef struct _PlaneTestResult
+{
+  PlaneTestKey key;
+  gboolean passed;
+  int64_t time_us;
+} PlaneTestResult;
+
+#define SECONDARY_GPU_DAMAGE_HISTORY_LENGTH 4
+
 typedef struct _MetaOnscreenNativeSecondaryGpuState
 {
   MetaGpuKms *gpu_kms;
@@ -76,11 +122,26 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
   struct {
     MetaDrmBufferDumb *current_dumb_fb;
     MetaDrmBufferDumb *dumb_fbs[2];
+
+    /* What changed since each dumb buffer was last copied into, or NULL
+     * if its content is unknown. */
+    MtkRegion *dumb_fb_damage[2];
   } cpu;
 
   gboolean noted_primary_gpu_copy_ok;
   gboolean noted_primary_gpu_copy_failed;
   MetaSharedFramebufferImportStatus import_status;
+
+  /* Whether the primary GPU renders with a modifier the secondary GPU can
+   * scan out, so that importing may be tried before copying. */
+  gboolean has_shared_modifiers;
+
+  MetaSharedFramebufferPath prepared_path;
+  MetaSharedFramebufferPath reported_path;
+
+  /* Damage of the most recent copies on the secondary GPU, newest first.
+   * A NULL entry means the whole buffer changed. */
+  MtkRegion *damage_history[SECONDARY_GPU_DAMAGE_HISTORY_LENGTH];
 } MetaOnscreenNativeSecondaryGpuState;
 
 struct _MetaOnscreenNative
@@ -100,8 +161,24 @@ struct _MetaOnscreenNative
     MetaDrmBuffer *next_fb;
     CoglScanout *current_scanout;
     CoglScanout *next_scanout;
+    CoglScanout *current_overlay_scanout;
+    CoglScanout *next_overlay_scanout;
+    int next_sync_fd;
+
+    /* Buffers of a posted frame that is still waiting for its page flip
+     * while 'next' already holds the frame queued after it. */
+    MetaDrmBuffer *posted_fb;
+    CoglScanout *posted_scanout;
+    CoglScanout *posted_overlay_scanout;
   } gbm;
 
+  /* Scanout to place on the overlay plane of the CRTC with the next
+   * composited frame, as selected by the compositor */
+  CoglScanout *overlay_scanout;
+
+  /* Recent TEST_ONLY commit results, PlaneTestKey -> PlaneTestResult */
+  GHashTable *plane_test_results;
+
 #ifdef HAVE_EGL_DEVICE
   struct {
     EGLStreamKHR stream;
@@ -140,6 +217,17 @@ free_current_bo (CoglOnscreen *onscreen)
 
   g_clear_object (&onscreen_native->gbm.current_fb);
   g_clear_object (&onscreen_native->gbm.current_scanout);
+  g_clear_object (&onscreen_native->gbm.current_overlay_scanout);
+}
+
+static void
+free_posted_bo (CoglOnscreen *onscreen)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+
+  g_clear_object (&onscreen_native->gbm.posted_fb);
+  g_clear_object (&onscreen_native->gbm.posted_scanout);
+  g_clear_object (&onscreen_native->gbm.posted_overlay_scanout);
 }
 
 static void
@@ -147,6 +235,19 @@ meta_onscreen_native_swap_drm_fb (CoglOnscreen *onscreen)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
 
+  if (onscreen_native->gbm.posted_fb)
+    {
+      free_current_bo (onscreen);
+
+      onscreen_native->gbm.current_fb =
+        g_steal_pointer (&onscreen_native->gbm.posted_fb);
+      onscreen_native->gbm.current_scanout =
+        g_steal_pointer (&onscreen_native->gbm.posted_scanout);
+      onscreen_native->gbm.current_overlay_scanout =
+        g_steal_pointer (&onscreen_native->gbm.posted_overlay_scanout);
+      return;
+    }
+
   if (!onscreen_native->gbm.next_fb)
     return;
 
@@ -157,6 +258,9 @@ meta_onscreen_native_swap_drm_fb (CoglOnscreen *onscreen)
   g_set_object (&onscreen_native->gbm.current_scanout,
                 onscreen_native->gbm.next_scanout);
   g_clear_object (&onscreen_native->gbm.next_scanout);
+  g_set_object (&onscreen_native->gbm.current_overlay_scanout,
+                onscreen_native->gbm.next_overlay_scanout);
+  g_clear_object (&onscreen_native->gbm.next_overlay_scanout);
 }
 
 static void
@@ -164,8 +268,41 @@ meta_onscreen_native_clear_next_fb (CoglOnscreen *onscreen)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
 
+  if (onscreen_native->gbm.posted_fb)
+    {
+      free_posted_bo (onscreen);
+      return;
+    }
+
   g_clear_object (&onscreen_native->gbm.next_fb);
   g_clear_object (&onscreen_native->gbm.next_scanout);
+  g_clear_object (&onscreen_native->gbm.next_overlay_scanout);
+  g_clear_fd (&onscreen_native->gbm.next_sync_fd, NULL);
+}
+
+/*
+ * With triple buffering the frame clock may post a new frame before the
+ * previous one has been flipped. Keep the buffers of the previous frame
+ * alive until its page flip completes, so they are not reused for
+ * rendering while still being scanned out.
+ */
+static void
+stash_posted_fb (CoglOnscreen *onscreen)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+
+  if (!onscreen_native->gbm.next_fb)
+    return;
+
+  g_warn_if_fail (!onscreen_native->gbm.posted_fb);
+  free_posted_bo (onscreen);
+
+  onscreen_native->gbm.posted_fb =
+    g_steal_pointer (&onscreen_native->gbm.next_fb);
+  onscreen_native->gbm.posted_scanout =
+    g_steal_pointer (&onscreen_native->gbm.next_scanout);
+  onscreen_native->gbm.posted_overlay_scanout =
+    g_steal_pointer (&onscreen_native->gbm.next_overlay_scanout);
 }
 
 static void
@@ -203,7 +340,9 @@ meta_onscreen_native_notify_frame_complete (CoglOnscreen *onscreen)
 
   info = cogl_onscreen_pop_head_frame_info (onscreen);
 
-  g_assert (!cogl_onscreen_peek_head_frame_info (onscreen));
+  /* At most one more frame may be queued behind this one */
+  g_assert (cogl_onscreen_peek_head_frame_info (onscreen) ==
+            cogl_onscreen_peek_tail_frame_info (onscreen));
 
   _cogl_onscreen_notify_frame_sync (onscreen, info);
   _cogl_onscreen_notify_complete (onscreen, info);
@@ -294,7 +433,8 @@ page_flip_feedback_ready (MetaKmsCrtc *kms_crtc,
   frame_info = cogl_onscreen_peek_head_frame_info (onscreen);
   frame_info->flags |= COGL_FRAME_INFO_FLAG_SYMBOLIC;
 
-  g_warn_if_fail (!onscreen_native->gbm.next_fb);
+  if (frame_info == cogl_onscreen_peek_tail_frame_info (onscreen))
+    g_warn_if_fail (!onscreen_native->gbm.next_fb);
 
   meta_onscreen_native_notify_frame_complete (onscreen);
 }
@@ -442,17 +582,17 @@ apply_transform (MetaCrtcKms            *crtc_kms,
 }
 
 static MetaKmsPlaneAssignment *
-assign_primary_plane (MetaCrtcKms            *crtc_kms,
-                      MetaDrmBuffer          *buffer,
-                      MetaKmsUpdate          *kms_update,
-                      MetaKmsAssignPlaneFlag  flags,
-                      const graphene_rect_t  *src_rect,
-                      const MtkRectangle     *dst_rect)
+assign_plane (MetaCrtcKms            *crtc_kms,
+              MetaKmsPlane           *kms_plane,
+              MetaDrmBuffer          *buffer,
+              MetaKmsUpdate          *kms_update,
+              MetaKmsAssignPlaneFlag  flags,
+              const graphene_rect_t  *src_rect,
+              const MtkRectangle     *dst_rect)
 {
   MetaCrtc *crtc = META_CRTC (crtc_kms);
   MetaFixed16Rectangle src_rect_fixed16;
   MetaKmsCrtc *kms_crtc;
-  MetaKmsPlane *primary_kms_plane;
   MetaKmsPlaneAssignment *plane_assignment;
 
   src_rect_fixed16 = (MetaFixed16Rectangle) {
@@ -463,27 +603,157 @@ assign_primary_plane (MetaCrtcKms            *crtc_kms,
   };
 
   meta_topic (META_DEBUG_KMS,
-              "Assigning buffer to primary plane update on CRTC "
+              "Assigning buffer to %s plane update on CRTC "
               "(%" G_GUINT64_FORMAT ") with src rect %f,%f %fx%f "
               "and dst rect %d,%d %dx%d",
+              meta_kms_plane_get_plane_type (kms_plane) ==
+              META_KMS_PLANE_TYPE_OVERLAY ? "overlay" : "primary",
               meta_crtc_get_id (crtc), src_rect->origin.x, src_rect->origin.y,
               src_rect->size.width, src_rect->size.height,
               dst_rect->x, dst_rect->y, dst_rect->width, dst_rect->height);
 
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
-  primary_kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
   plane_assignment = meta_kms_update_assign_plane (kms_update,
                                                    kms_crtc,
-                                                   primary_kms_plane,
+                                                   kms_plane,
                                                    buffer,
                                                    src_rect_fixed16,
                                                    *dst_rect,
                                                    flags);
-  apply_transform (crtc_kms, plane_assignment, primary_kms_plane);
+  apply_transform (crtc_kms, plane_assignment, kms_plane);
 
   return plane_assignment;
 }
 
+static MetaKmsPlaneAssignment *
+assign_primary_plane (MetaCrtcKms            *crtc_kms,
+                      MetaDrmBuffer          *buffer,
+                      MetaKmsUpdate          *kms_update,
+                      MetaKmsAssignPlaneFlag  flags,
+                      const graphene_rect_t  *src_rect,
+                      const MtkRectangle     *dst_rect)
+{
+  return assign_plane (crtc_kms,
+                       meta_crtc_kms_get_assigned_primary_plane (crtc_kms),
+                       buffer,
+                       kms_update,
+                       flags,
+                       src_rect,
+                       dst_rect);
+}
+
+static void
+assign_overlay_plane (MetaCrtcKms   *crtc_kms,
+                      CoglScanout   *scanout,
+                      MetaKmsUpdate *kms_update)
+{
+  MetaKmsPlane *overlay_plane;
+  MetaDrmBuffer *buffer;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+
+  overlay_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
+
+  cogl_scanout_get_src_rect (scanout, &src_rect);
+  cogl_scanout_get_dst_rect (scanout, &dst_rect);
+
+  assign_plane (crtc_kms,
+                overlay_plane,
+                buffer,
+                kms_update,
+                META_KMS_ASSIGN_PLANE_FLAG_DIRECT_SCANOUT,
+                &src_rect,
+                &dst_rect);
+}
+
+typedef struct _OverlayFeedbackData
+{
+  MetaOnscreenNative *onscreen_native;
+  CoglScanout *scanout;
+} OverlayFeedbackData;
+
+static void
+overlay_feedback_data_free (OverlayFeedbackData *data)
+{
+  g_object_unref (data->onscreen_native);
+  g_object_unref (data->scanout);
+  g_free (data);
+}
+
+static void
+overlay_result_feedback (const MetaKmsFeedback *kms_feedback,
+                         gpointer               user_data)
+{
+  OverlayFeedbackData *data = user_data;
+  MetaOnscreenNative *onscreen_native = data->onscreen_native;
+  CoglOnscreen *onscreen = COGL_ONSCREEN (onscreen_native);
+  ClutterStageView *view = CLUTTER_STAGE_VIEW (onscreen_native->view);
+  const GError *error;
+
+  error = meta_kms_feedback_get_error (kms_feedback);
+  if (!error ||
+      g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED))
+    return;
+
+  g_warning ("Overlay plane page flip failed: %s", error->message);
+
+  invalidate_plane_test_results (onscreen_native);
+
+  /* Taint the buffer so that the following frames are composited
+   * without the overlay plane */
+  cogl_scanout_notify_failed (data->scanout, onscreen);
+  if (onscreen_native->overlay_scanout == data->scanout)
+    g_clear_object (&onscreen_native->overlay_scanout);
+
+  clutter_stage_view_add_redraw_clip (view, NULL);
+  clutter_stage_view_schedule_update_now (view);
+}
+
+static const MetaKmsResultListenerVtable overlay_result_listener_vtable = {
+  .feedback = overlay_result_feedback,
+};
+
+static void
+update_overlay_plane (CoglOnscreen  *onscreen,
+                      MetaCrtcKms   *crtc_kms,
+                      MetaKmsUpdate *kms_update)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  MetaKmsPlane *overlay_plane;
+
+  overlay_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  if (!overlay_plane)
+    return;
+
+  g_set_object (&onscreen_native->gbm.next_overlay_scanout,
+                onscreen_native->overlay_scanout);
+
+  if (onscreen_native->gbm.next_overlay_scanout)
+    {
+      OverlayFeedbackData *data;
+
+      assign_overlay_plane (crtc_kms,
+                            onscreen_native->gbm.next_overlay_scanout,
+                            kms_update);
+
+      data = g_new0 (OverlayFeedbackData, 1);
+      data->onscreen_native = g_object_ref (onscreen_native);
+      data->scanout = g_object_ref (onscreen_native->gbm.next_overlay_scanout);
+      meta_kms_update_add_result_listener (kms_update,
+                                           &overlay_result_listener_vtable,
+                                           NULL,
+                                           data,
+                                           (GDestroyNotify) overlay_feedback_data_free);
+    }
+  else if (onscreen_native->gbm.posted_overlay_scanout ||
+           onscreen_native->gbm.current_overlay_scanout)
+    {
+      meta_kms_update_unassign_plane (kms_update, kms_crtc, overlay_plane);
+    }
+}
+
 static void
 meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
                                 MetaRendererView       *view,
@@ -555,6 +825,17 @@ meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
           meta_kms_plane_assignment_set_fb_damage (plane_assignment,
                                                    rectangles, n_rectangles);
         }
+
+      /* Let KMS wait for the rendering to complete instead of relying on
+       * implicit synchronization of the buffer */
+      if (onscreen_native->gbm.next_sync_fd >= 0)
+        {
+          meta_kms_plane_assignment_set_in_fence_fd (
+            plane_assignment,
+            g_steal_fd (&onscreen_native->gbm.next_sync_fd));
+        }
+
+      update_overlay_plane (onscreen, crtc_kms, kms_update);
       break;
     case META_RENDERER_NATIVE_MODE_SURFACELESS:
       g_assert_not_reached ();
@@ -737,7 +1018,94 @@ secondary_gpu_release_dumb (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_s
   unsigned i;
 
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
-    g_clear_object (&secondary_gpu_state->cpu.dumb_fbs[i]);
+    {
+      g_clear_object (&secondary_gpu_state->cpu.dumb_fbs[i]);
+      g_clear_pointer (&secondary_gpu_state->cpu.dumb_fb_damage[i],
+                       mtk_region_unref);
+    }
+}
+
+static void
+secondary_gpu_reset_dumb_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+{
+  unsigned i;
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fb_damage); i++)
+    {
+      g_clear_pointer (&secondary_gpu_state->cpu.dumb_fb_damage[i],
+                       mtk_region_unref);
+    }
+}
+
+static MtkRegion *
+region_from_damage_rectangles (const int *rectangles,
+                               int        n_rectangles)
+{
+  MtkRegionBuilder builder;
+  int i;
+
+  mtk_region_builder_init (&builder);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      mtk_region_builder_add_rectangle (&builder,
+                                        rectangles[i * 4],
+                                        rectangles[i * 4 + 1],
+                                        rectangles[i * 4 + 2],
+                                        rectangles[i * 4 + 3]);
+    }
+
+  return mtk_region_builder_finish (&builder);
+}
+
+static void
+secondary_gpu_reset_damage_history (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+{
+  int i;
+
+  for (i = 0; i < SECONDARY_GPU_DAMAGE_HISTORY_LENGTH; i++)
+    g_clear_pointer (&secondary_gpu_state->damage_history[i], mtk_region_unref);
+}
+
+static void
+secondary_gpu_push_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                           MtkRegion                           *damage)
+{
+  MtkRegion **history = secondary_gpu_state->damage_history;
+
+  g_clear_pointer (&history[SECONDARY_GPU_DAMAGE_HISTORY_LENGTH - 1],
+                   mtk_region_unref);
+  memmove (&history[1], &history[0],
+           (SECONDARY_GPU_DAMAGE_HISTORY_LENGTH - 1) * sizeof (MtkRegion *));
+  history[0] = damage ? mtk_region_ref (damage) : NULL;
+}
+
+/*
+ * Returns the region that needs to be copied into a back buffer of the
+ * given age so that it ends up up to date, or NULL if the whole buffer
+ * must be copied.
+ */
+static MtkRegion *
+secondary_gpu_get_buffer_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                 MtkRegion                           *damage,
+                                 int                                  age)
+{
+  MtkRegion *buffer_damage;
+  int i;
+
+  if (!damage || age <= 0 || age > SECONDARY_GPU_DAMAGE_HISTORY_LENGTH + 1)
+    return NULL;
+
+  for (i = 0; i < age - 1; i++)
+    {
+      if (!secondary_gpu_state->damage_history[i])
+        return NULL;
+    }
+
+  buffer_damage = mtk_region_copy (damage);
+  for (i = 0; i < age - 1; i++)
+    mtk_region_union (buffer_damage, secondary_gpu_state->damage_history[i]);
+
+  return buffer_damage;
 }
 
 static void
@@ -765,10 +1133,53 @@ secondary_gpu_state_free (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_sta
   g_clear_pointer (&secondary_gpu_state->gbm.surface, gbm_surface_destroy);
 
   secondary_gpu_release_dumb (secondary_gpu_state);
+  secondary_gpu_reset_damage_history (secondary_gpu_state);
 
   g_free (secondary_gpu_state);
 }
 
+static const char *
+shared_framebuffer_path_to_string (MetaSharedFramebufferPath path)
+{
+  switch (path)
+    {
+    case META_SHARED_FRAMEBUFFER_PATH_NONE:
+      return "none";
+    case META_SHARED_FRAMEBUFFER_PATH_ZERO_COPY:
+      return "zero-copy";
+    case META_SHARED_FRAMEBUFFER_PATH_SECONDARY_GPU_COPY:
+      return "secondary GPU copy";
+    case META_SHARED_FRAMEBUFFER_PATH_PRIMARY_GPU_COPY:
+      return "primary GPU copy";
+    case META_SHARED_FRAMEBUFFER_PATH_CPU_COPY:
+      return "CPU copy";
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+report_shared_framebuffer_path (CoglOnscreen                        *onscreen,
+                                MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                MetaSharedFramebufferPath            path)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaRenderDevice *render_device;
+
+  if (secondary_gpu_state->reported_path == path)
+    return;
+
+  render_device = secondary_gpu_state->renderer_gpu_data->render_device;
+  meta_topic (META_DEBUG_KMS,
+              "Output %s on %s switched from %s to %s",
+              meta_output_get_name (onscreen_native->output),
+              meta_render_device_get_name (render_device),
+              shared_framebuffer_path_to_string (secondary_gpu_state->reported_path),
+              shared_framebuffer_path_to_string (path));
+
+  secondary_gpu_state->reported_path = path;
+}
+
 static MetaDrmBuffer *
 import_shared_framebuffer (CoglOnscreen                        *onscreen,
                            MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
@@ -822,7 +1233,9 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
                              MetaRendererNativeGpuData           *renderer_gpu_data,
                              gboolean                            *egl_context_changed,
-                             MetaDrmBuffer                       *primary_gpu_fb)
+                             MetaDrmBuffer                       *primary_gpu_fb,
+                             const int                           *rectangles,
+                             int                                  n_rectangles)
 {
   MetaRendererNative *renderer_native = renderer_gpu_data->renderer_native;
   MetaEgl *egl = meta_renderer_native_get_egl (renderer_native);
@@ -835,6 +1248,10 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
   MetaDrmBufferFlags flags;
   MetaDrmBufferGbm *buffer_gbm;
   struct gbm_bo *bo;
+  g_autoptr (MtkRegion) damage = NULL;
+  g_autoptr (MtkRegion) buffer_damage = NULL;
+  g_autofree MtkRectangle *blit_rectangles = NULL;
+  int n_blit_rectangles = 0;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferSecondaryGpu,
                            "copy_shared_framebuffer_gpu()");
@@ -856,6 +1273,36 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
 
   *egl_context_changed = TRUE;
 
+  if (n_rectangles > 0)
+    damage = region_from_damage_rectangles (rectangles, n_rectangles);
+
+  /* Only copy what changed since the back buffer was last drawn to */
+  if (renderer_gpu_data->secondary.has_EGL_EXT_buffer_age)
+    {
+      EGLint age;
+
+      if (meta_egl_query_surface (egl,
+                                  egl_display,
+                                  secondary_gpu_state->egl_surface,
+                                  EGL_BUFFER_AGE_EXT,
+                                  &age,
+                                  NULL))
+        {
+          buffer_damage = secondary_gpu_get_buffer_damage (secondary_gpu_state,
+                                                           damage,
+                                                           age);
+        }
+    }
+
+  if (buffer_damage)
+    {
+      int i;
+
+      n_blit_rectangles = mtk_region_num_rectangles (buffer_damage);
+      blit_rectangles = g_new (MtkRectangle, n_blit_rectangles);
+      for (i = 0; i < n_blit_rectangles; i++)
+        blit_rectangles[i] = mtk_region_get_rectangle (buffer_damage, i);
+    }
 
   buffer_gbm = META_DRM_BUFFER_GBM (primary_gpu_fb);
   bo = meta_drm_buffer_gbm_get_bo (buffer_gbm);
@@ -865,13 +1312,18 @@ copy_shared_framebuffer_gpu (CoglOnscreen                        *onscreen,
                                                   renderer_gpu_data->secondary.egl_context,
                                                   secondary_gpu_state->egl_surface,
                                                   bo,
+                                                  blit_rectangles,
+                                                  n_blit_rectangles,
                                                   &error))
     {
       g_warning ("Failed to blit shared framebuffer: %s", error->message);
       g_error_free (error);
+      secondary_gpu_reset_damage_history (secondary_gpu_state);
       return NULL;
     }
 
+  secondary_gpu_push_damage (secondary_gpu_state, damage);
+
   if (!meta_egl_swap_buffers (egl,
                               egl_display,
                               secondary_gpu_state->egl_surface,
@@ -1037,21 +1489,95 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   return g_object_ref (buffer);
 }
 
+/*
+ * Returns the region that needs to be copied into the given dumb buffer,
+ * or NULL if it needs to be copied as a whole, and accumulates the damage
+ * for the other dumb buffers.
+ */
+static MtkRegion *
+secondary_gpu_take_dumb_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                MetaDrmBufferDumb                   *buffer_dumb,
+                                MtkRegion                           *damage)
+{
+  MtkRegion *buffer_damage = NULL;
+  unsigned i;
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
+    {
+      MtkRegion **dumb_fb_damage = &secondary_gpu_state->cpu.dumb_fb_damage[i];
+
+      if (secondary_gpu_state->cpu.dumb_fbs[i] == buffer_dumb)
+        {
+          if (damage && *dumb_fb_damage)
+            {
+              buffer_damage = g_steal_pointer (dumb_fb_damage);
+              mtk_region_union (buffer_damage, damage);
+            }
+
+          g_clear_pointer (dumb_fb_damage, mtk_region_unref);
+          *dumb_fb_damage = mtk_region_create ();
+        }
+      else if (*dumb_fb_damage)
+        {
+          if (damage)
+            mtk_region_union (*dumb_fb_damage, damage);
+          else
+            g_clear_pointer (dumb_fb_damage, mtk_region_unref);
+        }
+    }
+
+  return buffer_damage;
+}
+
+static gboolean
+read_pixels_into_dumb_buffer (CoglFramebuffer    *framebuffer,
+                              CoglPixelFormat     cogl_format,
+                              uint8_t            *buffer_data,
+                              int                 stride,
+                              const MtkRectangle *rect)
+{
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (CoglBitmap) dumb_bitmap = NULL;
+  int bpp;
+
+  /* Read straight into the damaged part of the mapped dumb buffer, so that
+   * no intermediate copy of the rows is needed. */
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
+  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                          rect->width,
+                                          rect->height,
+                                          cogl_format,
+                                          stride,
+                                          buffer_data +
+                                          rect->y * stride +
+                                          rect->x * bpp);
+
+  return cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                   rect->x,
+                                                   rect->y,
+                                                   COGL_READ_PIXELS_COLOR_BUFFER,
+                                                   dumb_bitmap);
+}
+
 static MetaDrmBuffer *
 copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
-                             MetaRendererNativeGpuData           *renderer_gpu_data)
+                             MetaRendererNativeGpuData           *renderer_gpu_data,
+                             const int                           *rectangles,
+                             int                                  n_rectangles)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
-  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
   MetaDrmBufferDumb *buffer_dumb;
   MetaDrmBuffer *buffer;
   int width, height, stride;
   uint32_t drm_format;
-  void *buffer_data;
-  CoglBitmap *dumb_bitmap;
+  uint8_t *buffer_data;
   CoglPixelFormat cogl_format;
   const MetaFormatInfo *format_info;
+  g_autoptr (MtkRegion) damage = NULL;
+  g_autoptr (MtkRegion) buffer_damage = NULL;
+  MtkRectangle full_rect;
+  gboolean success = TRUE;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpu,
                            "copy_shared_framebuffer_cpu()");
@@ -1072,21 +1598,57 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   g_assert (format_info);
   cogl_format = format_info->cogl_format;
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          width,
-                                          height,
-                                          cogl_format,
-                                          stride,
-                                          buffer_data);
+  full_rect = MTK_RECTANGLE_INIT (0, 0, width, height);
+
+  if (n_rectangles > 0)
+    {
+      damage = region_from_damage_rectangles (rectangles, n_rectangles);
+      mtk_region_intersect_rectangle (damage, &full_rect);
+    }
+
+  buffer_damage = secondary_gpu_take_dumb_damage (secondary_gpu_state,
+                                                  buffer_dumb,
+                                                  damage);
 
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+  if (!buffer_damage ||
+      mtk_region_num_rectangles (buffer_damage) > MAX_RECTS)
+    {
+      MtkRectangle rect;
 
-  g_object_unref (dumb_bitmap);
+      /* Every read back has a fixed cost, so read back the bounding box
+       * when the damage is fragmented. */
+      rect = buffer_damage ? mtk_region_get_extents (buffer_damage)
+                           : full_rect;
+      if (rect.width > 0 && rect.height > 0)
+        {
+          success = read_pixels_into_dumb_buffer (framebuffer, cogl_format,
+                                                  buffer_data, stride,
+                                                  &rect);
+        }
+    }
+  else
+    {
+      int i;
+
+      for (i = 0; i < mtk_region_num_rectangles (buffer_damage); i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (buffer_damage, i);
+
+          if (!read_pixels_into_dumb_buffer (framebuffer, cogl_format,
+                                             buffer_data, stride,
+                                             &rect))
+            {
+              success = FALSE;
+              break;
+            }
+        }
+    }
+
+  if (!success)
+    {
+      g_warning ("Failed to CPU-copy to a secondary GPU output");
+      secondary_gpu_reset_dumb_damage (secondary_gpu_state);
+    }
 
   secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
 
@@ -1122,7 +1684,10 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
           /* Done after eglSwapBuffers. */
           if (secondary_gpu_state->import_status ==
               META_SHARED_FRAMEBUFFER_IMPORT_STATUS_OK)
-            break;
+            {
+              secondary_gpu_reset_dumb_damage (secondary_gpu_state);
+              break;
+            }
           /* prepare fallback */
           G_GNUC_FALLTHROUGH;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
@@ -1142,14 +1707,28 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
 
               copy = copy_shared_framebuffer_cpu (onscreen,
                                                   secondary_gpu_state,
-                                                  renderer_gpu_data);
+                                                  renderer_gpu_data,
+                                                  rectangles,
+                                                  n_rectangles);
+              secondary_gpu_state->prepared_path =
+                META_SHARED_FRAMEBUFFER_PATH_CPU_COPY;
             }
-          else if (!secondary_gpu_state->noted_primary_gpu_copy_ok)
+          else
             {
-              meta_topic (META_DEBUG_KMS,
-                          "Using primary GPU to copy for %s succeeded once.",
-                          meta_render_device_get_name (render_device));
-              secondary_gpu_state->noted_primary_gpu_copy_ok = TRUE;
+              /* The primary GPU blit doesn't keep track of what the
+               * dumb buffers contain. */
+              secondary_gpu_reset_dumb_damage (secondary_gpu_state);
+
+              if (!secondary_gpu_state->noted_primary_gpu_copy_ok)
+                {
+                  meta_topic (META_DEBUG_KMS,
+                              "Using primary GPU to copy for %s succeeded once.",
+                              meta_render_device_get_name (render_device));
+                  secondary_gpu_state->noted_primary_gpu_copy_ok = TRUE;
+                }
+
+              secondary_gpu_state->prepared_path =
+                META_SHARED_FRAMEBUFFER_PATH_PRIMARY_GPU_COPY;
             }
           break;
         }
@@ -1159,10 +1738,12 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen *onscreen,
 }
 
 static void
-update_secondary_gpu_state_post_swap_buffers (CoglOnscreen   *onscreen,
-                                              gboolean       *egl_context_changed,
-                                              MetaDrmBuffer  *primary_gpu_fb,
-                                              MetaDrmBuffer **secondary_gpu_fb)
+update_secondary_gpu_state_post_swap_buffers (CoglOnscreen        *onscreen,
+                                              gboolean            *egl_context_changed,
+                                              MetaDrmBuffer       *primary_gpu_fb,
+                                              MetaDrmBuffer      **secondary_gpu_fb,
+                                              const int           *rectangles,
+                                              int                  n_rectangles)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
   MetaRendererNative *renderer_native = onscreen_native->renderer_native;
@@ -1176,6 +1757,7 @@ update_secondary_gpu_state_post_swap_buffers (CoglOnscreen   *onscreen,
     {
       MetaRendererNativeGpuData *renderer_gpu_data;
       g_autoptr (MetaDrmBuffer) next_fb = NULL;
+      MetaSharedFramebufferPath path = META_SHARED_FRAMEBUFFER_PATH_NONE;
 
       renderer_gpu_data =
         meta_renderer_native_get_gpu_data (renderer_native,
@@ -1187,7 +1769,10 @@ update_secondary_gpu_state_post_swap_buffers (CoglOnscreen   *onscreen,
                                                secondary_gpu_state,
                                                primary_gpu_fb);
           if (next_fb)
-            break;
+            {
+              path = META_SHARED_FRAMEBUFFER_PATH_ZERO_COPY;
+              break;
+            }
           /* The fallback was prepared in pre_swap_buffers and is currently
            * in secondary_gpu_fb.
            */
@@ -1196,16 +1781,46 @@ update_secondary_gpu_state_post_swap_buffers (CoglOnscreen   *onscreen,
           G_GNUC_FALLTHROUGH;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
           next_fb = g_object_ref (*secondary_gpu_fb);
+          path = secondary_gpu_state->prepared_path;
           break;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_SECONDARY_GPU:
+          /* The secondary GPU can scan out what the primary GPU rendered
+           * as is, so only copy if importing doesn't work out.
+           */
+          if (secondary_gpu_state->has_shared_modifiers &&
+              secondary_gpu_state->import_status !=
+              META_SHARED_FRAMEBUFFER_IMPORT_STATUS_FAILED)
+            {
+              next_fb = import_shared_framebuffer (onscreen,
+                                                   secondary_gpu_state,
+                                                   primary_gpu_fb);
+            }
+
+          if (next_fb)
+            {
+              path = META_SHARED_FRAMEBUFFER_PATH_ZERO_COPY;
+              break;
+            }
+
           next_fb = copy_shared_framebuffer_gpu (onscreen,
                                                  secondary_gpu_state,
                                                  renderer_gpu_data,
                                                  egl_context_changed,
-                                                 primary_gpu_fb);
+                                                 primary_gpu_fb,
+                                                 rectangles,
+                                                 n_rectangles);
+          path = META_SHARED_FRAMEBUFFER_PATH_SECONDARY_GPU_COPY;
           break;
         }
 
+      /* Frames that didn't go through the secondary GPU copy leave its
+       * buffers behind, so the damage history no longer applies. */
+      if (path != META_SHARED_FRAMEBUFFER_PATH_SECONDARY_GPU_COPY)
+        secondary_gpu_reset_damage_history (secondary_gpu_state);
+
+      if (next_fb)
+        report_shared_framebuffer_path (onscreen, secondary_gpu_state, path);
+
       g_set_object (secondary_gpu_fb, next_fb);
     }
 }
@@ -1317,6 +1932,14 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen  *onscreen,
   switch (renderer_gpu_data->mode)
     {
     case META_RENDERER_NATIVE_MODE_GBM:
+      g_clear_fd (&onscreen_native->gbm.next_sync_fd, NULL);
+      if (!onscreen_native->secondary_gpu_state &&
+          cogl_has_feature (cogl_context, COGL_FEATURE_ID_SYNC_FD))
+        {
+          onscreen_native->gbm.next_sync_fd =
+            cogl_context_get_latest_sync_fd (cogl_context);
+        }
+
       buffer_flags = META_DRM_BUFFER_FLAG_NONE;
       if (!meta_renderer_native_use_modifiers (renderer_native))
         buffer_flags |= META_DRM_BUFFER_FLAG_DISABLE_MODIFIERS;
@@ -1351,12 +1974,14 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen  *onscreen,
   update_secondary_gpu_state_post_swap_buffers (onscreen,
                                                 &egl_context_changed,
                                                 primary_gpu_fb,
-                                                &secondary_gpu_fb);
+                                                &secondary_gpu_fb,
+                                                rectangles,
+                                                n_rectangles);
 
   switch (renderer_gpu_data->mode)
     {
     case META_RENDERER_NATIVE_MODE_GBM:
-      g_warn_if_fail (onscreen_native->gbm.next_fb == NULL);
+      stash_posted_fb (onscreen);
       if (onscreen_native->secondary_gpu_state)
         g_set_object (&onscreen_native->gbm.next_fb, secondary_gpu_fb);
       else
@@ -1478,6 +2103,165 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen  *onscreen,
   clutter_frame_set_result (frame, CLUTTER_FRAME_RESULT_PENDING_PRESENTED);
 }
 
+static guint
+plane_test_key_hash (gconstpointer data)
+{
+  const PlaneTestKey *key = data;
+  guint hash;
+
+  hash = key->plane_id;
+  hash = hash * 31 + key->format;
+  hash = hash * 31 + g_int64_hash (&key->modifier);
+  hash = hash * 31 + key->width;
+  hash = hash * 31 + key->height;
+  hash = hash * 31 + key->src_rect.x;
+  hash = hash * 31 + key->src_rect.y;
+  hash = hash * 31 + key->src_rect.width;
+  hash = hash * 31 + key->src_rect.height;
+  hash = hash * 31 + key->dst_rect.x;
+  hash = hash * 31 + key->dst_rect.y;
+  hash = hash * 31 + key->dst_rect.width;
+  hash = hash * 31 + key->dst_rect.height;
+  hash = hash * 31 + key->transform;
+  hash = hash * 31 + key->primary_format;
+  hash = hash * 31 + g_int64_hash (&key->primary_modifier);
+  hash = hash * 31 + key->primary_width;
+  hash = hash * 31 + key->primary_height;
+
+  return hash;
+}
+
+static gboolean
+plane_test_key_equal (gconstpointer a,
+                      gconstpointer b)
+{
+  /* Keys are zero initialized, so padding never differs */
+  return memcmp (a, b, sizeof (PlaneTestKey)) == 0;
+}
+
+static void
+init_plane_test_key (PlaneTestKey          *key,
+                     MetaCrtcKms           *crtc_kms,
+                     MetaKmsPlane          *kms_plane,
+                     MetaDrmBuffer         *buffer,
+                     const graphene_rect_t *src_rect,
+                     const MtkRectangle    *dst_rect,
+                     MetaDrmBuffer         *primary_buffer)
+{
+  const MetaCrtcConfig *crtc_config =
+    meta_crtc_get_config (META_CRTC (crtc_kms));
+
+  memset (key, 0, sizeof (PlaneTestKey));
+
+  key->plane_id = meta_kms_plane_get_id (kms_plane);
+  key->format = meta_drm_buffer_get_format (buffer);
+  key->modifier = meta_drm_buffer_get_modifier (buffer);
+  key->width = meta_drm_buffer_get_width (buffer);
+  key->height = meta_drm_buffer_get_height (buffer);
+  key->src_rect.x = meta_fixed_16_from_double (src_rect->origin.x);
+  key->src_rect.y = meta_fixed_16_from_double (src_rect->origin.y);
+  key->src_rect.width = meta_fixed_16_from_double (src_rect->size.width);
+  key->src_rect.height = meta_fixed_16_from_double (src_rect->size.height);
+  key->dst_rect = *dst_rect;
+  key->transform = crtc_config->transform;
+
+  if (primary_buffer)
+    {
+      key->primary_format = meta_drm_buffer_get_format (primary_buffer);
+      key->primary_modifier = meta_drm_buffer_get_modifier (primary_buffer);
+      key->primary_width = meta_drm_buffer_get_width (primary_buffer);
+      key->primary_height = meta_drm_buffer_get_height (primary_buffer);
+    }
+}
+
+static gboolean
+lookup_plane_test_result (MetaOnscreenNative *onscreen_native,
+                          const PlaneTestKey *key,
+                          gboolean           *out_passed)
+{
+  PlaneTestResult *result;
+
+  result = g_hash_table_lookup (onscreen_native->plane_test_results, key);
+  if (!result)
+    return FALSE;
+
+  if (g_get_monotonic_time () - result->time_us > PLANE_TEST_RESULT_TIMEOUT_US)
+    {
+      g_hash_table_remove (onscreen_native->plane_test_results, key);
+      return FALSE;
+    }
+
+  *out_passed = result->passed;
+  return TRUE;
+}
+
+static gboolean
+is_plane_test_result_expired (gpointer key,
+                              gpointer value,
+                              gpointer user_data)
+{
+  PlaneTestResult *result = value;
+  int64_t *now_us = user_data;
+
+  return *now_us - result->time_us > PLANE_TEST_RESULT_TIMEOUT_US;
+}
+
+static gboolean
+process_plane_test_update (MetaOnscreenNative *onscreen_native,
+                           MetaKmsDevice      *kms_device,
+                           MetaKmsUpdate      *test_update,
+                           const PlaneTestKey *key)
+{
+  GHashTable *plane_test_results = onscreen_native->plane_test_results;
+  g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
+  PlaneTestResult *result;
+  const GError *error;
+  gboolean passed;
+  int64_t now_us;
+
+  kms_feedback =
+    meta_kms_device_process_update_sync (kms_device, test_update,
+                                         META_KMS_UPDATE_FLAG_TEST_ONLY);
+
+  passed = meta_kms_feedback_get_result (kms_feedback) ==
+           META_KMS_FEEDBACK_PASSED;
+
+  /* Failing because of not being DRM master says nothing about the
+   * configuration itself */
+  error = meta_kms_feedback_get_error (kms_feedback);
+  if (error &&
+      g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED))
+    return passed;
+
+  now_us = g_get_monotonic_time ();
+
+  if (g_hash_table_size (plane_test_results) >= MAX_PLANE_TEST_RESULTS)
+    {
+      g_hash_table_foreach_remove (plane_test_results,
+                                   is_plane_test_result_expired,
+                                   &now_us);
+    }
+  if (g_hash_table_size (plane_test_results) >= MAX_PLANE_TEST_RESULTS)
+    g_hash_table_remove_all (plane_test_results);
+
+  result = g_new0 (PlaneTestResult, 1);
+  result->key = *key;
+  result->passed = passed;
+  result->time_us = now_us;
+  g_hash_table_replace (plane_test_results, &result->key, result);
+
+  return passed;
+}
+
+static void
+invalidate_plane_test_results (MetaOnscreenNative *onscreen_native)
+{
+  /* A configuration that passed a test commit may still fail for real,
+   * e.g. because of the state of the other CRTCs, so don't trust any
+   * earlier result after that */
+  g_hash_table_remove_all (onscreen_native->plane_test_results);
+}
+
 gboolean
 meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
                                                    CoglScanout  *scanout)
@@ -1490,39 +2274,128 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
   MetaKmsCrtc *kms_crtc;
   MetaKmsUpdate *test_update;
   MetaDrmBuffer *buffer;
-  g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
-  MetaKmsFeedbackResult result;
   graphene_rect_t src_rect;
   MtkRectangle dst_rect;
+  PlaneTestKey key;
+  gboolean passed;
 
   gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
   kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
 
-  test_update = meta_kms_update_new (kms_device);
-
   cogl_scanout_get_src_rect (scanout, &src_rect);
   cogl_scanout_get_dst_rect (scanout, &dst_rect);
 
   buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
+
+  init_plane_test_key (&key, crtc_kms,
+                       meta_crtc_kms_get_assigned_primary_plane (crtc_kms),
+                       buffer, &src_rect, &dst_rect, NULL);
+  if (lookup_plane_test_result (onscreen_native, &key, &passed))
+    return passed;
+
+  test_update = meta_kms_update_new (kms_device);
   assign_primary_plane (crtc_kms,
                         buffer,
                         test_update,
-                        META_KMS_ASSIGN_PLANE_FLAG_DIRECT_SCANOUT,
-                        &src_rect,
-                        &dst_rect);
+                        META_KMS_ASSIGN_PLANE_FLAG_DIRECT_SCANOUT,
+                        &src_rect,
+                        &dst_rect);
+
+  meta_topic (META_DEBUG_KMS,
+              "Posting direct scanout test update for CRTC %u (%s) synchronously",
+              meta_kms_crtc_get_id (kms_crtc),
+              meta_kms_device_get_path (kms_device));
+
+  return process_plane_test_update (onscreen_native, kms_device,
+                                    test_update, &key);
+}
+
+gboolean
+meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                   CoglScanout  *scanout)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaCrtc *crtc = onscreen_native->crtc;
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
+  MetaGpuKms *gpu_kms;
+  MetaKmsDevice *kms_device;
+  MetaKmsCrtc *kms_crtc;
+  MetaKmsUpdate *test_update;
+  MetaKmsPlane *overlay_plane;
+  MetaDrmBuffer *current_fb;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+  PlaneTestKey key;
+  gboolean passed;
+
+  overlay_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  if (!overlay_plane)
+    return FALSE;
+
+  /* The buffer is imported on the primary GPU */
+  if (onscreen_native->secondary_gpu_state)
+    return FALSE;
+
+  /* Test against what is currently on the primary plane, as most drivers
+   * only accept an overlay plane next to an active primary plane */
+  current_fb = onscreen_native->gbm.current_fb;
+  if (!current_fb)
+    return FALSE;
+
+  gpu_kms = META_GPU_KMS (meta_crtc_get_gpu (crtc));
+  kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
+  kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+
+  cogl_scanout_get_src_rect (scanout, &src_rect);
+  cogl_scanout_get_dst_rect (scanout, &dst_rect);
+
+  init_plane_test_key (&key, crtc_kms, overlay_plane,
+                       META_DRM_BUFFER (cogl_scanout_get_buffer (scanout)),
+                       &src_rect, &dst_rect, current_fb);
+  if (lookup_plane_test_result (onscreen_native, &key, &passed))
+    return passed;
+
+  test_update = meta_kms_update_new (kms_device);
+
+  assign_primary_plane (crtc_kms,
+                        current_fb,
+                        test_update,
+                        META_KMS_ASSIGN_PLANE_FLAG_NONE,
+                        &GRAPHENE_RECT_INIT (0, 0,
+                                             meta_drm_buffer_get_width (current_fb),
+                                             meta_drm_buffer_get_height (current_fb)),
+                        &MTK_RECTANGLE_INIT (0, 0,
+                                             meta_drm_buffer_get_width (current_fb),
+                                             meta_drm_buffer_get_height (current_fb)));
+  assign_overlay_plane (crtc_kms, scanout, test_update);
 
   meta_topic (META_DEBUG_KMS,
-              "Posting direct scanout test update for CRTC %u (%s) synchronously",
+              "Posting overlay plane test update for CRTC %u (%s) synchronously",
               meta_kms_crtc_get_id (kms_crtc),
               meta_kms_device_get_path (kms_device));
 
-  kms_feedback =
-    meta_kms_device_process_update_sync (kms_device, test_update,
-                                         META_KMS_UPDATE_FLAG_TEST_ONLY);
+  return process_plane_test_update (onscreen_native, kms_device,
+                                    test_update, &key);
+}
 
-  result = meta_kms_feedback_get_result (kms_feedback);
-  return result == META_KMS_FEEDBACK_PASSED;
+/**
+ * meta_onscreen_native_set_overlay_scanout:
+ * @onscreen: A native onscreen
+ * @scanout: (nullable): A scanout previously checked with
+ *   meta_onscreen_native_is_buffer_overlay_compatible()
+ *
+ * Sets the scanout presented on the overlay plane of the CRTC, on top of
+ * the composited frames posted from now on, or stops using the overlay
+ * plane if @scanout is %NULL.
+ */
+void
+meta_onscreen_native_set_overlay_scanout (CoglOnscreen *onscreen,
+                                          CoglScanout  *scanout)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+
+  g_set_object (&onscreen_native->overlay_scanout, scanout);
 }
 
 static void
@@ -1546,6 +2419,8 @@ scanout_result_feedback (const MetaKmsFeedback *kms_feedback,
 
       g_warning ("Direct scanout page flip failed: %s", error->message);
 
+      invalidate_plane_test_results (onscreen_native);
+
       cogl_scanout_notify_failed (onscreen_native->gbm.next_scanout,
                                   onscreen);
       clutter_stage_view_add_redraw_clip (view, NULL);
@@ -1585,6 +2460,8 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
   MetaPowerSave power_save_mode;
   ClutterFrame *frame = user_data;
   MetaFrameNative *frame_native = meta_frame_native_from_frame (frame);
+  ClutterFrameClock *frame_clock =
+    clutter_stage_view_get_frame_clock (CLUTTER_STAGE_VIEW (onscreen_native->view));
   MetaKmsCrtc *kms_crtc;
   MetaKmsDevice *kms_device;
   MetaKmsUpdate *kms_update;
@@ -1612,9 +2489,9 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
                                                          render_gpu);
 
   g_warn_if_fail (renderer_gpu_data->mode == META_RENDERER_NATIVE_MODE_GBM);
-  g_warn_if_fail (!onscreen_native->gbm.next_fb);
-  g_warn_if_fail (!onscreen_native->gbm.next_scanout);
+  stash_posted_fb (onscreen);
 
+  g_clear_fd (&onscreen_native->gbm.next_sync_fd, NULL);
   g_set_object (&onscreen_native->gbm.next_scanout, scanout);
   g_set_object (&onscreen_native->gbm.next_fb,
                 META_DRM_BUFFER (cogl_scanout_get_buffer (scanout)));
@@ -1631,6 +2508,10 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
                                        onscreen_native,
                                        NULL);
 
+  if (clutter_frame_clock_get_mode (frame_clock) ==
+      CLUTTER_FRAME_CLOCK_MODE_TEARING)
+    meta_kms_update_set_async_page_flip (kms_update, TRUE);
+
   meta_onscreen_native_flip_crtc (onscreen,
                                   onscreen_native->view,
                                   onscreen_native->crtc,
@@ -1706,6 +2587,26 @@ meta_onscreen_native_prepare_frame (CoglOnscreen *onscreen,
         }
     }
 
+  if (meta_kms_crtc_is_vrr_supported (kms_crtc))
+    {
+      const MetaKmsCrtcState *crtc_state =
+        meta_kms_crtc_get_current_state (kms_crtc);
+      MetaRendererViewVrrPolicy vrr_policy;
+      gboolean vrr_enabled;
+
+      vrr_policy = meta_renderer_view_get_vrr_policy (onscreen_native->view);
+      vrr_enabled = vrr_policy != META_RENDERER_VIEW_VRR_POLICY_NEVER;
+
+      if (crtc_state->vrr.enabled != vrr_enabled)
+        {
+          MetaKmsUpdate *kms_update;
+
+          kms_update = meta_frame_native_ensure_kms_update (frame_native,
+                                                            kms_device);
+          meta_kms_update_set_vrr (kms_update, kms_crtc, vrr_enabled);
+        }
+    }
+
   if (onscreen_native->is_privacy_screen_invalid)
     {
       MetaKmsConnector *kms_connector =
@@ -1958,9 +2859,72 @@ get_supported_egl_modifiers (CoglOnscreen *onscreen,
   return modifiers;
 }
 
+static gboolean
+has_modifier (GArray   *modifiers,
+              uint64_t  modifier)
+{
+  unsigned int i;
+
+  for (i = 0; i < modifiers->len; i++)
+    {
+      if (g_array_index (modifiers, uint64_t, i) == modifier)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*
+ * Modifiers for rendering on the primary GPU and displaying on a secondary
+ * one. Prefer the ones the secondary GPU can both scan out and import for
+ * copying, so the buffer can be put on its primary plane as is and copying
+ * still works as a fallback. The primary GPU picks what it can render from
+ * this list, which typically leaves only linear for GPUs of different
+ * vendors.
+ */
+static GArray *
+get_supported_shared_modifiers (CoglOnscreen *onscreen,
+                                MetaCrtcKms  *crtc_kms,
+                                uint32_t      format,
+                                gboolean     *out_is_scanout_compatible)
+{
+  g_autoptr (GArray) kms_modifiers = NULL;
+  g_autoptr (GArray) egl_modifiers = NULL;
+  GArray *modifiers;
+  unsigned int i;
+
+  *out_is_scanout_compatible = FALSE;
+
+  kms_modifiers = get_supported_kms_modifiers (crtc_kms, format);
+  egl_modifiers = get_supported_egl_modifiers (onscreen, crtc_kms, format);
+  if (!kms_modifiers)
+    return g_steal_pointer (&egl_modifiers);
+
+  modifiers = g_array_new (FALSE, FALSE, sizeof (uint64_t));
+  for (i = 0; i < kms_modifiers->len; i++)
+    {
+      uint64_t modifier = g_array_index (kms_modifiers, uint64_t, i);
+
+      if (egl_modifiers && !has_modifier (egl_modifiers, modifier))
+        continue;
+
+      g_array_append_val (modifiers, modifier);
+    }
+
+  if (modifiers->len == 0)
+    {
+      g_array_free (modifiers, TRUE);
+      return g_steal_pointer (&egl_modifiers);
+    }
+
+  *out_is_scanout_compatible = TRUE;
+  return modifiers;
+}
+
 static GArray *
 get_supported_modifiers (CoglOnscreen *onscreen,
-                         uint32_t      format)
+                         uint32_t      format,
+                         gboolean     *out_is_scanout_compatible)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
   MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
@@ -1969,13 +2933,235 @@ get_supported_modifiers (CoglOnscreen *onscreen,
 
   gpu = meta_crtc_get_gpu (META_CRTC (crtc_kms));
   if (gpu == META_GPU (onscreen_native->render_gpu))
-    modifiers = get_supported_kms_modifiers (crtc_kms, format);
+    {
+      modifiers = get_supported_kms_modifiers (crtc_kms, format);
+      *out_is_scanout_compatible = TRUE;
+    }
   else
-    modifiers = get_supported_egl_modifiers (onscreen, crtc_kms, format);
+    {
+      modifiers = get_supported_shared_modifiers (onscreen, crtc_kms, format,
+                                                  out_is_scanout_compatible);
+    }
 
   return g_steal_pointer (&modifiers);
 }
 
+static gboolean
+is_compressed_intel_modifier (uint64_t modifier)
+{
+  switch (modifier)
+    {
+    case I915_FORMAT_MOD_Y_TILED_CCS:
+    case I915_FORMAT_MOD_Yf_TILED_CCS:
+#ifdef I915_FORMAT_MOD_Y_TILED_GEN12_RC_CCS
+    case I915_FORMAT_MOD_Y_TILED_GEN12_RC_CCS:
+    case I915_FORMAT_MOD_Y_TILED_GEN12_MC_CCS:
+#endif
+#ifdef I915_FORMAT_MOD_Y_TILED_GEN12_RC_CCS_CC
+    case I915_FORMAT_MOD_Y_TILED_GEN12_RC_CCS_CC:
+#endif
+#ifdef I915_FORMAT_MOD_4_TILED_DG2_RC_CCS
+    case I915_FORMAT_MOD_4_TILED_DG2_RC_CCS:
+    case I915_FORMAT_MOD_4_TILED_DG2_MC_CCS:
+    case I915_FORMAT_MOD_4_TILED_DG2_RC_CCS_CC:
+#endif
+#ifdef I915_FORMAT_MOD_4_TILED_MTL_RC_CCS
+    case I915_FORMAT_MOD_4_TILED_MTL_RC_CCS:
+    case I915_FORMAT_MOD_4_TILED_MTL_MC_CCS:
+    case I915_FORMAT_MOD_4_TILED_MTL_RC_CCS_CC:
+#endif
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+is_compressed_amd_modifier (uint64_t modifier)
+{
+#ifdef AMD_FMT_MOD
+  return AMD_FMT_MOD_GET (DCC, modifier) != 0;
+#else
+  return FALSE;
+#endif
+}
+
+static gboolean
+is_compressed_nvidia_modifier (uint64_t modifier)
+{
+  /* Block linear layouts carry the compression type in bits 23-25 */
+  return (modifier & 0x10) != 0 && ((modifier >> 23) & 0x7) != 0;
+}
+
+static gboolean
+is_compressed_arm_modifier (uint64_t modifier)
+{
+  /* Both AFBC and AFRC are compressed, the type lives in bits 52-55 */
+  switch ((modifier >> 52) & 0xf)
+    {
+    case 0x0: /* AFBC */
+    case 0x2: /* AFRC */
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static const struct {
+  uint64_t vendor;
+  gboolean (* is_compressed) (uint64_t modifier);
+} compressed_modifier_vendors[] = {
+  { DRM_FORMAT_MOD_VENDOR_INTEL, is_compressed_intel_modifier },
+  { DRM_FORMAT_MOD_VENDOR_AMD, is_compressed_amd_modifier },
+  { DRM_FORMAT_MOD_VENDOR_NVIDIA, is_compressed_nvidia_modifier },
+  { DRM_FORMAT_MOD_VENDOR_ARM, is_compressed_arm_modifier },
+};
+
+static gboolean
+is_compressed_modifier (uint64_t modifier)
+{
+  uint64_t vendor = modifier >> 56;
+  unsigned int i;
+
+  if (modifier == DRM_FORMAT_MOD_INVALID ||
+      modifier == DRM_FORMAT_MOD_LINEAR)
+    return FALSE;
+
+  for (i = 0; i < G_N_ELEMENTS (compressed_modifier_vendors); i++)
+    {
+      if (compressed_modifier_vendors[i].vendor == vendor)
+        return compressed_modifier_vendors[i].is_compressed (modifier);
+    }
+
+  return FALSE;
+}
+
+static gboolean
+test_compressed_modifiers (CoglOnscreen *onscreen,
+                           int           width,
+                           int           height,
+                           uint32_t      format,
+                           GArray       *compressed_modifiers)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaRendererNative *renderer_native = onscreen_native->renderer_native;
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+  MetaGpuKms *gpu_kms =
+    META_GPU_KMS (meta_crtc_get_gpu (onscreen_native->crtc));
+  MetaKmsDevice *kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
+  MetaRendererNativeGpuData *renderer_gpu_data;
+  MetaRenderDeviceGbm *render_device_gbm;
+  MetaDeviceFile *device_file;
+  g_autoptr (MetaDrmBufferGbm) buffer_gbm = NULL;
+  g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaKmsUpdate *test_update;
+  struct gbm_bo *gbm_bo;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+  gboolean passed;
+
+  renderer_gpu_data =
+    meta_renderer_native_get_gpu_data (renderer_native,
+                                       onscreen_native->render_gpu);
+  render_device_gbm = META_RENDER_DEVICE_GBM (renderer_gpu_data->render_device);
+  device_file =
+    meta_render_device_get_device_file (renderer_gpu_data->render_device);
+
+  gbm_bo =
+    gbm_bo_create_with_modifiers2 (meta_render_device_gbm_get_gbm_device (render_device_gbm),
+                                   width, height, format,
+                                   (uint64_t *) compressed_modifiers->data,
+                                   compressed_modifiers->len,
+                                   GBM_BO_USE_SCANOUT | GBM_BO_USE_RENDERING);
+  if (!gbm_bo)
+    return FALSE;
+
+  buffer_gbm = meta_drm_buffer_gbm_new_take (device_file, gbm_bo,
+                                             META_DRM_BUFFER_FLAG_NONE,
+                                             &error);
+  if (!buffer_gbm)
+    return FALSE;
+
+  src_rect = GRAPHENE_RECT_INIT (0, 0, width, height);
+  dst_rect = MTK_RECTANGLE_INIT (0, 0, width, height);
+
+  test_update = meta_kms_update_new (kms_device);
+  meta_onscreen_native_set_crtc_mode (onscreen, test_update,
+                                      renderer_gpu_data);
+  assign_primary_plane (crtc_kms,
+                        META_DRM_BUFFER (buffer_gbm),
+                        test_update,
+                        META_KMS_ASSIGN_PLANE_FLAG_NONE,
+                        &src_rect,
+                        &dst_rect);
+
+  kms_feedback =
+    meta_kms_device_process_update_sync (kms_device, test_update,
+                                         META_KMS_UPDATE_FLAG_TEST_ONLY);
+  passed = meta_kms_feedback_get_result (kms_feedback) ==
+           META_KMS_FEEDBACK_PASSED;
+
+  /* Without being DRM master nothing can be verified; the plane still
+   * advertised the modifiers, so trust it */
+  if (!passed &&
+      g_error_matches (meta_kms_feedback_get_error (kms_feedback),
+                       G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED))
+    return TRUE;
+
+  meta_topic (META_DEBUG_KMS,
+              "Compressed modifier 0x%" G_GINT64_MODIFIER "x for CRTC "
+              "%" G_GUINT64_FORMAT " %s test commit",
+              meta_drm_buffer_get_modifier (META_DRM_BUFFER (buffer_gbm)),
+              meta_crtc_get_id (onscreen_native->crtc),
+              passed ? "passed" : "failed");
+
+  return passed;
+}
+
+/*
+ * Compressed framebuffers need considerably less memory bandwidth to be
+ * scanned out, but GBM doesn't necessarily pick them when given a mixed
+ * list of modifiers. Only offer the compressed ones if the display
+ * controller accepts a buffer allocated with them, and otherwise leave
+ * them out so that the allocation doesn't end up with a layout that
+ * can't be scanned out.
+ */
+static GArray *
+rank_scanout_modifiers (CoglOnscreen *onscreen,
+                        int           width,
+                        int           height,
+                        uint32_t      format,
+                        GArray       *modifiers)
+{
+  g_autoptr (GArray) compressed_modifiers = NULL;
+  g_autoptr (GArray) other_modifiers = NULL;
+  unsigned int i;
+
+  compressed_modifiers = g_array_new (FALSE, FALSE, sizeof (uint64_t));
+  other_modifiers = g_array_new (FALSE, FALSE, sizeof (uint64_t));
+  for (i = 0; i < modifiers->len; i++)
+    {
+      uint64_t modifier = g_array_index (modifiers, uint64_t, i);
+
+      if (is_compressed_modifier (modifier))
+        g_array_append_val (compressed_modifiers, modifier);
+      else
+        g_array_append_val (other_modifiers, modifier);
+    }
+
+  if (compressed_modifiers->len == 0 || other_modifiers->len == 0)
+    return modifiers;
+
+  g_array_free (modifiers, TRUE);
+
+  if (test_compressed_modifiers (onscreen, width, height, format,
+                                 compressed_modifiers))
+    return g_steal_pointer (&compressed_modifiers);
+  else
+    return g_steal_pointer (&other_modifiers);
+}
+
 static GArray *
 get_supported_kms_formats (CoglOnscreen *onscreen)
 {
@@ -2079,6 +3265,7 @@ create_surfaces_gbm (CoglOnscreen        *onscreen,
   EGLConfig egl_config;
   uint32_t format;
   GArray *modifiers;
+  gboolean is_scanout_compatible = FALSE;
 
   renderer_gpu_data =
     meta_renderer_native_get_gpu_data (renderer_native,
@@ -2096,10 +3283,17 @@ create_surfaces_gbm (CoglOnscreen        *onscreen,
                                     egl_config);
 
   if (meta_renderer_native_use_modifiers (renderer_native))
-    modifiers = get_supported_modifiers (onscreen, format);
+    modifiers = get_supported_modifiers (onscreen, format,
+                                         &is_scanout_compatible);
   else
     modifiers = NULL;
 
+  if (modifiers && !onscreen_native->secondary_gpu_state)
+    {
+      modifiers = rank_scanout_modifiers (onscreen, width, height, format,
+                                          modifiers);
+    }
+
   if (modifiers)
     {
       new_gbm_surface =
@@ -2108,6 +3302,12 @@ create_surfaces_gbm (CoglOnscreen        *onscreen,
                                            (uint64_t *) modifiers->data,
                                            modifiers->len);
       g_array_free (modifiers, TRUE);
+
+      if (new_gbm_surface && onscreen_native->secondary_gpu_state)
+        {
+          onscreen_native->secondary_gpu_state->has_shared_modifiers =
+            is_scanout_compatible;
+        }
     }
 
   if (!new_gbm_surface)
@@ -2250,7 +3450,24 @@ meta_onscreen_native_set_view (CoglOnscreen     *onscreen,
                                MetaRendererView *view)
 {
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaRendererNativeGpuData *renderer_gpu_data;
+  ClutterFrameClock *frame_clock;
+  gboolean allow_triple_buffering;
+
   onscreen_native->view = view;
+
+  /* Copying to a secondary GPU cycles through only two buffers, so only
+   * queue an extra frame when scanning out what was rendered directly.
+   */
+  renderer_gpu_data =
+    meta_renderer_native_get_gpu_data (onscreen_native->renderer_native,
+                                       onscreen_native->render_gpu);
+  frame_clock = clutter_stage_view_get_frame_clock (CLUTTER_STAGE_VIEW (view));
+  allow_triple_buffering =
+    renderer_gpu_data->mode == META_RENDERER_NATIVE_MODE_GBM &&
+    !onscreen_native->secondary_gpu_state;
+  clutter_frame_clock_set_allow_triple_buffering (frame_clock,
+                                                  allow_triple_buffering);
 }
 
 static gboolean
@@ -2635,71 +3852,78 @@ on_hdr_metadata_changed (MetaOutput         *output,
   clutter_stage_view_schedule_update (stage_view);
 }
 
-MetaOnscreenNative *
-meta_onscreen_native_new (MetaRendererNative *renderer_native,
-                          MetaGpuKms         *render_gpu,
-                          MetaOutput         *output,
-                          MetaCrtc           *crtc,
-                          CoglContext        *cogl_context,
-                          int                 width,
-                          int                 height)
+static void
+connect_invalidation_handlers (MetaOnscreenNative *onscreen_native)
 {
-  MetaOnscreenNative *onscreen_native;
-  CoglFramebufferDriverConfig driver_config;
-
-  driver_config = (CoglFramebufferDriverConfig) {
-    .type = COGL_FRAMEBUFFER_DRIVER_TYPE_BACK,
-  };
-  onscreen_native = g_object_new (META_TYPE_ONSCREEN_NATIVE,
-                                  "context", cogl_context,
-                                  "driver-config", &driver_config,
-                                  "width", width,
-                                  "height", height,
-                                  NULL);
-
-  onscreen_native->renderer_native = renderer_native;
-  onscreen_native->render_gpu = render_gpu;
-
-  g_set_object (&onscreen_native->output, output);
-  g_set_object (&onscreen_native->crtc, crtc);
-
-  if (meta_crtc_get_gamma_lut_size (crtc) > 0)
+  if (meta_crtc_get_gamma_lut_size (onscreen_native->crtc) > 0)
     {
       onscreen_native->is_gamma_lut_invalid = TRUE;
       onscreen_native->gamma_lut_changed_handler_id =
-        g_signal_connect (crtc, "gamma-lut-changed",
+        g_signal_connect (onscreen_native->crtc, "gamma-lut-changed",
                           G_CALLBACK (on_gamma_lut_changed),
                           onscreen_native);
     }
 
-  if (meta_output_is_privacy_screen_supported (output))
+  if (meta_output_is_privacy_screen_supported (onscreen_native->output))
     {
       onscreen_native->is_privacy_screen_invalid = TRUE;
       onscreen_native->privacy_screen_changed_handler_id =
-        g_signal_connect (output, "notify::is-privacy-screen-enabled",
+        g_signal_connect (onscreen_native->output,
+                          "notify::is-privacy-screen-enabled",
                           G_CALLBACK (on_privacy_screen_enabled_changed),
                           onscreen_native);
     }
 
-  if (meta_output_is_color_space_supported (output,
+  if (meta_output_is_color_space_supported (onscreen_native->output,
                                             META_OUTPUT_COLORSPACE_DEFAULT))
     {
       onscreen_native->is_color_space_invalid = TRUE;
       onscreen_native->color_space_changed_handler_id =
-        g_signal_connect (output, "color-space-changed",
+        g_signal_connect (onscreen_native->output, "color-space-changed",
                           G_CALLBACK (on_color_space_changed),
                           onscreen_native);
     }
 
-  if (meta_output_is_hdr_metadata_supported (output,
+  if (meta_output_is_hdr_metadata_supported (onscreen_native->output,
                                              META_OUTPUT_HDR_METADATA_EOTF_TRADITIONAL_GAMMA_SDR))
     {
       onscreen_native->is_hdr_metadata_invalid = TRUE;
       onscreen_native->hdr_metadata_changed_handler_id =
-        g_signal_connect (output, "hdr-metadata-changed",
+        g_signal_connect (onscreen_native->output, "hdr-metadata-changed",
                           G_CALLBACK (on_hdr_metadata_changed),
                           onscreen_native);
     }
+}
+
+MetaOnscreenNative *
+meta_onscreen_native_new (MetaRendererNative *renderer_native,
+                          MetaGpuKms         *render_gpu,
+                          MetaOutput         *output,
+                          MetaCrtc           *crtc,
+                          CoglContext        *cogl_context,
+                          int                 width,
+                          int                 height)
+{
+  MetaOnscreenNative *onscreen_native;
+  CoglFramebufferDriverConfig driver_config;
+
+  driver_config = (CoglFramebufferDriverConfig) {
+    .type = COGL_FRAMEBUFFER_DRIVER_TYPE_BACK,
+  };
+  onscreen_native = g_object_new (META_TYPE_ONSCREEN_NATIVE,
+                                  "context", cogl_context,
+                                  "driver-config", &driver_config,
+                                  "width", width,
+                                  "height", height,
+                                  NULL);
+
+  onscreen_native->renderer_native = renderer_native;
+  onscreen_native->render_gpu = render_gpu;
+
+  g_set_object (&onscreen_native->output, output);
+  g_set_object (&onscreen_native->crtc, crtc);
+
+  connect_invalidation_handlers (onscreen_native);
 
   return onscreen_native;
 }
@@ -2736,6 +3960,9 @@ meta_onscreen_native_dispose (GObject *object)
     case META_RENDERER_NATIVE_MODE_GBM:
       g_clear_object (&onscreen_native->gbm.next_fb);
       g_clear_object (&onscreen_native->gbm.next_scanout);
+      g_clear_object (&onscreen_native->gbm.next_overlay_scanout);
+      g_clear_fd (&onscreen_native->gbm.next_sync_fd, NULL);
+      free_posted_bo (onscreen);
       free_current_bo (onscreen);
       break;
     case META_RENDERER_NATIVE_MODE_SURFACELESS:
@@ -2768,6 +3995,8 @@ meta_onscreen_native_dispose (GObject *object)
   g_clear_pointer (&onscreen_native->secondary_gpu_state,
                    secondary_gpu_state_free);
 
+  g_clear_object (&onscreen_native->overlay_scanout);
+  g_clear_pointer (&onscreen_native->plane_test_results, g_hash_table_unref);
   g_clear_object (&onscreen_native->output);
   g_clear_object (&onscreen_native->crtc);
 }
@@ -2775,6 +4004,10 @@ meta_onscreen_native_dispose (GObject *object)
 static void
 meta_onscreen_native_init (MetaOnscreenNative *onscreen_native)
 {
+  onscreen_native->gbm.next_sync_fd = -1;
+  onscreen_native->plane_test_results =
+    g_hash_table_new_full (plane_test_key_hash, plane_test_key_equal,
+                           NULL, g_free);
 }
 
 static void
@@ -2807,3 +4040,43 @@ meta_onscreen_native_detach (MetaOnscreenNative *onscreen_native)
   clear_invalidation_handlers (onscreen_native);
   onscreen_native->view = NULL;
 }
+
+/*
+ * Takes a detached onscreen back into use for a new view, if it was driving
+ * the same CRTC and output with the same size, so that its surfaces don't
+ * have to be allocated again. Onscreens with frames still in flight are
+ * not reused, as those frames belong to the view that was torn down.
+ */
+gboolean
+meta_onscreen_native_reattach (MetaOnscreenNative *onscreen_native,
+                               MetaGpuKms         *render_gpu,
+                               MetaOutput         *output,
+                               MetaCrtc           *crtc,
+                               int                 width,
+                               int                 height)
+{
+  CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen_native);
+  CoglOnscreen *onscreen = COGL_ONSCREEN (onscreen_native);
+
+  if (onscreen_native->view)
+    return FALSE;
+
+  if (onscreen_native->render_gpu != render_gpu ||
+      onscreen_native->output != output ||
+      onscreen_native->crtc != crtc)
+    return FALSE;
+
+  if (cogl_framebuffer_get_width (framebuffer) != width ||
+      cogl_framebuffer_get_height (framebuffer) != height)
+    return FALSE;
+
+  if (cogl_onscreen_peek_head_frame_info (onscreen) ||
+      onscreen_native->gbm.next_fb ||
+      onscreen_native->gbm.posted_fb)
+    return FALSE;
+
+  invalidate_plane_test_results (onscreen_native);
+  connect_invalidation_handlers (onscreen_native);
+
+  return TRUE;
+}
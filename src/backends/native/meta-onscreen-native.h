@@ -48,6 +48,12 @@ void meta_onscreen_native_dummy_power_save_page_flip (CoglOnscreen *onscreen);
 gboolean meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
                                                             CoglScanout  *scanout);
 
+gboolean meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                            CoglScanout  *scanout);
+
+void meta_onscreen_native_set_overlay_scanout (CoglOnscreen *onscreen,
+                                               CoglScanout  *scanout);
+
 void meta_onscreen_native_set_view (CoglOnscreen     *onscreen,
                                     MetaRendererView *view);
 
@@ -65,3 +71,10 @@ MetaCrtc * meta_onscreen_native_get_crtc (MetaOnscreenNative *onscreen_native);
 void meta_onscreen_native_invalidate (MetaOnscreenNative *onscreen_native);
 
 void meta_onscreen_native_detach (MetaOnscreenNative *onscreen_native);
+
+gboolean meta_onscreen_native_reattach (MetaOnscreenNative *onscreen_native,
+                                        MetaGpuKms         *render_gpu,
+                                        MetaOutput         *output,
+                                        MetaCrtc           *crtc,
+                                        int                 width,
+                                        int                 height);
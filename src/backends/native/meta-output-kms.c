@@ -428,6 +428,12 @@ meta_output_kms_new (MetaGpuKms        *gpu_kms,
 
   output_info->tile_info = connector_state->tile_info;
 
+  /* Tiled monitors are driven by multiple CRTCs that can't be kept in sync
+   * when their refresh cadence is driven by content.
+   */
+  output_info->supports_vrr = connector_state->vrr_capable &&
+                              !connector_state->tile_info.group_id;
+
   output = g_object_new (META_TYPE_OUTPUT_KMS,
                          "id", ((uint64_t) gpu_id << 32) | connector_id,
                          "gpu", gpu,
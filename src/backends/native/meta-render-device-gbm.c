@@ -27,11 +27,34 @@
 #include "backends/native/meta-drm-buffer-gbm.h"
 #include "backends/native/meta-drm-buffer-import.h"
 
+#define MAX_POOLED_DMA_BUFS 8
+#define POOLED_DMA_BUF_TRIM_INTERVAL_S 5
+
+typedef struct _PooledDmaBuf
+{
+  MetaDrmBuffer *buffer;
+
+  int width;
+  int height;
+  uint32_t format;
+  MetaDrmBufferFlags flags;
+
+  gboolean used_since_trim;
+} PooledDmaBuf;
+
 struct _MetaRenderDeviceGbm
 {
   MetaRenderDevice parent;
 
   struct gbm_device *gbm_device;
+
+  /* Allocated DMA buffers, kept around to be handed out again once their
+   * users released them, together with their FB IDs. */
+  GList *pooled_dma_bufs;
+  guint trim_pool_source_id;
+
+  GMemoryMonitor *memory_monitor;
+  gulong low_memory_warning_handler_id;
 };
 
 static GInitableIface *initable_parent_iface;
@@ -145,6 +168,137 @@ meta_render_device_gbm_create_egl_display (MetaRenderDevice  *render_device,
   return egl_display;
 }
 
+static void
+pooled_dma_buf_free (PooledDmaBuf *pooled_dma_buf)
+{
+  g_object_unref (pooled_dma_buf->buffer);
+  g_free (pooled_dma_buf);
+}
+
+static gboolean
+pooled_dma_buf_is_idle (PooledDmaBuf *pooled_dma_buf)
+{
+  /* The pool holds the last reference when nobody else uses the buffer */
+  return g_atomic_int_get (&G_OBJECT (pooled_dma_buf->buffer)->ref_count) == 1;
+}
+
+static void
+trim_dma_buf_pool (MetaRenderDeviceGbm *render_device_gbm,
+                   gboolean             trim_all)
+{
+  GList *l;
+
+  l = render_device_gbm->pooled_dma_bufs;
+  while (l)
+    {
+      PooledDmaBuf *pooled_dma_buf = l->data;
+      GList *l_next = l->next;
+
+      if (pooled_dma_buf_is_idle (pooled_dma_buf) &&
+          (trim_all || !pooled_dma_buf->used_since_trim))
+        {
+          render_device_gbm->pooled_dma_bufs =
+            g_list_delete_link (render_device_gbm->pooled_dma_bufs, l);
+          pooled_dma_buf_free (pooled_dma_buf);
+        }
+      else
+        {
+          pooled_dma_buf->used_since_trim = FALSE;
+        }
+
+      l = l_next;
+    }
+}
+
+static gboolean
+trim_dma_buf_pool_timeout (gpointer user_data)
+{
+  MetaRenderDeviceGbm *render_device_gbm = user_data;
+
+  trim_dma_buf_pool (render_device_gbm, FALSE);
+
+  if (!render_device_gbm->pooled_dma_bufs)
+    {
+      render_device_gbm->trim_pool_source_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+on_low_memory_warning (GMemoryMonitor             *memory_monitor,
+                       GMemoryMonitorWarningLevel  level,
+                       MetaRenderDeviceGbm        *render_device_gbm)
+{
+  trim_dma_buf_pool (render_device_gbm, TRUE);
+}
+
+static MetaDrmBuffer *
+take_pooled_dma_buf (MetaRenderDeviceGbm *render_device_gbm,
+                     int                  width,
+                     int                  height,
+                     uint32_t             format,
+                     MetaDrmBufferFlags   flags)
+{
+  GList *l;
+
+  for (l = render_device_gbm->pooled_dma_bufs; l; l = l->next)
+    {
+      PooledDmaBuf *pooled_dma_buf = l->data;
+
+      if (pooled_dma_buf->width == width &&
+          pooled_dma_buf->height == height &&
+          pooled_dma_buf->format == format &&
+          pooled_dma_buf->flags == flags &&
+          pooled_dma_buf_is_idle (pooled_dma_buf))
+        {
+          pooled_dma_buf->used_since_trim = TRUE;
+          return g_object_ref (pooled_dma_buf->buffer);
+        }
+    }
+
+  return NULL;
+}
+
+static void
+add_pooled_dma_buf (MetaRenderDeviceGbm *render_device_gbm,
+                    MetaDrmBuffer       *buffer,
+                    int                  width,
+                    int                  height,
+                    uint32_t             format,
+                    MetaDrmBufferFlags   flags)
+{
+  PooledDmaBuf *pooled_dma_buf;
+
+  if (g_list_length (render_device_gbm->pooled_dma_bufs) >=
+      MAX_POOLED_DMA_BUFS)
+    trim_dma_buf_pool (render_device_gbm, TRUE);
+
+  if (g_list_length (render_device_gbm->pooled_dma_bufs) >=
+      MAX_POOLED_DMA_BUFS)
+    return;
+
+  pooled_dma_buf = g_new0 (PooledDmaBuf, 1);
+  pooled_dma_buf->buffer = g_object_ref (buffer);
+  pooled_dma_buf->width = width;
+  pooled_dma_buf->height = height;
+  pooled_dma_buf->format = format;
+  pooled_dma_buf->flags = flags;
+  pooled_dma_buf->used_since_trim = TRUE;
+
+  render_device_gbm->pooled_dma_bufs =
+    g_list_prepend (render_device_gbm->pooled_dma_bufs, pooled_dma_buf);
+
+  if (!render_device_gbm->trim_pool_source_id)
+    {
+      render_device_gbm->trim_pool_source_id =
+        g_timeout_add_seconds (POOLED_DMA_BUF_TRIM_INTERVAL_S,
+                               trim_dma_buf_pool_timeout,
+                               render_device_gbm);
+    }
+}
+
 static MetaDrmBuffer *
 meta_render_device_gbm_allocate_dma_buf (MetaRenderDevice    *render_device,
                                          int                  width,
@@ -158,6 +312,12 @@ meta_render_device_gbm_allocate_dma_buf (MetaRenderDevice    *render_device,
   MetaDeviceFile *device_file;
   struct gbm_bo *gbm_bo;
   MetaDrmBufferGbm *buffer_gbm;
+  MetaDrmBuffer *buffer;
+
+  buffer = take_pooled_dma_buf (render_device_gbm,
+                                width, height, format, flags);
+  if (buffer)
+    return buffer;
 
   gbm_bo = gbm_bo_create (render_device_gbm->gbm_device,
                           width, height, format,
@@ -172,7 +332,14 @@ meta_render_device_gbm_allocate_dma_buf (MetaRenderDevice    *render_device,
   device_file = meta_render_device_get_device_file (render_device);
   buffer_gbm = meta_drm_buffer_gbm_new_take (device_file, gbm_bo, flags,
                                              error);
-  return META_DRM_BUFFER (buffer_gbm);
+  if (!buffer_gbm)
+    return NULL;
+
+  buffer = META_DRM_BUFFER (buffer_gbm);
+  add_pooled_dma_buf (render_device_gbm, buffer,
+                      width, height, format, flags);
+
+  return buffer;
 }
 
 static void
@@ -180,6 +347,13 @@ meta_render_device_gbm_finalize (GObject *object)
 {
   MetaRenderDeviceGbm *render_device_gbm = META_RENDER_DEVICE_GBM (object);
 
+  g_clear_signal_handler (&render_device_gbm->low_memory_warning_handler_id,
+                          render_device_gbm->memory_monitor);
+  g_clear_object (&render_device_gbm->memory_monitor);
+  g_clear_handle_id (&render_device_gbm->trim_pool_source_id, g_source_remove);
+  g_clear_list (&render_device_gbm->pooled_dma_bufs,
+                (GDestroyNotify) pooled_dma_buf_free);
+
   g_clear_pointer (&render_device_gbm->gbm_device, gbm_device_destroy);
 
   G_OBJECT_CLASS (meta_render_device_gbm_parent_class)->finalize (object);
@@ -204,6 +378,12 @@ meta_render_device_gbm_class_init (MetaRenderDeviceGbmClass *klass)
 static void
 meta_render_device_gbm_init (MetaRenderDeviceGbm *render_device_gbm)
 {
+  render_device_gbm->memory_monitor = g_memory_monitor_dup_default ();
+  render_device_gbm->low_memory_warning_handler_id =
+    g_signal_connect (render_device_gbm->memory_monitor,
+                      "low-memory-warning",
+                      G_CALLBACK (on_low_memory_warning),
+                      render_device_gbm);
 }
 
 MetaRenderDeviceGbm *
@@ -44,13 +44,27 @@
 #endif
 
 static void
-paint_egl_image (MetaGles3   *gles3,
-                 EGLImageKHR  egl_image,
-                 int          width,
-                 int          height)
+blit_framebuffer (MetaGles3 *gles3,
+                  int        width,
+                  int        height)
+{
+  GLBAS (gles3, glBlitFramebuffer, (0, height, width, 0,
+                                    0, 0, width, height,
+                                    GL_COLOR_BUFFER_BIT,
+                                    GL_NEAREST));
+}
+
+static void
+paint_egl_image (MetaGles3          *gles3,
+                 EGLImageKHR         egl_image,
+                 int                 width,
+                 int                 height,
+                 const MtkRectangle *rectangles,
+                 int                 n_rectangles)
 {
   GLuint texture;
   GLuint framebuffer;
+  int i;
 
   meta_gles3_clear_error (gles3);
 
@@ -76,23 +90,43 @@ paint_egl_image (MetaGles3   *gles3,
                                          GL_TEXTURE_2D, texture, 0));
 
   GLBAS (gles3, glBindFramebuffer, (GL_READ_FRAMEBUFFER, framebuffer));
-  GLBAS (gles3, glBlitFramebuffer, (0, height, width, 0,
-                                    0, 0, width, height,
-                                    GL_COLOR_BUFFER_BIT,
-                                    GL_NEAREST));
+
+  if (n_rectangles > 0)
+    {
+      /* The rectangles have a top-left origin, while the destination is
+       * bottom-left; the blit itself flips the image vertically. */
+      GLBAS (gles3, glEnable, (GL_SCISSOR_TEST));
+      for (i = 0; i < n_rectangles; i++)
+        {
+          const MtkRectangle *rect = &rectangles[i];
+
+          GLBAS (gles3, glScissor, (rect->x,
+                                    height - rect->y - rect->height,
+                                    rect->width,
+                                    rect->height));
+          blit_framebuffer (gles3, width, height);
+        }
+      GLBAS (gles3, glDisable, (GL_SCISSOR_TEST));
+    }
+  else
+    {
+      blit_framebuffer (gles3, width, height);
+    }
 
   GLBAS (gles3, glDeleteTextures, (1, &texture));
   GLBAS (gles3, glDeleteFramebuffers, (1, &framebuffer));
 }
 
 gboolean
-meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
-                                           MetaGles3      *gles3,
-                                           EGLDisplay      egl_display,
-                                           EGLContext      egl_context,
-                                           EGLSurface      egl_surface,
-                                           struct gbm_bo  *shared_bo,
-                                           GError        **error)
+meta_renderer_native_gles3_blit_shared_bo (MetaEgl             *egl,
+                                           MetaGles3           *gles3,
+                                           EGLDisplay           egl_display,
+                                           EGLContext           egl_context,
+                                           EGLSurface           egl_surface,
+                                           struct gbm_bo       *shared_bo,
+                                           const MtkRectangle  *rectangles,
+                                           int                  n_rectangles,
+                                           GError             **error)
 {
   int shared_bo_fd;
   unsigned int width;
@@ -150,7 +184,8 @@ meta_renderer_native_gles3_blit_shared_bo (MetaEgl        *egl,
   if (!egl_image)
     return FALSE;
 
-  paint_egl_image (gles3, egl_image, width, height);
+  paint_egl_image (gles3, egl_image, width, height,
+                   rectangles, n_rectangles);
 
   meta_egl_destroy_image (egl, egl_display, egl_image, NULL);
 
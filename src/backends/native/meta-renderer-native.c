@@ -1193,6 +1193,7 @@ meta_renderer_native_pop_pending_mode_set (MetaRendererNative *renderer_native,
 
 static CoglOffscreen *
 meta_renderer_native_create_offscreen (MetaRendererNative    *renderer_native,
+                                       CoglPixelFormat        format,
                                        gint                   view_width,
                                        gint                   view_height,
                                        GError               **error)
@@ -1202,7 +1203,9 @@ meta_renderer_native_create_offscreen (MetaRendererNative    *renderer_native,
   CoglOffscreen *fb;
   CoglTexture *tex;
 
-  tex = cogl_texture_2d_new_with_size (cogl_context, view_width, view_height);
+  tex = cogl_texture_2d_new_with_format (cogl_context,
+                                         view_width, view_height,
+                                         format);
   cogl_primitive_texture_set_auto_mipmap (tex, FALSE);
 
   if (!cogl_texture_allocate (tex, error))
@@ -1299,6 +1302,22 @@ should_force_shadow_fb (MetaRendererNative *renderer_native,
   return meta_kms_device_prefers_shadow_buffer (kms_device);
 }
 
+static CoglPixelFormat
+get_view_offscreen_format (MetaRendererNative *renderer_native,
+                           MetaOutput         *output)
+{
+  CoglContext *cogl_context =
+    cogl_context_from_renderer_native (renderer_native);
+
+  /* HDR content doesn't fit in 8 bits per component. Half floats keep the
+   * intermediate framebuffers precise at half the bandwidth of floats. */
+  if (meta_output_peek_color_space (output) == META_OUTPUT_COLORSPACE_BT2020 &&
+      cogl_has_feature (cogl_context, COGL_FEATURE_ID_TEXTURE_HALF_FLOAT))
+    return COGL_PIXEL_FORMAT_RGBA_FP_16161616_PRE;
+
+  return COGL_PIXEL_FORMAT_ANY;
+}
+
 static CoglFramebuffer *
 create_fallback_offscreen (MetaRendererNative *renderer_native,
                            int                 width,
@@ -1308,6 +1327,7 @@ create_fallback_offscreen (MetaRendererNative *renderer_native,
   GError *error = NULL;
 
   fallback_offscreen = meta_renderer_native_create_offscreen (renderer_native,
+                                                              COGL_PIXEL_FORMAT_ANY,
                                                               width,
                                                               height,
                                                               &error);
@@ -1320,6 +1340,41 @@ create_fallback_offscreen (MetaRendererNative *renderer_native,
   return COGL_FRAMEBUFFER (fallback_offscreen);
 }
 
+static CoglFramebuffer *
+take_detached_onscreen (MetaRendererNative *renderer_native,
+                        MetaOutput         *output,
+                        MetaCrtc           *crtc,
+                        int                 width,
+                        int                 height)
+{
+  GList *l;
+
+  for (l = renderer_native->detached_onscreens; l; l = l->next)
+    {
+      MetaOnscreenNative *onscreen_native;
+
+      if (!META_IS_ONSCREEN_NATIVE (l->data))
+        continue;
+
+      onscreen_native = META_ONSCREEN_NATIVE (l->data);
+      if (!meta_onscreen_native_reattach (onscreen_native,
+                                          renderer_native->primary_gpu_kms,
+                                          output, crtc,
+                                          width, height))
+        continue;
+
+      meta_topic (META_DEBUG_RENDER,
+                  "Reusing onscreen of CRTC %" G_GUINT64_FORMAT " for new view",
+                  meta_crtc_get_id (crtc));
+
+      renderer_native->detached_onscreens =
+        g_list_delete_link (renderer_native->detached_onscreens, l);
+      return COGL_FRAMEBUFFER (onscreen_native);
+    }
+
+  return NULL;
+}
+
 static MetaRendererView *
 meta_renderer_native_create_view (MetaRenderer       *renderer,
                                   MetaLogicalMonitor *logical_monitor,
@@ -1339,6 +1394,7 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
   g_autoptr (CoglFramebuffer) framebuffer = NULL;
   g_autoptr (CoglOffscreen) offscreen = NULL;
   gboolean use_shadowfb;
+  CoglPixelFormat offscreen_format;
   float scale;
   int onscreen_width;
   int onscreen_height;
@@ -1369,6 +1425,16 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
                                                    onscreen_width,
                                                    onscreen_height);
         }
+      else if ((framebuffer = take_detached_onscreen (renderer_native,
+                                                      output,
+                                                      crtc,
+                                                      onscreen_width,
+                                                      onscreen_height)))
+        {
+          use_shadowfb =
+            should_force_shadow_fb (renderer_native,
+                                    renderer_native->primary_gpu_kms);
+        }
       else
         {
           MetaGpuKms *primary_gpu_kms = renderer_native->primary_gpu_kms;
@@ -1407,6 +1473,7 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
       g_assert (META_IS_CRTC_VIRTUAL (crtc));
 
       virtual_onscreen = meta_renderer_native_create_offscreen (renderer_native,
+                                                                COGL_PIXEL_FORMAT_ANY,
                                                                 onscreen_width,
                                                                 onscreen_height,
                                                                 &error);
@@ -1416,6 +1483,8 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
       framebuffer = COGL_FRAMEBUFFER (virtual_onscreen);
     }
 
+  offscreen_format = get_view_offscreen_format (renderer_native, output);
+
   view_transform = calculate_view_transform (monitor_manager,
                                              logical_monitor,
                                              output,
@@ -1437,9 +1506,23 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
         }
 
       offscreen = meta_renderer_native_create_offscreen (renderer_native,
+                                                         offscreen_format,
                                                          offscreen_width,
                                                          offscreen_height,
                                                          &error);
+      if (!offscreen && offscreen_format != COGL_PIXEL_FORMAT_ANY)
+        {
+          g_warning ("Failed to allocate half float back buffer texture: %s",
+                     error->message);
+          g_clear_error (&error);
+
+          offscreen_format = COGL_PIXEL_FORMAT_ANY;
+          offscreen = meta_renderer_native_create_offscreen (renderer_native,
+                                                             offscreen_format,
+                                                             offscreen_width,
+                                                             offscreen_height,
+                                                             &error);
+        }
       if (!offscreen)
         g_error ("Failed to allocate back buffer texture: %s", error->message);
     }
@@ -1461,11 +1544,14 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
                               "framebuffer", framebuffer,
                               "offscreen", offscreen,
                               "use-shadowfb", use_shadowfb,
+                              "offscreen-format", offscreen_format,
                               "transform", view_transform,
                               "refresh-rate", crtc_mode_info->refresh_rate,
                               "vblank-duration-us", crtc_mode_info->vblank_duration_us,
                               NULL);
 
+  init_view_vrr (renderer_native, META_RENDERER_VIEW (view_native), output);
+
   if (META_IS_ONSCREEN_NATIVE (framebuffer))
     {
       CoglDisplayEGL *cogl_display_egl;
@@ -1487,6 +1573,61 @@ meta_renderer_native_create_view (MetaRenderer       *renderer,
   return META_RENDERER_VIEW (view_native);
 }
 
+static MetaRendererViewVrrPolicy
+calculate_vrr_policy (MetaRendererNative *renderer_native,
+                      MetaCrtc           *crtc)
+{
+  MetaRenderer *renderer = META_RENDERER (renderer_native);
+  MetaBackend *backend = meta_renderer_get_backend (renderer);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+  MetaKmsCrtc *kms_crtc;
+  const GList *l;
+
+  if (!meta_settings_is_experimental_feature_enabled (
+        settings, META_EXPERIMENTAL_FEATURE_VARIABLE_REFRESH_RATE))
+    return META_RENDERER_VIEW_VRR_POLICY_NEVER;
+
+  if (!META_IS_CRTC_KMS (crtc))
+    return META_RENDERER_VIEW_VRR_POLICY_NEVER;
+
+  kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (crtc));
+  if (!meta_kms_crtc_is_vrr_supported (kms_crtc))
+    return META_RENDERER_VIEW_VRR_POLICY_NEVER;
+
+  for (l = meta_crtc_get_outputs (crtc); l; l = l->next)
+    {
+      MetaOutput *output = l->data;
+
+      if (!meta_output_get_info (output)->supports_vrr)
+        return META_RENDERER_VIEW_VRR_POLICY_NEVER;
+    }
+
+  return META_RENDERER_VIEW_VRR_POLICY_FULLSCREEN;
+}
+
+static void
+init_view_vrr (MetaRendererNative *renderer_native,
+               MetaRendererView   *view,
+               MetaOutput         *output)
+{
+  ClutterStageView *stage_view = CLUTTER_STAGE_VIEW (view);
+  ClutterFrameClock *frame_clock =
+    clutter_stage_view_get_frame_clock (stage_view);
+  MetaCrtc *crtc = meta_renderer_view_get_crtc (view);
+  int max_refresh_rate;
+
+  if (meta_output_info_get_max_refresh_rate (meta_output_get_info (output),
+                                             &max_refresh_rate))
+    {
+      clutter_frame_clock_set_max_variable_refresh_rate (frame_clock,
+                                                         max_refresh_rate);
+    }
+
+  meta_renderer_view_set_vrr_policy (view,
+                                     calculate_vrr_policy (renderer_native,
+                                                           crtc));
+}
+
 static void
 detach_onscreens (MetaRenderer *renderer)
 {
@@ -1856,6 +1997,10 @@ init_secondary_gpu_data_gpu (MetaRendererNativeGpuData *renderer_gpu_data,
     meta_egl_has_extensions (egl, egl_display, NULL,
                              "EGL_EXT_image_dma_buf_import_modifiers",
                              NULL);
+  renderer_gpu_data->secondary.has_EGL_EXT_buffer_age =
+    meta_egl_has_extensions (egl, egl_display, NULL,
+                             "EGL_EXT_buffer_age",
+                             NULL);
   ret = TRUE;
 out:
   maybe_restore_cogl_egl_api (renderer_native);
@@ -2370,6 +2515,25 @@ meta_renderer_native_finalize (GObject *object)
   G_OBJECT_CLASS (meta_renderer_native_parent_class)->finalize (object);
 }
 
+static void
+on_experimental_features_changed (MetaSettings            *settings,
+                                  MetaExperimentalFeature  old_experimental_features,
+                                  MetaRendererNative      *renderer_native)
+{
+  MetaRenderer *renderer = META_RENDERER (renderer_native);
+  GList *l;
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      MetaRendererView *view = l->data;
+      MetaCrtc *crtc = meta_renderer_view_get_crtc (view);
+
+      meta_renderer_view_set_vrr_policy (view,
+                                         calculate_vrr_policy (renderer_native,
+                                                               crtc));
+    }
+}
+
 static void
 meta_renderer_native_constructed (GObject *object)
 {
@@ -2388,6 +2552,9 @@ meta_renderer_native_constructed (GObject *object)
                     G_CALLBACK (on_gpu_added), renderer_native);
   g_signal_connect (monitor_manager, "power-save-mode-changed",
                     G_CALLBACK (on_power_save_mode_changed), renderer_native);
+  g_signal_connect_object (settings, "experimental-features-changed",
+                           G_CALLBACK (on_experimental_features_changed),
+                           renderer_native, 0);
 
   G_OBJECT_CLASS (meta_renderer_native_parent_class)->constructed (object);
 }
@@ -145,6 +145,20 @@ meta_seat_impl_run_input_task (MetaSeatImpl *seat_impl,
   g_source_unref (source);
 }
 
+void
+meta_seat_impl_publish_modifier_state_in_impl (MetaSeatImpl *seat_impl)
+{
+  xkb_mod_mask_t xkb_mods = 0;
+
+  if (seat_impl->xkb)
+    xkb_mods = xkb_state_serialize_mods (seat_impl->xkb,
+                                         XKB_STATE_MODS_EFFECTIVE);
+
+  g_atomic_int_set (&seat_impl->published_xkb_mods, xkb_mods);
+  g_atomic_int_set (&seat_impl->published_button_state,
+                    seat_impl->button_state);
+}
+
 void
 meta_seat_impl_sync_leds_in_impl (MetaSeatImpl *seat_impl)
 {
@@ -436,6 +450,8 @@ meta_seat_impl_notify_key_in_impl (MetaSeatImpl       *seat_impl,
     {
       changed_state = xkb_state_update_key (seat_impl->xkb, keycode,
                                             state ? XKB_KEY_DOWN : XKB_KEY_UP);
+      if (changed_state & XKB_STATE_MODS_EFFECTIVE)
+        meta_seat_impl_publish_modifier_state_in_impl (seat_impl);
     }
 
   if (!meta_input_device_native_process_kbd_a11y_event_in_impl (seat_impl->core_keyboard,
@@ -858,6 +874,8 @@ meta_seat_impl_notify_button_in_impl (MetaSeatImpl       *seat_impl,
         seat_impl->button_state |= maskmap[button_nr - 1];
       else
         seat_impl->button_state &= ~maskmap[button_nr - 1];
+
+      meta_seat_impl_publish_modifier_state_in_impl (seat_impl);
     }
 
   if (clutter_input_device_get_device_type (input_device) == CLUTTER_TABLET_DEVICE)
@@ -2786,6 +2804,7 @@ meta_seat_impl_set_keyboard_numlock_in_impl (MetaSeatImpl *seat_impl,
                          locked_mods,
                          0, 0,
                          group_mods);
+  meta_seat_impl_publish_modifier_state_in_impl (seat_impl);
 
   meta_seat_impl_sync_leds_in_impl (seat_impl);
   meta_keymap_native_update_in_impl (seat_impl->keymap,
@@ -3081,6 +3100,7 @@ destroy_in_impl (GTask *task)
                                                 numlock_active);
 
   g_clear_pointer (&seat_impl->xkb, xkb_state_unref);
+  meta_seat_impl_publish_modifier_state_in_impl (seat_impl);
 
   meta_seat_impl_clear_repeat_source (seat_impl);
 
@@ -3245,7 +3265,23 @@ meta_seat_impl_query_state (MetaSeatImpl         *seat_impl,
 {
   MetaInputDeviceNative *device_native = META_INPUT_DEVICE_NATIVE (device);
   gboolean retval = FALSE;
-  ClutterModifierType mods = 0;
+  ClutterModifierType mods;
+
+  mods = g_atomic_int_get (&seat_impl->published_xkb_mods);
+
+  if (!sequence)
+    {
+      mods |= g_atomic_int_get (&seat_impl->published_button_state);
+
+      /* The modifier state is published separately, so querying only that
+       * doesn't need to take the state lock */
+      if (!coords)
+        {
+          if (modifiers)
+            *modifiers = mods;
+          return TRUE;
+        }
+    }
 
   g_rw_lock_reader_lock (&seat_impl->state_lock);
 
@@ -3265,24 +3301,12 @@ meta_seat_impl_query_state (MetaSeatImpl         *seat_impl,
           coords->y = touch_state->coords.y;
         }
 
-      if (seat_impl->xkb)
-        mods = meta_xkb_translate_modifiers (seat_impl->xkb, 0);
-
       retval = TRUE;
     }
   else
     {
-      if (coords)
-        {
-          coords->x = device_native->pointer_x;
-          coords->y = device_native->pointer_y;
-        }
-
-      if (seat_impl->xkb)
-        {
-          mods = meta_xkb_translate_modifiers (seat_impl->xkb,
-                                               seat_impl->button_state);
-        }
+      coords->x = device_native->pointer_x;
+      coords->y = device_native->pointer_y;
 
       retval = TRUE;
     }
@@ -3417,6 +3441,7 @@ meta_seat_impl_update_xkb_state_in_impl (MetaSeatImpl *seat_impl)
                          latched_mods,
                          locked_mods,
                          0, 0, seat_impl->layout_idx);
+  meta_seat_impl_publish_modifier_state_in_impl (seat_impl);
 
   seat_impl->caps_lock_led =
     xkb_keymap_led_get_index (xkb_keymap, XKB_LED_NAME_CAPS);
@@ -3589,6 +3614,7 @@ set_keyboard_layout_index (GTask *task)
   locked_mods = xkb_state_serialize_mods (state, XKB_STATE_MODS_LOCKED);
 
   xkb_state_update_mask (state, depressed_mods, latched_mods, locked_mods, 0, 0, idx);
+  meta_seat_impl_publish_modifier_state_in_impl (seat_impl);
   meta_keymap_native_update_in_impl (seat_impl->keymap,
                                      seat_impl,
                                      seat_impl->xkb);
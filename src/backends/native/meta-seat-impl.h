@@ -88,6 +88,13 @@ struct _MetaSeatImpl
   uint32_t button_state;
   int button_count[KEY_CNT];
 
+  /* Copies of the effective xkb modifiers and of button_state, published
+   * with atomic stores whenever they change, so that querying the modifier
+   * state never has to wait for, or read the xkb state of, the input
+   * thread. */
+  int published_xkb_mods;
+  int published_button_state;
+
   MetaBarrierManagerNative *barrier_manager;
   MetaPointerConstraintImpl *pointer_constraint;
 
@@ -193,6 +200,8 @@ void meta_seat_impl_notify_touch_event_in_impl (MetaSeatImpl       *seat_impl,
 
 void meta_seat_impl_sync_leds_in_impl (MetaSeatImpl *seat_impl);
 
+void meta_seat_impl_publish_modifier_state_in_impl (MetaSeatImpl *seat_impl);
+
 MetaTouchState * meta_seat_impl_acquire_touch_state_in_impl (MetaSeatImpl *seat_impl,
                                                              int           seat_slot);
 MetaTouchState * meta_seat_impl_lookup_touch_state_in_impl (MetaSeatImpl *seat_impl,
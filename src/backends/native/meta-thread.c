@@ -59,7 +59,15 @@ typedef struct _MetaThreadCallbackSource
 
   MetaThread *thread;
   GMainContext *main_context;
-  GList *callbacks;
+
+  /* Queued MetaThreadCallbackData, protected by the callbacks mutex. The
+   * array being dispatched is handed back as the spare one, so queuing
+   * callbacks doesn't allocate once the arrays have grown large enough.
+   */
+  GArray *callbacks;
+  GArray *spare_callbacks;
+  int has_callbacks;
+
   gboolean needs_flush;
 } MetaThreadCallbackSource;
 
@@ -107,11 +115,10 @@ G_DEFINE_TYPE_WITH_CODE (MetaThread, meta_thread, G_TYPE_OBJECT,
                                                    sizeof (MetaThreadClassPrivate)))
 
 static void
-meta_thread_callback_data_free (MetaThreadCallbackData *callback_data)
+meta_thread_callback_data_clear (MetaThreadCallbackData *callback_data)
 {
   if (callback_data->user_data_destroy)
     callback_data->user_data_destroy (callback_data->user_data);
-  g_free (callback_data);
 }
 
 static void
@@ -788,23 +795,63 @@ meta_thread_reset_thread_type (MetaThread     *thread,
     }
 }
 
+/* Must be called with the callbacks mutex held */
+static GArray *
+steal_callbacks (MetaThreadCallbackSource *callback_source)
+{
+  GArray *pending_callbacks;
+
+  if (callback_source->callbacks->len == 0)
+    return NULL;
+
+  pending_callbacks = callback_source->callbacks;
+  callback_source->callbacks = g_steal_pointer (&callback_source->spare_callbacks);
+  if (!callback_source->callbacks)
+    {
+      callback_source->callbacks =
+        g_array_sized_new (FALSE, FALSE, sizeof (MetaThreadCallbackData),
+                           pending_callbacks->len);
+    }
+  g_atomic_int_set (&callback_source->has_callbacks, FALSE);
+
+  return pending_callbacks;
+}
+
+/* Must be called with the callbacks mutex held */
+static void
+recycle_callbacks (MetaThreadCallbackSource *callback_source,
+                   GArray                   *pending_callbacks)
+{
+  if (!pending_callbacks)
+    return;
+
+  g_array_set_size (pending_callbacks, 0);
+
+  if (!callback_source->spare_callbacks)
+    callback_source->spare_callbacks = pending_callbacks;
+  else
+    g_array_unref (pending_callbacks);
+}
+
 static int
 dispatch_callbacks (MetaThread *thread,
-                    GList      *pending_callbacks)
+                    GArray     *pending_callbacks)
 {
-  int callback_count = 0;
-  GList *l;
+  unsigned int i;
 
-  for (l = pending_callbacks; l; l = l->next)
+  if (!pending_callbacks)
+    return 0;
+
+  for (i = 0; i < pending_callbacks->len; i++)
     {
-      MetaThreadCallbackData *callback_data = l->data;
+      MetaThreadCallbackData *callback_data =
+        &g_array_index (pending_callbacks, MetaThreadCallbackData, i);
 
       callback_data->callback (thread, callback_data->user_data);
-      meta_thread_callback_data_free (callback_data);
-      callback_count++;
+      meta_thread_callback_data_clear (callback_data);
     }
 
-  return callback_count;
+  return pending_callbacks->len;
 }
 
 void
@@ -813,7 +860,7 @@ meta_thread_dispatch_callbacks (MetaThread   *thread,
 {
   MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
   MetaThreadCallbackSource *callback_source;
-  g_autoptr (GList) pending_callbacks = NULL;
+  GArray *pending_callbacks;
 
   if (!main_context)
     main_context = g_main_context_default ();
@@ -822,11 +869,19 @@ meta_thread_dispatch_callbacks (MetaThread   *thread,
 
   g_assert (callback_source->main_context == main_context);
 
+  g_source_ref (&callback_source->base);
+
   g_mutex_lock (&priv->callbacks_mutex);
-  pending_callbacks = g_steal_pointer (&callback_source->callbacks);
+  pending_callbacks = steal_callbacks (callback_source);
   g_mutex_unlock (&priv->callbacks_mutex);
 
   dispatch_callbacks (thread, pending_callbacks);
+
+  g_mutex_lock (&priv->callbacks_mutex);
+  recycle_callbacks (callback_source, pending_callbacks);
+  g_mutex_unlock (&priv->callbacks_mutex);
+
+  g_source_unref (&callback_source->base);
 }
 
 void
@@ -857,26 +912,39 @@ meta_thread_flush_callbacks (MetaThread *thread)
 
   while (TRUE)
     {
-      g_autoptr (GList) pending_callbacks = NULL;
+      GArray *pending_callbacks[2] = { NULL, NULL };
       gboolean needs_reflush = FALSE;
       int i;
 
+      g_assert (main_thread_sources->len <= G_N_ELEMENTS (pending_callbacks));
+
       g_mutex_lock (&priv->callbacks_mutex);
       for (i = 0; i < main_thread_sources->len; i++)
         {
           MetaThreadCallbackSource *source =
             g_ptr_array_index (main_thread_sources, i);
 
-          pending_callbacks =
-            g_list_concat (pending_callbacks,
-                           g_steal_pointer (&source->callbacks));
+          pending_callbacks[i] = steal_callbacks (source);
         }
 
       callback_sources = g_hash_table_get_values (priv->callback_sources);
       g_mutex_unlock (&priv->callbacks_mutex);
 
-      if (dispatch_callbacks (thread, pending_callbacks) > 0)
-        needs_reflush = TRUE;
+      for (i = 0; i < main_thread_sources->len; i++)
+        {
+          if (dispatch_callbacks (thread, pending_callbacks[i]) > 0)
+            needs_reflush = TRUE;
+        }
+
+      g_mutex_lock (&priv->callbacks_mutex);
+      for (i = 0; i < main_thread_sources->len; i++)
+        {
+          MetaThreadCallbackSource *source =
+            g_ptr_array_index (main_thread_sources, i);
+
+          recycle_callbacks (source, pending_callbacks[i]);
+        }
+      g_mutex_unlock (&priv->callbacks_mutex);
 
       g_list_foreach (callback_sources, (GFunc) g_source_ref, NULL);
       for (l = callback_sources; l; l = l->next)
@@ -907,17 +975,10 @@ callback_source_prepare (GSource *source,
 {
   MetaThreadCallbackSource *callback_source =
     (MetaThreadCallbackSource *) source;
-  MetaThread *thread = callback_source->thread;
-  MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
-  gboolean retval;
 
   *timeout = -1;
 
-  g_mutex_lock (&priv->callbacks_mutex);
-  retval = !!callback_source->callbacks;
-  g_mutex_unlock (&priv->callbacks_mutex);
-
-  return retval;
+  return g_atomic_int_get (&callback_source->has_callbacks);
 }
 
 static gboolean
@@ -929,17 +990,19 @@ callback_source_dispatch (GSource     *source,
     (MetaThreadCallbackSource *) source;
   MetaThread *thread = callback_source->thread;
   MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
-  g_autoptr (GList) pending_callbacks = NULL;
+  GArray *pending_callbacks;
 
   g_mutex_lock (&priv->callbacks_mutex);
-  pending_callbacks = g_steal_pointer (&callback_source->callbacks);
+  pending_callbacks = steal_callbacks (callback_source);
   g_mutex_unlock (&priv->callbacks_mutex);
 
   dispatch_callbacks (thread, pending_callbacks);
 
   g_mutex_lock (&priv->callbacks_mutex);
 
-  if (callback_source->callbacks)
+  recycle_callbacks (callback_source, pending_callbacks);
+
+  if (callback_source->callbacks->len > 0)
     {
       g_source_set_ready_time (source, 0);
     }
@@ -963,9 +1026,16 @@ callback_source_finalize (GSource *source)
 {
   MetaThreadCallbackSource *callback_source =
     (MetaThreadCallbackSource *) source;
+  unsigned int i;
 
-  g_list_free_full (callback_source->callbacks,
-                    (GDestroyNotify) meta_thread_callback_data_free);
+  for (i = 0; i < callback_source->callbacks->len; i++)
+    {
+      meta_thread_callback_data_clear (&g_array_index (callback_source->callbacks,
+                                                       MetaThreadCallbackData,
+                                                       i));
+    }
+  g_array_unref (callback_source->callbacks);
+  g_clear_pointer (&callback_source->spare_callbacks, g_array_unref);
 
   g_cond_clear (&callback_source->cond);
   g_mutex_clear (&callback_source->mutex);
@@ -996,6 +1066,8 @@ meta_thread_register_callback_context (MetaThread   *thread,
   g_cond_init (&callback_source->cond);
   callback_source->thread = thread;
   callback_source->main_context = main_context;
+  callback_source->callbacks =
+    g_array_new (FALSE, FALSE, sizeof (MetaThreadCallbackData));
 
   g_source_set_ready_time (&callback_source->base, -1);
   g_source_set_priority (source, G_PRIORITY_HIGH + 1);
@@ -1032,7 +1104,8 @@ meta_thread_queue_callback (MetaThread         *thread,
   MetaThreadPrivate *priv = meta_thread_get_instance_private (thread);
   g_autoptr (GMutexLocker) locker;
   MetaThreadCallbackSource *callback_source;
-  MetaThreadCallbackData *callback_data;
+  MetaThreadCallbackData callback_data;
+  gboolean was_empty;
 
   if (!main_context)
     main_context = g_main_context_default ();
@@ -1042,8 +1115,7 @@ meta_thread_queue_callback (MetaThread         *thread,
   callback_source = g_hash_table_lookup (priv->callback_sources, main_context);
   g_return_if_fail (callback_source);
 
-  callback_data = g_new0 (MetaThreadCallbackData, 1);
-  *callback_data = (MetaThreadCallbackData) {
+  callback_data = (MetaThreadCallbackData) {
     .callback = callback ? callback : no_op_callback,
     .user_data = user_data,
     .user_data_destroy = user_data_destroy,
@@ -1051,9 +1123,12 @@ meta_thread_queue_callback (MetaThread         *thread,
 
   g_mutex_lock (&callback_source->mutex);
   callback_source->needs_flush = TRUE;
-  callback_source->callbacks = g_list_append (callback_source->callbacks,
-                                              callback_data);
-  g_source_set_ready_time (&callback_source->base, 0);
+  was_empty = callback_source->callbacks->len == 0;
+  g_array_append_val (callback_source->callbacks, callback_data);
+  g_atomic_int_set (&callback_source->has_callbacks, TRUE);
+  /* Only the first queued callback needs to wake up the context */
+  if (was_empty)
+    g_source_set_ready_time (&callback_source->base, 0);
   g_mutex_unlock (&callback_source->mutex);
 }
 
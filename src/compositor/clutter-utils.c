@@ -63,6 +63,22 @@ round_to_fixed (float x)
 #define MTX_GL_SCALE_X(x,w,v1,v2) ((((((x) / (w)) + 1.0f) / 2.0f) * (v1)) + (v2))
 #define MTX_GL_SCALE_Y(y,w,v1,v2) ((v1) - (((((y) / (w)) + 1.0f) / 2.0f) * (v1)) + (v2))
 
+/* Whether a box of @painted fixed point pixels maps every pixel to exactly
+ * one of @sampled texels when sampling with nearest-pixel interpolation.
+ *
+ * With fractional scaling, clients are expected to allocate buffers of
+ * round (logical size * scale) pixels, so the painted size can be off by up
+ * to half a pixel from the buffer size. As long as the accumulated error
+ * stays below half a pixel, pixel centers still land on the texel they
+ * correspond to, so there is nothing to gain from filtering.
+ */
+static inline gboolean
+is_pixel_exact_size (int painted,
+                     int sampled)
+{
+  return ABS (painted - sampled) <= FIXED_ONE / 2;
+}
+
 /* This helper function checks if (according to our fixed point precision)
  * the vertices @verts form a box of width @widthf and height @heightf
  * located at integral coordinates. These coordinates are returned
@@ -105,7 +121,8 @@ meta_actor_vertices_are_untransformed (graphene_point3d_t *verts,
     return FALSE;
 
   /* Not scaled? */
-  if (v1x - v0x != width || v2y - v0y != height)
+  if (!is_pixel_exact_size (v1x - v0x, width) ||
+      !is_pixel_exact_size (v2y - v0y, height))
     return FALSE;
 
   /* Not rotated/skewed? */
@@ -58,6 +58,7 @@
 #include "cogl/cogl.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-later-private.h"
+#include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-window-actor-private.h"
 #include "compositor/meta-window-group-private.h"
 #include "core/frame.h"
@@ -127,6 +128,9 @@ typedef struct _MetaCompositorPrivate
 
   GList *windows;
 
+  GHashTable *pending_geometry_syncs;
+  unsigned int sync_geometry_later_id;
+
   CoglContext *context;
 
   gboolean needs_update_top_window_actors;
@@ -140,6 +144,18 @@ typedef struct _MetaCompositorPrivate
 
   gboolean frame_in_progress;
 
+  gboolean prewarm_queued;
+  unsigned int prewarm_later_id;
+
+  GMemoryMonitor *memory_monitor;
+  gulong low_memory_warning_handler_id;
+
+  /* The unobscured regions are only valid for the stage as it was at the
+   * time they were culled */
+  gboolean has_culled_unobscured;
+  uint64_t culled_unobscured_damage_serial;
+  MtkRectangle culled_unobscured_stage_rect;
+
   MetaPluginManager *plugin_mgr;
 
   MetaWindowDrag *current_drag;
@@ -164,6 +180,10 @@ on_top_window_actor_destroyed (MetaWindowActor *window_actor,
 
 static void sync_actor_stacking (MetaCompositor *compositor);
 
+static void sync_window_actor_geometry (MetaCompositor  *compositor,
+                                        MetaWindowActor *window_actor,
+                                        gboolean         did_placement);
+
 static void
 meta_finish_workspace_switch (MetaCompositor *compositor)
 {
@@ -444,6 +464,12 @@ void
 meta_compositor_remove_window (MetaCompositor *compositor,
                                MetaWindow     *window)
 {
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  g_hash_table_remove (priv->pending_geometry_syncs,
+                       meta_window_actor_from_window (window));
+
   META_COMPOSITOR_GET_CLASS (compositor)->remove_window (compositor, window);
 }
 
@@ -455,6 +481,7 @@ meta_compositor_remove_window_actor (MetaCompositor  *compositor,
     meta_compositor_get_instance_private (compositor);
 
   priv->windows = g_list_remove (priv->windows, window_actor);
+  g_hash_table_remove (priv->pending_geometry_syncs, window_actor);
 }
 
 void
@@ -531,6 +558,18 @@ meta_compositor_filter_keybinding (MetaCompositor *compositor,
   return meta_plugin_manager_filter_keybinding (priv->plugin_mgr, binding);
 }
 
+static void
+flush_pending_window_geometry (MetaCompositor  *compositor,
+                               MetaWindowActor *window_actor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  /* Effects start out from the current actor geometry */
+  if (g_hash_table_remove (priv->pending_geometry_syncs, window_actor))
+    sync_window_actor_geometry (compositor, window_actor, FALSE);
+}
+
 void
 meta_compositor_show_window (MetaCompositor *compositor,
                              MetaWindow     *window,
@@ -538,6 +577,7 @@ meta_compositor_show_window (MetaCompositor *compositor,
 {
   MetaWindowActor *window_actor = meta_window_actor_from_window (window);
 
+  flush_pending_window_geometry (compositor, window_actor);
   meta_window_actor_show (window_actor, effect);
 }
 
@@ -550,6 +590,7 @@ meta_compositor_hide_window (MetaCompositor *compositor,
     meta_compositor_get_instance_private (compositor);
   MetaWindowActor *window_actor = meta_window_actor_from_window (window);
 
+  flush_pending_window_geometry (compositor, window_actor);
   meta_window_actor_hide (window_actor, effect);
   meta_stack_tracker_queue_sync_stack (priv->display->stack_tracker);
 }
@@ -563,6 +604,7 @@ meta_compositor_size_change_window (MetaCompositor *compositor,
 {
   MetaWindowActor *window_actor = meta_window_actor_from_window (window);
 
+  flush_pending_window_geometry (compositor, window_actor);
   meta_window_actor_size_change (window_actor, which_change, old_frame_rect, old_buffer_rect);
 }
 
@@ -845,6 +887,53 @@ meta_compositor_sync_stack (MetaCompositor  *compositor,
   invalidate_top_window_actor_for_views (compositor);
 }
 
+static void
+sync_window_actor_geometry (MetaCompositor  *compositor,
+                            MetaWindowActor *window_actor,
+                            gboolean         did_placement)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  MetaWindowActorChanges changes;
+
+  changes = meta_window_actor_sync_actor_geometry (window_actor, did_placement);
+
+  if (changes & META_WINDOW_ACTOR_CHANGE_SIZE)
+    meta_plugin_manager_event_size_changed (priv->plugin_mgr, window_actor);
+}
+
+static gboolean
+sync_pending_window_geometries (gpointer user_data)
+{
+  MetaCompositor *compositor = user_data;
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  GHashTableIter iter;
+  gpointer key;
+
+  priv->sync_geometry_later_id = 0;
+
+  while (g_hash_table_size (priv->pending_geometry_syncs) > 0)
+    {
+      MetaWindowActor *window_actor;
+
+      g_hash_table_iter_init (&iter, priv->pending_geometry_syncs);
+      g_hash_table_iter_next (&iter, &key, NULL);
+      g_hash_table_iter_remove (&iter);
+
+      window_actor = key;
+      sync_window_actor_geometry (compositor, window_actor, FALSE);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+/*
+ * A window may be moved and resized several times per frame, e.g. when a
+ * client is resized interactively, so unless the actor needs its initial
+ * position right away, only sync its geometry once before the next stage
+ * update, i.e. before it gets laid out and painted.
+ */
 void
 meta_compositor_sync_window_geometry (MetaCompositor *compositor,
                                       MetaWindow     *window,
@@ -853,12 +942,23 @@ meta_compositor_sync_window_geometry (MetaCompositor *compositor,
   MetaCompositorPrivate *priv =
     meta_compositor_get_instance_private (compositor);
   MetaWindowActor *window_actor = meta_window_actor_from_window (window);
-  MetaWindowActorChanges changes;
 
-  changes = meta_window_actor_sync_actor_geometry (window_actor, did_placement);
+  if (did_placement)
+    {
+      g_hash_table_remove (priv->pending_geometry_syncs, window_actor);
+      sync_window_actor_geometry (compositor, window_actor, TRUE);
+      return;
+    }
 
-  if (changes & META_WINDOW_ACTOR_CHANGE_SIZE)
-    meta_plugin_manager_event_size_changed (priv->plugin_mgr, window_actor);
+  g_hash_table_add (priv->pending_geometry_syncs, window_actor);
+
+  if (!priv->sync_geometry_later_id)
+    {
+      priv->sync_geometry_later_id =
+        meta_laters_add (priv->laters, META_LATER_BEFORE_REDRAW,
+                         sync_pending_window_geometries,
+                         compositor, NULL);
+    }
 }
 
 static void
@@ -960,6 +1060,7 @@ meta_compositor_real_before_paint (MetaCompositor     *compositor,
   ClutterStageView *stage_view;
   MtkRectangle stage_rect;
   MtkRegion *unobscured_region;
+  uint64_t damage_serial;
   GList *l;
 
   stage_rect = (MtkRectangle) {
@@ -968,17 +1069,29 @@ meta_compositor_real_before_paint (MetaCompositor     *compositor,
     clutter_actor_get_height (stage),
   };
 
-  unobscured_region = mtk_region_create_rectangle (&stage_rect);
-  meta_cullable_cull_unobscured (META_CULLABLE (priv->window_group), unobscured_region);
-  mtk_region_unref (unobscured_region);
+  /* Culling works on the whole stage, so if nothing changed since it was
+   * last done, e.g. for another view, the result is still valid. */
+  damage_serial = clutter_stage_get_damage_serial (CLUTTER_STAGE (stage));
+  if (!priv->has_culled_unobscured ||
+      priv->culled_unobscured_damage_serial != damage_serial ||
+      !mtk_rectangle_equal (&priv->culled_unobscured_stage_rect, &stage_rect))
+    {
+      unobscured_region = mtk_region_create_rectangle (&stage_rect);
+      meta_cullable_cull_unobscured (META_CULLABLE (priv->window_group), unobscured_region);
+      mtk_region_unref (unobscured_region);
 
-  unobscured_region = mtk_region_create_rectangle (&stage_rect);
-  meta_cullable_cull_unobscured (META_CULLABLE (priv->top_window_group), unobscured_region);
-  mtk_region_unref (unobscured_region);
+      unobscured_region = mtk_region_create_rectangle (&stage_rect);
+      meta_cullable_cull_unobscured (META_CULLABLE (priv->top_window_group), unobscured_region);
+      mtk_region_unref (unobscured_region);
 
-  unobscured_region = mtk_region_create_rectangle (&stage_rect);
-  meta_cullable_cull_unobscured (META_CULLABLE (priv->feedback_group), unobscured_region);
-  mtk_region_unref (unobscured_region);
+      unobscured_region = mtk_region_create_rectangle (&stage_rect);
+      meta_cullable_cull_unobscured (META_CULLABLE (priv->feedback_group), unobscured_region);
+      mtk_region_unref (unobscured_region);
+
+      priv->has_culled_unobscured = TRUE;
+      priv->culled_unobscured_damage_serial = damage_serial;
+      priv->culled_unobscured_stage_rect = stage_rect;
+    }
 
   stage_view = meta_compositor_view_get_stage_view (compositor_view);
 
@@ -1021,6 +1134,7 @@ meta_compositor_real_after_paint (MetaCompositor     *compositor,
       break;
 
     case COGL_GRAPHICS_RESET_STATUS_PURGED_CONTEXT_RESET:
+      cogl_context_trim_offscreen_pool (priv->context);
       g_signal_emit_by_name (priv->display, "gl-video-memory-purged");
       g_signal_emit_by_name (stage_actor, "gl-video-memory-purged");
       clutter_actor_queue_redraw (stage_actor);
@@ -1051,6 +1165,63 @@ meta_compositor_real_after_paint (MetaCompositor     *compositor,
     }
 }
 
+/**
+ * meta_compositor_prewarm:
+ * @compositor: a #MetaCompositor
+ *
+ * Creates the GPU resources that are otherwise set up lazily the first
+ * time a window is painted, so that the first window animations don't
+ * stall on them. This allocates an offscreen framebuffer, which also
+ * settles which framebuffer configuration Cogl uses for offscreens, and
+ * compiles the programs used to paint window textures.
+ *
+ * This is called once, when idle after the first frame was painted.
+ */
+void
+meta_compositor_prewarm (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (GError) error = NULL;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaCompositorPrewarm,
+                           "Meta::Compositor::prewarm()");
+
+  texture = cogl_texture_2d_new_with_size (priv->context, 16, 16);
+  if (!texture)
+    return;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Failed to allocate framebuffer for prewarming: %s",
+                  error->message);
+      return;
+    }
+
+  cogl_framebuffer_orthographic (COGL_FRAMEBUFFER (offscreen),
+                                 0, 0, 16, 16, -1.0, 1.0);
+
+  meta_shaped_texture_prewarm_pipelines (COGL_FRAMEBUFFER (offscreen));
+}
+
+static gboolean
+prewarm_idle (gpointer user_data)
+{
+  MetaCompositor *compositor = user_data;
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  priv->prewarm_later_id = 0;
+
+  meta_compositor_prewarm (compositor);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 meta_compositor_after_paint (MetaCompositor     *compositor,
                              MetaCompositorView *compositor_view)
@@ -1063,6 +1234,16 @@ meta_compositor_after_paint (MetaCompositor     *compositor,
   META_COMPOSITOR_GET_CLASS (compositor)->after_paint (compositor, compositor_view);
 
   priv->frame_in_progress = FALSE;
+
+  if (!priv->prewarm_queued)
+    {
+      priv->prewarm_later_id = meta_laters_add (priv->laters,
+                                                META_LATER_IDLE,
+                                                prewarm_idle,
+                                                compositor,
+                                                NULL);
+      priv->prewarm_queued = TRUE;
+    }
 }
 
 static void
@@ -1175,9 +1356,25 @@ meta_compositor_get_property (GObject    *object,
 static void
 meta_compositor_init (MetaCompositor *compositor)
 {
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  priv->pending_geometry_syncs = g_hash_table_new (NULL, NULL);
+
   invalidate_top_window_actor_for_views (compositor);
 }
 
+static void
+on_low_memory_warning (GMemoryMonitor             *memory_monitor,
+                       GMemoryMonitorWarningLevel  level,
+                       MetaCompositor             *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  cogl_context_trim_offscreen_pool (priv->context);
+}
+
 static void
 meta_compositor_constructed (GObject *object)
 {
@@ -1220,6 +1417,13 @@ meta_compositor_constructed (GObject *object)
                       G_CALLBACK (on_monitors_changed_internal),
                       compositor);
 
+  priv->memory_monitor = g_memory_monitor_dup_default ();
+  priv->low_memory_warning_handler_id =
+    g_signal_connect (priv->memory_monitor,
+                      "low-memory-warning",
+                      G_CALLBACK (on_low_memory_warning),
+                      compositor);
+
   priv->laters = meta_laters_new (compositor);
 
   G_OBJECT_CLASS (meta_compositor_parent_class)->constructed (object);
@@ -1235,6 +1439,19 @@ meta_compositor_dispose (GObject *object)
     meta_compositor_get_instance_private (compositor);
   ClutterActor *stage = meta_backend_get_stage (priv->backend);
 
+  if (priv->sync_geometry_later_id)
+    {
+      meta_laters_remove (priv->laters, priv->sync_geometry_later_id);
+      priv->sync_geometry_later_id = 0;
+    }
+  g_clear_pointer (&priv->pending_geometry_syncs, g_hash_table_unref);
+
+  if (priv->prewarm_later_id)
+    {
+      meta_laters_remove (priv->laters, priv->prewarm_later_id);
+      priv->prewarm_later_id = 0;
+    }
+
   g_clear_object (&priv->laters);
 
   g_clear_signal_handler (&priv->stage_presented_id, stage);
@@ -1242,6 +1459,9 @@ meta_compositor_dispose (GObject *object)
   g_clear_signal_handler (&priv->after_paint_handler_id, stage);
   g_clear_signal_handler (&priv->grabbed_notify_handler_id, stage);
   g_clear_signal_handler (&priv->window_visibility_updated_id, priv->display);
+  g_clear_signal_handler (&priv->low_memory_warning_handler_id,
+                          priv->memory_monitor);
+  g_clear_object (&priv->memory_monitor);
 
   g_clear_pointer (&priv->windows, g_list_free);
 
@@ -48,6 +48,14 @@ struct _MetaEdgeResistanceData
   GArray *right_edges;
   GArray *top_edges;
   GArray *bottom_edges;
+  GList *window_edges;
+
+  /* Set when windows, the stack or the work areas changed since the edges
+   * were computed, causing them to be recomputed on next use.
+   */
+  gboolean is_stale;
+  MetaDisplay *display;
+  GPtrArray *windows;
 };
 
 static GQuark edge_resistance_data_quark = 0;
@@ -629,56 +637,22 @@ apply_edge_resistance_to_each_side (MetaEdgeResistanceData  *edge_data,
 static void
 meta_edge_resistance_data_free (MetaEdgeResistanceData *edge_data)
 {
-  guint i,j;
-  GHashTable *edges_to_be_freed;
+  guint i;
 
-  /* We first need to clean out any window edges */
-  edges_to_be_freed = g_hash_table_new_full (g_direct_hash, g_direct_equal,
-                                             g_free, NULL);
-  for (i = 0; i < 4; i++)
-    {
-      GArray *tmp = NULL;
-      MetaSide side;
-      switch (i)
-        {
-        case 0:
-          tmp = edge_data->left_edges;
-          side = META_SIDE_LEFT;
-          break;
-        case 1:
-          tmp = edge_data->right_edges;
-          side = META_SIDE_RIGHT;
-          break;
-        case 2:
-          tmp = edge_data->top_edges;
-          side = META_SIDE_TOP;
-          break;
-        case 3:
-          tmp = edge_data->bottom_edges;
-          side = META_SIDE_BOTTOM;
-          break;
-        default:
-          g_assert_not_reached ();
-        }
+  /* Only the window edges are owned by us; the monitor and screen edges
+   * belong to the workspace, and may already be gone if the work areas
+   * changed during the operation.
+   */
+  g_list_free_full (edge_data->window_edges, g_free);
 
-      for (j = 0; j < tmp->len; j++)
-        {
-          MetaEdge *edge = g_array_index (tmp, MetaEdge*, j);
-          if (edge->edge_type == META_EDGE_WINDOW &&
-              edge->side_type == side)
-            {
-              /* The same edge will appear in two arrays, and we can't free
-               * it yet we still need to compare edge->side_type for the other
-               * array that it is in.  So store it in a hash table for later
-               * freeing.  Could also do this in a simple linked list.
-               */
-              g_hash_table_insert (edges_to_be_freed, edge, edge);
-            }
-        }
+  for (i = 0; i < edge_data->windows->len; i++)
+    {
+      g_signal_handlers_disconnect_by_data (g_ptr_array_index (edge_data->windows, i),
+                                            edge_data);
     }
-
-  /* Now free all the window edges (the key destroy function is g_free) */
-  g_hash_table_destroy (edges_to_be_freed);
+  g_ptr_array_free (edge_data->windows, TRUE);
+  g_signal_handlers_disconnect_by_data (edge_data->display->stack, edge_data);
+  g_signal_handlers_disconnect_by_data (edge_data->display, edge_data);
 
   /* Now free the arrays and data */
   g_array_free (edge_data->left_edges, TRUE);
@@ -875,6 +849,47 @@ cache_edges (MetaDisplay *display,
   return edge_data;
 }
 
+static void
+mark_edges_stale (MetaEdgeResistanceData *edge_data)
+{
+  edge_data->is_stale = TRUE;
+}
+
+/* Edges are computed lazily on first use, and are from then on kept
+ * up to date by recomputing them when any of their sources change.
+ */
+static void
+track_edge_sources (MetaEdgeResistanceData *edge_data,
+                    MetaDisplay            *display,
+                    GList                  *windows)
+{
+  GList *l;
+
+  edge_data->display = display;
+  edge_data->windows = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_signal_connect_swapped (display, "workareas-changed",
+                            G_CALLBACK (mark_edges_stale), edge_data);
+  g_signal_connect_swapped (display->stack, "changed",
+                            G_CALLBACK (mark_edges_stale), edge_data);
+
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *window = l->data;
+
+      if (!(WINDOW_EDGES_RELEVANT (window, display)))
+        continue;
+
+      g_signal_connect_swapped (window, "position-changed",
+                                G_CALLBACK (mark_edges_stale), edge_data);
+      g_signal_connect_swapped (window, "size-changed",
+                                G_CALLBACK (mark_edges_stale), edge_data);
+      g_signal_connect_swapped (window, "unmanaging",
+                                G_CALLBACK (mark_edges_stale), edge_data);
+      g_ptr_array_add (edge_data->windows, g_object_ref (window));
+    }
+}
+
 static MetaEdgeResistanceData *
 compute_resistance_and_snapping_edges (MetaWindowDrag *window_drag)
 {
@@ -1041,7 +1056,6 @@ compute_resistance_and_snapping_edges (MetaWindowDrag *window_drag)
   /*
    * 4th: Free the extra memory not needed and sort the list
    */
-  g_list_free (stacked_windows);
   /* Free the memory used by the obscuring windows/docks lists */
   g_slist_free (window_stacking);
   g_slist_free_full (obscuring_windows, g_free);
@@ -1053,14 +1067,17 @@ compute_resistance_and_snapping_edges (MetaWindowDrag *window_drag)
 
   /*
    * 5th: Cache the combination of these edges with the onscreen and
-   * monitor edges in an array for quick access.  Free the edges since
-   * they've been cached elsewhere.
+   * monitor edges in an array for quick access.  The window edges are kept
+   * around, to be freed along with the cache.
    */
   edge_data = cache_edges (display,
                            edges,
                            workspace_manager->active_workspace->monitor_edges,
                            workspace_manager->active_workspace->screen_edges);
-  g_list_free (edges);
+  edge_data->window_edges = edges;
+
+  track_edge_sources (edge_data, display, stacked_windows);
+  g_list_free (stacked_windows);
 
   return edge_data;
 }
@@ -1079,7 +1096,7 @@ meta_window_drag_ensure_edge_resistance_data (MetaWindowDrag *window_drag)
   edge_data = g_object_get_qdata (G_OBJECT (window_drag),
                                   edge_resistance_data_quark);
 
-  if (!edge_data)
+  if (!edge_data || edge_data->is_stale)
     {
       edge_data = compute_resistance_and_snapping_edges (window_drag);
       g_object_set_qdata_full (G_OBJECT (window_drag),
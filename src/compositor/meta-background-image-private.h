@@ -0,0 +1,10 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+#pragma once
+
+#include "meta/meta-background-image.h"
+
+MetaBackgroundImage * meta_background_image_cache_load_scaled (MetaBackgroundImageCache *cache,
+                                                               GFile                    *file,
+                                                               int                       cover_width,
+                                                               int                       cover_height);
@@ -18,10 +18,11 @@
 
 #include "config.h"
 
-#include "meta/meta-background-image.h"
+#include "compositor/meta-background-image-private.h"
 
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <gio/gio.h>
+#include <math.h>
 
 #include "clutter/clutter.h"
 #include "compositor/cogl-utils.h"
@@ -47,6 +48,7 @@ struct _MetaBackgroundImageCache
   GObject parent_instance;
 
   GHashTable *images;
+  GHashTable *scaled_images;
 };
 
 /**
@@ -62,14 +64,39 @@ struct _MetaBackgroundImage
   gboolean in_cache;
   gboolean loaded;
   CoglTexture *texture;
+
+  /* Size the image was decoded to cover, or 0 for the full resolution */
+  int cover_width;
+  int cover_height;
 };
 
+typedef struct _LoadData
+{
+  int max_texture_size;
+  int cover_width;
+  int cover_height;
+} LoadData;
+
+#define LOAD_BUFFER_SIZE (64 * 1024)
+
 G_DEFINE_TYPE (MetaBackgroundImageCache, meta_background_image_cache, G_TYPE_OBJECT);
 
 static void
 meta_background_image_cache_init (MetaBackgroundImageCache *cache)
 {
   cache->images = g_hash_table_new (g_file_hash, (GEqualFunc) g_file_equal);
+  cache->scaled_images = g_hash_table_new (g_file_hash,
+                                           (GEqualFunc) g_file_equal);
+}
+
+static GHashTable *
+get_images_table (MetaBackgroundImageCache *cache,
+                  MetaBackgroundImage      *image)
+{
+  if (image->cover_width > 0)
+    return cache->scaled_images;
+  else
+    return cache->images;
 }
 
 static void
@@ -86,7 +113,15 @@ meta_background_image_cache_finalize (GObject *object)
       image->in_cache = FALSE;
     }
 
+  g_hash_table_iter_init (&iter, cache->scaled_images);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      MetaBackgroundImage *image = value;
+      image->in_cache = FALSE;
+    }
+
   g_hash_table_destroy (cache->images);
+  g_hash_table_destroy (cache->scaled_images);
 
   G_OBJECT_CLASS (meta_background_image_cache_parent_class)->finalize (object);
 }
@@ -115,15 +150,87 @@ meta_background_image_cache_get_default (void)
   return cache;
 }
 
+static void
+on_size_prepared (GdkPixbufLoader *loader,
+                  int              width,
+                  int              height,
+                  LoadData        *load_data)
+{
+  double scale;
+
+  /* The orientation is only applied after decoding, so make sure the
+   * image covers the requested size when rotated too. */
+  scale = MAX (MAX ((double) load_data->cover_width / width,
+                    (double) load_data->cover_height / height),
+               MAX ((double) load_data->cover_height / width,
+                    (double) load_data->cover_width / height));
+  if (scale >= 1.0)
+    return;
+
+  /* Loaders such as the JPEG one decode at a reduced size directly,
+   * without ever holding the full resolution image in memory. */
+  gdk_pixbuf_loader_set_size (loader,
+                              MAX ((int) ceil (width * scale), 1),
+                              MAX ((int) ceil (height * scale), 1));
+}
+
+static GdkPixbuf *
+load_pixbuf_scaled (GInputStream  *stream,
+                    LoadData      *load_data,
+                    GCancellable  *cancellable,
+                    GError       **error)
+{
+  g_autoptr (GdkPixbufLoader) loader = NULL;
+  g_autofree guchar *buffer = NULL;
+  GdkPixbuf *pixbuf;
+  gssize n_read;
+
+  loader = gdk_pixbuf_loader_new ();
+  g_signal_connect (loader, "size-prepared",
+                    G_CALLBACK (on_size_prepared), load_data);
+
+  buffer = g_malloc (LOAD_BUFFER_SIZE);
+  while ((n_read = g_input_stream_read (stream, buffer, LOAD_BUFFER_SIZE,
+                                        cancellable, error)) > 0)
+    {
+      if (!gdk_pixbuf_loader_write (loader, buffer, n_read, error))
+        {
+          gdk_pixbuf_loader_close (loader, NULL);
+          return NULL;
+        }
+    }
+
+  if (n_read < 0)
+    {
+      gdk_pixbuf_loader_close (loader, NULL);
+      return NULL;
+    }
+
+  if (!gdk_pixbuf_loader_close (loader, error))
+    return NULL;
+
+  pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+  if (pixbuf == NULL)
+    {
+      g_set_error (error, GDK_PIXBUF_ERROR, GDK_PIXBUF_ERROR_FAILED,
+                   "Image contained no data");
+      return NULL;
+    }
+
+  return g_object_ref (pixbuf);
+}
+
 static void
 load_file (GTask               *task,
            MetaBackgroundImage *image,
-           gpointer             task_data,
+           LoadData            *load_data,
            GCancellable        *cancellable)
 {
+  int max_texture_size = load_data->max_texture_size;
   GError *error = NULL;
-  GdkPixbuf *pixbuf;
+  GdkPixbuf *pixbuf, *rotated;
   GFileInputStream *stream;
+  int width, height;
 
   stream = g_file_read (image->file, NULL, &error);
   if (stream == NULL)
@@ -132,7 +239,16 @@ load_file (GTask               *task,
       return;
     }
 
-  pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (stream), NULL, &error);
+  if (load_data->cover_width > 0)
+    {
+      pixbuf = load_pixbuf_scaled (G_INPUT_STREAM (stream), load_data,
+                                   cancellable, &error);
+    }
+  else
+    {
+      pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (stream),
+                                           NULL, &error);
+    }
   g_object_unref (stream);
 
   if (pixbuf == NULL)
@@ -141,6 +257,38 @@ load_file (GTask               *task,
       return;
     }
 
+  rotated = gdk_pixbuf_apply_embedded_orientation (pixbuf);
+  if (rotated != NULL)
+    {
+      g_object_unref (pixbuf);
+      pixbuf = rotated;
+    }
+
+  /* Images that don't fit in a single texture would need a sliced texture,
+   * which costs a draw per slice every time the background is painted. The
+   * background is scaled to the monitor when painted anyway, so downscale
+   * it here instead, while we are off the main thread. */
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  if (max_texture_size > 0 &&
+      (width > max_texture_size || height > max_texture_size))
+    {
+      double scale = (double) max_texture_size / MAX (width, height);
+      GdkPixbuf *scaled;
+
+      scaled = gdk_pixbuf_scale_simple (pixbuf,
+                                        CLAMP (width * scale,
+                                               1, max_texture_size),
+                                        CLAMP (height * scale,
+                                               1, max_texture_size),
+                                        GDK_INTERP_BILINEAR);
+      if (scaled != NULL)
+        {
+          g_object_unref (pixbuf);
+          pixbuf = scaled;
+        }
+    }
+
   g_task_return_pointer (task, pixbuf, (GDestroyNotify) g_object_unref);
 }
 
@@ -154,7 +302,7 @@ file_loaded (GObject      *source_object,
   g_autoptr (GError) local_error = NULL;
   GTask *task;
   CoglTexture *texture;
-  GdkPixbuf *pixbuf, *rotated;
+  GdkPixbuf *pixbuf;
   int width, height, row_stride;
   guchar *pixels;
   gboolean has_alpha;
@@ -171,13 +319,6 @@ file_loaded (GObject      *source_object,
       goto out;
     }
 
-  rotated = gdk_pixbuf_apply_embedded_orientation (pixbuf);
-  if (rotated != NULL)
-    {
-      g_object_unref (pixbuf);
-      pixbuf = rotated;
-    }
-
   width = gdk_pixbuf_get_width (pixbuf);
   height = gdk_pixbuf_get_height (pixbuf);
   row_stride = gdk_pixbuf_get_rowstride (pixbuf);
@@ -209,6 +350,40 @@ out:
   g_signal_emit (image, signals[LOADED], 0);
 }
 
+static MetaBackgroundImage *
+load_image (MetaBackgroundImageCache *cache,
+            GFile                    *file,
+            int                       cover_width,
+            int                       cover_height)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
+  MetaBackgroundImage *image;
+  LoadData *load_data;
+  GTask *task;
+
+  image = g_object_new (META_TYPE_BACKGROUND_IMAGE, NULL);
+  image->cache = cache;
+  image->in_cache = TRUE;
+  image->file = g_object_ref (file);
+  image->cover_width = cover_width;
+  image->cover_height = cover_height;
+  g_hash_table_insert (get_images_table (cache, image), image->file, image);
+
+  load_data = g_new0 (LoadData, 1);
+  load_data->max_texture_size = cogl_context_get_max_texture_size (ctx);
+  load_data->cover_width = cover_width;
+  load_data->cover_height = cover_height;
+
+  task = g_task_new (image, NULL, file_loaded, NULL);
+  g_task_set_task_data (task, load_data, g_free);
+
+  g_task_run_in_thread (task, (GTaskThreadFunc) load_file);
+  g_object_unref (task);
+
+  return image;
+}
+
 /**
  * meta_background_image_cache_load:
  * @cache: a #MetaBackgroundImageCache
@@ -230,7 +405,6 @@ meta_background_image_cache_load (MetaBackgroundImageCache *cache,
                                   GFile                    *file)
 {
   MetaBackgroundImage *image;
-  GTask *task;
 
   g_return_val_if_fail (META_IS_BACKGROUND_IMAGE_CACHE (cache), NULL);
   g_return_val_if_fail (file != NULL, NULL);
@@ -239,18 +413,41 @@ meta_background_image_cache_load (MetaBackgroundImageCache *cache,
   if (image != NULL)
     return g_object_ref (image);
 
-  image = g_object_new (META_TYPE_BACKGROUND_IMAGE, NULL);
-  image->cache = cache;
-  image->in_cache = TRUE;
-  image->file = g_object_ref (file);
-  g_hash_table_insert (cache->images, image->file, image);
+  return load_image (cache, file, 0, 0);
+}
 
-  task = g_task_new (image, NULL, file_loaded, NULL);
+/*
+ * Like meta_background_image_cache_load(), but the image is decoded at
+ * the smallest size that still covers @cover_width x @cover_height, for
+ * backgrounds that are scaled to the monitors anyway. The full
+ * resolution image is never uploaded.
+ */
+MetaBackgroundImage *
+meta_background_image_cache_load_scaled (MetaBackgroundImageCache *cache,
+                                         GFile                    *file,
+                                         int                       cover_width,
+                                         int                       cover_height)
+{
+  MetaBackgroundImage *image;
 
-  g_task_run_in_thread (task, (GTaskThreadFunc) load_file);
-  g_object_unref (task);
+  g_return_val_if_fail (META_IS_BACKGROUND_IMAGE_CACHE (cache), NULL);
+  g_return_val_if_fail (file != NULL, NULL);
+  g_return_val_if_fail (cover_width > 0 && cover_height > 0, NULL);
 
-  return image;
+  image = g_hash_table_lookup (cache->scaled_images, file);
+  if (image != NULL)
+    {
+      if (image->cover_width >= cover_width &&
+          image->cover_height >= cover_height)
+        return g_object_ref (image);
+
+      /* Too small for the current monitors; users of the old image keep
+       * it until they load it again. */
+      g_hash_table_remove (cache->scaled_images, image->file);
+      image->in_cache = FALSE;
+    }
+
+  return load_image (cache, file, cover_width, cover_height);
 }
 
 /**
@@ -271,11 +468,18 @@ meta_background_image_cache_purge (MetaBackgroundImageCache *cache,
   g_return_if_fail (file != NULL);
 
   image = g_hash_table_lookup (cache->images, file);
-  if (image == NULL)
-    return;
+  if (image != NULL)
+    {
+      g_hash_table_remove (cache->images, image->file);
+      image->in_cache = FALSE;
+    }
 
-  g_hash_table_remove (cache->images, image->file);
-  image->in_cache = FALSE;
+  image = g_hash_table_lookup (cache->scaled_images, file);
+  if (image != NULL)
+    {
+      g_hash_table_remove (cache->scaled_images, image->file);
+      image->in_cache = FALSE;
+    }
 }
 
 G_DEFINE_TYPE (MetaBackgroundImage, meta_background_image, G_TYPE_OBJECT);
@@ -291,7 +495,7 @@ meta_background_image_finalize (GObject *object)
   MetaBackgroundImage *image = META_BACKGROUND_IMAGE (object);
 
   if (image->in_cache)
-    g_hash_table_remove (image->cache->images, image->file);
+    g_hash_table_remove (get_images_table (image->cache, image), image->file);
 
   if (image->texture)
     g_object_unref (image->texture);
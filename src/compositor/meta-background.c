@@ -21,10 +21,12 @@
 
 #include "compositor/meta-background-private.h"
 
+#include <math.h>
 #include <string.h>
 
 #include "backends/meta-backend-private.h"
 #include "compositor/cogl-utils.h"
+#include "compositor/meta-background-image-private.h"
 #include "meta/display.h"
 #include "meta/meta-background-image.h"
 #include "meta/meta-background.h"
@@ -46,6 +48,10 @@ struct _MetaBackgroundMonitor
   gboolean dirty;
   CoglTexture *texture;
   CoglFramebuffer *fbo;
+
+  /* What the texture was last rendered for */
+  MtkRectangle rendered_area;
+  float rendered_scale;
 };
 
 struct _MetaBackground
@@ -69,6 +75,10 @@ struct _MetaBackground
   CoglTexture *color_texture;
   CoglTexture *wallpaper_texture;
 
+  /* Size the images are decoded to cover, or 0 for the full resolution */
+  int cover_width;
+  int cover_height;
+
   float blend_factor;
 
   guint wallpaper_allocation_failed : 1;
@@ -133,10 +143,82 @@ invalidate_monitor_backgrounds (MetaBackground *self)
     }
 }
 
+static void set_file (MetaBackground       *self,
+                      GFile               **filep,
+                      MetaBackgroundImage **imagep,
+                      GFile                *file,
+                      gboolean              force_reload);
+
+static gboolean
+style_needs_full_resolution (GDesktopBackgroundStyle style)
+{
+  /* These show the image pixels unscaled */
+  return (style == G_DESKTOP_BACKGROUND_STYLE_WALLPAPER ||
+          style == G_DESKTOP_BACKGROUND_STYLE_CENTERED);
+}
+
+/*
+ * Updates the size any scaled style needs the images to cover, which is
+ * at most the whole screen at the largest monitor scale. Returns %TRUE
+ * if the images loaded so far are not good enough anymore.
+ */
+static gboolean
+update_cover_size (MetaBackground *self)
+{
+  MetaContext *context = meta_display_get_context (self->display);
+  MetaBackend *backend = meta_context_get_backend (context);
+  int screen_width, screen_height;
+  int cover_width, cover_height;
+  float max_scale = 1.0;
+  gboolean needs_reload;
+
+  if (style_needs_full_resolution (self->style))
+    {
+      needs_reload = self->cover_width > 0;
+      self->cover_width = 0;
+      self->cover_height = 0;
+      return needs_reload;
+    }
+
+  if (meta_backend_is_stage_views_scaled (backend))
+    {
+      int i;
+
+      for (i = 0; i < meta_display_get_n_monitors (self->display); i++)
+        {
+          max_scale = MAX (max_scale,
+                           meta_display_get_monitor_scale (self->display, i));
+        }
+    }
+
+  meta_display_get_size (self->display, &screen_width, &screen_height);
+  cover_width = MAX ((int) ceilf (screen_width * max_scale), 1);
+  cover_height = MAX ((int) ceilf (screen_height * max_scale), 1);
+
+  needs_reload = (self->cover_width == 0 ||
+                  cover_width > self->cover_width ||
+                  cover_height > self->cover_height);
+  if (needs_reload)
+    {
+      self->cover_width = MAX (self->cover_width, cover_width);
+      self->cover_height = MAX (self->cover_height, cover_height);
+    }
+
+  return needs_reload;
+}
+
 static void
 on_monitors_changed (MetaBackground *self)
 {
   invalidate_monitor_backgrounds (self);
+
+  if (update_cover_size (self))
+    {
+      set_file (self, &self->file1, &self->background_image1,
+                self->file1, TRUE);
+      set_file (self, &self->file2, &self->background_image2,
+                self->file2, TRUE);
+    }
 }
 
 static void
@@ -256,7 +338,17 @@ set_file (MetaBackground       *self,
         {
           MetaBackgroundImageCache *cache = meta_background_image_cache_get_default ();
 
-          *imagep = meta_background_image_cache_load (cache, file);
+          if (self->cover_width > 0)
+            {
+              *imagep =
+                meta_background_image_cache_load_scaled (cache, file,
+                                                         self->cover_width,
+                                                         self->cover_height);
+            }
+          else
+            {
+              *imagep = meta_background_image_cache_load (cache, file);
+            }
           g_signal_connect (*imagep, "loaded",
                             G_CALLBACK (on_background_loaded), self);
         }
@@ -618,17 +710,19 @@ create_pipeline (PipelineType type)
   };
   static CoglPipeline *templates[3];
 
+  /* The templates are immutable once created so that the copies only
+   * ever differ from them by their layer textures and can share the
+   * template's program */
   if (templates[type] == NULL)
     {
       templates[type] = meta_create_texture_pipeline (NULL);
       cogl_pipeline_set_blend (templates[type], blend_strings[type], NULL);
+      cogl_pipeline_set_layer_filters (templates[type],
+                                       0,
+                                       COGL_PIPELINE_FILTER_LINEAR_MIPMAP_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
     }
 
-  cogl_pipeline_set_layer_filters (templates[type],
-                                   0,
-                                   COGL_PIPELINE_FILTER_LINEAR_MIPMAP_LINEAR,
-                                   COGL_PIPELINE_FILTER_LINEAR);
-
   return cogl_pipeline_copy (templates[type]);
 }
 
@@ -749,6 +843,89 @@ get_best_mipmap_level (CoglTexture *texture,
   return MAX (0, halves - 1);
 }
 
+static gboolean
+is_rendered_area_position_dependent (MetaBackground *self)
+{
+  return (self->style == G_DESKTOP_BACKGROUND_STYLE_WALLPAPER ||
+          self->style == G_DESKTOP_BACKGROUND_STYLE_SPANNED);
+}
+
+static gboolean
+background_renders_equal (MetaBackground *self,
+                          MetaBackground *other)
+{
+  return (self->display == other->display &&
+          self->style == other->style &&
+          self->shading_direction == other->shading_direction &&
+          clutter_color_equal (&self->color, &other->color) &&
+          clutter_color_equal (&self->second_color, &other->second_color) &&
+          self->background_image1 == other->background_image1 &&
+          self->background_image2 == other->background_image2 &&
+          G_APPROX_VALUE (self->blend_factor, other->blend_factor, FLT_EPSILON));
+}
+
+/*
+ * Finds an up to date prerendered texture, in this or any other
+ * background, that was drawn with the same images, blend and geometry,
+ * so that monitors with identical configurations, or the backgrounds
+ * created for each of them, don't render and keep the same thing twice.
+ */
+static MetaBackgroundMonitor *
+find_shareable_monitor (MetaBackground     *self,
+                        const MtkRectangle *area,
+                        float               scale)
+{
+  GSList *l;
+
+  for (l = all_backgrounds; l; l = l->next)
+    {
+      MetaBackground *other = l->data;
+      int i;
+
+      if (other != self && !background_renders_equal (self, other))
+        continue;
+
+      for (i = 0; i < other->n_monitors; i++)
+        {
+          MetaBackgroundMonitor *monitor = &other->monitors[i];
+
+          if (monitor->dirty || !monitor->texture)
+            continue;
+
+          if (mtk_rectangle_equal (&monitor->rendered_area, area) &&
+              G_APPROX_VALUE (monitor->rendered_scale, scale, FLT_EPSILON))
+            return monitor;
+        }
+    }
+
+  return NULL;
+}
+
+static gboolean
+is_texture_shared (MetaBackgroundMonitor *monitor)
+{
+  GSList *l;
+
+  /* Dirty monitors fetch their texture again before painting it next */
+  for (l = all_backgrounds; l; l = l->next)
+    {
+      MetaBackground *other = l->data;
+      int i;
+
+      for (i = 0; i < other->n_monitors; i++)
+        {
+          MetaBackgroundMonitor *other_monitor = &other->monitors[i];
+
+          if (other_monitor != monitor &&
+              !other_monitor->dirty &&
+              other_monitor->texture == monitor->texture)
+            return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
 CoglTexture *
 meta_background_get_texture (MetaBackground       *self,
                              int                   monitor_index,
@@ -802,6 +979,8 @@ meta_background_get_texture (MetaBackground       *self,
     {
       MetaContext *context = meta_display_get_context (self->display);
       MetaBackend *backend = meta_context_get_backend (context);
+      MetaBackgroundMonitor *shared_monitor;
+      MtkRectangle rendered_area;
       GError *catch_error = NULL;
       gboolean bare_region_visible = FALSE;
       int texture_width, texture_height;
@@ -817,6 +996,34 @@ meta_background_get_texture (MetaBackground       *self,
           texture_height = monitor_area.height;
         }
 
+      rendered_area = MTK_RECTANGLE_INIT (0, 0, texture_width, texture_height);
+      if (is_rendered_area_position_dependent (self))
+        {
+          rendered_area.x = monitor_area.x;
+          rendered_area.y = monitor_area.y;
+        }
+
+      shared_monitor = find_shareable_monitor (self,
+                                               &rendered_area,
+                                               monitor_scale);
+      if (shared_monitor && shared_monitor != monitor)
+        {
+          g_set_object (&monitor->texture, shared_monitor->texture);
+          g_set_object (&monitor->fbo, shared_monitor->fbo);
+          monitor->rendered_area = rendered_area;
+          monitor->rendered_scale = monitor_scale;
+          monitor->dirty = FALSE;
+
+          goto out;
+        }
+
+      /* Don't draw into a texture some other monitor is still showing */
+      if (monitor->texture && is_texture_shared (monitor))
+        {
+          g_clear_object (&monitor->fbo);
+          g_clear_object (&monitor->texture);
+        }
+
       if (monitor->texture == NULL)
         {
           CoglOffscreen *offscreen;
@@ -921,9 +1128,12 @@ meta_background_get_texture (MetaBackground       *self,
           g_object_unref (pipeline);
         }
 
+      monitor->rendered_area = rendered_area;
+      monitor->rendered_scale = monitor_scale;
       monitor->dirty = FALSE;
     }
 
+out:
   if (texture_area)
     set_texture_area_from_monitor_area (&geometry, texture_area);
 
@@ -998,14 +1208,18 @@ meta_background_set_blend (MetaBackground          *self,
                            double                   blend_factor,
                            GDesktopBackgroundStyle  style)
 {
+  gboolean force_reload;
+
   g_return_if_fail (META_IS_BACKGROUND (self));
   g_return_if_fail (blend_factor >= 0.0 && blend_factor <= 1.0);
 
-  set_file (self, &self->file1, &self->background_image1, file1, FALSE);
-  set_file (self, &self->file2, &self->background_image2, file2, FALSE);
+  self->style = style;
+  force_reload = update_cover_size (self);
+
+  set_file (self, &self->file1, &self->background_image1, file1, force_reload);
+  set_file (self, &self->file2, &self->background_image2, file2, force_reload);
 
   self->blend_factor = blend_factor;
-  self->style = style;
 
   free_wallpaper_texture (self);
   mark_changed (self);
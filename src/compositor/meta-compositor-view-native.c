@@ -24,8 +24,15 @@
 
 #include "compositor/meta-compositor-view-native.h"
 
+#include <math.h>
+
 #include "backends/meta-crtc.h"
+#include "backends/meta-monitor-transform.h"
+#include "backends/meta-renderer-view.h"
 #include "backends/native/meta-crtc-kms.h"
+#include "backends/native/meta-kms-crtc.h"
+#include "backends/native/meta-kms-device.h"
+#include "backends/native/meta-onscreen-native.h"
 #include "compositor/compositor-private.h"
 #include "compositor/meta-window-actor-private.h"
 
@@ -40,6 +47,10 @@ struct _MetaCompositorViewNative
 
 #ifdef HAVE_WAYLAND
   MetaWaylandSurface *scanout_candidate;
+  MetaWaylandSurface *overlay_scanout_surface;
+
+  MetaSurfaceActor *frame_sync_surface;
+  gulong frame_sync_repaint_scheduled_id;
 #endif /* HAVE_WAYLAND */
 };
 
@@ -50,24 +61,142 @@ G_DEFINE_TYPE (MetaCompositorViewNative, meta_compositor_view_native,
 static void
 update_scanout_candidate (MetaCompositorViewNative *view_native,
                           MetaWaylandSurface       *surface,
-                          MetaCrtc                 *crtc)
+                          MetaCrtc                 *crtc,
+                          MetaWaylandScanoutPlane   plane)
 {
   if (view_native->scanout_candidate &&
       view_native->scanout_candidate != surface)
     {
       meta_wayland_surface_set_scanout_candidate (view_native->scanout_candidate,
-                                                  NULL);
+                                                  NULL,
+                                                  META_WAYLAND_SCANOUT_PLANE_PRIMARY);
       g_clear_weak_pointer (&view_native->scanout_candidate);
     }
 
   if (surface)
     {
-      meta_wayland_surface_set_scanout_candidate (surface, crtc);
+      meta_wayland_surface_set_scanout_candidate (surface, crtc, plane);
       g_set_weak_pointer (&view_native->scanout_candidate,
                           surface);
     }
 }
 
+static void
+on_frame_sync_surface_repaint_scheduled (MetaSurfaceActor         *surface_actor,
+                                         MetaCompositorViewNative *view_native)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  ClutterFrameClock *frame_clock =
+    clutter_stage_view_get_frame_clock (stage_view);
+
+  switch (clutter_frame_clock_get_mode (frame_clock))
+    {
+    case CLUTTER_FRAME_CLOCK_MODE_VARIABLE:
+    case CLUTTER_FRAME_CLOCK_MODE_TEARING:
+      clutter_stage_view_schedule_update_now (stage_view);
+      break;
+    case CLUTTER_FRAME_CLOCK_MODE_FIXED:
+      break;
+    }
+}
+
+static void
+update_frame_sync_surface (MetaCompositorViewNative *view_native,
+                           MetaSurfaceActor         *surface_actor)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+
+  if (view_native->frame_sync_surface == surface_actor)
+    return;
+
+  if (view_native->frame_sync_surface)
+    {
+      g_clear_signal_handler (&view_native->frame_sync_repaint_scheduled_id,
+                              view_native->frame_sync_surface);
+      g_clear_weak_pointer (&view_native->frame_sync_surface);
+    }
+
+  if (surface_actor)
+    {
+      view_native->frame_sync_repaint_scheduled_id =
+        g_signal_connect (surface_actor, "repaint-scheduled",
+                          G_CALLBACK (on_frame_sync_surface_repaint_scheduled),
+                          view_native);
+      g_set_weak_pointer (&view_native->frame_sync_surface, surface_actor);
+    }
+
+  if (META_IS_RENDERER_VIEW (stage_view))
+    {
+      meta_renderer_view_set_has_frame_sync_surface (META_RENDERER_VIEW (stage_view),
+                                                     surface_actor != NULL);
+    }
+}
+
+static void
+update_allows_tearing (MetaCompositorViewNative *view_native,
+                       MetaWaylandSurface       *surface,
+                       MetaCrtc                 *crtc)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  gboolean allows_tearing = FALSE;
+
+  if (!META_IS_RENDERER_VIEW (stage_view))
+    return;
+
+  if (surface && meta_wayland_surface_is_tearing_allowed (surface))
+    {
+      MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (crtc));
+      MetaKmsDevice *kms_device = meta_kms_crtc_get_device (kms_crtc);
+
+      allows_tearing = meta_kms_device_supports_async_page_flip (kms_device);
+    }
+
+  meta_renderer_view_set_allows_tearing (META_RENDERER_VIEW (stage_view),
+                                         allows_tearing);
+}
+
+static gboolean
+is_software_cursor_in_rect (MetaCompositor        *compositor,
+                            ClutterStageView      *stage_view,
+                            const graphene_rect_t *rect)
+{
+  MetaBackend *backend = meta_compositor_get_backend (compositor);
+  MetaCursorTracker *cursor_tracker =
+    meta_backend_get_cursor_tracker (backend);
+  CoglTexture *cursor_sprite;
+  graphene_rect_t cursor_rect;
+  graphene_point_t position;
+  float scale;
+  int hotspot_x;
+  int hotspot_y;
+
+  cursor_sprite = meta_cursor_tracker_get_sprite (cursor_tracker);
+  if (!cursor_sprite ||
+      !meta_cursor_tracker_get_pointer_visible (cursor_tracker) ||
+      meta_stage_view_is_cursor_overlay_inhibited (META_STAGE_VIEW (stage_view)))
+    return FALSE;
+
+  meta_cursor_tracker_get_pointer (cursor_tracker, &position, NULL);
+  meta_cursor_tracker_get_hot (cursor_tracker, &hotspot_x, &hotspot_y);
+
+  scale = (clutter_stage_view_get_scale (stage_view) *
+           meta_cursor_tracker_get_scale (cursor_tracker));
+
+  graphene_rect_init (&cursor_rect,
+                      position.x - (hotspot_x * scale),
+                      position.y - (hotspot_y * scale),
+                      cogl_texture_get_width (cursor_sprite) * scale,
+                      cogl_texture_get_height (cursor_sprite) * scale);
+
+  return graphene_rect_intersection (rect, &cursor_rect, NULL);
+}
+
 static gboolean
 find_scanout_candidate (MetaCompositorView  *compositor_view,
                         MetaCompositor      *compositor,
@@ -77,16 +206,12 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
 {
   ClutterStageView *stage_view =
     meta_compositor_view_get_stage_view (compositor_view);
-  MetaStageView *view = META_STAGE_VIEW (stage_view);
   MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
-  MetaBackend *backend = meta_compositor_get_backend (compositor);
-  MetaCursorTracker *cursor_tracker =
-    meta_backend_get_cursor_tracker (backend);
-  CoglTexture *cursor_sprite;
   MetaCrtc *crtc;
   CoglFramebuffer *framebuffer;
   MetaWindowActor *window_actor;
   MtkRectangle view_rect;
+  graphene_rect_t graphene_view_rect;
   ClutterActorBox actor_box;
   MetaSurfaceActor *surface_actor;
   MetaSurfaceActorWayland *surface_actor_wayland;
@@ -101,39 +226,12 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
 
   clutter_stage_view_get_layout (stage_view, &view_rect);
 
-  cursor_sprite = meta_cursor_tracker_get_sprite (cursor_tracker);
-  if (cursor_sprite &&
-      meta_cursor_tracker_get_pointer_visible (cursor_tracker) &&
-      !meta_stage_view_is_cursor_overlay_inhibited (view))
-    {
-      graphene_rect_t graphene_view_rect;
-      graphene_rect_t cursor_rect;
-      graphene_point_t position;
-      float scale;
-      int hotspot_x;
-      int hotspot_y;
-
-      meta_cursor_tracker_get_pointer (cursor_tracker, &position, NULL);
-      meta_cursor_tracker_get_hot (cursor_tracker, &hotspot_x, &hotspot_y);
-
-      scale = (clutter_stage_view_get_scale (stage_view) *
-               meta_cursor_tracker_get_scale (cursor_tracker));
-
-      graphene_rect_init (&cursor_rect,
-                          position.x - (hotspot_x * scale),
-                          position.y - (hotspot_y * scale),
-                          cogl_texture_get_width (cursor_sprite) * scale,
-                          cogl_texture_get_height (cursor_sprite) * scale);
-
-      graphene_view_rect = mtk_rectangle_to_graphene_rect (&view_rect);
-      if (graphene_rect_intersection (&graphene_view_rect,
-                                      &cursor_rect,
-                                      NULL))
-        {
-          meta_topic (META_DEBUG_RENDER,
-                      "No direct scanout candidate: using software cursor");
-          return FALSE;
-        }
+  graphene_view_rect = mtk_rectangle_to_graphene_rect (&view_rect);
+  if (is_software_cursor_in_rect (compositor, stage_view, &graphene_view_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No direct scanout candidate: using software cursor");
+      return FALSE;
     }
 
   crtc = meta_renderer_view_get_crtc (renderer_view);
@@ -239,7 +337,254 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
   return TRUE;
 }
 
+static gboolean
+is_actor_topmost_in_rect (ClutterActor          *actor,
+                          const graphene_rect_t *rect)
+{
+  ClutterActor *child = actor;
+  ClutterActor *parent;
+
+  /* Anything painted after the actor inside its area would end up below
+   * the overlay plane */
+  while ((parent = clutter_actor_get_parent (child)))
+    {
+      ClutterActor *sibling;
+
+      for (sibling = clutter_actor_get_next_sibling (child);
+           sibling;
+           sibling = clutter_actor_get_next_sibling (sibling))
+        {
+          ClutterActorBox box;
+          graphene_rect_t sibling_rect;
+
+          if (!clutter_actor_is_mapped (sibling))
+            continue;
+
+          if (!clutter_actor_get_paint_box (sibling, &box))
+            return FALSE;
+
+          graphene_rect_init (&sibling_rect,
+                              box.x1, box.y1,
+                              box.x2 - box.x1, box.y2 - box.y1);
+          if (graphene_rect_intersection (&sibling_rect, rect, NULL))
+            return FALSE;
+        }
+
+      child = parent;
+    }
+
+  return TRUE;
+}
+
+/* Plane scalers often filter worse than the GPU does, so content that
+ * wants to be shown faithfully only goes on a plane unscaled */
+static gboolean
+is_surface_scaled (MetaWaylandSurface    *surface,
+                   ClutterStageView      *stage_view,
+                   const graphene_rect_t *surface_rect)
+{
+  float view_scale = clutter_stage_view_get_scale (stage_view);
+  float src_width, src_height;
+  int dst_width, dst_height;
+
+  if (surface->viewport.has_src_rect)
+    {
+      src_width = (surface->viewport.src_rect.size.width *
+                   surface->applied_state.scale);
+      src_height = (surface->viewport.src_rect.size.height *
+                    surface->applied_state.scale);
+    }
+  else
+    {
+      src_width = meta_wayland_surface_get_buffer_width (surface);
+      src_height = meta_wayland_surface_get_buffer_height (surface);
+    }
+
+  if (meta_monitor_transform_is_rotated (surface->buffer_transform))
+    {
+      float tmp = src_width;
+
+      src_width = src_height;
+      src_height = tmp;
+    }
+
+  dst_width = roundf (surface_rect->size.width * view_scale);
+  dst_height = roundf (surface_rect->size.height * view_scale);
+
+  return dst_width != roundf (src_width) || dst_height != roundf (src_height);
+}
+
+static gboolean
+find_overlay_candidate (MetaCompositorView  *compositor_view,
+                        MetaCompositor      *compositor,
+                        MetaCrtc           **crtc_out,
+                        MetaWaylandSurface **surface_out)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
+  MetaCrtc *crtc;
+  MetaWindowActor *window_actor;
+  MetaSurfaceActor *surface_actor;
+  MetaSurfaceActorWayland *surface_actor_wayland;
+  MetaWaylandSurface *surface;
+  MtkRectangle view_rect;
+  ClutterActorBox actor_box;
+  graphene_rect_t graphene_view_rect;
+  graphene_rect_t surface_rect;
+
+  if (meta_compositor_is_unredirect_inhibited (compositor))
+    return FALSE;
+
+  crtc = meta_renderer_view_get_crtc (renderer_view);
+  if (!META_IS_CRTC_KMS (crtc) ||
+      !meta_crtc_kms_get_assigned_overlay_plane (META_CRTC_KMS (crtc)))
+    return FALSE;
+
+  if (clutter_stage_view_has_shadowfb (stage_view))
+    return FALSE;
+
+  window_actor = meta_compositor_view_get_top_window_actor (compositor_view);
+  if (!window_actor)
+    return FALSE;
+
+  if (meta_window_actor_effect_in_progress (window_actor) ||
+      clutter_actor_has_transitions (CLUTTER_ACTOR (window_actor)))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: window-actor is animated");
+      return FALSE;
+    }
+
+  surface_actor = meta_window_actor_get_scanout_candidate (window_actor);
+  if (!surface_actor)
+    return FALSE;
+
+  if (!meta_surface_actor_is_opaque (surface_actor) ||
+      clutter_actor_get_paint_opacity (CLUTTER_ACTOR (surface_actor)) != 255)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: surface-actor is not opaque");
+      return FALSE;
+    }
+
+  if (meta_surface_actor_is_effectively_obscured (surface_actor) ||
+      !clutter_actor_get_paint_box (CLUTTER_ACTOR (surface_actor), &actor_box))
+    return FALSE;
+
+  clutter_stage_view_get_layout (stage_view, &view_rect);
+  graphene_view_rect = mtk_rectangle_to_graphene_rect (&view_rect);
+  graphene_rect_init (&surface_rect,
+                      actor_box.x1, actor_box.y1,
+                      actor_box.x2 - actor_box.x1,
+                      actor_box.y2 - actor_box.y1);
+  if (!graphene_rect_contains_rect (&graphene_view_rect, &surface_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: surface-actor not within stage-view");
+      return FALSE;
+    }
+
+  if (!is_actor_topmost_in_rect (CLUTTER_ACTOR (surface_actor), &surface_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: surface-actor is covered by other actors");
+      return FALSE;
+    }
+
+  if (is_software_cursor_in_rect (compositor, stage_view, &surface_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: using software cursor");
+      return FALSE;
+    }
+
+  surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (surface_actor);
+  surface = meta_surface_actor_wayland_get_surface (surface_actor_wayland);
+  if (!surface)
+    return FALSE;
+
+  if (meta_wayland_surface_get_content_type (surface) ==
+      META_WAYLAND_CONTENT_TYPE_PHOTO &&
+      is_surface_scaled (surface, stage_view, &surface_rect))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay candidate: photo content would be scaled by "
+                  "the plane");
+      return FALSE;
+    }
+
+  *crtc_out = crtc;
+  *surface_out = surface;
+
+  return TRUE;
+}
+
 static void
+update_overlay_scanout_surface (MetaCompositorViewNative *view_native,
+                                MetaWaylandSurface       *surface)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+
+  if (view_native->overlay_scanout_surface &&
+      view_native->overlay_scanout_surface != surface)
+    {
+      meta_wayland_surface_set_overlay_scanout_view (view_native->overlay_scanout_surface,
+                                                     NULL);
+      g_clear_weak_pointer (&view_native->overlay_scanout_surface);
+    }
+
+  if (surface)
+    {
+      meta_wayland_surface_set_overlay_scanout_view (surface, stage_view);
+      g_set_weak_pointer (&view_native->overlay_scanout_surface, surface);
+    }
+}
+
+static void
+update_overlay_scanout (MetaCompositorView  *compositor_view,
+                        MetaCompositor      *compositor,
+                        MetaCrtc           **crtc_out,
+                        MetaWaylandSurface **surface_out)
+{
+  ClutterStageView *stage_view;
+  CoglFramebuffer *framebuffer;
+  CoglOnscreen *onscreen;
+  MetaCrtc *crtc = NULL;
+  MetaWaylandSurface *surface = NULL;
+  g_autoptr (CoglScanout) scanout = NULL;
+
+  stage_view = meta_compositor_view_get_stage_view (compositor_view);
+  framebuffer = clutter_stage_view_get_onscreen (stage_view);
+  if (!META_IS_ONSCREEN_NATIVE (framebuffer))
+    return;
+
+  onscreen = COGL_ONSCREEN (framebuffer);
+
+  if (find_overlay_candidate (compositor_view, compositor, &crtc, &surface))
+    {
+      *crtc_out = crtc;
+      *surface_out = surface;
+
+      scanout = meta_wayland_surface_try_acquire_scanout (surface,
+                                                          onscreen,
+                                                          stage_view,
+                                                          META_WAYLAND_SCANOUT_PLANE_OVERLAY);
+      if (!scanout)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "Could not acquire overlay scanout");
+        }
+    }
+
+  meta_onscreen_native_set_overlay_scanout (onscreen, scanout);
+  update_overlay_scanout_surface (META_COMPOSITOR_VIEW_NATIVE (compositor_view),
+                                  scanout ? surface : NULL);
+}
+
+static gboolean
 try_assign_next_scanout (MetaCompositorView *compositor_view,
                          CoglOnscreen       *onscreen,
                          MetaWaylandSurface *surface)
@@ -250,15 +595,17 @@ try_assign_next_scanout (MetaCompositorView *compositor_view,
   stage_view = meta_compositor_view_get_stage_view (compositor_view);
   scanout = meta_wayland_surface_try_acquire_scanout (surface,
                                                       onscreen,
-                                                      stage_view);
+                                                      stage_view,
+                                                      META_WAYLAND_SCANOUT_PLANE_PRIMARY);
   if (!scanout)
     {
       meta_topic (META_DEBUG_RENDER,
                   "Could not acquire scanout");
-      return;
+      return FALSE;
     }
 
   clutter_stage_view_assign_next_scanout (stage_view, scanout);
+  return TRUE;
 }
 
 void
@@ -269,6 +616,8 @@ meta_compositor_view_native_maybe_assign_scanout (MetaCompositorViewNative *view
   MetaCrtc *crtc = NULL;
   CoglOnscreen *onscreen = NULL;
   MetaWaylandSurface *surface = NULL;
+  MetaCrtc *overlay_crtc = NULL;
+  MetaWaylandSurface *overlay_surface = NULL;
   gboolean candidate_found;
 
   candidate_found = find_scanout_candidate (compositor_view,
@@ -276,14 +625,50 @@ meta_compositor_view_native_maybe_assign_scanout (MetaCompositorViewNative *view
                                             &crtc,
                                             &onscreen,
                                             &surface);
-  if (candidate_found)
+  if (candidate_found &&
+      !try_assign_next_scanout (compositor_view, onscreen, surface) &&
+      meta_wayland_surface_get_content_type (surface) ==
+      META_WAYLAND_CONTENT_TYPE_VIDEO)
+    {
+      /* Video buffers are often in formats or sizes the primary plane can't
+       * take, but an overlay plane might, which still avoids compositing
+       * every frame of the video */
+      update_overlay_scanout (compositor_view, compositor,
+                              &overlay_crtc, &overlay_surface);
+    }
+  else if (candidate_found)
     {
-      try_assign_next_scanout (compositor_view,
-                               onscreen,
-                               surface);
+      meta_onscreen_native_set_overlay_scanout (onscreen, NULL);
+      update_overlay_scanout_surface (view_native, NULL);
+    }
+  else
+    {
+      update_overlay_scanout (compositor_view, compositor,
+                              &overlay_crtc, &overlay_surface);
     }
 
-  update_scanout_candidate (view_native, surface, crtc);
+  /* Surfaces that could go on an overlay plane get feedback for it too, so
+   * that they can allocate buffers the plane can scan out */
+  if (overlay_surface)
+    {
+      update_scanout_candidate (view_native, overlay_surface, overlay_crtc,
+                                META_WAYLAND_SCANOUT_PLANE_OVERLAY);
+    }
+  else
+    {
+      update_scanout_candidate (view_native, surface, crtc,
+                                META_WAYLAND_SCANOUT_PLANE_PRIMARY);
+    }
+  /* Still images have no frame rate for the refresh rate to follow */
+  if (surface &&
+      meta_wayland_surface_get_content_type (surface) ==
+      META_WAYLAND_CONTENT_TYPE_PHOTO)
+    update_frame_sync_surface (view_native, NULL);
+  else
+    update_frame_sync_surface (view_native,
+                               surface ? meta_wayland_surface_get_actor (surface)
+                                       : NULL);
+  update_allows_tearing (view_native, surface, crtc);
 }
 #endif /* HAVE_WAYLAND */
 
@@ -304,6 +689,14 @@ meta_compositor_view_native_finalize (GObject *object)
   MetaCompositorViewNative *view_native = META_COMPOSITOR_VIEW_NATIVE (object);
 
   g_clear_weak_pointer (&view_native->scanout_candidate);
+  update_overlay_scanout_surface (view_native, NULL);
+
+  if (view_native->frame_sync_surface)
+    {
+      g_clear_signal_handler (&view_native->frame_sync_repaint_scheduled_id,
+                              view_native->frame_sync_surface);
+      g_clear_weak_pointer (&view_native->frame_sync_surface);
+    }
 #endif /* HAVE_WAYLAND */
 
   G_OBJECT_CLASS (meta_compositor_view_native_parent_class)->finalize (object);
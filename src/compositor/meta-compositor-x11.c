@@ -32,6 +32,15 @@
 #include "core/display-private.h"
 #include "x11/meta-x11-display-private.h"
 
+/* After a window had to be composited again, e.g. because a notification
+ * appeared on top of it, wait this long before unredirecting it again.
+ * The wait is doubled each time an unredirection didn't last longer than
+ * UNREDIRECT_MIN_DURATION_US, up to UNREDIRECT_MAX_HOLDOFF_US, so that
+ * overlays popping up repeatedly don't make us switch back and forth. */
+#define UNREDIRECT_HOLDOFF_US (G_USEC_PER_SEC / 2)
+#define UNREDIRECT_MAX_HOLDOFF_US (8 * G_USEC_PER_SEC)
+#define UNREDIRECT_MIN_DURATION_US (5 * G_USEC_PER_SEC)
+
 struct _MetaCompositorX11
 {
   MetaCompositor parent;
@@ -45,6 +54,10 @@ struct _MetaCompositorX11
   gboolean have_x11_sync_object;
 
   MetaWindow *unredirected_window;
+  MetaUnredirectState unredirect_state;
+  int64_t unredirect_time_us;
+  int64_t redirect_time_us;
+  int64_t unredirect_holdoff_us;
 
   gboolean xserver_uses_monotonic_clock;
   int64_t xserver_time_query_time_us;
@@ -299,6 +312,18 @@ set_unredirected_window (MetaCompositorX11 *compositor_x11,
     }
 }
 
+static void
+update_unredirect_state (MetaCompositorX11   *compositor_x11,
+                         MetaUnredirectState  state)
+{
+  if (compositor_x11->unredirect_state == state)
+    return;
+
+  meta_topic (META_DEBUG_RENDER, "Unredirection state changed to %s",
+              meta_unredirect_state_to_string (state));
+  compositor_x11->unredirect_state = state;
+}
+
 static void
 maybe_unredirect_top_window (MetaCompositorX11 *compositor_x11)
 {
@@ -306,24 +331,105 @@ maybe_unredirect_top_window (MetaCompositorX11 *compositor_x11)
   MetaWindow *window_to_unredirect = NULL;
   MetaWindowActor *window_actor;
   MetaWindowActorX11 *window_actor_x11;
+  MetaUnredirectState state;
+  int64_t now_us = g_get_monotonic_time ();
 
   if (meta_compositor_is_unredirect_inhibited (compositor))
-    goto out;
+    {
+      state = META_UNREDIRECT_STATE_INHIBITED;
+      goto out;
+    }
 
   window_actor = meta_compositor_get_top_window_actor (compositor);
   if (!window_actor)
-    goto out;
+    {
+      state = META_UNREDIRECT_STATE_NO_CANDIDATE;
+      goto out;
+    }
 
   window_actor_x11 = META_WINDOW_ACTOR_X11 (window_actor);
   if (!meta_window_actor_x11_should_unredirect (window_actor_x11))
-    goto out;
+    {
+      state = META_UNREDIRECT_STATE_NO_CANDIDATE;
+      goto out;
+    }
 
   window_to_unredirect = meta_window_actor_get_meta_window (window_actor);
+  state = META_UNREDIRECT_STATE_UNREDIRECTED;
+
+  if (!compositor_x11->unredirected_window &&
+      now_us - compositor_x11->redirect_time_us <
+      compositor_x11->unredirect_holdoff_us)
+    {
+      window_to_unredirect = NULL;
+      state = META_UNREDIRECT_STATE_HOLDING_OFF;
+    }
 
 out:
+  if (compositor_x11->unredirected_window != window_to_unredirect)
+    {
+      if (window_to_unredirect)
+        {
+          compositor_x11->unredirect_time_us = now_us;
+        }
+      else
+        {
+          if (now_us - compositor_x11->unredirect_time_us <
+              UNREDIRECT_MIN_DURATION_US)
+            {
+              compositor_x11->unredirect_holdoff_us =
+                MIN (compositor_x11->unredirect_holdoff_us * 2,
+                     UNREDIRECT_MAX_HOLDOFF_US);
+            }
+          else
+            {
+              compositor_x11->unredirect_holdoff_us = UNREDIRECT_HOLDOFF_US;
+            }
+
+          compositor_x11->redirect_time_us = now_us;
+        }
+    }
+
+  update_unredirect_state (compositor_x11, state);
   set_unredirected_window (compositor_x11, window_to_unredirect);
 }
 
+const char *
+meta_unredirect_state_to_string (MetaUnredirectState state)
+{
+  switch (state)
+    {
+    case META_UNREDIRECT_STATE_NO_CANDIDATE:
+      return "no-candidate";
+    case META_UNREDIRECT_STATE_INHIBITED:
+      return "inhibited";
+    case META_UNREDIRECT_STATE_HOLDING_OFF:
+      return "holding-off";
+    case META_UNREDIRECT_STATE_UNREDIRECTED:
+      return "unredirected";
+    }
+
+  g_assert_not_reached ();
+}
+
+/**
+ * meta_compositor_x11_get_unredirect_state:
+ * @compositor_x11: a #MetaCompositorX11
+ * @unredirected_window: (out) (optional) (transfer none): the window that
+ *   currently bypasses the compositor, if any
+ *
+ * Returns: why the top window is or isn't unredirected, as of the last frame
+ */
+MetaUnredirectState
+meta_compositor_x11_get_unredirect_state (MetaCompositorX11  *compositor_x11,
+                                          MetaWindow        **unredirected_window)
+{
+  if (unredirected_window)
+    *unredirected_window = compositor_x11->unredirected_window;
+
+  return compositor_x11->unredirect_state;
+}
+
 static void
 on_before_update (ClutterStage     *stage,
                   ClutterStageView *stage_view,
@@ -522,6 +628,7 @@ meta_compositor_x11_dispose (GObject *object)
 static void
 meta_compositor_x11_init (MetaCompositorX11 *compositor_x11)
 {
+  compositor_x11->unredirect_holdoff_us = UNREDIRECT_HOLDOFF_US;
 }
 
 static void
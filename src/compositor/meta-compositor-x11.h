@@ -20,6 +20,14 @@
 
 #include "compositor/compositor-private.h"
 
+typedef enum _MetaUnredirectState
+{
+  META_UNREDIRECT_STATE_NO_CANDIDATE,
+  META_UNREDIRECT_STATE_INHIBITED,
+  META_UNREDIRECT_STATE_HOLDING_OFF,
+  META_UNREDIRECT_STATE_UNREDIRECTED,
+} MetaUnredirectState;
+
 #define META_TYPE_COMPOSITOR_X11 (meta_compositor_x11_get_type ())
 G_DECLARE_FINAL_TYPE (MetaCompositorX11, meta_compositor_x11,
                       META, COMPOSITOR_X11, MetaCompositor)
@@ -32,3 +40,8 @@ void meta_compositor_x11_process_xevent (MetaCompositorX11 *compositor_x11,
                                          MetaWindow        *window);
 
 Window meta_compositor_x11_get_output_xwindow (MetaCompositorX11 *compositor_x11);
+
+MetaUnredirectState meta_compositor_x11_get_unredirect_state (MetaCompositorX11  *compositor_x11,
+                                                              MetaWindow        **unredirected_window);
+
+const char * meta_unredirect_state_to_string (MetaUnredirectState state);
@@ -35,6 +35,11 @@ has_active_effects (ClutterActor *actor)
   g_autoptr (GList) effects = NULL;
   GList *l;
 
+  /* Redirecting is implemented with an internal effect */
+  if (clutter_actor_get_offscreen_redirect (actor) &
+      (CLUTTER_OFFSCREEN_REDIRECT_ALWAYS | CLUTTER_OFFSCREEN_REDIRECT_ON_IDLE))
+    return TRUE;
+
   effects = clutter_actor_get_effects (actor);
   for (l = effects; l != NULL; l = l->next)
     {
@@ -77,10 +82,39 @@ region_apply_transform_expand_maybe_ref (MtkRegion         *region,
 typedef void (* ChildCullMethod) (MetaCullable *cullable,
                                   MtkRegion    *region);
 
+static gboolean
+is_child_occluded (ClutterActor *actor,
+                   ClutterActor *child,
+                   MtkRegion    *region)
+{
+  g_autoptr (ClutterPaintVolume) paint_volume = NULL;
+  graphene_point3d_t origin;
+  graphene_rect_t rect;
+  MtkRectangle paint_rect;
+
+  if (mtk_region_is_empty (region))
+    return TRUE;
+
+  paint_volume = clutter_actor_get_transformed_paint_volume (child, actor);
+  if (!paint_volume)
+    return FALSE;
+
+  clutter_paint_volume_get_origin (paint_volume, &origin);
+  rect = GRAPHENE_RECT_INIT (origin.x, origin.y,
+                             clutter_paint_volume_get_width (paint_volume),
+                             clutter_paint_volume_get_height (paint_volume));
+  mtk_rectangle_from_graphene_rect (&rect, MTK_ROUNDING_STRATEGY_GROW,
+                                    &paint_rect);
+
+  return (mtk_region_contains_rectangle (region, &paint_rect) ==
+          MTK_REGION_OVERLAP_OUT);
+}
+
 static void
 cull_out_children_common (MetaCullable    *cullable,
                           MtkRegion       *region,
-                          ChildCullMethod  method)
+                          ChildCullMethod  method,
+                          GHashTable      *occluded_children)
 {
   ClutterActor *actor = CLUTTER_ACTOR (cullable);
   ClutterActor *child;
@@ -111,13 +145,18 @@ cull_out_children_common (MetaCullable    *cullable,
        * of the FBO later. So, skipping actors with effects applied also
        * prevents these bugs.
        *
-       * Theoretically, we should check clutter_actor_get_offscreen_redirect()
-       * as well for the same reason, but omitted for simplicity in the
-       * hopes that no-one will do that.
+       * Actors that are always or idly redirected offscreen are skipped for
+       * the same reason, e.g. window actors while their updates are frozen.
        */
       if (needs_culling && has_active_effects (child))
         needs_culling = FALSE;
 
+      /* Nothing the child paints, including shadows, would end up within
+       * the region that is still visible from above. */
+      if (needs_culling && occluded_children &&
+          is_child_occluded (actor, child, region))
+        g_hash_table_add (occluded_children, child);
+
       if (needs_culling)
         {
           g_autoptr (MtkRegion) actor_region = NULL;
@@ -180,7 +219,8 @@ meta_cullable_cull_unobscured_children (MetaCullable *cullable,
 {
   cull_out_children_common (cullable,
                             unobscured_region,
-                            meta_cullable_cull_unobscured);
+                            meta_cullable_cull_unobscured,
+                            NULL);
 }
 
 /**
@@ -199,7 +239,30 @@ meta_cullable_cull_redraw_clip_children (MetaCullable *cullable,
 {
   cull_out_children_common (cullable,
                             clip_region,
-                            meta_cullable_cull_redraw_clip);
+                            meta_cullable_cull_redraw_clip,
+                            NULL);
+}
+
+/**
+ * meta_cullable_cull_redraw_clip_children_occluded:
+ * @cullable: The #MetaCullable
+ * @clip_region: The clip region, as passed into cull_redraw_clip()
+ * @occluded_children: A set the fully occluded children are added to
+ *
+ * Like meta_cullable_cull_redraw_clip_children(), but also collects the
+ * children whose whole paint volume is outside of what is left of
+ * @clip_region after culling the children above them. These don't need
+ * to be painted at all.
+ */
+void
+meta_cullable_cull_redraw_clip_children_occluded (MetaCullable *cullable,
+                                                  MtkRegion    *clip_region,
+                                                  GHashTable   *occluded_children)
+{
+  cull_out_children_common (cullable,
+                            clip_region,
+                            meta_cullable_cull_redraw_clip,
+                            occluded_children);
 }
 
 static void
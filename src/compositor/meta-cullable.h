@@ -51,5 +51,8 @@ void meta_cullable_cull_unobscured_children (MetaCullable *cullable,
                                              MtkRegion    *unobscured_region);
 void meta_cullable_cull_redraw_clip_children (MetaCullable *cullable,
                                               MtkRegion    *clip_region);
+void meta_cullable_cull_redraw_clip_children_occluded (MetaCullable *cullable,
+                                                       MtkRegion    *clip_region,
+                                                       GHashTable   *occluded_children);
 
 G_END_DECLS
@@ -43,7 +43,41 @@
  *   in blocks, blur rows again, and then transpose back.
  *
  * - We approximate the 1D gaussian blur as 3 successive box filters.
+ *
+ * - Shadows of plain rectangles without a faded top don't need a
+ *   texture at all; the blurred rectangle is evaluated analytically in
+ *   the fragment shader instead, which works for any size.
+ */
+
+#define ANALYTIC_SHADOW_VERTEX_SHADER_DECLARATIONS                       \
+"varying vec2 shadow_position;\n"                                        \
+
+#define ANALYTIC_SHADOW_VERTEX_SHADER_CODE                               \
+"shadow_position = cogl_tex_coord0_in.xy;\n"                             \
+
+/* The convolution of a box with a gaussian is the product of the
+ * differences of the gaussian's cumulative distribution function at the
+ * box edges in each direction; erf() is approximated with the
+ * Abramowitz and Stegun formula 7.1.27.
  */
+#define ANALYTIC_SHADOW_FRAGMENT_SHADER_DECLARATIONS                     \
+"uniform vec2 shadow_size;\n"                                            \
+"uniform float shadow_sigma;\n"                                          \
+"varying vec2 shadow_position;\n"                                        \
+"vec4 shadow_erf (vec4 x)\n"                                             \
+"{\n"                                                                    \
+"  vec4 s = sign (x);\n"                                                 \
+"  vec4 a = abs (x);\n"                                                  \
+"  x = 1.0 + (0.278393 + (0.230389 + 0.078108 * (a * a)) * a) * a;\n"    \
+"  x *= x;\n"                                                            \
+"  return s - s / (x * x);\n"                                            \
+"}\n"                                                                    \
+
+#define ANALYTIC_SHADOW_FRAGMENT_SHADER_CODE                             \
+"vec4 query = vec4 (shadow_position, shadow_position - shadow_size);\n"  \
+"vec4 integral = 0.5 + 0.5 * shadow_erf (query * (0.7071068 / shadow_sigma));\n" \
+"float shadow_alpha = (integral.x - integral.z) * (integral.y - integral.w);\n" \
+"cogl_color_out = vec4 (0.0, 0.0, 0.0, cogl_color_out.a * shadow_alpha);\n" \
 
 typedef struct _MetaShadowCacheKey  MetaShadowCacheKey;
 typedef struct _MetaShadowClassInfo MetaShadowClassInfo;
@@ -78,6 +112,7 @@ struct _MetaShadow
 
   guint scale_width : 1;
   guint scale_height : 1;
+  guint is_analytic : 1;
 };
 
 struct _MetaShadowClassInfo
@@ -166,13 +201,87 @@ meta_shadow_unref (MetaShadow *shadow)
         }
 
       meta_window_shape_unref (shadow->key.shape);
-      g_object_unref (shadow->texture);
+      g_clear_object (&shadow->texture);
       g_object_unref (shadow->pipeline);
 
       g_free (shadow);
     }
 }
 
+static void
+paint_analytic_shadow (MetaShadow      *shadow,
+                       CoglFramebuffer *framebuffer,
+                       int              window_x,
+                       int              window_y,
+                       int              window_width,
+                       int              window_height,
+                       MtkRegion       *clip,
+                       gboolean         clip_strictly)
+{
+  MtkRectangle bounds;
+  MtkRegionOverlap overlap;
+  float size[2] = { window_width, window_height };
+  int location;
+
+  location = cogl_pipeline_get_uniform_location (shadow->pipeline,
+                                                 "shadow_size");
+  cogl_pipeline_set_uniform_float (shadow->pipeline, location, 2, 1, size);
+
+  meta_shadow_get_bounds (shadow,
+                          window_x, window_y,
+                          window_width, window_height,
+                          &bounds);
+
+  if (clip)
+    overlap = mtk_region_contains_rectangle (clip, &bounds);
+  else
+    overlap = MTK_REGION_OVERLAP_IN;
+
+  if (overlap == MTK_REGION_OVERLAP_OUT)
+    return;
+
+  /* Texture coordinates are the positions relative to the window, which
+   * is what the shader evaluates the shadow at.
+   */
+  if (overlap == MTK_REGION_OVERLAP_IN || !clip_strictly)
+    {
+      cogl_framebuffer_draw_textured_rectangle (framebuffer,
+                                                shadow->pipeline,
+                                                bounds.x, bounds.y,
+                                                bounds.x + bounds.width,
+                                                bounds.y + bounds.height,
+                                                bounds.x - window_x,
+                                                bounds.y - window_y,
+                                                bounds.x + bounds.width - window_x,
+                                                bounds.y + bounds.height - window_y);
+    }
+  else
+    {
+      g_autoptr (MtkRegion) intersection = NULL;
+      int n_rectangles, i;
+
+      intersection = mtk_region_create_rectangle (&bounds);
+      mtk_region_intersect (intersection, clip);
+
+      n_rectangles = mtk_region_num_rectangles (intersection);
+      for (i = 0; i < n_rectangles; i++)
+        {
+          MtkRectangle rect;
+
+          rect = mtk_region_get_rectangle (intersection, i);
+          cogl_framebuffer_draw_textured_rectangle (framebuffer,
+                                                    shadow->pipeline,
+                                                    rect.x, rect.y,
+                                                    rect.x + rect.width,
+                                                    rect.y + rect.height,
+                                                    rect.x - window_x,
+                                                    rect.y - window_y,
+                                                    rect.x + rect.width - window_x,
+                                                    rect.y + rect.height - window_y);
+        }
+    }
+}
+
 /**
  * meta_shadow_paint:
  * @window_x: x position of the region to paint a shadow for
@@ -202,8 +311,8 @@ meta_shadow_paint (MetaShadow      *shadow,
                    MtkRegion       *clip,
                    gboolean         clip_strictly)
 {
-  float texture_width = cogl_texture_get_width (shadow->texture);
-  float texture_height = cogl_texture_get_height (shadow->texture);
+  float texture_width;
+  float texture_height;
   int i, j;
   float src_x[4];
   float src_y[4];
@@ -217,6 +326,18 @@ meta_shadow_paint (MetaShadow      *shadow,
   cogl_pipeline_set_color4ub (shadow->pipeline,
                               opacity, opacity, opacity, opacity);
 
+  if (shadow->is_analytic)
+    {
+      paint_analytic_shadow (shadow, framebuffer,
+                             window_x, window_y,
+                             window_width, window_height,
+                             clip, clip_strictly);
+      return;
+    }
+
+  texture_width = cogl_texture_get_width (shadow->texture);
+  texture_height = cogl_texture_get_height (shadow->texture);
+
   if (shadow->scale_width)
     {
       n_x = 3;
@@ -528,6 +649,7 @@ blur_xspan (guchar *row,
 {
   int offset;
   int sum = 0;
+  uint64_t reciprocal;
   int i;
 
   if (d % 2 == 1)
@@ -535,14 +657,21 @@ blur_xspan (guchar *row,
   else
     offset = (d - shift) / 2;
 
+  /* Dividing by d is done by multiplying with a 32.32 fixed point
+   * reciprocal, rounded up. The error this introduces is below d / 2^32
+   * per unit of the dividend, and the dividend never exceeds 256 * d,
+   * so the result is exactly the same as the integer division for any
+   * blur width below 4096. Wider blurs fall back to dividing.
+   */
+  if (d < 4096)
+    reciprocal = ((G_GUINT64_CONSTANT (1) << 32) + d - 1) / d;
+  else
+    reciprocal = 0;
+
   /* All the conditionals in here look slow, but the branches will
    * be well predicted and there are enough different possibilities
    * that trying to write this as a series of unconditional loops
-   * is hard and not an obvious win. The main slow down here seems
-   * to be the integer division per pixel; one possible optimization
-   * would be to accumulate into two 16-bit integer buffers and
-   * only divide down after all three passes. (SSE parallel implementation
-   * of the divide step is possible.)
+   * is hard and not an obvious win.
    */
   for (i = x0 - d + offset; i < x1 + offset; i++)
     {
@@ -554,7 +683,11 @@ blur_xspan (guchar *row,
           if (i >= d)
             sum -= row[i - d];
 
-          tmp_buffer[i - offset] = (sum + d / 2) / d;
+          if (G_LIKELY (reciprocal))
+            tmp_buffer[i - offset] =
+              (guchar) (((uint64_t) (sum + d / 2) * reciprocal) >> 32);
+          else
+            tmp_buffer[i - offset] = (sum + d / 2) / d;
         }
     }
 
@@ -953,6 +1086,52 @@ make_shadow (MetaShadow *shadow,
   shadow->pipeline = meta_create_texture_pipeline (shadow->texture);
 }
 
+static void
+make_analytic_shadow (MetaShadow *shadow)
+{
+  static CoglPipeline *analytic_shadow_pipeline_template = NULL;
+  int location;
+
+  if (G_UNLIKELY (analytic_shadow_pipeline_template == NULL))
+    {
+      CoglSnippet *snippet;
+
+      analytic_shadow_pipeline_template = meta_create_texture_pipeline (NULL);
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX,
+                                  ANALYTIC_SHADOW_VERTEX_SHADER_DECLARATIONS,
+                                  ANALYTIC_SHADOW_VERTEX_SHADER_CODE);
+      cogl_pipeline_add_snippet (analytic_shadow_pipeline_template, snippet);
+      g_object_unref (snippet);
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                  ANALYTIC_SHADOW_FRAGMENT_SHADER_DECLARATIONS,
+                                  ANALYTIC_SHADOW_FRAGMENT_SHADER_CODE);
+      cogl_pipeline_add_snippet (analytic_shadow_pipeline_template, snippet);
+      g_object_unref (snippet);
+    }
+
+  shadow->is_analytic = TRUE;
+  shadow->pipeline = cogl_pipeline_copy (analytic_shadow_pipeline_template);
+
+  /* The three box blurs approximate a gaussian with the radius as its
+   * standard deviation, see get_box_filter_size(). */
+  location = cogl_pipeline_get_uniform_location (shadow->pipeline,
+                                                 "shadow_sigma");
+  cogl_pipeline_set_uniform_1f (shadow->pipeline, location,
+                                shadow->key.radius);
+}
+
+static gboolean
+is_rectangular_shape (MetaWindowShape *shape)
+{
+  g_autoptr (MtkRegion) region = NULL;
+
+  region = meta_window_shape_to_region (shape, 1, 1);
+
+  return mtk_region_num_rectangles (region) == 1;
+}
+
 static MetaShadowParams *
 get_shadow_params (MetaShadowFactory *factory,
                    const char        *class_name,
@@ -1052,6 +1231,40 @@ meta_shadow_factory_get_shadow (MetaShadowFactory *factory,
   params = get_shadow_params (factory, class_name, focused, FALSE);
 
   spread = get_shadow_spread (params->radius);
+
+  /* The shadow of a rectangle can be drawn at any size without a texture,
+   * as long as the top doesn't need to be faded out. */
+  if (params->radius > 0 && params->top_fade < 0 &&
+      is_rectangular_shape (shape))
+    {
+      key.shape = shape;
+      key.radius = params->radius;
+      key.top_fade = params->top_fade;
+
+      shadow = g_hash_table_lookup (factory->shadows, &key);
+      if (shadow)
+        return meta_shadow_ref (shadow);
+
+      shadow = g_new0 (MetaShadow, 1);
+
+      shadow->ref_count = 1;
+      shadow->factory = factory;
+      shadow->key.shape = meta_window_shape_ref (shape);
+      shadow->key.radius = params->radius;
+      shadow->key.top_fade = params->top_fade;
+
+      shadow->outer_border_top = spread;
+      shadow->outer_border_right = spread;
+      shadow->outer_border_bottom = spread;
+      shadow->outer_border_left = spread;
+
+      make_analytic_shadow (shadow);
+
+      g_hash_table_insert (factory->shadows, &shadow->key, shadow);
+
+      return shadow;
+    }
+
   meta_window_shape_get_borders (shape,
                                  &shape_border_top,
                                  &shape_border_right,
@@ -69,7 +69,13 @@ void meta_shaped_texture_set_clip_region (MetaShapedTexture *stex,
                                           MtkRegion         *clip_region);
 void meta_shaped_texture_set_opaque_region (MetaShapedTexture *stex,
                                             MtkRegion         *opaque_region);
+void meta_shaped_texture_set_infer_opaque_region (MetaShapedTexture *stex,
+                                                  gboolean           infer_opaque_region);
 
 void meta_shaped_texture_ensure_size_valid (MetaShapedTexture *stex);
 
 gboolean meta_shaped_texture_should_get_via_offscreen (MetaShapedTexture *stex);
+
+CoglTexture * meta_shaped_texture_get_untransformed_texture (MetaShapedTexture *stex);
+
+void meta_shaped_texture_prewarm_pipelines (CoglFramebuffer *framebuffer);
@@ -60,10 +60,41 @@ enum
 
 static guint signals[LAST_SIGNAL];
 
+/* Resources derived from the texture, such as mipmaps, are released when the
+ * texture has not been painted for this long, e.g. as the window is minimized
+ * or on another workspace. They are recreated when painted again.
+ */
+#define IDLE_EVICTION_TIMEOUT_S (5 * 60)
+
 static CoglPipelineKey opaque_overlay_pipeline_key =
   "meta-shaped-texture-opaque-pipeline-key";
 static CoglPipelineKey blended_overlay_pipeline_key =
   "meta-shaped-texture-blended-pipeline-key";
+static CoglPipelineKey opaque_inference_pipeline_key =
+  "meta-shaped-texture-opaque-inference-pipeline-key";
+
+/* Size of the blocks of texels whose minimum alpha is determined when
+ * inferring the opaque region, and the minimum time between two
+ * inferences of the same texture. */
+#define OPAQUE_INFERENCE_TILE_SIZE 16
+#define OPAQUE_INFERENCE_INTERVAL_US (G_USEC_PER_SEC)
+
+#define OPAQUE_INFERENCE_FRAGMENT_SHADER_DECLARATIONS                    \
+"uniform vec2 texel_size;\n"                                             \
+
+#define OPAQUE_INFERENCE_FRAGMENT_SHADER_CODE                            \
+"vec2 origin = cogl_tex_coord0_in.st -\n"                                \
+"  (" G_STRINGIFY (OPAQUE_INFERENCE_TILE_SIZE) ".0 / 2.0 - 0.5) * texel_size;\n" \
+"float min_alpha = 1.0;\n"                                               \
+"for (int i = 0; i < " G_STRINGIFY (OPAQUE_INFERENCE_TILE_SIZE) "; i++)\n" \
+"  {\n"                                                                  \
+"    for (int j = 0; j < " G_STRINGIFY (OPAQUE_INFERENCE_TILE_SIZE) "; j++)\n" \
+"      {\n"                                                              \
+"        vec2 coord = origin + vec2 (float (i), float (j)) * texel_size;\n" \
+"        min_alpha = min (min_alpha, texture2D (cogl_sampler0, coord).a);\n" \
+"      }\n"                                                              \
+"  }\n"                                                                  \
+"cogl_color_out = vec4 (min_alpha);\n"                                   \
 
 struct _MetaShapedTexture
 {
@@ -89,6 +120,15 @@ struct _MetaShapedTexture
   /* The region containing only fully opaque pixels */
   MtkRegion *opaque_region;
 
+  /* Opaque region found by looking at the texture contents, used when
+   * no opaque region was set */
+  MtkRegion *inferred_opaque_region;
+  CoglFramebuffer *inference_framebuffer;
+  int64_t last_inference_time_us;
+
+  int64_t last_paint_time_us;
+  guint idle_eviction_id;
+
   /* MetaCullable regions, see that documentation for more details */
   MtkRegion *clip_region;
 
@@ -108,6 +148,8 @@ struct _MetaShapedTexture
   int buffer_scale;
 
   guint create_mipmaps : 1;
+  guint infer_opaque_region : 1;
+  guint inferred_opaque_region_dirty : 1;
 };
 
 G_DEFINE_TYPE_WITH_CODE (MetaShapedTexture, meta_shaped_texture, G_TYPE_OBJECT,
@@ -241,6 +283,7 @@ meta_shaped_texture_dispose (GObject *object)
 {
   MetaShapedTexture *stex = (MetaShapedTexture *) object;
 
+  g_clear_handle_id (&stex->idle_eviction_id, g_source_remove);
   g_clear_pointer (&stex->texture_mipmap, meta_texture_mipmap_free);
 
   g_clear_object (&stex->texture);
@@ -249,6 +292,8 @@ meta_shaped_texture_dispose (GObject *object)
   meta_shaped_texture_reset_pipelines (stex);
 
   g_clear_pointer (&stex->opaque_region, mtk_region_unref);
+  g_clear_pointer (&stex->inferred_opaque_region, mtk_region_unref);
+  g_clear_object (&stex->inference_framebuffer);
   g_clear_pointer (&stex->clip_region, mtk_region_unref);
 
   g_clear_pointer (&stex->snippet, g_object_unref);
@@ -605,6 +650,10 @@ set_multi_texture (MetaShapedTexture *stex,
       stex->tex_height = height;
       meta_shaped_texture_reset_pipelines (stex);
       update_size (stex);
+
+      g_clear_pointer (&stex->inferred_opaque_region, mtk_region_unref);
+      g_clear_object (&stex->inference_framebuffer);
+      stex->inferred_opaque_region_dirty = TRUE;
     }
 
   meta_texture_mipmap_set_base_texture (stex->texture_mipmap, stex->texture);
@@ -622,6 +671,219 @@ flip_ints (int *x,
   *y = tmp;
 }
 
+static CoglPipeline *
+get_opaque_inference_pipeline (CoglContext *ctx)
+{
+  CoglPipeline *pipeline;
+
+  pipeline = cogl_context_get_named_pipeline (ctx,
+                                              &opaque_inference_pipeline_key);
+  if (!pipeline)
+    {
+      CoglSnippet *snippet;
+
+      pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+      cogl_pipeline_set_layer_null_texture (pipeline, 0);
+      cogl_pipeline_set_layer_filters (pipeline, 0,
+                                       COGL_PIPELINE_FILTER_NEAREST,
+                                       COGL_PIPELINE_FILTER_NEAREST);
+      cogl_pipeline_set_layer_wrap_mode (pipeline, 0,
+                                         COGL_PIPELINE_WRAP_MODE_CLAMP_TO_EDGE);
+
+      snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                  OPAQUE_INFERENCE_FRAGMENT_SHADER_DECLARATIONS,
+                                  OPAQUE_INFERENCE_FRAGMENT_SHADER_CODE);
+      cogl_pipeline_add_snippet (pipeline, snippet);
+      g_object_unref (snippet);
+
+      cogl_context_set_named_pipeline (ctx,
+                                       &opaque_inference_pipeline_key,
+                                       pipeline);
+    }
+
+  return pipeline;
+}
+
+/**
+ * meta_shaped_texture_get_untransformed_texture: (skip)
+ * @stex: a #MetaShapedTexture
+ *
+ * Returns the texture holding the contents if they are painted as is,
+ * i.e. without a mask, transform, viewport or conversion between planes,
+ * so that they can be copied directly instead of being painted.
+ *
+ * Returns: (transfer none) (nullable): the texture, or %NULL
+ */
+CoglTexture *
+meta_shaped_texture_get_untransformed_texture (MetaShapedTexture *stex)
+{
+  g_return_val_if_fail (META_IS_SHAPED_TEXTURE (stex), NULL);
+
+  if (!stex->texture ||
+      stex->mask_texture ||
+      !stex->is_y_inverted ||
+      !meta_multi_texture_is_simple (stex->texture) ||
+      stex->transform != META_MONITOR_TRANSFORM_NORMAL ||
+      stex->has_viewport_src_rect ||
+      stex->has_viewport_dst_size)
+    return NULL;
+
+  return meta_multi_texture_get_plane (stex->texture, 0);
+}
+
+static gboolean
+can_infer_opaque_region (MetaShapedTexture *stex)
+{
+  return (stex->infer_opaque_region &&
+          !stex->opaque_region &&
+          !stex->mask_texture &&
+          stex->texture &&
+          meta_multi_texture_is_simple (stex->texture) &&
+          meta_shaped_texture_has_alpha (stex) &&
+          stex->transform == META_MONITOR_TRANSFORM_NORMAL &&
+          !stex->has_viewport_src_rect &&
+          !stex->has_viewport_dst_size);
+}
+
+/*
+ * Finds the blocks of the texture that only contain fully opaque texels,
+ * by reducing each block to its minimum alpha on the GPU and reading back
+ * the much smaller result.
+ */
+static void
+infer_opaque_region (MetaShapedTexture *stex,
+                     CoglContext       *ctx)
+{
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  g_autofree uint8_t *pixels = NULL;
+  MtkRegionBuilder builder;
+  CoglTexture *texture;
+  float texel_size[2];
+  int width, height;
+  int x, y;
+
+  texture = meta_multi_texture_get_plane (stex->texture, 0);
+  width = (stex->tex_width + OPAQUE_INFERENCE_TILE_SIZE - 1) /
+          OPAQUE_INFERENCE_TILE_SIZE;
+  height = (stex->tex_height + OPAQUE_INFERENCE_TILE_SIZE - 1) /
+           OPAQUE_INFERENCE_TILE_SIZE;
+
+  if (!stex->inference_framebuffer)
+    {
+      g_autoptr (CoglTexture) reduced_texture = NULL;
+      CoglOffscreen *offscreen;
+
+      reduced_texture = cogl_texture_2d_new_with_size (ctx, width, height);
+      if (!reduced_texture)
+        return;
+
+      offscreen = cogl_offscreen_new_with_texture (reduced_texture);
+      if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), NULL))
+        {
+          g_object_unref (offscreen);
+          return;
+        }
+
+      stex->inference_framebuffer = COGL_FRAMEBUFFER (offscreen);
+      cogl_framebuffer_orthographic (stex->inference_framebuffer,
+                                     0, 0, width, height, -1.0, 1.0);
+    }
+
+  pipeline = cogl_pipeline_copy (get_opaque_inference_pipeline (ctx));
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+
+  texel_size[0] = 1.0f / stex->tex_width;
+  texel_size[1] = 1.0f / stex->tex_height;
+  cogl_pipeline_set_uniform_float (pipeline,
+                                   cogl_pipeline_get_uniform_location (pipeline,
+                                                                       "texel_size"),
+                                   2, 1, texel_size);
+
+  cogl_framebuffer_draw_textured_rectangle (stex->inference_framebuffer,
+                                            pipeline,
+                                            0, 0, width, height,
+                                            0.0, 0.0,
+                                            (float) (width * OPAQUE_INFERENCE_TILE_SIZE) /
+                                            stex->tex_width,
+                                            (float) (height * OPAQUE_INFERENCE_TILE_SIZE) /
+                                            stex->tex_height);
+
+  pixels = g_malloc (width * height * 4);
+  if (!cogl_framebuffer_read_pixels (stex->inference_framebuffer,
+                                     0, 0, width, height,
+                                     COGL_PIXEL_FORMAT_RGBA_8888,
+                                     pixels))
+    return;
+
+  mtk_region_builder_init (&builder);
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          MtkRectangle rect;
+
+          if (pixels[(y * width + x) * 4 + 3] != 0xff)
+            continue;
+
+          rect = MTK_RECTANGLE_INIT (x * OPAQUE_INFERENCE_TILE_SIZE,
+                                     y * OPAQUE_INFERENCE_TILE_SIZE,
+                                     OPAQUE_INFERENCE_TILE_SIZE,
+                                     OPAQUE_INFERENCE_TILE_SIZE);
+          rect.width = MIN (rect.width, stex->tex_width - rect.x);
+          rect.height = MIN (rect.height, stex->tex_height - rect.y);
+
+          mtk_rectangle_scale_double (&rect,
+                                      1.0 / stex->buffer_scale,
+                                      MTK_ROUNDING_STRATEGY_SHRINK,
+                                      &rect);
+          mtk_region_builder_add_rectangle (&builder,
+                                            rect.x, rect.y,
+                                            rect.width, rect.height);
+        }
+    }
+
+  g_clear_pointer (&stex->inferred_opaque_region, mtk_region_unref);
+  stex->inferred_opaque_region = mtk_region_builder_finish (&builder);
+}
+
+static void
+maybe_infer_opaque_region (MetaShapedTexture *stex,
+                           CoglContext       *ctx)
+{
+  int64_t now_us;
+
+  if (!stex->inferred_opaque_region_dirty)
+    return;
+
+  if (!can_infer_opaque_region (stex))
+    return;
+
+  now_us = g_get_monotonic_time ();
+  if (now_us - stex->last_inference_time_us < OPAQUE_INFERENCE_INTERVAL_US)
+    return;
+
+  COGL_TRACE_BEGIN_SCOPED (InferOpaqueRegion,
+                           "Meta::ShapedTexture::infer_opaque_region()");
+
+  stex->last_inference_time_us = now_us;
+  stex->inferred_opaque_region_dirty = FALSE;
+
+  infer_opaque_region (stex, ctx);
+}
+
+static MtkRegion *
+get_effective_opaque_region (MetaShapedTexture *stex)
+{
+  if (stex->opaque_region)
+    return stex->opaque_region;
+
+  if (can_infer_opaque_region (stex))
+    return stex->inferred_opaque_region;
+
+  return NULL;
+}
+
 static void
 do_paint_content (MetaShapedTexture   *stex,
                   ClutterPaintNode    *root_node,
@@ -631,6 +893,7 @@ do_paint_content (MetaShapedTexture   *stex,
 {
   int dst_width, dst_height;
   MtkRectangle content_rect;
+  MtkRegion *opaque_region;
   gboolean use_opaque_region;
   MtkRegion *blended_tex_region;
   CoglContext *ctx;
@@ -716,7 +979,10 @@ do_paint_content (MetaShapedTexture   *stex,
 
   ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
 
-  use_opaque_region = stex->opaque_region && opacity == 255;
+  maybe_infer_opaque_region (stex, ctx);
+  opaque_region = get_effective_opaque_region (stex);
+
+  use_opaque_region = opaque_region && opacity == 255;
 
   if (use_opaque_region)
     {
@@ -725,7 +991,7 @@ do_paint_content (MetaShapedTexture   *stex,
       else
         blended_tex_region = mtk_region_create_rectangle (&content_rect);
 
-      mtk_region_subtract (blended_tex_region, stex->opaque_region);
+      mtk_region_subtract (blended_tex_region, opaque_region);
     }
   else
     {
@@ -763,11 +1029,11 @@ do_paint_content (MetaShapedTexture   *stex,
       if (stex->clip_region)
         {
           region = mtk_region_copy (stex->clip_region);
-          mtk_region_intersect (region, stex->opaque_region);
+          mtk_region_intersect (region, opaque_region);
         }
       else
         {
-          region = mtk_region_ref (stex->opaque_region);
+          region = mtk_region_ref (opaque_region);
         }
 
       if (!mtk_region_is_empty (region))
@@ -904,6 +1170,61 @@ do_paint_content (MetaShapedTexture   *stex,
   g_clear_pointer (&blended_tex_region, mtk_region_unref);
 }
 
+static void
+evict_idle_resources (MetaShapedTexture *stex)
+{
+  /* The pipelines reference the mipmap texture, so they need to go too */
+  meta_texture_mipmap_clear (stex->texture_mipmap);
+  meta_shaped_texture_reset_pipelines (stex);
+  g_clear_object (&stex->inference_framebuffer);
+}
+
+static void schedule_idle_eviction (MetaShapedTexture *stex,
+                                    unsigned int       timeout_s);
+
+static gboolean
+idle_eviction_cb (gpointer user_data)
+{
+  MetaShapedTexture *stex = META_SHAPED_TEXTURE (user_data);
+  int64_t idle_time_us;
+
+  stex->idle_eviction_id = 0;
+
+  /* Painting doesn't push the timeout back, so check whether it happened
+   * in the meantime and wait the rest of the timeout if it did.
+   */
+  idle_time_us = g_get_monotonic_time () - stex->last_paint_time_us;
+  if (idle_time_us < IDLE_EVICTION_TIMEOUT_S * G_USEC_PER_SEC)
+    {
+      schedule_idle_eviction (stex,
+                              IDLE_EVICTION_TIMEOUT_S -
+                              idle_time_us / G_USEC_PER_SEC);
+      return G_SOURCE_REMOVE;
+    }
+
+  evict_idle_resources (stex);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_idle_eviction (MetaShapedTexture *stex,
+                        unsigned int       timeout_s)
+{
+  stex->idle_eviction_id = g_timeout_add_seconds (MAX (timeout_s, 1),
+                                                  idle_eviction_cb,
+                                                  stex);
+}
+
+static void
+mark_painted (MetaShapedTexture *stex)
+{
+  stex->last_paint_time_us = g_get_monotonic_time ();
+
+  if (!stex->idle_eviction_id)
+    schedule_idle_eviction (stex, IDLE_EVICTION_TIMEOUT_S);
+}
+
 static void
 meta_shaped_texture_paint_content (ClutterContent      *content,
                                    ClutterActor        *actor,
@@ -938,6 +1259,7 @@ meta_shaped_texture_paint_content (ClutterContent      *content,
   opacity = clutter_actor_get_paint_opacity (actor);
   clutter_actor_get_content_box (actor, &alloc);
 
+  mark_painted (stex);
   do_paint_content (stex, root_node, paint_context, &alloc, opacity);
 }
 
@@ -1047,6 +1369,8 @@ meta_shaped_texture_update_area (MetaShapedTexture *stex,
 
   mtk_rectangle_intersect (&buffer_rect, clip, clip);
 
+  meta_texture_mipmap_invalidate_area (stex->texture_mipmap, clip);
+
   mtk_rectangle_scale_double (clip,
                               1.0 / stex->buffer_scale,
                               MTK_ROUNDING_STRATEGY_GROW,
@@ -1119,7 +1443,9 @@ meta_shaped_texture_update_area (MetaShapedTexture *stex,
                                     clip);
     }
 
-  meta_texture_mipmap_invalidate (stex->texture_mipmap);
+  if (stex->inferred_opaque_region)
+    mtk_region_subtract_rectangle (stex->inferred_opaque_region, clip);
+  stex->inferred_opaque_region_dirty = TRUE;
 
   return TRUE;
 }
@@ -1209,7 +1535,37 @@ meta_shaped_texture_set_opaque_region (MetaShapedTexture *stex,
 MtkRegion *
 meta_shaped_texture_get_opaque_region (MetaShapedTexture *stex)
 {
-  return stex->opaque_region;
+  return get_effective_opaque_region (stex);
+}
+
+/**
+ * meta_shaped_texture_set_infer_opaque_region:
+ * @stex: a #MetaShapedTexture
+ * @infer_opaque_region: whether to look for opaque content
+ *
+ * Sets whether the fully opaque parts of the texture should be found by
+ * inspecting its contents when no opaque region was set, so that what is
+ * covered by them can be culled. The contents are inspected on the GPU,
+ * at most once a second, and changed areas are removed from the inferred
+ * region right away.
+ */
+void
+meta_shaped_texture_set_infer_opaque_region (MetaShapedTexture *stex,
+                                             gboolean           infer_opaque_region)
+{
+  infer_opaque_region = !!infer_opaque_region;
+
+  if (stex->infer_opaque_region == infer_opaque_region)
+    return;
+
+  stex->infer_opaque_region = infer_opaque_region;
+  stex->inferred_opaque_region_dirty = TRUE;
+
+  if (!infer_opaque_region)
+    {
+      g_clear_pointer (&stex->inferred_opaque_region, mtk_region_unref);
+      g_clear_object (&stex->inference_framebuffer);
+    }
 }
 
 gboolean
@@ -1245,6 +1601,7 @@ gboolean
 meta_shaped_texture_is_opaque (MetaShapedTexture *stex)
 {
   MetaMultiTexture *multi_texture;
+  MtkRegion *opaque_region;
   MtkRectangle opaque_rect;
 
   multi_texture = stex->texture;
@@ -1254,13 +1611,14 @@ meta_shaped_texture_is_opaque (MetaShapedTexture *stex)
   if (!meta_shaped_texture_has_alpha (stex))
     return TRUE;
 
-  if (!stex->opaque_region)
+  opaque_region = get_effective_opaque_region (stex);
+  if (!opaque_region)
     return FALSE;
 
-  if (mtk_region_num_rectangles (stex->opaque_region) != 1)
+  if (mtk_region_num_rectangles (opaque_region) != 1)
     return FALSE;
 
-  opaque_rect = mtk_region_get_extents (stex->opaque_region);
+  opaque_rect = mtk_region_get_extents (opaque_region);
 
   meta_shaped_texture_ensure_size_valid (stex);
 
@@ -1511,6 +1869,69 @@ meta_shaped_texture_new (void)
   return g_object_new (META_TYPE_SHAPED_TEXTURE, NULL);
 }
 
+/**
+ * meta_shaped_texture_prewarm_pipelines:
+ * @framebuffer: a small framebuffer to draw into
+ *
+ * Draws a dummy texture with each of the pipelines used for painting
+ * single plane window textures, so that their shader programs are
+ * compiled and cached before the first window is mapped. The programs
+ * don't depend on the texture size, so they are shared with the
+ * pipelines of every window drawn later.
+ */
+void
+meta_shaped_texture_prewarm_pipelines (CoglFramebuffer *framebuffer)
+{
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (MetaShapedTexture) stex = NULL;
+  g_autoptr (MetaMultiTexture) multi_texture = NULL;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglTexture) mask_texture = NULL;
+  g_autoptr (CoglPipeline) inference_pipeline = NULL;
+  static const uint8_t mask_data = 0xff;
+  CoglPipeline *pipelines[3];
+  float texel_size[2] = { 1.0f, 1.0f };
+  int i;
+
+  texture = cogl_texture_2d_new_with_size (ctx, 1, 1);
+  mask_texture = cogl_texture_2d_new_from_data (ctx, 1, 1,
+                                                COGL_PIXEL_FORMAT_A_8,
+                                                1, &mask_data,
+                                                NULL);
+  if (!texture || !mask_texture)
+    return;
+
+  multi_texture = meta_multi_texture_new_simple (g_object_ref (texture));
+
+  stex = meta_shaped_texture_new ();
+  meta_shaped_texture_set_texture (stex, multi_texture);
+
+  pipelines[0] = get_unmasked_pipeline (stex, ctx, stex->texture);
+  pipelines[1] = get_unblended_pipeline (stex, ctx, stex->texture);
+  pipelines[2] = get_masked_pipeline (stex, ctx, stex->texture);
+  cogl_pipeline_set_layer_texture (pipelines[2], 1, mask_texture);
+
+  for (i = 0; i < G_N_ELEMENTS (pipelines); i++)
+    {
+      cogl_pipeline_set_layer_texture (pipelines[i], 0, texture);
+      cogl_framebuffer_draw_rectangle (framebuffer, pipelines[i],
+                                       0, 0, 1, 1);
+    }
+
+  inference_pipeline = cogl_pipeline_copy (get_opaque_inference_pipeline (ctx));
+  cogl_pipeline_set_layer_texture (inference_pipeline, 0, texture);
+  cogl_pipeline_set_uniform_float (inference_pipeline,
+                                   cogl_pipeline_get_uniform_location (inference_pipeline,
+                                                                       "texel_size"),
+                                   2, 1, texel_size);
+  cogl_framebuffer_draw_rectangle (framebuffer, inference_pipeline,
+                                   0, 0, 1, 1);
+
+  /* Flush the journal so the programs are actually built now, while
+   * the shaped texture is still around */
+  cogl_framebuffer_flush (framebuffer);
+}
+
 /**
  * meta_shaped_texture_set_buffer_scale:
  * @stex: A #MetaShapedTexture
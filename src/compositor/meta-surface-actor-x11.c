@@ -32,6 +32,8 @@
 #include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-window-actor-private.h"
 #include "core/window-private.h"
+#include "meta/meta-backend.h"
+#include "meta/meta-context.h"
 #include "mtk/mtk-x11.h"
 #include "x11/meta-x11-display-private.h"
 #include "x11/window-x11.h"
@@ -48,6 +50,10 @@ struct _MetaSurfaceActorX11
   Pixmap pixmap;
   Damage damage;
 
+  /* Damage received since the last stage update, applied once per frame */
+  MtkRegion *pending_damage;
+  gulong before_update_handler_id;
+
   int last_width;
   int last_height;
 
@@ -66,12 +72,32 @@ G_DEFINE_TYPE (MetaSurfaceActorX11,
                meta_surface_actor_x11,
                META_TYPE_SURFACE_ACTOR)
 
+static ClutterActor *
+get_stage (MetaSurfaceActorX11 *self)
+{
+  MetaContext *context = meta_display_get_context (self->display);
+  MetaBackend *backend = meta_context_get_backend (context);
+
+  return meta_backend_get_stage (backend);
+}
+
+static void
+clear_pending_damage (MetaSurfaceActorX11 *self)
+{
+  if (self->before_update_handler_id)
+    g_clear_signal_handler (&self->before_update_handler_id, get_stage (self));
+
+  g_clear_pointer (&self->pending_damage, mtk_region_unref);
+}
+
 static void
 free_damage (MetaSurfaceActorX11 *self)
 {
   MetaDisplay *display = self->display;
   Display *xdisplay;
 
+  clear_pending_damage (self);
+
   if (self->damage == None)
     return;
 
@@ -185,6 +211,43 @@ meta_surface_actor_x11_is_visible (MetaSurfaceActorX11 *self)
   return (self->pixmap != None) && !self->unredirected;
 }
 
+/*
+ * Applications such as terminals and browsers may trigger many damage
+ * events per frame. Rather than updating the texture and queuing a clipped
+ * redraw for each of them, accumulate the damage and apply it right before
+ * the stage is laid out and painted.
+ */
+static void
+flush_pending_damage (MetaSurfaceActorX11 *self)
+{
+  MetaSurfaceActor *actor = META_SURFACE_ACTOR (self);
+  g_autoptr (MtkRegion) damage = NULL;
+  CoglTexturePixmapX11 *pixmap;
+  int i, n_rects;
+
+  damage = g_steal_pointer (&self->pending_damage);
+  clear_pending_damage (self);
+
+  if (!meta_surface_actor_x11_is_visible (self) ||
+      !meta_multi_texture_is_simple (self->texture))
+    return;
+
+  pixmap = COGL_TEXTURE_PIXMAP_X11 (meta_multi_texture_get_plane (self->texture, 0));
+
+  n_rects = mtk_region_num_rectangles (damage);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (damage, i);
+
+      cogl_texture_pixmap_x11_update_area (pixmap,
+                                           rect.x, rect.y,
+                                           rect.width, rect.height);
+      meta_surface_actor_update_area (actor,
+                                      rect.x, rect.y,
+                                      rect.width, rect.height);
+    }
+}
+
 static void
 meta_surface_actor_x11_process_damage (MetaSurfaceActor *actor,
                                        int               x,
@@ -193,7 +256,7 @@ meta_surface_actor_x11_process_damage (MetaSurfaceActor *actor,
                                        int               height)
 {
   MetaSurfaceActorX11 *self = META_SURFACE_ACTOR_X11 (actor);
-  CoglTexturePixmapX11 *pixmap;
+  MtkRectangle damage_rect = { x, y, width, height };
 
   self->received_damage = TRUE;
 
@@ -221,9 +284,20 @@ meta_surface_actor_x11_process_damage (MetaSurfaceActor *actor,
   if (!meta_multi_texture_is_simple (self->texture))
     return;
 
-  pixmap = COGL_TEXTURE_PIXMAP_X11 (meta_multi_texture_get_plane (self->texture, 0));
-  cogl_texture_pixmap_x11_update_area (pixmap, x, y, width, height);
-  meta_surface_actor_update_area (actor, x, y, width, height);
+  if (!self->pending_damage)
+    {
+      ClutterActor *stage = get_stage (self);
+
+      self->pending_damage = mtk_region_create_rectangle (&damage_rect);
+      self->before_update_handler_id =
+        g_signal_connect_swapped (stage, "before-update",
+                                  G_CALLBACK (flush_pending_damage), self);
+      clutter_stage_schedule_update (CLUTTER_STAGE (stage));
+    }
+  else
+    {
+      mtk_region_union_rectangle (self->pending_damage, &damage_rect);
+    }
 }
 
 void
@@ -554,6 +554,17 @@ meta_surface_actor_set_opaque_region (MetaSurfaceActor *self,
   meta_shaped_texture_set_opaque_region (priv->texture, region);
 }
 
+void
+meta_surface_actor_set_infer_opaque_region (MetaSurfaceActor *self,
+                                            gboolean          infer_opaque_region)
+{
+  MetaSurfaceActorPrivate *priv =
+    meta_surface_actor_get_instance_private (self);
+
+  meta_shaped_texture_set_infer_opaque_region (priv->texture,
+                                               infer_opaque_region);
+}
+
 MtkRegion *
 meta_surface_actor_get_opaque_region (MetaSurfaceActor *self)
 {
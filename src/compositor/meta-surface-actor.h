@@ -47,6 +47,8 @@ void meta_surface_actor_set_input_region (MetaSurfaceActor *self,
 void meta_surface_actor_set_opaque_region (MetaSurfaceActor *self,
                                            MtkRegion        *region);
 MtkRegion * meta_surface_actor_get_opaque_region (MetaSurfaceActor *self);
+void meta_surface_actor_set_infer_opaque_region (MetaSurfaceActor *self,
+                                                 gboolean          infer_opaque_region);
 
 void meta_surface_actor_process_damage (MetaSurfaceActor *actor,
                                         int x, int y, int width, int height);
@@ -43,21 +43,26 @@
 
 /* Theory of operation:
  *
- * We use a ring of NUM_SYNCS fence objects. On each frame we advance
- * to the next fence in the ring. For each fence we do:
+ * We use a ring of fence objects, initially NUM_SYNCS of them. On each
+ * frame we pick the next fence that is ready. For each fence we do:
  *
  * 1. fence is XSyncTriggerFence()'d and glWaitSync()'d
- * 2. NUM_SYNCS / 2 frames later, fence should be triggered
+ * 2. SYNC_RESET_LAG frames later, fence should be triggered
  * 3. fence is XSyncResetFence()'d
- * 4. NUM_SYNCS / 2 frames later, fence should be reset
+ * 4. fence is reset when its XAlarm fires
  * 5. go back to 1 and re-use fence
  *
- * glClientWaitSync() and XAlarms are used in steps 2 and 4,
- * respectively, to double-check the expectections.
+ * glClientWaitSync() is never used to wait in step 2, only to check
+ * whether the fence was triggered; if it wasn't yet, it is checked
+ * again on the next frame. When no fence is ready in step 1, the ring
+ * grows, up to MAX_NUM_SYNCS fences, after which we fall back to
+ * XSync() for that frame.
  */
 
 #define NUM_SYNCS 10
-#define MAX_SYNC_WAIT_TIME (1 * 1000 * 1000 * 1000) /* one sec */
+#define MAX_NUM_SYNCS 32
+#define SYNC_RESET_LAG (NUM_SYNCS / 2)
+#define MAX_SYNC_WAIT_TIME_US (G_USEC_PER_SEC) /* one sec */
 #define MAX_REBOOT_ATTEMPTS 2
 
 typedef enum
@@ -81,6 +86,7 @@ typedef struct
   XSyncValue next_counter_value;
 
   MetaSyncState state;
+  int64_t insert_time_us;
 } MetaSync;
 
 typedef struct
@@ -91,10 +97,12 @@ typedef struct
 
   GHashTable *alarm_to_sync;
 
-  MetaSync *syncs_array[NUM_SYNCS];
-  guint current_sync_idx;
+  GPtrArray *syncs;
+  guint next_sync_idx;
   MetaSync *current_sync;
-  guint warmup_syncs;
+
+  /* Inserted syncs that were not reset yet, oldest first */
+  GQueue inserted_syncs;
 
   guint reboots;
 } MetaSyncRing;
@@ -240,6 +248,7 @@ meta_sync_insert (MetaSync *self)
   self->gpu_fence = meta_gl_fence_sync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
   self->state = META_SYNC_STATE_WAITING;
+  self->insert_time_us = g_get_monotonic_time ();
 }
 
 static GLenum
@@ -404,6 +413,18 @@ meta_sync_free (MetaSync *self)
   g_free (self);
 }
 
+static MetaSync *
+meta_sync_ring_add_sync (MetaSyncRing *ring)
+{
+  MetaSync *sync;
+
+  sync = meta_sync_new (ring->xdisplay);
+  g_ptr_array_add (ring->syncs, sync);
+  g_hash_table_replace (ring->alarm_to_sync, (gpointer) sync->xalarm, sync);
+
+  return sync;
+}
+
 gboolean
 meta_sync_ring_init (Display *xdisplay)
 {
@@ -430,23 +451,22 @@ meta_sync_ring_init (Display *xdisplay)
   ring->xdisplay = xdisplay;
 
   ring->alarm_to_sync = g_hash_table_new (NULL, NULL);
+  ring->syncs = g_ptr_array_sized_new (NUM_SYNCS);
 
   for (i = 0; i < NUM_SYNCS; ++i)
-    {
-      MetaSync *sync = meta_sync_new (ring->xdisplay);
-      ring->syncs_array[i] = sync;
-      g_hash_table_replace (ring->alarm_to_sync, (gpointer) sync->xalarm, sync);
-    }
+    meta_sync_ring_add_sync (ring);
   /* Since the connection we create the X fences on isn't the same as
    * the one used for the GLX context, we need to XSync() here to
    * ensure glImportSync() succeeds. */
   XSync (xdisplay, False);
   for (i = 0; i < NUM_SYNCS; ++i)
-    meta_sync_import (ring->syncs_array[i]);
+    meta_sync_import (g_ptr_array_index (ring->syncs, i));
+
+  ring->next_sync_idx = 0;
+  ring->current_sync = NULL;
+  g_queue_init (&ring->inserted_syncs);
 
-  ring->current_sync_idx = 0;
-  ring->current_sync = ring->syncs_array[0];
-  ring->warmup_syncs = 0;
+  COGL_TRACE_COUNTER ("MetaSyncRing", "Number of syncs", ring->syncs->len);
 
   return TRUE;
 }
@@ -454,7 +474,6 @@ meta_sync_ring_init (Display *xdisplay)
 void
 meta_sync_ring_destroy (void)
 {
-  guint i;
   MetaSyncRing *ring = meta_sync_ring_get ();
 
   if (!ring)
@@ -462,12 +481,12 @@ meta_sync_ring_destroy (void)
 
   g_return_if_fail (ring->xdisplay != NULL);
 
-  ring->current_sync_idx = 0;
+  ring->next_sync_idx = 0;
   ring->current_sync = NULL;
-  ring->warmup_syncs = 0;
+  g_queue_clear (&ring->inserted_syncs);
 
-  for (i = 0; i < NUM_SYNCS; ++i)
-    meta_sync_free (ring->syncs_array[i]);
+  g_ptr_array_foreach (ring->syncs, (GFunc) meta_sync_free, NULL);
+  g_clear_pointer (&ring->syncs, g_ptr_array_unref);
 
   g_hash_table_destroy (ring->alarm_to_sync);
 
@@ -507,16 +526,25 @@ meta_sync_ring_after_frame (void)
 
   g_return_val_if_fail (ring->xdisplay != NULL, FALSE);
 
-  if (ring->warmup_syncs >= NUM_SYNCS / 2)
+  if (ring->current_sync)
+    {
+      g_queue_push_tail (&ring->inserted_syncs, ring->current_sync);
+      ring->current_sync = NULL;
+    }
+
+  while (g_queue_get_length (&ring->inserted_syncs) > SYNC_RESET_LAG)
     {
-      guint reset_sync_idx = (ring->current_sync_idx + NUM_SYNCS - (NUM_SYNCS / 2)) % NUM_SYNCS;
-      MetaSync *sync_to_reset = ring->syncs_array[reset_sync_idx];
+      MetaSync *sync_to_reset = g_queue_peek_head (&ring->inserted_syncs);
+      GLenum status;
 
-      GLenum status = meta_sync_check_update_finished (sync_to_reset, 0);
+      status = meta_sync_check_update_finished (sync_to_reset, 0);
       if (status == GL_TIMEOUT_EXPIRED)
         {
-          meta_warning ("MetaSyncRing: We should never wait for a sync -- add more syncs?");
-          status = meta_sync_check_update_finished (sync_to_reset, MAX_SYNC_WAIT_TIME);
+          int64_t wait_time_us;
+
+          wait_time_us = g_get_monotonic_time () - sync_to_reset->insert_time_us;
+          if (wait_time_us < MAX_SYNC_WAIT_TIME_US)
+            break;
         }
 
       if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
@@ -525,39 +553,85 @@ meta_sync_ring_after_frame (void)
           return meta_sync_ring_reboot (ring->xdisplay);
         }
 
+      g_queue_pop_head (&ring->inserted_syncs);
       meta_sync_reset (sync_to_reset);
     }
-  else
-    {
-      ring->warmup_syncs += 1;
-    }
 
-  ring->current_sync_idx += 1;
-  ring->current_sync_idx %= NUM_SYNCS;
+  return TRUE;
+}
 
-  ring->current_sync = ring->syncs_array[ring->current_sync_idx];
+static MetaSync *
+meta_sync_ring_find_ready_sync (MetaSyncRing *ring)
+{
+  guint i;
 
-  return TRUE;
+  for (i = 0; i < ring->syncs->len; i++)
+    {
+      guint idx = (ring->next_sync_idx + i) % ring->syncs->len;
+      MetaSync *sync = g_ptr_array_index (ring->syncs, idx);
+
+      if (sync->state == META_SYNC_STATE_READY)
+        {
+          ring->next_sync_idx = (idx + 1) % ring->syncs->len;
+          return sync;
+        }
+    }
+
+  return NULL;
 }
 
 gboolean
 meta_sync_ring_insert_wait (void)
 {
   MetaSyncRing *ring = meta_sync_ring_get ();
+  MetaSync *sync;
 
   if (!ring)
     return FALSE;
 
   g_return_val_if_fail (ring->xdisplay != NULL, FALSE);
 
-  if (ring->current_sync->state != META_SYNC_STATE_READY)
+  if (ring->current_sync)
+    {
+      g_queue_push_tail (&ring->inserted_syncs, ring->current_sync);
+      ring->current_sync = NULL;
+    }
+
+  sync = meta_sync_ring_find_ready_sync (ring);
+  if (!sync)
     {
-      meta_warning ("MetaSyncRing: Sync object is not ready -- were events handled properly?");
-      if (!meta_sync_ring_reboot (ring->xdisplay))
-        return FALSE;
+      int64_t start_time_us = g_get_monotonic_time ();
+
+      /* The GPU or the X server is behind; rather than waiting for a sync
+       * to be recycled, add one, or take the slow path for this frame. Both
+       * take a round trip. */
+      if (ring->syncs->len < MAX_NUM_SYNCS)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "MetaSyncRing: No sync ready, growing ring to %u",
+                      ring->syncs->len + 1);
+
+          sync = meta_sync_ring_add_sync (ring);
+          XSync (ring->xdisplay, False);
+          meta_sync_import (sync);
+
+          COGL_TRACE_COUNTER ("MetaSyncRing", "Number of syncs",
+                              ring->syncs->len);
+        }
+      else
+        {
+          XSync (ring->xdisplay, False);
+        }
+
+      COGL_TRACE_COUNTER ("MetaSyncRing", "Wait time (us)",
+                          g_get_monotonic_time () - start_time_us);
+
+      if (!sync)
+        return TRUE;
     }
 
-  meta_sync_insert (ring->current_sync);
+  meta_sync_insert (sync);
+  ring->current_sync = sync;
 
   return TRUE;
 }
@@ -36,6 +36,7 @@ struct _MetaTextureMipmap
   MetaMultiTexture *mipmap_texture;
   CoglPipeline *pipeline;
   CoglFramebuffer *fb;
+  MtkRegion *damage;
   gboolean invalid;
 };
 
@@ -72,6 +73,7 @@ meta_texture_mipmap_free (MetaTextureMipmap *mipmap)
   g_clear_object (&mipmap->base_texture);
   g_clear_object (&mipmap->mipmap_texture);
   g_clear_object (&mipmap->fb);
+  g_clear_pointer (&mipmap->damage, mtk_region_unref);
 
   g_free (mipmap);
 }
@@ -112,6 +114,31 @@ meta_texture_mipmap_invalidate (MetaTextureMipmap *mipmap)
   g_return_if_fail (mipmap != NULL);
 
   mipmap->invalid = TRUE;
+  g_clear_pointer (&mipmap->damage, mtk_region_unref);
+}
+
+/**
+ * meta_texture_mipmap_invalidate_area:
+ * @mipmap: a #MetaTextureMipmap
+ * @area: the damaged area, in base texture coordinates
+ *
+ * Marks only @area of the base texture as changed, so that the next
+ * call to meta_texture_mipmap_get_paint_texture() only has to
+ * downsample that part again.
+ */
+void
+meta_texture_mipmap_invalidate_area (MetaTextureMipmap  *mipmap,
+                                     const MtkRectangle *area)
+{
+  g_return_if_fail (mipmap != NULL);
+
+  if (mipmap->invalid)
+    return;
+
+  if (!mipmap->damage)
+    mipmap->damage = mtk_region_create_rectangle (area);
+  else
+    mtk_region_union_rectangle (mipmap->damage, area);
 }
 
 static void
@@ -119,6 +146,7 @@ free_mipmaps (MetaTextureMipmap *mipmap)
 {
   g_clear_object (&mipmap->fb);
   g_clear_object (&mipmap->mipmap_texture);
+  g_clear_pointer (&mipmap->damage, mtk_region_unref);
 }
 
 void
@@ -199,7 +227,7 @@ ensure_mipmap_texture (MetaTextureMipmap *mipmap)
       mipmap->invalid = TRUE;
     }
 
-  if (mipmap->invalid)
+  if (mipmap->invalid || mipmap->damage)
     {
       int n_planes, i;
 
@@ -244,12 +272,50 @@ ensure_mipmap_texture (MetaTextureMipmap *mipmap)
           cogl_pipeline_set_layer_texture (mipmap->pipeline, i, plane);
         }
 
-      cogl_framebuffer_draw_textured_rectangle (mipmap->fb,
-                                                mipmap->pipeline,
-                                                0, 0, width, height,
-                                                0.0, 0.0, 1.0, 1.0);
+      if (mipmap->invalid)
+        {
+          cogl_framebuffer_draw_textured_rectangle (mipmap->fb,
+                                                    mipmap->pipeline,
+                                                    0, 0, width, height,
+                                                    0.0, 0.0, 1.0, 1.0);
+        }
+      else
+        {
+          int n_rectangles;
+
+          /* Only downsample what changed, rounded outwards to whole
+           * pixels of the reduced texture. */
+          n_rectangles = mtk_region_num_rectangles (mipmap->damage);
+          for (i = 0; i < n_rectangles; i++)
+            {
+              MtkRectangle rect;
+              MtkRectangle bounds = MTK_RECTANGLE_INIT (0, 0, width, height);
+              float x1, y1, x2, y2;
+
+              rect = mtk_region_get_rectangle (mipmap->damage, i);
+              mtk_rectangle_scale_double (&rect, 0.5,
+                                          MTK_ROUNDING_STRATEGY_GROW,
+                                          &rect);
+              if (!mtk_rectangle_intersect (&rect, &bounds, &rect))
+                continue;
+
+              x1 = rect.x;
+              y1 = rect.y;
+              x2 = rect.x + rect.width;
+              y2 = rect.y + rect.height;
+
+              cogl_framebuffer_draw_textured_rectangle (mipmap->fb,
+                                                        mipmap->pipeline,
+                                                        x1, y1, x2, y2,
+                                                        x1 / width,
+                                                        y1 / height,
+                                                        x2 / width,
+                                                        y2 / height);
+            }
+        }
 
       mipmap->invalid = FALSE;
+      g_clear_pointer (&mipmap->damage, mtk_region_unref);
     }
 }
 
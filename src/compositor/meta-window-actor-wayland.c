@@ -26,7 +26,6 @@
 #include "compositor/meta-window-actor-wayland.h"
 #include "meta/meta-window-actor.h"
 #include "wayland/meta-wayland-buffer.h"
-#include "wayland/meta-wayland-single-pixel-buffer.h"
 #include "wayland/meta-wayland-surface-private.h"
 #include "wayland/meta-window-wayland.h"
 
@@ -35,6 +34,9 @@ struct _MetaSurfaceContainerActorWayland
   ClutterActor parent;
 
   MetaWindowActor *window_actor;
+
+  /* Surface actors left without anything to paint by the last culling */
+  GHashTable *occluded_surfaces;
 };
 
 static void surface_container_cullable_iface_init (MetaCullableInterface *iface);
@@ -90,7 +92,13 @@ static void
 surface_container_cull_redraw_clip (MetaCullable *cullable,
                                     MtkRegion    *clip_region)
 {
-  meta_cullable_cull_redraw_clip_children (cullable, clip_region);
+  MetaSurfaceContainerActorWayland *self =
+    META_SURFACE_CONTAINER_ACTOR_WAYLAND (cullable);
+
+  g_hash_table_remove_all (self->occluded_surfaces);
+  meta_cullable_cull_redraw_clip_children_occluded (cullable,
+                                                    clip_region,
+                                                    self->occluded_surfaces);
 }
 
 static void
@@ -152,16 +160,49 @@ surface_container_apply_transform (ClutterActor      *actor,
     }
 }
 
+static void
+surface_container_paint (ClutterActor        *actor,
+                         ClutterPaintContext *paint_context)
+{
+  MetaSurfaceContainerActorWayland *self =
+    META_SURFACE_CONTAINER_ACTOR_WAYLAND (actor);
+  ClutterActorIter iter;
+  ClutterActor *child;
+
+  /* All surface actors of the window are direct children, so subsurfaces
+   * entirely covered by other surfaces of the same window can be skipped
+   * without building their paint nodes. */
+  clutter_actor_iter_init (&iter, actor);
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      if (g_hash_table_contains (self->occluded_surfaces, child))
+        continue;
+
+      clutter_actor_paint (child, paint_context);
+    }
+}
+
 static void
 surface_container_dispose (GObject *object)
 {
   MetaSurfaceContainerActorWayland *self = META_SURFACE_CONTAINER_ACTOR_WAYLAND (object);
 
+  g_hash_table_remove_all (self->occluded_surfaces);
   clutter_actor_remove_all_children (CLUTTER_ACTOR (self));
 
   G_OBJECT_CLASS (meta_surface_container_actor_wayland_parent_class)->dispose (object);
 }
 
+static void
+surface_container_finalize (GObject *object)
+{
+  MetaSurfaceContainerActorWayland *self = META_SURFACE_CONTAINER_ACTOR_WAYLAND (object);
+
+  g_clear_pointer (&self->occluded_surfaces, g_hash_table_unref);
+
+  G_OBJECT_CLASS (meta_surface_container_actor_wayland_parent_class)->finalize (object);
+}
+
 static void
 meta_surface_container_actor_wayland_class_init (MetaSurfaceContainerActorWaylandClass *klass)
 {
@@ -169,13 +210,16 @@ meta_surface_container_actor_wayland_class_init (MetaSurfaceContainerActorWaylan
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   actor_class->apply_transform = surface_container_apply_transform;
+  actor_class->paint = surface_container_paint;
 
   object_class->dispose = surface_container_dispose;
+  object_class->finalize = surface_container_finalize;
 }
 
 static void
 meta_surface_container_actor_wayland_init (MetaSurfaceContainerActorWayland *self)
 {
+  self->occluded_surfaces = g_hash_table_new (NULL, NULL);
 }
 
 static gboolean
@@ -402,15 +446,8 @@ meta_window_actor_wayland_get_scanout_candidate (MetaWindowActor *actor)
 
       bg_surface = meta_surface_actor_wayland_get_surface (bg_surface_actor);
       buffer = meta_wayland_surface_get_buffer (bg_surface);
-      if (buffer->type == META_WAYLAND_BUFFER_TYPE_SINGLE_PIXEL)
-        {
-          MetaWaylandSinglePixelBuffer *sp_buffer;
-
-          sp_buffer = meta_wayland_single_pixel_buffer_from_buffer (buffer);
-          if (sp_buffer &&
-              meta_wayland_single_pixel_buffer_is_opaque_black (sp_buffer))
-            return topmost_surface_actor;
-        }
+      if (meta_wayland_buffer_is_opaque_black (buffer))
+        return topmost_surface_actor;
     }
 
   if (meta_surface_actor_is_opaque (topmost_surface_actor) &&
@@ -465,6 +502,11 @@ static void
 meta_window_actor_wayland_after_paint (MetaWindowActor  *actor,
                                        ClutterStageView *stage_view)
 {
+  MetaWindow *window = meta_window_actor_get_meta_window (actor);
+
+  /* Send the next pending interactive resize, now that the previous one
+   * made it to the screen. */
+  meta_window_wayland_check_update_resize (window);
 }
 
 static void
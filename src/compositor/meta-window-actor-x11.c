@@ -23,6 +23,7 @@
 #include "compositor/meta-window-actor-x11.h"
 
 #include "backends/meta-logical-monitor.h"
+#include "backends/meta-settings-private.h"
 #include "clutter/clutter-frame-clock.h"
 #include "compositor/compositor-private.h"
 #include "compositor/meta-cullable.h"
@@ -118,6 +119,43 @@ remove_frame_messages_timer (MetaWindowActorX11 *actor_x11)
   g_clear_handle_id (&actor_x11->send_frame_messages_timer, g_source_remove);
 }
 
+static float
+get_refresh_rate (MetaWindowActorX11 *actor_x11)
+{
+  MetaWindow *window =
+    meta_window_actor_get_meta_window (META_WINDOW_ACTOR (actor_x11));
+  ClutterFrameClock *frame_clock;
+  MetaLogicalMonitor *logical_monitor;
+
+  /* The frame clock follows what is actually presented, e.g. with variable
+   * refresh rate, so prefer it over the nominal refresh rate of the mode. */
+  frame_clock = clutter_actor_pick_frame_clock (CLUTTER_ACTOR (actor_x11),
+                                                NULL);
+  if (frame_clock)
+    {
+      float refresh_rate;
+
+      refresh_rate = clutter_frame_clock_get_refresh_rate (frame_clock);
+      if (refresh_rate >= 1.0f)
+        return refresh_rate;
+    }
+
+  logical_monitor = meta_window_get_main_logical_monitor (window);
+  if (logical_monitor)
+    {
+      GList *monitors = meta_logical_monitor_get_monitors (logical_monitor);
+      MetaMonitor *monitor;
+      MetaMonitorMode *mode;
+
+      monitor = g_list_first (monitors)->data;
+      mode = meta_monitor_get_current_mode (monitor);
+
+      return meta_monitor_mode_get_refresh_rate (mode);
+    }
+
+  return 60.0f;
+}
+
 static gboolean
 send_frame_messages_timeout (gpointer data)
 {
@@ -125,14 +163,19 @@ send_frame_messages_timeout (gpointer data)
   MetaWindow *window =
     meta_window_actor_get_meta_window (META_WINDOW_ACTOR (actor_x11));
   MetaSyncCounter *sync_counter;
+  int refresh_interval;
+
+  /* Nothing is presented, but the client can still pace itself to the
+   * refresh rate it would be presented at. */
+  refresh_interval = (int) (0.5 + G_USEC_PER_SEC / get_refresh_rate (actor_x11));
 
   sync_counter = meta_window_x11_get_sync_counter (window);
-  meta_sync_counter_finish_incomplete (sync_counter);
+  meta_sync_counter_finish_incomplete (sync_counter, refresh_interval);
 
   if (window->frame)
     {
       sync_counter = meta_frame_get_sync_counter (window->frame);
-      meta_sync_counter_finish_incomplete (sync_counter);
+      meta_sync_counter_finish_incomplete (sync_counter, refresh_interval);
     }
 
   actor_x11->send_frame_messages_timer = 0;
@@ -146,7 +189,6 @@ queue_send_frame_messages_timeout (MetaWindowActorX11 *actor_x11)
   MetaWindow *window =
     meta_window_actor_get_meta_window (META_WINDOW_ACTOR (actor_x11));
   MetaDisplay *display = meta_window_get_display (window);
-  MetaLogicalMonitor *logical_monitor;
   MetaSyncCounter *sync_counter;
   int64_t now_us;
   int64_t current_time;
@@ -156,22 +198,7 @@ queue_send_frame_messages_timeout (MetaWindowActorX11 *actor_x11)
   if (actor_x11->send_frame_messages_timer != 0)
     return;
 
-  logical_monitor = meta_window_get_main_logical_monitor (window);
-  if (logical_monitor)
-    {
-      GList *monitors = meta_logical_monitor_get_monitors (logical_monitor);
-      MetaMonitor *monitor;
-      MetaMonitorMode *mode;
-
-      monitor = g_list_first (monitors)->data;
-      mode = meta_monitor_get_current_mode (monitor);
-
-      refresh_rate = meta_monitor_mode_get_refresh_rate (mode);
-    }
-  else
-    {
-      refresh_rate = 60.0f;
-    }
+  refresh_rate = get_refresh_rate (actor_x11);
 
   now_us = g_get_monotonic_time ();
   current_time =
@@ -1008,6 +1035,17 @@ is_actor_maybe_transparent (MetaWindowActorX11 *actor_x11)
   return TRUE;
 }
 
+static gboolean
+should_infer_opaque_region (MetaWindow *window)
+{
+  MetaContext *context = meta_display_get_context (window->display);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+
+  return meta_settings_is_experimental_feature_enabled (
+    settings, META_EXPERIMENTAL_FEATURE_INFER_OPAQUE_REGIONS);
+}
+
 static void
 update_opaque_region (MetaWindowActorX11 *actor_x11)
 {
@@ -1065,6 +1103,10 @@ update_opaque_region (MetaWindowActorX11 *actor_x11)
 
   surface = meta_window_actor_get_surface (META_WINDOW_ACTOR (actor_x11));
   meta_surface_actor_set_opaque_region (surface, opaque_region);
+  meta_surface_actor_set_infer_opaque_region (surface,
+                                              is_maybe_transparent &&
+                                              !opaque_region &&
+                                              should_infer_opaque_region (window));
 }
 
 static void
@@ -81,6 +81,7 @@ typedef struct _MetaWindowActorPrivate
   guint		    needs_destroy	   : 1;
 
   guint             updates_frozen         : 1;
+  guint             redirected_while_frozen : 1;
   guint             first_frame_state      : 2; /* FirstFrameState */
 } MetaWindowActorPrivate;
 
@@ -1175,11 +1176,34 @@ meta_window_actor_set_updates_frozen (MetaWindowActor *self,
 
   if (priv->updates_frozen != updates_frozen)
     {
+      ClutterActor *actor = CLUTTER_ACTOR (self);
+
       priv->updates_frozen = updates_frozen;
       if (updates_frozen)
-        meta_window_actor_freeze (self);
+        {
+          meta_window_actor_freeze (self);
+
+          /* While the client catches up with e.g. an interactive resize,
+           * the contents don't change, so let any repaint overlapping the
+           * window reuse a cached image of it, decorations and shadow
+           * included, instead of painting it all over again */
+          if (clutter_actor_get_offscreen_redirect (actor) == 0)
+            {
+              clutter_actor_set_offscreen_redirect (actor,
+                                                    CLUTTER_OFFSCREEN_REDIRECT_ON_IDLE);
+              priv->redirected_while_frozen = TRUE;
+            }
+        }
       else
-        meta_window_actor_thaw (self);
+        {
+          if (priv->redirected_while_frozen)
+            {
+              clutter_actor_set_offscreen_redirect (actor, 0);
+              priv->redirected_while_frozen = FALSE;
+            }
+
+          meta_window_actor_thaw (self);
+        }
     }
 }
 
@@ -1405,6 +1429,98 @@ meta_window_actor_capture_into (MetaScreenCastWindow *screen_cast_window,
   cairo_surface_destroy (image);
 }
 
+/*
+ * When the window consists of nothing but a single surface whose buffer is
+ * painted as is, its contents can be copied straight into the stream
+ * framebuffer, avoiding a pass through the paint machinery.
+ */
+static gboolean
+blit_surface_texture_to_framebuffer (MetaWindowActor *window_actor,
+                                     MtkRectangle    *bounds,
+                                     CoglFramebuffer *framebuffer)
+{
+  MetaWindowActorPrivate *priv =
+    meta_window_actor_get_instance_private (window_actor);
+  ClutterActor *actor = CLUTTER_ACTOR (window_actor);
+  CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaShapedTexture *stex;
+  CoglTexture *texture;
+  graphene_rect_t scaled_bounds;
+  MtkRectangle texture_rect;
+  MtkRectangle copy_rect;
+  CoglColor clear_color;
+
+  if (!cogl_has_feature (cogl_context, COGL_FEATURE_ID_BLIT_FRAMEBUFFER))
+    return FALSE;
+
+  if (clutter_actor_get_n_children (actor) != 1 ||
+      clutter_actor_get_n_children (CLUTTER_ACTOR (priv->surface)) != 0)
+    return FALSE;
+
+  if (clutter_actor_has_effects (actor) ||
+      clutter_actor_has_effects (CLUTTER_ACTOR (priv->surface)))
+    return FALSE;
+
+  if (clutter_actor_get_paint_opacity (CLUTTER_ACTOR (priv->surface)) != 0xff)
+    return FALSE;
+
+  stex = meta_surface_actor_get_texture (priv->surface);
+  texture = meta_shaped_texture_get_untransformed_texture (stex);
+  if (!texture)
+    return FALSE;
+
+  /* The bounds are in logical pixels, and the framebuffer is laid out in
+   * buffer pixels, with the same origin as the texture. */
+  scaled_bounds = mtk_rectangle_to_graphene_rect (bounds);
+  graphene_rect_scale (&scaled_bounds,
+                       meta_shaped_texture_get_unscaled_width (stex) /
+                       meta_shaped_texture_get_width (stex),
+                       meta_shaped_texture_get_unscaled_height (stex) /
+                       meta_shaped_texture_get_height (stex),
+                       &scaled_bounds);
+  mtk_rectangle_from_graphene_rect (&scaled_bounds,
+                                    MTK_ROUNDING_STRATEGY_GROW,
+                                    &copy_rect);
+
+  texture_rect = MTK_RECTANGLE_INIT (0, 0,
+                                     cogl_texture_get_width (texture),
+                                     cogl_texture_get_height (texture));
+  if (!mtk_rectangle_intersect (&copy_rect, &texture_rect, &copy_rect))
+    return FALSE;
+
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    {
+      meta_topic (META_DEBUG_SCREEN_CAST,
+                  "Can't copy window buffer directly: %s", error->message);
+      return FALSE;
+    }
+
+  if (copy_rect.x != 0 || copy_rect.y != 0 ||
+      copy_rect.width < cogl_framebuffer_get_width (framebuffer) ||
+      copy_rect.height < cogl_framebuffer_get_height (framebuffer))
+    {
+      cogl_color_init_from_4ub (&clear_color, 0, 0, 0, 0);
+      cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+    }
+
+  if (!cogl_blit_framebuffer (COGL_FRAMEBUFFER (offscreen),
+                              framebuffer,
+                              copy_rect.x, copy_rect.y,
+                              copy_rect.x, copy_rect.y,
+                              copy_rect.width, copy_rect.height,
+                              &error))
+    {
+      meta_topic (META_DEBUG_SCREEN_CAST,
+                  "Failed to copy window buffer directly: %s", error->message);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
                                        MtkRectangle         *bounds,
@@ -1443,6 +1559,9 @@ meta_window_actor_blit_to_framebuffer (MetaScreenCastWindow *screen_cast_window,
   if (!graphene_matrix_inverse (&transform, &inverted_transform))
     return FALSE;
 
+  if (blit_surface_texture_to_framebuffer (window_actor, bounds, framebuffer))
+    return TRUE;
+
   unscaled_width = meta_shaped_texture_get_unscaled_width (stex);
   unscaled_height = meta_shaped_texture_get_unscaled_height (stex);
 
@@ -27,6 +27,10 @@
 #include "core/window-private.h"
 #include "meta/meta-enum-types.h"
 
+#ifdef HAVE_WAYLAND
+#include "wayland/meta-window-wayland.h"
+#endif
+
 #ifdef HAVE_X11_CLIENT
 #include "x11/window-x11.h"
 #endif
@@ -1504,6 +1508,16 @@ update_resize (MetaWindowDrag          *window_drag,
     return;
 #endif
 
+  /* Likewise, don't send Wayland clients another resize configuration
+   * until they acked and committed the previous one; the most recent size
+   * is sent after that has been painted.
+   */
+#ifdef HAVE_WAYLAND
+  if (window->client_type == META_WINDOW_CLIENT_TYPE_WAYLAND &&
+      meta_window_wayland_is_awaiting_resize_ack (window))
+    return;
+#endif
+
   meta_window_get_frame_rect (window, &old_rect);
 
   /* One sided resizing ought to actually be one-sided, despite the fact that
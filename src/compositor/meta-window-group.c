@@ -17,11 +17,22 @@ struct _MetaWindowGroupClass
   ClutterActorClass parent_class;
 };
 
+/* Clones painting the window group at most at this scale, like workspace
+ * thumbnails, paint a cached downscaled image of it instead */
+#define MAX_THUMBNAIL_SCALE 0.5f
+#define MIN_THUMBNAIL_SCALE (1.0f / 16.0f)
+
 struct _MetaWindowGroup
 {
   ClutterActor parent;
 
   MetaDisplay *display;
+
+  ClutterEffect *damage_tracker;
+  CoglOffscreen *thumbnail_offscreen;
+  CoglPipeline *thumbnail_pipeline;
+  float thumbnail_scale;
+  gboolean thumbnail_dirty;
 };
 
 static void cullable_iface_init (MetaCullableInterface *iface);
@@ -29,6 +40,53 @@ static void cullable_iface_init (MetaCullableInterface *iface);
 G_DEFINE_TYPE_WITH_CODE (MetaWindowGroup, meta_window_group, CLUTTER_TYPE_ACTOR,
                          G_IMPLEMENT_INTERFACE (META_TYPE_CULLABLE, cullable_iface_init));
 
+#define META_TYPE_WINDOW_GROUP_DAMAGE_TRACKER (meta_window_group_damage_tracker_get_type ())
+G_DECLARE_FINAL_TYPE (MetaWindowGroupDamageTracker,
+                      meta_window_group_damage_tracker,
+                      META, WINDOW_GROUP_DAMAGE_TRACKER,
+                      ClutterEffect)
+
+struct _MetaWindowGroupDamageTracker
+{
+  ClutterEffect parent;
+};
+
+G_DEFINE_FINAL_TYPE (MetaWindowGroupDamageTracker,
+                     meta_window_group_damage_tracker,
+                     CLUTTER_TYPE_EFFECT)
+
+static void
+meta_window_group_damage_tracker_paint (ClutterEffect           *effect,
+                                        ClutterPaintNode        *node,
+                                        ClutterPaintContext     *paint_context,
+                                        ClutterEffectPaintFlags  flags)
+{
+  ClutterEffectClass *parent_effect_class =
+    CLUTTER_EFFECT_CLASS (meta_window_group_damage_tracker_parent_class);
+  ClutterActor *actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+
+  /* Whichever paint comes first after anything in the window group queued
+   * a redraw sees it as dirty, so remember it until the thumbnail has been
+   * updated */
+  if (flags & CLUTTER_EFFECT_PAINT_ACTOR_DIRTY)
+    META_WINDOW_GROUP (actor)->thumbnail_dirty = TRUE;
+
+  parent_effect_class->paint (effect, node, paint_context, flags);
+}
+
+static void
+meta_window_group_damage_tracker_class_init (MetaWindowGroupDamageTrackerClass *klass)
+{
+  ClutterEffectClass *effect_class = CLUTTER_EFFECT_CLASS (klass);
+
+  effect_class->paint = meta_window_group_damage_tracker_paint;
+}
+
+static void
+meta_window_group_damage_tracker_init (MetaWindowGroupDamageTracker *tracker)
+{
+}
+
 static void
 meta_window_group_cull_unobscured (MetaCullable *cullable,
                                    MtkRegion    *unobscured_region)
@@ -50,6 +108,170 @@ cullable_iface_init (MetaCullableInterface *iface)
   iface->cull_redraw_clip = meta_window_group_cull_redraw_clip;
 }
 
+static void
+clear_thumbnail (MetaWindowGroup *window_group)
+{
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+  g_clear_object (&window_group->thumbnail_pipeline);
+
+  if (window_group->thumbnail_offscreen)
+    {
+      cogl_context_release_offscreen (ctx,
+                                      g_steal_pointer (&window_group->thumbnail_offscreen),
+                                      COGL_PIXEL_FORMAT_ANY);
+    }
+}
+
+static void
+release_thumbnail (MetaWindowGroup *window_group)
+{
+  clear_thumbnail (window_group);
+
+  if (window_group->damage_tracker)
+    {
+      clutter_actor_remove_effect (CLUTTER_ACTOR (window_group),
+                                   window_group->damage_tracker);
+      window_group->damage_tracker = NULL;
+    }
+}
+
+static gboolean
+update_thumbnail (MetaWindowGroup *window_group,
+                  float            stage_width,
+                  float            stage_height,
+                  float            scale)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (window_group);
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  g_autoptr (GError) error = NULL;
+  ClutterPaintContext *thumbnail_paint_context;
+  CoglFramebuffer *framebuffer;
+  CoglColor clear_color;
+  ClutterActorIter iter;
+  ClutterActor *child;
+
+  if (window_group->thumbnail_scale != scale)
+    clear_thumbnail (window_group);
+
+  if (!window_group->thumbnail_offscreen)
+    {
+      CoglTexture *texture;
+
+      window_group->thumbnail_offscreen =
+        cogl_context_acquire_offscreen (ctx,
+                                        MAX (ceilf (stage_width * scale), 1),
+                                        MAX (ceilf (stage_height * scale), 1),
+                                        COGL_PIXEL_FORMAT_ANY,
+                                        &error);
+      if (!window_group->thumbnail_offscreen)
+        {
+          g_warning ("Failed to create window group thumbnail: %s",
+                     error->message);
+          return FALSE;
+        }
+
+      texture = cogl_offscreen_get_texture (window_group->thumbnail_offscreen);
+      window_group->thumbnail_pipeline = cogl_pipeline_new (ctx);
+      cogl_pipeline_set_layer_texture (window_group->thumbnail_pipeline,
+                                       0, texture);
+      cogl_pipeline_set_layer_filters (window_group->thumbnail_pipeline, 0,
+                                       COGL_PIPELINE_FILTER_LINEAR,
+                                       COGL_PIPELINE_FILTER_LINEAR);
+
+      window_group->thumbnail_scale = scale;
+    }
+
+  if (!window_group->damage_tracker)
+    {
+      window_group->damage_tracker =
+        g_object_new (META_TYPE_WINDOW_GROUP_DAMAGE_TRACKER, NULL);
+      clutter_actor_add_effect (actor, window_group->damage_tracker);
+    }
+
+  framebuffer = COGL_FRAMEBUFFER (window_group->thumbnail_offscreen);
+
+  cogl_color_init_from_4f (&clear_color, 0.0f, 0.0f, 0.0f, 0.0f);
+  cogl_framebuffer_clear (framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+  cogl_framebuffer_orthographic (framebuffer,
+                                 0, 0, stage_width, stage_height,
+                                 -1.0f, 1.0f);
+
+  thumbnail_paint_context =
+    clutter_paint_context_new_for_framebuffer (framebuffer, NULL,
+                                               CLUTTER_PAINT_FLAG_NONE);
+
+  meta_cullable_cull_redraw_clip (META_CULLABLE (window_group), NULL);
+
+  clutter_actor_iter_init (&iter, actor);
+  while (clutter_actor_iter_next (&iter, &child))
+    clutter_actor_paint (child, thumbnail_paint_context);
+
+  clutter_paint_context_destroy (thumbnail_paint_context);
+
+  window_group->thumbnail_dirty = FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+paint_thumbnail (MetaWindowGroup     *window_group,
+                 ClutterPaintContext *paint_context,
+                 graphene_matrix_t   *stage_to_actor)
+{
+  ClutterActor *actor = CLUTTER_ACTOR (window_group);
+  ClutterActor *stage = clutter_actor_get_stage (actor);
+  ClutterStageView *view = clutter_paint_context_get_stage_view (paint_context);
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+  graphene_matrix_t actor_to_stage;
+  float stage_width, stage_height;
+  float paint_scale;
+  float scale;
+  uint8_t opacity;
+
+  /* The thumbnail covers the stage, which is where the window group
+   * normally is */
+  clutter_actor_get_relative_transformation_matrix (actor, stage,
+                                                    &actor_to_stage);
+  if (!graphene_matrix_is_identity (&actor_to_stage))
+    return FALSE;
+
+  paint_scale =
+    clutter_stage_view_get_scale (view) /
+    MIN (fabsf (graphene_matrix_get_x_scale (stage_to_actor)),
+         fabsf (graphene_matrix_get_y_scale (stage_to_actor)));
+  if (paint_scale > MAX_THUMBNAIL_SCALE)
+    return FALSE;
+
+  /* Stick to power of two fractions of the stage size, so that animating
+   * scales don't cause a new thumbnail to be drawn every frame */
+  scale = MAX_THUMBNAIL_SCALE;
+  while (scale / 2.0f >= paint_scale && scale / 2.0f >= MIN_THUMBNAIL_SCALE)
+    scale /= 2.0f;
+
+  clutter_actor_get_size (stage, &stage_width, &stage_height);
+
+  if (window_group->thumbnail_dirty ||
+      window_group->thumbnail_scale != scale ||
+      !window_group->thumbnail_offscreen)
+    {
+      if (!update_thumbnail (window_group, stage_width, stage_height, scale))
+        return FALSE;
+    }
+
+  opacity = clutter_actor_get_paint_opacity (actor);
+  cogl_pipeline_set_color4ub (window_group->thumbnail_pipeline,
+                              opacity, opacity, opacity, opacity);
+  cogl_framebuffer_draw_rectangle (framebuffer,
+                                   window_group->thumbnail_pipeline,
+                                   0, 0, stage_width, stage_height);
+
+  return TRUE;
+}
+
 static void
 meta_window_group_paint (ClutterActor        *actor,
                          ClutterPaintContext *paint_context)
@@ -60,7 +282,10 @@ meta_window_group_paint (ClutterActor        *actor,
   ClutterActor *stage = clutter_actor_get_stage (actor);
   const MtkRegion *redraw_clip;
   g_autoptr (MtkRegion) clip_region = NULL;
+  g_autoptr (GHashTable) occluded_children = NULL;
   graphene_matrix_t stage_to_actor;
+  ClutterActorIter iter;
+  ClutterActor *child;
 
   redraw_clip = clutter_paint_context_get_redraw_clip (paint_context);
   if (!redraw_clip)
@@ -100,11 +325,20 @@ meta_window_group_paint (ClutterActor        *actor,
       clutter_actor_get_transform (stage, &stage_to_eye);
       graphene_matrix_multiply (&stage_to_eye, &eye_to_actor,
                                 &stage_to_actor);
+
+      if (graphene_matrix_is_2d (&stage_to_actor) &&
+          paint_thumbnail (window_group, paint_context, &stage_to_actor))
+        return;
     }
   else
     {
       graphene_matrix_t actor_to_stage;
 
+      /* Nothing is showing a thumbnail anymore */
+      if (window_group->damage_tracker &&
+          !clutter_actor_has_mapped_clones (actor))
+        release_thumbnail (window_group);
+
       clutter_actor_get_relative_transformation_matrix (actor, stage,
                                                         &actor_to_stage);
       if (!graphene_matrix_inverse (&actor_to_stage, &stage_to_actor))
@@ -122,9 +356,21 @@ meta_window_group_paint (ClutterActor        *actor,
   clip_region = mtk_region_apply_matrix_transform_expand (redraw_clip,
                                                           &stage_to_actor);
 
-  meta_cullable_cull_redraw_clip (META_CULLABLE (window_group), clip_region);
+  occluded_children = g_hash_table_new (NULL, NULL);
+  meta_cullable_cull_redraw_clip_children_occluded (META_CULLABLE (window_group),
+                                                    clip_region,
+                                                    occluded_children);
 
-  parent_actor_class->paint (actor, paint_context);
+  /* Fully occluded windows are skipped altogether, so that neither their
+   * shadows nor the paint nodes of their surfaces are built. */
+  clutter_actor_iter_init (&iter, actor);
+  while (clutter_actor_iter_next (&iter, &child))
+    {
+      if (g_hash_table_contains (occluded_children, child))
+        continue;
+
+      clutter_actor_paint (child, paint_context);
+    }
 
   meta_cullable_cull_redraw_clip (META_CULLABLE (window_group), NULL);
 
@@ -190,11 +436,24 @@ meta_window_group_get_preferred_height (ClutterActor *actor,
   *nat_height = 0;
 }
 
+static void
+meta_window_group_dispose (GObject *object)
+{
+  MetaWindowGroup *window_group = META_WINDOW_GROUP (object);
+
+  release_thumbnail (window_group);
+
+  G_OBJECT_CLASS (meta_window_group_parent_class)->dispose (object);
+}
+
 static void
 meta_window_group_class_init (MetaWindowGroupClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
 
+  object_class->dispose = meta_window_group_dispose;
+
   actor_class->paint = meta_window_group_paint;
   actor_class->get_paint_volume = meta_window_group_get_paint_volume;
   actor_class->get_preferred_width = meta_window_group_get_preferred_width;
@@ -316,6 +316,15 @@ meta_window_constrain (MetaWindow          *window,
                          new);
   place_window_if_needed (window, &info);
 
+  /* Enforcing a constraint that is already satisfied leaves the rectangle
+   * untouched, so when everything is satisfied up front, as is usually the
+   * case for each step of an interactive move, skip the enforcing passes.
+   * Placement rules are excluded, as enforcing them also updates the
+   * relative and temporary positions.
+   */
+  if (!meta_window_get_placement_rule (window))
+    satisfied = do_all_constraints (window, &info, priority, TRUE);
+
   while (!satisfied && priority <= PRIORITY_MAXIMUM) {
     gboolean check_only = TRUE;
 
@@ -30,6 +30,7 @@
 
 #include "clutter/clutter.h"
 #include "core/keybindings-private.h"
+#include "core/meta-anonymous-file.h"
 #include "core/meta-gesture-tracker-private.h"
 #include "core/meta-pad-action-mapper.h"
 #include "core/stack-tracker.h"
@@ -151,8 +152,9 @@ struct _MetaDisplay
   MetaSoundPlayer *sound_player;
 
   MetaSelectionSource *selection_source;
-  GBytes *saved_clipboard;
+  MetaAnonymousFile *saved_clipboard;
   gchar *saved_clipboard_mimetype;
+  GCancellable *saved_clipboard_cancellable;
   MetaSelection *selection;
 };
 
@@ -124,6 +124,9 @@ typedef struct
   guint       ping_timeout_id;
 } MetaPingData;
 
+/* Time spent laying out hidden windows per idle iteration */
+#define DEFERRED_MOVE_RESIZE_BUDGET_US 1000
+
 typedef struct
 {
   MetaDisplay *display;
@@ -137,6 +140,9 @@ typedef struct _MetaDisplayPrivate
   guint queue_later_ids[META_N_QUEUE_TYPES];
   GList *queue_windows[META_N_QUEUE_TYPES];
 
+  guint deferred_move_resize_later_id;
+  GList *deferred_move_resize_windows;
+
   gboolean enable_input_capture;
 
   struct {
@@ -1233,6 +1239,7 @@ void
 meta_display_close (MetaDisplay *display,
                     guint32      timestamp)
 {
+  MetaDisplayPrivate *priv = meta_display_get_instance_private (display);
   MetaBackend *backend = backend_from_display (display);
   ClutterActor *stage = meta_backend_get_stage (backend);
   MetaCompositor *compositor;
@@ -1265,6 +1272,9 @@ meta_display_close (MetaDisplay *display,
     meta_laters_remove (laters, display->work_area_later);
   if (display->check_fullscreen_later != 0)
     meta_laters_remove (laters, display->check_fullscreen_later);
+  if (priv->deferred_move_resize_later_id != 0)
+    meta_laters_remove (laters, priv->deferred_move_resize_later_id);
+  g_clear_pointer (&priv->deferred_move_resize_windows, g_list_free);
 
   /* Stop caring about events */
   meta_display_free_events (display);
@@ -2960,9 +2970,14 @@ on_monitors_changed_internal (MetaMonitorManager *monitor_manager,
                                (MetaDisplayWindowFunc)
                                meta_window_update_for_monitors_changed, 0);
 
-  /* Queue a resize on all the windows */
-  meta_display_foreach_window (display, META_LIST_DEFAULT,
-                               meta_display_resize_func, 0);
+  /* Queue a resize on all the windows, unless only properties such as the
+   * privacy screen state changed */
+  if (meta_monitor_manager_get_changed_flags (monitor_manager) &
+      META_MONITORS_CHANGED_FLAG_GEOMETRY)
+    {
+      meta_display_foreach_window (display, META_LIST_DEFAULT,
+                                   meta_display_resize_func, 0);
+    }
 
   meta_display_queue_check_fullscreen (display);
 }
@@ -3580,6 +3595,10 @@ warn_on_incorrectly_unmanaged_window (MetaWindow *window)
   g_warn_if_fail (!window->unmanaging);
 }
 
+static void
+flush_deferred_move_resize (MetaDisplay *display,
+                            GList       *windows);
+
 static void
 update_window_visibilities (MetaDisplay *display,
                             GList       *windows)
@@ -3612,6 +3631,10 @@ update_window_visibilities (MetaDisplay *display,
   should_show = g_list_sort (should_show, window_stack_cmp);
   should_show = g_list_reverse (should_show);
 
+  /* Windows about to be shown must not be shown with a stale layout */
+  flush_deferred_move_resize (display, unplaced);
+  flush_deferred_move_resize (display, should_show);
+
   COGL_TRACE_BEGIN_SCOPED (MetaDisplayShowUnplacedWindows,
                            "Meta::Display::update_window_visibilities#show_unplaced()");
   g_list_foreach (unplaced, (GFunc) meta_window_update_visibility, NULL);
@@ -3656,6 +3679,112 @@ static const WindowQueueFunc window_queue_func[META_N_QUEUE_TYPES] =
   move_resize,
 };
 
+static void
+flush_deferred_move_resize (MetaDisplay *display,
+                            GList       *windows)
+{
+  MetaDisplayPrivate *priv = meta_display_get_instance_private (display);
+  GList *l;
+
+  if (!priv->deferred_move_resize_windows)
+    return;
+
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *window = l->data;
+      GList *link;
+
+      link = g_list_find (priv->deferred_move_resize_windows, window);
+      if (!link)
+        continue;
+
+      priv->deferred_move_resize_windows =
+        g_list_delete_link (priv->deferred_move_resize_windows, link);
+      meta_window_update_layout (window);
+    }
+}
+
+static gboolean
+deferred_move_resize_later_func (gpointer user_data)
+{
+  MetaDisplay *display = user_data;
+  MetaDisplayPrivate *priv = meta_display_get_instance_private (display);
+  unsigned int later_id;
+  int64_t start_time_us;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaDisplayDeferredMoveResize,
+                           "Meta::Display::deferred_move_resize()");
+
+  /* Laying out a window may unqueue others; don't let that remove us */
+  later_id = priv->deferred_move_resize_later_id;
+  priv->deferred_move_resize_later_id = 0;
+
+  start_time_us = g_get_monotonic_time ();
+
+  while (priv->deferred_move_resize_windows)
+    {
+      MetaWindow *window = priv->deferred_move_resize_windows->data;
+
+      priv->deferred_move_resize_windows =
+        g_list_delete_link (priv->deferred_move_resize_windows,
+                            priv->deferred_move_resize_windows);
+      meta_window_update_layout (window);
+
+      if (g_get_monotonic_time () - start_time_us >
+          DEFERRED_MOVE_RESIZE_BUDGET_US)
+        break;
+    }
+
+  if (!priv->deferred_move_resize_windows ||
+      priv->deferred_move_resize_later_id)
+    return G_SOURCE_REMOVE;
+
+  priv->deferred_move_resize_later_id = later_id;
+  return G_SOURCE_CONTINUE;
+}
+
+/*
+ * Hidden windows, e.g. those on other workspaces or minimized ones, don't
+ * contribute to the next frame, so rather than have them delay it, lay
+ * them out when idle, a few at a time.
+ */
+static GList *
+defer_hidden_move_resize (MetaDisplay *display,
+                          GList       *windows)
+{
+  MetaDisplayPrivate *priv = meta_display_get_instance_private (display);
+  GList *l;
+
+  l = windows;
+  while (l)
+    {
+      MetaWindow *window = l->data;
+      GList *next = l->next;
+
+      if (window->hidden && window->placed)
+        {
+          windows = g_list_remove_link (windows, l);
+          priv->deferred_move_resize_windows =
+            g_list_concat (l, priv->deferred_move_resize_windows);
+        }
+
+      l = next;
+    }
+
+  if (priv->deferred_move_resize_windows &&
+      !priv->deferred_move_resize_later_id)
+    {
+      MetaLaters *laters = meta_compositor_get_laters (display->compositor);
+
+      priv->deferred_move_resize_later_id =
+        meta_laters_add (laters, META_LATER_IDLE,
+                         deferred_move_resize_later_func,
+                         display, NULL);
+    }
+
+  return windows;
+}
+
 static gboolean
 window_queue_run_later_func (gpointer user_data)
 {
@@ -3669,6 +3798,9 @@ window_queue_run_later_func (gpointer user_data)
 
   priv->queue_later_ids[queue_idx] = 0;
 
+  if (1 << queue_idx == META_QUEUE_MOVE_RESIZE)
+    windows = defer_hidden_move_resize (display, windows);
+
   window_queue_func[queue_idx] (display, windows);
 
   return G_SOURCE_REMOVE;
@@ -3749,6 +3881,19 @@ meta_display_unqueue_window (MetaDisplay   *display,
           priv->queue_later_ids[queue_idx] = 0;
         }
     }
+
+  if (queue_types & META_QUEUE_MOVE_RESIZE)
+    {
+      priv->deferred_move_resize_windows =
+        g_list_remove (priv->deferred_move_resize_windows, window);
+
+      if (!priv->deferred_move_resize_windows &&
+          priv->deferred_move_resize_later_id)
+        {
+          meta_laters_remove (laters, priv->deferred_move_resize_later_id);
+          priv->deferred_move_resize_later_id = 0;
+        }
+    }
 }
 
 void
@@ -103,6 +103,8 @@ typedef struct
 
   GHashTable *key_bindings;
   GHashTable *key_bindings_index;
+  /* Indexed by keycode, non-zero if any binding may use the keycode */
+  GArray *bound_keycodes;
   xkb_mod_mask_t ignored_modifier_mask;
   xkb_mod_mask_t hyper_mask;
   xkb_mod_mask_t virtual_hyper_mask;
@@ -555,6 +555,24 @@ devirtualize_modifiers (MetaKeyBindingManager *keys,
     *mask |= Mod5Mask;
 }
 
+static void
+mark_keycode_bound (MetaKeyBindingManager *keys,
+                    xkb_keycode_t          keycode)
+{
+  if (keycode >= keys->bound_keycodes->len)
+    g_array_set_size (keys->bound_keycodes, keycode + 1);
+
+  g_array_index (keys->bound_keycodes, guint8, keycode) = TRUE;
+}
+
+static gboolean
+is_keycode_bound (MetaKeyBindingManager *keys,
+                  xkb_keycode_t          keycode)
+{
+  return (keycode < keys->bound_keycodes->len &&
+          g_array_index (keys->bound_keycodes, guint8, keycode));
+}
+
 static void
 index_binding (MetaKeyBindingManager *keys,
                MetaKeyBinding         *binding)
@@ -567,6 +585,7 @@ index_binding (MetaKeyBindingManager *keys,
       guint32 index_key;
 
       index_key = key_combo_key (&binding->resolved_combo, i);
+      mark_keycode_bound (keys, binding->resolved_combo.keycodes[i]);
 
       existing = g_hash_table_lookup (keys->key_bindings_index,
                                       GINT_TO_POINTER (index_key));
@@ -773,6 +792,7 @@ static void
 reload_combos (MetaKeyBindingManager *keys)
 {
   g_hash_table_remove_all (keys->key_bindings_index);
+  g_array_set_size (keys->bound_keycodes, 0);
 
   reload_active_keyboard_layouts (keys);
 
@@ -927,6 +947,10 @@ get_keybinding (MetaKeyBindingManager *keys,
     {
       guint32 key;
 
+      /* Most key presses don't match any binding, avoid hashing those */
+      if (!is_keycode_bound (keys, resolved_combo->keycodes[i]))
+        continue;
+
       key = key_combo_key (resolved_combo, i);
       binding = g_hash_table_lookup (keys->key_bindings_index,
                                      GINT_TO_POINTER (key));
@@ -1413,6 +1437,7 @@ meta_display_shutdown_keys (MetaDisplay *display)
 
   g_hash_table_destroy (keys->key_bindings_index);
   g_hash_table_destroy (keys->key_bindings);
+  g_array_free (keys->bound_keycodes, TRUE);
 
   clear_active_keyboard_layouts (keys);
 }
@@ -3903,6 +3928,7 @@ meta_display_init_keys (MetaDisplay *display)
 
   keys->key_bindings = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) meta_key_binding_free);
   keys->key_bindings_index = g_hash_table_new (NULL, NULL);
+  keys->bound_keycodes = g_array_new (FALSE, TRUE, sizeof (guint8));
 
   reload_modmap (keys);
 
@@ -29,10 +29,29 @@ struct _MetaAnonymousFile
 {
   int fd;
   size_t size;
+
+  int ref_count;
+  unsigned int hash;
+
+  /* Only set for keys used to look up cached files */
+  const uint8_t *data;
+
+  /* Set while the file is cached but otherwise unused */
+  GList *unused_link;
 };
 
 #define READONLY_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE)
 
+/* Files with the same contents, e.g. the keymap sent to every client, are
+ * shared, and a few that are no longer used are kept around in case the
+ * same contents come up again, e.g. when switching back and forth between
+ * keyboard layouts. Anything larger than this isn't worth keeping. */
+#define MAX_CACHED_FILE_SIZE (1024 * 1024)
+#define MAX_UNUSED_FILES 8
+
+static GHashTable *cached_files;
+static GQueue unused_files = G_QUEUE_INIT;
+
 static int
 create_tmpfile_cloexec (char *tmpname)
 {
@@ -166,25 +185,90 @@ create_anonymous_file (off_t size)
   return fd;
 }
 
-/**
- * meta_anonymous_file_new: (skip)
- * @size: The size of @data
- * @data: The data of the file with the size @size
- *
- * Create a new anonymous read-only file of the given size and the given data
- * The intended use-case is for sending mid-sized data from the compositor
- * to clients.
- *
- * When done, free the data using meta_anonymous_file_free().
- *
- * If this function fails errno is set.
- *
- * Returns: The newly created #MetaAnonymousFile, or NULL on failure. Use
- *   meta_anonymous_file_free() to free the resources when done.
- */
-MetaAnonymousFile *
-meta_anonymous_file_new (size_t         size,
-                         const uint8_t *data)
+static unsigned int
+hash_data (size_t         size,
+           const uint8_t *data)
+{
+  g_autoptr (GBytes) bytes = NULL;
+
+  bytes = g_bytes_new_static (data, size);
+  return g_bytes_hash (bytes);
+}
+
+static unsigned int
+cached_file_hash (gconstpointer key)
+{
+  const MetaAnonymousFile *file = key;
+
+  return file->hash;
+}
+
+static gboolean
+cached_file_equal (gconstpointer a,
+                   gconstpointer b)
+{
+  const MetaAnonymousFile *file = a;
+  const MetaAnonymousFile *other = b;
+  const uint8_t *data;
+  const uint8_t *other_data;
+  void *map = NULL;
+  void *other_map = NULL;
+  gboolean equal;
+
+  if (file == other)
+    return TRUE;
+
+  if (file->size != other->size || file->hash != other->hash)
+    return FALSE;
+
+  if (file->data)
+    {
+      data = file->data;
+    }
+  else
+    {
+      map = mmap (NULL, file->size, PROT_READ, MAP_PRIVATE, file->fd, 0);
+      if (map == MAP_FAILED)
+        return FALSE;
+      data = map;
+    }
+
+  if (other->data)
+    {
+      other_data = other->data;
+    }
+  else
+    {
+      other_map = mmap (NULL, other->size, PROT_READ, MAP_PRIVATE, other->fd, 0);
+      if (other_map == MAP_FAILED)
+        {
+          if (map)
+            munmap (map, file->size);
+          return FALSE;
+        }
+      other_data = other_map;
+    }
+
+  equal = memcmp (data, other_data, file->size) == 0;
+
+  if (map)
+    munmap (map, file->size);
+  if (other_map)
+    munmap (other_map, other->size);
+
+  return equal;
+}
+
+static void
+destroy_file (MetaAnonymousFile *file)
+{
+  close (file->fd);
+  g_free (file);
+}
+
+static MetaAnonymousFile *
+create_file (size_t         size,
+             const uint8_t *data)
 {
   MetaAnonymousFile *file;
   void *map;
@@ -197,6 +281,7 @@ meta_anonymous_file_new (size_t         size,
     }
 
   file->size = size;
+  file->ref_count = 1;
   file->fd = create_anonymous_file (size);
   if (file->fd == -1)
     goto err_free;
@@ -228,6 +313,64 @@ err_free:
   return NULL;
 }
 
+/**
+ * meta_anonymous_file_new: (skip)
+ * @size: The size of @data
+ * @data: The data of the file with the size @size
+ *
+ * Create a new anonymous read-only file of the given size and the given data
+ * The intended use-case is for sending mid-sized data from the compositor
+ * to clients.
+ *
+ * When done, free the data using meta_anonymous_file_free().
+ *
+ * The returned file may be shared with other users that created a file
+ * with the same contents.
+ *
+ * If this function fails errno is set.
+ *
+ * Returns: The newly created #MetaAnonymousFile, or NULL on failure. Use
+ *   meta_anonymous_file_free() to free the resources when done.
+ */
+MetaAnonymousFile *
+meta_anonymous_file_new (size_t         size,
+                         const uint8_t *data)
+{
+  MetaAnonymousFile key = { 0 };
+  MetaAnonymousFile *file;
+
+  if (size > MAX_CACHED_FILE_SIZE)
+    return create_file (size, data);
+
+  if (!cached_files)
+    cached_files = g_hash_table_new (cached_file_hash, cached_file_equal);
+
+  key.size = size;
+  key.hash = hash_data (size, data);
+  key.data = data;
+
+  file = g_hash_table_lookup (cached_files, &key);
+  if (file)
+    {
+      if (file->unused_link)
+        {
+          g_queue_delete_link (&unused_files, file->unused_link);
+          file->unused_link = NULL;
+        }
+
+      file->ref_count++;
+      return file;
+    }
+
+  file = create_file (size, data);
+  if (!file)
+    return NULL;
+
+  file->hash = key.hash;
+  g_hash_table_add (cached_files, file);
+
+  return file;
+}
 
 /**
  * meta_anonymous_file_free: (skip)
@@ -238,8 +381,28 @@ err_free:
 void
 meta_anonymous_file_free (MetaAnonymousFile *file)
 {
-  close (file->fd);
-  g_free (file);
+  MetaAnonymousFile *evicted;
+
+  g_return_if_fail (file->ref_count > 0);
+
+  if (--file->ref_count > 0)
+    return;
+
+  if (file->size > MAX_CACHED_FILE_SIZE)
+    {
+      destroy_file (file);
+      return;
+    }
+
+  g_queue_push_head (&unused_files, file);
+  file->unused_link = unused_files.head;
+
+  if (unused_files.length <= MAX_UNUSED_FILES)
+    return;
+
+  evicted = g_queue_pop_tail (&unused_files);
+  g_hash_table_remove (cached_files, evicted);
+  destroy_file (evicted);
 }
 
 /**
@@ -19,6 +19,8 @@
 
 #include "config.h"
 
+#include <errno.h>
+
 #include "core/meta-clipboard-manager.h"
 #include "core/meta-selection-private.h"
 #include "meta/meta-selection-source-memory.h"
@@ -68,20 +70,60 @@ transfer_cb (MetaSelection *selection,
              GOutputStream *output)
 {
   MetaDisplay *display = meta_selection_get_display (selection);
+  g_autoptr (GBytes) bytes = NULL;
   GError *error = NULL;
+  gssize max_transfer_size;
+  int idx;
 
   if (!meta_selection_transfer_finish (selection, result, &error))
     {
-      g_warning ("Failed to store clipboard: %s", error->message);
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+          g_warning ("Failed to store clipboard: %s", error->message);
+          g_clear_object (&display->saved_clipboard_cancellable);
+        }
       g_error_free (error);
       g_object_unref (output);
       return;
     }
 
+  g_clear_object (&display->saved_clipboard_cancellable);
+
   g_output_stream_close (output, NULL, NULL);
-  display->saved_clipboard =
-    g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
+  bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (output));
   g_object_unref (output);
+
+  /* One byte more than the limit was requested, to tell contents that
+   * are too large apart from those that fit exactly. Truncated contents
+   * wouldn't be of use to anyone.
+   */
+  if (!mimetype_match (display->saved_clipboard_mimetype,
+                       &idx, &max_transfer_size) ||
+      g_bytes_get_size (bytes) > max_transfer_size)
+    {
+      g_debug ("Clipboard contents too large to store");
+      g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
+      return;
+    }
+
+  /* Keep the contents out of the heap, in a sealed memfd */
+  display->saved_clipboard =
+    meta_anonymous_file_new (g_bytes_get_size (bytes),
+                             g_bytes_get_data (bytes, NULL));
+  if (!display->saved_clipboard)
+    {
+      g_warning ("Failed to store clipboard: %s", g_strerror (errno));
+      g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
+    }
+}
+
+static void
+clear_saved_clipboard (MetaDisplay *display)
+{
+  g_cancellable_cancel (display->saved_clipboard_cancellable);
+  g_clear_object (&display->saved_clipboard_cancellable);
+  g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
+  g_clear_pointer (&display->saved_clipboard, meta_anonymous_file_free);
 }
 
 static void
@@ -102,11 +144,11 @@ owner_changed_cb (MetaSelection       *selection,
       ssize_t transfer_size = -1;
 
       /* New selection source, find the best mimetype in order to
-       * keep a copy of it.
+       * keep a copy of it. A transfer still in progress for a previous
+       * owner is of no use anymore.
        */
       g_clear_object (&display->selection_source);
-      g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
-      g_clear_pointer (&display->saved_clipboard, g_bytes_unref);
+      clear_saved_clipboard (display);
 
       mimetypes = meta_selection_get_mimetypes (selection, selection_type);
 
@@ -134,21 +176,23 @@ owner_changed_cb (MetaSelection       *selection,
 
       display->saved_clipboard_mimetype = g_strdup (best);
       g_list_free_full (mimetypes, g_free);
+      display->saved_clipboard_cancellable = g_cancellable_new ();
       output = g_memory_output_stream_new_resizable ();
       meta_selection_transfer_async (selection,
                                      META_SELECTION_CLIPBOARD,
                                      display->saved_clipboard_mimetype,
-                                     transfer_size,
+                                     transfer_size + 1,
                                      output,
-                                     NULL,
+                                     display->saved_clipboard_cancellable,
                                      (GAsyncReadyCallback) transfer_cb,
                                      output);
     }
   else if (!new_owner && display->saved_clipboard)
     {
       /* Old owner is gone, time to take over */
-      new_owner = meta_selection_source_memory_new (display->saved_clipboard_mimetype,
-                                                    display->saved_clipboard);
+      new_owner =
+        meta_selection_source_memory_new_from_file (display->saved_clipboard_mimetype,
+                                                    g_steal_pointer (&display->saved_clipboard));
       g_set_object (&display->selection_source, new_owner);
       meta_selection_set_owner (selection, selection_type, new_owner);
       g_object_unref (new_owner);
@@ -171,8 +215,7 @@ meta_clipboard_manager_shutdown (MetaDisplay *display)
   MetaSelection *selection;
 
   g_clear_object (&display->selection_source);
-  g_clear_pointer (&display->saved_clipboard, g_bytes_unref);
-  g_clear_pointer (&display->saved_clipboard_mimetype, g_free);
+  clear_saved_clipboard (display);
   selection = meta_display_get_selection (display);
   g_signal_handlers_disconnect_by_func (selection, owner_changed_cb, display);
 }
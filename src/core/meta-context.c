@@ -24,6 +24,7 @@
 #include <sys/resource.h>
 
 #include "backends/meta-backend-private.h"
+#include "cogl/cogl.h"
 #include "compositor/meta-plugin-manager.h"
 #include "core/display-private.h"
 #include "core/meta-service-channel.h"
@@ -434,6 +435,8 @@ meta_context_setup (MetaContext  *context,
   MetaContextPrivate *priv = meta_context_get_instance_private (context);
   MetaCompositorType compositor_type;
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextSetup, "Meta::Context::setup()");
+
   g_warn_if_fail (priv->state == META_CONTEXT_STATE_CONFIGURED);
 
   if (!priv->plugin_name && priv->plugin_gtype == G_TYPE_NONE)
@@ -451,10 +454,13 @@ meta_context_setup (MetaContext  *context,
              priv->name, VERSION,
              compositor_type_to_description (compositor_type));
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextSetupPlugin,
+                           "Meta::Context::setup#plugin()");
   if (priv->plugin_name)
     meta_plugin_manager_load (priv->plugin_name);
   else
     meta_plugin_manager_set_plugin_type (priv->plugin_gtype);
+  COGL_TRACE_END (MetaContextSetupPlugin);
 
   init_introspection (context);
 
@@ -474,17 +480,30 @@ meta_context_start (MetaContext  *context,
 {
   MetaContextPrivate *priv = meta_context_get_instance_private (context);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextStart, "Meta::Context::start()");
+
   g_warn_if_fail (priv->state == META_CONTEXT_STATE_SETUP);
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextStartPrefs,
+                           "Meta::Context::start#prefs()");
   meta_prefs_init ();
+  COGL_TRACE_END (MetaContextStartPrefs);
 
 #ifdef HAVE_WAYLAND
   if (meta_context_get_compositor_type (context) ==
       META_COMPOSITOR_TYPE_WAYLAND)
-    priv->wayland_compositor = meta_wayland_compositor_new (context);
+    {
+      COGL_TRACE_BEGIN_SCOPED (MetaContextStartWayland,
+                               "Meta::Context::start#wayland()");
+      priv->wayland_compositor = meta_wayland_compositor_new (context);
+      COGL_TRACE_END (MetaContextStartWayland);
+    }
 #endif
 
+  COGL_TRACE_BEGIN_SCOPED (MetaContextStartDisplay,
+                           "Meta::Context::start#display()");
   priv->display = meta_display_new (context, error);
+  COGL_TRACE_END (MetaContextStartDisplay);
   if (!priv->display)
     {
       priv->state = META_CONTEXT_STATE_TERMINATED;
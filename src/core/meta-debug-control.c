@@ -20,9 +20,37 @@
 
 #include "core/meta-debug-control.h"
 
+#include <gio/gunixfdlist.h>
+#include <unistd.h>
+
+#include "clutter/clutter-mutter.h"
 #include "core/util-private.h"
 #include "meta/meta-backend.h"
+#include "meta/display.h"
+#include "meta/meta-backend.h"
 #include "meta/meta-context.h"
+#include "meta/window.h"
+
+#ifdef HAVE_PROFILER
+#include "core/meta-context-private.h"
+#endif
+
+#ifdef HAVE_NATIVE_BACKEND
+#include "backends/native/meta-backend-native.h"
+#include "backends/native/meta-kms-crtc.h"
+#include "backends/native/meta-kms-device.h"
+#include "backends/native/meta-kms.h"
+#endif
+
+#ifdef HAVE_X11_CLIENT
+#include "compositor/meta-compositor-x11.h"
+#endif
+
+#ifdef HAVE_WAYLAND
+#include "meta/meta-wayland-compositor.h"
+#include "wayland/meta-wayland-client-usage.h"
+#include "wayland/meta-wayland-protocol-stats.h"
+#endif
 
 enum
 {
@@ -55,9 +83,385 @@ G_DEFINE_TYPE_WITH_CODE (MetaDebugControl,
                          G_IMPLEMENT_INTERFACE (META_DBUS_TYPE_DEBUG_CONTROL,
                                                 meta_dbus_debug_control_iface_init))
 
+static GVariant *
+get_view_frame_timings (ClutterStageView *view)
+{
+  g_autofree ClutterFrameRecord *records = NULL;
+  GVariantBuilder builder;
+  int n_records;
+  int i;
+
+  records = g_new0 (ClutterFrameRecord, CLUTTER_STAGE_VIEW_N_FRAME_RECORDS);
+  n_records = clutter_stage_view_get_frame_records (view, records,
+                                                    CLUTTER_STAGE_VIEW_N_FRAME_RECORDS);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(xxxxxxxxbb)"));
+  for (i = 0; i < n_records; i++)
+    {
+      ClutterFrameRecord *record = &records[i];
+
+      g_variant_builder_add (&builder, "(xxxxxxxxbb)",
+                             record->frame_count,
+                             record->dispatch_time_us,
+                             record->layout_duration_us,
+                             record->paint_duration_us,
+                             record->pick_duration_us,
+                             record->gpu_duration_us,
+                             record->presentation_time_us,
+                             record->input_time_us,
+                             record->missed_vblank,
+                             record->is_scanout);
+    }
+
+  return g_variant_builder_end (&builder);
+}
+
+static gboolean
+handle_get_frame_timings (MetaDBusDebugControl  *dbus_debug_control,
+                          GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  GVariantBuilder builder;
+  GList *l;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa(xxxxxxxxbb)}"));
+  for (l = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage)); l; l = l->next)
+    {
+      ClutterStageView *view = l->data;
+      g_autofree char *name = NULL;
+
+      g_object_get (view, "name", &name, NULL);
+      g_variant_builder_add (&builder, "{s@a(xxxxxxxxbb)}",
+                             name ? name : "",
+                             get_view_frame_timings (view));
+    }
+
+  meta_dbus_debug_control_complete_get_frame_timings (dbus_debug_control,
+                                                      invocation,
+                                                      g_variant_builder_end (&builder));
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+#ifdef HAVE_NATIVE_BACKEND
+static GVariant *
+get_kms_crtc_statistics (MetaKmsCrtc *crtc)
+{
+  MetaKmsCrtcStats stats;
+  GVariantBuilder builder;
+  int i;
+
+  meta_kms_crtc_get_stats (crtc, &stats);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  for (i = 0; i < META_KMS_CRTC_N_LATENCIES; i++)
+    {
+      GVariant *histogram;
+
+      histogram = g_variant_new_fixed_array (G_VARIANT_TYPE_UINT64,
+                                             stats.latencies[i],
+                                             META_KMS_CRTC_STATS_N_BUCKETS,
+                                             sizeof (uint64_t));
+      g_variant_builder_add (&builder, "{sv}",
+                             meta_kms_crtc_latency_to_string (i),
+                             histogram);
+    }
+
+  g_variant_builder_add (&builder, "{sv}", "merged-updates",
+                         g_variant_new_uint64 (stats.n_merged_updates));
+  g_variant_builder_add (&builder, "{sv}", "discarded-updates",
+                         g_variant_new_uint64 (stats.n_discarded_updates));
+
+  return g_variant_builder_end (&builder);
+}
+#endif
+
+static gboolean
+handle_get_kms_statistics (MetaDBusDebugControl  *dbus_debug_control,
+                           GDBusMethodInvocation *invocation)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+#endif
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sa{sv}}"));
+
+#ifdef HAVE_NATIVE_BACKEND
+  if (META_IS_BACKEND_NATIVE (backend))
+    {
+      MetaKms *kms =
+        meta_backend_native_get_kms (META_BACKEND_NATIVE (backend));
+      GList *l;
+
+      for (l = meta_kms_get_devices (kms); l; l = l->next)
+        {
+          MetaKmsDevice *device = l->data;
+          GList *k;
+
+          for (k = meta_kms_device_get_crtcs (device); k; k = k->next)
+            {
+              MetaKmsCrtc *crtc = k->data;
+              g_autofree char *name = NULL;
+
+              name = g_strdup_printf ("%s:%u",
+                                      meta_kms_device_get_path (device),
+                                      meta_kms_crtc_get_id (crtc));
+              g_variant_builder_add (&builder, "{s@a{sv}}",
+                                     name,
+                                     get_kms_crtc_statistics (crtc));
+            }
+        }
+    }
+#endif
+
+  meta_dbus_debug_control_complete_get_kms_statistics (dbus_debug_control,
+                                                       invocation,
+                                                       g_variant_builder_end (&builder));
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_get_unredirect_state (MetaDBusDebugControl  *dbus_debug_control,
+                             GDBusMethodInvocation *invocation)
+{
+#ifdef HAVE_X11_CLIENT
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaDisplay *display = meta_context_get_display (debug_control->context);
+  MetaCompositor *compositor =
+    display ? meta_display_get_compositor (display) : NULL;
+#endif
+  const char *state = "";
+  const char *window_description = "";
+
+#ifdef HAVE_X11_CLIENT
+  if (compositor && META_IS_COMPOSITOR_X11 (compositor))
+    {
+      MetaCompositorX11 *compositor_x11 = META_COMPOSITOR_X11 (compositor);
+      MetaUnredirectState unredirect_state;
+      MetaWindow *window;
+
+      unredirect_state =
+        meta_compositor_x11_get_unredirect_state (compositor_x11, &window);
+      state = meta_unredirect_state_to_string (unredirect_state);
+      if (window)
+        window_description = meta_window_get_description (window);
+    }
+#endif
+
+  meta_dbus_debug_control_complete_get_unredirect_state (dbus_debug_control,
+                                                         invocation,
+                                                         state,
+                                                         window_description);
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+#ifdef HAVE_WAYLAND
+static GVariant *
+get_client_resources (MetaWaylandClientUsage *usage)
+{
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_builder_add (&builder, "{sv}", "pid",
+                         g_variant_new_int32 (usage->pid));
+  g_variant_builder_add (&builder, "{sv}", "surfaces",
+                         g_variant_new_uint32 (usage->n_surfaces));
+  g_variant_builder_add (&builder, "{sv}", "buffers",
+                         g_variant_new_uint32 (usage->n_buffers));
+  g_variant_builder_add (&builder, "{sv}", "pending-transactions",
+                         g_variant_new_uint32 (usage->n_pending_transactions));
+  g_variant_builder_add (&builder, "{sv}", "shm-bytes",
+                         g_variant_new_uint64 (usage->shm_bytes));
+  g_variant_builder_add (&builder, "{sv}", "texture-bytes",
+                         g_variant_new_uint64 (usage->texture_bytes));
+  g_variant_builder_add (&builder, "{sv}", "mipmaps-dropped",
+                         g_variant_new_boolean (usage->mipmaps_dropped));
+
+  return g_variant_builder_end (&builder);
+}
+#endif
+
+static gboolean
+handle_get_client_resources (MetaDBusDebugControl  *dbus_debug_control,
+                             GDBusMethodInvocation *invocation)
+{
+#ifdef HAVE_WAYLAND
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (debug_control->context);
+#endif
+  GVariantBuilder builder;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+
+#ifdef HAVE_WAYLAND
+  if (compositor)
+    {
+      g_autoptr (GArray) usages = NULL;
+      unsigned int i;
+
+      usages = meta_wayland_compositor_get_client_usage (compositor);
+      for (i = 0; i < usages->len; i++)
+        {
+          MetaWaylandClientUsage *usage =
+            &g_array_index (usages, MetaWaylandClientUsage, i);
+
+          g_variant_builder_add (&builder, "@a{sv}",
+                                 get_client_resources (usage));
+        }
+    }
+#endif
+
+  meta_dbus_debug_control_complete_get_client_resources (dbus_debug_control,
+                                                         invocation,
+                                                         g_variant_builder_end (&builder));
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_get_wayland_protocol_statistics (MetaDBusDebugControl  *dbus_debug_control,
+                                        GDBusMethodInvocation *invocation)
+{
+#ifdef HAVE_WAYLAND
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (debug_control->context);
+#endif
+  GVariant *statistics = NULL;
+
+#ifdef HAVE_WAYLAND
+  if (compositor)
+    statistics = meta_wayland_compositor_get_protocol_statistics (compositor);
+#endif
+
+  if (!statistics)
+    statistics = g_variant_new_array (G_VARIANT_TYPE ("(ia(stx))"), NULL, 0);
+
+  meta_dbus_debug_control_complete_get_wayland_protocol_statistics (dbus_debug_control,
+                                                                    invocation,
+                                                                    statistics);
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_get_actor_costs (MetaDBusDebugControl  *dbus_debug_control,
+                        GDBusMethodInvocation *invocation)
+{
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  g_autoptr (GArray) costs = NULL;
+  GVariantBuilder builder;
+  unsigned int i;
+
+  costs = clutter_stage_get_actor_costs (CLUTTER_STAGE (stage));
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(suxuxtt)"));
+  for (i = 0; i < costs->len; i++)
+    {
+      ClutterActorCost *cost = &g_array_index (costs, ClutterActorCost, i);
+
+      g_variant_builder_add (&builder, "(suxuxtt)",
+                             cost->name,
+                             cost->n_paints,
+                             cost->paint_time_us,
+                             cost->n_picks,
+                             cost->pick_time_us,
+                             cost->n_journal_entries,
+                             cost->n_draw_calls);
+    }
+
+  meta_dbus_debug_control_complete_get_actor_costs (dbus_debug_control,
+                                                    invocation,
+                                                    g_variant_builder_end (&builder));
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
+static gboolean
+handle_dump_flight_recorder (MetaDBusDebugControl  *dbus_debug_control,
+                             GDBusMethodInvocation *invocation,
+                             GUnixFDList           *fd_list,
+                             GVariant              *fd_variant)
+{
+#ifdef HAVE_PROFILER
+  MetaDebugControl *debug_control = META_DEBUG_CONTROL (dbus_debug_control);
+  MetaProfiler *profiler = meta_context_get_profiler (debug_control->context);
+  g_autoptr (GError) error = NULL;
+  int fd;
+
+  if (!profiler)
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Profiler not available");
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  if (!fd_list)
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "No file descriptor passed");
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  fd = g_unix_fd_list_get (fd_list, g_variant_get_handle (fd_variant), &error);
+  if (fd == -1)
+    {
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_INVALID_ARGS,
+                                             "Invalid file descriptor: %s",
+                                             error->message);
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  if (!meta_profiler_dump_flight_recorder (profiler, fd, &error))
+    {
+      close (fd);
+      g_dbus_method_invocation_return_error (invocation,
+                                             G_DBUS_ERROR,
+                                             G_DBUS_ERROR_FAILED,
+                                             "Failed to dump flight recorder: %s",
+                                             error->message);
+      return G_DBUS_METHOD_INVOCATION_HANDLED;
+    }
+
+  meta_dbus_debug_control_complete_dump_flight_recorder (dbus_debug_control,
+                                                         invocation,
+                                                         NULL);
+#else
+  g_dbus_method_invocation_return_error (invocation,
+                                         G_DBUS_ERROR,
+                                         G_DBUS_ERROR_NOT_SUPPORTED,
+                                         "Built without profiler support");
+#endif
+
+  return G_DBUS_METHOD_INVOCATION_HANDLED;
+}
+
 static void
 meta_dbus_debug_control_iface_init (MetaDBusDebugControlIface *iface)
 {
+  iface->handle_get_frame_timings = handle_get_frame_timings;
+  iface->handle_get_kms_statistics = handle_get_kms_statistics;
+  iface->handle_get_unredirect_state = handle_get_unredirect_state;
+  iface->handle_get_client_resources = handle_get_client_resources;
+  iface->handle_get_wayland_protocol_statistics =
+    handle_get_wayland_protocol_statistics;
+  iface->handle_get_actor_costs = handle_get_actor_costs;
+  iface->handle_dump_flight_recorder = handle_dump_flight_recorder;
 }
 
 static void
@@ -122,6 +526,79 @@ on_experimental_hdr_changed (MetaMonitorManager *monitor_manager,
                                           g_strcmp0 (experimental_hdr, "on") == 0);
 }
 
+static void
+on_client_texture_limit_changed (MetaDebugControl *debug_control,
+                                 GParamSpec       *pspec)
+{
+#ifdef HAVE_WAYLAND
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (debug_control->context);
+
+  if (!compositor)
+    return;
+
+  meta_wayland_compositor_set_client_texture_limit (compositor,
+                                                    meta_dbus_debug_control_get_client_texture_limit (dbus_debug_control));
+#endif
+}
+
+static void
+on_enable_wayland_protocol_profiling_changed (MetaDebugControl *debug_control,
+                                              GParamSpec       *pspec)
+{
+#ifdef HAVE_WAYLAND
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (debug_control->context);
+
+  if (!compositor)
+    return;
+
+  meta_wayland_compositor_set_protocol_profiling (compositor,
+                                                  meta_dbus_debug_control_get_enable_wayland_protocol_profiling (dbus_debug_control));
+#endif
+}
+
+static void
+on_enable_actor_costs_changed (MetaDebugControl *debug_control,
+                               GParamSpec       *pspec)
+{
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+  MetaBackend *backend = meta_context_get_backend (debug_control->context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+
+  if (meta_dbus_debug_control_get_enable_actor_costs (dbus_debug_control))
+    {
+      clutter_add_debug_flags (0, CLUTTER_DEBUG_ACTOR_COSTS, 0);
+    }
+  else
+    {
+      clutter_remove_debug_flags (0, CLUTTER_DEBUG_ACTOR_COSTS, 0);
+      clutter_stage_reset_actor_costs (CLUTTER_STAGE (stage));
+    }
+}
+
+static void
+on_enable_flight_recorder_changed (MetaDebugControl *debug_control,
+                                   GParamSpec       *pspec)
+{
+#ifdef HAVE_PROFILER
+  MetaDBusDebugControl *dbus_debug_control =
+    META_DBUS_DEBUG_CONTROL (debug_control);
+  MetaProfiler *profiler = meta_context_get_profiler (debug_control->context);
+
+  if (!profiler)
+    return;
+
+  meta_profiler_set_flight_recorder_enabled (profiler,
+                                             meta_dbus_debug_control_get_enable_flight_recorder (dbus_debug_control));
+#endif
+}
+
 static void
 on_context_started (MetaContext      *context,
                     MetaDebugControl *debug_control)
@@ -147,6 +624,29 @@ meta_debug_control_constructed (GObject *object)
                            G_CALLBACK (on_enable_hdr_changed), debug_control,
                            G_CONNECT_DEFAULT);
 
+  g_signal_connect_object (debug_control, "notify::client-texture-limit",
+                           G_CALLBACK (on_client_texture_limit_changed),
+                           debug_control,
+                           G_CONNECT_DEFAULT);
+
+  g_signal_connect_object (debug_control,
+                           "notify::enable-wayland-protocol-profiling",
+                           G_CALLBACK (on_enable_wayland_protocol_profiling_changed),
+                           debug_control,
+                           G_CONNECT_DEFAULT);
+
+  g_signal_connect_object (debug_control,
+                           "notify::enable-actor-costs",
+                           G_CALLBACK (on_enable_actor_costs_changed),
+                           debug_control,
+                           G_CONNECT_DEFAULT);
+
+  g_signal_connect_object (debug_control,
+                           "notify::enable-flight-recorder",
+                           G_CALLBACK (on_enable_flight_recorder_changed),
+                           debug_control,
+                           G_CONNECT_DEFAULT);
+
   G_OBJECT_CLASS (meta_debug_control_parent_class)->constructed (object);
 }
 
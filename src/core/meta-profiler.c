@@ -43,6 +43,9 @@ struct _MetaProfiler
   gboolean persistent;
   gboolean running;
 
+  gboolean flight_recorder_enabled;
+  gboolean flight_recording;
+
   GMutex mutex;
   GList *threads;
 };
@@ -76,6 +79,77 @@ thread_info_new (GMainContext *main_context,
   return thread_info;
 }
 
+static void
+enable_tracing_on_threads (MetaProfiler *profiler)
+{
+  GMainContext *main_context = g_main_context_default ();
+  const char *group_name;
+  GList *l;
+
+  /* Translators: this string will appear in Sysprof */
+  group_name = _("Compositor");
+
+  cogl_set_tracing_enabled_on_thread (main_context, group_name);
+
+  g_mutex_lock (&profiler->mutex);
+  for (l = profiler->threads; l; l = l->next)
+    {
+      ThreadInfo *thread_info = l->data;
+      g_autofree char *thread_group_name = NULL;
+
+      thread_group_name = g_strdup_printf ("%s (%s)",
+                                           group_name,
+                                           thread_info->name);
+      cogl_set_tracing_enabled_on_thread (thread_info->main_context,
+                                          thread_group_name);
+    }
+  g_mutex_unlock (&profiler->mutex);
+}
+
+static void
+disable_tracing_on_threads (MetaProfiler *profiler)
+{
+  GList *l;
+
+  cogl_set_tracing_disabled_on_thread (g_main_context_default ());
+
+  g_mutex_lock (&profiler->mutex);
+  for (l = profiler->threads; l; l = l->next)
+    {
+      ThreadInfo *thread_info = l->data;
+
+      cogl_set_tracing_disabled_on_thread (thread_info->main_context);
+    }
+  g_mutex_unlock (&profiler->mutex);
+}
+
+static void
+start_flight_recorder (MetaProfiler *profiler)
+{
+  g_autoptr (GError) error = NULL;
+
+  if (!cogl_start_flight_recorder (&error))
+    {
+      g_warning ("Failed to start flight recorder: %s", error->message);
+      return;
+    }
+
+  enable_tracing_on_threads (profiler);
+  profiler->flight_recording = TRUE;
+
+  g_debug ("Flight recorder running");
+}
+
+static void
+stop_flight_recorder (MetaProfiler *profiler)
+{
+  disable_tracing_on_threads (profiler);
+  cogl_stop_tracing ();
+  profiler->flight_recording = FALSE;
+
+  g_debug ("Stopping flight recorder");
+}
+
 static gboolean
 handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
               GDBusMethodInvocation    *invocation,
@@ -84,12 +158,9 @@ handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
               GVariant                 *fd_variant)
 {
   MetaProfiler *profiler = META_PROFILER (dbus_profiler);
-  GMainContext *main_context = g_main_context_default ();
   g_autoptr (GError) error = NULL;
-  const char *group_name;
   int position;
   int fd = -1;
-  GList *l;
 
   if (profiler->running)
     {
@@ -105,13 +176,16 @@ handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
   if (fd_list)
     fd = g_unix_fd_list_get (fd_list, position, NULL);
 
-  /* Translators: this string will appear in Sysprof */
-  group_name = _("Compositor");
+  if (profiler->flight_recording)
+    stop_flight_recorder (profiler);
 
   if (fd != -1)
     {
       if (!cogl_start_tracing_with_fd (fd, &error))
         {
+          if (profiler->flight_recorder_enabled)
+            start_flight_recorder (profiler);
+
           g_dbus_method_invocation_return_error (invocation,
                                                  G_DBUS_ERROR,
                                                  G_DBUS_ERROR_FAILED,
@@ -124,6 +198,9 @@ handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
     {
       if (!cogl_start_tracing_with_path ("mutter-profile.syscap", &error))
         {
+          if (profiler->flight_recorder_enabled)
+            start_flight_recorder (profiler);
+
           g_dbus_method_invocation_return_error (invocation,
                                                  G_DBUS_ERROR,
                                                  G_DBUS_ERROR_FAILED,
@@ -133,21 +210,7 @@ handle_start (MetaDBusSysprof3Profiler *dbus_profiler,
         }
     }
 
-  cogl_set_tracing_enabled_on_thread (main_context, group_name);
-
-  g_mutex_lock (&profiler->mutex);
-  for (l = profiler->threads; l; l = l->next)
-    {
-      ThreadInfo *thread_info = l->data;
-      g_autofree char *thread_group_name = NULL;
-
-      thread_group_name = g_strdup_printf ("%s (%s)",
-                                           group_name,
-                                           thread_info->name);
-      cogl_set_tracing_enabled_on_thread (thread_info->main_context,
-                                          thread_group_name);
-    }
-  g_mutex_unlock (&profiler->mutex);
+  enable_tracing_on_threads (profiler);
 
   profiler->running = TRUE;
 
@@ -162,7 +225,6 @@ handle_stop (MetaDBusSysprof3Profiler *dbus_profiler,
              GDBusMethodInvocation    *invocation)
 {
   MetaProfiler *profiler = META_PROFILER (dbus_profiler);
-  GList *l;
 
   if (profiler->persistent)
     {
@@ -182,16 +244,7 @@ handle_stop (MetaDBusSysprof3Profiler *dbus_profiler,
       return TRUE;
     }
 
-  cogl_set_tracing_disabled_on_thread (g_main_context_default ());
-
-  g_mutex_lock (&profiler->mutex);
-  for (l = profiler->threads; l; l = l->next)
-    {
-      ThreadInfo *thread_info = l->data;
-
-      cogl_set_tracing_disabled_on_thread (thread_info->main_context);
-    }
-  g_mutex_unlock (&profiler->mutex);
+  disable_tracing_on_threads (profiler);
 
   cogl_stop_tracing ();
 
@@ -199,6 +252,9 @@ handle_stop (MetaDBusSysprof3Profiler *dbus_profiler,
 
   g_debug ("Stopping profiler");
 
+  if (profiler->flight_recorder_enabled)
+    start_flight_recorder (profiler);
+
   meta_dbus_sysprof3_profiler_complete_stop (dbus_profiler, invocation);
   return TRUE;
 }
@@ -249,7 +305,7 @@ meta_profiler_finalize (GObject *object)
 {
   MetaProfiler *self = (MetaProfiler *)object;
 
-  if (self->persistent)
+  if (self->persistent || self->flight_recording)
     cogl_stop_tracing ();
 
   g_cancellable_cancel (self->cancellable);
@@ -323,7 +379,7 @@ meta_profiler_register_thread (MetaProfiler *profiler,
   g_warn_if_fail (!g_list_find (profiler->threads, main_context));
   profiler->threads = g_list_prepend (profiler->threads,
                                       thread_info_new (main_context, name));
-  if (profiler->running)
+  if (profiler->running || profiler->flight_recording)
     cogl_set_tracing_enabled_on_thread (main_context, name);
   g_mutex_unlock (&profiler->mutex);
 }
@@ -347,8 +403,46 @@ meta_profiler_unregister_thread (MetaProfiler *profiler,
         }
     }
 
-  if (profiler->running)
+  if (profiler->running || profiler->flight_recording)
     cogl_set_tracing_disabled_on_thread (main_context);
 
   g_mutex_unlock (&profiler->mutex);
 }
+
+/*
+ * The flight recorder keeps the most recent trace events of each thread in
+ * memory while no sysprof session is running, so that what led up to a
+ * hitch can be captured after the fact with meta_profiler_dump_flight_recorder().
+ */
+void
+meta_profiler_set_flight_recorder_enabled (MetaProfiler *profiler,
+                                           gboolean      enabled)
+{
+  if (profiler->flight_recorder_enabled == enabled)
+    return;
+
+  profiler->flight_recorder_enabled = enabled;
+
+  if (profiler->running)
+    return;
+
+  if (enabled)
+    start_flight_recorder (profiler);
+  else if (profiler->flight_recording)
+    stop_flight_recorder (profiler);
+}
+
+gboolean
+meta_profiler_dump_flight_recorder (MetaProfiler  *profiler,
+                                    int            fd,
+                                    GError       **error)
+{
+  if (!profiler->flight_recording)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_INITIALIZED,
+                   "Flight recorder not running");
+      return FALSE;
+    }
+
+  return cogl_dump_flight_recorder_to_fd (fd, error);
+}
@@ -40,4 +40,11 @@ void meta_profiler_register_thread (MetaProfiler *profiler,
 void meta_profiler_unregister_thread (MetaProfiler *profiler,
                                       GMainContext *main_context);
 
+void meta_profiler_set_flight_recorder_enabled (MetaProfiler *profiler,
+                                                gboolean      enabled);
+
+gboolean meta_profiler_dump_flight_recorder (MetaProfiler  *profiler,
+                                             int            fd,
+                                             GError       **error);
+
 G_END_DECLS
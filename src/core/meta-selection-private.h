@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "core/meta-anonymous-file.h"
 #include "meta/meta-selection.h"
 
 MetaSelectionSource *
@@ -27,3 +28,6 @@ MetaSelectionSource *
                                     MetaSelectionType  selection_type);
 
 MetaDisplay * meta_selection_get_display (MetaSelection *selection);
+
+MetaSelectionSource * meta_selection_source_memory_new_from_file (const char        *mimetype,
+                                                                  MetaAnonymousFile *file);
@@ -21,17 +21,80 @@
 
 #include "meta/meta-selection-source-memory.h"
 
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "core/meta-selection-private.h"
+
 struct _MetaSelectionSourceMemory
 {
   MetaSelectionSource parent_instance;
   char *mimetype;
   GBytes *content;
+  MetaAnonymousFile *file;
 };
 
+typedef struct
+{
+  void *data;
+  size_t size;
+} FileMapping;
+
 G_DEFINE_TYPE (MetaSelectionSourceMemory,
                meta_selection_source_memory,
                META_TYPE_SELECTION_SOURCE)
 
+static void
+file_mapping_free (FileMapping *mapping)
+{
+  munmap (mapping->data, mapping->size);
+  g_free (mapping);
+}
+
+static GBytes *
+map_file_contents (MetaAnonymousFile  *file,
+                   GError            **error)
+{
+  FileMapping *mapping;
+  size_t size;
+  void *data;
+  int fd;
+
+  size = meta_anonymous_file_size (file);
+  if (size == 0)
+    return g_bytes_new (NULL, 0);
+
+  fd = meta_anonymous_file_open_fd (file, META_ANONYMOUS_FILE_MAPMODE_PRIVATE);
+  if (fd == -1)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to open selection contents: %s", g_strerror (errsv));
+      return NULL;
+    }
+
+  data = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  meta_anonymous_file_close_fd (fd);
+
+  if (data == MAP_FAILED)
+    {
+      int errsv = errno;
+
+      g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errsv),
+                   "Failed to map selection contents: %s", g_strerror (errsv));
+      return NULL;
+    }
+
+  mapping = g_new0 (FileMapping, 1);
+  mapping->data = data;
+  mapping->size = size;
+
+  return g_bytes_new_with_free_func (data, size,
+                                     (GDestroyNotify) file_mapping_free,
+                                     mapping);
+}
+
 static void
 meta_selection_source_memory_read_async (MetaSelectionSource *source,
                                          const char          *mimetype,
@@ -55,7 +118,26 @@ meta_selection_source_memory_read_async (MetaSelectionSource *source,
   task = g_task_new (source, cancellable, callback, user_data);
   g_task_set_source_tag (task, meta_selection_source_memory_read_async);
 
-  stream = g_memory_input_stream_new_from_bytes (source_mem->content);
+  if (source_mem->file)
+    {
+      g_autoptr (GBytes) content = NULL;
+      GError *error = NULL;
+
+      /* Map the contents only for the duration of the transfer */
+      content = map_file_contents (source_mem->file, &error);
+      if (!content)
+        {
+          g_task_return_error (task, error);
+          return;
+        }
+
+      stream = g_memory_input_stream_new_from_bytes (content);
+    }
+  else
+    {
+      stream = g_memory_input_stream_new_from_bytes (source_mem->content);
+    }
+
   g_task_return_pointer (task, stream, g_object_unref);
 }
 
@@ -86,6 +168,7 @@ meta_selection_source_memory_finalize (GObject *object)
   MetaSelectionSourceMemory *source_mem = META_SELECTION_SOURCE_MEMORY (object);
 
   g_clear_pointer (&source_mem->content, g_bytes_unref);
+  g_clear_pointer (&source_mem->file, meta_anonymous_file_free);
   g_free (source_mem->mimetype);
 
   G_OBJECT_CLASS (meta_selection_source_memory_parent_class)->finalize (object);
@@ -124,3 +207,29 @@ meta_selection_source_memory_new (const char  *mimetype,
 
   return META_SELECTION_SOURCE (source);
 }
+
+/**
+ * meta_selection_source_memory_new_from_file: (skip)
+ * @mimetype: Mimetype of the contents
+ * @file: (transfer full): Anonymous file holding the contents
+ *
+ * Creates a selection source for contents held in an anonymous file, which
+ * is only mapped while the contents are being transferred.
+ *
+ * Returns: The new selection source
+ */
+MetaSelectionSource *
+meta_selection_source_memory_new_from_file (const char        *mimetype,
+                                            MetaAnonymousFile *file)
+{
+  MetaSelectionSourceMemory *source;
+
+  g_return_val_if_fail (mimetype != NULL, NULL);
+  g_return_val_if_fail (file != NULL, NULL);
+
+  source = g_object_new (META_TYPE_SELECTION_SOURCE_MEMORY, NULL);
+  source->mimetype = g_strdup (mimetype);
+  source->file = file;
+
+  return META_SELECTION_SOURCE (source);
+}
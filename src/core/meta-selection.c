@@ -19,9 +19,19 @@
 
 #include "config.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+#include <glib-unix.h>
+#include <sys/stat.h>
+
 #include "core/meta-selection-private.h"
 #include "meta/meta-selection.h"
 
+/* Maximum amount of data moved or buffered at once during transfers */
+#define TRANSFER_CHUNK_SIZE (64 * 1024)
+
 typedef struct TransferRequest TransferRequest;
 
 struct _MetaSelection
@@ -41,6 +51,8 @@ struct TransferRequest
   GCancellable *cancellable;
   GCancellable *external_cancellable;
   gulong cancellable_signal_handler;
+  GSource *splice_source;
+  gboolean has_spliced_data;
 };
 
 enum
@@ -258,6 +270,12 @@ transfer_request_free (TransferRequest *request)
       g_clear_pointer (&request->timeout_source, g_source_unref);
     }
 
+  if (request->splice_source)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+    }
+
   g_clear_object (&request->cancellable);
   g_clear_object (&request->istream);
   g_clear_object (&request->ostream);
@@ -283,6 +301,162 @@ splice_cb (GOutputStream *stream,
   g_object_unref (task);
 }
 
+static void
+splice_streams_async (GTask           *task,
+                      TransferRequest *request)
+{
+  g_output_stream_splice_async (request->ostream,
+                                request->istream,
+                                G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+                                G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                G_PRIORITY_DEFAULT,
+                                g_task_get_cancellable (task),
+                                (GAsyncReadyCallback) splice_cb,
+                                task);
+}
+
+static gboolean
+is_pipe_fd (int fd)
+{
+  struct stat stat_buf;
+
+  return fstat (fd, &stat_buf) == 0 && S_ISFIFO (stat_buf.st_mode);
+}
+
+static gboolean
+can_splice_fds (TransferRequest *request)
+{
+  return (G_IS_UNIX_INPUT_STREAM (request->istream) &&
+          G_IS_UNIX_OUTPUT_STREAM (request->ostream) &&
+          is_pipe_fd (g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (request->istream))) &&
+          is_pipe_fd (g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (request->ostream))));
+}
+
+static void wait_for_splice_fd (GTask        *task,
+                                int           fd,
+                                GIOCondition  condition);
+
+static void
+finish_splice_fds (GTask  *task,
+                   GError *error)
+{
+  TransferRequest *request = g_task_get_task_data (task);
+
+  if (request->splice_source)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+    }
+
+  g_input_stream_close (request->istream, NULL, NULL);
+  g_output_stream_close (request->ostream, NULL, NULL);
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+static gboolean
+splice_fd_cb (int           fd,
+              GIOCondition  condition,
+              gpointer      user_data)
+{
+  GTask *task = user_data;
+  TransferRequest *request = g_task_get_task_data (task);
+  GError *error = NULL;
+  int in_fd, out_fd;
+  ssize_t ret;
+
+  if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task),
+                                            &error))
+    {
+      finish_splice_fds (task, error);
+      return G_SOURCE_REMOVE;
+    }
+
+  in_fd = g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (request->istream));
+  out_fd = g_unix_output_stream_get_fd (G_UNIX_OUTPUT_STREAM (request->ostream));
+
+  do
+    ret = splice (in_fd, NULL, out_fd, NULL, TRANSFER_CHUNK_SIZE,
+                  SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  while (ret < 0 && errno == EINTR);
+
+  if (ret > 0)
+    {
+      request->has_spliced_data = TRUE;
+
+      if (fd == in_fd)
+        return G_SOURCE_CONTINUE;
+
+      wait_for_splice_fd (task, in_fd, G_IO_IN | G_IO_HUP | G_IO_ERR);
+      return G_SOURCE_REMOVE;
+    }
+  else if (ret == 0)
+    {
+      finish_splice_fds (task, NULL);
+      return G_SOURCE_REMOVE;
+    }
+  else if (errno == EAGAIN)
+    {
+      /* When woken up by the source, the target pipe is full, and the
+       * other way around. */
+      if (fd == in_fd)
+        wait_for_splice_fd (task, out_fd, G_IO_OUT | G_IO_ERR);
+      else
+        wait_for_splice_fd (task, in_fd, G_IO_IN | G_IO_HUP | G_IO_ERR);
+      return G_SOURCE_REMOVE;
+    }
+  else if (errno == EINVAL && !request->has_spliced_data)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+      splice_streams_async (task, request);
+      return G_SOURCE_REMOVE;
+    }
+  else
+    {
+      int errsv = errno;
+
+      error = g_error_new (G_IO_ERROR, g_io_error_from_errno (errsv),
+                           "Failed to splice selection data: %s",
+                           g_strerror (errsv));
+      finish_splice_fds (task, error);
+      return G_SOURCE_REMOVE;
+    }
+}
+
+static void
+wait_for_splice_fd (GTask        *task,
+                    int           fd,
+                    GIOCondition  condition)
+{
+  TransferRequest *request = g_task_get_task_data (task);
+  GSource *cancellable_source;
+
+  if (request->splice_source)
+    {
+      g_source_destroy (request->splice_source);
+      g_clear_pointer (&request->splice_source, g_source_unref);
+    }
+
+  request->splice_source = g_unix_fd_source_new (fd, condition);
+  g_source_set_name (request->splice_source, "[mutter] Selection splice");
+  g_source_set_callback (request->splice_source,
+                         G_SOURCE_FUNC (splice_fd_cb),
+                         task, NULL);
+
+  /* Be dispatched on cancellation too, e.g. when the transfer times out */
+  cancellable_source = g_cancellable_source_new (g_task_get_cancellable (task));
+  g_source_set_dummy_callback (cancellable_source);
+  g_source_add_child_source (request->splice_source, cancellable_source);
+  g_source_unref (cancellable_source);
+
+  g_source_attach (request->splice_source, NULL);
+}
+
 static void
 write_cb (GOutputStream *stream,
           GAsyncResult  *result,
@@ -362,7 +536,8 @@ read_selection_source_async (GTask           *task,
                              TransferRequest *request)
 {
   g_input_stream_read_bytes_async (request->istream,
-                                   (gsize) request->len,
+                                   MIN ((gsize) request->len,
+                                        TRANSFER_CHUNK_SIZE),
                                    G_PRIORITY_DEFAULT,
                                    g_task_get_cancellable (task),
                                    (GAsyncReadyCallback) read_cb,
@@ -391,14 +566,19 @@ source_read_cb (MetaSelectionSource *source,
 
   if (request->len < 0)
     {
-      g_output_stream_splice_async (request->ostream,
-                                    request->istream,
-                                    G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
-                                    G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
-                                    G_PRIORITY_DEFAULT,
-                                    g_task_get_cancellable (task),
-                                    (GAsyncReadyCallback) splice_cb,
-                                    task);
+      /* Move data directly between pipes, e.g. from one Wayland client to
+       * another, instead of copying it through userspace buffers. */
+      if (can_splice_fds (request))
+        {
+          int in_fd;
+
+          in_fd = g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (request->istream));
+          wait_for_splice_fd (task, in_fd, G_IO_IN | G_IO_HUP | G_IO_ERR);
+        }
+      else
+        {
+          splice_streams_async (task, request);
+        }
     }
   else
     {
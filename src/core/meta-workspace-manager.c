@@ -198,7 +198,7 @@ meta_workspace_manager_reload_work_areas (MetaWorkspaceManager *workspace_manage
     {
       MetaWorkspace *workspace = l->data;
 
-      meta_workspace_invalidate_work_area (workspace);
+      meta_workspace_reload_work_area (workspace);
     }
 }
 
@@ -429,99 +429,89 @@ avoid_being_obscured_as_second_modal_dialog (MetaWindow *window,
 }
 
 static gboolean
-rectangle_overlaps_some_window (MtkRectangle *rect,
-                                GList        *windows)
+window_type_obscures_placement (MetaWindowType type)
 {
-  GList *tmp;
-  MtkRectangle dest;
-
-  tmp = windows;
-  while (tmp != NULL)
+  switch (type)
     {
-      MetaWindow *other = tmp->data;
-      MtkRectangle other_rect;
-
-      switch (other->type)
-        {
-        case META_WINDOW_DOCK:
-        case META_WINDOW_SPLASHSCREEN:
-        case META_WINDOW_DESKTOP:
-        case META_WINDOW_DIALOG:
-        case META_WINDOW_MODAL_DIALOG:
-	/* override redirect window types: */
-	case META_WINDOW_DROPDOWN_MENU:
-	case META_WINDOW_POPUP_MENU:
-	case META_WINDOW_TOOLTIP:
-	case META_WINDOW_NOTIFICATION:
-	case META_WINDOW_COMBO:
-	case META_WINDOW_DND:
-	case META_WINDOW_OVERRIDE_OTHER:
-          break;
-
-        case META_WINDOW_NORMAL:
-        case META_WINDOW_UTILITY:
-        case META_WINDOW_TOOLBAR:
-        case META_WINDOW_MENU:
-          meta_window_get_frame_rect (other, &other_rect);
-
-          if (mtk_rectangle_intersect (rect, &other_rect, &dest))
-            return TRUE;
-          break;
-        }
+    case META_WINDOW_DOCK:
+    case META_WINDOW_SPLASHSCREEN:
+    case META_WINDOW_DESKTOP:
+    case META_WINDOW_DIALOG:
+    case META_WINDOW_MODAL_DIALOG:
+    /* override redirect window types: */
+    case META_WINDOW_DROPDOWN_MENU:
+    case META_WINDOW_POPUP_MENU:
+    case META_WINDOW_TOOLTIP:
+    case META_WINDOW_NOTIFICATION:
+    case META_WINDOW_COMBO:
+    case META_WINDOW_DND:
+    case META_WINDOW_OVERRIDE_OTHER:
+      return FALSE;
 
-      tmp = tmp->next;
+    case META_WINDOW_NORMAL:
+    case META_WINDOW_UTILITY:
+    case META_WINDOW_TOOLBAR:
+    case META_WINDOW_MENU:
+      return TRUE;
     }
 
   return FALSE;
 }
 
-static gint
-leftmost_cmp (gconstpointer a, gconstpointer b)
+static gboolean
+rectangle_overlaps_some_rect (MtkRectangle *rect,
+                              GArray       *obstacles)
 {
-  MetaWindow *aw = (gpointer) a;
-  MetaWindow *bw = (gpointer) b;
-  MtkRectangle a_frame;
-  MtkRectangle b_frame;
-  int ax, bx;
+  MtkRectangle dest;
+  unsigned int i;
 
-  meta_window_get_frame_rect (aw, &a_frame);
-  meta_window_get_frame_rect (bw, &b_frame);
-  ax = a_frame.x;
-  bx = b_frame.x;
+  for (i = 0; i < obstacles->len; i++)
+    {
+      MtkRectangle *obstacle = &g_array_index (obstacles, MtkRectangle, i);
 
-  if (ax < bx)
-    return -1;
-  else if (ax > bx)
-    return 1;
-  else
-    return 0;
+      if (mtk_rectangle_intersect (rect, obstacle, &dest))
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
-static gint
-rightmost_cmp (gconstpointer a,
-               gconstpointer b)
+/* Rectangles below which to try, sorted topmost first, then leftmost (or
+ * rightmost for RTL) first.
+ */
+static int
+below_cmp (gconstpointer a,
+           gconstpointer b,
+           gpointer      user_data)
 {
-  return -leftmost_cmp (a, b);
+  const MtkRectangle *a_rect = a;
+  const MtkRectangle *b_rect = b;
+  gboolean ltr = GPOINTER_TO_INT (user_data);
+
+  if (a_rect->y != b_rect->y)
+    return a_rect->y < b_rect->y ? -1 : 1;
+  else if (a_rect->x != b_rect->x)
+    return (a_rect->x < b_rect->x) == ltr ? -1 : 1;
+  else
+    return 0;
 }
 
-static gint
-topmost_cmp (gconstpointer a, gconstpointer b)
+/* Rectangles next to which to try, sorted leftmost (or rightmost for RTL)
+ * first, then topmost first.
+ */
+static int
+end_cmp (gconstpointer a,
+         gconstpointer b,
+         gpointer      user_data)
 {
-  MetaWindow *aw = (gpointer) a;
-  MetaWindow *bw = (gpointer) b;
-  MtkRectangle a_frame;
-  MtkRectangle b_frame;
-  int ay, by;
-
-  meta_window_get_frame_rect (aw, &a_frame);
-  meta_window_get_frame_rect (bw, &b_frame);
-  ay = a_frame.y;
-  by = b_frame.y;
-
-  if (ay < by)
-    return -1;
-  else if (ay > by)
-    return 1;
+  const MtkRectangle *a_rect = a;
+  const MtkRectangle *b_rect = b;
+  gboolean ltr = GPOINTER_TO_INT (user_data);
+
+  if (a_rect->x != b_rect->x)
+    return (a_rect->x < b_rect->x) == ltr ? -1 : 1;
+  else if (a_rect->y != b_rect->y)
+    return a_rect->y < b_rect->y ? -1 : 1;
   else
     return 0;
 }
@@ -572,25 +562,30 @@ find_first_fit (MetaWindow         *window,
    * of each existing window, aligned with the left/top of the
    * existing window in each of those cases.
    */
-  int retval;
-  GList *below_sorted;
-  GList *end_sorted;
-  GList *tmp;
+  g_autoptr (GArray) candidates = NULL;
+  g_autoptr (GArray) obstacles = NULL;
+  GList *l;
   MtkRectangle rect;
   MtkRectangle work_area;
   gboolean ltr = meta_get_locale_direction () == META_LOCALE_DIRECTION_LTR;
+  unsigned int i;
 
-  retval = FALSE;
+  /* Look up the frame rects once, rather than for every comparison and
+   * every candidate position.
+   */
+  candidates = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+  obstacles = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *w = l->data;
+      MtkRectangle frame_rect;
 
-  /* Below each window */
-  below_sorted = g_list_copy (windows);
-  below_sorted = g_list_sort (below_sorted, ltr ? leftmost_cmp : rightmost_cmp);
-  below_sorted = g_list_sort (below_sorted, topmost_cmp);
+      meta_window_get_frame_rect (w, &frame_rect);
+      g_array_append_val (candidates, frame_rect);
 
-  /* To the right of each window */
-  end_sorted = g_list_copy (windows);
-  end_sorted = g_list_sort (end_sorted, topmost_cmp);
-  end_sorted = g_list_sort (end_sorted, ltr ? leftmost_cmp : rightmost_cmp);
+      if (window_type_obscures_placement (w->type))
+        g_array_append_val (obstacles, frame_rect);
+    }
 
   meta_window_get_frame_rect (window, &rect);
 
@@ -613,75 +608,56 @@ find_first_fit (MetaWindow         *window,
   center_tile_rect_in_area (&rect, &work_area);
 
   if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-      !rectangle_overlaps_some_window (&rect, windows))
+      !rectangle_overlaps_some_rect (&rect, obstacles))
     {
       *new_x = rect.x;
       *new_y = rect.y;
 
-      retval = TRUE;
-
-      goto out;
+      return TRUE;
     }
 
   /* try below each window */
-  tmp = below_sorted;
-  while (tmp != NULL)
+  g_array_sort_with_data (candidates, below_cmp, GINT_TO_POINTER (ltr));
+  for (i = 0; i < candidates->len; i++)
     {
-      MetaWindow *w = tmp->data;
-      MtkRectangle frame_rect;
+      MtkRectangle *frame_rect = &g_array_index (candidates, MtkRectangle, i);
 
-      meta_window_get_frame_rect (w, &frame_rect);
-
-      rect.x = frame_rect.x;
-      rect.y = frame_rect.y + frame_rect.height;
+      rect.x = frame_rect->x;
+      rect.y = frame_rect->y + frame_rect->height;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, below_sorted))
+          !rectangle_overlaps_some_rect (&rect, obstacles))
         {
           *new_x = rect.x;
           *new_y = rect.y;
 
-          retval = TRUE;
-
-          goto out;
+          return TRUE;
         }
-
-      tmp = tmp->next;
     }
 
   /* try to the right (or left in RTL environment) of each window */
-  tmp = end_sorted;
-  while (tmp != NULL)
+  g_array_sort_with_data (candidates, end_cmp, GINT_TO_POINTER (ltr));
+  for (i = 0; i < candidates->len; i++)
     {
-      MetaWindow *w = tmp->data;
-      MtkRectangle frame_rect;
-
-      meta_window_get_frame_rect (w, &frame_rect);
+      MtkRectangle *frame_rect = &g_array_index (candidates, MtkRectangle, i);
 
       if (ltr)
-        rect.x = frame_rect.x + frame_rect.width;
+        rect.x = frame_rect->x + frame_rect->width;
       else
-        rect.x = frame_rect.x - rect.width;
-      rect.y = frame_rect.y;
+        rect.x = frame_rect->x - rect.width;
+      rect.y = frame_rect->y;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, end_sorted))
+          !rectangle_overlaps_some_rect (&rect, obstacles))
         {
           *new_x = rect.x;
           *new_y = rect.y;
 
-          retval = TRUE;
-
-          goto out;
+          return TRUE;
         }
-
-      tmp = tmp->next;
     }
 
-out:
-  g_list_free (below_sorted);
-  g_list_free (end_sorted);
-  return retval;
+  return FALSE;
 }
 
 void
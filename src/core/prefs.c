@@ -72,7 +72,10 @@
 
 #define SETTINGS(s) g_hash_table_lookup (settings_schemas, (s))
 
-static GList *changes = NULL;
+/* Set of preferences with a queued change notification, indexed by
+ * MetaPreference, so that queueing is cheap and changes to many keys at
+ * once are dispatched together, in a stable order. */
+static guint64 pending_changes = 0;
 static guint changed_idle;
 static GList *listeners = NULL;
 static GHashTable *settings_schemas;
@@ -100,6 +103,7 @@ static gboolean gnome_accessibility = FALSE;
 static gboolean gnome_animations = TRUE;
 static gboolean locate_pointer_is_enabled = FALSE;
 static unsigned int check_alive_timeout = 5000;
+static unsigned int hidden_frame_callback_interval = 1000;
 static char *cursor_theme = NULL;
 /* cursor_size will, when running as an X11 compositing window manager, be the
  * actual cursor size, multiplied with the global window scaling factor. On
@@ -508,6 +512,13 @@ static MetaUintPreference preferences_uint[] =
       },
       &check_alive_timeout,
     },
+    {
+      { "hidden-frame-callback-interval",
+        SCHEMA_MUTTER,
+        META_PREF_HIDDEN_FRAME_CALLBACK_INTERVAL,
+      },
+      &hidden_frame_callback_interval,
+    },
     { { NULL, 0, 0 }, NULL },
   };
 
@@ -927,42 +938,39 @@ emit_changed (MetaPreference pref)
 static gboolean
 changed_idle_handler (gpointer data)
 {
-  GList *tmp;
-  GList *copy;
+  guint64 changes;
+  MetaPreference pref;
 
   changed_idle = 0;
 
-  copy = g_list_copy (changes); /* reentrancy paranoia */
-
-  g_list_free (changes);
-  changes = NULL;
+  /* Take the whole set, listeners may queue new changes */
+  changes = pending_changes;
+  pending_changes = 0;
 
-  tmp = copy;
-  while (tmp != NULL)
+  for (pref = 0; changes != 0; pref++, changes >>= 1)
     {
-      MetaPreference pref = GPOINTER_TO_INT (tmp->data);
-
-      emit_changed (pref);
-
-      tmp = tmp->next;
+      if (changes & 1)
+        emit_changed (pref);
     }
 
-  g_list_free (copy);
-
   return FALSE;
 }
 
 static void
 queue_changed (MetaPreference pref)
 {
+  guint64 pref_bit;
+
+  G_STATIC_ASSERT (META_PREF_HIDDEN_FRAME_CALLBACK_INTERVAL < 64);
+
   meta_topic (META_DEBUG_PREFS, "Queueing change of pref %s",
               meta_preference_to_string (pref));
 
-  if (g_list_find (changes, GINT_TO_POINTER (pref)) == NULL)
-    changes = g_list_prepend (changes, GINT_TO_POINTER (pref));
-  else
+  pref_bit = G_GUINT64_CONSTANT (1) << pref;
+  if (pending_changes & pref_bit)
     meta_topic (META_DEBUG_PREFS, "Change of pref %s was already pending",
                 meta_preference_to_string (pref));
+  pending_changes |= pref_bit;
 
   if (changed_idle == 0)
     {
@@ -1462,7 +1470,7 @@ button_layout_handler (GVariant *value,
   if (!button_layout_equal (&button_layout, &new_layout))
     {
       button_layout = new_layout;
-      emit_changed (META_PREF_BUTTON_LAYOUT);
+      queue_changed (META_PREF_BUTTON_LAYOUT);
     }
 
   return TRUE;
@@ -1689,6 +1697,9 @@ meta_preference_to_string (MetaPreference pref)
 
     case META_PREF_CHECK_ALIVE_TIMEOUT:
       return "CHECK_ALIVE_TIMEOUT";
+
+    case META_PREF_HIDDEN_FRAME_CALLBACK_INTERVAL:
+      return "HIDDEN_FRAME_CALLBACK_INTERVAL";
     }
 
   return "(unknown)";
@@ -2041,6 +2052,12 @@ meta_prefs_get_check_alive_timeout (void)
   return check_alive_timeout;
 }
 
+unsigned int
+meta_prefs_get_hidden_frame_callback_interval (void)
+{
+  return hidden_frame_callback_interval;
+}
+
 const char *
 meta_prefs_get_iso_next_group_option (void)
 {
@@ -1301,6 +1301,52 @@ meta_stack_tracker_keep_override_redirect_on_top (MetaStackTracker *tracker)
     }
 }
 
+/* Marks the elements of @sequence that are part of its longest strictly
+ * increasing subsequence, by the value of the element. */
+static void
+mark_longest_increasing_subsequence (const int *sequence,
+                                     int        n_elements,
+                                     gboolean  *marks)
+{
+  g_autofree int *tails = NULL;
+  g_autofree int *predecessors = NULL;
+  int length = 0;
+  int i;
+
+  if (n_elements == 0)
+    return;
+
+  /* tails[k] is the index of the smallest element ending an increasing
+   * subsequence of length k + 1 */
+  tails = g_new (int, n_elements);
+  predecessors = g_new (int, n_elements);
+
+  for (i = 0; i < n_elements; i++)
+    {
+      int low = 0;
+      int high = length;
+
+      while (low < high)
+        {
+          int middle = (low + high) / 2;
+
+          if (sequence[tails[middle]] < sequence[i])
+            low = middle + 1;
+          else
+            high = middle;
+        }
+
+      predecessors[i] = low > 0 ? tails[low - 1] : -1;
+      tails[low] = i;
+
+      if (low == length)
+        length++;
+    }
+
+  for (i = tails[length - 1]; i >= 0; i = predecessors[i])
+    marks[sequence[i]] = TRUE;
+}
+
 void
 meta_stack_tracker_restack_managed (MetaStackTracker *tracker,
                                     const guint64    *managed,
@@ -1309,6 +1355,10 @@ meta_stack_tracker_restack_managed (MetaStackTracker *tracker,
   guint64 *windows;
   int n_windows;
   int old_pos, new_pos;
+  g_autoptr (GHashTable) new_positions = NULL;
+  g_autofree int *current_order = NULL;
+  g_autofree gboolean *in_place = NULL;
+  int n_current;
 
   COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManaged,
                            "Meta::StackTracker::restack_managed()");
@@ -1347,47 +1397,51 @@ meta_stack_tracker_restack_managed (MetaStackTracker *tracker,
     }
   COGL_TRACE_END (StackTrackerRestackManagedRaise);
 
-  old_pos--;
-  new_pos--;
-
   COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManagedRestack,
                            "Meta::StackTracker::restack_managed#restack()");
-  while (old_pos >= 0 && new_pos >= 0)
+  new_positions = g_hash_table_new (g_int64_hash, g_int64_equal);
+  for (new_pos = 0; new_pos < n_managed - 1; new_pos++)
+    {
+      g_hash_table_insert (new_positions,
+                           (gpointer) &managed[new_pos],
+                           GINT_TO_POINTER (new_pos + 1));
+    }
+
+  /* Collect the new positions of the windows in their current order,
+   * bottom to top, skipping anything below the guard window */
+  for (old_pos = n_windows - 1; old_pos >= 0; old_pos--)
     {
       if (meta_stack_tracker_is_guard_window (tracker, windows[old_pos]))
         break;
+    }
 
-      if (windows[old_pos] == managed[new_pos])
-        {
-          old_pos--;
-          new_pos--;
-          continue;
-        }
-
-      MetaWindow *old_window = meta_display_lookup_stack_id (tracker->display, windows[old_pos]);
-      if (!old_window || old_window->override_redirect || old_window->unmanaging)
-        {
-          old_pos--;
-          continue;
-        }
+  current_order = g_new (int, n_managed);
+  n_current = 0;
+  for (old_pos = old_pos + 1; old_pos < n_windows; old_pos++)
+    {
+      gpointer value;
 
-      meta_stack_tracker_lower_below (tracker, managed[new_pos], managed[new_pos + 1]);
-      meta_stack_tracker_get_stack (tracker, &windows, &n_windows);
-      /* Moving managed[new_pos] above windows[old_pos] moves the window at old_pos down by one,
-       * we'll examine it again to see if it matches the next new window */
-      old_pos--;
-      new_pos--;
+      value = g_hash_table_lookup (new_positions, &windows[old_pos]);
+      if (value)
+        current_order[n_current++] = GPOINTER_TO_INT (value) - 1;
     }
-  COGL_TRACE_END (StackTrackerRestackManagedRestack);
 
-  COGL_TRACE_BEGIN_SCOPED (StackTrackerRestackManagedLower,
-                           "Meta::StackTracker::restack_managed#lower()");
-  while (new_pos > 0)
+  /* The top window was put in place already, and as many windows as possible
+   * keep theirs, so that moving a single window only takes one restack */
+  in_place = g_new0 (gboolean, n_managed);
+  mark_longest_increasing_subsequence (current_order, n_current, in_place);
+  in_place[n_managed - 1] = TRUE;
+
+  for (new_pos = n_managed - 2; new_pos >= 0; new_pos--)
     {
-      meta_stack_tracker_lower_below (tracker, managed[new_pos], managed[new_pos - 1]);
-      new_pos--;
+      if (in_place[new_pos])
+        continue;
+
+      meta_stack_tracker_lower_below (tracker,
+                                      managed[new_pos],
+                                      managed[new_pos + 1]);
     }
-  COGL_TRACE_END (StackTrackerRestackManagedLower);
+  COGL_TRACE_END (StackTrackerRestackManagedRestack);
 }
 
 void
@@ -48,6 +48,11 @@
 #define WINDOW_TRANSIENT_FOR_WHOLE_GROUP(w)        \
   (meta_window_has_transient_type (w) && w->transient_for == NULL)
 
+/* Number of misplaced windows up to which the stack is repaired by moving
+ * them into place, rather than by sorting the whole list.
+ */
+#define MAX_MISPLACED_WINDOWS 16
+
 static void meta_window_set_stack_position_no_sync (MetaWindow *window,
                                                     int         position);
 static void stack_do_relayer (MetaStack *stack);
@@ -486,10 +491,11 @@ add_constraint (Constraint **constraints,
   constraints[below->stack_position] = c;
 }
 
-static void
+static gboolean
 create_constraints (Constraint **constraints,
                     GList       *windows)
 {
+  gboolean has_constraints = FALSE;
   GList *tmp;
 
   tmp = windows;
@@ -548,6 +554,7 @@ create_constraints (Constraint **constraints,
                               "Constraining %s above %s as it's transient for its group",
                               w->desc, group_window->desc);
                   add_constraint (constraints, w, group_window);
+                  has_constraints = TRUE;
                 }
 
               tmp2 = tmp2->next;
@@ -569,11 +576,14 @@ create_constraints (Constraint **constraints,
                           "Constraining %s above %s due to transiency",
                           w->desc, parent->desc);
               add_constraint (constraints, w, parent);
+              has_constraints = TRUE;
             }
         }
 
       tmp = tmp->next;
     }
+
+  return has_constraints;
 }
 
 static void
@@ -803,18 +813,80 @@ stack_do_constrain (MetaStack *stack)
   constraints = g_new0 (Constraint*,
                         stack->n_positions);
 
-  create_constraints (constraints, stack->sorted);
-
-  graph_constraints (constraints, stack->n_positions);
+  /* Without any transient windows there is no graph to walk */
+  if (create_constraints (constraints, stack->sorted))
+    {
+      graph_constraints (constraints, stack->n_positions);
 
-  apply_constraints (constraints, stack->n_positions);
+      apply_constraints (constraints, stack->n_positions);
 
-  free_constraints (constraints, stack->n_positions);
+      free_constraints (constraints, stack->n_positions);
+    }
   g_free (constraints);
 
   stack->need_constrain = FALSE;
 }
 
+/*
+ * Most changes to the stack, such as raising, lowering, adding or
+ * relayering a window, only leave a few windows out of place in an
+ * otherwise sorted list. Unlink those from the list, keeping the remainder
+ * sorted, and insert them back where they belong. Returns FALSE if too
+ * many windows are misplaced for this to be cheaper than a full sort, in
+ * which case the list still needs sorting.
+ */
+static gboolean
+repair_sorted (MetaStack *stack)
+{
+  GList *misplaced = NULL;
+  int n_misplaced = 0;
+  GList *l;
+
+  l = stack->sorted;
+  while (l != NULL)
+    {
+      GList *next = l->next;
+      GList *prev = l->prev;
+      GList *misplaced_link;
+
+      if (!prev || compare_window_position (prev->data, l->data) <= 0)
+        {
+          l = next;
+          continue;
+        }
+
+      /* Either this window or the previous one is out of place; if this
+       * window fits after the one before the previous one, the previous one
+       * is the one that moved.
+       */
+      if (!prev->prev ||
+          compare_window_position (prev->prev->data, l->data) <= 0)
+        misplaced_link = prev;
+      else
+        misplaced_link = l;
+
+      stack->sorted = g_list_remove_link (stack->sorted, misplaced_link);
+      misplaced = g_list_concat (misplaced_link, misplaced);
+
+      if (++n_misplaced > MAX_MISPLACED_WINDOWS)
+        {
+          stack->sorted = g_list_concat (stack->sorted, misplaced);
+          return FALSE;
+        }
+
+      l = next;
+    }
+
+  for (l = misplaced; l; l = l->next)
+    {
+      stack->sorted = g_list_insert_sorted (stack->sorted, l->data,
+                                            (GCompareFunc) compare_window_position);
+    }
+  g_list_free (misplaced);
+
+  return TRUE;
+}
+
 /**
  * stack_do_resort:
  *
@@ -829,8 +901,11 @@ stack_do_resort (MetaStack *stack)
   meta_topic (META_DEBUG_STACK,
               "Sorting stack list");
 
-  stack->sorted = g_list_sort (stack->sorted,
-                               (GCompareFunc) compare_window_position);
+  if (!repair_sorted (stack))
+    {
+      stack->sorted = g_list_sort (stack->sorted,
+                                   (GCompareFunc) compare_window_position);
+    }
 
   meta_display_queue_check_fullscreen (stack->display);
 
@@ -3672,7 +3672,17 @@ meta_window_update_for_monitors_changed (MetaWindow *window)
         window->tile_monitor_number = -1;
     }
 
-  if (new && old)
+  if (new && old &&
+      !(meta_monitor_manager_get_changed_flags (monitor_manager) &
+        META_MONITORS_CHANGED_FLAG_GEOMETRY) &&
+      mtk_rectangle_equal (&old->rect, &new->rect))
+    {
+      /* Nothing moved, only the logical monitor objects were replaced, so
+       * there is no need to go through a full move and resize. */
+      meta_window_update_monitor (window,
+                                  META_WINDOW_UPDATE_MONITOR_FLAGS_FORCE);
+    }
+  else if (new && old)
     {
       /* This will eventually reach meta_window_update_monitor that
        * will send leave/enter-monitor events. The old != new monitor
@@ -87,6 +87,8 @@ void meta_workspace_get_work_area_for_logical_monitor (MetaWorkspace      *works
 
 void meta_workspace_invalidate_work_area (MetaWorkspace *workspace);
 
+void meta_workspace_reload_work_area (MetaWorkspace *workspace);
+
 GList* meta_workspace_get_onscreen_region       (MetaWorkspace *workspace);
 GList * meta_workspace_get_onmonitor_region (MetaWorkspace      *workspace,
                                              MetaLogicalMonitor *logical_monitor);
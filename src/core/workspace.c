@@ -759,8 +759,151 @@ meta_workspace_list_windows (MetaWorkspace *workspace)
   return workspace_windows;
 }
 
-void
-meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
+static GSList *
+list_current_struts (MetaWorkspace *workspace)
+{
+  GSList *struts;
+  GList *windows, *l;
+
+  struts = g_slist_copy (workspace->builtin_struts);
+
+  windows = meta_workspace_list_windows (workspace);
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *window = l->data;
+
+      struts = g_slist_concat (g_slist_copy (window->struts), struts);
+    }
+  g_list_free (windows);
+
+  return struts;
+}
+
+static GSList *
+find_strut (GSList    *struts,
+            MetaStrut *strut)
+{
+  GSList *l;
+
+  for (l = struts; l; l = l->next)
+    {
+      MetaStrut *other = l->data;
+
+      if (other->side == strut->side &&
+          mtk_rectangle_equal (&other->rect, &strut->rect))
+        return l;
+    }
+
+  return NULL;
+}
+
+static void
+add_monitors_touching_strut (MetaMonitorManager  *monitor_manager,
+                             MetaStrut           *strut,
+                             GList              **logical_monitors)
+{
+  GList *l;
+
+  for (l = meta_monitor_manager_get_logical_monitors (monitor_manager);
+       l;
+       l = l->next)
+    {
+      MetaLogicalMonitor *logical_monitor = l->data;
+
+      if (!mtk_rectangle_overlap (&logical_monitor->rect, &strut->rect) ||
+          g_list_find (*logical_monitors, logical_monitor))
+        continue;
+
+      *logical_monitors = g_list_prepend (*logical_monitors, logical_monitor);
+    }
+}
+
+/*
+ * Compares the struts the work areas were computed from with the current
+ * ones, and collects the logical monitors touched by the struts that were
+ * added or removed. Returns FALSE if the struts didn't change.
+ */
+static gboolean
+find_monitors_affected_by_struts (MetaWorkspace  *workspace,
+                                  GList         **affected_logical_monitors)
+{
+  MetaContext *context = meta_display_get_context (workspace->display);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  g_autoptr (GSList) current_struts = NULL;
+  gboolean changed = FALSE;
+  GSList *l;
+
+  current_struts = list_current_struts (workspace);
+
+  for (l = workspace->all_struts; l; l = l->next)
+    {
+      MetaStrut *strut = l->data;
+      GSList *link;
+
+      link = find_strut (current_struts, strut);
+      if (link)
+        {
+          current_struts = g_slist_delete_link (current_struts, link);
+        }
+      else
+        {
+          add_monitors_touching_strut (monitor_manager, strut,
+                                       affected_logical_monitors);
+          changed = TRUE;
+        }
+    }
+
+  for (l = current_struts; l; l = l->next)
+    {
+      add_monitors_touching_strut (monitor_manager, l->data,
+                                   affected_logical_monitors);
+      changed = TRUE;
+    }
+
+  /* Struts outside of all monitors; don't try to be clever */
+  if (changed && !*affected_logical_monitors)
+    *affected_logical_monitors =
+      g_list_copy (meta_monitor_manager_get_logical_monitors (monitor_manager));
+
+  return changed;
+}
+
+static gboolean
+is_window_affected (MetaWindow *window,
+                    GList      *affected_logical_monitors)
+{
+  MetaContext *context = meta_display_get_context (window->display);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MtkRectangle frame_rect;
+  GList *l;
+
+  meta_window_get_frame_rect (window, &frame_rect);
+
+  /* Any rectangle that avoids the struts is contained in one of the
+   * spanning rectangles computed from them, so constraints of windows that
+   * lie within a monitor without changed struts are unaffected.
+   */
+  for (l = meta_monitor_manager_get_logical_monitors (monitor_manager);
+       l;
+       l = l->next)
+    {
+      MetaLogicalMonitor *logical_monitor = l->data;
+
+      if (!g_list_find (affected_logical_monitors, logical_monitor) &&
+          mtk_rectangle_contains_rect (&logical_monitor->rect, &frame_rect))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+invalidate_work_area (MetaWorkspace *workspace,
+                      GList         *affected_logical_monitors)
 {
   MetaWindowDrag *window_drag;
   GList *windows, *l;
@@ -799,12 +942,17 @@ meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
 
   workspace->work_areas_invalid = TRUE;
 
-  /* redo the size/position constraints on all windows */
+  /* redo the size/position constraints on all affected windows */
   windows = meta_workspace_list_windows (workspace);
 
   for (l = windows; l != NULL; l = l->next)
     {
       MetaWindow *w = l->data;
+
+      if (affected_logical_monitors &&
+          !is_window_affected (w, affected_logical_monitors))
+        continue;
+
       meta_window_queue (w, META_QUEUE_MOVE_RESIZE);
     }
 
@@ -813,6 +961,46 @@ meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
   meta_display_queue_workarea_recalc (workspace->display);
 }
 
+/**
+ * meta_workspace_invalidate_work_area:
+ * @workspace: a #MetaWorkspace
+ *
+ * Invalidates the work areas after the struts of the workspace or of any
+ * of its windows may have changed. Nothing is done if the struts turn out
+ * to be the same as those the work areas were computed from, and only
+ * windows on monitors touched by changed struts are constrained again.
+ */
+void
+meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
+{
+  g_autoptr (GList) affected_logical_monitors = NULL;
+
+  if (!workspace->work_areas_invalid &&
+      !find_monitors_affected_by_struts (workspace,
+                                         &affected_logical_monitors))
+    {
+      meta_topic (META_DEBUG_WORKAREA,
+                  "Struts of workspace %d unchanged, keeping work area",
+                  meta_workspace_index (workspace));
+      return;
+    }
+
+  invalidate_work_area (workspace, affected_logical_monitors);
+}
+
+/**
+ * meta_workspace_reload_work_area:
+ * @workspace: a #MetaWorkspace
+ *
+ * Unconditionally invalidates the work areas, e.g. after the monitor
+ * configuration changed, constraining all windows again.
+ */
+void
+meta_workspace_reload_work_area (MetaWorkspace *workspace)
+{
+  invalidate_work_area (workspace, NULL);
+}
+
 static MetaStrut *
 copy_strut(MetaStrut *original)
 {
@@ -123,6 +123,7 @@ main (int    argc,
       char **argv)
 {
   MetaAnonymousFile *file;
+  MetaAnonymousFile *other_file;
   int fd = -1, other_fd = -1;
   g_autofree char *fd_path = NULL;
 
@@ -177,6 +178,34 @@ main (int    argc,
   meta_anonymous_file_close_fd (fd);
   meta_anonymous_file_close_fd (fd);
 
+  /* A file with the same contents should share the sealed fd */
+  other_file = meta_anonymous_file_new (strlen (teststring) + 1,
+                                        (const uint8_t *) teststring);
+  g_assert_nonnull (other_file);
+
+  fd = meta_anonymous_file_open_fd (file, META_ANONYMOUS_FILE_MAPMODE_PRIVATE);
+  g_assert (fd != -1);
+  other_fd = meta_anonymous_file_open_fd (other_file,
+                                          META_ANONYMOUS_FILE_MAPMODE_PRIVATE);
+  g_assert (other_fd != -1);
+
+  if (other_fd != fd)
+    goto fail;
+
+  meta_anonymous_file_close_fd (fd);
+  meta_anonymous_file_close_fd (other_fd);
+
+  /* Freeing one of them must leave the other one usable */
+  meta_anonymous_file_free (other_file);
+
+  fd = meta_anonymous_file_open_fd (file, META_ANONYMOUS_FILE_MAPMODE_PRIVATE);
+  g_assert (fd != -1);
+
+  if (!test_read_fd_mmap (fd, teststring))
+    goto fail;
+
+  meta_anonymous_file_close_fd (fd);
+
 
   fd = meta_anonymous_file_open_fd (file, META_ANONYMOUS_FILE_MAPMODE_SHARED);
   g_assert (fd != -1);
@@ -5,6 +5,47 @@
 
 #include "tests/clutter-test-utils.h"
 
+typedef struct _CountActor      CountActor;
+typedef struct _CountActorClass CountActorClass;
+
+struct _CountActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+struct _CountActor
+{
+  ClutterActor parent;
+
+  int paint_count;
+};
+
+GType count_actor_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (CountActor, count_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+count_actor_paint (ClutterActor        *actor,
+                   ClutterPaintContext *paint_context)
+{
+  CountActor *count_actor = (CountActor *) actor;
+
+  count_actor->paint_count++;
+}
+
+static void
+count_actor_class_init (CountActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint = count_actor_paint;
+}
+
+static void
+count_actor_init (CountActor *self)
+{
+}
+
 static void
 on_presented (ClutterStage     *stage,
               ClutterStageView *view,
@@ -63,6 +104,75 @@ actor_clone_unmapped (void)
   g_assert_null (container);
 }
 
+static void
+wait_for_paint (ClutterActor *stage)
+{
+  g_autoptr (GMainLoop) main_loop = g_main_loop_new (NULL, TRUE);
+  gulong paint_handler;
+
+  paint_handler = g_signal_connect_data (CLUTTER_STAGE (stage),
+                                         "after-paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED);
+
+  clutter_actor_queue_redraw (stage);
+  g_main_loop_run (main_loop);
+
+  g_clear_signal_handler (&paint_handler, stage);
+}
+
+static void
+actor_clone_cache_contents (void)
+{
+  ClutterActor *stage;
+  CountActor *source;
+  ClutterActor *clone;
+  int paint_count;
+
+  stage = clutter_test_get_stage ();
+
+  source = g_object_new (count_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (source), 100, 100);
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (source));
+
+  clone = clutter_clone_new (CLUTTER_ACTOR (source));
+  clutter_clone_set_cache_contents (CLUTTER_CLONE (clone), TRUE);
+  g_assert_true (clutter_clone_get_cache_contents (CLUTTER_CLONE (clone)));
+  clutter_actor_set_size (clone, 25, 25);
+  clutter_actor_add_child (stage, clone);
+
+  clutter_actor_show (stage);
+
+  /* The source is painted on the stage and once into the cache */
+  wait_for_paint (stage);
+  g_assert_cmpint (source->paint_count, ==, 2);
+
+  /* Changing only the clone keeps using the cached contents */
+  paint_count = source->paint_count;
+  clutter_actor_set_opacity (clone, 127);
+  clutter_actor_set_position (clone, 10, 10);
+  wait_for_paint (stage);
+  g_assert_cmpint (source->paint_count, ==, paint_count + 1);
+
+  /* Damaging the source updates the cache */
+  paint_count = source->paint_count;
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (source));
+  wait_for_paint (stage);
+  g_assert_cmpint (source->paint_count, ==, paint_count + 2);
+
+  /* Without caching every paint of the clone paints the source */
+  clutter_clone_set_cache_contents (CLUTTER_CLONE (clone), FALSE);
+  paint_count = source->paint_count;
+  wait_for_paint (stage);
+  g_assert_cmpint (source->paint_count, ==, paint_count + 2);
+
+  clutter_actor_destroy (clone);
+  clutter_actor_destroy (CLUTTER_ACTOR (source));
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/clone/unmapped", actor_clone_unmapped)
+  CLUTTER_TEST_UNIT ("/actor/clone/cache-contents", actor_clone_cache_contents)
 )
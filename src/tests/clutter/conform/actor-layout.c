@@ -2,6 +2,44 @@
 
 #include "tests/clutter-test-utils.h"
 
+typedef struct _TestAllocationCounter
+{
+  ClutterActor parent;
+
+  int n_allocations;
+} TestAllocationCounter;
+
+#define TEST_TYPE_ALLOCATION_COUNTER (test_allocation_counter_get_type ())
+G_DECLARE_FINAL_TYPE (TestAllocationCounter, test_allocation_counter,
+                      TEST, ALLOCATION_COUNTER, ClutterActor)
+G_DEFINE_TYPE (TestAllocationCounter, test_allocation_counter,
+               CLUTTER_TYPE_ACTOR)
+
+static void
+test_allocation_counter_allocate (ClutterActor          *actor,
+                                  const ClutterActorBox *box)
+{
+  TestAllocationCounter *counter = TEST_ALLOCATION_COUNTER (actor);
+
+  counter->n_allocations++;
+
+  CLUTTER_ACTOR_CLASS (test_allocation_counter_parent_class)->allocate (actor,
+                                                                       box);
+}
+
+static void
+test_allocation_counter_class_init (TestAllocationCounterClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->allocate = test_allocation_counter_allocate;
+}
+
+static void
+test_allocation_counter_init (TestAllocationCounter *counter)
+{
+}
+
 static void
 actor_basic_layout (void)
 {
@@ -92,7 +130,103 @@ actor_margin_layout (void)
   clutter_actor_destroy (vase);
 }
 
+static void
+actor_relayout_boundary (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  TestAllocationCounter *vase;
+  ClutterActor *pot;
+  ClutterActor *flower;
+  graphene_point_t p;
+
+  vase = g_object_new (TEST_TYPE_ALLOCATION_COUNTER, NULL);
+  clutter_actor_set_layout_manager (CLUTTER_ACTOR (vase),
+                                    clutter_box_layout_new ());
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (vase));
+
+  /* A fixed size actor can't change its preferred size because of its
+   * children, so relayouts of those stop there.
+   */
+  pot = clutter_actor_new ();
+  clutter_actor_set_size (pot, 100, 100);
+  clutter_actor_add_child (CLUTTER_ACTOR (vase), pot);
+
+  flower = clutter_actor_new ();
+  clutter_actor_set_background_color (flower, CLUTTER_COLOR_Red);
+  clutter_actor_set_size (flower, 10, 10);
+  clutter_actor_add_child (pot, flower);
+
+  graphene_point_init (&p, 5, 5);
+  clutter_test_assert_actor_at_point (stage, &p, flower);
+
+  vase->n_allocations = 0;
+  clutter_actor_set_size (flower, 50, 50);
+
+  graphene_point_init (&p, 40, 40);
+  clutter_test_assert_actor_at_point (stage, &p, flower);
+  g_assert_cmpint (vase->n_allocations, ==, 0);
+
+  /* Changing the boundary itself still relayouts its parent. */
+  clutter_actor_set_size (pot, 200, 200);
+
+  graphene_point_init (&p, 40, 40);
+  clutter_test_assert_actor_at_point (stage, &p, flower);
+  g_assert_cmpint (vase->n_allocations, >, 0);
+
+  clutter_actor_destroy (CLUTTER_ACTOR (vase));
+}
+
+static void
+actor_cached_layout (void)
+{
+  ClutterActor *stage = clutter_test_get_stage ();
+  ClutterActor *vase;
+  ClutterActor *flower[2];
+  graphene_point_t p;
+
+  vase = clutter_actor_new ();
+  clutter_actor_set_layout_manager (vase, clutter_box_layout_new ());
+  clutter_actor_add_child (stage, vase);
+
+  flower[0] = clutter_actor_new ();
+  clutter_actor_set_background_color (flower[0], CLUTTER_COLOR_Red);
+  clutter_actor_set_size (flower[0], 100, 100);
+  clutter_actor_add_child (vase, flower[0]);
+
+  flower[1] = clutter_actor_new ();
+  clutter_actor_set_background_color (flower[1], CLUTTER_COLOR_Yellow);
+  clutter_actor_set_size (flower[1], 100, 100);
+  clutter_actor_add_child (vase, flower[1]);
+
+  graphene_point_init (&p, 150, 50);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  /* Allocating again with nothing changed reuses the same layout */
+  clutter_actor_queue_relayout (vase);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  /* A child changing its size request is picked up */
+  clutter_actor_set_width (flower[0], 50);
+  graphene_point_init (&p, 75, 50);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  /* And so is a change of the layout manager itself */
+  clutter_box_layout_set_spacing (CLUTTER_BOX_LAYOUT (clutter_actor_get_layout_manager (vase)),
+                                  50);
+  graphene_point_init (&p, 125, 50);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  /* As well as a child being hidden */
+  clutter_actor_hide (flower[0]);
+  graphene_point_init (&p, 50, 50);
+  clutter_test_assert_actor_at_point (stage, &p, flower[1]);
+
+  clutter_actor_destroy (vase);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/layout/basic", actor_basic_layout)
   CLUTTER_TEST_UNIT ("/actor/layout/margin", actor_margin_layout)
+  CLUTTER_TEST_UNIT ("/actor/layout/relayout-boundary", actor_relayout_boundary)
+  CLUTTER_TEST_UNIT ("/actor/layout/cached", actor_cached_layout)
 )
@@ -209,6 +209,10 @@ verify_redraws (gpointer user_data)
   clutter_actor_set_translation (data->parent_container, 0.f, -1.f, 0.f);
   verify_redraw (data, 0);
 
+  /* The same goes for the transformation of the actor itself */
+  clutter_actor_set_translation (data->container, 0.f, 1.f, 0.f);
+  verify_redraw (data, 0);
+
   /* Redrawing an unrelated actor shouldn't cause a redraw */
   clutter_actor_set_position (data->unrelated_actor, 0, 1);
   verify_redraw (data, 0);
@@ -0,0 +1,125 @@
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+typedef struct _FooActor      FooActor;
+typedef struct _FooActorClass FooActorClass;
+
+struct _FooActorClass
+{
+  ClutterActorClass parent_class;
+};
+
+struct _FooActor
+{
+  ClutterActor parent;
+
+  int paint_node_count;
+};
+
+GType foo_actor_get_type (void) G_GNUC_CONST;
+
+G_DEFINE_TYPE (FooActor, foo_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+foo_actor_paint_node (ClutterActor     *actor,
+                      ClutterPaintNode *root)
+{
+  FooActor *foo_actor = (FooActor *) actor;
+  ClutterActorBox box = { 0.f, 0.f, 10.f, 10.f };
+  ClutterPaintNode *node;
+
+  foo_actor->paint_node_count++;
+
+  node = clutter_color_node_new (&(ClutterColor) { 255, 0, 0, 255 });
+  clutter_paint_node_add_rectangle (node, &box);
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+}
+
+static void
+foo_actor_class_init (FooActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint_node = foo_actor_paint_node;
+}
+
+static void
+foo_actor_init (FooActor *self)
+{
+}
+
+static void
+wait_for_paint (ClutterActor *stage)
+{
+  g_autoptr (GMainLoop) main_loop = g_main_loop_new (NULL, TRUE);
+  gulong paint_handler;
+
+  paint_handler = g_signal_connect_data (CLUTTER_STAGE (stage),
+                                         "after-paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED);
+
+  clutter_actor_queue_redraw (stage);
+  g_main_loop_run (main_loop);
+
+  g_clear_signal_handler (&paint_handler, stage);
+}
+
+static void
+actor_paint_nodes_retained (void)
+{
+  ClutterActor *stage;
+  ClutterActor *container;
+  FooActor *foo_actor;
+
+  stage = clutter_test_get_stage ();
+
+  container = clutter_actor_new ();
+  clutter_actor_add_child (stage, container);
+
+  foo_actor = g_object_new (foo_actor_get_type (), NULL);
+  clutter_actor_set_size (CLUTTER_ACTOR (foo_actor), 10, 10);
+  clutter_actor_set_retain_paint_nodes (CLUTTER_ACTOR (foo_actor), TRUE);
+  clutter_actor_add_child (container, CLUTTER_ACTOR (foo_actor));
+
+  clutter_actor_show (stage);
+
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 1);
+
+  /* Repainting the stage reuses the nodes */
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 1);
+
+  /* A redraw queued on the actor itself discards them */
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (foo_actor));
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 2);
+
+  /* So does a change of the paint opacity through a parent */
+  clutter_actor_set_opacity (container, 127);
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 3);
+
+  /* And a size change */
+  clutter_actor_set_size (CLUTTER_ACTOR (foo_actor), 20, 20);
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 4);
+
+  clutter_actor_set_retain_paint_nodes (CLUTTER_ACTOR (foo_actor), FALSE);
+
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 5);
+  wait_for_paint (stage);
+  g_assert_cmpint (foo_actor->paint_node_count, ==, 6);
+
+  clutter_actor_destroy (container);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/paint-nodes/retained", actor_paint_nodes_retained)
+)
@@ -0,0 +1,107 @@
+#include "clutter/clutter.h"
+#include "clutter/clutter-damage-tiles.h"
+#include "tests/clutter-test-utils.h"
+
+static void
+damage_tiles_empty (void)
+{
+  MtkRectangle layout = { 0, 0, 1024, 768 };
+  g_autoptr (ClutterDamageTiles) tiles = NULL;
+  g_autoptr (MtkRegion) region = NULL;
+
+  tiles = clutter_damage_tiles_new (&layout);
+  g_assert_true (clutter_damage_tiles_is_empty (tiles));
+  g_assert_false (clutter_damage_tiles_is_full (tiles));
+
+  region = clutter_damage_tiles_to_region (tiles);
+  g_assert_true (mtk_region_is_empty (region));
+}
+
+static void
+damage_tiles_snap (void)
+{
+  MtkRectangle layout = { 100, 100, 1000, 700 };
+  MtkRectangle rect = { 110, 110, 10, 10 };
+  MtkRectangle expected = { 100, 100, 64, 64 };
+  MtkRectangle extents;
+  g_autoptr (ClutterDamageTiles) tiles = NULL;
+  g_autoptr (MtkRegion) region = NULL;
+
+  tiles = clutter_damage_tiles_new (&layout);
+  clutter_damage_tiles_add_rectangle (tiles, &rect);
+  g_assert_false (clutter_damage_tiles_is_empty (tiles));
+
+  region = clutter_damage_tiles_to_region (tiles);
+  g_assert_cmpint (mtk_region_num_rectangles (region), ==, 1);
+  extents = mtk_region_get_extents (region);
+  g_assert_true (mtk_rectangle_equal (&extents, &expected));
+}
+
+static void
+damage_tiles_clamp_to_layout (void)
+{
+  MtkRectangle layout = { 0, 0, 100, 100 };
+  MtkRectangle rect = { 90, 90, 100, 100 };
+  MtkRectangle outside = { 200, 200, 10, 10 };
+  MtkRectangle expected = { 64, 64, 36, 36 };
+  MtkRectangle extents;
+  g_autoptr (ClutterDamageTiles) tiles = NULL;
+  g_autoptr (MtkRegion) region = NULL;
+
+  tiles = clutter_damage_tiles_new (&layout);
+  clutter_damage_tiles_add_rectangle (tiles, &outside);
+  g_assert_true (clutter_damage_tiles_is_empty (tiles));
+
+  clutter_damage_tiles_add_rectangle (tiles, &rect);
+  region = clutter_damage_tiles_to_region (tiles);
+  extents = mtk_region_get_extents (region);
+  g_assert_true (mtk_rectangle_equal (&extents, &expected));
+}
+
+static void
+damage_tiles_many_rectangles (void)
+{
+  MtkRectangle layout = { 0, 0, 4096, 2160 };
+  g_autoptr (ClutterDamageTiles) tiles = NULL;
+  g_autoptr (MtkRegion) region = NULL;
+  int i;
+
+  tiles = clutter_damage_tiles_new (&layout);
+
+  /* Many small rectangles in the first row of tiles end up as one run. */
+  for (i = 0; i < 4096; i += 2)
+    {
+      MtkRectangle rect = { i, 0, 1, 1 };
+
+      clutter_damage_tiles_add_rectangle (tiles, &rect);
+    }
+
+  region = clutter_damage_tiles_to_region (tiles);
+  g_assert_cmpint (mtk_region_num_rectangles (region), ==, 1);
+}
+
+static void
+damage_tiles_full (void)
+{
+  MtkRectangle layout = { 0, 0, 200, 150 };
+  MtkRectangle left = { 0, 0, 100, 150 };
+  MtkRectangle right = { 100, 0, 100, 150 };
+  g_autoptr (ClutterDamageTiles) tiles = NULL;
+
+  tiles = clutter_damage_tiles_new (&layout);
+  clutter_damage_tiles_add_rectangle (tiles, &left);
+  g_assert_false (clutter_damage_tiles_is_full (tiles));
+  clutter_damage_tiles_add_rectangle (tiles, &right);
+  g_assert_true (clutter_damage_tiles_is_full (tiles));
+
+  clutter_damage_tiles_clear (tiles);
+  g_assert_true (clutter_damage_tiles_is_empty (tiles));
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/damage-tiles/empty", damage_tiles_empty)
+  CLUTTER_TEST_UNIT ("/damage-tiles/snap", damage_tiles_snap)
+  CLUTTER_TEST_UNIT ("/damage-tiles/clamp-to-layout", damage_tiles_clamp_to_layout)
+  CLUTTER_TEST_UNIT ("/damage-tiles/many-rectangles", damage_tiles_many_rectangles)
+  CLUTTER_TEST_UNIT ("/damage-tiles/full", damage_tiles_full)
+)
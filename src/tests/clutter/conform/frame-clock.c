@@ -255,6 +255,41 @@ frame_clock_immediate_present (void)
   clutter_frame_clock_destroy (frame_clock);
 }
 
+static void
+frame_clock_tearing (void)
+{
+  GMainLoop *main_loop;
+  ClutterFrameClock *frame_clock;
+  int64_t before_us;
+  int64_t after_us;
+
+  test_frame_count = 10;
+  expected_frame_count = 0;
+
+  main_loop = g_main_loop_new (NULL, FALSE);
+  frame_clock = clutter_frame_clock_new (refresh_rate,
+                                         0,
+                                         NULL,
+                                         &immediate_frame_listener_iface,
+                                         main_loop);
+  clutter_frame_clock_set_mode (frame_clock, CLUTTER_FRAME_CLOCK_MODE_TEARING);
+
+  before_us = g_get_monotonic_time ();
+
+  clutter_frame_clock_schedule_update (frame_clock);
+  g_main_loop_run (main_loop);
+
+  after_us = g_get_monotonic_time ();
+
+  /* Updates are not aligned to the refresh rate when tearing, so presenting
+   * immediately should not be throttled to one frame per refresh interval.
+   */
+  g_assert_cmpint (after_us - before_us, <, 9 * refresh_interval_us);
+
+  g_main_loop_unref (main_loop);
+  clutter_frame_clock_destroy (frame_clock);
+}
+
 static gboolean
 schedule_update_timeout (gpointer user_data)
 {
@@ -841,9 +876,118 @@ frame_clock_notify_ready (void)
   clutter_frame_clock_destroy (frame_clock);
 }
 
+typedef struct _TripleBufferingTest
+{
+  ClutterFrameClock *frame_clock;
+  GMainLoop *main_loop;
+
+  int n_frames_in_flight;
+  int max_frames_in_flight;
+  gboolean done;
+} TripleBufferingTest;
+
+static gboolean
+present_slow_frame_timeout (gpointer user_data)
+{
+  TripleBufferingTest *test = user_data;
+  ClutterFrameInfo frame_info;
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+
+  /* Pretend the GPU needed two refresh intervals to render the frame */
+  init_frame_info (&frame_info, now_us);
+  frame_info.cpu_time_before_buffer_swap_us = now_us;
+  frame_info.gpu_rendering_duration_ns = 2 * refresh_interval_us * 1000;
+
+  test->n_frames_in_flight--;
+  clutter_frame_clock_notify_presented (test->frame_clock, &frame_info);
+
+  if (test->done && test->n_frames_in_flight == 0)
+    g_main_loop_quit (test->main_loop);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+schedule_update_idle (gpointer user_data)
+{
+  ClutterFrameClock *frame_clock = user_data;
+
+  clutter_frame_clock_schedule_update (frame_clock);
+
+  return G_SOURCE_REMOVE;
+}
+
+static ClutterFrameResult
+triple_buffering_frame_clock_frame (ClutterFrameClock *frame_clock,
+                                    ClutterFrame      *frame,
+                                    gpointer           user_data)
+{
+  TripleBufferingTest *test = user_data;
+
+  if (test->done)
+    return CLUTTER_FRAME_RESULT_IDLE;
+
+  g_assert_cmpint (clutter_frame_get_count (frame), ==, expected_frame_count);
+
+  expected_frame_count++;
+
+  if (test_frame_count == 0)
+    {
+      test->done = TRUE;
+      return CLUTTER_FRAME_RESULT_IDLE;
+    }
+
+  test_frame_count--;
+
+  test->n_frames_in_flight++;
+  test->max_frames_in_flight = MAX (test->max_frames_in_flight,
+                                    test->n_frames_in_flight);
+  g_assert_cmpint (test->n_frames_in_flight, <=, 2);
+
+  g_timeout_add (2 * refresh_interval_us / 1000,
+                 present_slow_frame_timeout, test);
+  g_idle_add (schedule_update_idle, frame_clock);
+
+  return CLUTTER_FRAME_RESULT_PENDING_PRESENTED;
+}
+
+static const ClutterFrameListenerIface triple_buffering_listener_iface = {
+  .frame = triple_buffering_frame_clock_frame,
+};
+
+static void
+frame_clock_triple_buffering (void)
+{
+  TripleBufferingTest test = { 0 };
+
+  test_frame_count = 10;
+  expected_frame_count = 0;
+
+  test.main_loop = g_main_loop_new (NULL, FALSE);
+  test.frame_clock = clutter_frame_clock_new (refresh_rate,
+                                              0,
+                                              NULL,
+                                              &triple_buffering_listener_iface,
+                                              &test);
+  clutter_frame_clock_set_allow_triple_buffering (test.frame_clock, TRUE);
+
+  clutter_frame_clock_schedule_update (test.frame_clock);
+  g_main_loop_run (test.main_loop);
+
+  /* Frames were slow to render, so a second one got queued */
+  g_assert_cmpint (test.max_frames_in_flight, ==, 2);
+  g_assert_cmpint (expected_frame_count, ==, 11);
+
+  g_main_loop_unref (test.main_loop);
+  clutter_frame_clock_destroy (test.frame_clock);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/frame-clock/schedule-update", frame_clock_schedule_update)
   CLUTTER_TEST_UNIT ("/frame-clock/immediate-present", frame_clock_immediate_present)
+  CLUTTER_TEST_UNIT ("/frame-clock/tearing", frame_clock_tearing)
   CLUTTER_TEST_UNIT ("/frame-clock/delayed-damage", frame_clock_delayed_damage)
   CLUTTER_TEST_UNIT ("/frame-clock/no-damage", frame_clock_no_damage)
   CLUTTER_TEST_UNIT ("/frame-clock/schedule-update-now", frame_clock_schedule_update_now)
@@ -852,4 +996,5 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/frame-clock/reschedule-on-idle", frame_clock_reschedule_on_idle)
   CLUTTER_TEST_UNIT ("/frame-clock/destroy-signal", frame_clock_destroy_signal)
   CLUTTER_TEST_UNIT ("/frame-clock/notify-ready", frame_clock_notify_ready)
+  CLUTTER_TEST_UNIT ("/frame-clock/triple-buffering", frame_clock_triple_buffering)
 )
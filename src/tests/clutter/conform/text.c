@@ -548,6 +548,74 @@ text_idempotent_use_markup (void)
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
 
+static void
+text_shared_layout (void)
+{
+  ClutterText *text_a;
+  ClutterText *text_b;
+
+  text_a = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 10", "Shared"));
+  g_object_ref_sink (text_a);
+  text_b = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 10", "Shared"));
+  g_object_ref_sink (text_b);
+
+  /* Identical labels share their layout */
+  g_assert_true (clutter_text_get_layout (text_a) ==
+                 clutter_text_get_layout (text_b));
+
+  clutter_text_set_text (text_b, "Not shared");
+  g_assert_true (clutter_text_get_layout (text_a) !=
+                 clutter_text_get_layout (text_b));
+
+  clutter_text_set_text (text_b, "Shared");
+  clutter_text_set_font_name (text_b, "Sans 12");
+  g_assert_true (clutter_text_get_layout (text_a) !=
+                 clutter_text_get_layout (text_b));
+
+  /* Editable text always gets its own layout */
+  clutter_text_set_font_name (text_b, "Sans 10");
+  clutter_text_set_editable (text_b, TRUE);
+  g_assert_true (clutter_text_get_layout (text_a) !=
+                 clutter_text_get_layout (text_b));
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text_a));
+  clutter_actor_destroy (CLUTTER_ACTOR (text_b));
+}
+
+static void
+text_async_shaping (void)
+{
+  ClutterText *text;
+  g_autoptr (GString) contents = NULL;
+
+  contents = g_string_new (NULL);
+  while (contents->len < 32 * 1024)
+    g_string_append (contents, "The quick brown fox jumps over the lazy dog. ");
+
+  text = CLUTTER_TEXT (clutter_text_new ());
+  g_object_ref_sink (text);
+  clutter_text_set_selectable (text, FALSE);
+  clutter_text_set_async_shaping (text, TRUE);
+  clutter_text_set_text (text, contents->str);
+
+  /* Nothing was shaped before, so an empty layout is used meanwhile */
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text)),
+                   ==,
+                   "");
+
+  while (g_strcmp0 (pango_layout_get_text (clutter_text_get_layout (text)),
+                    contents->str) != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* Short contents are shaped right away */
+  clutter_text_set_text (text, "Short");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text)),
+                   ==,
+                   "Short");
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text));
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -562,4 +630,6 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/shared-layout", text_shared_layout)
+  CLUTTER_TEST_UNIT ("/text/async-shaping", text_async_shaping)
 )
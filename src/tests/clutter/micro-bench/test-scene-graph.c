@@ -0,0 +1,406 @@
+/*
+ * Benchmarks for the scene graph hot paths.
+ *
+ * Every case prints a single line of JSON to stdout, e.g.
+ *
+ *   {"benchmark": "relayout-deep", "iterations": 200, "usec": 1234, "usec-per-iteration": 6.170}
+ *
+ * so that results can be collected and compared between runs. The number
+ * of iterations can be scaled with CLUTTER_BENCHMARK_SCALE.
+ */
+
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#include "tests/clutter-test-utils.h"
+
+#define TREE_DEPTH 64
+#define TREE_WIDTH 256
+#define N_PICK_ACTORS 500
+#define N_TRANSITIONS 200
+
+static double iteration_scale = 1.0;
+
+typedef struct _BenchTimer
+{
+  const char *name;
+  int iterations;
+  int64_t start_us;
+} BenchTimer;
+
+static int
+scaled_iterations (int iterations)
+{
+  return MAX (1, (int) (iterations * iteration_scale));
+}
+
+static void
+bench_timer_start (BenchTimer *timer,
+                   const char *name,
+                   int         iterations)
+{
+  timer->name = name;
+  timer->iterations = iterations;
+  timer->start_us = g_get_monotonic_time ();
+}
+
+static void
+bench_timer_report (BenchTimer *timer)
+{
+  int64_t elapsed_us = g_get_monotonic_time () - timer->start_us;
+
+  g_print ("{\"benchmark\": \"%s\", \"iterations\": %d, "
+           "\"usec\": %" G_GINT64_FORMAT ", \"usec-per-iteration\": %.3f}\n",
+           timer->name,
+           timer->iterations,
+           elapsed_us,
+           (double) elapsed_us / timer->iterations);
+}
+
+static void
+wait_for_paint (ClutterActor *stage)
+{
+  g_autoptr (GMainLoop) main_loop = g_main_loop_new (NULL, TRUE);
+  gulong paint_handler;
+
+  paint_handler = g_signal_connect_data (CLUTTER_STAGE (stage),
+                                         "after-paint",
+                                         G_CALLBACK (g_main_loop_quit),
+                                         main_loop,
+                                         NULL,
+                                         G_CONNECT_SWAPPED);
+
+  g_main_loop_run (main_loop);
+
+  g_clear_signal_handler (&paint_handler, stage);
+}
+
+static void
+ensure_layout (ClutterActor *actor)
+{
+  ClutterActorBox box;
+
+  /* Retrieving the allocation runs any pending relayout of the stage */
+  clutter_actor_get_allocation_box (actor, &box);
+}
+
+static ClutterActor *
+create_wide_tree (ClutterActor *stage,
+                  int           n_children)
+{
+  ClutterActor *root;
+  int i;
+
+  root = clutter_actor_new ();
+  clutter_actor_set_layout_manager (root,
+                                    clutter_box_layout_new ());
+  clutter_actor_add_child (stage, root);
+
+  for (i = 0; i < n_children; i++)
+    {
+      ClutterActor *child = clutter_actor_new ();
+
+      clutter_actor_set_background_color (child, CLUTTER_COLOR_Red);
+      clutter_actor_set_size (child, 2, 2 + i % 8);
+      clutter_actor_add_child (root, child);
+    }
+
+  return root;
+}
+
+static ClutterActor *
+create_deep_tree (ClutterActor  *stage,
+                  int            depth,
+                  ClutterActor **leaf_out)
+{
+  ClutterActor *root;
+  ClutterActor *parent;
+  int i;
+
+  root = clutter_actor_new ();
+  clutter_actor_set_layout_manager (root, clutter_bin_layout_new ());
+  clutter_actor_add_child (stage, root);
+
+  parent = root;
+  for (i = 0; i < depth; i++)
+    {
+      ClutterActor *child = clutter_actor_new ();
+
+      clutter_actor_set_layout_manager (child, clutter_bin_layout_new ());
+      clutter_actor_add_child (parent, child);
+      parent = child;
+    }
+
+  clutter_actor_set_background_color (parent, CLUTTER_COLOR_Red);
+  clutter_actor_set_size (parent, 10, 10);
+  *leaf_out = parent;
+
+  return root;
+}
+
+static void
+bench_relayout_deep (ClutterActor *stage)
+{
+  ClutterActor *root, *leaf;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (500);
+  int i;
+
+  root = create_deep_tree (stage, TREE_DEPTH, &leaf);
+  ensure_layout (root);
+
+  bench_timer_start (&timer, "relayout-deep", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      clutter_actor_set_size (leaf, 10 + i % 2, 10);
+      ensure_layout (root);
+    }
+  bench_timer_report (&timer);
+
+  clutter_actor_destroy (root);
+}
+
+static void
+bench_relayout_wide (ClutterActor *stage)
+{
+  ClutterActor *root, *first_child;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (500);
+  int i;
+
+  root = create_wide_tree (stage, TREE_WIDTH);
+  first_child = clutter_actor_get_first_child (root);
+  ensure_layout (root);
+
+  bench_timer_start (&timer, "relayout-wide", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      clutter_actor_set_width (first_child, 2 + i % 2);
+      ensure_layout (root);
+    }
+  bench_timer_report (&timer);
+
+  clutter_actor_destroy (root);
+}
+
+static void
+bench_paint_volume (ClutterActor *stage)
+{
+  ClutterActor *root, *first_child;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (2000);
+  int i;
+
+  root = create_wide_tree (stage, TREE_WIDTH);
+  first_child = clutter_actor_get_first_child (root);
+  ensure_layout (root);
+
+  bench_timer_start (&timer, "paint-volume", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      /* Moving a child invalidates the paint volume of the container */
+      clutter_actor_set_translation (first_child, i % 2, 0.f, 0.f);
+      clutter_actor_get_paint_volume (root);
+    }
+  bench_timer_report (&timer);
+
+  clutter_actor_destroy (root);
+}
+
+static void
+bench_pick (ClutterActor *stage)
+{
+  ClutterActor *root;
+  BenchTimer timer;
+  float width, height;
+  int n_iterations = scaled_iterations (200);
+  int i;
+
+  clutter_actor_get_size (stage, &width, &height);
+
+  root = clutter_actor_new ();
+  clutter_actor_add_child (stage, root);
+
+  for (i = 0; i < N_PICK_ACTORS; i++)
+    {
+      ClutterActor *child = clutter_actor_new ();
+
+      clutter_actor_set_reactive (child, TRUE);
+      clutter_actor_set_position (child,
+                                  g_random_double_range (0, width - 20),
+                                  g_random_double_range (0, height - 20));
+      clutter_actor_set_size (child, 20, 20);
+      clutter_actor_add_child (root, child);
+    }
+
+  ensure_layout (root);
+
+  bench_timer_start (&timer, "pick", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      /* Move one actor so that the pick cannot be served from the
+       * previous pick stack */
+      clutter_actor_set_x (clutter_actor_get_first_child (root), i % 2);
+      clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                      CLUTTER_PICK_REACTIVE,
+                                      g_random_double_range (0, width),
+                                      g_random_double_range (0, height));
+    }
+  bench_timer_report (&timer);
+
+  clutter_actor_destroy (root);
+}
+
+static void
+bench_transitions (ClutterActor *stage)
+{
+  g_autoptr (GPtrArray) transitions = NULL;
+  ClutterActor *root;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (200);
+  int i, j;
+
+  root = clutter_actor_new ();
+  clutter_actor_add_child (stage, root);
+
+  transitions = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (i = 0; i < N_TRANSITIONS; i++)
+    {
+      ClutterActor *child = clutter_actor_new ();
+      ClutterTransition *transition;
+
+      clutter_actor_add_child (root, child);
+
+      transition = clutter_property_transition_new ("opacity");
+      clutter_transition_set_from (transition, G_TYPE_UINT, 0);
+      clutter_transition_set_to (transition, G_TYPE_UINT, 255);
+      clutter_timeline_set_duration (CLUTTER_TIMELINE (transition), 1000);
+      clutter_transition_set_animatable (transition,
+                                         CLUTTER_ANIMATABLE (child));
+      g_ptr_array_add (transitions, transition);
+    }
+
+  bench_timer_start (&timer, "transition-tick", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      unsigned int msecs = (i * 16) % 1000;
+
+      for (j = 0; j < transitions->len; j++)
+        {
+          ClutterTimeline *timeline = g_ptr_array_index (transitions, j);
+
+          clutter_timeline_advance (timeline, msecs);
+          g_signal_emit_by_name (timeline, "new-frame", msecs);
+        }
+    }
+  bench_timer_report (&timer);
+
+  clutter_actor_destroy (root);
+}
+
+static void
+bench_paint_nodes (ClutterActor *stage)
+{
+  ClutterActor *root;
+  CoglContext *ctx =
+    clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (GError) error = NULL;
+  MtkRectangle rect = { 0, 0, 256, 256 };
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (200);
+  int i;
+
+  root = create_wide_tree (stage, TREE_WIDTH);
+  ensure_layout (root);
+
+  texture = cogl_texture_2d_new_with_size (ctx, rect.width, rect.height);
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    g_error ("Failed to allocate framebuffer: %s", error->message);
+
+  bench_timer_start (&timer, "paint-nodes", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      clutter_stage_paint_to_framebuffer (CLUTTER_STAGE (stage),
+                                          COGL_FRAMEBUFFER (offscreen),
+                                          &rect, 1.f,
+                                          CLUTTER_PAINT_FLAG_NONE);
+    }
+  cogl_framebuffer_finish (COGL_FRAMEBUFFER (offscreen));
+  bench_timer_report (&timer);
+
+  clutter_actor_destroy (root);
+}
+
+static void
+bench_stage_redraw (ClutterActor *stage,
+                    const char   *name,
+                    int           damage_size)
+{
+  ClutterActor *root;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (100);
+  int i;
+
+  root = create_wide_tree (stage, TREE_WIDTH);
+  clutter_actor_queue_redraw (stage);
+  wait_for_paint (stage);
+
+  bench_timer_start (&timer, name, n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      if (damage_size > 0)
+        {
+          MtkRectangle clip = { i % 32, 0, damage_size, damage_size };
+
+          clutter_actor_queue_redraw_with_clip (stage, &clip);
+        }
+      else
+        {
+          clutter_actor_queue_redraw (stage);
+        }
+
+      wait_for_paint (stage);
+    }
+  bench_timer_report (&timer);
+
+  clutter_actor_destroy (root);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  ClutterActor *stage;
+  const char *scale;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  clutter_test_init (&argc, &argv);
+
+  scale = g_getenv ("CLUTTER_BENCHMARK_SCALE");
+  if (scale)
+    iteration_scale = MAX (g_ascii_strtod (scale, NULL), 0.01);
+
+  g_random_set_seed (12345678);
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_show (stage);
+  wait_for_paint (stage);
+
+  bench_relayout_deep (stage);
+  bench_relayout_wide (stage);
+  bench_paint_volume (stage);
+  bench_pick (stage);
+  bench_transitions (stage);
+  bench_paint_nodes (stage);
+  bench_stage_redraw (stage, "stage-redraw-full", 0);
+  bench_stage_redraw (stage, "stage-redraw-damage-256", 256);
+  bench_stage_redraw (stage, "stage-redraw-damage-16", 16);
+
+  return EXIT_SUCCESS;
+}
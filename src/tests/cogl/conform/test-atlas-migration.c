@@ -144,6 +144,35 @@ test_atlas_migration (void)
     g_print ("OK\n");
 }
 
+static void
+test_atlas_compaction (void)
+{
+  CoglTexture *textures[N_TEXTURES];
+  int tex_num;
+
+  /* Fill the atlas so that it has to grow */
+  for (tex_num = 0; tex_num < N_TEXTURES; tex_num++)
+    textures[tex_num] = create_texture (tex_num + 1);
+
+  /* Only keep a few of the smallest textures so that most of the atlas
+     is left unused and it gets compacted when idle */
+  for (tex_num = 16; tex_num < N_TEXTURES; tex_num++)
+    g_object_unref (textures[tex_num]);
+
+  while (g_main_context_iteration (NULL, FALSE));
+
+  /* The remaining textures should have been migrated intact */
+  for (tex_num = 0; tex_num < 16; tex_num++)
+    verify_texture (textures[tex_num], tex_num + 1);
+
+  for (tex_num = 0; tex_num < 16; tex_num++)
+    g_object_unref (textures[tex_num]);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
+
 COGL_TEST_SUITE (
   g_test_add_func ("/atlas-migration", test_atlas_migration);
+  g_test_add_func ("/atlas-migration/compaction", test_atlas_compaction);
 )
@@ -63,6 +63,85 @@ test_fence (void)
     g_print ("OK\n");
 }
 
+static void
+read_pixels_cb (GObject      *source_object,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  CoglBitmap **bitmap_out = user_data;
+  g_autoptr (GError) error = NULL;
+
+  *bitmap_out = cogl_framebuffer_read_pixels_finish (COGL_FRAMEBUFFER (source_object),
+                                                     result,
+                                                     &error);
+  g_assert_no_error (error);
+
+  g_main_loop_quit (loop);
+}
+
+static void
+test_fence_read_pixels_async (void)
+{
+  GSource *cogl_source;
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+  g_autoptr (CoglBitmap) bitmap = NULL;
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autofree uint8_t *pixels = NULL;
+  unsigned int timeout_id;
+  int rowstride;
+
+  cogl_source = cogl_glib_source_new (test_ctx, G_PRIORITY_DEFAULT);
+  g_source_attach (cogl_source, NULL);
+  loop = g_main_loop_new (NULL, TRUE);
+
+  cogl_framebuffer_orthographic (test_fb, 0, 0, fb_width, fb_height, -1, 100);
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR,
+                            0.0f, 0.0f, 1.0f, 1.0f);
+  /* Red top half so that a wrongly flipped read shows up */
+  pipeline = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (pipeline, 0xff, 0x00, 0x00, 0xff);
+  cogl_framebuffer_draw_rectangle (test_fb, pipeline,
+                                   0, 0, fb_width, fb_height / 2);
+
+  cogl_framebuffer_read_pixels_async (test_fb,
+                                      0, 0,
+                                      fb_width, fb_height,
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                      NULL,
+                                      read_pixels_cb,
+                                      &bitmap);
+
+  /* Anything drawn after the read was started must not end up in it */
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR,
+                            0.0f, 1.0f, 0.0f, 1.0f);
+
+  timeout_id = g_timeout_add_seconds (5, timeout, NULL);
+
+  g_main_loop_run (loop);
+
+  g_clear_handle_id (&timeout_id, g_source_remove);
+
+  g_assert_nonnull (bitmap);
+  g_assert_cmpint (cogl_bitmap_get_width (bitmap), ==, fb_width);
+  g_assert_cmpint (cogl_bitmap_get_height (bitmap), ==, fb_height);
+
+  /* Go through a texture to get at the contents of the bitmap */
+  texture = cogl_texture_2d_new_from_bitmap (bitmap);
+  rowstride = fb_width * 4;
+  pixels = g_malloc (rowstride * fb_height);
+  cogl_texture_get_data (texture, COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                         rowstride, pixels);
+
+  test_utils_compare_pixel (pixels, 0xff0000ff);
+  test_utils_compare_pixel (pixels + (fb_height - 1) * rowstride, 0x0000ffff);
+
+  if (cogl_test_verbose ())
+    g_print ("OK\n");
+}
+
 COGL_TEST_SUITE (
   g_test_add_func ("/fence", test_fence);
+  g_test_add_func ("/fence/read-pixels-async", test_fence_read_pixels_async);
 )
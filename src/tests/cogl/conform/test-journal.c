@@ -44,6 +44,100 @@ test_journal_unref_flush (void)
   g_object_unref (texture);
 }
 
+static void
+test_journal_reorder (void)
+{
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+  CoglPipeline *red;
+  CoglPipeline *green;
+  CoglTexture *texture;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0, fb_width, fb_height,
+                                 -1, 100);
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  red = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (red, 0xff, 0x00, 0x00, 0xff);
+
+  /* Use a texture so that the two pipelines can't be batched together */
+  texture = test_utils_create_color_texture (test_ctx, 0x00ff00ff);
+  green = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_layer_texture (green, 0, texture);
+
+  /* The third rectangle doesn't overlap the second one and may be moved
+   * in front of it, the fourth one does and has to stay on top */
+  cogl_framebuffer_draw_rectangle (test_fb, red, 0, 0, 50, 50);
+  cogl_framebuffer_draw_rectangle (test_fb, green, 25, 0, 75, 50);
+  cogl_framebuffer_draw_rectangle (test_fb, red, 100, 0, 150, 50);
+  cogl_framebuffer_draw_rectangle (test_fb, red, 50, 10, 60, 20);
+
+  test_utils_check_region (test_fb, 1, 1, 23, 48, 0xff0000ff);
+  test_utils_check_region (test_fb, 26, 21, 48, 28, 0x00ff00ff);
+  test_utils_check_region (test_fb, 51, 11, 8, 8, 0xff0000ff);
+  test_utils_check_region (test_fb, 101, 1, 48, 48, 0xff0000ff);
+
+  g_object_unref (green);
+  g_object_unref (texture);
+  g_object_unref (red);
+}
+
+static void
+test_journal_reorder_textures (void)
+{
+  int fb_width = cogl_framebuffer_get_width (test_fb);
+  int fb_height = cogl_framebuffer_get_height (test_fb);
+  CoglPipeline *red;
+  CoglPipeline *green;
+  CoglPipeline *blue;
+  CoglTexture *green_texture;
+  CoglTexture *blue_texture;
+
+  cogl_framebuffer_orthographic (test_fb,
+                                 0, 0, fb_width, fb_height,
+                                 -1, 100);
+  cogl_framebuffer_clear4f (test_fb, COGL_BUFFER_BIT_COLOR, 0, 0, 0, 1);
+
+  red = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_color4ub (red, 0xff, 0x00, 0x00, 0xff);
+
+  /* The two textured pipelines only differ by their texture */
+  green_texture = test_utils_create_color_texture (test_ctx, 0x00ff00ff);
+  green = cogl_pipeline_new (test_ctx);
+  cogl_pipeline_set_layer_texture (green, 0, green_texture);
+
+  blue_texture = test_utils_create_color_texture (test_ctx, 0x0000ffff);
+  blue = cogl_pipeline_copy (green);
+  cogl_pipeline_set_layer_texture (blue, 0, blue_texture);
+
+  /* Each textured rectangle has a red one on top of it. The blue
+   * rectangle may be drawn straight after the green one, but the last
+   * green rectangle overlaps the red one before it and has to stay on
+   * top of it */
+  cogl_framebuffer_draw_rectangle (test_fb, green, 0, 0, 50, 50);
+  cogl_framebuffer_draw_rectangle (test_fb, red, 10, 10, 20, 20);
+  cogl_framebuffer_draw_rectangle (test_fb, blue, 100, 0, 150, 50);
+  cogl_framebuffer_draw_rectangle (test_fb, red, 110, 10, 120, 20);
+  cogl_framebuffer_draw_rectangle (test_fb, red, 200, 0, 220, 20);
+  cogl_framebuffer_draw_rectangle (test_fb, green, 210, 10, 230, 30);
+
+  test_utils_check_region (test_fb, 21, 21, 28, 28, 0x00ff00ff);
+  test_utils_check_region (test_fb, 11, 11, 8, 8, 0xff0000ff);
+  test_utils_check_region (test_fb, 121, 21, 28, 28, 0x0000ffff);
+  test_utils_check_region (test_fb, 111, 11, 8, 8, 0xff0000ff);
+  test_utils_check_region (test_fb, 201, 1, 8, 8, 0xff0000ff);
+  test_utils_check_region (test_fb, 211, 11, 18, 18, 0x00ff00ff);
+
+  g_object_unref (blue);
+  g_object_unref (blue_texture);
+  g_object_unref (green);
+  g_object_unref (green_texture);
+  g_object_unref (red);
+}
+
 COGL_TEST_SUITE (
   g_test_add_func ("/journal/unref-flush", test_journal_unref_flush);
+  g_test_add_func ("/journal/reorder", test_journal_reorder);
+  g_test_add_func ("/journal/reorder-textures", test_journal_reorder_textures);
 )
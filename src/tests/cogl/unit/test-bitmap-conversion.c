@@ -0,0 +1,220 @@
+#include "config.h"
+
+#include "cogl/cogl.h"
+#include "cogl/cogl-bitmap-private.h"
+#include "cogl/cogl-cpu-caps.h"
+#include "cogl/cogl-half-float.h"
+#include "tests/cogl-test-utils.h"
+
+/* Not a multiple of any of the vector widths so the scalar tails get
+ * exercised too */
+#define WIDTH 37
+#define HEIGHT 3
+
+typedef struct
+{
+  CoglPixelFormat format;
+  int offsets[4];
+} FormatLayout;
+
+static const FormatLayout layouts[] =
+  {
+    { COGL_PIXEL_FORMAT_RGBA_8888, { 0, 1, 2, 3 } },
+    { COGL_PIXEL_FORMAT_BGRA_8888, { 2, 1, 0, 3 } },
+    { COGL_PIXEL_FORMAT_ARGB_8888, { 1, 2, 3, 0 } },
+    { COGL_PIXEL_FORMAT_ABGR_8888, { 3, 2, 1, 0 } },
+  };
+
+static uint8_t
+premult_component (uint8_t c,
+                   uint8_t alpha)
+{
+  unsigned int t = c * alpha + 128;
+
+  return ((t >> 8) + t) >> 8;
+}
+
+static void
+check_conversion (const FormatLayout *src_layout,
+                  gboolean            src_premult,
+                  const FormatLayout *dst_layout,
+                  gboolean            dst_premult)
+{
+  CoglPixelFormat src_format = src_layout->format;
+  CoglPixelFormat dst_format = dst_layout->format;
+  uint8_t src_data[WIDTH * HEIGHT * 4];
+  uint8_t dst_data[WIDTH * HEIGHT * 4];
+  g_autoptr (CoglBitmap) src_bmp = NULL;
+  g_autoptr (CoglBitmap) dst_bmp = NULL;
+  g_autoptr (GError) error = NULL;
+  int i, c;
+
+  if (src_premult)
+    src_format |= COGL_PREMULT_BIT;
+  if (dst_premult)
+    dst_format |= COGL_PREMULT_BIT;
+
+  for (i = 0; i < WIDTH * HEIGHT; i++)
+    {
+      uint8_t *p = src_data + i * 4;
+      uint8_t alpha = g_test_rand_int_range (0, 256);
+
+      p[src_layout->offsets[3]] = alpha;
+
+      for (c = 0; c < 3; c++)
+        {
+          /* Premultiplied components can't be larger than the alpha */
+          p[src_layout->offsets[c]] =
+            g_test_rand_int_range (0, (src_premult ? alpha : 255) + 1);
+        }
+    }
+
+  src_bmp = cogl_bitmap_new_for_data (test_ctx, WIDTH, HEIGHT,
+                                      src_format, WIDTH * 4,
+                                      src_data);
+  dst_bmp = cogl_bitmap_new_for_data (test_ctx, WIDTH, HEIGHT,
+                                      dst_format, WIDTH * 4,
+                                      dst_data);
+
+  g_assert_true (_cogl_bitmap_convert_into_bitmap (src_bmp, dst_bmp, &error));
+  g_assert_no_error (error);
+
+  for (i = 0; i < WIDTH * HEIGHT; i++)
+    {
+      const uint8_t *src = src_data + i * 4;
+      const uint8_t *dst = dst_data + i * 4;
+      uint8_t alpha = src[src_layout->offsets[3]];
+
+      g_assert_cmpuint (dst[dst_layout->offsets[3]], ==, alpha);
+
+      for (c = 0; c < 3; c++)
+        {
+          uint8_t expected = src[src_layout->offsets[c]];
+
+          if (!src_premult && dst_premult)
+            expected = premult_component (expected, alpha);
+          else if (src_premult && !dst_premult)
+            expected = alpha == 0 ? 0 : expected * 255 / alpha;
+
+          g_assert_cmpuint (dst[dst_layout->offsets[c]], ==, expected);
+        }
+    }
+}
+
+static void
+test_convert_8888 (void)
+{
+  CoglCpuCaps saved_caps;
+  int pass, src, dst, premult;
+
+  cogl_init_cpu_caps ();
+  saved_caps = cogl_cpu_caps;
+
+  /* Run once with whatever the CPU supports and once with the optional
+   * instruction sets masked out so every kernel gets exercised */
+  for (pass = 0; pass < 2; pass++)
+    {
+      if (pass == 1)
+        cogl_cpu_caps &= ~(COGL_CPU_CAP_AVX2 | COGL_CPU_CAP_SSSE3);
+
+      for (src = 0; src < G_N_ELEMENTS (layouts); src++)
+        for (dst = 0; dst < G_N_ELEMENTS (layouts); dst++)
+          for (premult = 0; premult < 4; premult++)
+            check_conversion (&layouts[src], premult & 1,
+                              &layouts[dst], premult & 2);
+    }
+
+  cogl_cpu_caps = saved_caps;
+}
+
+static void
+test_premult_2101010 (void)
+{
+  uint32_t src_data[2], dst_data[2];
+  g_autoptr (CoglBitmap) src_bmp = NULL;
+  g_autoptr (CoglBitmap) dst_bmp = NULL;
+  g_autoptr (GError) error = NULL;
+
+  /* An opaque white pixel followed by a transparent one. Every pixel
+   * needs to be premultiplied, not just the first one */
+  src_data[0] = (3u << 30) | (0x3ff << 20) | (0x3ff << 10) | 0x3ff;
+  src_data[1] = (0x3ff << 20) | (0x3ff << 10) | 0x3ff;
+
+  src_bmp = cogl_bitmap_new_for_data (test_ctx, 2, 1,
+                                      COGL_PIXEL_FORMAT_ABGR_2101010,
+                                      sizeof (src_data),
+                                      (uint8_t *) src_data);
+  dst_bmp = cogl_bitmap_new_for_data (test_ctx, 2, 1,
+                                      COGL_PIXEL_FORMAT_ABGR_2101010_PRE,
+                                      sizeof (dst_data),
+                                      (uint8_t *) dst_data);
+
+  g_assert_true (_cogl_bitmap_convert_into_bitmap (src_bmp, dst_bmp, &error));
+  g_assert_no_error (error);
+
+  g_assert_cmphex (dst_data[0], ==, src_data[0]);
+  g_assert_cmphex (dst_data[1], ==, 0);
+}
+
+static void
+test_convert_half_float (void)
+{
+  float src_data[WIDTH * 4], dst_data[WIDTH * 4];
+  uint16_t half_data[WIDTH * 4];
+  CoglCpuCaps saved_caps;
+  int pass, i;
+
+  cogl_init_cpu_caps ();
+  saved_caps = cogl_cpu_caps;
+
+  for (i = 0; i < WIDTH * 4; i++)
+    src_data[i] = g_test_rand_double_range (0.0, 1.0);
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      g_autoptr (CoglBitmap) src_bmp = NULL;
+      g_autoptr (CoglBitmap) half_bmp = NULL;
+      g_autoptr (CoglBitmap) dst_bmp = NULL;
+      g_autoptr (GError) error = NULL;
+
+      if (pass == 1)
+        cogl_cpu_caps &= ~COGL_CPU_CAP_F16C;
+
+      src_bmp = cogl_bitmap_new_for_data (test_ctx, WIDTH, 1,
+                                          COGL_PIXEL_FORMAT_RGBA_FP_32323232,
+                                          sizeof (src_data),
+                                          (uint8_t *) src_data);
+      half_bmp = cogl_bitmap_new_for_data (test_ctx, WIDTH, 1,
+                                           COGL_PIXEL_FORMAT_RGBA_FP_16161616,
+                                           sizeof (half_data),
+                                           (uint8_t *) half_data);
+      dst_bmp = cogl_bitmap_new_for_data (test_ctx, WIDTH, 1,
+                                          COGL_PIXEL_FORMAT_RGBA_FP_32323232,
+                                          sizeof (dst_data),
+                                          (uint8_t *) dst_data);
+
+      g_assert_true (_cogl_bitmap_convert_into_bitmap (src_bmp, half_bmp,
+                                                       &error));
+      g_assert_no_error (error);
+      g_assert_true (_cogl_bitmap_convert_into_bitmap (half_bmp, dst_bmp,
+                                                       &error));
+      g_assert_no_error (error);
+
+      for (i = 0; i < WIDTH * 4; i++)
+        {
+          g_assert_cmphex (half_data[i], ==,
+                           cogl_float_to_half_slow (src_data[i]));
+          g_assert_cmpfloat (dst_data[i], ==,
+                             cogl_half_to_float_slow (half_data[i]));
+        }
+    }
+
+  cogl_cpu_caps = saved_caps;
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/bitmap-conversion/8888", test_convert_8888);
+  g_test_add_func ("/bitmap-conversion/half-float", test_convert_half_float);
+  g_test_add_func ("/bitmap-conversion/premult-2101010",
+                   test_premult_2101010);
+)
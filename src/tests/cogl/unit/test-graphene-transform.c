@@ -0,0 +1,106 @@
+#include "config.h"
+
+#include "cogl/cogl-cpu-caps.h"
+#include "cogl/cogl-graphene.h"
+#include "tests/cogl-test-utils.h"
+
+#define N_POINTS 7
+
+/* Vertices interleaved with other data, like in the journal */
+#define STRIDE_IN 3
+#define STRIDE_OUT 5
+
+static void
+check_transform_points_f2 (const graphene_matrix_t *matrix)
+{
+  float points_in[N_POINTS * STRIDE_IN];
+  float points_out[N_POINTS * STRIDE_OUT];
+  float in_place[N_POINTS * 4];
+  int i;
+
+  for (i = 0; i < N_POINTS * STRIDE_IN; i++)
+    points_in[i] = g_test_rand_double_range (-1000.0, 1000.0);
+  for (i = 0; i < N_POINTS * STRIDE_OUT; i++)
+    points_out[i] = -1.f;
+  for (i = 0; i < N_POINTS; i++)
+    {
+      in_place[i * 4] = points_in[i * STRIDE_IN];
+      in_place[i * 4 + 1] = points_in[i * STRIDE_IN + 1];
+      in_place[i * 4 + 2] = 0.f;
+      in_place[i * 4 + 3] = -1.f;
+    }
+
+  cogl_graphene_matrix_transform_points (matrix,
+                                         2,
+                                         sizeof (float) * STRIDE_IN,
+                                         points_in,
+                                         sizeof (float) * STRIDE_OUT,
+                                         points_out,
+                                         N_POINTS);
+  cogl_graphene_matrix_transform_points (matrix,
+                                         2,
+                                         sizeof (float) * 4,
+                                         in_place,
+                                         sizeof (float) * 4,
+                                         in_place,
+                                         N_POINTS);
+
+  for (i = 0; i < N_POINTS; i++)
+    {
+      graphene_point3d_t p, expected;
+      const float *o = points_out + i * STRIDE_OUT;
+      const float *o_in_place = in_place + i * 4;
+
+      graphene_point3d_init (&p,
+                             points_in[i * STRIDE_IN],
+                             points_in[i * STRIDE_IN + 1],
+                             0.f);
+      graphene_matrix_transform_point3d (matrix, &p, &expected);
+
+      g_assert_cmpfloat_with_epsilon (o[0], expected.x, 0.01);
+      g_assert_cmpfloat_with_epsilon (o[1], expected.y, 0.01);
+      g_assert_cmpfloat_with_epsilon (o[2], expected.z, 0.01);
+
+      /* Anything past the third component must be left alone */
+      g_assert_cmpfloat (o[3], ==, -1.f);
+      g_assert_cmpfloat (o[4], ==, -1.f);
+
+      g_assert_cmpfloat_with_epsilon (o_in_place[0], expected.x, 0.01);
+      g_assert_cmpfloat_with_epsilon (o_in_place[1], expected.y, 0.01);
+      g_assert_cmpfloat_with_epsilon (o_in_place[2], expected.z, 0.01);
+      g_assert_cmpfloat (o_in_place[3], ==, -1.f);
+    }
+}
+
+static void
+test_transform_points (void)
+{
+  CoglCpuCaps saved_caps;
+  graphene_matrix_t matrix;
+  int pass;
+
+  cogl_init_cpu_caps ();
+  saved_caps = cogl_cpu_caps;
+
+  graphene_matrix_init_identity (&matrix);
+  graphene_matrix_rotate_z (&matrix, 30.f);
+  graphene_matrix_scale (&matrix, 2.f, 0.5f, 1.f);
+  graphene_matrix_translate (&matrix,
+                             &GRAPHENE_POINT3D_INIT (100.f, -20.f, 3.f));
+
+  /* Run once with whatever the CPU supports and once with the optional
+   * instruction sets masked out so every kernel gets exercised */
+  for (pass = 0; pass < 2; pass++)
+    {
+      if (pass == 1)
+        cogl_cpu_caps &= ~COGL_CPU_CAP_AVX2;
+
+      check_transform_points_f2 (&matrix);
+    }
+
+  cogl_cpu_caps = saved_caps;
+}
+
+COGL_TEST_SUITE_MINIMAL (
+  g_test_add_func ("/graphene/transform-points", test_transform_points);
+)
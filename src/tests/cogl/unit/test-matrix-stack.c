@@ -0,0 +1,116 @@
+#include "config.h"
+
+#include <cogl/cogl.h>
+
+#include "tests/cogl-test-utils.h"
+
+static void
+build_stack (CoglMatrixStack *stack,
+             float            x)
+{
+  cogl_matrix_stack_push (stack);
+  cogl_matrix_stack_translate (stack, x, 2.f, 0.f);
+  cogl_matrix_stack_scale (stack, 2.f, 2.f, 1.f);
+}
+
+static void
+test_matrix_stack_intern (void)
+{
+  g_autoptr (CoglMatrixStack) stack0 = cogl_matrix_stack_new (test_ctx);
+  g_autoptr (CoglMatrixStack) stack1 = cogl_matrix_stack_new (test_ctx);
+  g_autoptr (CoglMatrixStack) stack2 = cogl_matrix_stack_new (test_ctx);
+  graphene_matrix_t matrix0;
+  graphene_matrix_t matrix1;
+
+  build_stack (stack0, 1.f);
+  build_stack (stack1, 1.f);
+  build_stack (stack2, 3.f);
+
+  /* Identical operations on identical parents share their entries */
+  g_assert_true (cogl_matrix_stack_get_entry (stack0) ==
+                 cogl_matrix_stack_get_entry (stack1));
+  g_assert_false (cogl_matrix_stack_get_entry (stack0) ==
+                  cogl_matrix_stack_get_entry (stack2));
+
+  /* Changing one stack must not affect the other */
+  cogl_matrix_stack_pop (stack1);
+  cogl_matrix_stack_translate (stack1, 5.f, 0.f, 0.f);
+
+  cogl_matrix_stack_get (stack0, &matrix0);
+  g_assert_cmpfloat_with_epsilon (graphene_matrix_get_x_translation (&matrix0),
+                                  1.f, FLT_EPSILON);
+  g_assert_cmpfloat_with_epsilon (graphene_matrix_get_x_scale (&matrix0),
+                                  2.f, FLT_EPSILON);
+
+  cogl_matrix_stack_get (stack1, &matrix1);
+  g_assert_cmpfloat_with_epsilon (graphene_matrix_get_x_translation (&matrix1),
+                                  5.f, FLT_EPSILON);
+  g_assert_cmpfloat_with_epsilon (graphene_matrix_get_x_scale (&matrix1),
+                                  1.f, FLT_EPSILON);
+
+  /* Dropping the last user of an entry lets an identical one be built
+   * again from scratch */
+  g_clear_object (&stack0);
+  g_clear_object (&stack2);
+  build_stack (stack1, 1.f);
+
+  cogl_matrix_stack_get (stack1, &matrix1);
+  g_assert_cmpfloat_with_epsilon (graphene_matrix_get_x_translation (&matrix1),
+                                  6.f, FLT_EPSILON);
+}
+
+static void
+test_matrix_stack_composite (void)
+{
+  g_autoptr (CoglMatrixStack) stack = cogl_matrix_stack_new (test_ctx);
+  graphene_matrix_t expected;
+  graphene_matrix_t matrix;
+  graphene_matrix_t inverse;
+  graphene_matrix_t product;
+  graphene_matrix_t identity;
+  CoglMatrixEntry *entry;
+
+  cogl_matrix_stack_translate (stack, 10.f, 20.f, 0.f);
+  cogl_matrix_stack_push (stack);
+  cogl_matrix_stack_rotate (stack, 30.f, 0.f, 0.f, 1.f);
+  cogl_matrix_stack_scale (stack, 2.f, 4.f, 1.f);
+
+  /* Graphene applies operations in the order they are added, which is
+   * the reverse of the order they were pushed in */
+  graphene_matrix_init_scale (&expected, 2.f, 4.f, 1.f);
+  graphene_matrix_rotate (&expected, 30.f, graphene_vec3_z_axis ());
+  graphene_matrix_translate (&expected,
+                             &GRAPHENE_POINT3D_INIT (10.f, 20.f, 0.f));
+
+  entry = cogl_matrix_stack_get_entry (stack);
+
+  /* The second query is served from the cached composition */
+  cogl_matrix_entry_get (entry, &matrix);
+  g_assert_true (graphene_matrix_near (&matrix, &expected, 0.0001f));
+  cogl_matrix_entry_get (entry, &matrix);
+  g_assert_true (graphene_matrix_near (&matrix, &expected, 0.0001f));
+
+  g_assert_true (cogl_matrix_entry_get_inverse (entry, &inverse));
+  graphene_matrix_multiply (&matrix, &inverse, &product);
+  graphene_matrix_init_identity (&identity);
+  g_assert_true (graphene_matrix_near (&product, &identity, 0.0001f));
+
+  g_assert_true (cogl_matrix_stack_get_inverse (stack, &matrix));
+  g_assert_true (graphene_matrix_near (&matrix, &inverse, 0.0001f));
+
+  /* Composing a child reuses the cached parent */
+  cogl_matrix_stack_translate (stack, 1.f, 0.f, 0.f);
+  graphene_matrix_init_translate (&product,
+                                  &GRAPHENE_POINT3D_INIT (1.f, 0.f, 0.f));
+  graphene_matrix_multiply (&product, &expected, &expected);
+  cogl_matrix_stack_get (stack, &matrix);
+  g_assert_true (graphene_matrix_near (&matrix, &expected, 0.0001f));
+
+  cogl_matrix_stack_scale (stack, 0.f, 1.f, 1.f);
+  g_assert_false (cogl_matrix_stack_get_inverse (stack, &inverse));
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/matrix-stack/intern", test_matrix_stack_intern);
+  g_test_add_func ("/matrix-stack/composite", test_matrix_stack_composite);
+)
@@ -0,0 +1,471 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Benchmarks the compositing path of a headless compositor.
+ *
+ * Every scenario maps a fixed set of continuously redrawing windows from
+ * the compositor-bench-client Wayland client onto a 1920x1080 virtual
+ * monitor. Interactive scenarios additionally move or resize the first
+ * window with a pointer grab driven by a virtual pointer, one motion per
+ * painted frame. Once the client is done, the frame records of the view
+ * and the CPU time of the compositor are summarized as a line of JSON, e.g.
+ *
+ *   {"benchmark": "compositor", "scenario": "windows", "buffer-type": "shm", "windows": 16, "subsurfaces": 0, "frames": 120, "frame-interval-avg-usec": 16667, "frame-interval-max-usec": 16700, "missed-vblanks": 0, "paint-avg-usec": 812, "gpu-avg-usec": 0, "input-latency-avg-usec": 0, "input-latency-max-usec": 0, "cpu-usec": 123456}
+ *
+ * Scenarios using dma-buf buffers are skipped when the client can't
+ * allocate them. The number of frames can be scaled with
+ * MUTTER_BENCHMARK_SCALE, but only the most recent
+ * CLUTTER_STAGE_VIEW_N_FRAME_RECORDS frames are summarized.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+#include <linux/input-event-codes.h>
+#include <math.h>
+#include <sys/resource.h>
+
+#include "backends/meta-backend-private.h"
+#include "clutter/clutter-stage-view-private.h"
+#include "meta/meta-wayland-compositor.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-test-utils.h"
+#include "tests/meta-wayland-test-utils.h"
+#include "wayland/meta-wayland.h"
+
+#define N_FRAMES 120
+#define EXIT_SKIP 77
+
+#define MONITOR_WIDTH 1920
+#define MONITOR_HEIGHT 1080
+#define MOTION_AMPLITUDE 200.0
+
+typedef enum _BenchInteraction
+{
+  BENCH_INTERACTION_NONE,
+  BENCH_INTERACTION_MOVE,
+  BENCH_INTERACTION_RESIZE,
+} BenchInteraction;
+
+typedef struct _BenchConfig
+{
+  const char *scenario;
+  const char *buffer_type;
+  int n_windows;
+  int n_subsurfaces;
+  int width;
+  int height;
+  BenchInteraction interaction;
+} BenchConfig;
+
+static const BenchConfig bench_configs[] = {
+  { "windows", "shm", 1, 0, 640, 480, BENCH_INTERACTION_NONE },
+  { "windows", "shm", 16, 0, 480, 270, BENCH_INTERACTION_NONE },
+  { "windows", "dma-buf", 1, 0, 640, 480, BENCH_INTERACTION_NONE },
+  { "windows", "dma-buf", 16, 0, 480, 270, BENCH_INTERACTION_NONE },
+  { "subsurfaces", "shm", 1, 64, 640, 480, BENCH_INTERACTION_NONE },
+  { "subsurfaces", "shm", 4, 64, 640, 480, BENCH_INTERACTION_NONE },
+  { "move", "shm", 1, 0, 640, 480, BENCH_INTERACTION_MOVE },
+  { "resize", "shm", 1, 0, 640, 480, BENCH_INTERACTION_RESIZE },
+};
+
+typedef struct _BenchRun
+{
+  const BenchConfig *config;
+
+  GSubprocess *subprocess;
+  gboolean finished;
+
+  ClutterVirtualInputDevice *virtual_pointer;
+  graphene_point_t anchor;
+  int n_motions;
+} BenchRun;
+
+static MetaContext *test_context;
+static int n_frames = N_FRAMES;
+
+static int64_t
+get_cpu_time_us (void)
+{
+  struct rusage usage;
+
+  g_assert_cmpint (getrusage (RUSAGE_SELF, &usage), ==, 0);
+
+  return ((usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * G_USEC_PER_SEC +
+          usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static ClutterStageView *
+get_view (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  GList *views;
+
+  views = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage));
+  g_assert_cmpuint (g_list_length (views), ==, 1);
+
+  return views->data;
+}
+
+static int64_t
+get_last_frame_count (ClutterStageView *view)
+{
+  ClutterFrameRecord record;
+
+  if (clutter_stage_view_get_frame_records (view, &record, 1) == 0)
+    return -1;
+
+  return record.frame_count;
+}
+
+static void
+bench_client_exited (GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  BenchRun *run = user_data;
+  g_autoptr (GError) error = NULL;
+
+  if (!g_subprocess_wait_finish (G_SUBPROCESS (source_object),
+                                 result,
+                                 &error))
+    g_error ("Failed to wait for compositor benchmark client: %s",
+             error->message);
+
+  run->finished = TRUE;
+}
+
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame,
+                BenchRun         *run)
+{
+  double phase;
+
+  if (run->finished)
+    return;
+
+  run->n_motions++;
+  phase = run->n_motions * G_PI / 30.0;
+
+  clutter_virtual_input_device_notify_absolute_motion (
+    run->virtual_pointer,
+    g_get_monotonic_time (),
+    run->anchor.x + MOTION_AMPLITUDE * sin (phase),
+    run->anchor.y + MOTION_AMPLITUDE * (1.0 - cos (phase)) / 2.0);
+}
+
+static void
+begin_interaction (BenchRun *run)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterSeat *seat = meta_backend_get_default_seat (backend);
+  MetaWindow *window;
+  MtkRectangle frame_rect;
+  MetaGrabOp grab_op;
+
+  window = meta_wait_for_client_window (test_context, "bench-0");
+  while (meta_window_is_hidden (window))
+    g_main_context_iteration (NULL, TRUE);
+  meta_wait_for_paint (test_context);
+
+  meta_window_move_frame (window, FALSE, 100, 100);
+  meta_window_get_frame_rect (window, &frame_rect);
+
+  switch (run->config->interaction)
+    {
+    case BENCH_INTERACTION_MOVE:
+      run->anchor.x = frame_rect.x + frame_rect.width / 2.0;
+      run->anchor.y = frame_rect.y + frame_rect.height / 2.0;
+      grab_op = META_GRAB_OP_MOVING;
+      break;
+    case BENCH_INTERACTION_RESIZE:
+      run->anchor.x = frame_rect.x + frame_rect.width - 1;
+      run->anchor.y = frame_rect.y + frame_rect.height - 1;
+      grab_op = META_GRAB_OP_RESIZING_SE;
+      break;
+    case BENCH_INTERACTION_NONE:
+    default:
+      g_assert_not_reached ();
+    }
+
+  run->virtual_pointer =
+    clutter_seat_create_virtual_device (seat, CLUTTER_POINTER_DEVICE);
+  clutter_virtual_input_device_notify_absolute_motion (run->virtual_pointer,
+                                                       g_get_monotonic_time (),
+                                                       run->anchor.x,
+                                                       run->anchor.y);
+  meta_flush_input (test_context);
+
+  g_assert_true (meta_window_begin_grab_op (window, grab_op,
+                                            clutter_seat_get_pointer (seat),
+                                            NULL,
+                                            meta_display_get_current_time_roundtrip (
+                                              meta_window_get_display (window))));
+
+  g_signal_connect (meta_backend_get_stage (backend), "after-paint",
+                    G_CALLBACK (on_after_paint), run);
+}
+
+static void
+end_interaction (BenchRun *run)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+
+  g_signal_handlers_disconnect_by_func (meta_backend_get_stage (backend),
+                                        on_after_paint, run);
+
+  /* The grab normally ends with the window, but be explicit about it */
+  clutter_virtual_input_device_notify_button (run->virtual_pointer,
+                                              g_get_monotonic_time (),
+                                              BTN_LEFT,
+                                              CLUTTER_BUTTON_STATE_PRESSED);
+  clutter_virtual_input_device_notify_button (run->virtual_pointer,
+                                              g_get_monotonic_time (),
+                                              BTN_LEFT,
+                                              CLUTTER_BUTTON_STATE_RELEASED);
+  meta_flush_input (test_context);
+
+  g_clear_object (&run->virtual_pointer);
+}
+
+static void
+print_results (const BenchConfig *config,
+               ClutterStageView  *view,
+               int64_t            first_frame_count,
+               int64_t            cpu_time_us)
+{
+  g_autofree ClutterFrameRecord *records = NULL;
+  int64_t last_presentation_time_us = 0;
+  int64_t total_interval_us = 0;
+  int64_t max_interval_us = 0;
+  int64_t total_paint_us = 0;
+  int64_t total_gpu_us = 0;
+  int64_t total_latency_us = 0;
+  int64_t max_latency_us = 0;
+  int n_records;
+  int n_measured = 0;
+  int n_intervals = 0;
+  int n_latencies = 0;
+  int n_missed = 0;
+  int i;
+
+  records = g_new0 (ClutterFrameRecord, CLUTTER_STAGE_VIEW_N_FRAME_RECORDS);
+  n_records = clutter_stage_view_get_frame_records (view, records,
+                                                    CLUTTER_STAGE_VIEW_N_FRAME_RECORDS);
+
+  for (i = 0; i < n_records; i++)
+    {
+      ClutterFrameRecord *record = &records[i];
+
+      if (record->frame_count <= first_frame_count)
+        continue;
+
+      n_measured++;
+      total_paint_us += record->paint_duration_us;
+      total_gpu_us += record->gpu_duration_us;
+
+      if (record->missed_vblank)
+        n_missed++;
+
+      if (!record->is_presented)
+        continue;
+
+      if (last_presentation_time_us)
+        {
+          int64_t interval_us =
+            record->presentation_time_us - last_presentation_time_us;
+
+          total_interval_us += interval_us;
+          max_interval_us = MAX (max_interval_us, interval_us);
+          n_intervals++;
+        }
+      last_presentation_time_us = record->presentation_time_us;
+
+      if (record->input_time_us)
+        {
+          int64_t latency_us =
+            record->presentation_time_us - record->input_time_us;
+
+          total_latency_us += latency_us;
+          max_latency_us = MAX (max_latency_us, latency_us);
+          n_latencies++;
+        }
+    }
+
+  g_print ("{\"benchmark\": \"compositor\", "
+           "\"scenario\": \"%s\", \"buffer-type\": \"%s\", "
+           "\"windows\": %d, \"subsurfaces\": %d, "
+           "\"frames\": %d, "
+           "\"frame-interval-avg-usec\": %" G_GINT64_FORMAT ", "
+           "\"frame-interval-max-usec\": %" G_GINT64_FORMAT ", "
+           "\"missed-vblanks\": %d, "
+           "\"paint-avg-usec\": %" G_GINT64_FORMAT ", "
+           "\"gpu-avg-usec\": %" G_GINT64_FORMAT ", "
+           "\"input-latency-avg-usec\": %" G_GINT64_FORMAT ", "
+           "\"input-latency-max-usec\": %" G_GINT64_FORMAT ", "
+           "\"cpu-usec\": %" G_GINT64_FORMAT "}\n",
+           config->scenario, config->buffer_type,
+           config->n_windows, config->n_subsurfaces,
+           n_measured,
+           n_intervals ? total_interval_us / n_intervals : 0,
+           max_interval_us,
+           n_missed,
+           n_measured ? total_paint_us / n_measured : 0,
+           n_measured ? total_gpu_us / n_measured : 0,
+           n_latencies ? total_latency_us / n_latencies : 0,
+           max_latency_us,
+           cpu_time_us);
+}
+
+static void
+run_bench (gconstpointer user_data)
+{
+  const BenchConfig *config = user_data;
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (test_context);
+  g_autoptr (MetaVirtualMonitor) virtual_monitor = NULL;
+  g_autoptr (GSubprocessLauncher) launcher = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *client_path = NULL;
+  g_autofree char *windows = NULL;
+  g_autofree char *subsurfaces = NULL;
+  g_autofree char *frames = NULL;
+  g_autofree char *width = NULL;
+  g_autofree char *height = NULL;
+  BenchRun run = { .config = config };
+  ClutterStageView *view;
+  int64_t first_frame_count;
+  int64_t start_cpu_time_us;
+  int64_t cpu_time_us;
+
+  virtual_monitor = meta_create_test_monitor (test_context,
+                                              MONITOR_WIDTH, MONITOR_HEIGHT,
+                                              60.0);
+  meta_wait_for_paint (test_context);
+
+  view = get_view ();
+  first_frame_count = get_last_frame_count (view);
+
+  client_path = g_test_build_filename (G_TEST_BUILT,
+                                       "src",
+                                       "tests",
+                                       "wayland-test-clients",
+                                       "compositor-bench-client",
+                                       NULL);
+  windows = g_strdup_printf ("%d", config->n_windows);
+  subsurfaces = g_strdup_printf ("%d", config->n_subsurfaces);
+  frames = g_strdup_printf ("%d", n_frames);
+  width = g_strdup_printf ("%d", config->width);
+  height = g_strdup_printf ("%d", config->height);
+
+  launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_NONE);
+  g_subprocess_launcher_setenv (launcher,
+                                "WAYLAND_DISPLAY",
+                                meta_wayland_get_wayland_display_name (compositor),
+                                TRUE);
+
+  start_cpu_time_us = get_cpu_time_us ();
+
+  run.subprocess = g_subprocess_launcher_spawn (launcher,
+                                                &error,
+                                                client_path,
+                                                "--windows", windows,
+                                                "--subsurfaces", subsurfaces,
+                                                "--frames", frames,
+                                                "--width", width,
+                                                "--height", height,
+                                                "--buffer-type", config->buffer_type,
+                                                NULL);
+  if (!run.subprocess)
+    g_error ("Failed to launch compositor benchmark client: %s",
+             error->message);
+
+  g_subprocess_wait_async (run.subprocess, NULL,
+                           bench_client_exited,
+                           &run);
+
+  if (config->interaction != BENCH_INTERACTION_NONE)
+    begin_interaction (&run);
+
+  while (!run.finished)
+    g_main_context_iteration (NULL, TRUE);
+
+  cpu_time_us = get_cpu_time_us () - start_cpu_time_us;
+
+  if (run.virtual_pointer)
+    end_interaction (&run);
+
+  if (g_subprocess_get_if_exited (run.subprocess) &&
+      g_subprocess_get_exit_status (run.subprocess) == EXIT_SKIP)
+    {
+      g_test_skip ("Buffer type not supported by the client");
+      g_object_unref (run.subprocess);
+      return;
+    }
+
+  g_assert_true (g_subprocess_get_successful (run.subprocess));
+  g_object_unref (run.subprocess);
+
+  print_results (config, view, first_frame_count, cpu_time_us);
+}
+
+static void
+init_benchmarks (void)
+{
+  const char *scale;
+  size_t i;
+
+  scale = g_getenv ("MUTTER_BENCHMARK_SCALE");
+  if (scale)
+    n_frames = MAX ((int) (N_FRAMES * g_ascii_strtod (scale, NULL)), 1);
+
+  for (i = 0; i < G_N_ELEMENTS (bench_configs); i++)
+    {
+      const BenchConfig *config = &bench_configs[i];
+      g_autofree char *path = NULL;
+
+      path = g_strdup_printf ("/compositor/bench/%s/%s/%d-windows/%d-subsurfaces",
+                              config->scenario,
+                              config->buffer_type,
+                              config->n_windows,
+                              config->n_subsurfaces);
+      g_test_add_data_func (path, config, run_bench);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_benchmarks ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
@@ -66,6 +66,7 @@ main (int    argc,
       char **argv)
 {
   MetaEdidInfo *edid_info;
+  MetaEdidInfo *edid_info_copy;
   edid_info = meta_edid_info_new_parse (edid_blob,edid_blob_len);
 
   g_assert (edid_info != NULL);
@@ -76,4 +77,13 @@ main (int    argc,
             (META_EDID_TF_TRADITIONAL_GAMMA_SDR | META_EDID_TF_PQ));
   g_assert (edid_info->colorimetry ==
             (META_EDID_COLORIMETRY_BT2020YCC | META_EDID_COLORIMETRY_BT2020RGB));
+
+  edid_info_copy = meta_edid_info_copy (edid_info);
+  g_assert (edid_info_copy->manufacturer_code != edid_info->manufacturer_code);
+  g_assert (strcmp (edid_info_copy->manufacturer_code, "GSM") == 0);
+  g_assert (edid_info_copy->product_code == edid_info->product_code);
+  g_assert (edid_info_copy->colorimetry == edid_info->colorimetry);
+
+  meta_edid_info_free (edid_info_copy);
+  meta_edid_info_free (edid_info);
 }
@@ -778,8 +778,8 @@ meta_create_monitor_test_setup (MetaBackend          *backend,
         setup->outputs[i].panel_orientation_transform;
       if (setup->outputs[i].has_edid_info)
         {
-          output_info->edid_info = g_memdup2 (&setup->outputs[i].edid_info,
-                                              sizeof (setup->outputs[i].edid_info));
+          output_info->edid_info =
+            meta_edid_info_copy (&setup->outputs[i].edid_info);
           output_info->edid_checksum_md5 =
             g_compute_checksum_for_data (G_CHECKSUM_MD5,
                                          (uint8_t *) &setup->outputs[i].edid_info,
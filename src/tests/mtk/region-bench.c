@@ -0,0 +1,429 @@
+/*
+ * Benchmarks for MtkRegion operations.
+ *
+ * The workloads mimic what the compositor does with regions every frame:
+ * culling a stack of windows against each other, accumulating damage and
+ * transforming it for the screen cast and for scaled or transformed
+ * views. Every case prints a single line of JSON to stdout, e.g.
+ *
+ *   {"benchmark": "cull-stack", "iterations": 2000, "usec": 1234, "usec-per-iteration": 0.617}
+ *
+ * so that results can be collected and compared between runs. The number
+ * of iterations can be scaled with MTK_BENCHMARK_SCALE.
+ *
+ * Recorded damage traces can be replayed by passing their paths on the
+ * command line. A trace is a text file with one damage rectangle per line,
+ * written as "x y width height", with empty lines separating frames.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "mtk/mtk.h"
+
+#define STAGE_WIDTH 3840
+#define STAGE_HEIGHT 2160
+#define N_WINDOWS 32
+#define N_DAMAGE_RECTS 64
+
+static double iteration_scale = 1.0;
+
+typedef struct _BenchTimer
+{
+  const char *name;
+  int iterations;
+  int64_t start_us;
+} BenchTimer;
+
+typedef struct _Trace
+{
+  char *name;
+  /* Array of GArray of MtkRectangle, one per frame */
+  GPtrArray *frames;
+} Trace;
+
+static int
+scaled_iterations (int iterations)
+{
+  return MAX (1, (int) (iterations * iteration_scale));
+}
+
+static void
+bench_timer_start (BenchTimer *timer,
+                   const char *name,
+                   int         iterations)
+{
+  timer->name = name;
+  timer->iterations = iterations;
+  timer->start_us = g_get_monotonic_time ();
+}
+
+static void
+bench_timer_report (BenchTimer *timer)
+{
+  int64_t elapsed_us = g_get_monotonic_time () - timer->start_us;
+
+  g_print ("{\"benchmark\": \"%s\", \"iterations\": %d, "
+           "\"usec\": %" G_GINT64_FORMAT ", \"usec-per-iteration\": %.3f}\n",
+           timer->name,
+           timer->iterations,
+           elapsed_us,
+           (double) elapsed_us / timer->iterations);
+}
+
+static MtkRectangle
+random_rectangle (int max_width,
+                  int max_height)
+{
+  int width = g_random_int_range (1, max_width);
+  int height = g_random_int_range (1, max_height);
+
+  return MTK_RECTANGLE_INIT (g_random_int_range (0, STAGE_WIDTH - width),
+                             g_random_int_range (0, STAGE_HEIGHT - height),
+                             width,
+                             height);
+}
+
+static MtkRegion *
+create_window_region (void)
+{
+  MtkRectangle rect = random_rectangle (STAGE_WIDTH / 2, STAGE_HEIGHT / 2);
+  MtkRegion *region;
+
+  region = mtk_region_create_rectangle (&rect);
+
+  /* Rounded corners make the opaque region of most windows a few
+   * rectangles rather than a single one */
+  mtk_region_subtract_rectangle (region,
+                                 &MTK_RECTANGLE_INIT (rect.x, rect.y, 8, 8));
+  mtk_region_subtract_rectangle (region,
+                                 &MTK_RECTANGLE_INIT (rect.x + rect.width - 8,
+                                                      rect.y, 8, 8));
+
+  return region;
+}
+
+static MtkRegion *
+create_damage_region (int n_rects)
+{
+  MtkRegionBuilder builder;
+  int i;
+
+  mtk_region_builder_init (&builder);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = random_rectangle (256, 128);
+
+      mtk_region_builder_add_rectangle (&builder,
+                                        rect.x, rect.y,
+                                        rect.width, rect.height);
+    }
+
+  return mtk_region_builder_finish (&builder);
+}
+
+static void
+bench_cull_stack (void)
+{
+  MtkRegion *windows[N_WINDOWS];
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (2000);
+  int i, j;
+
+  for (i = 0; i < N_WINDOWS; i++)
+    windows[i] = create_window_region ();
+
+  bench_timer_start (&timer, "cull-stack", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      g_autoptr (MtkRegion) unobscured = NULL;
+
+      unobscured = mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (0, 0,
+                                                                     STAGE_WIDTH,
+                                                                     STAGE_HEIGHT));
+
+      /* Walk the stack from top to bottom like meta_cullable_cull_unobscured() */
+      for (j = N_WINDOWS - 1; j >= 0; j--)
+        {
+          g_autoptr (MtkRegion) visible = NULL;
+
+          visible = mtk_region_copy (unobscured);
+          mtk_region_intersect (visible, windows[j]);
+          mtk_region_subtract (unobscured, windows[j]);
+        }
+    }
+  bench_timer_report (&timer);
+
+  for (i = 0; i < N_WINDOWS; i++)
+    mtk_region_unref (windows[i]);
+}
+
+static void
+bench_damage_union (void)
+{
+  g_autoptr (MtkRegion) damage = NULL;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (200);
+  int i, j;
+
+  damage = create_damage_region (N_DAMAGE_RECTS);
+
+  bench_timer_start (&timer, "damage-union", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      g_autoptr (MtkRegion) accumulated = NULL;
+
+      accumulated = mtk_region_create ();
+      for (j = 0; j < N_DAMAGE_RECTS; j++)
+        {
+          MtkRectangle rect = random_rectangle (256, 128);
+
+          mtk_region_union_rectangle (accumulated, &rect);
+        }
+      mtk_region_union (accumulated, damage);
+    }
+  bench_timer_report (&timer);
+}
+
+static void
+bench_damage_subtract_intersect (void)
+{
+  g_autoptr (MtkRegion) damage = NULL;
+  g_autoptr (MtkRegion) opaque = NULL;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (2000);
+  int i;
+
+  damage = create_damage_region (N_DAMAGE_RECTS);
+  opaque = create_damage_region (N_DAMAGE_RECTS / 4);
+
+  bench_timer_start (&timer, "damage-subtract-intersect", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      g_autoptr (MtkRegion) blended = NULL;
+      g_autoptr (MtkRegion) clipped = NULL;
+
+      blended = mtk_region_copy (damage);
+      mtk_region_subtract (blended, opaque);
+
+      clipped = mtk_region_copy (damage);
+      mtk_region_intersect_rectangle (clipped,
+                                      &MTK_RECTANGLE_INIT (0, 0,
+                                                           STAGE_WIDTH / 2,
+                                                           STAGE_HEIGHT / 2));
+    }
+  bench_timer_report (&timer);
+}
+
+static void
+bench_crop_and_scale (void)
+{
+  g_autoptr (MtkRegion) damage = NULL;
+  graphene_rect_t src_rect =
+    GRAPHENE_RECT_INIT (0, 0, STAGE_WIDTH / 2.0f, STAGE_HEIGHT / 2.0f);
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (2000);
+  int i;
+
+  damage = create_damage_region (N_DAMAGE_RECTS);
+
+  /* Downscaling the stage damage into a screen cast stream */
+  bench_timer_start (&timer, "crop-and-scale", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      g_autoptr (MtkRegion) scaled = NULL;
+
+      scaled = mtk_region_crop_and_scale (damage, &src_rect, 1280, 720);
+    }
+  bench_timer_report (&timer);
+}
+
+static void
+bench_matrix_transform_expand (void)
+{
+  g_autoptr (MtkRegion) damage = NULL;
+  graphene_matrix_t transform;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (2000);
+  int i;
+
+  damage = create_damage_region (N_DAMAGE_RECTS);
+
+  graphene_matrix_init_scale (&transform, 1.5f, 1.5f, 1.f);
+  graphene_matrix_translate (&transform,
+                             &GRAPHENE_POINT3D_INIT (-100.f, -50.f, 0.f));
+
+  bench_timer_start (&timer, "matrix-transform-expand", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      g_autoptr (MtkRegion) transformed = NULL;
+
+      transformed = mtk_region_apply_matrix_transform_expand (damage,
+                                                              &transform);
+    }
+  bench_timer_report (&timer);
+}
+
+static void
+bench_iterate (void)
+{
+  g_autoptr (MtkRegion) damage = NULL;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (20000);
+  int64_t area = 0;
+  int i;
+
+  damage = create_damage_region (N_DAMAGE_RECTS * 4);
+
+  bench_timer_start (&timer, "iterate", n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      MtkRegionIterator iter;
+
+      for (mtk_region_iterator_init (&iter, damage);
+           !mtk_region_iterator_at_end (&iter);
+           mtk_region_iterator_next (&iter))
+        area += iter.rectangle.width * iter.rectangle.height;
+    }
+  bench_timer_report (&timer);
+
+  g_assert_cmpint (area, >, 0);
+}
+
+static void
+trace_free (Trace *trace)
+{
+  g_free (trace->name);
+  g_ptr_array_unref (trace->frames);
+  g_free (trace);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (Trace, trace_free)
+
+static Trace *
+trace_load (const char  *path,
+            GError     **error)
+{
+  g_autoptr (Trace) trace = NULL;
+  g_autofree char *contents = NULL;
+  g_auto (GStrv) lines = NULL;
+  GArray *frame = NULL;
+  int i;
+
+  if (!g_file_get_contents (path, &contents, NULL, error))
+    return NULL;
+
+  trace = g_new0 (Trace, 1);
+  trace->name = g_path_get_basename (path);
+  trace->frames = g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+
+  lines = g_strsplit (contents, "\n", -1);
+  for (i = 0; lines[i]; i++)
+    {
+      MtkRectangle rect;
+
+      g_strstrip (lines[i]);
+      if (lines[i][0] == '\0')
+        {
+          frame = NULL;
+          continue;
+        }
+
+      if (sscanf (lines[i], "%d %d %d %d",
+                  &rect.x, &rect.y, &rect.width, &rect.height) != 4)
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+                       "Invalid rectangle '%s' on line %d", lines[i], i + 1);
+          return NULL;
+        }
+
+      if (!frame)
+        {
+          frame = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+          g_ptr_array_add (trace->frames, frame);
+        }
+
+      g_array_append_val (frame, rect);
+    }
+
+  return g_steal_pointer (&trace);
+}
+
+static void
+bench_trace (Trace *trace)
+{
+  g_autofree char *name = NULL;
+  BenchTimer timer;
+  int n_iterations = scaled_iterations (20);
+  int i, j;
+
+  name = g_strdup_printf ("trace-%s", trace->name);
+
+  /* Replays the damage like the stage view does: accumulate the damage of
+   * each frame, clip it to the view and walk the result when painting */
+  bench_timer_start (&timer, name, n_iterations);
+  for (i = 0; i < n_iterations; i++)
+    {
+      for (j = 0; j < trace->frames->len; j++)
+        {
+          GArray *frame = g_ptr_array_index (trace->frames, j);
+          MtkRegionBuilder builder;
+          g_autoptr (MtkRegion) damage = NULL;
+          MtkRegionIterator iter;
+
+          mtk_region_builder_init (&builder);
+          mtk_region_builder_add_rectangles (&builder,
+                                             (MtkRectangle *) frame->data,
+                                             frame->len);
+          damage = mtk_region_builder_finish (&builder);
+
+          mtk_region_intersect_rectangle (damage,
+                                          &MTK_RECTANGLE_INIT (0, 0,
+                                                               STAGE_WIDTH,
+                                                               STAGE_HEIGHT));
+
+          for (mtk_region_iterator_init (&iter, damage);
+               !mtk_region_iterator_at_end (&iter);
+               mtk_region_iterator_next (&iter))
+            ;
+        }
+    }
+  bench_timer_report (&timer);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  const char *scale;
+  int i;
+
+  scale = g_getenv ("MTK_BENCHMARK_SCALE");
+  if (scale)
+    iteration_scale = MAX (g_ascii_strtod (scale, NULL), 0.01);
+
+  g_random_set_seed (12345678);
+
+  bench_cull_stack ();
+  bench_damage_union ();
+  bench_damage_subtract_intersect ();
+  bench_crop_and_scale ();
+  bench_matrix_transform_expand ();
+  bench_iterate ();
+
+  for (i = 1; i < argc; i++)
+    {
+      g_autoptr (Trace) trace = NULL;
+      g_autoptr (GError) error = NULL;
+
+      trace = trace_load (argv[i], &error);
+      if (!trace)
+        g_error ("Failed to load trace %s: %s", argv[i], error->message);
+
+      bench_trace (trace);
+    }
+
+  return EXIT_SUCCESS;
+}
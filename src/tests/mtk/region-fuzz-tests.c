@@ -0,0 +1,291 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Applies random sequences of region operations and compares the result
+ * against a trivial per-pixel reference implementation. The seed can be
+ * changed with --seed to explore other sequences.
+ */
+
+#include "config.h"
+#include "mtk/mtk.h"
+
+#include <glib.h>
+#include <string.h>
+
+#define GRID_SIZE 48
+#define N_ITERATIONS 500
+#define N_OPERATIONS 16
+
+typedef struct _Bitmap
+{
+  gboolean pixels[GRID_SIZE][GRID_SIZE];
+} Bitmap;
+
+typedef enum _Operation
+{
+  OPERATION_UNION,
+  OPERATION_SUBTRACT,
+  OPERATION_INTERSECT,
+  OPERATION_UNION_RECTANGLE,
+  OPERATION_SUBTRACT_RECTANGLE,
+  OPERATION_INTERSECT_RECTANGLE,
+  OPERATION_TRANSLATE,
+  N_OPERATION_TYPES,
+} Operation;
+
+static MtkRectangle
+random_rectangle (void)
+{
+  int x = g_test_rand_int_range (-4, GRID_SIZE);
+  int y = g_test_rand_int_range (-4, GRID_SIZE);
+
+  /* Include empty rectangles, and rectangles reaching out of the grid */
+  return MTK_RECTANGLE_INIT (x, y,
+                             g_test_rand_int_range (0, GRID_SIZE / 2),
+                             g_test_rand_int_range (0, GRID_SIZE / 2));
+}
+
+static void
+bitmap_fill (Bitmap             *bitmap,
+             const MtkRectangle *rect,
+             gboolean            value)
+{
+  int x, y;
+
+  for (y = MAX (rect->y, 0); y < MIN (rect->y + rect->height, GRID_SIZE); y++)
+    {
+      for (x = MAX (rect->x, 0); x < MIN (rect->x + rect->width, GRID_SIZE); x++)
+        bitmap->pixels[y][x] = value;
+    }
+}
+
+static MtkRegion *
+create_random_region (Bitmap *bitmap)
+{
+  MtkRegion *region;
+  int n_rects;
+  int i;
+
+  memset (bitmap, 0, sizeof (Bitmap));
+  region = mtk_region_create ();
+
+  n_rects = g_test_rand_int_range (0, 5);
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = random_rectangle ();
+
+      mtk_region_union_rectangle (region, &rect);
+      bitmap_fill (bitmap, &rect, TRUE);
+    }
+
+  return region;
+}
+
+static void
+assert_region_matches_bitmap (MtkRegion    *region,
+                              const Bitmap *bitmap)
+{
+  int x, y;
+
+  for (y = 0; y < GRID_SIZE; y++)
+    {
+      for (x = 0; x < GRID_SIZE; x++)
+        {
+          g_assert_cmpint (mtk_region_contains_point (region, x, y),
+                           ==,
+                           bitmap->pixels[y][x]);
+        }
+    }
+}
+
+static void
+apply_random_operation (MtkRegion *region,
+                        Bitmap    *bitmap)
+{
+  g_autoptr (MtkRegion) other = NULL;
+  Bitmap other_bitmap;
+  MtkRectangle rect;
+  Operation operation;
+  int x, y;
+  int dx, dy;
+
+  operation = g_test_rand_int_range (0, N_OPERATION_TYPES);
+  switch (operation)
+    {
+    case OPERATION_UNION:
+    case OPERATION_SUBTRACT:
+    case OPERATION_INTERSECT:
+      other = create_random_region (&other_bitmap);
+
+      if (operation == OPERATION_UNION)
+        mtk_region_union (region, other);
+      else if (operation == OPERATION_SUBTRACT)
+        mtk_region_subtract (region, other);
+      else
+        mtk_region_intersect (region, other);
+
+      for (y = 0; y < GRID_SIZE; y++)
+        {
+          for (x = 0; x < GRID_SIZE; x++)
+            {
+              gboolean a = bitmap->pixels[y][x];
+              gboolean b = other_bitmap.pixels[y][x];
+
+              if (operation == OPERATION_UNION)
+                bitmap->pixels[y][x] = a || b;
+              else if (operation == OPERATION_SUBTRACT)
+                bitmap->pixels[y][x] = a && !b;
+              else
+                bitmap->pixels[y][x] = a && b;
+            }
+        }
+      break;
+    case OPERATION_UNION_RECTANGLE:
+      rect = random_rectangle ();
+      mtk_region_union_rectangle (region, &rect);
+      bitmap_fill (bitmap, &rect, TRUE);
+      break;
+    case OPERATION_SUBTRACT_RECTANGLE:
+      rect = random_rectangle ();
+      mtk_region_subtract_rectangle (region, &rect);
+      bitmap_fill (bitmap, &rect, FALSE);
+      break;
+    case OPERATION_INTERSECT_RECTANGLE:
+      rect = random_rectangle ();
+      mtk_region_intersect_rectangle (region, &rect);
+
+      memset (&other_bitmap, 0, sizeof (Bitmap));
+      bitmap_fill (&other_bitmap, &rect, TRUE);
+      for (y = 0; y < GRID_SIZE; y++)
+        {
+          for (x = 0; x < GRID_SIZE; x++)
+            bitmap->pixels[y][x] &= other_bitmap.pixels[y][x];
+        }
+      break;
+    case OPERATION_TRANSLATE:
+      dx = g_test_rand_int_range (-8, 9);
+      dy = g_test_rand_int_range (-8, 9);
+      mtk_region_translate (region, dx, dy);
+      for (y = 0; y < GRID_SIZE; y++)
+        {
+          for (x = 0; x < GRID_SIZE; x++)
+            {
+              g_assert_cmpint (mtk_region_contains_point (region,
+                                                          x + dx, y + dy),
+                               ==,
+                               bitmap->pixels[y][x]);
+            }
+        }
+      mtk_region_translate (region, -dx, -dy);
+      break;
+    case N_OPERATION_TYPES:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+test_region_fuzz (void)
+{
+  int i, j;
+
+  for (i = 0; i < N_ITERATIONS; i++)
+    {
+      g_autoptr (MtkRegion) region = NULL;
+      g_autoptr (MtkRegion) copy = NULL;
+      Bitmap bitmap;
+      Bitmap copy_bitmap;
+
+      region = create_random_region (&bitmap);
+
+      for (j = 0; j < N_OPERATIONS; j++)
+        {
+          /* Keep a copy around to check that modifying the region never
+           * affects regions it was copied to */
+          if (g_test_rand_bit ())
+            {
+              g_clear_pointer (&copy, mtk_region_unref);
+              copy = mtk_region_copy (region);
+              copy_bitmap = bitmap;
+            }
+
+          apply_random_operation (region, &bitmap);
+          assert_region_matches_bitmap (region, &bitmap);
+
+          if (copy)
+            assert_region_matches_bitmap (copy, &copy_bitmap);
+        }
+    }
+}
+
+static void
+test_region_builder_fuzz (void)
+{
+  int i, j;
+
+  for (i = 0; i < N_ITERATIONS; i++)
+    {
+      MtkRegionBuilder builder;
+      MtkRectangle rects[64];
+      g_autoptr (MtkRegion) region = NULL;
+      Bitmap bitmap = { 0 };
+      int n_rects;
+
+      n_rects = g_test_rand_int_range (0, G_N_ELEMENTS (rects));
+      for (j = 0; j < n_rects; j++)
+        {
+          rects[j] = random_rectangle ();
+          bitmap_fill (&bitmap, &rects[j], TRUE);
+        }
+
+      mtk_region_builder_init (&builder);
+      j = 0;
+      while (j < n_rects)
+        {
+          int n = g_test_rand_int_range (1, n_rects - j + 1);
+
+          if (n == 1)
+            {
+              mtk_region_builder_add_rectangle (&builder,
+                                                rects[j].x, rects[j].y,
+                                                rects[j].width,
+                                                rects[j].height);
+            }
+          else
+            {
+              mtk_region_builder_add_rectangles (&builder, &rects[j], n);
+            }
+
+          j += n;
+        }
+      region = mtk_region_builder_finish (&builder);
+
+      assert_region_matches_bitmap (region, &bitmap);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/mtk/region/fuzz", test_region_fuzz);
+  g_test_add_func ("/mtk/region/builder-fuzz", test_region_builder_fuzz);
+
+  return g_test_run ();
+}
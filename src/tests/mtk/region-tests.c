@@ -76,6 +76,136 @@ test_region (void)
   g_assert_cmpint (extents.height, ==, rect.height);
 }
 
+static void
+test_single_rectangle_operations (void)
+{
+  MtkRectangle rect = MTK_RECTANGLE_INIT (0, 0, 100, 100);
+  MtkRectangle extents;
+  g_autoptr (MtkRegion) r1 = NULL;
+  g_autoptr (MtkRegion) r2 = NULL;
+
+  r1 = mtk_region_create_rectangle (&rect);
+
+  mtk_region_intersect_rectangle (r1, &MTK_RECTANGLE_INIT (50, 25, 100, 50));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+  extents = mtk_region_get_extents (r1);
+  g_assert (mtk_rectangle_equal (&extents, &MTK_RECTANGLE_INIT (50, 25, 50, 50)));
+
+  mtk_region_intersect_rectangle (r1, &MTK_RECTANGLE_INIT (200, 200, 10, 10));
+  g_assert (mtk_region_is_empty (r1));
+
+  mtk_region_union_rectangle (r1, &rect);
+  mtk_region_union_rectangle (r1, &MTK_RECTANGLE_INIT (10, 10, 20, 20));
+  mtk_region_union_rectangle (r1, &MTK_RECTANGLE_INIT (10, 10, 0, 20));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+  extents = mtk_region_get_extents (r1);
+  g_assert (mtk_rectangle_equal (&extents, &rect));
+
+  mtk_region_subtract_rectangle (r1, &MTK_RECTANGLE_INIT (100, 0, 10, 100));
+  extents = mtk_region_get_extents (r1);
+  g_assert (mtk_rectangle_equal (&extents, &rect));
+
+  mtk_region_subtract_rectangle (r1, &MTK_RECTANGLE_INIT (25, 25, 50, 50));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 4);
+  g_assert (!mtk_region_contains_point (r1, 50, 50));
+  g_assert (mtk_region_contains_point (r1, 10, 50));
+
+  /* A rectangle covering the extents of a complex region */
+  mtk_region_intersect_rectangle (r1, &MTK_RECTANGLE_INIT (-10, -10, 120, 120));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 4);
+
+  mtk_region_intersect_rectangle (r1, &MTK_RECTANGLE_INIT (0, 0, 50, 100));
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 3);
+  extents = mtk_region_get_extents (r1);
+  g_assert (mtk_rectangle_equal (&extents, &MTK_RECTANGLE_INIT (0, 0, 50, 100)));
+
+  r2 = mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (-10, -10, 120, 120));
+  mtk_region_union (r1, r2);
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 1);
+  g_assert (mtk_region_equal (r1, r2));
+
+  mtk_region_intersect (r1, r1);
+  g_assert (mtk_region_equal (r1, r2));
+
+  mtk_region_subtract (r1, r1);
+  g_assert (mtk_region_is_empty (r1));
+
+  mtk_region_subtract (r2, r1);
+  extents = mtk_region_get_extents (r2);
+  g_assert (mtk_rectangle_equal (&extents, &MTK_RECTANGLE_INIT (-10, -10, 120, 120)));
+
+  mtk_region_intersect (r2, r1);
+  g_assert (mtk_region_is_empty (r2));
+}
+
+static void
+test_copy_on_write (void)
+{
+  MtkRectangle rects[] = {
+    MTK_RECTANGLE_INIT (0, 0, 100, 100),
+    MTK_RECTANGLE_INIT (200, 0, 100, 100),
+  };
+  g_autoptr (MtkRegion) r1 = NULL;
+  g_autoptr (MtkRegion) r2 = NULL;
+  g_autoptr (MtkRegion) r3 = NULL;
+
+  r1 = mtk_region_create_rectangles (rects, G_N_ELEMENTS (rects));
+  r2 = mtk_region_copy (r1);
+  r3 = mtk_region_copy (r2);
+  g_assert (mtk_region_equal (r1, r2));
+  g_assert (mtk_region_equal (r2, r3));
+
+  mtk_region_subtract_rectangle (r2, &rects[0]);
+  g_assert_cmpint (mtk_region_num_rectangles (r1), ==, 2);
+  g_assert_cmpint (mtk_region_num_rectangles (r2), ==, 1);
+  g_assert_cmpint (mtk_region_num_rectangles (r3), ==, 2);
+  g_assert (mtk_region_equal (r1, r3));
+
+  mtk_region_translate (r1, 10, 0);
+  g_assert (!mtk_region_equal (r1, r3));
+  g_assert (mtk_region_contains_point (r3, 0, 0));
+  g_assert (!mtk_region_contains_point (r1, 0, 0));
+
+  g_clear_pointer (&r1, mtk_region_unref);
+  g_assert_cmpint (mtk_region_num_rectangles (r3), ==, 2);
+
+  mtk_region_union (r3, r2);
+  mtk_region_subtract (r3, r2);
+  g_assert_cmpint (mtk_region_num_rectangles (r3), ==, 1);
+  g_assert_cmpint (mtk_region_num_rectangles (r2), ==, 1);
+  g_assert (!mtk_region_equal (r2, r3));
+}
+
+static void
+test_builder_add_rectangles (void)
+{
+  MtkRegionBuilder builder;
+  MtkRectangle rects[100];
+  g_autoptr (MtkRegion) r1 = NULL;
+  g_autoptr (MtkRegion) r2 = NULL;
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (rects); i++)
+    rects[i] = MTK_RECTANGLE_INIT ((i * 37) % 200, (i * 53) % 150, 10, 20);
+
+  mtk_region_builder_init (&builder);
+  for (i = 0; i < G_N_ELEMENTS (rects); i++)
+    {
+      mtk_region_builder_add_rectangle (&builder,
+                                        rects[i].x, rects[i].y,
+                                        rects[i].width, rects[i].height);
+    }
+  r1 = mtk_region_builder_finish (&builder);
+
+  mtk_region_builder_init (&builder);
+  mtk_region_builder_add_rectangles (&builder, rects, 3);
+  mtk_region_builder_add_rectangles (&builder, &rects[3], 70);
+  mtk_region_builder_add_rectangles (&builder, &rects[73], 27);
+  r2 = mtk_region_builder_finish (&builder);
+
+  g_assert (mtk_region_equal (r1, r2));
+}
+
 int
 main (int    argc,
       char **argv)
@@ -85,6 +215,11 @@ main (int    argc,
   g_test_add_func ("/mtk/region/region", test_region);
   g_test_add_func ("/mtk/region/contains-point", test_contains_point);
   g_test_add_func ("/mtk/region/translate", test_translate);
+  g_test_add_func ("/mtk/region/single-rectangle-operations",
+                   test_single_rectangle_operations);
+  g_test_add_func ("/mtk/region/copy-on-write", test_copy_on_write);
+  g_test_add_func ("/mtk/region/builder-add-rectangles",
+                   test_builder_add_rectangles);
 
   return g_test_run ();
 }
@@ -0,0 +1,408 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Benchmarks building and processing KMS updates.
+ *
+ * Each case repeats one operation on the test KMS device and prints the
+ * average CPU and wall clock time per iteration as a line of JSON, e.g.
+ *
+ *   {"benchmark": "kms-update", "mode": "atomic", "case": "merge", "iterations": 10000, "cpu-usec-per-iteration": 2.41, "wall-usec-per-iteration": 2.45}
+ *
+ * The CPU time includes the KMS thread. Cases that only build updates
+ * measure meta-kms-update.c; the others go through the atomic or simple
+ * impl device, depending on MUTTER_DEBUG_FORCE_KMS_MODE. Cases that wait
+ * for page flips are bound by the refresh rate, so their CPU time is the
+ * interesting number. The iteration counts can be scaled with
+ * MUTTER_BENCHMARK_SCALE.
+ */
+
+#include "config.h"
+
+#include <sys/resource.h>
+
+#include "backends/native/meta-backend-native.h"
+#include "backends/native/meta-kms-connector.h"
+#include "backends/native/meta-kms-crtc.h"
+#include "backends/native/meta-kms-device-private.h"
+#include "backends/native/meta-kms-device.h"
+#include "backends/native/meta-kms-impl-device-atomic.h"
+#include "backends/native/meta-kms-mode.h"
+#include "backends/native/meta-kms-update-private.h"
+#include "backends/native/meta-kms.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-kms-test-utils.h"
+
+typedef struct _BenchState
+{
+  MetaKmsDevice *device;
+  MetaKmsCrtc *crtc;
+  MetaKmsConnector *connector;
+  MetaKmsMode *mode;
+  MetaKmsPlane *primary_plane;
+  MetaKmsPlane *cursor_plane;
+
+  MetaDrmBuffer *primary_buffers[2];
+  MetaDrmBuffer *cursor_buffer;
+
+  int iteration;
+} BenchState;
+
+typedef void (* BenchFunc) (BenchState *state);
+
+typedef struct _BenchCase
+{
+  const char *name;
+  BenchFunc func;
+  int n_iterations;
+} BenchCase;
+
+typedef struct _FlipData
+{
+  GMainLoop *loop;
+  gboolean done;
+} FlipData;
+
+static MetaContext *test_context;
+static double iteration_scale = 1.0;
+
+static int64_t
+get_cpu_time_us (void)
+{
+  struct rusage usage;
+
+  g_assert_cmpint (getrusage (RUSAGE_SELF, &usage), ==, 0);
+
+  return ((usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * G_USEC_PER_SEC +
+          usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static void
+flip_feedback_flipped (MetaKmsCrtc  *kms_crtc,
+                       unsigned int  sequence,
+                       unsigned int  tv_sec,
+                       unsigned int  tv_usec,
+                       gpointer      user_data)
+{
+}
+
+static void
+flip_feedback_ready (MetaKmsCrtc *kms_crtc,
+                     gpointer     user_data)
+{
+}
+
+static void
+flip_feedback_mode_set_fallback (MetaKmsCrtc *kms_crtc,
+                                 gpointer     user_data)
+{
+}
+
+static void
+flip_feedback_discarded (MetaKmsCrtc  *kms_crtc,
+                         gpointer      user_data,
+                         const GError *error)
+{
+}
+
+static const MetaKmsPageFlipListenerVtable flip_listener_vtable = {
+  .flipped = flip_feedback_flipped,
+  .ready = flip_feedback_ready,
+  .mode_set_fallback = flip_feedback_mode_set_fallback,
+  .discarded = flip_feedback_discarded,
+};
+
+static void
+flip_data_destroy (gpointer user_data)
+{
+  FlipData *data = user_data;
+
+  data->done = TRUE;
+  g_main_loop_quit (data->loop);
+}
+
+static MetaKmsPlaneAssignment *
+assign_primary_plane (BenchState    *state,
+                      MetaKmsUpdate *update)
+{
+  MetaDrmBuffer *buffer = state->primary_buffers[state->iteration % 2];
+
+  return meta_kms_update_assign_plane (update,
+                                       state->crtc,
+                                       state->primary_plane,
+                                       buffer,
+                                       meta_get_mode_fixed_rect_16 (state->mode),
+                                       meta_get_mode_rect (state->mode),
+                                       META_KMS_ASSIGN_PLANE_FLAG_NONE);
+}
+
+static MetaKmsPlaneAssignment *
+assign_cursor_plane (BenchState    *state,
+                     MetaKmsUpdate *update)
+{
+  MetaKmsPlaneAssignment *plane_assignment;
+  int x = state->iteration % 256;
+  int y = (state->iteration / 256) % 256;
+
+  plane_assignment =
+    meta_kms_update_assign_plane (update,
+                                  state->crtc,
+                                  state->cursor_plane,
+                                  state->cursor_buffer,
+                                  META_FIXED_16_RECTANGLE_INIT_INT (0, 0,
+                                                                    64, 64),
+                                  MTK_RECTANGLE_INIT (x, y, 64, 64),
+                                  META_KMS_ASSIGN_PLANE_FLAG_NONE);
+  meta_kms_plane_assignment_set_cursor_hotspot (plane_assignment, 10, 11);
+
+  return plane_assignment;
+}
+
+static MetaKmsUpdate *
+build_frame_update (BenchState *state)
+{
+  MetaKmsUpdate *update;
+
+  update = meta_kms_update_new (state->device);
+  assign_primary_plane (state, update);
+  if (state->cursor_plane)
+    assign_cursor_plane (state, update);
+
+  return update;
+}
+
+static void
+post_and_wait (BenchState    *state,
+               MetaKmsUpdate *update)
+{
+  FlipData data = { 0 };
+
+  data.loop = g_main_loop_new (NULL, FALSE);
+  meta_kms_update_add_page_flip_listener (update, state->crtc,
+                                          &flip_listener_vtable,
+                                          NULL,
+                                          &data,
+                                          flip_data_destroy);
+  meta_kms_device_post_update (state->device, update,
+                               META_KMS_UPDATE_FLAG_NONE);
+
+  if (!data.done)
+    g_main_loop_run (data.loop);
+  g_main_loop_unref (data.loop);
+}
+
+static void
+bench_build (BenchState *state)
+{
+  MetaKmsUpdate *update;
+
+  update = build_frame_update (state);
+  meta_kms_update_add_page_flip_listener (update, state->crtc,
+                                          &flip_listener_vtable,
+                                          NULL, NULL, NULL);
+  meta_kms_update_free (update);
+}
+
+static void
+bench_merge (BenchState *state)
+{
+  MetaKmsUpdate *update;
+  MetaKmsUpdate *cursor_update;
+
+  update = meta_kms_update_new (state->device);
+  assign_primary_plane (state, update);
+
+  cursor_update = meta_kms_update_new (state->device);
+  if (state->cursor_plane)
+    assign_cursor_plane (state, cursor_update);
+  meta_kms_update_set_privacy_screen (cursor_update, state->connector, FALSE);
+
+  meta_kms_update_merge_from (update, cursor_update);
+  meta_kms_update_free (cursor_update);
+  meta_kms_update_free (update);
+}
+
+static void
+bench_test_commit (BenchState *state)
+{
+  MetaKmsFeedback *feedback;
+
+  feedback =
+    meta_kms_device_process_update_sync (state->device,
+                                         build_frame_update (state),
+                                         META_KMS_UPDATE_FLAG_TEST_ONLY);
+  meta_kms_feedback_unref (feedback);
+}
+
+static void
+bench_page_flip (BenchState *state)
+{
+  post_and_wait (state, build_frame_update (state));
+}
+
+static void
+bench_cursor (BenchState *state)
+{
+  MetaKmsUpdate *update;
+
+  if (!state->cursor_plane)
+    return;
+
+  update = meta_kms_update_new (state->device);
+  assign_cursor_plane (state, update);
+  post_and_wait (state, update);
+}
+
+static void
+bench_mode_set (BenchState *state)
+{
+  MetaKmsUpdate *update;
+  MetaKmsFeedback *feedback;
+
+  update = meta_kms_update_new (state->device);
+  meta_kms_update_mode_set (update, state->crtc,
+                            g_list_append (NULL, state->connector),
+                            state->mode);
+  assign_primary_plane (state, update);
+  feedback = meta_kms_device_process_update_sync (state->device, update,
+                                                  META_KMS_UPDATE_FLAG_MODE_SET);
+  meta_kms_feedback_unref (feedback);
+}
+
+static const BenchCase bench_cases[] = {
+  { "build", bench_build, 10000 },
+  { "merge", bench_merge, 10000 },
+  { "test-commit", bench_test_commit, 1000 },
+  { "page-flip", bench_page_flip, 120 },
+  { "cursor", bench_cursor, 120 },
+  { "mode-set", bench_mode_set, 10 },
+};
+
+static void
+init_bench_state (BenchState *state)
+{
+  state->device = meta_get_test_kms_device (test_context);
+  state->crtc = meta_get_test_kms_crtc (state->device);
+  state->connector = meta_get_test_kms_connector (state->device);
+  state->mode = meta_kms_connector_get_preferred_mode (state->connector);
+  state->primary_plane = meta_get_primary_test_plane_for (state->device,
+                                                          state->crtc);
+  state->cursor_plane = meta_get_cursor_test_plane_for (state->device,
+                                                        state->crtc);
+
+  state->primary_buffers[0] =
+    meta_create_test_mode_dumb_buffer (state->device, state->mode);
+  state->primary_buffers[1] =
+    meta_create_test_mode_dumb_buffer (state->device, state->mode);
+  state->cursor_buffer = meta_create_test_dumb_buffer (state->device, 64, 64);
+
+  /* Make sure the CRTC is active before flipping it */
+  bench_mode_set (state);
+}
+
+static void
+release_bench_state (BenchState *state)
+{
+  g_clear_object (&state->primary_buffers[0]);
+  g_clear_object (&state->primary_buffers[1]);
+  g_clear_object (&state->cursor_buffer);
+}
+
+static void
+run_bench (gconstpointer user_data)
+{
+  const BenchCase *bench_case = user_data;
+  BenchState state = { 0 };
+  MetaKmsImplDevice *impl_device;
+  int n_iterations;
+  int64_t start_cpu_time_us;
+  int64_t start_time_us;
+  int64_t cpu_time_us;
+  int64_t wall_time_us;
+
+  init_bench_state (&state);
+
+  if (bench_case->func == bench_cursor && !state.cursor_plane)
+    {
+      g_test_skip ("No cursor plane");
+      release_bench_state (&state);
+      return;
+    }
+
+  n_iterations = MAX ((int) (bench_case->n_iterations * iteration_scale), 1);
+
+  start_cpu_time_us = get_cpu_time_us ();
+  start_time_us = g_get_monotonic_time ();
+
+  for (state.iteration = 0; state.iteration < n_iterations; state.iteration++)
+    bench_case->func (&state);
+
+  wall_time_us = g_get_monotonic_time () - start_time_us;
+  cpu_time_us = get_cpu_time_us () - start_cpu_time_us;
+
+  impl_device = meta_kms_device_get_impl_device (state.device);
+
+  g_print ("{\"benchmark\": \"kms-update\", \"mode\": \"%s\", "
+           "\"case\": \"%s\", \"iterations\": %d, "
+           "\"cpu-usec-per-iteration\": %.2f, "
+           "\"wall-usec-per-iteration\": %.2f}\n",
+           META_IS_KMS_IMPL_DEVICE_ATOMIC (impl_device) ? "atomic" : "simple",
+           bench_case->name,
+           n_iterations,
+           (double) cpu_time_us / n_iterations,
+           (double) wall_time_us / n_iterations);
+
+  release_bench_state (&state);
+}
+
+static void
+init_tests (void)
+{
+  const char *scale;
+  size_t i;
+
+  scale = g_getenv ("MUTTER_BENCHMARK_SCALE");
+  if (scale)
+    iteration_scale = g_ascii_strtod (scale, NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (bench_cases); i++)
+    {
+      g_autofree char *path = NULL;
+
+      path = g_strdup_printf ("/backends/native/kms/update/bench/%s",
+                              bench_cases[i].name);
+      g_test_add_data_func (path, &bench_cases[i], run_bench);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = test_context =
+    meta_create_test_context (META_CONTEXT_TEST_TYPE_VKMS,
+                              META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert (meta_context_configure (context, &argc, &argv, NULL));
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_CAN_SKIP);
+}
@@ -633,6 +633,67 @@ meta_test_kms_update_merge (void)
   meta_kms_update_free (update1);
 }
 
+static void
+meta_test_kms_update_merge_crtc_ctm (void)
+{
+  MetaKmsDevice *device;
+  MetaKmsCrtc *crtc;
+  MetaKmsUpdate *update1;
+  MetaKmsUpdate *update2;
+  g_autoptr (MetaGammaLut) lut = NULL;
+  GList *crtc_color_updates;
+  MetaKmsCrtcColorUpdate *crtc_color_update;
+  const float ctm[9] = {
+    0.5f, 0.25f, 0.25f,
+    0.0f, 1.0f, 0.0f,
+    -0.5f, 0.0f, 1.5f,
+  };
+  struct drm_color_ctm drm_ctm;
+
+  device = meta_get_test_kms_device (test_context);
+  crtc = meta_get_test_kms_crtc (device);
+
+  if (!meta_kms_crtc_is_ctm_supported (crtc))
+    {
+      g_test_skip ("CRTC doesn't support a color transformation matrix");
+      return;
+    }
+
+  update1 = meta_kms_update_new (device);
+  meta_kms_update_set_crtc_ctm (update1, crtc, ctm);
+
+  update2 = meta_kms_update_new (device);
+  lut = meta_gamma_lut_new (3,
+                            (uint16_t[]) { 1, 2, 3 },
+                            (uint16_t[]) { 4, 5, 6 },
+                            (uint16_t[]) { 7, 8, 9 });
+  meta_kms_update_set_crtc_gamma (update2, crtc, lut);
+
+  meta_kms_update_merge_from (update1, update2);
+  meta_kms_update_free (update2);
+
+  crtc_color_updates = meta_kms_update_get_crtc_color_updates (update1);
+  g_assert_cmpuint (g_list_length (crtc_color_updates), ==, 1);
+  crtc_color_update = crtc_color_updates->data;
+
+  g_assert_true (crtc_color_update->gamma.has_update);
+  g_assert_nonnull (crtc_color_update->gamma.state);
+  g_assert_cmpint (crtc_color_update->gamma.state->size, ==, 3);
+
+  g_assert_true (crtc_color_update->ctm.has_update);
+  g_assert_false (crtc_color_update->ctm.is_bypass);
+
+  meta_kms_crtc_color_update_get_drm_ctm (crtc_color_update, &drm_ctm);
+  g_assert_cmpuint (drm_ctm.matrix[0], ==, 1ull << 31);
+  g_assert_cmpuint (drm_ctm.matrix[1], ==, 1ull << 30);
+  g_assert_cmpuint (drm_ctm.matrix[4], ==, 1ull << 32);
+  g_assert_cmpuint (drm_ctm.matrix[5], ==, 0);
+  g_assert_cmpuint (drm_ctm.matrix[6], ==, (1ull << 63) | (1ull << 31));
+  g_assert_cmpuint (drm_ctm.matrix[8], ==, 3ull << 31);
+
+  meta_kms_update_free (update1);
+}
+
 typedef struct _ThreadData
 {
   GMutex init_mutex;
@@ -858,6 +919,8 @@ init_tests (void)
                    meta_test_kms_update_page_flip);
   g_test_add_func ("/backends/native/kms/update/merge",
                    meta_test_kms_update_merge);
+  g_test_add_func ("/backends/native/kms/update/merge-crtc-ctm",
+                   meta_test_kms_update_merge_crtc_ctm);
   g_test_add_func ("/backends/native/kms/update/off-thread-page-flip",
                    meta_test_kms_update_off_thread_page_flip);
   g_test_add_func ("/backends/native/kms/update/feedback",
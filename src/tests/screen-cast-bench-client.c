@@ -0,0 +1,667 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Screen cast consumer used by mutter-screen-cast-bench.
+ *
+ * Records a virtual monitor with the given cursor mode, format and size,
+ * and moves the pointer across it at the maximum frame rate of the
+ * stream. Every pointer motion damages the stage, so it is expected to
+ * result in one frame. For each motion, the time until the next buffer
+ * is received is measured, and motions not followed by a buffer before
+ * the next one are counted as dropped frames. The results are printed as
+ * a single line of JSON to stdout.
+ */
+
+#include "config.h"
+
+#include <pipewire/pipewire.h>
+#include <spa/param/format-utils.h>
+#include <spa/param/props.h>
+#include <spa/param/video/format-utils.h>
+#include <spa/utils/result.h>
+#include <stdint.h>
+
+#include "meta-dbus-remote-desktop.h"
+#include "meta-dbus-screen-cast.h"
+
+#define MAX_FRAMERATE 60
+#define CURSOR_META_SIZE(width, height) \
+ (sizeof(struct spa_meta_cursor) + \
+  sizeof(struct spa_meta_bitmap) + width * height * 4)
+
+typedef struct _Stream
+{
+  MetaDBusScreenCastStream *proxy;
+  uint32_t pipewire_node_id;
+  struct pw_stream *pipewire_stream;
+  struct spa_hook pipewire_stream_listener;
+  enum pw_stream_state state;
+
+  uint32_t spa_format;
+  int width;
+  int height;
+
+  int buffer_count;
+  int64_t last_buffer_time_us;
+  int64_t last_buffer_pts_us;
+} Stream;
+
+typedef struct _PipeWireSource
+{
+  GSource source;
+
+  struct pw_loop *pipewire_loop;
+} PipeWireSource;
+
+typedef struct _Results
+{
+  int n_motions;
+  int n_frames;
+  int n_dropped;
+
+  int64_t total_latency_us;
+  int64_t max_latency_us;
+
+  int n_queue_latencies;
+  int64_t total_queue_latency_us;
+} Results;
+
+static GSource *_pipewire_source;
+static struct pw_context *_pipewire_context;
+static struct pw_core *_pipewire_core;
+static struct spa_hook _pipewire_core_listener;
+
+static char *cursor_mode_name = NULL;
+static char *format_name = NULL;
+static int stream_width = 1920;
+static int stream_height = 1080;
+static int n_motions = 300;
+
+static GOptionEntry options[] = {
+  {
+    "cursor-mode", 0, 0, G_OPTION_ARG_STRING, &cursor_mode_name,
+    "Cursor mode (hidden, embedded or metadata)", "MODE"
+  },
+  {
+    "format", 0, 0, G_OPTION_ARG_STRING, &format_name,
+    "Video format (BGRx, BGRA or NV12)", "FORMAT"
+  },
+  {
+    "width", 0, 0, G_OPTION_ARG_INT, &stream_width,
+    "Width of the stream", "WIDTH"
+  },
+  {
+    "height", 0, 0, G_OPTION_ARG_INT, &stream_height,
+    "Height of the stream", "HEIGHT"
+  },
+  {
+    "motions", 0, 0, G_OPTION_ARG_INT, &n_motions,
+    "Number of pointer motions to measure", "N"
+  },
+  { NULL }
+};
+
+static gboolean
+pipewire_loop_source_prepare (GSource *source,
+                              int     *timeout)
+{
+  *timeout = -1;
+  return FALSE;
+}
+
+static gboolean
+pipewire_loop_source_dispatch (GSource     *source,
+                               GSourceFunc  callback,
+                               gpointer     user_data)
+{
+  PipeWireSource *pipewire_source = (PipeWireSource *) source;
+  int result;
+
+  result = pw_loop_iterate (pipewire_source->pipewire_loop, 0);
+  if (result < 0)
+    g_error ("pipewire_loop_iterate failed: %s", spa_strerror (result));
+
+  return TRUE;
+}
+
+static void
+pipewire_loop_source_finalize (GSource *source)
+{
+  PipeWireSource *pipewire_source = (PipeWireSource *) source;
+
+  pw_loop_leave (pipewire_source->pipewire_loop);
+  pw_loop_destroy (pipewire_source->pipewire_loop);
+}
+
+static GSourceFuncs pipewire_source_funcs =
+{
+  pipewire_loop_source_prepare,
+  NULL,
+  pipewire_loop_source_dispatch,
+  pipewire_loop_source_finalize
+};
+
+static GSource *
+create_pipewire_source (struct pw_loop *pipewire_loop)
+{
+  GSource *source;
+  PipeWireSource *pipewire_source;
+
+  source = g_source_new (&pipewire_source_funcs,
+                         sizeof (PipeWireSource));
+
+  pipewire_source = (PipeWireSource *) source;
+  pipewire_source->pipewire_loop = pipewire_loop;
+
+  g_source_add_unix_fd (source,
+                        pw_loop_get_fd (pipewire_source->pipewire_loop),
+                        G_IO_IN | G_IO_ERR);
+
+  pw_loop_enter (pipewire_source->pipewire_loop);
+  g_source_attach (source, NULL);
+
+  return source;
+}
+
+static void
+on_core_error (void       *user_data,
+               uint32_t    id,
+               int         seq,
+               int         res,
+               const char *message)
+{
+  g_error ("PipeWire core error: id:%u %s", id, message);
+}
+
+static const struct pw_core_events core_events = {
+  PW_VERSION_CORE_EVENTS,
+  .error = on_core_error,
+};
+
+static void
+init_pipewire (void)
+{
+  struct pw_loop *pipewire_loop;
+
+  pw_init (NULL, NULL);
+
+  pipewire_loop = pw_loop_new (NULL);
+  g_assert_nonnull (pipewire_loop);
+
+  _pipewire_source = create_pipewire_source (pipewire_loop);
+  _pipewire_context = pw_context_new (pipewire_loop,
+                                      NULL, 0);
+  g_assert_nonnull (_pipewire_context);
+  _pipewire_core = pw_context_connect (_pipewire_context, NULL, 0);
+  g_assert_nonnull (_pipewire_core);
+
+  pw_core_add_listener (_pipewire_core,
+                        &_pipewire_core_listener,
+                        &core_events,
+                        NULL);
+}
+
+static void
+release_pipewire (void)
+{
+  g_clear_pointer (&_pipewire_core, pw_core_disconnect);
+  g_clear_pointer (&_pipewire_context, pw_context_destroy);
+  if (_pipewire_source)
+    {
+      g_source_destroy (_pipewire_source);
+      g_source_unref (_pipewire_source);
+      _pipewire_source = NULL;
+    }
+}
+
+static void
+on_stream_state_changed (void                 *user_data,
+                         enum pw_stream_state  old,
+                         enum pw_stream_state  state,
+                         const char           *error)
+{
+  Stream *stream = user_data;
+
+  if (state == PW_STREAM_STATE_ERROR)
+    g_error ("PipeWire stream error: %s", error);
+
+  stream->state = state;
+}
+
+static void
+on_stream_param_changed (void                 *user_data,
+                         uint32_t              id,
+                         const struct spa_pod *format)
+{
+  Stream *stream = user_data;
+  uint8_t params_buffer[1024];
+  struct spa_pod_builder pod_builder;
+  const struct spa_pod *params[3];
+
+  if (!format || id != SPA_PARAM_Format)
+    return;
+
+  pod_builder = SPA_POD_BUILDER_INIT (params_buffer, sizeof (params_buffer));
+
+  params[0] = spa_pod_builder_add_object (
+    &pod_builder,
+    SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers,
+    SPA_PARAM_BUFFERS_buffers, SPA_POD_CHOICE_RANGE_Int (8, 1, 8),
+    SPA_PARAM_BUFFERS_dataType, SPA_POD_Int ((1 << SPA_DATA_MemPtr) |
+                                             (1 << SPA_DATA_MemFd)),
+    0);
+
+  params[1] = spa_pod_builder_add_object (
+    &pod_builder,
+    SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+    SPA_PARAM_META_type, SPA_POD_Id (SPA_META_Header),
+    SPA_PARAM_META_size, SPA_POD_Int (sizeof (struct spa_meta_header)),
+    0);
+
+  params[2] = spa_pod_builder_add_object (
+    &pod_builder,
+    SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+    SPA_PARAM_META_type, SPA_POD_Id (SPA_META_Cursor),
+    SPA_PARAM_META_size, SPA_POD_CHOICE_RANGE_Int (CURSOR_META_SIZE (384, 384),
+                                                   CURSOR_META_SIZE (1, 1),
+                                                   CURSOR_META_SIZE (384, 384)),
+    0);
+
+  pw_stream_update_params (stream->pipewire_stream,
+                           params, G_N_ELEMENTS (params));
+}
+
+static void
+on_stream_process (void *user_data)
+{
+  Stream *stream = user_data;
+  struct pw_buffer *next_buffer;
+  struct pw_buffer *buffer = NULL;
+  struct spa_meta_header *header;
+
+  if (!stream->pipewire_stream)
+    return;
+
+  next_buffer = pw_stream_dequeue_buffer (stream->pipewire_stream);
+  while (next_buffer)
+    {
+      buffer = next_buffer;
+      next_buffer = pw_stream_dequeue_buffer (stream->pipewire_stream);
+
+      if (next_buffer)
+        pw_stream_queue_buffer (stream->pipewire_stream, buffer);
+    }
+  if (!buffer)
+    return;
+
+  stream->last_buffer_time_us = g_get_monotonic_time ();
+
+  header = spa_buffer_find_meta_data (buffer->buffer,
+                                      SPA_META_Header,
+                                      sizeof (*header));
+  if (header && header->pts > 0)
+    stream->last_buffer_pts_us = header->pts / SPA_NSEC_PER_USEC;
+  else
+    stream->last_buffer_pts_us = 0;
+
+  pw_stream_queue_buffer (stream->pipewire_stream, buffer);
+
+  stream->buffer_count++;
+}
+
+static const struct pw_stream_events stream_events = {
+  PW_VERSION_STREAM_EVENTS,
+  .state_changed = on_stream_state_changed,
+  .param_changed = on_stream_param_changed,
+  .process = on_stream_process,
+};
+
+static void
+stream_connect (Stream *stream)
+{
+  uint8_t params_buffer[1024];
+  struct spa_pod_builder pod_builder;
+  struct spa_rectangle rect;
+  struct spa_fraction min_framerate;
+  struct spa_fraction max_framerate;
+  const struct spa_pod *params[1];
+  int ret;
+
+  stream->pipewire_stream = pw_stream_new (_pipewire_core,
+                                           "mutter-bench-pipewire-stream",
+                                           NULL);
+
+  rect = SPA_RECTANGLE (stream->width, stream->height);
+  min_framerate = SPA_FRACTION (1, 1);
+  max_framerate = SPA_FRACTION (MAX_FRAMERATE, 1);
+
+  pod_builder = SPA_POD_BUILDER_INIT (params_buffer, sizeof (params_buffer));
+  params[0] = spa_pod_builder_add_object (
+    &pod_builder,
+    SPA_TYPE_OBJECT_Format, SPA_PARAM_EnumFormat,
+    SPA_FORMAT_mediaType, SPA_POD_Id (SPA_MEDIA_TYPE_video),
+    SPA_FORMAT_mediaSubtype, SPA_POD_Id (SPA_MEDIA_SUBTYPE_raw),
+    SPA_FORMAT_VIDEO_format, SPA_POD_Id (stream->spa_format),
+    SPA_FORMAT_VIDEO_size, SPA_POD_Rectangle (&rect),
+    SPA_FORMAT_VIDEO_framerate, SPA_POD_Fraction (&SPA_FRACTION(0, 1)),
+    SPA_FORMAT_VIDEO_maxFramerate, SPA_POD_CHOICE_RANGE_Fraction (&max_framerate,
+                                                                  &min_framerate,
+                                                                  &max_framerate),
+    0);
+
+  pw_stream_add_listener (stream->pipewire_stream,
+                          &stream->pipewire_stream_listener,
+                          &stream_events,
+                          stream);
+
+  ret = pw_stream_connect (stream->pipewire_stream,
+                           PW_DIRECTION_INPUT,
+                           stream->pipewire_node_id,
+                           PW_STREAM_FLAG_AUTOCONNECT,
+                           params, 1);
+  if (ret < 0)
+    g_error ("Failed to connect PipeWire stream: %s", g_strerror (-ret));
+}
+
+static void
+on_pipewire_stream_added (MetaDBusScreenCastStream *proxy,
+                          unsigned int              node_id,
+                          Stream                   *stream)
+{
+  stream->pipewire_node_id = (uint32_t) node_id;
+  stream_connect (stream);
+}
+
+static gboolean
+on_timeout (gpointer user_data)
+{
+  gboolean *timed_out = user_data;
+
+  *timed_out = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+iterate_until (int64_t deadline_us)
+{
+  gboolean timed_out = FALSE;
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+  if (now_us >= deadline_us)
+    return;
+
+  g_timeout_add (MAX ((deadline_us - now_us) / 1000, 1), on_timeout, &timed_out);
+  while (!timed_out)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+stream_wait_for_render (Stream *stream)
+{
+  int initial_buffer_count = stream->buffer_count;
+
+  while (stream->buffer_count == initial_buffer_count)
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static uint32_t
+spa_format_from_name (const char *name)
+{
+  if (!name || g_str_equal (name, "BGRx"))
+    return SPA_VIDEO_FORMAT_BGRx;
+  else if (g_str_equal (name, "BGRA"))
+    return SPA_VIDEO_FORMAT_BGRA;
+  else if (g_str_equal (name, "NV12"))
+    return SPA_VIDEO_FORMAT_NV12;
+
+  g_error ("Unknown format '%s'", name);
+}
+
+static uint32_t
+cursor_mode_from_name (const char *name)
+{
+  if (!name || g_str_equal (name, "hidden"))
+    return 0;
+  else if (g_str_equal (name, "embedded"))
+    return 1;
+  else if (g_str_equal (name, "metadata"))
+    return 2;
+
+  g_error ("Unknown cursor mode '%s'", name);
+}
+
+static void
+measure (MetaDBusRemoteDesktopSession *remote_desktop_session_proxy,
+         Stream                       *stream,
+         Results                      *results)
+{
+  const char *stream_path =
+    g_dbus_proxy_get_object_path (G_DBUS_PROXY (stream->proxy));
+  int64_t interval_us = G_USEC_PER_SEC / MAX_FRAMERATE;
+  int i;
+
+  for (i = 0; i < n_motions; i++)
+    {
+      g_autoptr (GError) error = NULL;
+      int64_t motion_time_us;
+      int initial_buffer_count;
+
+      initial_buffer_count = stream->buffer_count;
+      motion_time_us = g_get_monotonic_time ();
+
+      /* Move along the diagonal, so that every motion changes both the
+       * cursor position and the damaged part of the stage */
+      if (!meta_dbus_remote_desktop_session_call_notify_pointer_motion_absolute_sync (
+            remote_desktop_session_proxy,
+            stream_path,
+            i % stream->width, i % stream->height,
+            NULL, &error))
+        g_error ("Failed to move pointer: %s", error->message);
+
+      iterate_until (motion_time_us + interval_us);
+
+      results->n_motions++;
+
+      if (stream->buffer_count == initial_buffer_count)
+        {
+          results->n_dropped++;
+          continue;
+        }
+
+      results->n_frames += stream->buffer_count - initial_buffer_count;
+      results->total_latency_us += stream->last_buffer_time_us - motion_time_us;
+      results->max_latency_us = MAX (results->max_latency_us,
+                                     stream->last_buffer_time_us -
+                                     motion_time_us);
+
+      if (stream->last_buffer_pts_us &&
+          stream->last_buffer_pts_us <= stream->last_buffer_time_us)
+        {
+          results->n_queue_latencies++;
+          results->total_queue_latency_us +=
+            stream->last_buffer_time_us - stream->last_buffer_pts_us;
+        }
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (GOptionContext) option_context = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (MetaDBusRemoteDesktop) remote_desktop_proxy = NULL;
+  g_autoptr (MetaDBusRemoteDesktopSession) remote_desktop_session_proxy = NULL;
+  g_autoptr (MetaDBusScreenCast) screen_cast_proxy = NULL;
+  g_autoptr (MetaDBusScreenCastSession) screen_cast_session_proxy = NULL;
+  g_autofree char *remote_desktop_session_path = NULL;
+  g_autofree char *screen_cast_session_path = NULL;
+  g_autofree char *stream_path = NULL;
+  GVariantBuilder properties_builder;
+  Results results = { 0 };
+  Stream stream = { 0 };
+
+  option_context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (option_context, options, NULL);
+  if (!g_option_context_parse (option_context, &argc, &argv, &error))
+    g_error ("Invalid arguments: %s", error->message);
+
+  stream.spa_format = spa_format_from_name (format_name);
+  stream.width = stream_width;
+  stream.height = stream_height;
+
+  init_pipewire ();
+
+  remote_desktop_proxy = meta_dbus_remote_desktop_proxy_new_for_bus_sync (
+    G_BUS_TYPE_SESSION,
+    G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+    "org.gnome.Mutter.RemoteDesktop",
+    "/org/gnome/Mutter/RemoteDesktop",
+    NULL,
+    &error);
+  if (!remote_desktop_proxy)
+    g_error ("Failed to acquire proxy: %s", error->message);
+
+  screen_cast_proxy = meta_dbus_screen_cast_proxy_new_for_bus_sync (
+    G_BUS_TYPE_SESSION,
+    G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+    "org.gnome.Mutter.ScreenCast",
+    "/org/gnome/Mutter/ScreenCast",
+    NULL,
+    &error);
+  if (!screen_cast_proxy)
+    g_error ("Failed to acquire proxy: %s", error->message);
+
+  if (!meta_dbus_remote_desktop_call_create_session_sync (
+        remote_desktop_proxy,
+        &remote_desktop_session_path,
+        NULL,
+        &error))
+    g_error ("Failed to create session: %s", error->message);
+
+  remote_desktop_session_proxy =
+    meta_dbus_remote_desktop_session_proxy_new_for_bus_sync (
+      G_BUS_TYPE_SESSION,
+      G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+      "org.gnome.Mutter.RemoteDesktop",
+      remote_desktop_session_path,
+      NULL,
+      &error);
+  if (!remote_desktop_session_proxy)
+    g_error ("Failed to acquire proxy: %s", error->message);
+
+  g_variant_builder_init (&properties_builder, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_builder_add (&properties_builder, "{sv}",
+                         "remote-desktop-session-id",
+                         g_variant_new_string (
+                           meta_dbus_remote_desktop_session_get_session_id (
+                             remote_desktop_session_proxy)));
+
+  if (!meta_dbus_screen_cast_call_create_session_sync (
+        screen_cast_proxy,
+        g_variant_builder_end (&properties_builder),
+        &screen_cast_session_path,
+        NULL,
+        &error))
+    g_error ("Failed to create session: %s", error->message);
+
+  screen_cast_session_proxy =
+    meta_dbus_screen_cast_session_proxy_new_for_bus_sync (
+      G_BUS_TYPE_SESSION,
+      G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+      "org.gnome.Mutter.ScreenCast",
+      screen_cast_session_path,
+      NULL,
+      &error);
+  if (!screen_cast_session_proxy)
+    g_error ("Failed to acquire proxy: %s", error->message);
+
+  g_variant_builder_init (&properties_builder, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_builder_add (&properties_builder, "{sv}",
+                         "cursor-mode",
+                         g_variant_new_uint32 (
+                           cursor_mode_from_name (cursor_mode_name)));
+
+  if (!meta_dbus_screen_cast_session_call_record_virtual_sync (
+        screen_cast_session_proxy,
+        g_variant_builder_end (&properties_builder),
+        &stream_path,
+        NULL,
+        &error))
+    g_error ("Failed to record virtual monitor: %s", error->message);
+
+  stream.proxy = meta_dbus_screen_cast_stream_proxy_new_for_bus_sync (
+    G_BUS_TYPE_SESSION,
+    G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
+    "org.gnome.Mutter.ScreenCast",
+    stream_path,
+    NULL,
+    &error);
+  if (!stream.proxy)
+    g_error ("Failed to acquire proxy: %s", error->message);
+
+  g_signal_connect (stream.proxy, "pipewire-stream-added",
+                    G_CALLBACK (on_pipewire_stream_added),
+                    &stream);
+
+  if (!meta_dbus_remote_desktop_session_call_start_sync (
+        remote_desktop_session_proxy,
+        NULL,
+        &error))
+    g_error ("Failed to start session: %s", error->message);
+
+  while (stream.state != PW_STREAM_STATE_STREAMING)
+    g_main_context_iteration (NULL, TRUE);
+  stream_wait_for_render (&stream);
+
+  measure (remote_desktop_session_proxy, &stream, &results);
+
+  g_print ("{\"benchmark\": \"screen-cast-virtual\", "
+           "\"cursor-mode\": \"%s\", \"format\": \"%s\", "
+           "\"width\": %d, \"height\": %d, "
+           "\"motions\": %d, \"frames\": %d, \"dropped\": %d, "
+           "\"latency-usec-mean\": %.1f, \"latency-usec-max\": %" G_GINT64_FORMAT ", "
+           "\"queue-latency-usec-mean\": %.1f}\n",
+           cursor_mode_name ? cursor_mode_name : "hidden",
+           format_name ? format_name : "BGRx",
+           stream.width, stream.height,
+           results.n_motions, results.n_frames, results.n_dropped,
+           (results.n_motions - results.n_dropped) > 0 ?
+           (double) results.total_latency_us /
+           (results.n_motions - results.n_dropped) : 0.0,
+           results.max_latency_us,
+           results.n_queue_latencies > 0 ?
+           (double) results.total_queue_latency_us /
+           results.n_queue_latencies : 0.0);
+
+  if (!meta_dbus_remote_desktop_session_call_stop_sync (
+        remote_desktop_session_proxy,
+        NULL,
+        &error))
+    g_error ("Failed to stop session: %s", error->message);
+
+  g_clear_pointer (&stream.pipewire_stream, pw_stream_destroy);
+  g_clear_object (&stream.proxy);
+
+  release_pipewire ();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Benchmarks the screen cast pipeline of a headless compositor.
+ *
+ * For every combination of cursor mode, format and size, the
+ * mutter-screen-cast-bench-client consumer records a virtual monitor and
+ * drives it with pointer motion, printing frame timings, latency and
+ * dropped frames as a line of JSON. Afterwards, a second line reports what
+ * the compositor spent on it, e.g.
+ *
+ *   {"benchmark": "screen-cast-compositor", "cursor-mode": "embedded", "format": "BGRx", "width": 1920, "height": 1080, "cpu-usec": 123456}
+ *
+ * Since the headless backend renders on the CPU, the CPU time includes
+ * the rendering and the copies into the stream buffers. The number of
+ * pointer motions can be scaled with MUTTER_BENCHMARK_SCALE.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "meta-test/meta-context-test.h"
+
+#define N_MOTIONS 300
+
+typedef struct _BenchConfig
+{
+  const char *cursor_mode;
+  const char *format;
+  int width;
+  int height;
+} BenchConfig;
+
+static const BenchConfig bench_configs[] = {
+  { "hidden", "BGRx", 1280, 720 },
+  { "hidden", "BGRx", 1920, 1080 },
+  { "hidden", "BGRx", 3840, 2160 },
+  { "embedded", "BGRx", 1920, 1080 },
+  { "metadata", "BGRx", 1920, 1080 },
+  { "hidden", "BGRA", 1920, 1080 },
+  { "hidden", "NV12", 1920, 1080 },
+};
+
+static int n_motions = N_MOTIONS;
+
+static int64_t
+get_cpu_time_us (void)
+{
+  struct rusage usage;
+
+  g_assert_cmpint (getrusage (RUSAGE_SELF, &usage), ==, 0);
+
+  return ((usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * G_USEC_PER_SEC +
+          usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+static void
+bench_client_exited (GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  g_autoptr (GError) error = NULL;
+
+  if (!g_subprocess_wait_check_finish (G_SUBPROCESS (source_object),
+                                       result,
+                                       &error))
+    g_error ("Screen cast benchmark client failed: %s", error->message);
+
+  g_main_loop_quit (user_data);
+}
+
+static void
+run_bench (gconstpointer user_data)
+{
+  const BenchConfig *config = user_data;
+  g_autoptr (GSubprocessLauncher) launcher = NULL;
+  g_autoptr (GSubprocess) subprocess = NULL;
+  g_autoptr (GMainLoop) loop = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *client_path = NULL;
+  g_autofree char *width = NULL;
+  g_autofree char *height = NULL;
+  g_autofree char *motions = NULL;
+  int64_t start_cpu_time_us;
+
+  client_path = g_test_build_filename (G_TEST_BUILT,
+                                       "src",
+                                       "tests",
+                                       "mutter-screen-cast-bench-client",
+                                       NULL);
+  width = g_strdup_printf ("%d", config->width);
+  height = g_strdup_printf ("%d", config->height);
+  motions = g_strdup_printf ("%d", n_motions);
+
+  launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_NONE);
+  g_subprocess_launcher_setenv (launcher,
+                                "XDG_RUNTIME_DIR", getenv ("XDG_RUNTIME_DIR"),
+                                TRUE);
+
+  start_cpu_time_us = get_cpu_time_us ();
+
+  subprocess = g_subprocess_launcher_spawn (launcher,
+                                            &error,
+                                            client_path,
+                                            "--cursor-mode", config->cursor_mode,
+                                            "--format", config->format,
+                                            "--width", width,
+                                            "--height", height,
+                                            "--motions", motions,
+                                            NULL);
+  if (!subprocess)
+    g_error ("Failed to launch screen cast benchmark client: %s",
+             error->message);
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_subprocess_wait_check_async (subprocess,
+                                 NULL,
+                                 bench_client_exited,
+                                 loop);
+  g_main_loop_run (loop);
+
+  g_print ("{\"benchmark\": \"screen-cast-compositor\", "
+           "\"cursor-mode\": \"%s\", \"format\": \"%s\", "
+           "\"width\": %d, \"height\": %d, "
+           "\"cpu-usec\": %" G_GINT64_FORMAT "}\n",
+           config->cursor_mode, config->format,
+           config->width, config->height,
+           get_cpu_time_us () - start_cpu_time_us);
+}
+
+static void
+init_benchmarks (void)
+{
+  const char *scale;
+  size_t i;
+
+  scale = g_getenv ("MUTTER_BENCHMARK_SCALE");
+  if (scale)
+    n_motions = MAX ((int) (N_MOTIONS * g_ascii_strtod (scale, NULL)), 1);
+
+  for (i = 0; i < G_N_ELEMENTS (bench_configs); i++)
+    {
+      const BenchConfig *config = &bench_configs[i];
+      g_autofree char *path = NULL;
+
+      path = g_strdup_printf ("/backends/native/screen-cast/bench/%s/%s/%dx%d",
+                              config->cursor_mode,
+                              config->format,
+                              config->width,
+                              config->height);
+      g_test_add_data_func (path, config, run_bench);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert (meta_context_configure (context, &argc, &argv, NULL));
+
+  init_benchmarks ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
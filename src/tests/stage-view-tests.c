@@ -18,6 +18,7 @@
 #include "config.h"
 
 #include "clutter/clutter.h"
+#include "clutter/clutter-stage-private.h"
 #include "clutter/clutter-stage-view-private.h"
 #include "compositor/meta-window-actor-private.h"
 #include "meta-test/meta-context-test.h"
@@ -666,6 +667,74 @@ meta_test_actor_stage_views_frame_clock (void)
   clutter_actor_destroy (actor_3);
 }
 
+static void
+on_allocation_changed (ClutterActor *actor,
+                       GParamSpec   *pspec,
+                       int          *n_allocations)
+{
+  (*n_allocations)++;
+}
+
+static void
+meta_test_actor_stage_views_scoped_relayout (void)
+{
+  MetaBackend *backend = test_backend;
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  ClutterActor *group;
+  ClutterActor *actor_1;
+  ClutterActor *actor_2;
+  GList *stage_views;
+  int n_allocations_1 = 0;
+  int n_allocations_2 = 0;
+
+  stage_views = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage));
+  g_assert_cmpint (g_list_length (stage_views), ==, 2);
+
+  /* Relayouts of children of a no-layout actor are queued separately. */
+  group = clutter_actor_new ();
+  clutter_actor_set_flags (group, CLUTTER_ACTOR_NO_LAYOUT);
+  clutter_actor_add_child (stage, group);
+
+  actor_1 = clutter_actor_new ();
+  clutter_actor_set_size (actor_1, 100, 100);
+  clutter_actor_set_position (actor_1, 100, 100);
+  clutter_actor_add_child (group, actor_1);
+
+  actor_2 = clutter_actor_new ();
+  clutter_actor_set_size (actor_2, 100, 100);
+  clutter_actor_set_position (actor_2, 1100, 100);
+  clutter_actor_add_child (group, actor_2);
+
+  clutter_actor_show (stage);
+
+  wait_for_paint (stage);
+
+  is_on_stage_views (actor_1, 1, stage_views->data);
+  is_on_stage_views (actor_2, 1, stage_views->next->data);
+
+  g_signal_connect (actor_1, "notify::allocation",
+                    G_CALLBACK (on_allocation_changed), &n_allocations_1);
+  g_signal_connect (actor_2, "notify::allocation",
+                    G_CALLBACK (on_allocation_changed), &n_allocations_2);
+
+  clutter_actor_set_size (actor_1, 50, 50);
+  clutter_actor_set_size (actor_2, 50, 50);
+
+  /* Only the actor on the first view is relayouted. */
+  clutter_stage_maybe_relayout_for_view (CLUTTER_STAGE (stage),
+                                         stage_views->data);
+  g_assert_cmpint (n_allocations_1, ==, 1);
+  g_assert_cmpint (n_allocations_2, ==, 0);
+
+  /* The second actor is still queued for its own view. */
+  clutter_stage_maybe_relayout_for_view (CLUTTER_STAGE (stage),
+                                         stage_views->next->data);
+  g_assert_cmpint (n_allocations_1, ==, 1);
+  g_assert_cmpint (n_allocations_2, ==, 1);
+
+  clutter_actor_destroy (group);
+}
+
 typedef struct _TimelineTest
 {
   GMainLoop *main_loop;
@@ -1342,6 +1411,8 @@ init_tests (void)
                    meta_test_actor_stage_views_hot_plug);
   g_test_add_func ("/stage-views/actor-stage-views-frame-clock",
                    meta_test_actor_stage_views_frame_clock);
+  g_test_add_func ("/stage-views/actor-stage-views-scoped-relayout",
+                   meta_test_actor_stage_views_scoped_relayout);
   g_test_add_func ("/stage-views/actor-stage-views-timeline",
                    meta_test_actor_stage_views_timeline);
   g_test_add_func ("/stage-views/actor-stage-views-parent-rebuilt",
@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Load generator for mutter-compositor-bench.
+ *
+ * Maps a number of toplevels called "bench-0", "bench-1", ..., each
+ * optionally carrying a grid of small subsurfaces, and redraws all of them
+ * with a new color every time the compositor sends a frame callback. It
+ * exits once the most recently mapped toplevel, which is the one on top
+ * and thus never throttled, has drawn the requested number of frames.
+ *
+ * Exits with 77 if dma-buf buffers are requested but not available.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <wayland-client.h>
+
+#include "wayland-test-client-utils.h"
+
+#define SUBSURFACE_SIZE 32
+#define EXIT_SKIP 77
+
+typedef struct _BenchWindow
+{
+  WaylandSurface *surface;
+
+  struct wl_surface **subsurface_surfaces;
+  struct wl_subsurface **subsurfaces;
+
+  struct wl_callback *frame_callback;
+  int n_frames;
+} BenchWindow;
+
+static WaylandDisplay *display;
+
+static BenchWindow *windows;
+
+static int n_windows = 1;
+static int n_subsurfaces = 0;
+static int n_frames = 120;
+static int window_width = 640;
+static int window_height = 480;
+static char *buffer_type = NULL;
+
+static gboolean running;
+
+static GOptionEntry options[] = {
+  {
+    "windows", 0, 0, G_OPTION_ARG_INT, &n_windows,
+    "Number of toplevels to map", "N"
+  },
+  {
+    "subsurfaces", 0, 0, G_OPTION_ARG_INT, &n_subsurfaces,
+    "Number of subsurfaces per toplevel", "N"
+  },
+  {
+    "frames", 0, 0, G_OPTION_ARG_INT, &n_frames,
+    "Number of frames to draw", "N"
+  },
+  {
+    "width", 0, 0, G_OPTION_ARG_INT, &window_width,
+    "Width of the toplevels", "WIDTH"
+  },
+  {
+    "height", 0, 0, G_OPTION_ARG_INT, &window_height,
+    "Height of the toplevels", "HEIGHT"
+  },
+  {
+    "buffer-type", 0, 0, G_OPTION_ARG_STRING, &buffer_type,
+    "Buffer type (shm or dma-buf)", "TYPE"
+  },
+  { NULL }
+};
+
+static uint32_t
+get_frame_color (int window_index,
+                 int frame)
+{
+  uint8_t shade = (frame * 4 + window_index * 32) & 0xff;
+
+  return 0xff000000 | (shade << 16) | ((255 - shade) << 8) | 0x40;
+}
+
+static void draw_window (BenchWindow *window);
+
+static void
+handle_frame_callback (void               *data,
+                       struct wl_callback *callback,
+                       uint32_t            time)
+{
+  BenchWindow *window = data;
+
+  g_clear_pointer (&window->frame_callback, wl_callback_destroy);
+
+  window->n_frames++;
+
+  if (window == &windows[n_windows - 1] &&
+      window->n_frames >= n_frames)
+    {
+      running = FALSE;
+      return;
+    }
+
+  draw_window (window);
+}
+
+static const struct wl_callback_listener frame_listener = {
+  handle_frame_callback,
+};
+
+static void
+draw_window (BenchWindow *window)
+{
+  int window_index = window - windows;
+  int i;
+
+  for (i = 0; i < n_subsurfaces; i++)
+    {
+      draw_surface (display, window->subsurface_surfaces[i],
+                    SUBSURFACE_SIZE, SUBSURFACE_SIZE,
+                    get_frame_color (window_index + i + 1, window->n_frames));
+      wl_surface_damage_buffer (window->subsurface_surfaces[i],
+                                0, 0, SUBSURFACE_SIZE, SUBSURFACE_SIZE);
+      wl_surface_commit (window->subsurface_surfaces[i]);
+    }
+
+  draw_surface (display, window->surface->wl_surface,
+                window->surface->width, window->surface->height,
+                get_frame_color (window_index, window->n_frames));
+  wl_surface_damage_buffer (window->surface->wl_surface,
+                            0, 0,
+                            window->surface->width, window->surface->height);
+
+  window->frame_callback = wl_surface_frame (window->surface->wl_surface);
+  wl_callback_add_listener (window->frame_callback, &frame_listener, window);
+  wl_surface_commit (window->surface->wl_surface);
+}
+
+static void
+init_subsurfaces (BenchWindow *window)
+{
+  int columns = MAX (window_width / SUBSURFACE_SIZE, 1);
+  int i;
+
+  window->subsurface_surfaces = g_new0 (struct wl_surface *, n_subsurfaces);
+  window->subsurfaces = g_new0 (struct wl_subsurface *, n_subsurfaces);
+
+  for (i = 0; i < n_subsurfaces; i++)
+    {
+      window->subsurface_surfaces[i] =
+        wl_compositor_create_surface (display->compositor);
+      window->subsurfaces[i] =
+        wl_subcompositor_get_subsurface (display->subcompositor,
+                                         window->subsurface_surfaces[i],
+                                         window->surface->wl_surface);
+      wl_subsurface_set_position (window->subsurfaces[i],
+                                  (i % columns) * SUBSURFACE_SIZE,
+                                  (i / columns) * SUBSURFACE_SIZE);
+    }
+}
+
+static void
+destroy_window (BenchWindow *window)
+{
+  int i;
+
+  g_clear_pointer (&window->frame_callback, wl_callback_destroy);
+
+  for (i = 0; i < n_subsurfaces; i++)
+    {
+      wl_subsurface_destroy (window->subsurfaces[i]);
+      wl_surface_destroy (window->subsurface_surfaces[i]);
+    }
+  g_free (window->subsurfaces);
+  g_free (window->subsurface_surfaces);
+
+  g_clear_object (&window->surface);
+}
+
+static gboolean
+is_configured (void)
+{
+  int i;
+
+  for (i = 0; i < n_windows; i++)
+    {
+      if (windows[i].surface->width == 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (GOptionContext) option_context = NULL;
+  g_autoptr (GError) error = NULL;
+  int i;
+
+  option_context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (option_context, options, NULL);
+  if (!g_option_context_parse (option_context, &argc, &argv, &error))
+    g_error ("Invalid arguments: %s", error->message);
+
+  g_assert_cmpint (n_windows, >, 0);
+  g_assert_cmpint (n_subsurfaces, >=, 0);
+
+  display = wayland_display_new (WAYLAND_DISPLAY_CAPABILITY_NONE);
+
+  if (g_strcmp0 (buffer_type, "dma-buf") == 0)
+    {
+      if (!display->gbm_device)
+        {
+          g_printerr ("No dma-buf capable device available\n");
+          return EXIT_SKIP;
+        }
+    }
+  else if (!buffer_type || g_strcmp0 (buffer_type, "shm") == 0)
+    {
+      g_clear_pointer (&display->gbm_device, gbm_device_destroy);
+    }
+  else
+    {
+      g_error ("Unknown buffer type '%s'", buffer_type);
+    }
+
+  windows = g_new0 (BenchWindow, n_windows);
+  for (i = 0; i < n_windows; i++)
+    {
+      g_autofree char *title = NULL;
+
+      title = g_strdup_printf ("bench-%d", i);
+      windows[i].surface = wayland_surface_new (display, title,
+                                                window_width, window_height,
+                                                get_frame_color (i, 0));
+      wl_surface_commit (windows[i].surface->wl_surface);
+    }
+
+  while (!is_configured ())
+    {
+      if (wl_display_dispatch (display->display) == -1)
+        return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < n_windows; i++)
+    {
+      init_subsurfaces (&windows[i]);
+      draw_window (&windows[i]);
+    }
+
+  running = TRUE;
+  while (running)
+    {
+      if (wl_display_dispatch (display->display) == -1)
+        return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < n_windows; i++)
+    destroy_window (&windows[i]);
+  g_free (windows);
+
+  wl_display_roundtrip (display->display);
+  g_object_unref (display);
+
+  return EXIT_SUCCESS;
+}
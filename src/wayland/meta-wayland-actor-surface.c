@@ -166,6 +166,18 @@ meta_wayland_actor_surface_get_geometry_scale (MetaWaylandActorSurface *actor_su
   return actor_surface_class->get_geometry_scale (actor_surface);
 }
 
+static gboolean
+should_infer_opaque_region (MetaWaylandSurface *surface)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (surface->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+
+  return meta_settings_is_experimental_feature_enabled (
+    settings, META_EXPERIMENTAL_FEATURE_INFER_OPAQUE_REGIONS);
+}
+
 static void
 meta_wayland_actor_surface_real_sync_actor_state (MetaWaylandActorSurface *actor_surface)
 {
@@ -179,6 +191,7 @@ meta_wayland_actor_surface_real_sync_actor_state (MetaWaylandActorSurface *actor
   MetaShapedTexture *stex;
   MetaWaylandBuffer *buffer;
   MtkRectangle surface_rect;
+  gboolean infer_opaque_region;
   MetaWaylandSurface *subsurface_surface;
 
   surface_actor = priv->actor;
@@ -228,6 +241,8 @@ meta_wayland_actor_surface_real_sync_actor_state (MetaWaylandActorSurface *actor
         meta_surface_actor_set_input_region (surface_actor, NULL);
       }
 
+    infer_opaque_region = FALSE;
+
     if (!meta_shaped_texture_has_alpha (stex))
       {
         g_autoptr (MtkRegion) opaque_region = NULL;
@@ -246,7 +261,11 @@ meta_wayland_actor_surface_real_sync_actor_state (MetaWaylandActorSurface *actor
     else
       {
         meta_surface_actor_set_opaque_region (surface_actor, NULL);
+        infer_opaque_region = should_infer_opaque_region (surface);
       }
+
+    meta_surface_actor_set_infer_opaque_region (surface_actor,
+                                                infer_opaque_region);
   }
 
   meta_shaped_texture_set_transform (stex, surface->buffer_transform);
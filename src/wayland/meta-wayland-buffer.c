@@ -49,6 +49,7 @@
 #include "wayland/meta-wayland-buffer.h"
 
 #include <drm_fourcc.h>
+#include <string.h>
 
 #include "backends/meta-backend-private.h"
 #include "clutter/clutter.h"
@@ -68,6 +69,30 @@
 
 #define META_WAYLAND_SHM_MAX_PLANES 4
 
+/* Damage smaller than this is uploaded directly while processing the commit,
+ * as handing it to a thread would cost more than it saves. */
+#define META_WAYLAND_SHM_ASYNC_UPLOAD_MIN_BYTES (256 * 1024)
+
+typedef struct _MetaWaylandShmUpload
+{
+  MetaWaylandBuffer *buffer;
+  struct wl_shm_buffer *shm_buffer;
+  struct wl_shm_pool *shm_pool;
+  int stride;
+
+  CoglTexture *texture;
+  CoglPixelFormat format;
+  int bpp;
+  MtkRegion *region;
+
+  CoglBuffer *pixel_buffer;
+  uint8_t *staging_data;
+
+  GMutex mutex;
+  GCond cond;
+  gboolean copied;
+} MetaWaylandShmUpload;
+
 enum
 {
   RESOURCE_DESTROYED,
@@ -82,12 +107,44 @@ G_DEFINE_TYPE (MetaWaylandBuffer, meta_wayland_buffer, G_TYPE_OBJECT);
 MetaFormatInfo supported_shm_formats[G_N_ELEMENTS (meta_format_info)];
 size_t n_supported_shm_formats = 0;
 
+static gboolean
+is_shm_upload_copied (MetaWaylandShmUpload *upload)
+{
+  gboolean copied;
+
+  g_mutex_lock (&upload->mutex);
+  copied = upload->copied;
+  g_mutex_unlock (&upload->mutex);
+
+  return copied;
+}
+
+static void
+wait_for_shm_upload_copy (MetaWaylandShmUpload *upload)
+{
+  g_mutex_lock (&upload->mutex);
+  while (!upload->copied)
+    g_cond_wait (&upload->cond, &upload->mutex);
+  g_mutex_unlock (&upload->mutex);
+}
+
 static void
 meta_wayland_buffer_destroy_handler (struct wl_listener *listener,
                                      void               *data)
 {
   MetaWaylandBuffer *buffer =
     wl_container_of (listener, buffer, destroy_listener);
+  GList *l;
+
+  /* The wl_shm_buffer goes away with the resource, so any copy still reading
+   * from it has to be finished first. */
+  for (l = buffer->compositor->pending_shm_uploads.head; l; l = l->next)
+    {
+      MetaWaylandShmUpload *upload = l->data;
+
+      if (upload->buffer == buffer)
+        wait_for_shm_upload_copy (upload);
+    }
 
   buffer->resource = NULL;
   wl_list_remove (&buffer->destroy_listener.link);
@@ -135,6 +192,45 @@ meta_wayland_buffer_is_realized (MetaWaylandBuffer *buffer)
   return buffer->type != META_WAYLAND_BUFFER_TYPE_UNKNOWN;
 }
 
+static uint32_t
+shm_to_drm_format (enum wl_shm_format format)
+{
+  if (format == WL_SHM_FORMAT_ARGB8888)
+    return DRM_FORMAT_ARGB8888;
+  if (format == WL_SHM_FORMAT_XRGB8888)
+    return DRM_FORMAT_XRGB8888;
+
+  /* all other wayland shm formats are the same as the drm format */
+  return format;
+}
+
+static const char *
+shm_format_to_string (MetaDrmFormatBuf   *format_buf,
+                      enum wl_shm_format  shm_format)
+{
+  uint32_t drm_format;
+
+  drm_format = shm_to_drm_format (shm_format);
+  return meta_drm_format_to_string (format_buf, drm_format);
+}
+
+static const MetaFormatInfo *
+get_supported_shm_format_info (uint32_t shm_format)
+{
+  size_t i;
+
+  for (i = 0; i < n_supported_shm_formats; i++)
+    {
+      uint32_t drm_format;
+
+      drm_format = shm_to_drm_format (shm_format);
+      if (supported_shm_formats[i].drm_format == drm_format)
+        return &supported_shm_formats[i];
+    }
+
+  return NULL;
+}
+
 gboolean
 meta_wayland_buffer_realize (MetaWaylandBuffer *buffer)
 {
@@ -143,10 +239,14 @@ meta_wayland_buffer_realize (MetaWaylandBuffer *buffer)
 #endif
   MetaWaylandDmaBufBuffer *dma_buf;
   MetaWaylandSinglePixelBuffer *single_pixel_buffer;
+  struct wl_shm_buffer *shm_buffer;
 
-  if (wl_shm_buffer_get (buffer->resource) != NULL)
+  shm_buffer = wl_shm_buffer_get (buffer->resource);
+  if (shm_buffer)
     {
       buffer->type = META_WAYLAND_BUFFER_TYPE_SHM;
+      buffer->shm.format_info =
+        get_supported_shm_format_info (wl_shm_buffer_get_format (shm_buffer));
       return TRUE;
     }
 
@@ -212,45 +312,6 @@ meta_wayland_buffer_realize (MetaWaylandBuffer *buffer)
   return FALSE;
 }
 
-static uint32_t
-shm_to_drm_format (enum wl_shm_format format)
-{
-  if (format == WL_SHM_FORMAT_ARGB8888)
-    return DRM_FORMAT_ARGB8888;
-  if (format == WL_SHM_FORMAT_XRGB8888)
-    return DRM_FORMAT_XRGB8888;
-
-  /* all other wayland shm formats are the same as the drm format */
-  return format;
-}
-
-static const char *
-shm_format_to_string (MetaDrmFormatBuf   *format_buf,
-                      enum wl_shm_format  shm_format)
-{
-  uint32_t drm_format;
-
-  drm_format = shm_to_drm_format (shm_format);
-  return meta_drm_format_to_string (format_buf, drm_format);
-}
-
-static const MetaFormatInfo *
-get_supported_shm_format_info (uint32_t shm_format)
-{
-  size_t i;
-
-  for (i = 0; i < n_supported_shm_formats; i++)
-    {
-      uint32_t drm_format;
-
-      drm_format = shm_to_drm_format (shm_format);
-      if (supported_shm_formats[i].drm_format == drm_format)
-        return &supported_shm_formats[i];
-    }
-
-  return NULL;
-}
-
 static CoglTexture *
 texture_from_bitmap (CoglBitmap  *bitmap,
                      GError     **error)
@@ -391,6 +452,33 @@ multi_texture_from_shm (CoglContext           *cogl_context,
                                  n_planes);
 }
 
+static gboolean
+is_shm_buffer_opaque_black (struct wl_shm_buffer *shm_buffer)
+{
+  uint32_t shm_format;
+  uint32_t pixel;
+
+  /* A single pixel shm buffer is the pre wp_single_pixel_buffer_v1 way of
+   * painting a solid color, and is treated the same way. */
+  if (wl_shm_buffer_get_width (shm_buffer) != 1 ||
+      wl_shm_buffer_get_height (shm_buffer) != 1)
+    return FALSE;
+
+  shm_format = wl_shm_buffer_get_format (shm_buffer);
+  if (shm_format != WL_SHM_FORMAT_XRGB8888 &&
+      shm_format != WL_SHM_FORMAT_ARGB8888)
+    return FALSE;
+
+  wl_shm_buffer_begin_access (shm_buffer);
+  pixel = *(const uint32_t *) wl_shm_buffer_get_data (shm_buffer);
+  wl_shm_buffer_end_access (shm_buffer);
+
+  if (shm_format == WL_SHM_FORMAT_ARGB8888 && (pixel >> 24) != 0xff)
+    return FALSE;
+
+  return (pixel & 0x00ffffff) == 0;
+}
+
 static gboolean
 shm_buffer_attach (MetaWaylandBuffer  *buffer,
                    MetaMultiTexture  **texture,
@@ -415,7 +503,7 @@ shm_buffer_attach (MetaWaylandBuffer  *buffer,
   height = wl_shm_buffer_get_height (shm_buffer);
   shm_format = wl_shm_buffer_get_format (shm_buffer);
 
-  format_info = get_supported_shm_format_info (shm_format);
+  format_info = buffer->shm.format_info;
   if (!format_info)
     {
       g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
@@ -426,6 +514,8 @@ shm_buffer_attach (MetaWaylandBuffer  *buffer,
   cogl_format = format_info->cogl_format;
   multi_format = format_info->multi_texture_format;
 
+  buffer->shm.is_opaque_black = is_shm_buffer_opaque_black (shm_buffer);
+
   meta_topic (META_DEBUG_WAYLAND,
               "[wl-shm] wl_buffer@%u wl_shm_format %s "
               "-> MetaMultiTextureFormat %s / CoglPixelFormat %s",
@@ -708,6 +798,18 @@ meta_wayland_buffer_inc_use_count (MetaWaylandBuffer *buffer)
   buffer->use_count++;
 }
 
+static void
+signal_release_points (MetaWaylandBuffer *buffer)
+{
+  GList *l;
+
+  for (l = buffer->release_points; l; l = l->next)
+    meta_wayland_sync_point_signal (l->data);
+
+  g_clear_list (&buffer->release_points,
+                (GDestroyNotify) meta_wayland_sync_point_free);
+}
+
 void
 meta_wayland_buffer_dec_use_count (MetaWaylandBuffer *buffer)
 {
@@ -715,16 +817,282 @@ meta_wayland_buffer_dec_use_count (MetaWaylandBuffer *buffer)
 
   buffer->use_count--;
 
-  if (buffer->use_count == 0 && buffer->resource)
+  if (buffer->use_count > 0)
+    return;
+
+  signal_release_points (buffer);
+
+  if (buffer->resource)
     wl_buffer_send_release (buffer->resource);
 }
 
+/**
+ * meta_wayland_buffer_add_release_point:
+ * @buffer: a #MetaWaylandBuffer
+ * @release_point: (transfer full): an explicit sync release point
+ *
+ * Adds a release point to signal once the buffer isn't used anymore, i.e.
+ * when it is neither applied to a surface, waiting in a transaction nor
+ * being scanned out.
+ */
+void
+meta_wayland_buffer_add_release_point (MetaWaylandBuffer    *buffer,
+                                       MetaWaylandSyncPoint *release_point)
+{
+  g_return_if_fail (buffer->use_count > 0);
+
+  buffer->release_points = g_list_prepend (buffer->release_points,
+                                           release_point);
+}
+
 gboolean
 meta_wayland_buffer_is_y_inverted (MetaWaylandBuffer *buffer)
 {
   return buffer->is_y_inverted;
 }
 
+/**
+ * meta_wayland_buffer_is_opaque_black:
+ * @buffer: a #MetaWaylandBuffer
+ *
+ * Returns: whether the buffer was last attached with a single opaque black
+ * pixel, either as a single pixel buffer or as a 1x1 shm buffer.
+ */
+gboolean
+meta_wayland_buffer_is_opaque_black (MetaWaylandBuffer *buffer)
+{
+  switch (buffer->type)
+    {
+    case META_WAYLAND_BUFFER_TYPE_SINGLE_PIXEL:
+      return meta_wayland_single_pixel_buffer_is_opaque_black (buffer->single_pixel.single_pixel_buffer);
+    case META_WAYLAND_BUFFER_TYPE_SHM:
+      return buffer->shm.is_opaque_black;
+    case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
+#ifdef HAVE_WAYLAND_EGLSTREAM
+    case META_WAYLAND_BUFFER_TYPE_EGL_STREAM:
+#endif
+    case META_WAYLAND_BUFFER_TYPE_DMA_BUF:
+    case META_WAYLAND_BUFFER_TYPE_UNKNOWN:
+      return FALSE;
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+apply_shm_upload (MetaWaylandShmUpload *upload)
+{
+  size_t offset = 0;
+  int i, n_rectangles;
+
+  wait_for_shm_upload_copy (upload);
+
+  cogl_buffer_unmap (upload->pixel_buffer);
+
+  n_rectangles = mtk_region_num_rectangles (upload->region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (upload->region, i);
+      g_autoptr (CoglBitmap) bitmap = NULL;
+      int row_size = rect.width * upload->bpp;
+
+      bitmap = cogl_bitmap_new_from_buffer (upload->pixel_buffer,
+                                            upload->format,
+                                            rect.width, rect.height,
+                                            row_size,
+                                            offset);
+      if (!cogl_texture_set_region_from_bitmap (upload->texture,
+                                                0, 0,
+                                                rect.x, rect.y,
+                                                rect.width, rect.height,
+                                                bitmap))
+        g_warning ("Failed to upload Wayland shm buffer damage");
+
+      offset += (size_t) row_size * rect.height;
+    }
+
+  wl_shm_pool_unref (upload->shm_pool);
+  meta_wayland_buffer_dec_use_count (upload->buffer);
+
+  g_object_unref (upload->buffer);
+  g_object_unref (upload->texture);
+  g_object_unref (upload->pixel_buffer);
+  mtk_region_unref (upload->region);
+  g_mutex_clear (&upload->mutex);
+  g_cond_clear (&upload->cond);
+  g_free (upload);
+}
+
+static void
+flush_shm_uploads (MetaWaylandCompositor *compositor,
+                   gboolean               wait)
+{
+  MetaWaylandShmUpload *upload;
+
+  /* Uploads are applied in the order they were committed, so a texture never
+   * ends up with older content on top of newer. */
+  while ((upload = g_queue_peek_head (&compositor->pending_shm_uploads)))
+    {
+      if (!wait && !is_shm_upload_copied (upload))
+        break;
+
+      g_queue_pop_head (&compositor->pending_shm_uploads);
+      apply_shm_upload (upload);
+    }
+}
+
+/**
+ * meta_wayland_flush_shm_uploads:
+ * @compositor: a #MetaWaylandCompositor
+ *
+ * Applies all shm buffer damage that is still being staged off the main
+ * thread to the corresponding textures, waiting for any unfinished copies.
+ * Must be called before painting.
+ */
+void
+meta_wayland_flush_shm_uploads (MetaWaylandCompositor *compositor)
+{
+  flush_shm_uploads (compositor, TRUE);
+}
+
+static void
+copy_shm_damage_in_thread (GTask        *task,
+                           gpointer      source_object,
+                           gpointer      task_data,
+                           GCancellable *cancellable)
+{
+  MetaWaylandShmUpload *upload = task_data;
+  const uint8_t *data;
+  uint8_t *staging_data = upload->staging_data;
+  int i, n_rectangles;
+
+  wl_shm_buffer_begin_access (upload->shm_buffer);
+  data = wl_shm_buffer_get_data (upload->shm_buffer);
+
+  n_rectangles = mtk_region_num_rectangles (upload->region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (upload->region, i);
+      size_t row_size = (size_t) rect.width * upload->bpp;
+      const uint8_t *rect_data;
+      int y;
+
+      rect_data = data + rect.x * upload->bpp + rect.y * upload->stride;
+
+      for (y = 0; y < rect.height; y++)
+        {
+          memcpy (staging_data, rect_data + y * upload->stride, row_size);
+          staging_data += row_size;
+        }
+    }
+
+  wl_shm_buffer_end_access (upload->shm_buffer);
+
+  g_mutex_lock (&upload->mutex);
+  upload->copied = TRUE;
+  g_cond_signal (&upload->cond);
+  g_mutex_unlock (&upload->mutex);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+static void
+on_shm_damage_copied (GObject      *source_object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  MetaWaylandCompositor *compositor = META_WAYLAND_COMPOSITOR (source_object);
+
+  /* Don't hold the wl_buffer back from the client until something paints;
+   * whatever has been copied can be uploaded and released right away. */
+  flush_shm_uploads (compositor, FALSE);
+}
+
+static gboolean
+queue_shm_buffer_damage_upload (MetaWaylandBuffer *buffer,
+                                MetaMultiTexture  *texture,
+                                MtkRegion         *region)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (buffer->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  struct wl_shm_buffer *shm_buffer;
+  const MetaFormatInfo *format_info;
+  const MetaMultiTextureFormatInfo *mt_format_info;
+  MetaWaylandShmUpload *upload;
+  g_autoptr (GTask) task = NULL;
+  CoglTexture *cogl_texture;
+  CoglPixelFormat format;
+  size_t size = 0;
+  int bpp;
+  int i, n_rectangles;
+  uint8_t *staging_data;
+
+  if (!cogl_has_feature (cogl_context, COGL_FEATURE_ID_MAP_BUFFER_FOR_WRITE))
+    return FALSE;
+
+  shm_buffer = wl_shm_buffer_get (buffer->resource);
+  format_info = buffer->shm.format_info;
+  mt_format_info =
+    meta_multi_texture_format_get_info (format_info->multi_texture_format);
+  if (mt_format_info->n_planes != 1)
+    return FALSE;
+
+  cogl_texture = meta_multi_texture_get_plane (texture, 0);
+  format = _cogl_texture_get_format (cogl_texture);
+  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+
+      size += (size_t) rect.width * rect.height * bpp;
+    }
+
+  if (size < META_WAYLAND_SHM_ASYNC_UPLOAD_MIN_BYTES)
+    return FALSE;
+
+  upload = g_new0 (MetaWaylandShmUpload, 1);
+  upload->pixel_buffer =
+    COGL_BUFFER (cogl_pixel_buffer_new (cogl_context, size, NULL));
+  staging_data = cogl_buffer_map (upload->pixel_buffer,
+                                  COGL_BUFFER_ACCESS_WRITE,
+                                  COGL_BUFFER_MAP_HINT_DISCARD);
+  if (!staging_data)
+    {
+      g_object_unref (upload->pixel_buffer);
+      g_free (upload);
+      return FALSE;
+    }
+
+  upload->buffer = g_object_ref (buffer);
+  upload->shm_buffer = shm_buffer;
+  upload->shm_pool = wl_shm_buffer_ref_pool (shm_buffer);
+  upload->stride = wl_shm_buffer_get_stride (shm_buffer);
+  upload->texture = g_object_ref (cogl_texture);
+  upload->format = format;
+  upload->bpp = bpp;
+  upload->region = mtk_region_ref (region);
+  upload->staging_data = staging_data;
+  g_mutex_init (&upload->mutex);
+  g_cond_init (&upload->cond);
+
+  /* The client may only reuse the buffer once it's released, which has to
+   * wait until the damaged rows have been copied out of it. */
+  meta_wayland_buffer_inc_use_count (buffer);
+
+  g_queue_push_tail (&buffer->compositor->pending_shm_uploads, upload);
+
+  task = g_task_new (buffer->compositor, NULL, on_shm_damage_copied, NULL);
+  g_task_set_task_data (task, upload, NULL);
+  g_task_run_in_thread (task, copy_shm_damage_in_thread);
+
+  return TRUE;
+}
+
 static gboolean
 process_shm_buffer_damage (MetaWaylandBuffer *buffer,
                            MetaMultiTexture  *texture,
@@ -740,17 +1108,20 @@ process_shm_buffer_damage (MetaWaylandBuffer *buffer,
   const uint8_t *data;
   int stride;
   int height;
-  uint32_t shm_format;
   int i, n_rectangles, n_planes;
 
+  if (queue_shm_buffer_damage_upload (buffer, texture, region))
+    return TRUE;
+
+  flush_shm_uploads (buffer->compositor, TRUE);
+
   n_rectangles = mtk_region_num_rectangles (region);
 
   shm_buffer = wl_shm_buffer_get (buffer->resource);
   stride = wl_shm_buffer_get_stride (shm_buffer);
   height = wl_shm_buffer_get_height (shm_buffer);
-  shm_format = wl_shm_buffer_get_format (shm_buffer);
 
-  format_info = get_supported_shm_format_info (shm_format);
+  format_info = buffer->shm.format_info;
   multi_format = format_info->multi_texture_format;
   mt_format_info = meta_multi_texture_format_get_info (multi_format);
   n_planes = mt_format_info->n_planes;
@@ -909,10 +1280,11 @@ scanout_destroyed (gpointer  data,
 }
 
 CoglScanout *
-meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                         CoglOnscreen          *onscreen,
-                                         const graphene_rect_t *src_rect,
-                                         const MtkRectangle    *dst_rect)
+meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer       *buffer,
+                                         CoglOnscreen            *onscreen,
+                                         MetaWaylandScanoutPlane  plane,
+                                         const graphene_rect_t   *src_rect,
+                                         const MtkRectangle      *dst_rect)
 {
   CoglScanout *scanout = NULL;
 
@@ -937,6 +1309,12 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                   "Buffer type not scanout compatible");
       return NULL;
     case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
+      if (plane != META_WAYLAND_SCANOUT_PLANE_PRIMARY)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "Buffer type does not support overlay planes");
+          return NULL;
+        }
       if (src_rect || dst_rect)
         {
           meta_topic (META_DEBUG_RENDER,
@@ -949,6 +1327,7 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
       {
         scanout = meta_wayland_dma_buf_try_acquire_scanout (buffer,
                                                             onscreen,
+                                                            plane,
                                                             src_rect,
                                                             dst_rect);
         break;
@@ -978,6 +1357,7 @@ meta_wayland_buffer_finalize (GObject *object)
 
   g_warn_if_fail (buffer->use_count == 0);
 
+  signal_release_points (buffer);
   clear_tainted_scanout_onscreens (buffer);
   g_clear_pointer (&buffer->tainted_scanout_onscreens, g_hash_table_unref);
 
@@ -25,10 +25,12 @@
 #include <wayland-server.h>
 
 #include "cogl/cogl.h"
+#include "common/meta-cogl-drm-formats.h"
 #include "meta/meta-multi-texture.h"
 #include "wayland/meta-wayland-types.h"
 #include "wayland/meta-wayland-egl-stream.h"
 #include "wayland/meta-wayland-dma-buf.h"
+#include "wayland/meta-wayland-drm-syncobj.h"
 #include "wayland/meta-wayland-single-pixel-buffer.h"
 
 typedef enum _MetaWaylandBufferType
@@ -53,10 +55,18 @@ struct _MetaWaylandBuffer
 
   unsigned int use_count;
 
+  /* MetaWaylandSyncPoint release points to signal once unused */
+  GList *release_points;
+
   gboolean is_y_inverted;
 
   MetaWaylandBufferType type;
 
+  struct {
+    const MetaFormatInfo *format_info;
+    gboolean is_opaque_black;
+  } shm;
+
   struct {
     MetaMultiTexture *texture;
   } egl_image;
@@ -96,13 +106,19 @@ gboolean                meta_wayland_buffer_attach              (MetaWaylandBuff
 CoglSnippet *           meta_wayland_buffer_create_snippet      (MetaWaylandBuffer     *buffer);
 void                    meta_wayland_buffer_inc_use_count       (MetaWaylandBuffer     *buffer);
 void                    meta_wayland_buffer_dec_use_count       (MetaWaylandBuffer     *buffer);
+void                    meta_wayland_buffer_add_release_point   (MetaWaylandBuffer     *buffer,
+                                                                 MetaWaylandSyncPoint  *release_point);
 gboolean                meta_wayland_buffer_is_y_inverted       (MetaWaylandBuffer     *buffer);
+gboolean                meta_wayland_buffer_is_opaque_black     (MetaWaylandBuffer     *buffer);
 void                    meta_wayland_buffer_process_damage      (MetaWaylandBuffer     *buffer,
                                                                  MetaMultiTexture      *texture,
                                                                  MtkRegion             *region);
-CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                                                 CoglOnscreen          *onscreen,
-                                                                 const graphene_rect_t *src_rect,
-                                                                 const MtkRectangle    *dst_rect);
+CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer       *buffer,
+                                                                 CoglOnscreen            *onscreen,
+                                                                 MetaWaylandScanoutPlane  plane,
+                                                                 const graphene_rect_t   *src_rect,
+                                                                 const MtkRectangle      *dst_rect);
 
 void meta_wayland_init_shm (MetaWaylandCompositor *compositor);
+
+void meta_wayland_flush_shm_uploads (MetaWaylandCompositor *compositor);
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Accounts for the resources each Wayland client pins in the compositor,
+ * i.e. the textures of its surfaces, the shm memory mapped for its buffers
+ * and its transactions waiting to be applied.
+ *
+ * The accounting is done on demand by walking the resources of each client,
+ * so there is no cost when nobody asks. If a texture limit is set, clients
+ * exceeding it get the mipmaps of their surfaces dropped, as those are the
+ * only cached data derived from client contents that can be recreated.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-client-usage.h"
+
+#include <string.h>
+#include <wayland-server.h>
+
+#include "compositor/meta-surface-actor.h"
+#include "core/util-private.h"
+#include "meta/meta-shaped-texture.h"
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface-private.h"
+#include "wayland/meta-wayland-transaction.h"
+
+#define CLIENT_USAGE_CHECK_INTERVAL_S 5
+
+typedef struct _ClientUsageData
+{
+  MetaWaylandClientUsage usage;
+  GPtrArray *surfaces;
+} ClientUsageData;
+
+static int
+get_bytes_per_pixel (CoglTexture *texture)
+{
+  switch (cogl_texture_get_components (texture))
+    {
+    case COGL_TEXTURE_COMPONENTS_A:
+      return 1;
+    case COGL_TEXTURE_COMPONENTS_RG:
+      return 2;
+    case COGL_TEXTURE_COMPONENTS_RGB:
+    case COGL_TEXTURE_COMPONENTS_RGBA:
+    case COGL_TEXTURE_COMPONENTS_DEPTH:
+      return 4;
+    }
+
+  g_assert_not_reached ();
+}
+
+static uint64_t
+get_texture_size (MetaMultiTexture *texture)
+{
+  uint64_t size = 0;
+  int i;
+
+  for (i = 0; i < meta_multi_texture_get_n_planes (texture); i++)
+    {
+      CoglTexture *plane = meta_multi_texture_get_plane (texture, i);
+
+      size += ((uint64_t) cogl_texture_get_width (plane) *
+               cogl_texture_get_height (plane) *
+               get_bytes_per_pixel (plane));
+    }
+
+  return size;
+}
+
+static enum wl_iterator_result
+account_resource (struct wl_resource *resource,
+                  void               *user_data)
+{
+  ClientUsageData *data = user_data;
+  const char *class = wl_resource_get_class (resource);
+
+  if (strcmp (class, wl_surface_interface.name) == 0)
+    {
+      MetaWaylandSurface *surface = wl_resource_get_user_data (resource);
+
+      if (!surface)
+        return WL_ITERATOR_CONTINUE;
+
+      data->usage.n_surfaces++;
+      if (surface->applied_state.texture)
+        {
+          data->usage.texture_bytes +=
+            get_texture_size (surface->applied_state.texture);
+        }
+      g_ptr_array_add (data->surfaces, surface);
+    }
+  else if (strcmp (class, wl_buffer_interface.name) == 0)
+    {
+      struct wl_shm_buffer *shm_buffer = wl_shm_buffer_get (resource);
+
+      data->usage.n_buffers++;
+      if (shm_buffer)
+        {
+          data->usage.shm_bytes +=
+            ((uint64_t) wl_shm_buffer_get_stride (shm_buffer) *
+             wl_shm_buffer_get_height (shm_buffer));
+        }
+    }
+
+  return WL_ITERATOR_CONTINUE;
+}
+
+static void
+client_usage_data_clear (ClientUsageData *data)
+{
+  g_clear_pointer (&data->surfaces, g_ptr_array_unref);
+}
+
+static void
+set_surfaces_create_mipmaps (GPtrArray *surfaces,
+                             gboolean   create_mipmaps)
+{
+  unsigned int i;
+
+  for (i = 0; i < surfaces->len; i++)
+    {
+      MetaWaylandSurface *surface = g_ptr_array_index (surfaces, i);
+      MetaSurfaceActor *actor = meta_wayland_surface_get_actor (surface);
+
+      if (!actor)
+        continue;
+
+      meta_shaped_texture_set_create_mipmaps (meta_surface_actor_get_texture (actor),
+                                              create_mipmaps);
+    }
+}
+
+/**
+ * meta_wayland_compositor_get_client_usage:
+ * @compositor: A #MetaWaylandCompositor
+ *
+ * Accounts for the resources of every connected client, and applies the
+ * texture limit if one is set.
+ *
+ * Returns: (transfer full) (element-type MetaWaylandClientUsage): The usage
+ *   of each client
+ */
+GArray *
+meta_wayland_compositor_get_client_usage (MetaWaylandCompositor *compositor)
+{
+  struct wl_list *clients;
+  struct wl_client *client;
+  g_autoptr (GArray) client_data = NULL;
+  g_autoptr (GHashTable) client_indices = NULL;
+  GArray *usages;
+  GList *l;
+  unsigned int i;
+
+  client_data = g_array_new (FALSE, TRUE, sizeof (ClientUsageData));
+  g_array_set_clear_func (client_data,
+                          (GDestroyNotify) client_usage_data_clear);
+  client_indices = g_hash_table_new (NULL, NULL);
+
+  clients = wl_display_get_client_list (compositor->wayland_display);
+  wl_client_for_each (client, clients)
+    {
+      ClientUsageData data = { 0 };
+
+      wl_client_get_credentials (client, &data.usage.pid, NULL, NULL);
+      data.surfaces = g_ptr_array_new ();
+      wl_client_for_each_resource (client, account_resource, &data);
+
+      g_hash_table_insert (client_indices, client,
+                           GUINT_TO_POINTER (client_data->len));
+      g_array_append_val (client_data, data);
+    }
+
+  for (l = compositor->committed_transactions.head; l; l = l->next)
+    {
+      MetaWaylandTransaction *transaction = l->data;
+      struct wl_client *transaction_client;
+      gpointer index;
+
+      transaction_client = meta_wayland_transaction_get_client (transaction);
+      if (!transaction_client ||
+          !g_hash_table_lookup_extended (client_indices, transaction_client,
+                                         NULL, &index))
+        continue;
+
+      g_array_index (client_data, ClientUsageData,
+                     GPOINTER_TO_UINT (index)).usage.n_pending_transactions++;
+    }
+
+  usages = g_array_sized_new (FALSE, FALSE, sizeof (MetaWaylandClientUsage),
+                              client_data->len);
+  for (i = 0; i < client_data->len; i++)
+    {
+      ClientUsageData *data = &g_array_index (client_data, ClientUsageData, i);
+      uint64_t limit = compositor->client_usage.texture_limit;
+
+      data->usage.mipmaps_dropped = limit > 0 &&
+                                    data->usage.texture_bytes > limit;
+      set_surfaces_create_mipmaps (data->surfaces,
+                                   !data->usage.mipmaps_dropped);
+
+      if (data->usage.mipmaps_dropped)
+        {
+          meta_topic (META_DEBUG_WAYLAND,
+                      "Client (pid %d) uses %" G_GUINT64_FORMAT " bytes of "
+                      "textures, exceeding the limit of %" G_GUINT64_FORMAT
+                      " bytes, dropping mipmaps",
+                      (int) data->usage.pid,
+                      data->usage.texture_bytes,
+                      limit);
+        }
+
+      g_array_append_val (usages, data->usage);
+    }
+
+  return usages;
+}
+
+static gboolean
+check_client_usage (gpointer user_data)
+{
+  MetaWaylandCompositor *compositor = user_data;
+
+  g_array_unref (meta_wayland_compositor_get_client_usage (compositor));
+
+  return G_SOURCE_CONTINUE;
+}
+
+/**
+ * meta_wayland_compositor_set_client_texture_limit:
+ * @compositor: A #MetaWaylandCompositor
+ * @limit: Maximum texture bytes per client before dropping its mipmaps, or 0
+ *
+ * Sets the limit of texture memory each client may pin before the mipmaps of
+ * its surfaces are dropped. While a limit is set, clients are checked
+ * periodically.
+ */
+void
+meta_wayland_compositor_set_client_texture_limit (MetaWaylandCompositor *compositor,
+                                                  uint64_t               limit)
+{
+  if (compositor->client_usage.texture_limit == limit)
+    return;
+
+  compositor->client_usage.texture_limit = limit;
+
+  /* Apply the new limit right away, restoring mipmaps if it was lifted */
+  check_client_usage (compositor);
+
+  if (limit > 0 && !compositor->client_usage.check_timeout_id)
+    {
+      compositor->client_usage.check_timeout_id =
+        g_timeout_add_seconds (CLIENT_USAGE_CHECK_INTERVAL_S,
+                               check_client_usage,
+                               compositor);
+    }
+  else if (limit == 0)
+    {
+      g_clear_handle_id (&compositor->client_usage.check_timeout_id,
+                         g_source_remove);
+    }
+}
+
+void
+meta_wayland_client_usage_finalize (MetaWaylandCompositor *compositor)
+{
+  g_clear_handle_id (&compositor->client_usage.check_timeout_id,
+                     g_source_remove);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <sys/types.h>
+
+#include "wayland/meta-wayland-types.h"
+
+typedef struct _MetaWaylandClientUsage
+{
+  pid_t pid;
+
+  unsigned int n_surfaces;
+  unsigned int n_buffers;
+  unsigned int n_pending_transactions;
+
+  /* Bytes of client shm pools mapped for attached buffers */
+  uint64_t shm_bytes;
+
+  /* Estimated bytes of textures of the applied surface contents */
+  uint64_t texture_bytes;
+
+  /* Whether mipmaps of the client's surfaces are disabled due to the limit */
+  gboolean mipmaps_dropped;
+} MetaWaylandClientUsage;
+
+GArray * meta_wayland_compositor_get_client_usage (MetaWaylandCompositor *compositor);
+
+void meta_wayland_compositor_set_client_texture_limit (MetaWaylandCompositor *compositor,
+                                                       uint64_t               limit);
+
+void meta_wayland_client_usage_finalize (MetaWaylandCompositor *compositor);
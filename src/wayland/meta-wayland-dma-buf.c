@@ -97,6 +97,7 @@ typedef struct _MetaWaylandDmaBufTranche
   GArray *formats;
   MetaWaylandDmaBufTrancheFlags flags;
   uint64_t scanout_crtc_id;
+  uint32_t scanout_plane_id;
 } MetaWaylandDmaBufTranche;
 
 typedef struct _MetaWaylandDmaBufFeedback
@@ -605,10 +606,11 @@ import_scanout_gbm_bo (MetaWaylandDmaBufBuffer  *dma_buf,
 #endif
 
 CoglScanout *
-meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                          CoglOnscreen          *onscreen,
-                                          const graphene_rect_t *src_rect,
-                                          const MtkRectangle    *dst_rect)
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer       *buffer,
+                                          CoglOnscreen            *onscreen,
+                                          MetaWaylandScanoutPlane  plane,
+                                          const graphene_rect_t   *src_rect,
+                                          const MtkRectangle      *dst_rect)
 {
 #ifdef HAVE_NATIVE_BACKEND
   MetaWaylandDmaBufBuffer *dma_buf;
@@ -624,6 +626,7 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
   g_autoptr (GError) error = NULL;
   MetaDrmBufferFlags flags;
   gboolean use_modifier;
+  gboolean is_compatible = FALSE;
   int n_planes;
 
   dma_buf = meta_wayland_dma_buf_from_buffer (buffer);
@@ -669,7 +672,19 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
   cogl_scanout_set_src_rect (scanout, src_rect);
   cogl_scanout_set_dst_rect (scanout, dst_rect);
 
-  if (!meta_onscreen_native_is_buffer_scanout_compatible (onscreen, scanout))
+  switch (plane)
+    {
+    case META_WAYLAND_SCANOUT_PLANE_PRIMARY:
+      is_compatible =
+        meta_onscreen_native_is_buffer_scanout_compatible (onscreen, scanout);
+      break;
+    case META_WAYLAND_SCANOUT_PLANE_OVERLAY:
+      is_compatible =
+        meta_onscreen_native_is_buffer_overlay_compatible (onscreen, scanout);
+      break;
+    }
+
+  if (!is_compatible)
     {
       meta_topic (META_DEBUG_RENDER,
                   "Buffer not scanout compatible (see also KMS debug topic)");
@@ -1278,25 +1293,38 @@ has_modifier (GArray   *modifiers,
 }
 
 static gboolean
-crtc_supports_modifier (MetaCrtcKms *crtc_kms,
-                        uint32_t     drm_format,
-                        uint64_t     drm_modifier)
+plane_supports_modifier (MetaKmsPlane *plane,
+                         uint32_t      drm_format,
+                         uint64_t      drm_modifier)
 {
-  MetaKmsPlane *plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
-  GArray *crtc_modifiers;
-
-  g_return_val_if_fail (plane, FALSE);
+  GArray *plane_modifiers;
 
-  crtc_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
-  if (!crtc_modifiers)
+  plane_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
+  if (!plane_modifiers)
     return FALSE;
 
-  return has_modifier (crtc_modifiers, drm_modifier);
+  return has_modifier (plane_modifiers, drm_modifier);
+}
+
+static MetaKmsPlane *
+get_scanout_kms_plane (MetaCrtcKms             *crtc_kms,
+                       MetaWaylandScanoutPlane  plane)
+{
+  switch (plane)
+    {
+    case META_WAYLAND_SCANOUT_PLANE_PRIMARY:
+      return meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+    case META_WAYLAND_SCANOUT_PLANE_OVERLAY:
+      return meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+    }
+
+  g_assert_not_reached ();
 }
 
 static void
 ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
-                        MetaCrtc                         *crtc)
+                        MetaCrtc                         *crtc,
+                        MetaWaylandScanoutPlane           plane)
 {
   MetaWaylandDmaBufManager *dma_buf_manager = surface_feedback->dma_buf_manager;
   MetaContext *context =
@@ -1315,7 +1343,7 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
   g_return_if_fail (META_IS_CRTC_KMS (crtc));
 
   crtc_kms = META_CRTC_KMS (crtc);
-  kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+  kms_plane = get_scanout_kms_plane (crtc_kms, plane);
 
   g_return_if_fail (META_IS_KMS_PLANE (kms_plane));
 
@@ -1324,7 +1352,8 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
     {
       tranche = el->data;
 
-      if (tranche->scanout_crtc_id == meta_crtc_get_id (crtc))
+      if (tranche->scanout_crtc_id == meta_crtc_get_id (crtc) &&
+          tranche->scanout_plane_id == meta_kms_plane_get_id (kms_plane))
         return;
 
       meta_wayland_dma_buf_tranche_free (tranche);
@@ -1341,9 +1370,9 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
                            MetaWaylandDmaBufFormat,
                            i);
 
-          if (!crtc_supports_modifier (crtc_kms,
-                                       format.drm_format,
-                                       format.drm_modifier))
+          if (!plane_supports_modifier (kms_plane,
+                                        format.drm_format,
+                                        format.drm_modifier))
             continue;
 
           g_array_append_val (formats, format);
@@ -1381,6 +1410,7 @@ ensure_scanout_tranche (MetaWaylandDmaBufSurfaceFeedback *surface_feedback,
                                               priority,
                                               flags);
   tranche->scanout_crtc_id = meta_crtc_get_id (crtc);
+  tranche->scanout_plane_id = meta_kms_plane_get_id (kms_plane);
   meta_wayland_dma_buf_feedback_add_tranche (feedback, tranche);
 }
 
@@ -1409,7 +1439,12 @@ update_surface_feedback_tranches (MetaWaylandDmaBufSurfaceFeedback *surface_feed
 
   crtc = meta_wayland_surface_get_scanout_candidate (surface_feedback->surface);
   if (crtc)
-    ensure_scanout_tranche (surface_feedback, crtc);
+    {
+      MetaWaylandScanoutPlane plane =
+        meta_wayland_surface_get_scanout_candidate_plane (surface_feedback->surface);
+
+      ensure_scanout_tranche (surface_feedback, crtc, plane);
+    }
   else
     clear_scanout_tranche (surface_feedback);
 #endif /* HAVE_NATIVE_BACKEND */
@@ -0,0 +1,751 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * MetaWaylandDrmSyncobj
+ *
+ * Implements explicit synchronization using DRM timeline syncobjs
+ *
+ * With the linux-drm-syncobj protocol, clients pass an acquire point that
+ * signals once their rendering into the attached buffer has completed, and
+ * a release point that the compositor signals once it is done reading from
+ * the buffer. The acquire point replaces the implicit fences of the dma-buf
+ * planes as a transaction dependency. The release point is signaled when
+ * the buffer use count drops to zero, which includes direct scanout, using
+ * the fence of the latest rendering that may have sampled from it.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-drm-syncobj.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <xf86drm.h>
+
+#include "backends/meta-backend-private.h"
+#include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface-private.h"
+#include "wayland/meta-wayland-versions.h"
+
+#ifdef HAVE_NATIVE_BACKEND
+#include "backends/native/meta-device-pool.h"
+#include "backends/native/meta-renderer-native.h"
+#endif
+
+#include "linux-drm-syncobj-v1-server-protocol.h"
+
+struct _MetaWaylandDrmSyncobjManager
+{
+  GObject parent;
+
+  MetaWaylandCompositor *compositor;
+  CoglContext *cogl_context;
+  int drm_fd;
+
+#ifdef HAVE_NATIVE_BACKEND
+  MetaDeviceFile *device_file;
+#endif
+};
+
+struct _MetaWaylandSyncobjTimeline
+{
+  GObject parent;
+
+  MetaWaylandDrmSyncobjManager *manager;
+  uint32_t drm_syncobj;
+};
+
+typedef struct _MetaWaylandDrmSyncobjSource
+{
+  GSource base;
+
+  MetaWaylandDmaBufSourceDispatch dispatch;
+  MetaWaylandBuffer *buffer;
+  gpointer user_data;
+
+  int event_fd;
+} MetaWaylandDrmSyncobjSource;
+
+G_DEFINE_FINAL_TYPE (MetaWaylandDrmSyncobjManager,
+                     meta_wayland_drm_syncobj_manager,
+                     G_TYPE_OBJECT)
+
+G_DEFINE_FINAL_TYPE (MetaWaylandSyncobjTimeline,
+                     meta_wayland_syncobj_timeline,
+                     G_TYPE_OBJECT)
+
+static MetaWaylandSyncobjTimeline *
+meta_wayland_syncobj_timeline_new (MetaWaylandDrmSyncobjManager *manager,
+                                   uint32_t                      drm_syncobj)
+{
+  MetaWaylandSyncobjTimeline *timeline;
+
+  timeline = g_object_new (META_TYPE_WAYLAND_SYNCOBJ_TIMELINE, NULL);
+  timeline->manager = g_object_ref (manager);
+  timeline->drm_syncobj = drm_syncobj;
+
+  return timeline;
+}
+
+static void
+meta_wayland_syncobj_timeline_finalize (GObject *object)
+{
+  MetaWaylandSyncobjTimeline *timeline = META_WAYLAND_SYNCOBJ_TIMELINE (object);
+
+  drmSyncobjDestroy (timeline->manager->drm_fd, timeline->drm_syncobj);
+  g_clear_object (&timeline->manager);
+
+  G_OBJECT_CLASS (meta_wayland_syncobj_timeline_parent_class)->finalize (object);
+}
+
+static void
+meta_wayland_syncobj_timeline_class_init (MetaWaylandSyncobjTimelineClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = meta_wayland_syncobj_timeline_finalize;
+}
+
+static void
+meta_wayland_syncobj_timeline_init (MetaWaylandSyncobjTimeline *timeline)
+{
+}
+
+static gboolean
+is_sync_point_signaled (MetaWaylandSyncPoint *sync_point)
+{
+  MetaWaylandSyncobjTimeline *timeline = sync_point->timeline;
+  uint64_t signaled_point;
+
+  if (drmSyncobjQuery (timeline->manager->drm_fd,
+                       &timeline->drm_syncobj, &signaled_point, 1) != 0)
+    return FALSE;
+
+  return signaled_point >= sync_point->sync_point;
+}
+
+MetaWaylandSyncPoint *
+meta_wayland_sync_point_new (MetaWaylandSyncobjTimeline *timeline,
+                             uint64_t                    sync_point)
+{
+  MetaWaylandSyncPoint *point;
+
+  point = g_new0 (MetaWaylandSyncPoint, 1);
+  point->timeline = g_object_ref (timeline);
+  point->sync_point = sync_point;
+
+  return point;
+}
+
+void
+meta_wayland_sync_point_free (MetaWaylandSyncPoint *sync_point)
+{
+  g_clear_object (&sync_point->timeline);
+  g_free (sync_point);
+}
+
+static gboolean
+import_sync_file (MetaWaylandSyncPoint *sync_point,
+                  int                   sync_fd)
+{
+  MetaWaylandSyncobjTimeline *timeline = sync_point->timeline;
+  int drm_fd = timeline->manager->drm_fd;
+  uint32_t tmp_syncobj;
+  int ret;
+
+  if (drmSyncobjCreate (drm_fd, 0, &tmp_syncobj) != 0)
+    return FALSE;
+
+  ret = drmSyncobjImportSyncFile (drm_fd, tmp_syncobj, sync_fd);
+  if (ret == 0)
+    {
+      ret = drmSyncobjTransfer (drm_fd,
+                                timeline->drm_syncobj, sync_point->sync_point,
+                                tmp_syncobj, 0,
+                                0);
+    }
+
+  drmSyncobjDestroy (drm_fd, tmp_syncobj);
+
+  return ret == 0;
+}
+
+/**
+ * meta_wayland_sync_point_signal:
+ * @sync_point: A release point
+ *
+ * Signals the release point once the rendering submitted so far has
+ * completed, or right away if the driver can't provide a fence for it.
+ */
+void
+meta_wayland_sync_point_signal (MetaWaylandSyncPoint *sync_point)
+{
+  MetaWaylandSyncobjTimeline *timeline = sync_point->timeline;
+  MetaWaylandDrmSyncobjManager *manager = timeline->manager;
+  int sync_fd = -1;
+  gboolean imported = FALSE;
+
+  if (cogl_has_feature (manager->cogl_context, COGL_FEATURE_ID_SYNC_FD))
+    sync_fd = cogl_context_get_latest_sync_fd (manager->cogl_context);
+
+  if (sync_fd >= 0)
+    {
+      imported = import_sync_file (sync_point, sync_fd);
+      close (sync_fd);
+    }
+
+  if (imported)
+    return;
+
+  if (drmSyncobjTimelineSignal (manager->drm_fd,
+                                &timeline->drm_syncobj,
+                                &sync_point->sync_point,
+                                1) != 0)
+    {
+      g_warning ("Failed to signal DRM syncobj release point: %s",
+                 g_strerror (errno));
+    }
+}
+
+/**
+ * meta_wayland_surface_explicit_sync_validate:
+ * @surface: A surface with a wp_linux_drm_syncobj_surface_v1 object
+ * @state: The state about to be committed
+ *
+ * Checks the pending timeline points against the attached buffer, posting
+ * a protocol error if they don't match up.
+ *
+ * Returns: %TRUE if the state may be committed
+ */
+gboolean
+meta_wayland_surface_explicit_sync_validate (MetaWaylandSurface      *surface,
+                                             MetaWaylandSurfaceState *state)
+{
+  struct wl_resource *resource = surface->drm_syncobj.resource;
+  MetaWaylandSyncPoint *acquire = state->drm_syncobj.acquire;
+  MetaWaylandSyncPoint *release = state->drm_syncobj.release;
+  MetaWaylandBuffer *buffer = state->buffer;
+
+  if (!buffer)
+    {
+      if (acquire || release)
+        {
+          wl_resource_post_error (resource,
+                                  WP_LINUX_DRM_SYNCOBJ_SURFACE_V1_ERROR_NO_BUFFER,
+                                  "Timeline points set without a buffer");
+          return FALSE;
+        }
+
+      return TRUE;
+    }
+
+  if (!meta_wayland_buffer_is_realized (buffer))
+    meta_wayland_buffer_realize (buffer);
+
+  if (buffer->type != META_WAYLAND_BUFFER_TYPE_DMA_BUF)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_SURFACE_V1_ERROR_UNSUPPORTED_BUFFER,
+                              "Explicit synchronization requires a dma-buf buffer");
+      return FALSE;
+    }
+
+  if (!acquire)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_SURFACE_V1_ERROR_NO_ACQUIRE_POINT,
+                              "Buffer attached without an acquire point");
+      return FALSE;
+    }
+
+  if (!release)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_SURFACE_V1_ERROR_NO_RELEASE_POINT,
+                              "Buffer attached without a release point");
+      return FALSE;
+    }
+
+  if (acquire->timeline == release->timeline &&
+      acquire->sync_point >= release->sync_point)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_SURFACE_V1_ERROR_CONFLICTING_POINTS,
+                              "Release point must come after the acquire point "
+                              "on the same timeline");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+meta_wayland_drm_syncobj_source_dispatch (GSource     *base,
+                                          GSourceFunc  callback,
+                                          gpointer     user_data)
+{
+  MetaWaylandDrmSyncobjSource *source = (MetaWaylandDrmSyncobjSource *) base;
+
+  source->dispatch (source->buffer, source->user_data);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+meta_wayland_drm_syncobj_source_finalize (GSource *base)
+{
+  MetaWaylandDrmSyncobjSource *source = (MetaWaylandDrmSyncobjSource *) base;
+
+  g_clear_fd (&source->event_fd, NULL);
+  g_clear_object (&source->buffer);
+}
+
+static GSourceFuncs meta_wayland_drm_syncobj_source_funcs = {
+  .dispatch = meta_wayland_drm_syncobj_source_dispatch,
+  .finalize = meta_wayland_drm_syncobj_source_finalize
+};
+
+/**
+ * meta_wayland_drm_syncobj_create_source:
+ * @buffer: A #MetaWaylandBuffer object
+ * @acquire: The acquire point of the buffer
+ * @dispatch: Callback
+ * @user_data: User data for the callback
+ *
+ * Creates a GSource which will call the specified dispatch callback when
+ * the acquire point has been signaled.
+ *
+ * Returns: The new GSource (or %NULL if the acquire point was signaled
+ * already)
+ */
+GSource *
+meta_wayland_drm_syncobj_create_source (MetaWaylandBuffer               *buffer,
+                                        MetaWaylandSyncPoint            *acquire,
+                                        MetaWaylandDmaBufSourceDispatch  dispatch,
+                                        gpointer                         user_data)
+{
+  MetaWaylandSyncobjTimeline *timeline = acquire->timeline;
+  MetaWaylandDrmSyncobjSource *source;
+  int event_fd;
+
+  if (is_sync_point_signaled (acquire))
+    return NULL;
+
+  event_fd = eventfd (0, EFD_CLOEXEC);
+  if (event_fd < 0)
+    {
+      g_warning ("Failed to create eventfd for acquire point: %s",
+                 g_strerror (errno));
+      return NULL;
+    }
+
+  if (drmSyncobjEventfd (timeline->manager->drm_fd,
+                         timeline->drm_syncobj,
+                         acquire->sync_point,
+                         event_fd,
+                         0) != 0)
+    {
+      g_warning ("Failed to wait for acquire point: %s", g_strerror (errno));
+      close (event_fd);
+      return NULL;
+    }
+
+  source =
+    (MetaWaylandDrmSyncobjSource *) g_source_new (&meta_wayland_drm_syncobj_source_funcs,
+                                                  sizeof (*source));
+  g_source_set_name ((GSource *) source, "[mutter] DRM syncobj acquire source");
+
+  source->buffer = g_object_ref (buffer);
+  source->dispatch = dispatch;
+  source->user_data = user_data;
+  source->event_fd = event_fd;
+
+  g_source_add_unix_fd (&source->base, event_fd, G_IO_IN);
+
+  return &source->base;
+}
+
+static void
+timeline_destroy (struct wl_client   *client,
+                  struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+timeline_destructor (struct wl_resource *resource)
+{
+  MetaWaylandSyncobjTimeline *timeline = wl_resource_get_user_data (resource);
+
+  g_object_unref (timeline);
+}
+
+static const struct wp_linux_drm_syncobj_timeline_v1_interface timeline_interface = {
+  timeline_destroy,
+};
+
+static void
+syncobj_surface_destroy (struct wl_client   *client,
+                         struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+syncobj_surface_destructor (struct wl_resource *resource)
+{
+  MetaWaylandSurface *surface;
+  MetaWaylandSurfaceState *pending;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    return;
+
+  pending = meta_wayland_surface_get_pending_state (surface);
+  g_clear_pointer (&pending->drm_syncobj.acquire,
+                   meta_wayland_sync_point_free);
+  g_clear_pointer (&pending->drm_syncobj.release,
+                   meta_wayland_sync_point_free);
+
+  g_clear_signal_handler (&surface->drm_syncobj.destroy_handler_id, surface);
+  surface->drm_syncobj.resource = NULL;
+}
+
+static void
+on_surface_destroyed (MetaWaylandSurface *surface)
+{
+  wl_resource_set_user_data (surface->drm_syncobj.resource, NULL);
+}
+
+static void
+set_sync_point (struct wl_resource     *timeline_resource,
+                uint32_t                point_hi,
+                uint32_t                point_lo,
+                MetaWaylandSyncPoint  **sync_point)
+{
+  MetaWaylandSyncobjTimeline *timeline =
+    wl_resource_get_user_data (timeline_resource);
+
+  g_clear_pointer (sync_point, meta_wayland_sync_point_free);
+  *sync_point = meta_wayland_sync_point_new (timeline,
+                                             (uint64_t) point_hi << 32 |
+                                             point_lo);
+}
+
+static void
+syncobj_surface_set_acquire_point (struct wl_client   *client,
+                                   struct wl_resource *resource,
+                                   struct wl_resource *timeline_resource,
+                                   uint32_t            point_hi,
+                                   uint32_t            point_lo)
+{
+  MetaWaylandSurface *surface;
+  MetaWaylandSurfaceState *pending;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_SURFACE_V1_ERROR_NO_SURFACE,
+                              "surface destroyed");
+      return;
+    }
+
+  pending = meta_wayland_surface_get_pending_state (surface);
+  set_sync_point (timeline_resource, point_hi, point_lo,
+                  &pending->drm_syncobj.acquire);
+}
+
+static void
+syncobj_surface_set_release_point (struct wl_client   *client,
+                                   struct wl_resource *resource,
+                                   struct wl_resource *timeline_resource,
+                                   uint32_t            point_hi,
+                                   uint32_t            point_lo)
+{
+  MetaWaylandSurface *surface;
+  MetaWaylandSurfaceState *pending;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_SURFACE_V1_ERROR_NO_SURFACE,
+                              "surface destroyed");
+      return;
+    }
+
+  pending = meta_wayland_surface_get_pending_state (surface);
+  set_sync_point (timeline_resource, point_hi, point_lo,
+                  &pending->drm_syncobj.release);
+}
+
+static const struct wp_linux_drm_syncobj_surface_v1_interface syncobj_surface_interface = {
+  syncobj_surface_destroy,
+  syncobj_surface_set_acquire_point,
+  syncobj_surface_set_release_point,
+};
+
+static void
+syncobj_manager_destroy (struct wl_client   *client,
+                         struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+syncobj_manager_get_surface (struct wl_client   *client,
+                             struct wl_resource *resource,
+                             uint32_t            id,
+                             struct wl_resource *surface_resource)
+{
+  MetaWaylandSurface *surface = wl_resource_get_user_data (surface_resource);
+  struct wl_resource *syncobj_surface_resource;
+
+  if (surface->drm_syncobj.resource)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_MANAGER_V1_ERROR_SURFACE_EXISTS,
+                              "syncobj surface already exists on surface");
+      return;
+    }
+
+  syncobj_surface_resource =
+    wl_resource_create (client,
+                        &wp_linux_drm_syncobj_surface_v1_interface,
+                        wl_resource_get_version (resource),
+                        id);
+  wl_resource_set_implementation (syncobj_surface_resource,
+                                  &syncobj_surface_interface,
+                                  surface,
+                                  syncobj_surface_destructor);
+
+  surface->drm_syncobj.resource = syncobj_surface_resource;
+  surface->drm_syncobj.destroy_handler_id =
+    g_signal_connect (surface,
+                      "destroy",
+                      G_CALLBACK (on_surface_destroyed),
+                      NULL);
+}
+
+static void
+syncobj_manager_import_timeline (struct wl_client   *client,
+                                 struct wl_resource *resource,
+                                 uint32_t            id,
+                                 int32_t             fd)
+{
+  MetaWaylandDrmSyncobjManager *manager = wl_resource_get_user_data (resource);
+  MetaWaylandSyncobjTimeline *timeline;
+  struct wl_resource *timeline_resource;
+  uint32_t drm_syncobj;
+  int ret;
+
+  ret = drmSyncobjFDToHandle (manager->drm_fd, fd, &drm_syncobj);
+  close (fd);
+
+  if (ret != 0)
+    {
+      wl_resource_post_error (resource,
+                              WP_LINUX_DRM_SYNCOBJ_MANAGER_V1_ERROR_INVALID_TIMELINE,
+                              "Failed to import timeline: %s",
+                              g_strerror (errno));
+      return;
+    }
+
+  timeline = meta_wayland_syncobj_timeline_new (manager, drm_syncobj);
+
+  timeline_resource =
+    wl_resource_create (client,
+                        &wp_linux_drm_syncobj_timeline_v1_interface,
+                        wl_resource_get_version (resource),
+                        id);
+  wl_resource_set_implementation (timeline_resource,
+                                  &timeline_interface,
+                                  timeline,
+                                  timeline_destructor);
+}
+
+static const struct wp_linux_drm_syncobj_manager_v1_interface syncobj_manager_interface = {
+  syncobj_manager_destroy,
+  syncobj_manager_get_surface,
+  syncobj_manager_import_timeline,
+};
+
+static void
+syncobj_manager_bind (struct wl_client *client,
+                      void             *data,
+                      uint32_t          version,
+                      uint32_t          id)
+{
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &wp_linux_drm_syncobj_manager_v1_interface,
+                                 version,
+                                 id);
+  wl_resource_set_implementation (resource,
+                                  &syncobj_manager_interface,
+                                  data,
+                                  NULL);
+}
+
+#ifdef HAVE_NATIVE_BACKEND
+static gboolean
+supports_syncobj_eventfd (int drm_fd)
+{
+  uint32_t drm_syncobj;
+  int event_fd;
+  int ret;
+
+  if (drmSyncobjCreate (drm_fd, 0, &drm_syncobj) != 0)
+    return FALSE;
+
+  event_fd = eventfd (0, EFD_CLOEXEC);
+  if (event_fd < 0)
+    {
+      drmSyncobjDestroy (drm_fd, drm_syncobj);
+      return FALSE;
+    }
+
+  ret = drmSyncobjEventfd (drm_fd, drm_syncobj, 0, event_fd,
+                           DRM_SYNCOBJ_WAIT_FLAGS_WAIT_AVAILABLE);
+
+  close (event_fd);
+  drmSyncobjDestroy (drm_fd, drm_syncobj);
+
+  return ret == 0;
+}
+#endif
+
+/**
+ * meta_wayland_drm_syncobj_manager_new:
+ * @compositor: The #MetaWaylandCompositor
+ *
+ * Creates the global Wayland object that exposes the linux-drm-syncobj
+ * protocol, if the primary GPU supports timeline syncobjs.
+ *
+ * Returns: (transfer full): The MetaWaylandDrmSyncobjManager instance.
+ */
+MetaWaylandDrmSyncobjManager *
+meta_wayland_drm_syncobj_manager_new (MetaWaylandCompositor  *compositor,
+                                      GError                **error)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  MetaContext *context = meta_wayland_compositor_get_context (compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  g_autoptr (MetaWaylandDrmSyncobjManager) manager = NULL;
+  MetaDeviceFile *device_file;
+  uint64_t timeline_supported = 0;
+  int drm_fd;
+
+  if (!compositor->dma_buf_manager)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Explicit synchronization requires dma-buf support");
+      return NULL;
+    }
+
+  if (!META_IS_RENDERER_NATIVE (renderer))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Explicit synchronization requires the native backend");
+      return NULL;
+    }
+
+  device_file =
+    meta_renderer_native_get_primary_device_file (META_RENDERER_NATIVE (renderer));
+  if (!device_file)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "No primary GPU device file");
+      return NULL;
+    }
+
+  drm_fd = meta_device_file_get_fd (device_file);
+  if (drmGetCap (drm_fd, DRM_CAP_SYNCOBJ_TIMELINE, &timeline_supported) != 0 ||
+      !timeline_supported)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Primary GPU doesn't support timeline syncobjs");
+      return NULL;
+    }
+
+  if (!supports_syncobj_eventfd (drm_fd))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Kernel doesn't support waiting for syncobjs with eventfd");
+      return NULL;
+    }
+
+  manager = g_object_new (META_TYPE_WAYLAND_DRM_SYNCOBJ_MANAGER, NULL);
+  manager->compositor = compositor;
+  manager->cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  manager->device_file = meta_device_file_acquire (device_file);
+  manager->drm_fd = drm_fd;
+
+  if (!wl_global_create (compositor->wayland_display,
+                         &wp_linux_drm_syncobj_manager_v1_interface,
+                         META_WP_LINUX_DRM_SYNCOBJ_VERSION,
+                         manager,
+                         syncobj_manager_bind))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Failed to create wp_linux_drm_syncobj_manager_v1 global");
+      return NULL;
+    }
+
+  return g_steal_pointer (&manager);
+#else
+  g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+               "Explicit synchronization requires the native backend");
+  return NULL;
+#endif
+}
+
+static void
+meta_wayland_drm_syncobj_manager_finalize (GObject *object)
+{
+#ifdef HAVE_NATIVE_BACKEND
+  MetaWaylandDrmSyncobjManager *manager =
+    META_WAYLAND_DRM_SYNCOBJ_MANAGER (object);
+
+  g_clear_pointer (&manager->device_file, meta_device_file_release);
+#endif
+
+  G_OBJECT_CLASS (meta_wayland_drm_syncobj_manager_parent_class)->finalize (object);
+}
+
+static void
+meta_wayland_drm_syncobj_manager_class_init (MetaWaylandDrmSyncobjManagerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = meta_wayland_drm_syncobj_manager_finalize;
+}
+
+static void
+meta_wayland_drm_syncobj_manager_init (MetaWaylandDrmSyncobjManager *manager)
+{
+  manager->drm_fd = -1;
+}
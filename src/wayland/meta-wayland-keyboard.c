@@ -56,6 +56,12 @@
 #include "core/meta-anonymous-file.h"
 #include "wayland/meta-wayland-private.h"
 
+/* Unfocused clients don't need a new keymap until they gain focus, so delay
+ * sending it to them a bit, and then only to a few of them per main loop
+ * iteration, instead of having every client parse it at the same time. */
+#define KEYMAP_DELIVERY_GRACE_PERIOD_MS 500
+#define KEYMAP_DELIVERY_BATCH_SIZE 16
+
 G_DEFINE_TYPE (MetaWaylandKeyboard, meta_wayland_keyboard,
                META_TYPE_WAYLAND_INPUT_DEVICE)
 
@@ -76,6 +82,9 @@ backend_from_keyboard (MetaWaylandKeyboard *keyboard)
 static void
 unbind_resource (struct wl_resource *resource)
 {
+  MetaWaylandKeyboard *keyboard = wl_resource_get_user_data (resource);
+
+  g_hash_table_remove (keyboard->pending_keymap_resources, resource);
   wl_list_remove (wl_resource_get_link (resource));
 }
 
@@ -109,15 +118,82 @@ send_keymap (MetaWaylandKeyboard *keyboard,
   meta_anonymous_file_close_fd (fd);
 }
 
+static void
+ensure_keymap_sent (MetaWaylandKeyboard *keyboard,
+                    struct wl_resource  *resource)
+{
+  if (g_hash_table_remove (keyboard->pending_keymap_resources, resource))
+    send_keymap (keyboard, resource);
+}
+
+static void
+clear_pending_keymaps (MetaWaylandKeyboard *keyboard)
+{
+  g_clear_handle_id (&keyboard->keymap_grace_timeout_id, g_source_remove);
+  g_clear_handle_id (&keyboard->keymap_delivery_idle_id, g_source_remove);
+  g_hash_table_remove_all (keyboard->pending_keymap_resources);
+}
+
+static gboolean
+deliver_pending_keymaps (gpointer user_data)
+{
+  MetaWaylandKeyboard *keyboard = user_data;
+  GHashTableIter iter;
+  struct wl_resource *resource;
+  int n_sent = 0;
+
+  g_hash_table_iter_init (&iter, keyboard->pending_keymap_resources);
+  while (n_sent < KEYMAP_DELIVERY_BATCH_SIZE &&
+         g_hash_table_iter_next (&iter, (gpointer *) &resource, NULL))
+    {
+      g_hash_table_iter_remove (&iter);
+      send_keymap (keyboard, resource);
+      n_sent++;
+    }
+
+  if (g_hash_table_size (keyboard->pending_keymap_resources) > 0)
+    return G_SOURCE_CONTINUE;
+
+  keyboard->keymap_delivery_idle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+keymap_grace_period_elapsed (gpointer user_data)
+{
+  MetaWaylandKeyboard *keyboard = user_data;
+
+  keyboard->keymap_grace_timeout_id = 0;
+
+  if (!keyboard->keymap_delivery_idle_id)
+    {
+      keyboard->keymap_delivery_idle_id =
+        g_idle_add (deliver_pending_keymaps, keyboard);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 inform_clients_of_new_keymap (MetaWaylandKeyboard *keyboard)
 {
   struct wl_resource *keyboard_resource;
 
-  wl_resource_for_each (keyboard_resource, &keyboard->resource_list)
-    send_keymap (keyboard, keyboard_resource);
+  clear_pending_keymaps (keyboard);
+
   wl_resource_for_each (keyboard_resource, &keyboard->focus_resource_list)
     send_keymap (keyboard, keyboard_resource);
+
+  if (wl_list_empty (&keyboard->resource_list))
+    return;
+
+  wl_resource_for_each (keyboard_resource, &keyboard->resource_list)
+    g_hash_table_add (keyboard->pending_keymap_resources, keyboard_resource);
+
+  keyboard->keymap_grace_timeout_id =
+    g_timeout_add (KEYMAP_DELIVERY_GRACE_PERIOD_MS,
+                   keymap_grace_period_elapsed,
+                   keyboard);
 }
 
 static void
@@ -574,6 +650,8 @@ meta_wayland_keyboard_disable (MetaWaylandKeyboard *keyboard)
   meta_wayland_keyboard_end_grab (keyboard);
   meta_wayland_keyboard_set_focus (keyboard, NULL);
 
+  clear_pending_keymaps (keyboard);
+
   wl_list_remove (&keyboard->resource_list);
   wl_list_init (&keyboard->resource_list);
   wl_list_remove (&keyboard->focus_resource_list);
@@ -809,6 +887,7 @@ meta_wayland_keyboard_set_focus (MetaWaylandKeyboard *keyboard,
 
           wl_resource_for_each (resource, &keyboard->focus_resource_list)
             {
+              ensure_keymap_sent (keyboard, resource);
               broadcast_focus (keyboard, resource);
             }
         }
@@ -908,6 +987,8 @@ meta_wayland_keyboard_init (MetaWaylandKeyboard *keyboard)
   wl_list_init (&keyboard->resource_list);
   wl_list_init (&keyboard->focus_resource_list);
 
+  keyboard->pending_keymap_resources = g_hash_table_new (NULL, NULL);
+
   keyboard->default_grab.interface = &default_keyboard_grab_interface;
   keyboard->default_grab.keyboard = keyboard;
   keyboard->grab = &keyboard->default_grab;
@@ -921,6 +1002,8 @@ meta_wayland_keyboard_finalize (GObject *object)
 {
   MetaWaylandKeyboard *keyboard = META_WAYLAND_KEYBOARD (object);
 
+  clear_pending_keymaps (keyboard);
+  g_clear_pointer (&keyboard->pending_keymap_resources, g_hash_table_unref);
   meta_wayland_xkb_info_destroy (&keyboard->xkb_info);
 
   G_OBJECT_CLASS (meta_wayland_keyboard_parent_class)->finalize (object);
@@ -82,6 +82,11 @@ struct _MetaWaylandKeyboard
   struct wl_list resource_list;
   struct wl_list focus_resource_list;
 
+  /* Unfocused resources that haven't received the current keymap yet */
+  GHashTable *pending_keymap_resources;
+  guint keymap_grace_timeout_id;
+  guint keymap_delivery_idle_id;
+
   MetaWaylandSurface *focus_surface;
   struct wl_listener focus_surface_listener;
   uint32_t focus_serial;
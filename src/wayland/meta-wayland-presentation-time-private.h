@@ -32,6 +32,8 @@ typedef struct _MetaWaylandPresentationFeedback
   struct wl_resource *resource;
 
   MetaWaylandSurface *surface;
+
+  gboolean is_zero_copy;
 } MetaWaylandPresentationFeedback;
 
 typedef struct _MetaWaylandPresentationTime
@@ -168,6 +168,18 @@ on_after_paint (ClutterStage          *stage,
 
       if (!wl_list_empty (&surface->presentation_time.feedback_list))
         {
+          MetaWaylandPresentationFeedback *feedback;
+          gboolean is_zero_copy;
+
+          /* A surface on an overlay plane is presented without copying,
+           * even though the rest of the stage view was composited. */
+          is_zero_copy =
+            surface->presentation_time.overlay_scanout_view == stage_view;
+          wl_list_for_each (feedback,
+                            &surface->presentation_time.feedback_list,
+                            link)
+            feedback->is_zero_copy = is_zero_copy;
+
           /* Add feedbacks to the list to be fired on presentation. */
           wl_list_insert_list (feedbacks,
                                &surface->presentation_time.feedback_list);
@@ -344,16 +356,23 @@ meta_wayland_presentation_feedback_present (MetaWaylandPresentationFeedback *fee
   seq_hi = surface->presentation_time.sequence >> 32;
   seq_lo = surface->presentation_time.sequence;
 
-  flags = WP_PRESENTATION_FEEDBACK_KIND_HW_COMPLETION;
+  flags = 0;
 
   if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_HW_CLOCK)
     flags |= WP_PRESENTATION_FEEDBACK_KIND_HW_CLOCK;
 
-  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY)
+  if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_ZERO_COPY ||
+      feedback->is_zero_copy)
     flags |= WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY;
 
+  /* Only an actual page flip event signals hardware completion; without
+   * one, e.g. when falling back to a mode set, the presentation time is
+   * the time the frame was handled. */
   if (frame_info->flags & CLUTTER_FRAME_INFO_FLAG_VSYNC)
-    flags |= WP_PRESENTATION_FEEDBACK_KIND_VSYNC;
+    {
+      flags |= WP_PRESENTATION_FEEDBACK_KIND_VSYNC;
+      flags |= WP_PRESENTATION_FEEDBACK_KIND_HW_COMPLETION;
+    }
 
   for (l = meta_wayland_output_get_resources (output); l; l = l->next)
     {
@@ -59,6 +59,7 @@ struct _MetaXWaylandManager
 
   guint abstract_fd_watch_id;
   guint unix_fd_watch_id;
+  guint warm_standby_id;
 
   gulong prepare_shutdown_id;
 
@@ -91,6 +92,7 @@ struct _MetaWaylandCompositor
 
   GHashTable *outputs;
   GList *frame_callback_surfaces;
+  GList *fifo_barrier_surfaces;
 
 #ifdef HAVE_XWAYLAND
   MetaXWaylandManager xwayland_manager;
@@ -105,12 +107,26 @@ struct _MetaWaylandCompositor
 
   MetaWaylandPresentationTime presentation_time;
   MetaWaylandDmaBufManager *dma_buf_manager;
+  MetaWaylandDrmSyncobjManager *drm_syncobj_manager;
 
   /*
    * Queue of transactions which have been committed but not applied yet, in the
    * order they were committed.
    */
   GQueue committed_transactions;
+
+  /*
+   * Queue of shm buffer damage being copied off the main thread, in the order
+   * it was committed, waiting to be uploaded to the texture.
+   */
+  GQueue pending_shm_uploads;
+
+  struct {
+    uint64_t texture_limit;
+    guint check_timeout_id;
+  } client_usage;
+
+  MetaWaylandProtocolStats *protocol_stats;
 };
 
 gboolean meta_wayland_compositor_is_egl_display_bound (MetaWaylandCompositor *compositor);
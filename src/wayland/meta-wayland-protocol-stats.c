@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Counts the requests of each client and the time spent handling them, per
+ * interface and request.
+ *
+ * The protocol logger of libwayland is only called before a request is
+ * dispatched, so a request is considered handled when the next one is
+ * logged, or when dispatching the Wayland event loop ended. The time thus
+ * also includes unmarshalling the next request, which is negligible compared
+ * to what the noteworthy requests cost.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-protocol-stats.h"
+
+#include <wayland-server.h>
+
+#include "cogl/cogl.h"
+#include "wayland/meta-wayland-private.h"
+
+typedef struct _RequestStats
+{
+  const char *name;
+  uint64_t count;
+  int64_t total_time_us;
+} RequestStats;
+
+typedef struct _ClientStats
+{
+  MetaWaylandProtocolStats *stats;
+  struct wl_listener destroy_listener;
+
+  pid_t pid;
+
+  /* Keys: struct wl_message of the request, values: RequestStats */
+  GHashTable *requests;
+} ClientStats;
+
+struct _MetaWaylandProtocolStats
+{
+  struct wl_protocol_logger *logger;
+
+  /* Keys: struct wl_client, values: ClientStats */
+  GHashTable *clients;
+
+  ClientStats *current_client;
+  RequestStats *current_request;
+  int64_t current_request_start_us;
+#ifdef HAVE_PROFILER
+  gboolean current_request_traced;
+  CoglTraceHead current_request_trace;
+#endif
+};
+
+static void
+client_stats_free (ClientStats *client_stats)
+{
+  wl_list_remove (&client_stats->destroy_listener.link);
+  g_hash_table_unref (client_stats->requests);
+  g_free (client_stats);
+}
+
+static void
+on_client_destroyed (struct wl_listener *listener,
+                     void               *data)
+{
+  ClientStats *client_stats = wl_container_of (listener, client_stats,
+                                               destroy_listener);
+  MetaWaylandProtocolStats *stats = client_stats->stats;
+
+  if (stats->current_client == client_stats)
+    meta_wayland_protocol_stats_end_dispatch (stats);
+
+  g_hash_table_remove (stats->clients, data);
+}
+
+static ClientStats *
+ensure_client_stats (MetaWaylandProtocolStats *stats,
+                     struct wl_client         *client)
+{
+  ClientStats *client_stats;
+
+  client_stats = g_hash_table_lookup (stats->clients, client);
+  if (client_stats)
+    return client_stats;
+
+  client_stats = g_new0 (ClientStats, 1);
+  client_stats->stats = stats;
+  client_stats->requests = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  wl_client_get_credentials (client, &client_stats->pid, NULL, NULL);
+
+  client_stats->destroy_listener.notify = on_client_destroyed;
+  wl_client_add_destroy_listener (client, &client_stats->destroy_listener);
+
+  g_hash_table_insert (stats->clients, client, client_stats);
+
+  return client_stats;
+}
+
+static RequestStats *
+ensure_request_stats (ClientStats             *client_stats,
+                      struct wl_resource      *resource,
+                      const struct wl_message *message)
+{
+  RequestStats *request_stats;
+  g_autofree char *name = NULL;
+
+  request_stats = g_hash_table_lookup (client_stats->requests, message);
+  if (request_stats)
+    return request_stats;
+
+  name = g_strdup_printf ("%s.%s",
+                          wl_resource_get_class (resource),
+                          message->name);
+
+  request_stats = g_new0 (RequestStats, 1);
+  /* Interned, as the name outlives the client when tracing */
+  request_stats->name = g_intern_string (name);
+  g_hash_table_insert (client_stats->requests, (gpointer) message,
+                       request_stats);
+
+  return request_stats;
+}
+
+static void
+protocol_logger_func (void                                   *user_data,
+                      enum wl_protocol_logger_type            type,
+                      const struct wl_protocol_logger_message *message)
+{
+  MetaWaylandProtocolStats *stats = user_data;
+  struct wl_client *client;
+  ClientStats *client_stats;
+
+  if (type != WL_PROTOCOL_LOGGER_REQUEST)
+    return;
+
+  meta_wayland_protocol_stats_end_dispatch (stats);
+
+  client = wl_resource_get_client (message->resource);
+  client_stats = ensure_client_stats (stats, client);
+
+  stats->current_client = client_stats;
+  stats->current_request = ensure_request_stats (client_stats,
+                                                 message->resource,
+                                                 message->message);
+  stats->current_request_start_us = g_get_monotonic_time ();
+
+#ifdef HAVE_PROFILER
+  stats->current_request_traced = cogl_is_tracing_enabled ();
+  if (stats->current_request_traced)
+    {
+      g_autofree char *description = NULL;
+
+      cogl_trace_begin (&stats->current_request_trace,
+                        stats->current_request->name);
+      description = g_strdup_printf ("pid: %d", client_stats->pid);
+      cogl_trace_describe (&stats->current_request_trace, description);
+    }
+#endif
+}
+
+void
+meta_wayland_protocol_stats_end_dispatch (MetaWaylandProtocolStats *stats)
+{
+  RequestStats *request_stats = stats->current_request;
+
+  if (!request_stats)
+    return;
+
+  request_stats->count++;
+  request_stats->total_time_us +=
+    g_get_monotonic_time () - stats->current_request_start_us;
+
+#ifdef HAVE_PROFILER
+  if (stats->current_request_traced)
+    cogl_trace_end (&stats->current_request_trace);
+  stats->current_request_traced = FALSE;
+#endif
+
+  stats->current_client = NULL;
+  stats->current_request = NULL;
+}
+
+void
+meta_wayland_protocol_stats_free (MetaWaylandProtocolStats *stats)
+{
+  meta_wayland_protocol_stats_end_dispatch (stats);
+
+  wl_protocol_logger_destroy (stats->logger);
+  g_hash_table_unref (stats->clients);
+  g_free (stats);
+}
+
+void
+meta_wayland_compositor_set_protocol_profiling (MetaWaylandCompositor *compositor,
+                                                gboolean               enabled)
+{
+  MetaWaylandProtocolStats *stats;
+
+  if (!enabled)
+    {
+      g_clear_pointer (&compositor->protocol_stats,
+                       meta_wayland_protocol_stats_free);
+      return;
+    }
+
+  if (compositor->protocol_stats)
+    return;
+
+  stats = g_new0 (MetaWaylandProtocolStats, 1);
+  stats->clients =
+    g_hash_table_new_full (NULL, NULL,
+                           NULL, (GDestroyNotify) client_stats_free);
+  stats->logger = wl_display_add_protocol_logger (compositor->wayland_display,
+                                                  protocol_logger_func,
+                                                  stats);
+
+  compositor->protocol_stats = stats;
+}
+
+/**
+ * meta_wayland_compositor_get_protocol_statistics:
+ *
+ * Returns: (transfer floating): The request statistics of each client since
+ *   profiling was enabled, as `a(ia(stx))` with the pid of the client, and
+ *   the name, count and total handling time in microseconds of each request.
+ */
+GVariant *
+meta_wayland_compositor_get_protocol_statistics (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandProtocolStats *stats = compositor->protocol_stats;
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  ClientStats *client_stats;
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ia(stx))"));
+
+  if (!stats)
+    return g_variant_builder_end (&builder);
+
+  g_hash_table_iter_init (&iter, stats->clients);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &client_stats))
+    {
+      GHashTableIter request_iter;
+      RequestStats *request_stats;
+
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("(ia(stx))"));
+      g_variant_builder_add (&builder, "i", client_stats->pid);
+      g_variant_builder_open (&builder, G_VARIANT_TYPE ("a(stx)"));
+
+      g_hash_table_iter_init (&request_iter, client_stats->requests);
+      while (g_hash_table_iter_next (&request_iter, NULL,
+                                     (gpointer *) &request_stats))
+        {
+          /* Requests that are still being handled don't count yet */
+          if (request_stats->count == 0)
+            continue;
+
+          g_variant_builder_add (&builder, "(stx)",
+                                 request_stats->name,
+                                 request_stats->count,
+                                 request_stats->total_time_us);
+        }
+
+      g_variant_builder_close (&builder);
+      g_variant_builder_close (&builder);
+    }
+
+  return g_variant_builder_end (&builder);
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "wayland/meta-wayland-types.h"
+
+void meta_wayland_compositor_set_protocol_profiling (MetaWaylandCompositor *compositor,
+                                                     gboolean               enabled);
+
+GVariant * meta_wayland_compositor_get_protocol_statistics (MetaWaylandCompositor *compositor);
+
+void meta_wayland_protocol_stats_end_dispatch (MetaWaylandProtocolStats *stats);
+
+void meta_wayland_protocol_stats_free (MetaWaylandProtocolStats *stats);
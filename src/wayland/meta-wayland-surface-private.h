@@ -27,6 +27,7 @@
 #include "compositor/meta-surface-actor.h"
 #include "meta/meta-cursor-tracker.h"
 #include "meta/meta-wayland-surface.h"
+#include "wayland/meta-wayland-drm-syncobj.h"
 #include "wayland/meta-wayland-pointer-constraints.h"
 #include "wayland/meta-wayland-types.h"
 
@@ -116,6 +117,28 @@ struct _MetaWaylandSurfaceState
   int viewport_dst_width;
   int viewport_dst_height;
 
+  /* wp_tearing_control */
+  gboolean has_new_allow_tearing;
+  gboolean allow_tearing;
+
+  /* wp_content_type */
+  gboolean has_new_content_type;
+  MetaWaylandContentType content_type;
+
+  /* wp_fifo_v1 */
+  gboolean fifo_barrier;
+  gboolean fifo_wait;
+
+  /* wp_commit_timer_v1 */
+  gboolean has_commit_time;
+  int64_t commit_time_us;
+
+  /* wp_linux_drm_syncobj_surface_v1 */
+  struct {
+    MetaWaylandSyncPoint *acquire;
+    MetaWaylandSyncPoint *release;
+  } drm_syncobj;
+
   GSList *subsurface_placement_ops;
 
   /* presentation-time */
@@ -234,6 +257,43 @@ struct _MetaWaylandSurface
     double scale;
   } fractional_scale;
 
+  /* wp_tearing_control */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+
+    gboolean allow_tearing;
+  } tearing_control;
+
+  /* wp_content_type */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+
+    MetaWaylandContentType type;
+  } content_type;
+
+  /* wp_fifo_v1 */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+
+    /* Set by an applied content update, until the compositor latched it */
+    gboolean barrier_set;
+  } fifo;
+
+  /* wp_commit_timer_v1 */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+  } commit_timer;
+
+  /* wp_linux_drm_syncobj_surface_v1 */
+  struct {
+    struct wl_resource *resource;
+    gulong destroy_handler_id;
+  } drm_syncobj;
+
   /* table of seats for which shortcuts are inhibited */
   GHashTable *shortcut_inhibited_seats;
 
@@ -245,6 +305,9 @@ struct _MetaWaylandSurface
     gboolean is_last_output_sequence_valid;
     gboolean needs_sequence_update;
 
+    /* Stage view that has the surface on an overlay plane, if any */
+    ClutterStageView *overlay_scanout_view;
+
     /*
      * Sequence has an undefined base, but is guaranteed to monotonically
      * increase. DRM only gives us a 32-bit sequence, so we compute our own
@@ -255,6 +318,7 @@ struct _MetaWaylandSurface
 
   /* dma-buf feedback */
   MetaCrtc *scanout_candidate;
+  MetaWaylandScanoutPlane scanout_candidate_plane;
 
   /* Transactions */
   struct {
@@ -383,14 +447,25 @@ int                 meta_wayland_surface_get_buffer_width (MetaWaylandSurface *s
 META_EXPORT_TEST
 int                 meta_wayland_surface_get_buffer_height (MetaWaylandSurface *surface);
 
-CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
-                                                              CoglOnscreen       *onscreen,
-                                                              ClutterStageView   *stage_view);
+CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface      *surface,
+                                                              CoglOnscreen            *onscreen,
+                                                              ClutterStageView        *stage_view,
+                                                              MetaWaylandScanoutPlane  plane);
 
 MetaCrtc * meta_wayland_surface_get_scanout_candidate (MetaWaylandSurface *surface);
 
-void meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface *surface,
-                                                 MetaCrtc           *crtc);
+MetaWaylandScanoutPlane meta_wayland_surface_get_scanout_candidate_plane (MetaWaylandSurface *surface);
+
+void meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface      *surface,
+                                                 MetaCrtc                *crtc,
+                                                 MetaWaylandScanoutPlane  plane);
+
+void meta_wayland_surface_set_overlay_scanout_view (MetaWaylandSurface *surface,
+                                                    ClutterStageView   *stage_view);
+
+gboolean meta_wayland_surface_is_tearing_allowed (MetaWaylandSurface *surface);
+
+MetaWaylandContentType meta_wayland_surface_get_content_type (MetaWaylandSurface *surface);
 
 int meta_wayland_surface_get_geometry_scale (MetaWaylandSurface *surface);
 
@@ -36,7 +36,10 @@
 #include "core/window-private.h"
 #include "wayland/meta-wayland-actor-surface.h"
 #include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-commit-timing.h"
+#include "wayland/meta-wayland-content-type.h"
 #include "wayland/meta-wayland-data-device.h"
+#include "wayland/meta-wayland-fifo.h"
 #include "wayland/meta-wayland-fractional-scale.h"
 #include "wayland/meta-wayland-gtk-shell.h"
 #include "wayland/meta-wayland-keyboard.h"
@@ -47,6 +50,7 @@
 #include "wayland/meta-wayland-region.h"
 #include "wayland/meta-wayland-seat.h"
 #include "wayland/meta-wayland-subsurface.h"
+#include "wayland/meta-wayland-tearing-control.h"
 #include "wayland/meta-wayland-transaction.h"
 #include "wayland/meta-wayland-viewporter.h"
 #include "wayland/meta-wayland-xdg-shell.h"
@@ -443,6 +447,13 @@ meta_wayland_surface_state_set_default (MetaWaylandSurfaceState *state)
   state->has_new_buffer_transform = FALSE;
   state->has_new_viewport_src_rect = FALSE;
   state->has_new_viewport_dst_size = FALSE;
+  state->has_new_allow_tearing = FALSE;
+  state->has_new_content_type = FALSE;
+  state->fifo_barrier = FALSE;
+  state->fifo_wait = FALSE;
+  state->has_commit_time = FALSE;
+  state->drm_syncobj.acquire = NULL;
+  state->drm_syncobj.release = NULL;
 
   state->subsurface_placement_ops = NULL;
 
@@ -475,6 +486,8 @@ meta_wayland_surface_state_clear (MetaWaylandSurfaceState *state)
   g_clear_pointer (&state->input_region, mtk_region_unref);
   g_clear_pointer (&state->opaque_region, mtk_region_unref);
   g_clear_pointer (&state->xdg_positioner, g_free);
+  g_clear_pointer (&state->drm_syncobj.acquire, meta_wayland_sync_point_free);
+  g_clear_pointer (&state->drm_syncobj.release, meta_wayland_sync_point_free);
 
   if (state->buffer_destroy_handler_id)
     {
@@ -520,6 +533,9 @@ meta_wayland_surface_state_merge_into (MetaWaylandSurfaceState *from,
 
       g_clear_object (&to->texture);
       to->texture = g_steal_pointer (&from->texture);
+
+      g_clear_pointer (&to->drm_syncobj.acquire, meta_wayland_sync_point_free);
+      to->drm_syncobj.acquire = g_steal_pointer (&from->drm_syncobj.acquire);
     }
 
   to->dx += from->dx;
@@ -602,6 +618,27 @@ meta_wayland_surface_state_merge_into (MetaWaylandSurfaceState *from,
       to->has_new_viewport_dst_size = TRUE;
     }
 
+  if (from->has_new_allow_tearing)
+    {
+      to->allow_tearing = from->allow_tearing;
+      to->has_new_allow_tearing = TRUE;
+    }
+
+  if (from->has_new_content_type)
+    {
+      to->content_type = from->content_type;
+      to->has_new_content_type = TRUE;
+    }
+
+  to->fifo_barrier |= from->fifo_barrier;
+  to->fifo_wait |= from->fifo_wait;
+
+  if (from->has_commit_time)
+    {
+      to->commit_time_us = from->commit_time_us;
+      to->has_commit_time = TRUE;
+    }
+
   if (from->subsurface_placement_ops != NULL)
     {
       if (to->subsurface_placement_ops != NULL)
@@ -795,6 +832,19 @@ meta_wayland_surface_apply_state (MetaWaylandSurface      *surface,
       surface->viewport.has_dst_size = surface->viewport.dst_width > 0;
     }
 
+  if (state->has_new_allow_tearing)
+    surface->tearing_control.allow_tearing = state->allow_tearing;
+
+  if (state->has_new_content_type)
+    surface->content_type.type = state->content_type;
+
+  if (state->fifo_barrier)
+    {
+      surface->fifo.barrier_set = TRUE;
+      meta_wayland_compositor_add_fifo_barrier_surface (surface->compositor,
+                                                        surface);
+    }
+
   state->derived.surface_size_changed =
     meta_wayland_surface_get_width (surface) != old_width ||
     meta_wayland_surface_get_height (surface) != old_height;
@@ -921,6 +971,10 @@ meta_wayland_surface_commit (MetaWaylandSurface *surface)
   COGL_TRACE_BEGIN_SCOPED (MetaWaylandSurfaceCommit,
                            "Meta::WaylandSurface::commit()");
 
+  if (surface->drm_syncobj.resource &&
+      !meta_wayland_surface_explicit_sync_validate (surface, pending))
+    return;
+
   if (pending->scale > 0)
     surface->committed_state.scale = pending->scale;
 
@@ -951,6 +1005,12 @@ meta_wayland_surface_commit (MetaWaylandSurface *surface)
 
       g_object_ref (buffer);
       meta_wayland_buffer_inc_use_count (buffer);
+
+      if (pending->drm_syncobj.release)
+        {
+          meta_wayland_buffer_add_release_point (buffer,
+                                                 g_steal_pointer (&pending->drm_syncobj.release));
+        }
     }
   else if (pending->newly_attached)
     {
@@ -1505,6 +1565,7 @@ meta_wayland_surface_finalize (GObject *object)
   g_clear_pointer (&surface->input_region, mtk_region_unref);
 
   meta_wayland_compositor_remove_frame_callback_surface (compositor, surface);
+  meta_wayland_compositor_remove_fifo_barrier_surface (compositor, surface);
   meta_wayland_compositor_remove_presentation_feedback_surface (compositor,
                                                                 surface);
 
@@ -1632,6 +1693,10 @@ meta_wayland_shell_init (MetaWaylandCompositor *compositor)
   meta_wayland_init_gtk_shell (compositor);
   meta_wayland_init_viewporter (compositor);
   meta_wayland_init_fractional_scale (compositor);
+  meta_wayland_init_tearing_control (compositor);
+  meta_wayland_init_content_type (compositor);
+  meta_wayland_init_fifo (compositor);
+  meta_wayland_init_commit_timing (compositor);
 }
 
 void
@@ -2254,9 +2319,10 @@ meta_wayland_surface_get_buffer_height (MetaWaylandSurface *surface)
 }
 
 CoglScanout *
-meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
-                                          CoglOnscreen       *onscreen,
-                                          ClutterStageView   *stage_view)
+meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface      *surface,
+                                          CoglOnscreen            *onscreen,
+                                          ClutterStageView        *stage_view,
+                                          MetaWaylandScanoutPlane  plane)
 {
   MetaRendererView *renderer_view;
   MetaSurfaceActor *surface_actor;
@@ -2319,8 +2385,10 @@ meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
                             untransformed_view_height,
                             &dst_rect);
 
-  /* Use an implicit destination rect when possible */
-  if (surface->viewport.has_dst_size ||
+  /* Use an implicit destination rect when possible; overlay planes are
+   * always positioned explicitly */
+  if (plane != META_WAYLAND_SCANOUT_PLANE_PRIMARY ||
+      surface->viewport.has_dst_size ||
       dst_rect.x != 0 || dst_rect.y != 0 ||
       dst_rect.width != untransformed_view_width ||
       dst_rect.height != untransformed_view_height)
@@ -2334,6 +2402,7 @@ meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
 
   return meta_wayland_buffer_try_acquire_scanout (surface->buffer,
                                                   onscreen,
+                                                  plane,
                                                   src_rect_ptr,
                                                   dst_rect_ptr);
 }
@@ -2344,18 +2413,66 @@ meta_wayland_surface_get_scanout_candidate (MetaWaylandSurface *surface)
   return surface->scanout_candidate;
 }
 
+/**
+ * meta_wayland_surface_get_scanout_candidate_plane:
+ * @surface: A #MetaWaylandSurface
+ *
+ * Returns: The kind of plane of the scanout candidate CRTC the surface could
+ * be scanned out on. Only meaningful if there is a scanout candidate.
+ */
+MetaWaylandScanoutPlane
+meta_wayland_surface_get_scanout_candidate_plane (MetaWaylandSurface *surface)
+{
+  return surface->scanout_candidate_plane;
+}
+
 void
-meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface *surface,
-                                            MetaCrtc           *crtc)
+meta_wayland_surface_set_scanout_candidate (MetaWaylandSurface      *surface,
+                                            MetaCrtc                *crtc,
+                                            MetaWaylandScanoutPlane  plane)
 {
-  if (surface->scanout_candidate == crtc)
+  if (surface->scanout_candidate == crtc &&
+      surface->scanout_candidate_plane == plane)
     return;
 
   g_set_object (&surface->scanout_candidate, crtc);
+  surface->scanout_candidate_plane = plane;
   g_object_notify_by_pspec (G_OBJECT (surface),
                             obj_props[PROP_SCANOUT_CANDIDATE]);
 }
 
+void
+meta_wayland_surface_set_overlay_scanout_view (MetaWaylandSurface *surface,
+                                               ClutterStageView   *stage_view)
+{
+  surface->presentation_time.overlay_scanout_view = stage_view;
+}
+
+/**
+ * meta_wayland_surface_is_tearing_allowed:
+ * @surface: A #MetaWaylandSurface
+ *
+ * Returns: %TRUE if the client asked for the surface contents to be
+ *   presented as soon as possible, even if that causes tearing.
+ */
+gboolean
+meta_wayland_surface_is_tearing_allowed (MetaWaylandSurface *surface)
+{
+  return surface->tearing_control.allow_tearing;
+}
+
+/**
+ * meta_wayland_surface_get_content_type:
+ * @surface: A #MetaWaylandSurface
+ *
+ * Returns: The kind of content the client said the surface shows.
+ */
+MetaWaylandContentType
+meta_wayland_surface_get_content_type (MetaWaylandSurface *surface)
+{
+  return surface->content_type.type;
+}
+
 int
 meta_wayland_surface_get_geometry_scale (MetaWaylandSurface *surface)
 {
@@ -0,0 +1,166 @@
+/*
+ * Wayland Support
+ *
+ * Copyright (C) 2025 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include "meta-wayland-tearing-control.h"
+
+#include <glib.h>
+
+#include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-surface-private.h"
+#include "wayland/meta-wayland-versions.h"
+
+#include "tearing-control-v1-server-protocol.h"
+
+static void
+wp_tearing_control_destructor (struct wl_resource *resource)
+{
+  MetaWaylandSurface *surface;
+  MetaWaylandSurfaceState *pending;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    return;
+
+  g_clear_signal_handler (&surface->tearing_control.destroy_handler_id,
+                          surface);
+
+  /* Reverts to vsync with the next commit */
+  pending = meta_wayland_surface_get_pending_state (surface);
+  if (pending)
+    {
+      pending->allow_tearing = FALSE;
+      pending->has_new_allow_tearing = TRUE;
+    }
+
+  surface->tearing_control.resource = NULL;
+}
+
+static void
+on_surface_destroyed (MetaWaylandSurface *surface)
+{
+  wl_resource_set_user_data (surface->tearing_control.resource, NULL);
+}
+
+static void
+wp_tearing_control_set_presentation_hint (struct wl_client   *client,
+                                          struct wl_resource *resource,
+                                          uint32_t            hint)
+{
+  MetaWaylandSurface *surface;
+  MetaWaylandSurfaceState *pending;
+
+  surface = wl_resource_get_user_data (resource);
+  if (!surface)
+    return;
+
+  pending = meta_wayland_surface_get_pending_state (surface);
+  pending->allow_tearing = hint == WP_TEARING_CONTROL_V1_PRESENTATION_HINT_ASYNC;
+  pending->has_new_allow_tearing = TRUE;
+}
+
+static void
+wp_tearing_control_destroy (struct wl_client   *client,
+                            struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static const struct wp_tearing_control_v1_interface meta_wayland_tearing_control_interface = {
+  wp_tearing_control_set_presentation_hint,
+  wp_tearing_control_destroy,
+};
+
+static void
+wp_tearing_control_manager_destroy (struct wl_client   *client,
+                                    struct wl_resource *resource)
+{
+  wl_resource_destroy (resource);
+}
+
+static void
+wp_tearing_control_manager_get_tearing_control (struct wl_client   *client,
+                                                struct wl_resource *resource,
+                                                uint32_t            tearing_control_id,
+                                                struct wl_resource *surface_resource)
+{
+  MetaWaylandSurface *surface;
+  struct wl_resource *tearing_control_resource;
+
+  surface = wl_resource_get_user_data (surface_resource);
+  if (surface->tearing_control.resource)
+    {
+      wl_resource_post_error (resource,
+                              WP_TEARING_CONTROL_MANAGER_V1_ERROR_TEARING_CONTROL_EXISTS,
+                              "tearing control resource already exists on surface");
+      return;
+    }
+
+  tearing_control_resource = wl_resource_create (client,
+                                                 &wp_tearing_control_v1_interface,
+                                                 wl_resource_get_version (resource),
+                                                 tearing_control_id);
+  wl_resource_set_implementation (tearing_control_resource,
+                                  &meta_wayland_tearing_control_interface,
+                                  surface,
+                                  wp_tearing_control_destructor);
+
+  surface->tearing_control.resource = tearing_control_resource;
+  surface->tearing_control.destroy_handler_id =
+    g_signal_connect (surface,
+                      "destroy",
+                      G_CALLBACK (on_surface_destroyed),
+                      NULL);
+}
+
+static const struct wp_tearing_control_manager_v1_interface meta_wayland_tearing_control_manager_interface = {
+  wp_tearing_control_manager_destroy,
+  wp_tearing_control_manager_get_tearing_control,
+};
+
+static void
+wp_tearing_control_bind (struct wl_client *client,
+                         void             *data,
+                         uint32_t          version,
+                         uint32_t          id)
+{
+  struct wl_resource *resource;
+
+  resource = wl_resource_create (client,
+                                 &wp_tearing_control_manager_v1_interface,
+                                 version,
+                                 id);
+  wl_resource_set_implementation (resource,
+                                  &meta_wayland_tearing_control_manager_interface,
+                                  data,
+                                  NULL);
+}
+
+void
+meta_wayland_init_tearing_control (MetaWaylandCompositor *compositor)
+{
+  if (wl_global_create (compositor->wayland_display,
+                        &wp_tearing_control_manager_v1_interface,
+                        META_WP_TEARING_CONTROL_VERSION,
+                        compositor,
+                        wp_tearing_control_bind) == NULL)
+    g_error ("Failed to register a global wp_tearing_control object");
+}
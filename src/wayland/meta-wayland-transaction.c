@@ -23,18 +23,28 @@
 
 #include <glib-unix.h>
 
+#include "compositor/meta-surface-actor.h"
 #include "wayland/meta-wayland.h"
 #include "wayland/meta-wayland-buffer.h"
 #include "wayland/meta-wayland-dma-buf.h"
-
-#define META_WAYLAND_TRANSACTION_NONE ((void *)(uintptr_t) G_MAXSIZE)
+#include "wayland/meta-wayland-drm-syncobj.h"
 
 struct _MetaWaylandTransaction
 {
   GList node;
   MetaWaylandCompositor *compositor;
-  MetaWaylandTransaction *next_candidate;
-  uint64_t committed_sequence;
+
+  /* Link in the queue of transactions which may be applied next */
+  GList candidate_link;
+
+  /*
+   * Number of surfaces in the transaction which still have an earlier
+   * committed transaction pending
+   */
+  unsigned int num_blocked_surfaces;
+
+  /* Whether any entry waits for a FIFO barrier */
+  gboolean has_fifo_wait;
 
   /*
    * Keys:   All surfaces referenced in the transaction
@@ -44,6 +54,9 @@ struct _MetaWaylandTransaction
 
   /* Sources for buffers which are not ready yet */
   GHashTable *buf_sources;
+
+  /* Source for the time the transaction is meant to be presented at */
+  GSource *commit_time_source;
 };
 
 struct _MetaWaylandTransactionEntry
@@ -164,27 +177,8 @@ meta_wayland_transaction_compare (const void *key1,
 }
 
 static void
-ensure_next_candidate (MetaWaylandTransaction  *transaction,
-                       MetaWaylandTransaction **first_candidate)
-{
-  MetaWaylandTransaction **candidate;
-
-  if (transaction->next_candidate)
-    return;
-
-  candidate = first_candidate;
-  while (*candidate != META_WAYLAND_TRANSACTION_NONE &&
-         (*candidate)->committed_sequence <
-         transaction->committed_sequence)
-    candidate = &(*candidate)->next_candidate;
-
-  transaction->next_candidate = *candidate;
-  *candidate = transaction;
-}
-
-static void
-meta_wayland_transaction_apply (MetaWaylandTransaction  *transaction,
-                                MetaWaylandTransaction **first_candidate)
+meta_wayland_transaction_apply (MetaWaylandTransaction *transaction,
+                                GQueue                 *candidates)
 {
   g_autofree MetaWaylandSurface **surfaces = NULL;
   g_autofree MetaWaylandSurfaceState **states = NULL;
@@ -237,7 +231,11 @@ meta_wayland_transaction_apply (MetaWaylandTransaction  *transaction,
           if (next_transaction)
             {
               surface->transaction.first_committed = next_transaction;
-              ensure_next_candidate (next_transaction, first_candidate);
+
+              g_assert (next_transaction->num_blocked_surfaces > 0);
+              if (--next_transaction->num_blocked_surfaces == 0)
+                g_queue_push_tail_link (candidates,
+                                        &next_transaction->candidate_link);
             }
         }
     }
@@ -258,15 +256,27 @@ has_dependencies (MetaWaylandTransaction *transaction)
 {
   GHashTableIter iter;
   MetaWaylandSurface *surface;
+  MetaWaylandTransactionEntry *entry;
+
+  if (transaction->num_blocked_surfaces > 0)
+    return TRUE;
 
   if (transaction->buf_sources &&
       g_hash_table_size (transaction->buf_sources) > 0)
     return TRUE;
 
+  if (transaction->commit_time_source)
+    return TRUE;
+
+  if (!transaction->has_fifo_wait)
+    return FALSE;
+
   g_hash_table_iter_init (&iter, transaction->entries);
-  while (g_hash_table_iter_next (&iter, (gpointer *) &surface, NULL))
+  while (g_hash_table_iter_next (&iter,
+                                 (gpointer *) &surface, (gpointer *) &entry))
     {
-      if (surface->transaction.first_committed != transaction)
+      if (entry && entry->state && entry->state->fifo_wait &&
+          surface->fifo.barrier_set)
         return TRUE;
     }
 
@@ -274,30 +284,34 @@ has_dependencies (MetaWaylandTransaction *transaction)
 }
 
 static void
-meta_wayland_transaction_maybe_apply_one (MetaWaylandTransaction  *transaction,
-                                          MetaWaylandTransaction **first_candidate)
+meta_wayland_transaction_maybe_apply_one (MetaWaylandTransaction *transaction,
+                                          GQueue                 *candidates)
 {
   if (has_dependencies (transaction))
     return;
 
-  meta_wayland_transaction_apply (transaction, first_candidate);
+  meta_wayland_transaction_apply (transaction, candidates);
 }
 
 static void
 meta_wayland_transaction_maybe_apply (MetaWaylandTransaction *transaction)
 {
-  MetaWaylandTransaction *first_candidate = META_WAYLAND_TRANSACTION_NONE;
+  GQueue candidates = G_QUEUE_INIT;
+  GList *link;
 
+  /*
+   * Applying a transaction only unblocks the transactions committed after it
+   * for the same surfaces, so only those are considered next
+   */
   while (TRUE)
     {
-      meta_wayland_transaction_maybe_apply_one (transaction, &first_candidate);
+      meta_wayland_transaction_maybe_apply_one (transaction, &candidates);
 
-      if (first_candidate == META_WAYLAND_TRANSACTION_NONE)
+      link = g_queue_pop_head_link (&candidates);
+      if (!link)
         return;
 
-      transaction = first_candidate;
-      first_candidate = transaction->next_candidate;
-      transaction->next_candidate = NULL;
+      transaction = link->data;
     }
 }
 
@@ -316,7 +330,8 @@ meta_wayland_transaction_dma_buf_dispatch (MetaWaylandBuffer *buffer,
 
 static gboolean
 meta_wayland_transaction_add_dma_buf_source (MetaWaylandTransaction *transaction,
-                                             MetaWaylandBuffer      *buffer)
+                                             MetaWaylandBuffer      *buffer,
+                                             MetaWaylandSyncPoint   *acquire)
 {
   GSource *source;
 
@@ -324,9 +339,20 @@ meta_wayland_transaction_add_dma_buf_source (MetaWaylandTransaction *transaction
       g_hash_table_contains (transaction->buf_sources, buffer))
     return FALSE;
 
-  source = meta_wayland_dma_buf_create_source (buffer,
-                                               meta_wayland_transaction_dma_buf_dispatch,
-                                               transaction);
+  /* An explicit acquire point replaces the implicit dma-buf fences */
+  if (acquire)
+    {
+      source = meta_wayland_drm_syncobj_create_source (buffer,
+                                                       acquire,
+                                                       meta_wayland_transaction_dma_buf_dispatch,
+                                                       transaction);
+    }
+  else
+    {
+      source = meta_wayland_dma_buf_create_source (buffer,
+                                                   meta_wayland_transaction_dma_buf_dispatch,
+                                                   transaction);
+    }
   if (!source)
     return FALSE;
 
@@ -344,6 +370,99 @@ meta_wayland_transaction_add_dma_buf_source (MetaWaylandTransaction *transaction
   return TRUE;
 }
 
+void
+meta_wayland_transaction_maybe_apply_for_surface (MetaWaylandSurface *surface)
+{
+  MetaWaylandTransaction *transaction = surface->transaction.first_committed;
+
+  if (transaction)
+    meta_wayland_transaction_maybe_apply (transaction);
+}
+
+static gboolean
+commit_time_source_dispatch (GSource     *source,
+                             GSourceFunc  callback,
+                             gpointer     user_data)
+{
+  return callback (user_data);
+}
+
+static GSourceFuncs commit_time_source_funcs = {
+  .dispatch = commit_time_source_dispatch,
+};
+
+static gboolean
+meta_wayland_transaction_commit_time_reached (gpointer user_data)
+{
+  MetaWaylandTransaction *transaction = user_data;
+
+  g_clear_pointer (&transaction->commit_time_source, g_source_destroy);
+  meta_wayland_transaction_maybe_apply (transaction);
+
+  return G_SOURCE_REMOVE;
+}
+
+static int64_t
+get_refresh_interval_us (MetaWaylandSurface *surface)
+{
+  MetaSurfaceActor *actor;
+  float highest_refresh_rate = 0.0f;
+  GList *l;
+
+  actor = meta_wayland_surface_get_actor (surface);
+  if (!actor)
+    return 0;
+
+  for (l = clutter_actor_peek_stage_views (CLUTTER_ACTOR (actor)); l; l = l->next)
+    {
+      highest_refresh_rate =
+        MAX (highest_refresh_rate,
+             clutter_stage_view_get_refresh_rate (l->data));
+    }
+
+  if (highest_refresh_rate <= 0.0f)
+    return 0;
+
+  return (int64_t) (G_USEC_PER_SEC / highest_refresh_rate);
+}
+
+static gboolean
+meta_wayland_transaction_add_commit_time_source (MetaWaylandTransaction *transaction,
+                                                 MetaWaylandSurface     *surface,
+                                                 int64_t                 commit_time_us)
+{
+  int64_t ready_time_us;
+
+  /* Applying the transaction half a refresh cycle early makes it land in the
+   * refresh cycle closest to the requested time, rather than always in the
+   * one after it. */
+  ready_time_us = commit_time_us - get_refresh_interval_us (surface) / 2;
+  if (ready_time_us <= g_get_monotonic_time ())
+    return FALSE;
+
+  if (transaction->commit_time_source)
+    {
+      if (g_source_get_ready_time (transaction->commit_time_source) <
+          ready_time_us)
+        g_source_set_ready_time (transaction->commit_time_source, ready_time_us);
+
+      return TRUE;
+    }
+
+  transaction->commit_time_source = g_source_new (&commit_time_source_funcs,
+                                                  sizeof (GSource));
+  g_source_set_name (transaction->commit_time_source,
+                     "[mutter] Wayland commit time");
+  g_source_set_callback (transaction->commit_time_source,
+                         meta_wayland_transaction_commit_time_reached,
+                         transaction, NULL);
+  g_source_set_ready_time (transaction->commit_time_source, ready_time_us);
+  g_source_attach (transaction->commit_time_source, NULL);
+  g_source_unref (transaction->commit_time_source);
+
+  return TRUE;
+}
+
 static void
 meta_wayland_transaction_add_placement_surfaces (MetaWaylandTransaction  *transaction,
                                                  MetaWaylandSurfaceState *state)
@@ -364,7 +483,6 @@ meta_wayland_transaction_add_placement_surfaces (MetaWaylandTransaction  *transa
 void
 meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
 {
-  static uint64_t committed_sequence;
   GQueue *committed_queue;
   gboolean maybe_apply = TRUE;
   GHashTableIter iter;
@@ -383,9 +501,25 @@ meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
           MetaWaylandBuffer *buffer = entry->state->buffer;
 
           if (buffer &&
-              meta_wayland_transaction_add_dma_buf_source (transaction, buffer))
+              meta_wayland_transaction_add_dma_buf_source (transaction,
+                                                           buffer,
+                                                           entry->state->drm_syncobj.acquire))
             maybe_apply = FALSE;
 
+          if (entry->state->has_commit_time &&
+              meta_wayland_transaction_add_commit_time_source (transaction,
+                                                               surface,
+                                                               entry->state->commit_time_us))
+            maybe_apply = FALSE;
+
+          if (entry->state->fifo_wait)
+            {
+              transaction->has_fifo_wait = TRUE;
+
+              if (surface->fifo.barrier_set)
+                maybe_apply = FALSE;
+            }
+
           if (entry->state->subsurface_placement_ops)
             {
               if (!placement_states)
@@ -406,7 +540,6 @@ meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
                                                        placement_state);
     }
 
-  transaction->committed_sequence = ++committed_sequence;
   transaction->node.data = transaction;
 
   committed_queue =
@@ -423,6 +556,7 @@ meta_wayland_transaction_commit (MetaWaylandTransaction *transaction)
           entry = g_hash_table_lookup (surface->transaction.last_committed->entries,
                                        surface);
           entry->next_transaction = transaction;
+          transaction->num_blocked_surfaces++;
           maybe_apply = FALSE;
         }
       else
@@ -600,12 +734,28 @@ meta_wayland_transaction_new (MetaWaylandCompositor *compositor)
   transaction = g_new0 (MetaWaylandTransaction, 1);
 
   transaction->compositor = compositor;
+  transaction->candidate_link.data = transaction;
   transaction->entries = g_hash_table_new_full (NULL, NULL, g_object_unref,
                                                 (GDestroyNotify) meta_wayland_transaction_entry_free);
 
   return transaction;
 }
 
+struct wl_client *
+meta_wayland_transaction_get_client (MetaWaylandTransaction *transaction)
+{
+  GHashTableIter iter;
+  MetaWaylandSurface *surface;
+
+  /* All surfaces of a transaction belong to the same client */
+  g_hash_table_iter_init (&iter, transaction->entries);
+  if (!g_hash_table_iter_next (&iter, (gpointer *) &surface, NULL) ||
+      !surface->resource)
+    return NULL;
+
+  return wl_resource_get_client (surface->resource);
+}
+
 void
 meta_wayland_transaction_free (MetaWaylandTransaction *transaction)
 {
@@ -618,6 +768,7 @@ meta_wayland_transaction_free (MetaWaylandTransaction *transaction)
     }
 
   g_clear_pointer (&transaction->buf_sources, g_hash_table_destroy);
+  g_clear_pointer (&transaction->commit_time_source, g_source_destroy);
   g_hash_table_destroy (transaction->entries);
   g_free (transaction);
 }
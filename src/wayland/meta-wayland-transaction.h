@@ -25,6 +25,8 @@ void meta_wayland_transaction_drop_subsurface_state (MetaWaylandTransaction *tra
 
 void meta_wayland_transaction_commit (MetaWaylandTransaction *transaction);
 
+void meta_wayland_transaction_maybe_apply_for_surface (MetaWaylandSurface *surface);
+
 MetaWaylandTransactionEntry *meta_wayland_transaction_ensure_entry (MetaWaylandTransaction *transaction,
                                                                     MetaWaylandSurface     *surface);
 
@@ -50,6 +52,8 @@ void meta_wayland_transaction_merge_pending_state (MetaWaylandTransaction *trans
 
 MetaWaylandTransaction *meta_wayland_transaction_new (MetaWaylandCompositor *compositor);
 
+struct wl_client *meta_wayland_transaction_get_client (MetaWaylandTransaction *transaction);
+
 void meta_wayland_transaction_free (MetaWaylandTransaction *transaction);
 
 void meta_wayland_transaction_finalize (MetaWaylandCompositor *compositor);
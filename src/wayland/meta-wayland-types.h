@@ -73,3 +73,19 @@ typedef struct _MetaWaylandXdgForeign MetaWaylandXdgForeign;
 typedef struct _MetaWaylandFilterManager MetaWaylandFilterManager;
 
 typedef struct _MetaWaylandClient MetaWaylandClient;
+
+typedef struct _MetaWaylandProtocolStats MetaWaylandProtocolStats;
+
+typedef enum _MetaWaylandScanoutPlane
+{
+  META_WAYLAND_SCANOUT_PLANE_PRIMARY,
+  META_WAYLAND_SCANOUT_PLANE_OVERLAY,
+} MetaWaylandScanoutPlane;
+
+typedef enum _MetaWaylandContentType
+{
+  META_WAYLAND_CONTENT_TYPE_NONE,
+  META_WAYLAND_CONTENT_TYPE_PHOTO,
+  META_WAYLAND_CONTENT_TYPE_VIDEO,
+  META_WAYLAND_CONTENT_TYPE_GAME,
+} MetaWaylandContentType;
@@ -57,3 +57,8 @@
 #define META_WP_SINGLE_PIXEL_BUFFER_V1_VERSION 1
 #define META_MUTTER_X11_INTEROP_VERSION 1
 #define META_WP_FRACTIONAL_SCALE_VERSION 1
+#define META_WP_TEARING_CONTROL_VERSION 1
+#define META_WP_CONTENT_TYPE_VERSION 1
+#define META_WP_FIFO_VERSION 1
+#define META_WP_COMMIT_TIMING_VERSION 1
+#define META_WP_LINUX_DRM_SYNCOBJ_VERSION 1
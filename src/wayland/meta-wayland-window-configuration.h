@@ -50,6 +50,8 @@ struct _MetaWaylandWindowConfiguration
 
   gboolean is_fullscreen;
   gboolean is_suspended;
+
+  int64_t sent_time_us;
 };
 
 MetaWaylandWindowConfiguration * meta_wayland_window_configuration_new (MetaWindow          *window,
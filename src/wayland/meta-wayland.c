@@ -31,10 +31,13 @@
 #include "compositor/meta-surface-actor-wayland.h"
 #include "core/events.h"
 #include "core/meta-context-private.h"
+#include "meta/prefs.h"
 #include "wayland/meta-wayland-activation.h"
 #include "wayland/meta-wayland-buffer.h"
+#include "wayland/meta-wayland-client-usage.h"
 #include "wayland/meta-wayland-data-device.h"
 #include "wayland/meta-wayland-dma-buf.h"
+#include "wayland/meta-wayland-drm-syncobj.h"
 #include "wayland/meta-wayland-egl-stream.h"
 #include "wayland/meta-wayland-filter-manager.h"
 #include "wayland/meta-wayland-idle-inhibit.h"
@@ -44,6 +47,7 @@
 #include "wayland/meta-wayland-outputs.h"
 #include "wayland/meta-wayland-presentation-time-private.h"
 #include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-protocol-stats.h"
 #include "wayland/meta-wayland-region.h"
 #include "wayland/meta-wayland-seat.h"
 #include "wayland/meta-wayland-subsurface.h"
@@ -80,15 +84,22 @@ typedef struct _MetaWaylandCompositorPrivate
 
   MetaWaylandFilterManager *filter_manager;
   GHashTable *frame_callback_sources;
+  guint hidden_frame_callback_timeout_id;
 } MetaWaylandCompositorPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaWaylandCompositor, meta_wayland_compositor,
                             G_TYPE_OBJECT)
 
+/* Events queued outside of the well-defined flush points are still sent
+ * within this delay. */
+#define MAX_FLUSH_DELAY_US (G_USEC_PER_SEC / 500)
+
 typedef struct
 {
   GSource source;
+  MetaWaylandCompositor *compositor;
   struct wl_display *display;
+  gboolean needs_flush;
 } WaylandEventSource;
 
 typedef struct
@@ -99,9 +110,33 @@ typedef struct
   ClutterStageView *stage_view;
 } FrameCallbackSource;
 
+typedef struct _ScheduledSurfaceAssociation
+{
+  MetaWindow *window;
+  gulong unmanaged_handler_id;
+  int64_t scheduled_time_us;
+} ScheduledSurfaceAssociation;
+
+static void
+scheduled_surface_association_free (ScheduledSurfaceAssociation *association)
+{
+  g_clear_signal_handler (&association->unmanaged_handler_id,
+                          association->window);
+  g_free (association);
+}
+
 static void meta_wayland_compositor_update_focus (MetaWaylandCompositor *compositor,
                                                   MetaWindow            *window);
 
+static void
+schedule_flush (MetaWaylandCompositor *compositor)
+{
+  WaylandEventSource *source = (WaylandEventSource *) compositor->source;
+
+  if (source)
+    source->needs_flush = TRUE;
+}
+
 static gboolean
 wayland_event_source_prepare (GSource *base,
                               int     *timeout)
@@ -110,7 +145,21 @@ wayland_event_source_prepare (GSource *base,
 
   *timeout = -1;
 
-  wl_display_flush_clients (source->display);
+  /* Flush once per main loop iteration, after all sources dispatched in it
+   * queued their events, but only if one of them was a flush point, i.e.
+   * client requests, input events or a completed frame. Anything else gets
+   * sent along with the next flush, or when the flush delay expired. */
+  if (source->needs_flush)
+    {
+      wl_display_flush_clients (source->display);
+      source->needs_flush = FALSE;
+      g_source_set_ready_time (base, -1);
+    }
+  else if (g_source_get_ready_time (base) == -1)
+    {
+      g_source_set_ready_time (base,
+                               g_get_monotonic_time () + MAX_FLUSH_DELAY_US);
+    }
 
   return FALSE;
 }
@@ -125,6 +174,13 @@ wayland_event_source_dispatch (GSource    *base,
 
   wl_event_loop_dispatch (loop, 0);
 
+  if (source->compositor->protocol_stats)
+    meta_wayland_protocol_stats_end_dispatch (source->compositor->protocol_stats);
+
+  /* Replies to client requests are sent right away */
+  source->needs_flush = TRUE;
+  g_source_set_ready_time (base, -1);
+
   return TRUE;
 }
 
@@ -137,8 +193,9 @@ static GSourceFuncs wayland_event_source_funcs =
 };
 
 static GSource *
-wayland_event_source_new (struct wl_display *display)
+wayland_event_source_new (MetaWaylandCompositor *compositor)
 {
+  struct wl_display *display = compositor->wayland_display;
   GSource *source;
   WaylandEventSource *wayland_source;
   struct wl_event_loop *loop = wl_display_get_event_loop (display);
@@ -147,6 +204,7 @@ wayland_event_source_new (struct wl_display *display)
                          sizeof (WaylandEventSource));
   g_source_set_name (source, "[mutter] Wayland events");
   wayland_source = (WaylandEventSource *) source;
+  wayland_source->compositor = compositor;
   wayland_source->display = display;
   g_source_add_unix_fd (&wayland_source->source,
                         wl_event_loop_get_fd (loop),
@@ -189,6 +247,109 @@ emit_frame_callbacks_for_stage_view (MetaWaylandCompositor *compositor,
       compositor->frame_callback_surfaces =
         g_list_delete_link (compositor->frame_callback_surfaces, l_cur);
     }
+
+  schedule_flush (compositor);
+}
+
+static gboolean
+is_primary_on_any_stage_view (MetaSurfaceActor *actor)
+{
+  ClutterActor *stage;
+  GList *l;
+
+  stage = clutter_actor_get_stage (CLUTTER_ACTOR (actor));
+  if (!stage)
+    return FALSE;
+
+  for (l = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage)); l; l = l->next)
+    {
+      if (meta_surface_actor_wayland_is_view_primary (actor, l->data))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+emit_hidden_frame_callbacks (gpointer user_data)
+{
+  MetaWaylandCompositor *compositor = user_data;
+  MetaWaylandCompositorPrivate *priv =
+    meta_wayland_compositor_get_instance_private (compositor);
+  GList *l;
+  int64_t now_us;
+
+  now_us = g_get_monotonic_time ();
+
+  l = compositor->frame_callback_surfaces;
+  while (l)
+    {
+      GList *l_cur = l;
+      MetaWaylandSurface *surface = l->data;
+      MetaSurfaceActor *actor;
+      MetaWaylandActorSurface *actor_surface;
+
+      l = l->next;
+
+      actor = meta_wayland_surface_get_actor (surface);
+      if (!actor)
+        continue;
+
+      /* Surfaces that are primary on some view get their frame callbacks when
+       * that view updates, at its refresh rate. */
+      if (is_primary_on_any_stage_view (actor))
+        continue;
+
+      actor_surface = META_WAYLAND_ACTOR_SURFACE (surface->role);
+      meta_wayland_actor_surface_emit_frame_callbacks (actor_surface,
+                                                       now_us / 1000);
+
+      compositor->frame_callback_surfaces =
+        g_list_delete_link (compositor->frame_callback_surfaces, l_cur);
+    }
+
+  if (compositor->frame_callback_surfaces)
+    return G_SOURCE_CONTINUE;
+
+  priv->hidden_frame_callback_timeout_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+static void
+ensure_hidden_frame_callback_timeout (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandCompositorPrivate *priv =
+    meta_wayland_compositor_get_instance_private (compositor);
+  unsigned int interval_ms;
+
+  if (priv->hidden_frame_callback_timeout_id)
+    return;
+
+  interval_ms = meta_prefs_get_hidden_frame_callback_interval ();
+  if (interval_ms == 0)
+    return;
+
+  priv->hidden_frame_callback_timeout_id =
+    g_timeout_add (interval_ms, emit_hidden_frame_callbacks, compositor);
+  g_source_set_name_by_id (priv->hidden_frame_callback_timeout_id,
+                           "[mutter] Wayland frame callbacks for hidden surfaces");
+}
+
+static void
+prefs_changed (MetaPreference pref,
+               gpointer       user_data)
+{
+  MetaWaylandCompositor *compositor = user_data;
+  MetaWaylandCompositorPrivate *priv =
+    meta_wayland_compositor_get_instance_private (compositor);
+
+  if (pref != META_PREF_HIDDEN_FRAME_CALLBACK_INTERVAL)
+    return;
+
+  g_clear_handle_id (&priv->hidden_frame_callback_timeout_id, g_source_remove);
+
+  if (compositor->frame_callback_surfaces)
+    ensure_hidden_frame_callback_timeout (compositor);
 }
 
 #ifdef HAVE_NATIVE_BACKEND
@@ -284,6 +445,52 @@ ensure_source_for_stage_view (MetaWaylandCompositor *compositor,
 }
 #endif /* HAVE_NATIVE_BACKEND */
 
+static void
+on_before_paint (ClutterStage          *stage,
+                 ClutterStageView      *stage_view,
+                 ClutterFrame          *frame,
+                 MetaWaylandCompositor *compositor)
+{
+  meta_wayland_flush_shm_uploads (compositor);
+}
+
+static void
+clear_fifo_barriers_for_stage_view (MetaWaylandCompositor *compositor,
+                                    ClutterStageView      *stage_view)
+{
+  g_autoptr (GList) cleared_surfaces = NULL;
+  GList *l;
+
+  l = compositor->fifo_barrier_surfaces;
+  while (l)
+    {
+      GList *l_cur = l;
+      MetaWaylandSurface *surface = l->data;
+      MetaSurfaceActor *actor;
+
+      l = l->next;
+
+      /* A barrier is cleared once the content update that set it had its
+       * chance to be presented, i.e. when the view it is primary on was
+       * updated. Surfaces not shown anywhere are cleared by any view, which
+       * limits them to a refresh rate without blocking them. */
+      actor = meta_wayland_surface_get_actor (surface);
+      if (actor &&
+          !meta_surface_actor_wayland_is_view_primary (actor, stage_view) &&
+          is_primary_on_any_stage_view (actor))
+        continue;
+
+      surface->fifo.barrier_set = FALSE;
+
+      compositor->fifo_barrier_surfaces =
+        g_list_remove_link (compositor->fifo_barrier_surfaces, l_cur);
+      cleared_surfaces = g_list_concat (l_cur, cleared_surfaces);
+    }
+
+  for (l = cleared_surfaces; l; l = l->next)
+    meta_wayland_transaction_maybe_apply_for_surface (l->data);
+}
+
 static void
 on_after_update (ClutterStage          *stage,
                  ClutterStageView      *stage_view,
@@ -296,6 +503,8 @@ on_after_update (ClutterStage          *stage,
   GSource *source;
   int64_t frame_deadline_us;
 
+  clear_fifo_barriers_for_stage_view (compositor, stage_view);
+
   if (!META_IS_BACKEND_NATIVE (backend))
     {
       emit_frame_callbacks_for_stage_view (compositor, stage_view);
@@ -326,6 +535,7 @@ on_after_update (ClutterStage          *stage,
 
   g_source_set_ready_time (source, frame_deadline_us);
 #else
+  clear_fifo_barriers_for_stage_view (compositor, stage_view);
   emit_frame_callbacks_for_stage_view (compositor, stage_view);
 #endif
 }
@@ -445,6 +655,8 @@ on_presented (ClutterStage          *stage,
                                                   frame_info,
                                                   output);
     }
+
+  schedule_flush (compositor);
 }
 
 static void
@@ -472,6 +684,8 @@ gboolean
 meta_wayland_compositor_handle_event (MetaWaylandCompositor *compositor,
                                       const ClutterEvent    *event)
 {
+  schedule_flush (compositor);
+
   if (meta_wayland_tablet_manager_handle_event (compositor->tablet_manager,
                                                 event))
     return TRUE;
@@ -510,6 +724,12 @@ meta_wayland_compositor_add_frame_callback_surface (MetaWaylandCompositor *compo
 
   compositor->frame_callback_surfaces =
     g_list_prepend (compositor->frame_callback_surfaces, surface);
+
+  /* Hidden surfaces, e.g. fully obscured, minimized or on another
+   * workspace, are never primary on a stage view. Instead of leaving them
+   * without frame callbacks, or at the mercy of the fallback timers of the
+   * client, they get them at a low rate until they are shown again. */
+  ensure_hidden_frame_callback_timeout (compositor);
 }
 
 void
@@ -520,6 +740,32 @@ meta_wayland_compositor_remove_frame_callback_surface (MetaWaylandCompositor *co
     g_list_remove (compositor->frame_callback_surfaces, surface);
 }
 
+void
+meta_wayland_compositor_add_fifo_barrier_surface (MetaWaylandCompositor *compositor,
+                                                  MetaWaylandSurface    *surface)
+{
+  MetaBackend *backend = meta_context_get_backend (compositor->context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+
+  if (!g_list_find (compositor->fifo_barrier_surfaces, surface))
+    {
+      compositor->fifo_barrier_surfaces =
+        g_list_prepend (compositor->fifo_barrier_surfaces, surface);
+    }
+
+  /* Make sure there is an update that clears the barrier, even if the
+   * content update didn't damage anything. */
+  clutter_stage_schedule_update (CLUTTER_STAGE (stage));
+}
+
+void
+meta_wayland_compositor_remove_fifo_barrier_surface (MetaWaylandCompositor *compositor,
+                                                     MetaWaylandSurface    *surface)
+{
+  compositor->fifo_barrier_surfaces =
+    g_list_remove (compositor->fifo_barrier_surfaces, surface);
+}
+
 void
 meta_wayland_compositor_add_presentation_feedback_surface (MetaWaylandCompositor *compositor,
                                                            MetaWaylandSurface    *surface)
@@ -616,17 +862,28 @@ meta_wayland_compositor_finalize (GObject *object)
   ClutterActor *stage = meta_backend_get_stage (backend);
 
   meta_wayland_activation_finalize (compositor);
+  meta_wayland_client_usage_finalize (compositor);
   meta_wayland_outputs_finalize (compositor);
   meta_wayland_presentation_time_finalize (compositor);
   meta_wayland_tablet_manager_finalize (compositor);
 
+  g_clear_pointer (&compositor->protocol_stats,
+                   meta_wayland_protocol_stats_free);
+
   g_hash_table_destroy (compositor->scheduled_surface_associations);
 
+  meta_prefs_remove_listener (prefs_changed, compositor);
+  g_clear_handle_id (&priv->hidden_frame_callback_timeout_id, g_source_remove);
+
+  g_signal_handlers_disconnect_by_func (stage, on_before_paint, compositor);
   g_signal_handlers_disconnect_by_func (stage, on_after_update, compositor);
   g_signal_handlers_disconnect_by_func (stage, on_presented, compositor);
 
+  meta_wayland_flush_shm_uploads (compositor);
+
   meta_wayland_transaction_finalize (compositor);
 
+  g_clear_object (&compositor->drm_syncobj_manager);
   g_clear_object (&compositor->dma_buf_manager);
 
   g_clear_pointer (&compositor->seat, meta_wayland_seat_free);
@@ -647,7 +904,10 @@ meta_wayland_compositor_init (MetaWaylandCompositor *compositor)
   MetaWaylandCompositorPrivate *priv =
     meta_wayland_compositor_get_instance_private (compositor);
 
-  compositor->scheduled_surface_associations = g_hash_table_new (NULL, NULL);
+  compositor->scheduled_surface_associations =
+    g_hash_table_new_full (NULL, NULL,
+                           NULL,
+                           (GDestroyNotify) scheduled_surface_association_free);
 
   wl_log_set_handler_server (meta_wayland_log_func);
 
@@ -742,6 +1002,29 @@ init_dma_buf_support (MetaWaylandCompositor *compositor)
     }
 }
 
+static void
+init_drm_syncobj_support (MetaWaylandCompositor *compositor)
+{
+  g_autoptr (GError) error = NULL;
+
+  compositor->drm_syncobj_manager =
+    meta_wayland_drm_syncobj_manager_new (compositor, &error);
+  if (!compositor->drm_syncobj_manager)
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+        {
+          meta_topic (META_DEBUG_WAYLAND,
+                      "Wayland explicit synchronization support not enabled: %s",
+                      error->message);
+        }
+      else
+        {
+          g_warning ("Wayland explicit synchronization support not enabled: %s",
+                     error->message);
+        }
+    }
+}
+
 MetaWaylandCompositor *
 meta_wayland_compositor_new (MetaContext *context)
 {
@@ -756,7 +1039,7 @@ meta_wayland_compositor_new (MetaContext *context)
   compositor = g_object_new (META_TYPE_WAYLAND_COMPOSITOR, NULL);
   compositor->context = context;
 
-  wayland_event_source = wayland_event_source_new (compositor->wayland_display);
+  wayland_event_source = wayland_event_source_new (compositor);
 
   /* XXX: Here we are setting the wayland event source to have a
    * slightly lower priority than the X event source, because we are
@@ -769,6 +1052,8 @@ meta_wayland_compositor_new (MetaContext *context)
   compositor->source = wayland_event_source;
   g_source_unref (wayland_event_source);
 
+  g_signal_connect (stage, "before-paint",
+                    G_CALLBACK (on_before_paint), compositor);
   g_signal_connect (stage, "after-update",
                     G_CALLBACK (on_after_update), compositor);
   g_signal_connect (stage, "presented",
@@ -777,6 +1062,8 @@ meta_wayland_compositor_new (MetaContext *context)
   g_signal_connect (context, "started",
                     G_CALLBACK (on_started), compositor);
 
+  meta_prefs_add_listener (prefs_changed, compositor);
+
   if (!wl_global_create (compositor->wayland_display,
                          &wl_compositor_interface,
                          META_WL_COMPOSITOR_VERSION,
@@ -799,6 +1086,7 @@ meta_wayland_compositor_new (MetaContext *context)
   meta_wayland_xdg_foreign_init (compositor);
   meta_wayland_legacy_xdg_foreign_init (compositor);
   init_dma_buf_support (compositor);
+  init_drm_syncobj_support (compositor);
   meta_wayland_init_single_pixel_buffer_manager (compositor);
   meta_wayland_keyboard_shortcuts_inhibit_init (compositor);
   meta_wayland_surface_inhibit_shortcuts_dialog_init ();
@@ -948,27 +1236,6 @@ meta_wayland_compositor_flush_clients (MetaWaylandCompositor *compositor)
   wl_display_flush_clients (compositor->wayland_display);
 }
 
-static void on_scheduled_association_unmanaged (MetaWindow *window,
-                                                gpointer    user_data);
-
-static void
-meta_wayland_compositor_remove_surface_association (MetaWaylandCompositor *compositor,
-                                                    int                    id)
-{
-  MetaWindow *window;
-
-  window = g_hash_table_lookup (compositor->scheduled_surface_associations,
-                                GINT_TO_POINTER (id));
-  if (window)
-    {
-      g_signal_handlers_disconnect_by_func (window,
-                                            on_scheduled_association_unmanaged,
-                                            GINT_TO_POINTER (id));
-      g_hash_table_remove (compositor->scheduled_surface_associations,
-                           GINT_TO_POINTER (id));
-    }
-}
-
 static void
 on_scheduled_association_unmanaged (MetaWindow *window,
                                     gpointer    user_data)
@@ -978,8 +1245,8 @@ on_scheduled_association_unmanaged (MetaWindow *window,
   MetaWaylandCompositor *compositor =
     meta_context_get_wayland_compositor (context);
 
-  meta_wayland_compositor_remove_surface_association (compositor,
-                                                      GPOINTER_TO_INT (user_data));
+  g_hash_table_remove (compositor->scheduled_surface_associations,
+                       user_data);
 }
 
 void
@@ -987,11 +1254,18 @@ meta_wayland_compositor_schedule_surface_association (MetaWaylandCompositor *com
                                                       int                    id,
                                                       MetaWindow            *window)
 {
-  g_signal_connect (window, "unmanaged",
-                    G_CALLBACK (on_scheduled_association_unmanaged),
-                    GINT_TO_POINTER (id));
-  g_hash_table_insert (compositor->scheduled_surface_associations,
-                       GINT_TO_POINTER (id), window);
+  ScheduledSurfaceAssociation *association;
+
+  association = g_new0 (ScheduledSurfaceAssociation, 1);
+  association->window = window;
+  association->scheduled_time_us = g_get_monotonic_time ();
+  association->unmanaged_handler_id =
+    g_signal_connect (window, "unmanaged",
+                      G_CALLBACK (on_scheduled_association_unmanaged),
+                      GINT_TO_POINTER (id));
+
+  g_hash_table_replace (compositor->scheduled_surface_associations,
+                        GINT_TO_POINTER (id), association);
 }
 
 #ifdef HAVE_XWAYLAND
@@ -1000,17 +1274,36 @@ meta_wayland_compositor_notify_surface_id (MetaWaylandCompositor *compositor,
                                            int                    id,
                                            MetaWaylandSurface    *surface)
 {
+  ScheduledSurfaceAssociation *association;
   MetaWindow *window;
+  int64_t latency_us;
 
-  window = g_hash_table_lookup (compositor->scheduled_surface_associations,
-                                GINT_TO_POINTER (id));
-  if (window)
-    {
-#ifdef HAVE_XWAYLAND
-      meta_xwayland_associate_window_with_surface (window, surface);
-#endif
-      meta_wayland_compositor_remove_surface_association (compositor, id);
-    }
+  /* Only Xwayland announces its surfaces through WL_SURFACE_ID */
+  if (wl_resource_get_client (surface->resource) !=
+      compositor->xwayland_manager.client)
+    return;
+
+  association = g_hash_table_lookup (compositor->scheduled_surface_associations,
+                                     GINT_TO_POINTER (id));
+  if (!association)
+    return;
+
+  window = association->window;
+  latency_us = g_get_monotonic_time () - association->scheduled_time_us;
+
+  COGL_TRACE_MESSAGE ("Xwayland surface association",
+                      "Window %s waited %" G_GINT64_FORMAT " µs for "
+                      "wl_surface@%d",
+                      window->desc, latency_us, id);
+  meta_topic (META_DEBUG_WAYLAND,
+              "Associating window %s with wl_surface@%d after %"
+              G_GINT64_FORMAT " µs",
+              window->desc, id, latency_us);
+
+  g_hash_table_remove (compositor->scheduled_surface_associations,
+                       GINT_TO_POINTER (id));
+
+  meta_xwayland_associate_window_with_surface (window, surface);
 }
 #endif
 
@@ -57,6 +57,12 @@ void                    meta_wayland_compositor_add_frame_callback_surface (Meta
 void                    meta_wayland_compositor_remove_frame_callback_surface (MetaWaylandCompositor *compositor,
                                                                                MetaWaylandSurface    *surface);
 
+void                    meta_wayland_compositor_add_fifo_barrier_surface (MetaWaylandCompositor *compositor,
+                                                                          MetaWaylandSurface    *surface);
+
+void                    meta_wayland_compositor_remove_fifo_barrier_surface (MetaWaylandCompositor *compositor,
+                                                                             MetaWaylandSurface    *surface);
+
 void                    meta_wayland_compositor_add_presentation_feedback_surface (MetaWaylandCompositor *compositor,
                                                                                    MetaWaylandSurface    *surface);
 
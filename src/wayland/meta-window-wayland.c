@@ -72,6 +72,7 @@ struct _MetaWindowWayland
   MetaGravity last_sent_gravity;
 
   MetaWaylandWindowConfiguration *last_acked_configuration;
+  gboolean needs_resize_update;
 
   gboolean has_been_shown;
 
@@ -83,6 +84,10 @@ struct _MetaWindowWaylandClass
   MetaWindowClass parent_class;
 };
 
+/* How long an interactive resize waits for the client to ack and commit the
+ * previous resize configuration, before sending the next one anyway. */
+#define RESIZE_ACK_TIMEOUT_US (G_USEC_PER_SEC / 10)
+
 G_DEFINE_TYPE (MetaWindowWayland, meta_window_wayland, META_TYPE_WINDOW)
 
 static void
@@ -192,6 +197,7 @@ static void
 meta_window_wayland_configure (MetaWindowWayland              *wl_window,
                                MetaWaylandWindowConfiguration *configuration)
 {
+  configuration->sent_time_us = g_get_monotonic_time ();
   meta_wayland_surface_configure_notify (wl_window->surface, configuration);
 
   wl_window->pending_configurations =
@@ -1064,6 +1070,52 @@ acquire_acked_configuration (MetaWindowWayland       *wl_window,
   return NULL;
 }
 
+gboolean
+meta_window_wayland_is_awaiting_resize_ack (MetaWindow *window)
+{
+  MetaWindowWayland *wl_window = META_WINDOW_WAYLAND (window);
+  int64_t now_us;
+  GList *l;
+
+  now_us = g_get_monotonic_time ();
+
+  for (l = wl_window->pending_configurations; l; l = l->next)
+    {
+      MetaWaylandWindowConfiguration *configuration = l->data;
+
+      if (configuration->is_resizing &&
+          configuration->has_size &&
+          now_us - configuration->sent_time_us < RESIZE_ACK_TIMEOUT_US)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+void
+meta_window_wayland_check_update_resize (MetaWindow *window)
+{
+  MetaWindowWayland *wl_window = META_WINDOW_WAYLAND (window);
+  MetaWindowDrag *window_drag;
+
+  if (!wl_window->needs_resize_update)
+    return;
+
+  if (meta_window_wayland_is_awaiting_resize_ack (window))
+    return;
+
+  wl_window->needs_resize_update = FALSE;
+
+  window_drag =
+    meta_compositor_get_current_window_drag (window->display->compositor);
+  if (!window_drag ||
+      meta_window_drag_get_window (window_drag) != window ||
+      !meta_grab_op_is_resizing (meta_window_drag_get_grab_op (window_drag)))
+    return;
+
+  meta_window_drag_update_resize (window_drag);
+}
+
 gboolean
 meta_window_wayland_is_resize (MetaWindowWayland *wl_window,
                                int                width,
@@ -1257,6 +1309,10 @@ meta_window_wayland_finish_move_resize (MetaWindow              *window,
         flags |= META_MOVE_RESIZE_WAYLAND_CLIENT_RESIZE;
     }
 
+  if (is_window_being_resized && acked_configuration &&
+      acked_configuration->is_resizing)
+    wl_window->needs_resize_update = TRUE;
+
   g_clear_pointer (&wl_window->last_acked_configuration,
                    meta_wayland_window_configuration_free);
   wl_window->last_acked_configuration = g_steal_pointer (&acked_configuration);
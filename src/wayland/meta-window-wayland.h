@@ -70,6 +70,10 @@ void meta_window_wayland_get_max_size (MetaWindow *window,
                                        int        *width,
                                        int        *height);
 
+gboolean meta_window_wayland_is_awaiting_resize_ack (MetaWindow *window);
+
+void meta_window_wayland_check_update_resize (MetaWindow *window);
+
 gboolean meta_window_wayland_is_resize (MetaWindowWayland *wl_window,
                                         int                width,
                                         int                height);
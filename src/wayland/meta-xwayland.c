@@ -64,6 +64,8 @@
 #define X11_TMP_UNIX_DIR     "/tmp/.X11-unix"
 #define X11_TMP_UNIX_PATH    "/tmp/.X11-unix/X"
 
+#define WARM_STANDBY_DELAY_S 10
+
 static int display_number_override = -1;
 
 static void meta_xwayland_stop_xserver (MetaXWaylandManager *manager);
@@ -968,12 +970,9 @@ meta_xwayland_start_xserver_finish (MetaXWaylandManager  *manager,
   return g_task_propagate_boolean (G_TASK (result), error);
 }
 
-static gboolean
-xdisplay_connection_activity_cb (gint         fd,
-                                 GIOCondition cond,
-                                 gpointer     user_data)
+static void
+start_on_demand (MetaXWaylandManager *manager)
 {
-  MetaXWaylandManager *manager = user_data;
   MetaContext *context =
     meta_wayland_compositor_get_context (manager->compositor);
   MetaDisplay *display = meta_context_get_display (context);
@@ -984,10 +983,54 @@ xdisplay_connection_activity_cb (gint         fd,
   /* Stop watching both file descriptors */
   g_clear_handle_id (&manager->abstract_fd_watch_id, g_source_remove);
   g_clear_handle_id (&manager->unix_fd_watch_id, g_source_remove);
+  g_clear_handle_id (&manager->warm_standby_id, g_source_remove);
+}
+
+static gboolean
+xdisplay_connection_activity_cb (gint         fd,
+                                 GIOCondition cond,
+                                 gpointer     user_data)
+{
+  MetaXWaylandManager *manager = user_data;
+
+  start_on_demand (manager);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+warm_standby_cb (gpointer user_data)
+{
+  MetaXWaylandManager *manager = user_data;
+
+  manager->warm_standby_id = 0;
+
+  g_message ("Starting Xwayland in the background");
+  start_on_demand (manager);
 
   return G_SOURCE_REMOVE;
 }
 
+static gboolean
+should_warm_standby (MetaXWaylandManager *manager)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (manager->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaSettings *settings = meta_backend_get_settings (backend);
+
+  if (!meta_settings_is_experimental_feature_enabled (settings,
+                                                      META_EXPERIMENTAL_FEATURE_XWAYLAND_WARM_STANDBY))
+    return FALSE;
+
+  /* Xwayland would only terminate again for the lack of X11 clients */
+  if (meta_settings_is_experimental_feature_enabled (settings,
+                                                     META_EXPERIMENTAL_FEATURE_AUTOCLOSE_XWAYLAND))
+    return FALSE;
+
+  return TRUE;
+}
+
 static void
 meta_xwayland_stop_xserver (MetaXWaylandManager *manager)
 {
@@ -1014,6 +1057,7 @@ meta_xwayland_shutdown (MetaWaylandCompositor *compositor)
   char path[256];
 
   g_cancellable_cancel (manager->xserver_died_cancellable);
+  g_clear_handle_id (&manager->warm_standby_id, g_source_remove);
 
   XSetIOErrorHandler (x_io_error_noop);
   x11_display = display->x11_display;
@@ -1059,6 +1103,7 @@ meta_xwayland_init (MetaXWaylandManager    *manager,
 {
   MetaContext *context = compositor->context;
   MetaX11DisplayPolicy policy;
+  gboolean first_init = FALSE;
   int display = 0;
 
   if (display_number_override != -1)
@@ -1068,6 +1113,8 @@ meta_xwayland_init (MetaXWaylandManager    *manager,
 
   if (!manager->public_connection.name)
     {
+      first_init = TRUE;
+
       if (!choose_xdisplay (manager, &manager->public_connection, &display, error))
         return FALSE;
 
@@ -1111,6 +1158,16 @@ meta_xwayland_init (MetaXWaylandManager    *manager,
       manager->unix_fd_watch_id =
         g_unix_fd_add (manager->public_connection.unix_fd, G_IO_IN,
                        xdisplay_connection_activity_cb, manager);
+
+      /* Only once, so a crashing Xwayland is not restarted in a loop */
+      if (first_init && should_warm_standby (manager))
+        {
+          manager->warm_standby_id =
+            g_timeout_add_seconds_full (G_PRIORITY_LOW,
+                                        WARM_STANDBY_DELAY_S,
+                                        warm_standby_cb,
+                                        manager, NULL);
+        }
     }
 
   if (policy != META_X11_DISPLAY_POLICY_DISABLED)
@@ -48,6 +48,7 @@
 #include "x11/meta-x11-selection-private.h"
 #include "x11/meta-x11-selection-input-stream-private.h"
 #include "x11/meta-x11-selection-output-stream-private.h"
+#include "x11/window-props.h"
 #include "x11/window-x11.h"
 #include "x11/window-x11-private.h"
 #include "x11/xprops.h"
@@ -1855,6 +1856,11 @@ meta_x11_display_handle_xevent (MetaX11Display *x11_display,
   meta_spew_event_print (x11_display, event);
 #endif
 
+  /* Property changes are coalesced as long as nothing else happens, so
+   * that other events are handled with up to date properties. */
+  if (event->type != PropertyNotify)
+    meta_x11_display_reload_pending_properties (x11_display);
+
   meta_x11_display_run_event_funcs (x11_display, event);
 
   if (meta_x11_startup_notification_handle_xevent (x11_display, event))
@@ -1962,14 +1968,121 @@ meta_x11_display_handle_xevent (MetaX11Display *x11_display,
 }
 
 
+static gboolean
+is_coalescable_with (MetaX11Display *x11_display,
+                     XEvent         *event,
+                     XEvent         *next_event)
+{
+  if (next_event->type != event->type ||
+      next_event->xany.send_event != event->xany.send_event)
+    return FALSE;
+
+  if (event->type == ConfigureNotify)
+    {
+      return (next_event->xconfigure.event == event->xconfigure.event &&
+              next_event->xconfigure.window == event->xconfigure.window);
+    }
+  else if (event->type == x11_display->damage_event_base + XDamageNotify)
+    {
+      XDamageNotifyEvent *damage_event = (XDamageNotifyEvent *) event;
+      XDamageNotifyEvent *next_damage_event = (XDamageNotifyEvent *) next_event;
+
+      return (next_damage_event->drawable == damage_event->drawable &&
+              next_damage_event->damage == damage_event->damage &&
+              next_damage_event->level == damage_event->level);
+    }
+
+  return FALSE;
+}
+
+static void
+merge_damage_event (XDamageNotifyEvent *damage_event,
+                    XDamageNotifyEvent *next_damage_event)
+{
+  MtkRectangle area = {
+    damage_event->area.x,
+    damage_event->area.y,
+    damage_event->area.width,
+    damage_event->area.height,
+  };
+  MtkRectangle next_area = {
+    next_damage_event->area.x,
+    next_damage_event->area.y,
+    next_damage_event->area.width,
+    next_damage_event->area.height,
+  };
+  MtkRectangle merged_area;
+
+  mtk_rectangle_union (&area, &next_area, &merged_area);
+
+  *damage_event = *next_damage_event;
+  damage_event->area.x = merged_area.x;
+  damage_event->area.y = merged_area.y;
+  damage_event->area.width = merged_area.width;
+  damage_event->area.height = merged_area.height;
+}
+
+/*
+ * Collapses a run of already queued events that would be made redundant by
+ * the last one of the run: a ConfigureNotify only matters for its final
+ * geometry and stacking, and damage to the same drawable can be handled as
+ * the union of the damaged areas. Only directly adjacent events are merged,
+ * so that the relative order of events for different windows, which the
+ * stack tracker relies on, is preserved. PropertyNotify events are
+ * coalesced separately by deferring the property reloads.
+ */
+static void
+coalesce_queued_xevents (MetaX11Display *x11_display,
+                         XEvent         *xevent)
+{
+  XEvent next_event;
+  int n_coalesced = 0;
+
+  if (xevent->type != ConfigureNotify &&
+      xevent->type != x11_display->damage_event_base + XDamageNotify)
+    return;
+
+  while (XEventsQueued (x11_display->xdisplay, QueuedAlready) > 0)
+    {
+      XPeekEvent (x11_display->xdisplay, &next_event);
+      if (!is_coalescable_with (x11_display, xevent, &next_event))
+        break;
+
+      XNextEvent (x11_display->xdisplay, &next_event);
+
+      if (xevent->type == ConfigureNotify)
+        *xevent = next_event;
+      else
+        merge_damage_event ((XDamageNotifyEvent *) xevent,
+                            (XDamageNotifyEvent *) &next_event);
+
+      n_coalesced++;
+    }
+
+  if (n_coalesced > 0)
+    {
+      meta_topic (META_DEBUG_EVENTS,
+                  "Coalesced %d queued %s events for 0x%lx",
+                  n_coalesced,
+                  xevent->type == ConfigureNotify ? "ConfigureNotify"
+                                                  : "DamageNotify",
+                  xevent->xany.window);
+    }
+}
+
 static gboolean
 xevent_func (XEvent   *xevent,
              gpointer  data)
 {
   MetaX11Display *x11_display = data;
 
+  coalesce_queued_xevents (x11_display, xevent);
+
   meta_x11_display_handle_xevent (x11_display, xevent);
 
+  if (XEventsQueued (x11_display->xdisplay, QueuedAlready) == 0)
+    meta_x11_display_reload_pending_properties (x11_display);
+
   return G_SOURCE_CONTINUE;
 }
 
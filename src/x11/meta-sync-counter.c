@@ -32,10 +32,14 @@
  * Cogl counter for that frame, and send _NET_WM_FRAME_DRAWN at the end of the
  * frame. _NET_WM_FRAME_TIMINGS is sent when we get a frame_complete callback.
  *
+ * The timings carry the presentation time and refresh rate reported for the
+ * frame by the backend, e.g. from the KMS page flip.
+ *
  * As an exception, if a window is completely obscured, we try to throttle drawning
  * to a slower frame rate. In this case, frame_counter stays -1 until
  * send_frame_message_timeout() runs, at which point we send both the
- * _NET_WM_FRAME_DRAWN and _NET_WM_FRAME_TIMINGS messages.
+ * _NET_WM_FRAME_DRAWN and _NET_WM_FRAME_TIMINGS messages, the latter
+ * without presentation time, but with the refresh interval of the frame clock.
  */
 typedef struct
 {
@@ -453,8 +457,8 @@ do_send_frame_timings (MetaSyncCounter *sync_counter,
                          "presentation time: %" G_GINT64_FORMAT ", "
                          "sync request serial: %" G_GINT64_FORMAT,
                          refresh_interval,
-                         frame->sync_request_serial,
-                         presentation_time);
+                         presentation_time,
+                         frame->sync_request_serial);
       COGL_TRACE_DESCRIBE (MetaWindowActorX11FrameTimings, description);
     }
 #endif
@@ -543,7 +547,8 @@ meta_sync_counter_complete_frame (MetaSyncCounter  *sync_counter,
 }
 
 void
-meta_sync_counter_finish_incomplete (MetaSyncCounter *sync_counter)
+meta_sync_counter_finish_incomplete (MetaSyncCounter *sync_counter,
+                                     int              refresh_interval)
 {
   GList *l;
 
@@ -555,7 +560,7 @@ meta_sync_counter_finish_incomplete (MetaSyncCounter *sync_counter)
       if (frame->frame_counter == -1)
         {
           do_send_frame_drawn (sync_counter, frame);
-          do_send_frame_timings (sync_counter, frame, 0, 0);
+          do_send_frame_timings (sync_counter, frame, refresh_interval, 0);
 
           sync_counter->frames = g_list_delete_link (sync_counter->frames, l);
           g_free (frame);
@@ -82,6 +82,7 @@ void meta_sync_counter_complete_frame (MetaSyncCounter  *sync_counter,
                                        ClutterFrameInfo *frame_info,
                                        int64_t           presentation_time);
 
-void meta_sync_counter_finish_incomplete (MetaSyncCounter *sync_counter);
+void meta_sync_counter_finish_incomplete (MetaSyncCounter *sync_counter,
+                                          int              refresh_interval);
 
 void meta_sync_counter_send_frame_drawn (MetaSyncCounter *sync_counter);
@@ -120,6 +120,7 @@ struct _MetaX11Display
   MetaWindowPropHooks *prop_hooks_table;
   GHashTable *prop_hooks;
   int n_prop_hooks;
+  GHashTable *pending_property_reloads;
 
   /* Managed by group-props.c */
   MetaGroupPropHooks *group_prop_hooks;
@@ -186,6 +187,7 @@ struct _MetaX11Display
   XserverRegion empty_region;
 
   unsigned int reload_x11_cursor_later;
+  unsigned int active_workspace_hint_later;
 };
 
 MetaX11Display *meta_x11_display_new (MetaDisplay *display, GError **error);
@@ -104,6 +104,7 @@ static void prefs_changed_callback (MetaPreference pref,
 static void meta_x11_display_init_frames_client (MetaX11Display *x11_display);
 
 static void meta_x11_display_remove_cursor_later (MetaX11Display *x11_display);
+static void meta_x11_display_remove_active_workspace_hint_later (MetaX11Display *x11_display);
 
 static void meta_x11_display_set_input_focus (MetaX11Display *x11_display,
                                               MetaWindow     *window,
@@ -158,6 +159,8 @@ meta_x11_display_dispose (GObject *object)
 
   x11_display->closing = TRUE;
 
+  meta_x11_display_remove_active_workspace_hint_later (x11_display);
+
   g_clear_pointer (&x11_display->alarm_filters, g_ptr_array_unref);
 
   g_clear_list (&x11_display->event_funcs,
@@ -854,6 +857,9 @@ set_active_workspace_hint (MetaWorkspaceManager *workspace_manager,
 {
   unsigned long data[1];
 
+  if (!workspace_manager->active_workspace)
+    return;
+
   /* this is because we destroy the spaces in order,
    * so we always end up setting a current desktop of
    * 0 when closing a screen, so lose the current desktop
@@ -876,6 +882,57 @@ set_active_workspace_hint (MetaWorkspaceManager *workspace_manager,
   mtk_x11_error_trap_pop (x11_display->xdisplay);
 }
 
+static void
+meta_x11_display_remove_active_workspace_hint_later (MetaX11Display *x11_display)
+{
+  if (x11_display->active_workspace_hint_later)
+    {
+      MetaDisplay *display = x11_display->display;
+
+      /* May happen during destruction */
+      if (display->compositor)
+        {
+          MetaLaters *laters = meta_compositor_get_laters (display->compositor);
+          meta_laters_remove (laters, x11_display->active_workspace_hint_later);
+        }
+
+      x11_display->active_workspace_hint_later = 0;
+    }
+}
+
+static gboolean
+active_workspace_hint_later (gpointer user_data)
+{
+  MetaX11Display *x11_display = user_data;
+
+  x11_display->active_workspace_hint_later = 0;
+  set_active_workspace_hint (x11_display->display->workspace_manager,
+                             x11_display);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Writing the property (and trapping errors around it) means a round trip
+ * to the X server; don't do that in the middle of a workspace switch, and
+ * only write the final workspace when switching several times in a row.
+ */
+static void
+queue_active_workspace_hint (MetaWorkspaceManager *workspace_manager,
+                             MetaX11Display       *x11_display)
+{
+  MetaDisplay *display = x11_display->display;
+  MetaLaters *laters = meta_compositor_get_laters (display->compositor);
+
+  if (x11_display->active_workspace_hint_later)
+    return;
+
+  x11_display->active_workspace_hint_later =
+    meta_laters_add (laters, META_LATER_BEFORE_REDRAW,
+                     active_workspace_hint_later,
+                     x11_display,
+                     NULL);
+}
+
 static void
 set_number_of_spaces_hint (MetaWorkspaceManager *workspace_manager,
                            GParamSpec           *pspec,
@@ -1456,7 +1513,7 @@ meta_x11_display_new (MetaDisplay  *display,
     }
 
   g_signal_connect_object (display->workspace_manager, "active-workspace-changed",
-                           G_CALLBACK (set_active_workspace_hint),
+                           G_CALLBACK (queue_active_workspace_hint),
                            x11_display, 0);
 
   set_number_of_spaces_hint (display->workspace_manager, NULL, x11_display);
@@ -1569,6 +1626,7 @@ meta_x11_display_restore_active_workspace (MetaX11Display *x11_display)
       meta_verbose ("No _NET_CURRENT_DESKTOP present");
     }
 
+  meta_x11_display_remove_active_workspace_hint_later (x11_display);
   set_active_workspace_hint (display->workspace_manager, x11_display);
 }
 
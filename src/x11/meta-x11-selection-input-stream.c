@@ -49,8 +49,12 @@ struct MetaX11SelectionInputStreamPrivate
 
   guint complete : 1;
   guint incr : 1;
+  guint property_pending_delete : 1;
 };
 
+/* Number of INCR chunks that are fetched ahead of the reader */
+#define MAX_QUEUED_CHUNKS 4
+
 G_DEFINE_TYPE_WITH_PRIVATE (MetaX11SelectionInputStream,
                             meta_x11_selection_input_stream,
                             G_TYPE_INPUT_STREAM)
@@ -121,31 +125,51 @@ meta_x11_selection_input_stream_fill_buffer (MetaX11SelectionInputStream *stream
 }
 
 static void
-meta_x11_selection_input_stream_flush (MetaX11SelectionInputStream *stream)
+meta_x11_selection_input_stream_maybe_delete_property (MetaX11SelectionInputStream *stream)
 {
   MetaX11SelectionInputStreamPrivate *priv =
     meta_x11_selection_input_stream_get_instance_private (stream);
   Display *xdisplay = priv->x11_display->xdisplay;
-  gssize written;
+
+  if (!priv->property_pending_delete)
+    return;
+
+  /* Deleting the property asks the selection owner for the next INCR
+   * chunk, don't do that while the reader is behind. */
+  if (priv->incr && !priv->complete &&
+      g_async_queue_length (priv->chunks) >= MAX_QUEUED_CHUNKS)
+    return;
 
   mtk_x11_error_trap_push (xdisplay);
   XDeleteProperty (xdisplay, priv->window, priv->xproperty);
   mtk_x11_error_trap_pop (xdisplay);
 
-  if (!meta_x11_selection_input_stream_has_data (stream))
-    return;
+  priv->property_pending_delete = FALSE;
+}
 
-  if (priv->pending_task == NULL)
-    return;
+static void
+meta_x11_selection_input_stream_flush (MetaX11SelectionInputStream *stream)
+{
+  MetaX11SelectionInputStreamPrivate *priv =
+    meta_x11_selection_input_stream_get_instance_private (stream);
+  gssize written;
 
-  written = meta_x11_selection_input_stream_fill_buffer (stream,
-                                                         priv->pending_data,
-                                                         priv->pending_size);
-  g_task_return_int (priv->pending_task, written);
+  priv->property_pending_delete = TRUE;
 
-  g_clear_object (&priv->pending_task);
-  priv->pending_data = NULL;
-  priv->pending_size = 0;
+  if (meta_x11_selection_input_stream_has_data (stream) &&
+      priv->pending_task != NULL)
+    {
+      written = meta_x11_selection_input_stream_fill_buffer (stream,
+                                                             priv->pending_data,
+                                                             priv->pending_size);
+      g_task_return_int (priv->pending_task, written);
+
+      g_clear_object (&priv->pending_task);
+      priv->pending_data = NULL;
+      priv->pending_size = 0;
+    }
+
+  meta_x11_selection_input_stream_maybe_delete_property (stream);
 }
 
 static void
@@ -215,6 +239,8 @@ meta_x11_selection_input_stream_read_async (GInputStream        *input_stream,
       size = meta_x11_selection_input_stream_fill_buffer (stream, buffer, count);
       g_task_return_int (task, size);
       g_object_unref (task);
+
+      meta_x11_selection_input_stream_maybe_delete_property (stream);
     }
   else
     {
@@ -50,12 +50,15 @@ struct _MetaX11SelectionOutputStreamPrivate
   guint flush_requested : 1;
 
   GTask *pending_task;
+  GTask *pending_write_task;
 
   guint incr : 1;
   guint delete_pending : 1;
   guint pipe_error : 1;
 };
 
+#define MAX_BUFFERED_CHUNKS 4
+
 G_DEFINE_TYPE_WITH_PRIVATE (MetaX11SelectionOutputStream,
                             meta_x11_selection_output_stream,
                             G_TYPE_OUTPUT_STREAM);
@@ -141,6 +144,19 @@ meta_x11_selection_output_stream_needs_flush_unlocked (MetaX11SelectionOutputStr
   return priv->data->len >= get_max_request_size (priv->x11_display);
 }
 
+static gboolean
+meta_x11_selection_output_stream_is_buffer_full (MetaX11SelectionOutputStream *stream)
+{
+  MetaX11SelectionOutputStreamPrivate *priv =
+    meta_x11_selection_output_stream_get_instance_private (stream);
+
+  /* Don't accept more data than a few INCR chunks while the requestor
+   * is still busy with the previous one. */
+  return (priv->delete_pending &&
+          priv->data->len >= (MAX_BUFFERED_CHUNKS *
+                              get_max_request_size (priv->x11_display)));
+}
+
 static gboolean
 meta_x11_selection_output_stream_needs_flush (MetaX11SelectionOutputStream *stream)
 {
@@ -292,15 +308,37 @@ meta_x11_selection_output_stream_perform_flush (MetaX11SelectionOutputStream *st
                                    error_str);
           g_clear_object (&priv->pending_task);
         }
+
+      if (priv->pending_write_task)
+        {
+          g_task_return_new_error (priv->pending_write_task,
+                                   G_IO_ERROR,
+                                   G_IO_ERROR_BROKEN_PIPE,
+                                   "Connection with client was broken");
+          g_clear_object (&priv->pending_write_task);
+        }
     }
-  else if (priv->pending_task && priv->data->len == 0 && !priv->delete_pending)
+  else
     {
-      size_t result;
+      if (priv->pending_task && priv->data->len == 0 && !priv->delete_pending)
+        {
+          size_t result;
 
-      priv->flush_requested = FALSE;
-      result = GPOINTER_TO_SIZE (g_task_get_task_data (priv->pending_task));
-      g_task_return_int (priv->pending_task, result);
-      g_clear_object (&priv->pending_task);
+          priv->flush_requested = FALSE;
+          result = GPOINTER_TO_SIZE (g_task_get_task_data (priv->pending_task));
+          g_task_return_int (priv->pending_task, result);
+          g_clear_object (&priv->pending_task);
+        }
+
+      if (priv->pending_write_task &&
+          !meta_x11_selection_output_stream_is_buffer_full (stream))
+        {
+          size_t result;
+
+          result = GPOINTER_TO_SIZE (g_task_get_task_data (priv->pending_write_task));
+          g_task_return_int (priv->pending_write_task, result);
+          g_clear_object (&priv->pending_write_task);
+        }
     }
 }
 
@@ -381,21 +419,24 @@ meta_x11_selection_output_stream_write_async (GOutputStream       *output_stream
   g_byte_array_append (priv->data, buffer, count);
   g_mutex_unlock (&priv->mutex);
 
-  if (!meta_x11_selection_output_stream_needs_flush (stream))
+  if (meta_x11_selection_output_stream_needs_flush (stream) &&
+      meta_x11_selection_output_stream_can_flush (stream))
+    meta_x11_selection_output_stream_perform_flush (stream);
+
+  if (meta_x11_selection_output_stream_is_buffer_full (stream))
     {
-      g_task_return_int (task, count);
-      g_object_unref (task);
+      /* Finish the write once the requestor fetched enough of the
+       * buffered data, so the source is read at the pace of the
+       * requestor.
+       */
+      g_assert (priv->pending_write_task == NULL);
+      g_task_set_task_data (task, GSIZE_TO_POINTER (count), NULL);
+      priv->pending_write_task = task;
       return;
     }
-  else
-    {
-      if (meta_x11_selection_output_stream_can_flush (stream))
-        meta_x11_selection_output_stream_perform_flush (stream);
 
-      g_task_return_int (task, count);
-      g_object_unref (task);
-      return;
-    }
+  g_task_return_int (task, count);
+  g_object_unref (task);
 }
 
 static gssize
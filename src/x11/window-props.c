@@ -80,6 +80,12 @@ struct _MetaWindowPropHooks
   MetaPropHookFlags flags;
 };
 
+typedef struct _PendingPropertyReload
+{
+  Window xwindow;
+  Atom property;
+} PendingPropertyReload;
+
 static void init_prop_value            (MetaWindow          *window,
                                         MetaWindowPropHooks *hooks,
                                         MetaPropValue       *value);
@@ -129,6 +135,119 @@ meta_window_reload_property (MetaWindow      *window,
                                             initial);
 }
 
+void
+meta_window_queue_property_reload_from_xwindow (MetaWindow *window,
+                                                Window      xwindow,
+                                                Atom        property)
+{
+  MetaX11Display *x11_display = window->display->x11_display;
+  MetaWindowPropHooks *hooks;
+  PendingPropertyReload reload;
+  GArray *pending;
+  unsigned int i;
+
+  hooks = find_hooks (x11_display, property);
+  if (!hooks || (hooks->flags & INIT_ONLY))
+    return;
+
+  pending = g_hash_table_lookup (x11_display->pending_property_reloads,
+                                 window);
+  if (!pending)
+    {
+      pending = g_array_new (FALSE, FALSE, sizeof (PendingPropertyReload));
+      g_hash_table_insert (x11_display->pending_property_reloads,
+                           g_object_ref (window),
+                           pending);
+    }
+
+  for (i = 0; i < pending->len; i++)
+    {
+      PendingPropertyReload *other =
+        &g_array_index (pending, PendingPropertyReload, i);
+
+      if (other->xwindow == xwindow && other->property == property)
+        return;
+    }
+
+  reload = (PendingPropertyReload) {
+    .xwindow = xwindow,
+    .property = property,
+  };
+  g_array_append_val (pending, reload);
+}
+
+static void
+reload_pending_properties (MetaWindow *window,
+                           GArray     *pending)
+{
+  MetaX11Display *x11_display = window->display->x11_display;
+  g_autofree MetaPropValue *values = NULL;
+  g_autofree MetaWindowPropHooks **hooks = NULL;
+
+  values = g_new0 (MetaPropValue, pending->len);
+  hooks = g_new0 (MetaWindowPropHooks *, pending->len);
+
+  /* Fetch the properties of each X window in one go; that is usually just
+   * the client window, and the user time window if it has one. */
+  while (pending->len > 0 && !window->unmanaging)
+    {
+      Window xwindow = g_array_index (pending, PendingPropertyReload, 0).xwindow;
+      unsigned int n_values = 0;
+      unsigned int i;
+
+      i = 0;
+      while (i < pending->len)
+        {
+          PendingPropertyReload *reload =
+            &g_array_index (pending, PendingPropertyReload, i);
+
+          if (reload->xwindow != xwindow)
+            {
+              i++;
+              continue;
+            }
+
+          hooks[n_values] = find_hooks (x11_display, reload->property);
+          init_prop_value (window, hooks[n_values], &values[n_values]);
+          n_values++;
+
+          g_array_remove_index (pending, i);
+        }
+
+      meta_prop_get_values (x11_display, xwindow, values, n_values);
+
+      for (i = 0; i < n_values; i++)
+        reload_prop_value (window, hooks[i], &values[i], FALSE);
+
+      meta_prop_free_values (values, n_values);
+      memset (values, 0, n_values * sizeof (MetaPropValue));
+    }
+}
+
+void
+meta_x11_display_reload_pending_properties (MetaX11Display *x11_display)
+{
+  g_autoptr (GHashTable) pending_reloads = NULL;
+  GHashTableIter iter;
+  MetaWindow *window;
+  GArray *pending;
+
+  if (g_hash_table_size (x11_display->pending_property_reloads) == 0)
+    return;
+
+  /* Reloading may queue more, they are handled the next time */
+  pending_reloads = g_steal_pointer (&x11_display->pending_property_reloads);
+  x11_display->pending_property_reloads =
+    g_hash_table_new_full (NULL, NULL,
+                           g_object_unref,
+                           (GDestroyNotify) g_array_unref);
+
+  g_hash_table_iter_init (&iter, pending_reloads);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &window,
+                                 (gpointer *) &pending))
+    reload_pending_properties (window, pending);
+}
+
 void
 meta_window_load_initial_properties (MetaWindow *window)
 {
@@ -1944,6 +2063,10 @@ meta_x11_display_init_window_prop_hooks (MetaX11Display *x11_display)
 
   x11_display->prop_hooks_table = (gpointer) table;
   x11_display->prop_hooks = g_hash_table_new (NULL, NULL);
+  x11_display->pending_property_reloads =
+    g_hash_table_new_full (NULL, NULL,
+                           g_object_unref,
+                           (GDestroyNotify) g_array_unref);
 
   while (cursor->property)
     {
@@ -1968,6 +2091,9 @@ meta_x11_display_init_window_prop_hooks (MetaX11Display *x11_display)
 void
 meta_x11_display_free_window_prop_hooks (MetaX11Display *x11_display)
 {
+  g_clear_pointer (&x11_display->pending_property_reloads,
+                   g_hash_table_unref);
+
   g_hash_table_unref (x11_display->prop_hooks);
   x11_display->prop_hooks = NULL;
 
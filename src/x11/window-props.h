@@ -7,7 +7,8 @@
  * and take appropriate action given their values.
  *
  * Note that all the meta_window_reload_property* functions require a
- * round trip to the server.
+ * round trip to the server. Property changes are therefore queued with
+ * meta_window_queue_property_reload_from_xwindow(), and reloaded in batches.
  */
 
 /*
@@ -47,6 +48,29 @@ void meta_window_reload_property_from_xwindow (MetaWindow      *window,
                                                Atom             property,
                                                gboolean         initial);
 
+/**
+ * meta_window_queue_property_reload_from_xwindow:
+ * @window:     The window the property belongs to.
+ * @xwindow:    The X handle for the window.
+ * @property:   A single X atom.
+ *
+ * Queues reloading a property that changed, to be done together with all
+ * other queued properties of the window by
+ * meta_x11_display_reload_pending_properties().
+ */
+void meta_window_queue_property_reload_from_xwindow (MetaWindow *window,
+                                                     Window      xwindow,
+                                                     Atom        property);
+
+/**
+ * meta_x11_display_reload_pending_properties:
+ * @x11_display:  The X11 display.
+ *
+ * Reloads the queued properties of all windows, fetching the properties of
+ * each window with a single round trip to the server.
+ */
+void meta_x11_display_reload_pending_properties (MetaX11Display *x11_display);
+
 /**
  * meta_window_load_initial_properties:
  * @window:      The window.
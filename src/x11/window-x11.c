@@ -2890,6 +2890,7 @@ static void
 meta_window_x11_impl_process_property_notify (MetaWindow     *window,
                                               XPropertyEvent *event)
 {
+  MetaX11Display *x11_display = window->display->x11_display;
   Window xid = meta_window_x11_get_xwindow (window);
   Window user_time_window = meta_window_x11_get_user_time_window (window);
 
@@ -2903,13 +2904,22 @@ meta_window_x11_impl_process_property_notify (MetaWindow     *window,
       XFree (property_name);
     }
 
-  if (event->atom == window->display->x11_display->atom__NET_WM_USER_TIME &&
+  if (event->atom == x11_display->atom__NET_WM_USER_TIME &&
       user_time_window)
     {
       xid = user_time_window;
     }
 
-  meta_window_reload_property_from_xwindow (window, xid, event->atom, FALSE);
+  /* Which window later user time changes are read from depends on this
+   * one, so don't let it lag behind them. */
+  if (event->atom == x11_display->atom__NET_WM_USER_TIME_WINDOW)
+    {
+      meta_x11_display_reload_pending_properties (x11_display);
+      meta_window_reload_property_from_xwindow (window, xid, event->atom, FALSE);
+      return;
+    }
+
+  meta_window_queue_property_reload_from_xwindow (window, xid, event->atom);
 }
 
 void